@@ -0,0 +1,1634 @@
+/*****************************************************************************
+ * File bignum.c part of ProgAndSciCalc
+ *
+ * Copyright (C) 2018 Ken Bromham
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "bignum.h"
+
+typedef unsigned __int128 u128;
+
+#define LIMB_BYTES sizeof(bn_limb_t)
+
+static int karatsuba_threshold = BN_KARATSUBA_THRESHOLD;
+static int ntt_threshold = BN_NTT_THRESHOLD;
+static int bz_threshold = BN_BZ_THRESHOLD;
+static int radix_dc_threshold = BN_RADIX_DC_THRESHOLD;
+
+
+void bn_set_thresholds(int karatsuba, int ntt, int bz, int radix_dc)
+{
+    /* Karatsuba on fewer than 4 limbs would recurse on the same size */
+    karatsuba_threshold = karatsuba > 0 ? karatsuba : BN_KARATSUBA_THRESHOLD;
+    if (karatsuba_threshold < 4)
+    {
+        karatsuba_threshold = 4;
+    }
+    ntt_threshold = ntt > 0 ? ntt : BN_NTT_THRESHOLD;
+    bz_threshold = bz > 0 ? bz : BN_BZ_THRESHOLD;
+    radix_dc_threshold = radix_dc > 0 ? radix_dc : BN_RADIX_DC_THRESHOLD;
+}
+
+
+/****************************************************************************
+ * Arena
+ *
+ * A list of blocks, newest first. Allocation takes the next part of the
+ * newest block, or starts a new one if it doesn't fit.
+ */
+
+struct bn_arena_block
+{
+    bn_arena_block *prev;
+    size_t size;
+    size_t used;
+    bn_limb_t mem[];
+};
+
+#define ARENA_BLOCK_SIZE (64 * 1024)
+
+void bn_arena_init(bn_arena_t *ar)
+{
+    ar->head = NULL;
+}
+
+void bn_arena_free(bn_arena_t *ar)
+{
+    while (ar->head != NULL)
+    {
+        bn_arena_block *b = ar->head;
+        ar->head = b->prev;
+        free(b);
+    }
+}
+
+void *bn_arena_alloc(bn_arena_t *ar, size_t size)
+{
+    bn_arena_block *b = ar->head;
+    void *p;
+
+    /* keep everything aligned for limbs */
+    size = (size + LIMB_BYTES - 1) & ~(LIMB_BYTES - 1);
+    if (size == 0)
+    {
+        size = LIMB_BYTES;
+    }
+
+    if (b == NULL || b->size - b->used < size)
+    {
+        size_t bsize = size > ARENA_BLOCK_SIZE ? size : ARENA_BLOCK_SIZE;
+        b = malloc(sizeof(*b) + bsize);
+        if (b == NULL)
+        {
+            fprintf(stderr, "bignum: out of memory\n");
+            exit(1);
+        }
+        b->prev = ar->head;
+        b->size = bsize;
+        b->used = 0;
+        ar->head = b;
+    }
+    p = (char *)b->mem + b->used;
+    b->used += size;
+    return p;
+}
+
+bn_arena_mark_t bn_arena_mark(bn_arena_t *ar)
+{
+    bn_arena_mark_t mark;
+    mark.block = ar->head;
+    mark.used = ar->head ? ar->head->used : 0;
+    return mark;
+}
+
+void bn_arena_release(bn_arena_t *ar, bn_arena_mark_t mark)
+{
+    while (ar->head != mark.block)
+    {
+        bn_arena_block *b = ar->head;
+        ar->head = b->prev;
+        free(b);
+    }
+    if (ar->head != NULL)
+    {
+        ar->head->used = mark.used;
+    }
+}
+
+static bn_limb_t *limbs_alloc(bn_arena_t *ar, int n)
+{
+    return bn_arena_alloc(ar, (size_t)n * LIMB_BYTES);
+}
+
+
+/****************************************************************************
+ * Operations on limb arrays (least significant first)
+ */
+
+/* length without high zero limbs */
+static int limbs_norm(const bn_limb_t *a, int n)
+{
+    while (n > 0 && a[n - 1] == 0)
+    {
+        n--;
+    }
+    return n;
+}
+
+/* compare a and b of the same length */
+static int limbs_cmp(const bn_limb_t *a, const bn_limb_t *b, int n)
+{
+    for (int i = n - 1; i >= 0; i--)
+    {
+        if (a[i] != b[i])
+        {
+            return a[i] < b[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+/* r = a + b, an >= bn, r has an limbs (can be a), returns the carry */
+static bn_limb_t limbs_add(bn_limb_t *r, const bn_limb_t *a, int an,
+                           const bn_limb_t *b, int bn)
+{
+    bn_limb_t c = 0;
+    int i;
+
+    for (i = 0; i < bn; i++)
+    {
+        u128 s = (u128)a[i] + b[i] + c;
+        r[i] = (bn_limb_t)s;
+        c = (bn_limb_t)(s >> 64);
+    }
+    for (; i < an; i++)
+    {
+        bn_limb_t s = a[i] + c;
+        c = s < c;
+        r[i] = s;
+    }
+    return c;
+}
+
+/* r = a - b, an >= bn, r has an limbs (can be a), returns the borrow */
+static bn_limb_t limbs_sub(bn_limb_t *r, const bn_limb_t *a, int an,
+                           const bn_limb_t *b, int bn)
+{
+    bn_limb_t br = 0;
+    int i;
+
+    for (i = 0; i < bn; i++)
+    {
+        bn_limb_t ai = a[i];
+        bn_limb_t bi = b[i];
+        r[i] = ai - bi - br;
+        br = (ai < bi) || (ai - bi < br);
+    }
+    for (; i < an; i++)
+    {
+        bn_limb_t ai = a[i];
+        r[i] = ai - br;
+        br = ai < br;
+    }
+    return br;
+}
+
+/* r = a * m, r has n limbs (can be a), returns the carry limb */
+static bn_limb_t limbs_mul_1(bn_limb_t *r, const bn_limb_t *a, int n,
+                             bn_limb_t m)
+{
+    bn_limb_t c = 0;
+
+    for (int i = 0; i < n; i++)
+    {
+        u128 p = (u128)a[i] * m + c;
+        r[i] = (bn_limb_t)p;
+        c = (bn_limb_t)(p >> 64);
+    }
+    return c;
+}
+
+/* r += a * m, returns the carry limb */
+static bn_limb_t limbs_addmul_1(bn_limb_t *r, const bn_limb_t *a, int n,
+                                bn_limb_t m)
+{
+    bn_limb_t c = 0;
+
+    for (int i = 0; i < n; i++)
+    {
+        u128 p = (u128)a[i] * m + r[i] + c;
+        r[i] = (bn_limb_t)p;
+        c = (bn_limb_t)(p >> 64);
+    }
+    return c;
+}
+
+/* r -= a * m, returns the borrow limb */
+static bn_limb_t limbs_submul_1(bn_limb_t *r, const bn_limb_t *a, int n,
+                                bn_limb_t m)
+{
+    bn_limb_t c = 0;
+
+    for (int i = 0; i < n; i++)
+    {
+        u128 p = (u128)a[i] * m + c;
+        bn_limb_t lo = (bn_limb_t)p;
+        bn_limb_t t = r[i];
+        c = (bn_limb_t)(p >> 64);
+        r[i] = t - lo;
+        c += t < lo;
+    }
+    return c;
+}
+
+/* q = a / d (q can be a), returns the remainder */
+static bn_limb_t limbs_divmod_1(bn_limb_t *q, const bn_limb_t *a, int n,
+                                bn_limb_t d)
+{
+    bn_limb_t r = 0;
+
+    for (int i = n - 1; i >= 0; i--)
+    {
+        u128 cur = ((u128)r << 64) | a[i];
+        q[i] = (bn_limb_t)(cur / d);
+        r = (bn_limb_t)(cur % d);
+    }
+    return r;
+}
+
+/* r = a << s for s 0 - 63, n >= 1 limbs (r can be a), returns the bits
+ * shifted out of the top */
+static bn_limb_t limbs_lshift(bn_limb_t *r, const bn_limb_t *a, int n, int s)
+{
+    bn_limb_t out;
+
+    if (s == 0)
+    {
+        memmove(r, a, n * LIMB_BYTES);
+        return 0;
+    }
+    out = a[n - 1] >> (64 - s);
+    for (int i = n - 1; i > 0; i--)
+    {
+        r[i] = (a[i] << s) | (a[i - 1] >> (64 - s));
+    }
+    r[0] = a[0] << s;
+    return out;
+}
+
+/* r = a >> s for s 0 - 63, n >= 1 limbs (r can be a) */
+static void limbs_rshift(bn_limb_t *r, const bn_limb_t *a, int n, int s)
+{
+    if (s == 0)
+    {
+        memmove(r, a, n * LIMB_BYTES);
+        return;
+    }
+    for (int i = 0; i < n - 1; i++)
+    {
+        r[i] = (a[i] >> s) | (a[i + 1] << (64 - s));
+    }
+    r[n - 1] = a[n - 1] >> s;
+}
+
+
+/****************************************************************************
+ * Multiplication
+ */
+
+static void limbs_mul(bn_arena_t *ar, bn_limb_t *r,
+                      const bn_limb_t *a, int an, const bn_limb_t *b, int bn);
+
+/* r = a * b, r has an + bn limbs and isn't a or b */
+static void mul_school(bn_limb_t *r, const bn_limb_t *a, int an,
+                       const bn_limb_t *b, int bn)
+{
+    memset(r, 0, (size_t)(an + bn) * LIMB_BYTES);
+    for (int j = 0; j < bn; j++)
+    {
+        r[j + an] = limbs_addmul_1(r + j, a, an, b[j]);
+    }
+}
+
+/* r = a * b, both n limbs, r 2n limbs.
+ * With a = a1 * B + a0 and b = b1 * B + b0, a0 and b0 the low h limbs,
+ * a * b = z2 * B^2 + (z1 - z2 - z0) * B + z0 where z0 = a0 * b0,
+ * z2 = a1 * b1 and z1 = (a0 + a1) * (b0 + b1), three multiplications of
+ * half the size instead of four. */
+static void mul_karatsuba(bn_arena_t *ar, bn_limb_t *r,
+                          const bn_limb_t *a, const bn_limb_t *b, int n)
+{
+    int h = n / 2;
+    int hh = n - h;
+    int zn = 2 * (hh + 1);
+    bn_arena_mark_t mark = bn_arena_mark(ar);
+    bn_limb_t *sa = limbs_alloc(ar, hh + 1);
+    bn_limb_t *sb = limbs_alloc(ar, hh + 1);
+    bn_limb_t *z1 = limbs_alloc(ar, zn);
+
+    sa[hh] = limbs_add(sa, a + h, hh, a, h);
+    sb[hh] = limbs_add(sb, b + h, hh, b, h);
+
+    /* z0 in the low 2h limbs of r, z2 in the high 2hh */
+    limbs_mul(ar, r, a, h, b, h);
+    limbs_mul(ar, r + 2 * h, a + h, hh, b + h, hh);
+    limbs_mul(ar, z1, sa, hh + 1, sb, hh + 1);
+
+    limbs_sub(z1, z1, zn, r, 2 * h);
+    limbs_sub(z1, z1, zn, r + 2 * h, 2 * hh);
+    zn = limbs_norm(z1, zn);
+    limbs_add(r + h, r + h, 2 * n - h, z1, zn);
+
+    bn_arena_release(ar, mark);
+}
+
+/*
+ * Number theoretic transform multiplication, modulo the prime
+ * p = 2^64 - 2^32 + 1 which has roots of unity of every power of 2 order up
+ * to 2^32. The numbers are split into 16 bit digits so the convolution
+ * sums (at most 2^32 terms each under 2^32) stay below p and are exact.
+ */
+#define NTT_P 0xFFFFFFFF00000001ULL
+/* 2^64 mod p */
+#define NTT_EPSILON 0xFFFFFFFFULL
+/* generator of the multiplicative group */
+#define NTT_G 7
+
+static uint64_t ntt_reduce(u128 x)
+{
+    uint64_t lo = (uint64_t)x;
+    uint64_t hi = (uint64_t)(x >> 64);
+    uint64_t hi_hi = hi >> 32;
+    uint64_t hi_lo = hi & NTT_EPSILON;
+    uint64_t t0, t1, t2;
+
+    /* x = lo + hi_lo * 2^64 + hi_hi * 2^96, and 2^96 = -1 mod p */
+    t0 = lo - hi_hi;
+    if (lo < hi_hi)
+    {
+        t0 -= NTT_EPSILON;
+    }
+    t1 = hi_lo * NTT_EPSILON;
+    t2 = t0 + t1;
+    if (t2 < t1)
+    {
+        t2 += NTT_EPSILON;
+    }
+    if (t2 >= NTT_P)
+    {
+        t2 -= NTT_P;
+    }
+    return t2;
+}
+
+static uint64_t ntt_mul(uint64_t a, uint64_t b)
+{
+    return ntt_reduce((u128)a * b);
+}
+
+static uint64_t ntt_add(uint64_t a, uint64_t b)
+{
+    uint64_t s = a + b;
+    if (s < a || s >= NTT_P)
+    {
+        s -= NTT_P;
+    }
+    return s;
+}
+
+static uint64_t ntt_sub(uint64_t a, uint64_t b)
+{
+    return a >= b ? a - b : a + (NTT_P - b);
+}
+
+static uint64_t ntt_pow(uint64_t b, uint64_t e)
+{
+    uint64_t r = 1;
+
+    while (e)
+    {
+        if (e & 1)
+        {
+            r = ntt_mul(r, b);
+        }
+        b = ntt_mul(b, b);
+        e >>= 1;
+    }
+    return r;
+}
+
+/* in place transform of 2^logn values, inverse includes the 1/n scaling */
+static void ntt(uint64_t *a, int logn, bool inverse)
+{
+    size_t n = (size_t)1 << logn;
+
+    for (size_t i = 1, j = 0; i < n; i++)
+    {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1)
+        {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j)
+        {
+            uint64_t t = a[i];
+            a[i] = a[j];
+            a[j] = t;
+        }
+    }
+
+    for (size_t len = 2; len <= n; len <<= 1)
+    {
+        uint64_t w = ntt_pow(NTT_G, (NTT_P - 1) / len);
+        size_t half = len / 2;
+
+        if (inverse)
+        {
+            w = ntt_pow(w, NTT_P - 2);
+        }
+        for (size_t i = 0; i < n; i += len)
+        {
+            uint64_t wk = 1;
+            for (size_t j = 0; j < half; j++)
+            {
+                uint64_t u = a[i + j];
+                uint64_t v = ntt_mul(a[i + j + half], wk);
+                a[i + j] = ntt_add(u, v);
+                a[i + j + half] = ntt_sub(u, v);
+                wk = ntt_mul(wk, w);
+            }
+        }
+    }
+
+    if (inverse)
+    {
+        uint64_t ninv = ntt_pow(n, NTT_P - 2);
+        for (size_t i = 0; i < n; i++)
+        {
+            a[i] = ntt_mul(a[i], ninv);
+        }
+    }
+}
+
+static void ntt_split(uint64_t *f, size_t size, const bn_limb_t *a, int an)
+{
+    for (int i = 0; i < an; i++)
+    {
+        for (int k = 0; k < 4; k++)
+        {
+            f[4 * i + k] = (a[i] >> (16 * k)) & 0xffff;
+        }
+    }
+    memset(f + 4 * (size_t)an, 0, (size - 4 * (size_t)an) * sizeof(*f));
+}
+
+/* r = a * b, r has an + bn limbs and isn't a or b */
+static void mul_ntt(bn_arena_t *ar, bn_limb_t *r,
+                    const bn_limb_t *a, int an, const bn_limb_t *b, int bn)
+{
+    size_t digits = 4 * (size_t)(an + bn);
+    int logn = 0;
+    bn_arena_mark_t mark = bn_arena_mark(ar);
+    uint64_t *fa, *fb;
+    size_t n;
+    u128 c = 0;
+
+    while (((size_t)1 << logn) < digits)
+    {
+        logn++;
+    }
+    n = (size_t)1 << logn;
+    fa = bn_arena_alloc(ar, n * sizeof(*fa));
+    fb = bn_arena_alloc(ar, n * sizeof(*fb));
+    ntt_split(fa, n, a, an);
+    ntt_split(fb, n, b, bn);
+
+    ntt(fa, logn, false);
+    ntt(fb, logn, false);
+    for (size_t i = 0; i < n; i++)
+    {
+        fa[i] = ntt_mul(fa[i], fb[i]);
+    }
+    ntt(fa, logn, true);
+
+    /* put the carries through the 16 bit digits */
+    memset(r, 0, (size_t)(an + bn) * LIMB_BYTES);
+    for (size_t k = 0; k < digits; k++)
+    {
+        c += fa[k];
+        r[k / 4] |= (bn_limb_t)(c & 0xffff) << (16 * (k % 4));
+        c >>= 16;
+    }
+
+    bn_arena_release(ar, mark);
+}
+
+/* r = a * b, r has an + bn limbs and isn't a or b */
+static void limbs_mul(bn_arena_t *ar, bn_limb_t *r,
+                      const bn_limb_t *a, int an, const bn_limb_t *b, int bn)
+{
+    if (an < bn)
+    {
+        const bn_limb_t *t = a;
+        int tn = an;
+        a = b;
+        an = bn;
+        b = t;
+        bn = tn;
+    }
+
+    if (bn < karatsuba_threshold)
+    {
+        mul_school(r, a, an, b, bn);
+    }
+    else if (bn >= ntt_threshold)
+    {
+        mul_ntt(ar, r, a, an, b, bn);
+    }
+    else if (an == bn)
+    {
+        mul_karatsuba(ar, r, a, b, an);
+    }
+    else
+    {
+        /* unbalanced, multiply b by pieces of a the same size as b */
+        bn_arena_mark_t mark = bn_arena_mark(ar);
+        bn_limb_t *t = limbs_alloc(ar, 2 * bn);
+
+        memset(r, 0, (size_t)(an + bn) * LIMB_BYTES);
+        for (int i = 0; i < an; i += bn)
+        {
+            int len = an - i < bn ? an - i : bn;
+            limbs_mul(ar, t, a + i, len, b, bn);
+            limbs_add(r + i, r + i, an + bn - i, t, len + bn);
+        }
+        bn_arena_release(ar, mark);
+    }
+}
+
+
+/****************************************************************************
+ * Division
+ */
+
+/* Knuth algorithm D. u has un limbs, v has vn >= 2 limbs with the top bit
+ * set, and the top vn limbs of u are less than v. Sets the un - vn limbs
+ * of q and leaves the remainder in the low vn limbs of u. */
+static void div_school(bn_limb_t *q, bn_limb_t *u, int un,
+                       const bn_limb_t *v, int vn)
+{
+    bn_limb_t vtop = v[vn - 1];
+    bn_limb_t vnext = v[vn - 2];
+
+    for (int j = un - vn - 1; j >= 0; j--)
+    {
+        u128 num = ((u128)u[j + vn] << 64) | u[j + vn - 1];
+        u128 qhat, rhat;
+        bn_limb_t top, borrow;
+
+        if (u[j + vn] >= vtop)
+        {
+            qhat = ~(bn_limb_t)0;
+            rhat = num - qhat * vtop;
+        }
+        else
+        {
+            qhat = num / vtop;
+            rhat = num % vtop;
+        }
+        /* at most 2 too big after this, usually right */
+        while ((rhat >> 64) == 0 &&
+               qhat * vnext > ((rhat << 64) | u[j + vn - 2]))
+        {
+            qhat--;
+            rhat += vtop;
+        }
+
+        borrow = limbs_submul_1(u + j, v, vn, (bn_limb_t)qhat);
+        top = u[j + vn];
+        u[j + vn] = top - borrow;
+        if (top < borrow)
+        {
+            /* one too big, add back */
+            qhat--;
+            u[j + vn] += limbs_add(u + j, u + j, vn, v, vn);
+        }
+        q[j] = (bn_limb_t)qhat;
+    }
+}
+
+static void div_3n2n(bn_arena_t *ar, bn_limb_t *q, bn_limb_t *r,
+                     const bn_limb_t *a, const bn_limb_t *b, int h);
+
+/* Burnikel-Ziegler. a has 2n limbs, b has n limbs with the top bit set, and
+ * the high n limbs of a are less than b. Sets the n limbs of q and r. */
+static void div_2n1n(bn_arena_t *ar, bn_limb_t *q, bn_limb_t *r,
+                     const bn_limb_t *a, const bn_limb_t *b, int n)
+{
+    bn_arena_mark_t mark = bn_arena_mark(ar);
+
+    if (n == 1)
+    {
+        u128 num = ((u128)a[1] << 64) | a[0];
+        q[0] = (bn_limb_t)(num / b[0]);
+        r[0] = (bn_limb_t)(num % b[0]);
+    }
+    else if ((n & 1) || n < bz_threshold)
+    {
+        bn_limb_t *u = limbs_alloc(ar, 2 * n);
+        memcpy(u, a, 2 * n * LIMB_BYTES);
+        div_school(q, u, 2 * n, b, n);
+        memcpy(r, u, n * LIMB_BYTES);
+    }
+    else
+    {
+        int h = n / 2;
+        bn_limb_t *r1 = limbs_alloc(ar, n);
+        bn_limb_t *t = limbs_alloc(ar, 3 * h);
+
+        /* the top three quarters of a, giving the high half of q */
+        div_3n2n(ar, q + h, r1, a + h, b, h);
+        /* then that remainder and the last quarter */
+        memcpy(t, a, h * LIMB_BYTES);
+        memcpy(t + h, r1, n * LIMB_BYTES);
+        div_3n2n(ar, q, r, t, b, h);
+    }
+
+    bn_arena_release(ar, mark);
+}
+
+/* a has 3h limbs, b has 2h limbs with the top bit set, and the high 2h
+ * limbs of a are less than b. Sets the h limbs of q and 2h limbs of r.
+ * The quotient is estimated from the high halves (never too small, and at
+ * most 2 too big) then corrected. */
+static void div_3n2n(bn_arena_t *ar, bn_limb_t *q, bn_limb_t *r,
+                     const bn_limb_t *a, const bn_limb_t *b, int h)
+{
+    bn_arena_mark_t mark = bn_arena_mark(ar);
+    const bn_limb_t *b1 = b + h;
+    /* the remainder, one limb extra as it can go negative */
+    bn_limb_t *rr = limbs_alloc(ar, 2 * h + 1);
+    bn_limb_t *d = limbs_alloc(ar, 2 * h);
+    bool neg;
+
+    memcpy(rr, a, h * LIMB_BYTES);
+    if (limbs_cmp(a + 2 * h, b1, h) < 0)
+    {
+        div_2n1n(ar, q, rr + h, a + h, b1, h);
+        rr[2 * h] = 0;
+    }
+    else
+    {
+        /* the high half of a must be equal to b1, q = B^h - 1 and the
+         * remainder of the high halves is a1 + b1 */
+        memset(q, 0xff, h * LIMB_BYTES);
+        rr[2 * h] = limbs_add(rr + h, a + h, h, b1, h);
+    }
+
+    limbs_mul(ar, d, q, h, b, h);
+    neg = limbs_sub(rr, rr, 2 * h + 1, d, 2 * h) != 0;
+    while (neg)
+    {
+        bn_limb_t one = 1;
+        limbs_sub(q, q, h, &one, 1);
+        /* a carry out of the top means it's back to positive */
+        neg = limbs_add(rr, rr, 2 * h + 1, b, 2 * h) == 0;
+    }
+    memcpy(r, rr, 2 * h * LIMB_BYTES);
+
+    bn_arena_release(ar, mark);
+}
+
+/* q = a / b, r = a % b. an >= bn, b has no high zero limbs. q has
+ * an - bn + 1 limbs and r has bn limbs. */
+static void limbs_divmod(bn_arena_t *ar, bn_limb_t *q, bn_limb_t *r,
+                         const bn_limb_t *a, int an,
+                         const bn_limb_t *b, int bn)
+{
+    bn_arena_mark_t mark = bn_arena_mark(ar);
+    bn_limb_t *vs;
+    int s;
+
+    if (bn == 1)
+    {
+        r[0] = limbs_divmod_1(q, a, an, b[0]);
+        return;
+    }
+
+    /* normalise so the top bit of the divisor is set */
+    s = __builtin_clzll(b[bn - 1]);
+    vs = limbs_alloc(ar, bn);
+    limbs_lshift(vs, b, bn, s);
+
+    if (bn < bz_threshold)
+    {
+        bn_limb_t *u = limbs_alloc(ar, an + 1);
+        u[an] = limbs_lshift(u, a, an, s);
+        div_school(q, u, an + 1, vs, bn);
+        limbs_rshift(r, u, bn, s);
+    }
+    else
+    {
+        /* Blocks of n limbs, where n is the divisor size rounded up to a
+         * number that halves evenly down to below the threshold. The
+         * divisor is padded with zero limbs at the bottom to make it n
+         * limbs, the dividend with the same number. */
+        int j = bn;
+        int k = 0;
+        int n, pad, t;
+        bn_limb_t *bb, *u, *qq, *z, *rem;
+
+        while (j >= bz_threshold)
+        {
+            j = (j + 1) / 2;
+            k++;
+        }
+        n = j << k;
+        pad = n - bn;
+        t = (an + 1 + pad + n - 1) / n;
+
+        bb = limbs_alloc(ar, n);
+        u = limbs_alloc(ar, t * n);
+        qq = limbs_alloc(ar, t * n);
+        z = limbs_alloc(ar, 2 * n);
+        rem = limbs_alloc(ar, n);
+        memset(bb, 0, pad * LIMB_BYTES);
+        memcpy(bb + pad, vs, bn * LIMB_BYTES);
+        memset(u, 0, (size_t)t * n * LIMB_BYTES);
+        u[an + pad] = limbs_lshift(u + pad, a, an, s);
+        memset(rem, 0, n * LIMB_BYTES);
+
+        /* a block at a time from the top, each with the remainder so far */
+        for (int i = t - 1; i >= 0; i--)
+        {
+            memcpy(z, u + (size_t)i * n, n * LIMB_BYTES);
+            memcpy(z + n, rem, n * LIMB_BYTES);
+            div_2n1n(ar, qq + (size_t)i * n, rem, z, bb, n);
+        }
+        memcpy(q, qq, (an - bn + 1) * LIMB_BYTES);
+        limbs_rshift(r, rem + pad, bn, s);
+    }
+
+    bn_arena_release(ar, mark);
+}
+
+
+/****************************************************************************
+ * Signed values
+ */
+
+/* set r to the n limbs at d, dropping high zero limbs */
+static void bn_set(bn_t *r, bn_limb_t *d, int n, bool neg)
+{
+    n = limbs_norm(d, n);
+    r->d = d;
+    r->n = n;
+    r->neg = n > 0 && neg;
+}
+
+static void bn_copy(bn_arena_t *ar, bn_t *r, const bn_t *a, bool neg)
+{
+    bn_limb_t *d = limbs_alloc(ar, a->n);
+    if (a->n > 0)
+    {
+        memcpy(d, a->d, a->n * LIMB_BYTES);
+    }
+    bn_set(r, d, a->n, neg);
+}
+
+/* compare magnitudes */
+static int cmp_mag(const bn_t *a, const bn_t *b)
+{
+    if (a->n != b->n)
+    {
+        return a->n < b->n ? -1 : 1;
+    }
+    return limbs_cmp(a->d, b->d, a->n);
+}
+
+void bn_zero(bn_t *r)
+{
+    r->d = NULL;
+    r->n = 0;
+    r->neg = false;
+}
+
+void bn_from_u128(bn_arena_t *ar, bn_t *r, unsigned __int128 val)
+{
+    bn_limb_t *d = limbs_alloc(ar, 2);
+    d[0] = (bn_limb_t)val;
+    d[1] = (bn_limb_t)(val >> 64);
+    bn_set(r, d, 2, false);
+}
+
+void bn_from_s128(bn_arena_t *ar, bn_t *r, __int128 val)
+{
+    unsigned __int128 mag = val < 0 ? -(unsigned __int128)val : (unsigned __int128)val;
+    bn_from_u128(ar, r, mag);
+    r->neg = val < 0;
+}
+
+unsigned __int128 bn_to_u128(const bn_t *a)
+{
+    unsigned __int128 v = 0;
+
+    if (a->n > 0)
+    {
+        v = a->d[0];
+    }
+    if (a->n > 1)
+    {
+        v |= (unsigned __int128)a->d[1] << 64;
+    }
+    return a->neg ? -v : v;
+}
+
+bool bn_is_zero(const bn_t *a)
+{
+    return a->n == 0;
+}
+
+int bn_cmp(const bn_t *a, const bn_t *b)
+{
+    if (a->neg != b->neg)
+    {
+        return a->neg ? -1 : 1;
+    }
+    return a->neg ? -cmp_mag(a, b) : cmp_mag(a, b);
+}
+
+long bn_bit_length(const bn_t *a)
+{
+    if (a->n == 0)
+    {
+        return 0;
+    }
+    return (long)a->n * 64 - __builtin_clzll(a->d[a->n - 1]);
+}
+
+void bn_neg(bn_arena_t *ar, bn_t *r, const bn_t *a)
+{
+    bn_copy(ar, r, a, !a->neg);
+}
+
+/* r = a + b where a and b have signs aneg and bneg */
+static void add_signed(bn_arena_t *ar, bn_t *r,
+                       const bn_t *a, bool aneg, const bn_t *b, bool bneg)
+{
+    bn_limb_t *d;
+
+    if (aneg == bneg)
+    {
+        if (a->n < b->n)
+        {
+            const bn_t *t = a;
+            a = b;
+            b = t;
+        }
+        d = limbs_alloc(ar, a->n + 1);
+        d[a->n] = limbs_add(d, a->d, a->n, b->d, b->n);
+        bn_set(r, d, a->n + 1, aneg);
+    }
+    else if (cmp_mag(a, b) >= 0)
+    {
+        d = limbs_alloc(ar, a->n);
+        limbs_sub(d, a->d, a->n, b->d, b->n);
+        bn_set(r, d, a->n, aneg);
+    }
+    else
+    {
+        d = limbs_alloc(ar, b->n);
+        limbs_sub(d, b->d, b->n, a->d, a->n);
+        bn_set(r, d, b->n, bneg);
+    }
+}
+
+void bn_add(bn_arena_t *ar, bn_t *r, const bn_t *a, const bn_t *b)
+{
+    add_signed(ar, r, a, a->neg, b, b->neg);
+}
+
+void bn_sub(bn_arena_t *ar, bn_t *r, const bn_t *a, const bn_t *b)
+{
+    add_signed(ar, r, a, a->neg, b, !b->neg);
+}
+
+/* r = a + v for a small v >= 0 */
+static void add_small(bn_arena_t *ar, bn_t *r, const bn_t *a, bn_limb_t v)
+{
+    bn_t t;
+    t.d = &v;
+    t.n = v != 0;
+    t.neg = false;
+    bn_add(ar, r, a, &t);
+}
+
+bool bn_mul(bn_arena_t *ar, bn_t *r, const bn_t *a, const bn_t *b)
+{
+    bn_limb_t *d;
+
+    if (a->n == 0 || b->n == 0)
+    {
+        bn_zero(r);
+        return true;
+    }
+    if (bn_bit_length(a) + bn_bit_length(b) - 1 > BN_MAX_BITS)
+    {
+        return false;
+    }
+    d = limbs_alloc(ar, a->n + b->n);
+    limbs_mul(ar, d, a->d, a->n, b->d, b->n);
+    bn_set(r, d, a->n + b->n, a->neg != b->neg);
+    return true;
+}
+
+bool bn_divmod(bn_arena_t *ar, bn_t *q, bn_t *rem,
+               const bn_t *a, const bn_t *b)
+{
+    bn_t qt, rt;
+
+    if (b->n == 0)
+    {
+        return false;
+    }
+    if (cmp_mag(a, b) < 0)
+    {
+        bn_zero(&qt);
+        rt = *a;
+    }
+    else
+    {
+        bn_limb_t *qd = limbs_alloc(ar, a->n - b->n + 1);
+        bn_limb_t *rd = limbs_alloc(ar, b->n);
+        limbs_divmod(ar, qd, rd, a->d, a->n, b->d, b->n);
+        bn_set(&qt, qd, a->n - b->n + 1, a->neg != b->neg);
+        bn_set(&rt, rd, b->n, a->neg);
+    }
+    if (q != NULL)
+    {
+        *q = qt;
+    }
+    if (rem != NULL)
+    {
+        *rem = rt;
+    }
+    return true;
+}
+
+bool bn_pow(bn_arena_t *ar, bn_t *r, const bn_t *a, unsigned long e)
+{
+    long bits = bn_bit_length(a);
+    bn_t acc;
+    int top;
+
+    if (e == 0)
+    {
+        bn_from_u128(ar, r, 1);
+        return true;
+    }
+    if (bits > 1 && (unsigned long)(bits - 1) > BN_MAX_BITS / e)
+    {
+        return false;
+    }
+
+    /* left to right binary */
+    acc = *a;
+    top = 63 - __builtin_clzll(e);
+    for (int i = top - 1; i >= 0; i--)
+    {
+        if (!bn_mul(ar, &acc, &acc, &acc))
+        {
+            return false;
+        }
+        if ((e >> i) & 1)
+        {
+            if (!bn_mul(ar, &acc, &acc, a))
+            {
+                return false;
+            }
+        }
+    }
+    *r = acc;
+    return true;
+}
+
+/* a mod m for m > 0, in 0 to m - 1 */
+static void mod_positive(bn_arena_t *ar, bn_t *r, const bn_t *a, const bn_t *m)
+{
+    bn_t t;
+    bn_divmod(ar, NULL, &t, a, m);
+    if (t.neg)
+    {
+        bn_add(ar, &t, &t, m);
+    }
+    *r = t;
+}
+
+bool bn_powmod(bn_arena_t *ar, bn_t *r,
+               const bn_t *a, const bn_t *e, const bn_t *m)
+{
+    bn_t mm, base, acc;
+    bn_limb_t *buf[2];
+    int which = 0;
+
+    if (e->neg || m->n == 0)
+    {
+        return false;
+    }
+    mm = *m;
+    mm.neg = false;
+
+    mod_positive(ar, &base, a, &mm);
+    bn_from_u128(ar, &acc, 1);
+    mod_positive(ar, &acc, &acc, &mm);
+
+    /* each step's result is copied to one of two buffers, and the rest of
+     * the space it used released */
+    buf[0] = limbs_alloc(ar, mm.n);
+    buf[1] = limbs_alloc(ar, mm.n);
+    for (long i = bn_bit_length(e) - 1; i >= 0; i--)
+    {
+        bn_arena_mark_t mark = bn_arena_mark(ar);
+        bn_t t;
+
+        bn_mul(ar, &t, &acc, &acc);
+        mod_positive(ar, &t, &t, &mm);
+        if ((e->d[i / 64] >> (i % 64)) & 1)
+        {
+            bn_mul(ar, &t, &t, &base);
+            mod_positive(ar, &t, &t, &mm);
+        }
+        if (t.n > 0)
+        {
+            memcpy(buf[which], t.d, t.n * LIMB_BYTES);
+        }
+        bn_arena_release(ar, mark);
+        bn_set(&acc, buf[which], t.n, false);
+        which ^= 1;
+    }
+    *r = acc;
+    return true;
+}
+
+/* product of lo to hi, as a tree so the big multiplications are of
+ * similar sizes */
+static void product_range(bn_arena_t *ar, bn_t *r,
+                          unsigned long lo, unsigned long hi)
+{
+    if (hi - lo < 32)
+    {
+        bn_limb_t *d = limbs_alloc(ar, (int)(hi - lo) + 2);
+        int n = 1;
+        d[0] = 1;
+        for (unsigned long k = lo; k <= hi; k++)
+        {
+            bn_limb_t c = limbs_mul_1(d, d, n, k);
+            if (c)
+            {
+                d[n++] = c;
+            }
+        }
+        bn_set(r, d, n, false);
+    }
+    else
+    {
+        unsigned long mid = lo + (hi - lo) / 2;
+        bn_t a, b;
+        product_range(ar, &a, lo, mid);
+        product_range(ar, &b, mid + 1, hi);
+        bn_mul(ar, r, &a, &b);
+    }
+}
+
+bool bn_factorial(bn_arena_t *ar, bn_t *r, unsigned long n)
+{
+    if (n < 2)
+    {
+        bn_from_u128(ar, r, 1);
+        return true;
+    }
+    /* log2(n!) */
+    if (lgamma((double)n + 1) / log(2.0) > BN_MAX_BITS)
+    {
+        return false;
+    }
+    product_range(ar, r, 2, n);
+    return true;
+}
+
+void bn_gcd(bn_arena_t *ar, bn_t *r, const bn_t *a, const bn_t *b)
+{
+    int size = a->n > b->n ? a->n : b->n;
+    bn_limb_t *buf[2];
+    bn_t x, y;
+    int which = 0;
+
+    /* Euclid, with the values kept in two buffers and the space each
+     * division uses released */
+    buf[0] = limbs_alloc(ar, size);
+    buf[1] = limbs_alloc(ar, size);
+    x = *a;
+    x.neg = false;
+    y = *b;
+    y.neg = false;
+    while (y.n != 0)
+    {
+        bn_arena_mark_t mark = bn_arena_mark(ar);
+        bn_t t;
+        bn_divmod(ar, NULL, &t, &x, &y);
+        if (t.n > 0)
+        {
+            memcpy(buf[which], t.d, t.n * LIMB_BYTES);
+        }
+        bn_arena_release(ar, mark);
+        x = y;
+        bn_set(&y, buf[which], t.n, false);
+        which ^= 1;
+    }
+    bn_copy(ar, r, &x, false);
+}
+
+bool bn_shl(bn_arena_t *ar, bn_t *r, const bn_t *a, unsigned long n)
+{
+    int limbs, d_n;
+    bn_limb_t *d;
+
+    if (a->n == 0)
+    {
+        bn_zero(r);
+        return true;
+    }
+    if (n > BN_MAX_BITS || bn_bit_length(a) + (long)n > BN_MAX_BITS)
+    {
+        return false;
+    }
+    limbs = (int)(n / 64);
+    d_n = a->n + limbs + 1;
+    d = limbs_alloc(ar, d_n);
+    memset(d, 0, limbs * LIMB_BYTES);
+    d[d_n - 1] = limbs_lshift(d + limbs, a->d, a->n, (int)(n % 64));
+    bn_set(r, d, d_n, a->neg);
+    return true;
+}
+
+/* magnitude of a shifted right n bits */
+static void shr_mag(bn_arena_t *ar, bn_t *r, const bn_t *a, unsigned long n)
+{
+    unsigned long limbs = n / 64;
+    bn_limb_t *d;
+    int d_n;
+
+    if (limbs >= (unsigned long)a->n)
+    {
+        bn_zero(r);
+        return;
+    }
+    d_n = a->n - (int)limbs;
+    d = limbs_alloc(ar, d_n);
+    limbs_rshift(d, a->d + limbs, d_n, (int)(n % 64));
+    bn_set(r, d, d_n, false);
+}
+
+void bn_shr(bn_arena_t *ar, bn_t *r, const bn_t *a, unsigned long n)
+{
+    if (!a->neg)
+    {
+        shr_mag(ar, r, a, n);
+    }
+    else
+    {
+        /* floor(a / 2^n) = -(((|a| - 1) >> n) + 1) */
+        bn_t t = *a;
+        t.neg = false;
+        add_signed(ar, &t, &t, false, &(bn_t){ .d = (bn_limb_t[]){ 1 }, .n = 1, .neg = false }, true);
+        shr_mag(ar, &t, &t, n);
+        add_small(ar, &t, &t, 1);
+        t.neg = true;
+        *r = t;
+    }
+}
+
+/* a as twos complement in n limbs */
+static void to_twos(bn_limb_t *d, const bn_t *a, int n)
+{
+    memset(d, 0, n * LIMB_BYTES);
+    if (a->n > 0)
+    {
+        memcpy(d, a->d, a->n * LIMB_BYTES);
+    }
+    if (a->neg)
+    {
+        bn_limb_t c = 1;
+        for (int i = 0; i < n; i++)
+        {
+            d[i] = ~d[i] + c;
+            c = c && d[i] == 0;
+        }
+    }
+}
+
+/* r from n limbs of twos complement (which are changed) */
+static void from_twos(bn_t *r, bn_limb_t *d, int n)
+{
+    bool neg = d[n - 1] >> 63;
+    if (neg)
+    {
+        bn_limb_t c = 1;
+        for (int i = 0; i < n; i++)
+        {
+            d[i] = ~d[i] + c;
+            c = c && d[i] == 0;
+        }
+    }
+    bn_set(r, d, n, neg);
+}
+
+typedef enum
+{
+    bit_and,
+    bit_or,
+    bit_xor,
+} bit_op_enum;
+
+static void bitwise(bn_arena_t *ar, bn_t *r, const bn_t *a, const bn_t *b,
+                    bit_op_enum op)
+{
+    /* one limb more than either for the sign */
+    int n = (a->n > b->n ? a->n : b->n) + 1;
+    bn_limb_t *da = limbs_alloc(ar, n);
+    bn_limb_t *db = limbs_alloc(ar, n);
+
+    to_twos(da, a, n);
+    to_twos(db, b, n);
+    for (int i = 0; i < n; i++)
+    {
+        switch (op)
+        {
+        case bit_and:
+            da[i] &= db[i];
+            break;
+        case bit_or:
+            da[i] |= db[i];
+            break;
+        default:
+            da[i] ^= db[i];
+            break;
+        }
+    }
+    from_twos(r, da, n);
+}
+
+void bn_and(bn_arena_t *ar, bn_t *r, const bn_t *a, const bn_t *b)
+{
+    bitwise(ar, r, a, b, bit_and);
+}
+
+void bn_or(bn_arena_t *ar, bn_t *r, const bn_t *a, const bn_t *b)
+{
+    bitwise(ar, r, a, b, bit_or);
+}
+
+void bn_xor(bn_arena_t *ar, bn_t *r, const bn_t *a, const bn_t *b)
+{
+    bitwise(ar, r, a, b, bit_xor);
+}
+
+void bn_not(bn_arena_t *ar, bn_t *r, const bn_t *a)
+{
+    /* ~a = -a - 1 */
+    bn_t t;
+    bn_neg(ar, &t, a);
+    add_signed(ar, r, &t, t.neg, &(bn_t){ .d = (bn_limb_t[]){ 1 }, .n = 1, .neg = false }, true);
+}
+
+
+/****************************************************************************
+ * Conversion to and from strings
+ *
+ * Decimal is done in chunks of 19 digits (the most that fit in a limb),
+ * and above BN_RADIX_DC_THRESHOLD limbs by splitting the number in two
+ * with a power 10^(19 * 2^k), so the cost is that of the fast division or
+ * multiplication rather than quadratic.
+ */
+
+#define DEC_CHUNK 19
+#define DEC_CHUNK_POW 10000000000000000000ULL
+#define MAX_DEC_POWS 32
+
+static const char digit_chars[] = "0123456789ABCDEF";
+
+/* pow[k] = 10^(19 * 2^k) */
+typedef struct
+{
+    bn_t pow[MAX_DEC_POWS];
+    int num;
+} dec_pows_t;
+
+/* Make the powers up to k. Done before any arena marks, they are used
+ * all the way down the recursion. */
+static void make_dec_pows(bn_arena_t *ar, dec_pows_t *dp, int k)
+{
+    dp->num = 0;
+    while (dp->num <= k && dp->num < MAX_DEC_POWS)
+    {
+        if (dp->num == 0)
+        {
+            bn_from_u128(ar, &dp->pow[0], DEC_CHUNK_POW);
+        }
+        else
+        {
+            bn_mul(ar, &dp->pow[dp->num], &dp->pow[dp->num - 1],
+                   &dp->pow[dp->num - 1]);
+        }
+        dp->num++;
+    }
+}
+
+/* largest k with 2^(k+1) <= n, for n >= 2 */
+static int half_pow(size_t n)
+{
+    int k = 0;
+    while (((size_t)2 << (k + 1)) <= n)
+    {
+        k++;
+    }
+    return k;
+}
+
+/* write a >= 0 as exactly width decimal digits at p, zero padded */
+static void put_dec(bn_arena_t *ar, const dec_pows_t *dp, char *p,
+                    size_t width, const bn_t *a)
+{
+    int k;
+
+    if (a->n <= radix_dc_threshold || a->n < 2 || width <= 2 * DEC_CHUNK)
+    {
+        bn_arena_mark_t mark = bn_arena_mark(ar);
+        bn_limb_t *t = limbs_alloc(ar, a->n);
+        int n = a->n;
+        char *e = p + width;
+
+        if (n > 0)
+        {
+            memcpy(t, a->d, n * LIMB_BYTES);
+        }
+        while (n > 0 && e > p)
+        {
+            bn_limb_t rem = limbs_divmod_1(t, t, n, DEC_CHUNK_POW);
+            n = limbs_norm(t, n);
+            for (int i = 0; i < DEC_CHUNK && e > p; i++)
+            {
+                *--e = (char)('0' + rem % 10);
+                rem /= 10;
+            }
+        }
+        memset(p, '0', e - p);
+        bn_arena_release(ar, mark);
+        return;
+    }
+
+    /* low part about half the digits of a */
+    k = half_pow(a->n);
+    while (k > 0 && ((size_t)DEC_CHUNK << k) >= width)
+    {
+        k--;
+    }
+    if (k >= dp->num)
+    {
+        k = dp->num - 1;
+    }
+
+    {
+        bn_arena_mark_t mark = bn_arena_mark(ar);
+        size_t low = (size_t)DEC_CHUNK << k;
+        bn_t q, r;
+
+        bn_divmod(ar, &q, &r, a, &dp->pow[k]);
+        put_dec(ar, dp, p, width - low, &q);
+        put_dec(ar, dp, p + width - low, low, &r);
+        bn_arena_release(ar, mark);
+    }
+}
+
+/* the value of len decimal digits at s */
+static void get_dec(bn_arena_t *ar, const dec_pows_t *dp, bn_t *r,
+                    const char *s, size_t len)
+{
+    if (len <= (size_t)DEC_CHUNK * radix_dc_threshold || len <= 2 * DEC_CHUNK)
+    {
+        bn_limb_t *d = limbs_alloc(ar, (int)(len / DEC_CHUNK) + 2);
+        int n = 0;
+        size_t first = len % DEC_CHUNK ? len % DEC_CHUNK : DEC_CHUNK;
+
+        for (size_t i = 0; i < len; )
+        {
+            size_t chunk = i == 0 ? first : DEC_CHUNK;
+            bn_limb_t v = 0;
+            bn_limb_t c;
+            for (size_t j = 0; j < chunk; j++)
+            {
+                v = v * 10 + (bn_limb_t)(s[i + j] - '0');
+            }
+            c = limbs_mul_1(d, d, n, DEC_CHUNK_POW);
+            if (c)
+            {
+                d[n++] = c;
+            }
+            c = limbs_add(d, d, n, &v, n > 0 ? 1 : 0);
+            if (n == 0)
+            {
+                d[n++] = v;
+            }
+            else if (c)
+            {
+                d[n++] = c;
+            }
+            i += chunk;
+        }
+        bn_set(r, d, n, false);
+    }
+    else
+    {
+        /* the low part 19 * 2^k digits, about half */
+        int k = half_pow(len / DEC_CHUNK);
+        size_t low;
+        bn_t hi, lo;
+
+        if (k >= dp->num)
+        {
+            k = dp->num - 1;
+        }
+        low = (size_t)DEC_CHUNK << k;
+        get_dec(ar, dp, &hi, s, len - low);
+        get_dec(ar, dp, &lo, s + len - low, low);
+        bn_mul(ar, &hi, &hi, &dp->pow[k]);
+        bn_add(ar, r, &hi, &lo);
+    }
+}
+
+static int bits_per_digit(int base)
+{
+    switch (base)
+    {
+    case 2:
+        return 1;
+    case 8:
+        return 3;
+    case 16:
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+char *bn_to_string(bn_arena_t *ar, const bn_t *a, int base)
+{
+    long bits = bn_bit_length(a);
+    int dbits = bits_per_digit(base);
+    size_t width;
+    char *buf, *p;
+
+    if (dbits == 0)
+    {
+        /* decimal, at most bits * log10(2) + 1 digits */
+        bn_t mag = *a;
+        dec_pows_t dp;
+
+        mag.neg = false;
+        width = (size_t)(bits * 0.30102999566398120) + 1;
+        buf = bn_arena_alloc(ar, width + 2);
+        make_dec_pows(ar, &dp, a->n >= 2 ? half_pow(a->n) : 0);
+        put_dec(ar, &dp, buf + 1, width, &mag);
+    }
+    else
+    {
+        width = bits ? (size_t)(bits + dbits - 1) / dbits : 1;
+        buf = bn_arena_alloc(ar, width + 2);
+        for (size_t i = 0; i < width; i++)
+        {
+            /* digit i from the bottom */
+            size_t pos = i * dbits;
+            size_t limb = pos / 64;
+            int shift = (int)(pos % 64);
+            unsigned v = 0;
+
+            if (limb < (size_t)a->n)
+            {
+                v = (unsigned)(a->d[limb] >> shift);
+                if (shift + dbits > 64 && limb + 1 < (size_t)a->n)
+                {
+                    v |= (unsigned)(a->d[limb + 1] << (64 - shift));
+                }
+            }
+            buf[1 + width - 1 - i] = digit_chars[v & ((1u << dbits) - 1)];
+        }
+    }
+    buf[width + 1] = 0;
+
+    /* no leading zeros, but at least one digit */
+    p = buf + 1;
+    while (*p == '0' && p[1] != 0)
+    {
+        p++;
+    }
+    if (a->neg)
+    {
+        *--p = '-';
+    }
+    return p;
+}
+
+static int digit_val(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return 99;
+}
+
+bool bn_from_string(bn_arena_t *ar, bn_t *r, const char *str, size_t len,
+                    int base)
+{
+    int dbits = bits_per_digit(base);
+
+    if (len == 0)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < len; i++)
+    {
+        if (digit_val(str[i]) >= base)
+        {
+            return false;
+        }
+    }
+    /* skip leading zeros so they don't count towards the size */
+    while (len > 1 && *str == '0')
+    {
+        str++;
+        len--;
+    }
+
+    if (dbits == 0)
+    {
+        dec_pows_t dp;
+        if (len > (size_t)(BN_MAX_BITS * 0.30102999566398120) + 1)
+        {
+            return false;
+        }
+        make_dec_pows(ar, &dp, half_pow(len / DEC_CHUNK + 2));
+        get_dec(ar, &dp, r, str, len);
+    }
+    else
+    {
+        int n;
+        bn_limb_t *d;
+
+        if (len > (size_t)BN_MAX_BITS / dbits)
+        {
+            return false;
+        }
+        n = (int)((len * dbits + 63) / 64);
+        d = limbs_alloc(ar, n);
+        memset(d, 0, n * LIMB_BYTES);
+        for (size_t i = 0; i < len; i++)
+        {
+            /* digit i from the bottom */
+            bn_limb_t v = (bn_limb_t)digit_val(str[len - 1 - i]);
+            size_t pos = i * dbits;
+            size_t limb = pos / 64;
+            int shift = (int)(pos % 64);
+
+            d[limb] |= v << shift;
+            if (shift + dbits > 64)
+            {
+                d[limb + 1] |= v >> (64 - shift);
+            }
+        }
+        bn_set(r, d, n, false);
+    }
+    return true;
+}
@@ -0,0 +1,156 @@
+/*****************************************************************************
+ * File bignum.h part of ProgAndSciCalc
+ *
+ * Copyright (C) 2018 Ken Bromham
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef BIGNUM_H
+#define BIGNUM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Arbitrary precision signed integers.
+ *
+ * A value is an array of 64 bit limbs (least significant first) holding the
+ * magnitude, plus a sign. The limbs are allocated from an arena, and every
+ * operation allocates a new result, so values are never modified once
+ * made and one value can be used as both an argument and the result. All
+ * the values (and the temporary space the operations need) are freed
+ * together by freeing or releasing the arena.
+ *
+ * Multiplication is schoolbook for small numbers, Karatsuba above
+ * BN_KARATSUBA_THRESHOLD limbs and a number theoretic transform above
+ * BN_NTT_THRESHOLD limbs. Division is Knuth's algorithm D for small
+ * divisors and Burnikel-Ziegler recursive division above
+ * BN_BZ_THRESHOLD limbs. Conversion to and from decimal splits the number
+ * in halves by powers of 10 so it also benefits from the fast
+ * multiplication and division.
+ */
+
+typedef uint64_t bn_limb_t;
+
+typedef struct
+{
+    bn_limb_t *d;
+    /* number of limbs in use, no high zero limbs, 0 for the value 0 */
+    int n;
+    /* never set for 0 */
+    bool neg;
+} bn_t;
+
+/* The largest result allowed, in bits. Operations that would go over it
+ * fail instead, so a typo can't try to make a number the size of memory. */
+#define BN_MAX_BITS (1 << 24)
+
+/* default thresholds, in limbs */
+#define BN_KARATSUBA_THRESHOLD 32
+#define BN_NTT_THRESHOLD 1500
+#define BN_BZ_THRESHOLD 48
+/* decimal conversion splits numbers above this many limbs */
+#define BN_RADIX_DC_THRESHOLD 30
+
+
+typedef struct bn_arena_block bn_arena_block;
+
+typedef struct
+{
+    bn_arena_block *head;
+} bn_arena_t;
+
+typedef struct
+{
+    bn_arena_block *block;
+    size_t used;
+} bn_arena_mark_t;
+
+/* An arena must be initialised before use and freed when done with. If
+ * memory runs out the program exits. */
+void bn_arena_init(bn_arena_t *ar);
+void bn_arena_free(bn_arena_t *ar);
+void *bn_arena_alloc(bn_arena_t *ar, size_t size);
+
+/* Release everything allocated since the mark */
+bn_arena_mark_t bn_arena_mark(bn_arena_t *ar);
+void bn_arena_release(bn_arena_t *ar, bn_arena_mark_t mark);
+
+
+/* Change the thresholds, only intended for testing, 0 for the default */
+void bn_set_thresholds(int karatsuba, int ntt, int bz, int radix_dc);
+
+void bn_zero(bn_t *r);
+void bn_from_u128(bn_arena_t *ar, bn_t *r, unsigned __int128 val);
+void bn_from_s128(bn_arena_t *ar, bn_t *r, __int128 val);
+
+/* The low 128 bits of a, twos complement if a is negative */
+unsigned __int128 bn_to_u128(const bn_t *a);
+
+bool bn_is_zero(const bn_t *a);
+/* -1, 0, 1 as a < b, a == b, a > b */
+int bn_cmp(const bn_t *a, const bn_t *b);
+/* number of bits in the magnitude, 0 for 0 */
+long bn_bit_length(const bn_t *a);
+
+void bn_neg(bn_arena_t *ar, bn_t *r, const bn_t *a);
+void bn_add(bn_arena_t *ar, bn_t *r, const bn_t *a, const bn_t *b);
+void bn_sub(bn_arena_t *ar, bn_t *r, const bn_t *a, const bn_t *b);
+bool bn_mul(bn_arena_t *ar, bn_t *r, const bn_t *a, const bn_t *b);
+
+/* Truncating division as C, remainder has the sign of a. Either of q and
+ * rem can be NULL. Returns false for divide by 0. */
+bool bn_divmod(bn_arena_t *ar, bn_t *q, bn_t *rem,
+               const bn_t *a, const bn_t *b);
+
+/* a to the power e, false if the result would be over BN_MAX_BITS */
+bool bn_pow(bn_arena_t *ar, bn_t *r, const bn_t *a, unsigned long e);
+
+/* a to the power e mod m, result from 0 to |m| - 1. False if e is
+ * negative or m is 0. */
+bool bn_powmod(bn_arena_t *ar, bn_t *r,
+               const bn_t *a, const bn_t *e, const bn_t *m);
+
+/* n!, false if the result would be over BN_MAX_BITS */
+bool bn_factorial(bn_arena_t *ar, bn_t *r, unsigned long n);
+
+/* greatest common divisor, never negative */
+void bn_gcd(bn_arena_t *ar, bn_t *r, const bn_t *a, const bn_t *b);
+
+/* Shifts, right shift of a negative value rounds towards minus infinity
+ * as for an arithmetic shift. Left shift fails if the result would be
+ * over BN_MAX_BITS. */
+bool bn_shl(bn_arena_t *ar, bn_t *r, const bn_t *a, unsigned long n);
+void bn_shr(bn_arena_t *ar, bn_t *r, const bn_t *a, unsigned long n);
+
+/* Bitwise operations as if the values were twos complement of infinite
+ * width */
+void bn_and(bn_arena_t *ar, bn_t *r, const bn_t *a, const bn_t *b);
+void bn_or(bn_arena_t *ar, bn_t *r, const bn_t *a, const bn_t *b);
+void bn_xor(bn_arena_t *ar, bn_t *r, const bn_t *a, const bn_t *b);
+void bn_not(bn_arena_t *ar, bn_t *r, const bn_t *a);
+
+/* Convert to a string in base 2, 8, 10 or 16, with a leading '-' if
+ * negative. The string is allocated from the arena. */
+char *bn_to_string(bn_arena_t *ar, const bn_t *a, int base);
+
+/* Convert len digits of str (no sign, no prefix) in base 2, 8, 10 or 16.
+ * Returns false if any of them isn't a digit of the base, or the value
+ * would be over BN_MAX_BITS. */
+bool bn_from_string(bn_arena_t *ar, bn_t *r, const char *str, size_t len,
+                    int base);
+
+#endif
@@ -0,0 +1,423 @@
+/*****************************************************************************
+ * File bitops.c part of ProgAndSciCalc
+ *
+ * Copyright (C) 2018 Ken Bromham
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdint.h>
+
+#include "bitops.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define BITOPS_X86
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+typedef unsigned __int128 u128;
+
+/* The 64 bit operations, the 128 bit ones are made from two of these.
+ * clz64 and ctz64 give 64 for 0. fast_pdep is true when pdep64 and pext64
+ * are instructions, otherwise the Morton ops use their own shift and mask
+ * versions which beat the general bit at a time loop. */
+typedef struct
+{
+    int (*popcount64)(uint64_t x);
+    int (*clz64)(uint64_t x);
+    int (*ctz64)(uint64_t x);
+    uint64_t (*pdep64)(uint64_t x, uint64_t mask);
+    uint64_t (*pext64)(uint64_t x, uint64_t mask);
+    bool fast_pdep;
+} bitops_impl_t;
+
+
+/* portable */
+
+static int popcount64_sw(uint64_t x)
+{
+    /* add up the bits in pairs, then fours, then bytes, then the multiply
+     * adds all the bytes into the top byte */
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+    return (int)((x * 0x0101010101010101ULL) >> 56);
+}
+
+static int clz64_sw(uint64_t x)
+{
+    return x == 0 ? 64 : __builtin_clzll(x);
+}
+
+static int ctz64_sw(uint64_t x)
+{
+    return x == 0 ? 64 : __builtin_ctzll(x);
+}
+
+/* one bit of the mask at a time, from the bottom */
+static uint64_t pdep64_sw(uint64_t x, uint64_t mask)
+{
+    uint64_t r = 0;
+
+    for (uint64_t bb = 1; mask != 0; bb <<= 1)
+    {
+        if (x & bb)
+        {
+            r |= mask & -mask;
+        }
+        mask &= mask - 1;
+    }
+    return r;
+}
+
+static uint64_t pext64_sw(uint64_t x, uint64_t mask)
+{
+    uint64_t r = 0;
+
+    for (uint64_t bb = 1; mask != 0; bb <<= 1)
+    {
+        if (x & mask & -mask)
+        {
+            r |= bb;
+        }
+        mask &= mask - 1;
+    }
+    return r;
+}
+
+static const bitops_impl_t impl_sw =
+{
+    popcount64_sw, clz64_sw, ctz64_sw, pdep64_sw, pext64_sw, false
+};
+
+
+#ifdef BITOPS_X86
+
+/* Compiled for the instructions whatever the build flags, and only called
+ * when cpuid says they are there. LZCNT and TZCNT give 64 for 0 so need
+ * no test. */
+
+__attribute__((target("popcnt")))
+static int popcount64_hw(uint64_t x)
+{
+    return (int)_mm_popcnt_u64(x);
+}
+
+__attribute__((target("lzcnt")))
+static int clz64_hw(uint64_t x)
+{
+    return (int)_lzcnt_u64(x);
+}
+
+__attribute__((target("bmi")))
+static int ctz64_hw(uint64_t x)
+{
+    return (int)_tzcnt_u64(x);
+}
+
+__attribute__((target("bmi2")))
+static uint64_t pdep64_hw(uint64_t x, uint64_t mask)
+{
+    return _pdep_u64(x, mask);
+}
+
+__attribute__((target("bmi2")))
+static uint64_t pext64_hw(uint64_t x, uint64_t mask)
+{
+    return _pext_u64(x, mask);
+}
+
+/* AMD before Zen 3 (family 19h) do PDEP/PEXT in microcode, taking
+ * hundreds of cycles for a busy mask, slower than the portable code */
+static bool slow_pdep(void)
+{
+    unsigned int a, b, c, d;
+    unsigned int family;
+
+    __cpuid(0, a, b, c, d);
+    /* "AuthenticAMD" */
+    if (b != 0x68747541 || d != 0x69746e65 || c != 0x444d4163)
+    {
+        return false;
+    }
+    __cpuid(1, a, b, c, d);
+    family = (a >> 8) & 0xf;
+    if (family == 0xf)
+    {
+        family += (a >> 20) & 0xff;
+    }
+    return family < 0x19;
+}
+
+/* CPUID.1:ECX.POPCNT[bit 23], CPUID.80000001H:ECX.LZCNT[bit 5],
+ * CPUID.(EAX=07H, ECX=0):EBX.BMI1[bit 3] and BMI2[bit 8] */
+static bitops_impl_t impl_hw_detect(bool *any)
+{
+    bitops_impl_t impl = impl_sw;
+    unsigned int a, b, c, d;
+
+    *any = false;
+    if (__get_cpuid(1, &a, &b, &c, &d) && (c & (1u << 23)))
+    {
+        impl.popcount64 = popcount64_hw;
+        *any = true;
+    }
+    if (__get_cpuid(0x80000001, &a, &b, &c, &d) && (c & (1u << 5)))
+    {
+        impl.clz64 = clz64_hw;
+        *any = true;
+    }
+    if (__get_cpuid_max(0, NULL) >= 7)
+    {
+        __cpuid_count(7, 0, a, b, c, d);
+        if (b & (1u << 3))
+        {
+            impl.ctz64 = ctz64_hw;
+            *any = true;
+        }
+        if ((b & (1u << 8)) && !slow_pdep())
+        {
+            impl.pdep64 = pdep64_hw;
+            impl.pext64 = pext64_hw;
+            impl.fast_pdep = true;
+            *any = true;
+        }
+    }
+    return impl;
+}
+#endif
+
+
+static bitops_impl_t impl;
+static bool impl_selected;
+static bool use_hardware = true;
+static bool using_hardware;
+
+static void select_impl(void)
+{
+    impl = impl_sw;
+    using_hardware = false;
+#ifdef BITOPS_X86
+    if (use_hardware)
+    {
+        impl = impl_hw_detect(&using_hardware);
+    }
+#endif
+    impl_selected = true;
+}
+
+static const bitops_impl_t *get_impl(void)
+{
+    if (!impl_selected)
+    {
+        select_impl();
+    }
+    return &impl;
+}
+
+void bitops_use_hardware(bool enable)
+{
+    use_hardware = enable;
+    select_impl();
+}
+
+bool bitops_using_hardware(void)
+{
+    get_impl();
+    return using_hardware;
+}
+
+
+int bitops_popcount(u128 x)
+{
+    const bitops_impl_t *p = get_impl();
+    return p->popcount64((uint64_t)x) + p->popcount64((uint64_t)(x >> 64));
+}
+
+int bitops_clz(u128 x, int bits)
+{
+    const bitops_impl_t *p = get_impl();
+    uint64_t hi = (uint64_t)(x >> 64);
+    int n = hi != 0 ? p->clz64(hi) : 64 + p->clz64((uint64_t)x);
+
+    /* not counting the zeros above the width */
+    return n - (128 - bits);
+}
+
+int bitops_ctz(u128 x, int bits)
+{
+    const bitops_impl_t *p = get_impl();
+    uint64_t lo = (uint64_t)x;
+
+    if (x == 0)
+    {
+        return bits;
+    }
+    return lo != 0 ? p->ctz64(lo) : 64 + p->ctz64((uint64_t)(x >> 64));
+}
+
+int bitops_parity(u128 x)
+{
+    return bitops_popcount(x) & 1;
+}
+
+static uint64_t reverse64(uint64_t x)
+{
+    /* swap adjacent bits, then pairs, then nybbles, leaving the bytes to
+     * BSWAP */
+    x = ((x >> 1) & 0x5555555555555555ULL) | ((x & 0x5555555555555555ULL) << 1);
+    x = ((x >> 2) & 0x3333333333333333ULL) | ((x & 0x3333333333333333ULL) << 2);
+    x = ((x >> 4) & 0x0f0f0f0f0f0f0f0fULL) | ((x & 0x0f0f0f0f0f0f0f0fULL) << 4);
+    return __builtin_bswap64(x);
+}
+
+u128 bitops_reverse(u128 x, int bits)
+{
+    u128 r = ((u128)reverse64((uint64_t)x) << 64) | reverse64((uint64_t)(x >> 64));
+    return r >> (128 - bits);
+}
+
+u128 bitops_byteswap(u128 x, int bits)
+{
+    u128 r = ((u128)__builtin_bswap64((uint64_t)x) << 64)
+             | __builtin_bswap64((uint64_t)(x >> 64));
+    return r >> (128 - bits);
+}
+
+
+/* the 128 bit versions work on the low half of the mask, then carry on
+ * with the high half from where the low half left off */
+
+u128 bitops_pdep(u128 x, u128 mask)
+{
+    const bitops_impl_t *p = get_impl();
+    uint64_t mlo = (uint64_t)mask;
+    int n = p->popcount64(mlo);
+    uint64_t lo = p->pdep64((uint64_t)x, mlo);
+    uint64_t hi = p->pdep64((uint64_t)(x >> n), (uint64_t)(mask >> 64));
+
+    return ((u128)hi << 64) | lo;
+}
+
+u128 bitops_pext(u128 x, u128 mask)
+{
+    const bitops_impl_t *p = get_impl();
+    uint64_t mlo = (uint64_t)mask;
+    int n = p->popcount64(mlo);
+    uint64_t lo = p->pext64((uint64_t)x, mlo);
+    uint64_t hi = p->pext64((uint64_t)(x >> 64), (uint64_t)(mask >> 64));
+
+    return ((u128)hi << n) | lo;
+}
+
+
+/* every second and every third bit, from bit 0 */
+#define EVERY2_64 0x5555555555555555ULL
+#define EVERY3_64 0x1249249249249249ULL
+#define EVERY2 (((u128)EVERY2_64 << 64) | EVERY2_64)
+/* EVERY3_64 stops at bit 60, so the pattern carries on at 63, 66, ... up
+ * to 123 as the same shifted up by 63, then there's just 126 left */
+#define EVERY3 (((u128)1 << 126) | ((u128)EVERY3_64 << 63) | EVERY3_64)
+
+/* The shift and mask versions, spreading the bits in halves, then
+ * quarters and so on (or gathering in the reverse order). Each works on
+ * a 64 bit result, the 128 bit ones do it in pieces. */
+
+static uint64_t spread2_32(uint64_t x)
+{
+    x &= 0xffffffffULL;
+    x = (x | (x << 16)) & 0x0000ffff0000ffffULL;
+    x = (x | (x << 8)) & 0x00ff00ff00ff00ffULL;
+    x = (x | (x << 4)) & 0x0f0f0f0f0f0f0f0fULL;
+    x = (x | (x << 2)) & 0x3333333333333333ULL;
+    x = (x | (x << 1)) & EVERY2_64;
+    return x;
+}
+
+static uint64_t compact2_64(uint64_t x)
+{
+    x &= EVERY2_64;
+    x = (x | (x >> 1)) & 0x3333333333333333ULL;
+    x = (x | (x >> 2)) & 0x0f0f0f0f0f0f0f0fULL;
+    x = (x | (x >> 4)) & 0x00ff00ff00ff00ffULL;
+    x = (x | (x >> 8)) & 0x0000ffff0000ffffULL;
+    x = (x | (x >> 16)) & 0xffffffffULL;
+    return x;
+}
+
+/* 21 bits to 63 */
+static uint64_t spread3_21(uint64_t x)
+{
+    x &= 0x1fffffULL;
+    x = (x | (x << 32)) & 0x001f00000000ffffULL;
+    x = (x | (x << 16)) & 0x001f0000ff0000ffULL;
+    x = (x | (x << 8)) & 0x100f00f00f00f00fULL;
+    x = (x | (x << 4)) & 0x10c30c30c30c30c3ULL;
+    x = (x | (x << 2)) & EVERY3_64;
+    return x;
+}
+
+static uint64_t compact3_63(uint64_t x)
+{
+    x &= EVERY3_64;
+    x = (x | (x >> 2)) & 0x10c30c30c30c30c3ULL;
+    x = (x | (x >> 4)) & 0x100f00f00f00f00fULL;
+    x = (x | (x >> 8)) & 0x001f0000ff0000ffULL;
+    x = (x | (x >> 16)) & 0x001f00000000ffffULL;
+    x = (x | (x >> 32)) & 0x1fffffULL;
+    return x;
+}
+
+u128 bitops_spread2(u128 x)
+{
+    if (get_impl()->fast_pdep)
+    {
+        return bitops_pdep(x, EVERY2);
+    }
+    return ((u128)spread2_32((uint64_t)(x >> 32)) << 64) | spread2_32((uint64_t)x);
+}
+
+u128 bitops_compact2(u128 x)
+{
+    if (get_impl()->fast_pdep)
+    {
+        return bitops_pext(x, EVERY2);
+    }
+    return ((u128)compact2_64((uint64_t)(x >> 64)) << 32) | compact2_64((uint64_t)x);
+}
+
+u128 bitops_spread3(u128 x)
+{
+    if (get_impl()->fast_pdep)
+    {
+        return bitops_pdep(x, EVERY3);
+    }
+    /* bits 0-20 to 0-60, 21-41 to 63-123, and 42 to 126 */
+    return spread3_21((uint64_t)x)
+           | ((u128)spread3_21((uint64_t)(x >> 21)) << 63)
+           | ((u128)((uint64_t)(x >> 42) & 1) << 126);
+}
+
+u128 bitops_compact3(u128 x)
+{
+    if (get_impl()->fast_pdep)
+    {
+        return bitops_pext(x, EVERY3);
+    }
+    return compact3_63((uint64_t)x)
+           | ((u128)compact3_63((uint64_t)(x >> 63)) << 21)
+           | ((u128)((uint64_t)(x >> 126) & 1) << 42);
+}
@@ -0,0 +1,76 @@
+/*****************************************************************************
+ * File bitops.h part of ProgAndSciCalc
+ *
+ * Copyright (C) 2018 Ken Bromham
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef BITOPS_H
+#define BITOPS_H
+
+#include <stdbool.h>
+
+/* Bit counting and rearranging for values of up to 128 bits.
+ *
+ * bits is the width (1 to 128) and x must have no bits set above it.
+ *
+ * On x86 the counts use the POPCNT, LZCNT and TZCNT instructions when the
+ * CPU has them (checked once with cpuid, so the program still runs on
+ * older CPUs), otherwise portable code. Byte swap is always BSWAP as the
+ * compiler knows it for every x86. Deposit and extract use the BMI2 PDEP
+ * and PEXT instructions in the same way. */
+
+int bitops_popcount(unsigned __int128 x);
+
+/* number of zeros above the highest set bit, bits if x is 0 */
+int bitops_clz(unsigned __int128 x, int bits);
+
+/* number of zeros below the lowest set bit, bits if x is 0 */
+int bitops_ctz(unsigned __int128 x, int bits);
+
+/* 1 if the number of set bits is odd */
+int bitops_parity(unsigned __int128 x);
+
+/* bit 0 to bit bits - 1 and so on */
+unsigned __int128 bitops_reverse(unsigned __int128 x, int bits);
+
+/* reverse the order of the bytes, bits must be a multiple of 8 */
+unsigned __int128 bitops_byteswap(unsigned __int128 x, int bits);
+
+/* the low bits of x go in turn to the bits set in mask, from the bottom */
+unsigned __int128 bitops_pdep(unsigned __int128 x, unsigned __int128 mask);
+
+/* the bits of x where mask is set, packed together at the bottom */
+unsigned __int128 bitops_pext(unsigned __int128 x, unsigned __int128 mask);
+
+/* Morton (Z-order) helpers. spread2 moves bit i to bit 2i (for the low 64
+ * bits), compact2 undoes it taking the even bits. spread3 moves bit i to
+ * bit 3i (for the low 43 bits), compact3 takes every third bit. So a 2-D
+ * index is spread2(x) | spread2(y) << 1, and y comes back out as
+ * compact2(index >> 1). */
+unsigned __int128 bitops_spread2(unsigned __int128 x);
+unsigned __int128 bitops_compact2(unsigned __int128 x);
+unsigned __int128 bitops_spread3(unsigned __int128 x);
+unsigned __int128 bitops_compact3(unsigned __int128 x);
+
+/* false to use the portable code even when the instructions are there,
+ * for testing */
+void bitops_use_hardware(bool enable);
+
+/* true if the instructions are being used */
+bool bitops_using_hardware(void);
+
+#endif
@@ -0,0 +1,3 @@
+#!/bin/sh
+#
+gcc -Wall -Wextra -O2 -std=c99 -o test_bignum test_bignum.c bignum.c -lm
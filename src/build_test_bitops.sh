@@ -0,0 +1,3 @@
+#!/bin/sh
+#
+gcc -Wall -Wextra -O2 -std=c99 -o test_bitops test_bitops.c bitops.c
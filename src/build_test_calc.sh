@@ -0,0 +1,3 @@
+#!/bin/sh
+#
+gcc -Wall -Wextra -O2 -std=c99 -o test_calc test_calc.c calc.c calc_float.c calc_integer.c calc_util.c calc_bigint.c calc_conversion.c display_print.c bitops.c gf2.c ntheory.c rational.c bignum.c radix_print.c dfp_int.c decNumber/decContext.c decNumber/decQuad.c decNumber/decNumber.c decNumber/decimal128.c decNumber/decimal64.c decNumber/decNumberMath.c -lm
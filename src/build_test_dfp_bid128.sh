@@ -0,0 +1,3 @@
+#!/bin/sh
+#
+gcc -Wall -Wextra -O2 -std=c99 -o test_dfp_bid128 test_dfp_bid128.c dfp_bid128.c decNumber/decContext.c decNumber/decQuad.c decNumber/decNumber.c decNumber/decimal128.c decNumber/decimal64.c
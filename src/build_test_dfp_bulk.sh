@@ -0,0 +1,3 @@
+#!/bin/sh
+#
+gcc -Wall -Wextra -O2 -std=c99 -o test_dfp_bulk test_dfp_bulk.c dfp_bulk.c decNumber/decContext.c decNumber/decQuad.c
@@ -0,0 +1,3 @@
+#!/bin/sh
+#
+gcc -Wall -Wextra -O2 -std=c99 -o test_dfp_int test_dfp_int.c dfp_int.c decNumber/decContext.c decNumber/decQuad.c decNumber/decNumber.c decNumber/decimal128.c decNumber/decimal64.c
@@ -0,0 +1,3 @@
+#!/bin/sh
+#
+gcc -Wall -Wextra -O2 -std=c99 -o test_ieee754 test_ieee754.c ieee754.c bignum.c decNumber/decContext.c decNumber/decQuad.c -lm
@@ -0,0 +1,3 @@
+#!/bin/sh
+#
+gcc -Wall -Wextra -O2 -std=c99 -pthread -o test_invsym test_invsym.c invsym.c ntheory.c bitops.c decNumber/decContext.c decNumber/decQuad.c decNumber/decNumber.c decNumber/decimal128.c decNumber/decimal64.c decNumber/decNumberMath.c -lm
@@ -0,0 +1,3 @@
+#!/bin/sh
+#
+gcc -Wall -Wextra -O2 -std=c99 -o test_rational test_rational.c rational.c ntheory.c bitops.c bignum.c decNumber/decContext.c decNumber/decQuad.c -lm
@@ -19,23 +19,35 @@
 
 
 #include "calc_internal.h"
+#include "radix_print.h"
 
 decContext dfp_context;
 
 static int debug_level;
 
-static void (*result_callback)(uint64_t, stackf_t, calc_op_enum);
-static void (*history_callback)(uint64_t, stackf_t);
+static void (*result_callback)(calc_int_t, stackf_t, calc_op_enum);
+static void (*history_callback)(calc_int_t, stackf_t);
 static void (*num_paren_callback)(int);
 static void (*warn_callback)(const char *msg);
 static void (*error_callback)(const char *msg);
-static bool (*get_best_integer_callback)(uint64_t *, bool *);
+static bool (*get_best_integer_callback)(calc_int_t *, bool *);
 
 static calc_mode_enum calc_mode;
 static calc_angle_enum calc_angle;
 /* use unsigned in integer mode */
 static bool use_unsigned;
-static calc_width_enum integer_width = calc_width_64;
+static calc_width_t integer_width = 64;
+/* 0 when not in mod m mode */
+static uint64_t modulus;
+/* 0, or the number of fraction bits in fixed point (Q format) mode */
+static int fixed_frac;
+static bool fixed_saturate;
+
+/* 0, or the lane width in lanes (SWAR) mode */
+static int lanes;
+
+/* float mode, values that are exact fractions also kept as num / den */
+static calc_rational_enum rational;
 
 static bool warn_on_signed_overflow = true;
 static bool warn_on_unsigned_overflow = true;
@@ -43,7 +55,9 @@ static bool warn_on_unsigned_overflow = true;
 /* Priority for binary ops. Unary ops are grabbed immediately so effectively
  * have a priority above PRIORITY_MAX. For equals, use PRIORITY_MIN.
  * Bitwise and,or,xor use PRIORITY_ADD_SUB.
- * Shifts and gcd use PRIORITY_MUL_DIV. */
+ * Shifts, gcd, pdep, pext, morton2, the GF(2) ops and lane min, max and
+ * compares use PRIORITY_MUL_DIV, the saturating lane add and subtract
+ * PRIORITY_ADD_SUB, the mod m power and discrete log PRIORITY_POWER_ROOT. */
 #define PRIORITY_ADD_SUB      0
 #define PRIORITY_MUL_DIV      1
 #define PRIORITY_POWER_ROOT   2
@@ -63,8 +77,11 @@ static void report_num_used_parentheses(void);
 /* Stack element */
 typedef struct
 {
-    uint64_t ival;
+    calc_int_t ival;
     stackf_t fval;
+    /* in rational mode, the exact value when rval_valid */
+    rat_t rval;
+    bool rval_valid;
 } stack_el_t;
 
 #define STACK_SIZE ((NUM_PRIORITY * (MAX_PARENTHESES + 1)) + 1)
@@ -84,7 +101,7 @@ static bool init_from_save_val;
 typedef struct
 {
     calc_op_enum cop;
-    uint64_t (*iop)(uint64_t, uint64_t);
+    calc_int_t (*iop)(calc_int_t, calc_int_t);
     stackf_t (*fop)(stackf_t, stackf_t);
     int priority;
 } bop_stack_el_t;
@@ -121,15 +138,18 @@ static void print_stack(void)
     for (int i = 0; i < STACK_SIZE; i++)
     {
         char buf[DFP_STRING_MAX];
+        char ibuf[RADIX_PRINT_MAX];
         dfp_to_string(&stack[i].fval, buf);
         if (use_unsigned)
         {
-            printf("  [%" PRIu64 " %s] ", stack[i].ival, buf);
+            radix_print(ibuf, stack[i].ival, 10, 1, 0, NULL);
+            printf("  [%s %s] ", ibuf, buf);
         }
         else
         {
-            int64_t si = calc_util_get_signed(stack[i].ival, integer_width);
-            printf("  [%" PRId64 " %s] ", si, buf);
+            calc_sint_t si = calc_util_get_signed(stack[i].ival, integer_width);
+            radix_print(ibuf, si < 0 ? -(calc_int_t)si : (calc_int_t)si, 10, 1, 0, NULL);
+            printf("  [%s%s %s] ", si < 0 ? "-" : "", ibuf, buf);
         }
     }
     printf("\n");
@@ -181,13 +201,12 @@ static void history_update(const stack_el_t *s)
 
 #define stack_num_args() stack_index
 
-static void stack_push(uint64_t iarg, stackf_t farg)
+static void stack_push_el(const stack_el_t *el)
 {
     if (stack_index < STACK_SIZE)
     {
         calc_info("stack push");
-        stack[stack_index].ival = iarg;
-        stack[stack_index].fval = farg;
+        stack[stack_index] = *el;
         history_update(&stack[stack_index]);
         stack_index++;
         print_stack();
@@ -198,6 +217,17 @@ static void stack_push(uint64_t iarg, stackf_t farg)
     }
 }
 
+/* a value that isn't known to be an exact fraction */
+static void stack_push(calc_int_t iarg, stackf_t farg)
+{
+    stack_el_t el;
+
+    el.ival = iarg;
+    el.fval = farg;
+    el.rval_valid = false;
+    stack_push_el(&el);
+}
+
 static stack_el_t stack_pop(void)
 {
     if (stack_index > 0)
@@ -232,7 +262,7 @@ static const stack_el_t *stack_peek(void)
 #define bop_stack_num_args() bop_stack_index
 
 static void bop_stack_push(calc_op_enum cop,
-                           uint64_t (*fni)(uint64_t, uint64_t),
+                           calc_int_t (*fni)(calc_int_t, calc_int_t),
                            stackf_t (*fnf)(stackf_t, stackf_t),
                            int pri)
 {
@@ -311,6 +341,73 @@ static void dfp_normalise_zero(stackf_t *arg)
     }
 }
 
+static bool rational_on(void)
+{
+    return rational != calc_rational_off && calc_mode == calc_mode_float;
+}
+
+/* Values entered are exact decimals, so exact fractions too unless
+ * they're beyond 128 bits */
+static void rational_from_fval(stack_el_t *s)
+{
+    s->rval_valid = rational_on() && rat_from_dfp(&s->rval, &s->fval);
+}
+
+/* the fraction for a result, fval being the nearest decimal to it */
+static void rational_set(stack_el_t *s, const rat_t *r)
+{
+    s->rval = *r;
+    s->rval_valid = true;
+}
+
+static void rational_to_fval(const rat_t *r, stackf_t *fval)
+{
+    rat_to_dfp(r, fval);
+    dfp_normalise_zero(fval);
+}
+
+/* + - * / of exact fractions, false for any other op, if either arg isn't
+ * an exact fraction or if the result doesn't fit, then it's done in
+ * decimal float as normal */
+static bool rational_bin_op(calc_op_enum cop, const stack_el_t *a,
+                            const stack_el_t *b, rat_t *r)
+{
+    if (!rational_on() || !a->rval_valid || !b->rval_valid)
+        return false;
+
+    switch (cop)
+    {
+        case cop_add:
+            return rat_add(r, &a->rval, &b->rval);
+        case cop_sub:
+            return rat_sub(r, &a->rval, &b->rval);
+        case cop_mul:
+            return rat_mul(r, &a->rval, &b->rval);
+        case cop_div:
+            return rat_div(r, &a->rval, &b->rval);
+        default:
+            return false;
+    }
+}
+
+static bool rational_unary_op(calc_op_enum cop, const stack_el_t *a, rat_t *r)
+{
+    if (!rational_on() || !a->rval_valid)
+        return false;
+
+    switch (cop)
+    {
+        case cop_pm:
+            return rat_neg(r, &a->rval);
+        case cop_sqr:
+            return rat_mul(r, &a->rval, &a->rval);
+        case cop_onedx:
+            return rat_inv(r, &a->rval);
+        default:
+            return false;
+    }
+}
+
 static void request_display_update(void)
 {
     calc_info("request_update");
@@ -325,12 +422,15 @@ static void request_display_update(void)
 }
 
 
-static void unary_op(uint64_t (*fni)(uint64_t),
+static void unary_op(calc_op_enum cop,
+                     calc_int_t (*fni)(calc_int_t),
                      stackf_t (*fnf)(stackf_t))
 {
-    uint64_t iresult;
+    calc_int_t iresult;
     stackf_t fresult;
     stack_el_t arg;
+    rat_t rresult;
+    bool rvalid = false;
 
     if (calc_mode == calc_mode_integer && fni == NULL)
         return;
@@ -360,13 +460,18 @@ static void unary_op(uint64_t (*fni)(uint64_t),
          * likewise all unary ops eg.
          *  10 + 2 * sqr [4] sqr [16] = [42]
          */
-        stack_push(arg.ival, arg.fval);
+        stack_push_el(&arg);
     }
     if (calc_mode == calc_mode_integer)
     {
         iresult = fni(arg.ival);
         dfp_zero(&fresult);
     }
+    else if ((rvalid = rational_unary_op(cop, &arg, &rresult)))
+    {
+        iresult = 0;
+        rational_to_fval(&rresult, &fresult);
+    }
     else
     {
         iresult = 0;
@@ -374,6 +479,8 @@ static void unary_op(uint64_t (*fni)(uint64_t),
         dfp_normalise_zero(&fresult);
     }
     stack_push(iresult, fresult);
+    if (rvalid)
+        rational_set(&stack[stack_index - 1], &rresult);
     request_display_update();
 }
 
@@ -383,10 +490,12 @@ static void process_bin_ops(int priority)
 {
     while (bop_stack_num_args() > 0)
     {
-        uint64_t iresult;
+        calc_int_t iresult;
         stackf_t fresult;
         stack_el_t arg1;
         stack_el_t arg2;
+        rat_t rresult;
+        bool rvalid = false;
         const bop_stack_el_t *bop_info;
 
         calc_info("bin ops loop");
@@ -427,7 +536,7 @@ static void process_bin_ops(int priority)
             const stack_el_t *s;
             calc_info("duplicate arg1");
             s = stack_peek();
-            stack_push(s->ival, s->fval);
+            stack_push_el(s);
             if (!allow_repeated_equals)
             {
                 calc_info("discard dangling binop");
@@ -443,6 +552,12 @@ static void process_bin_ops(int priority)
             iresult = bop_info->iop(arg1.ival, arg2.ival);
             dfp_zero(&fresult);
         }
+        else if ((rvalid = rational_bin_op(bop_info->cop, &arg1, &arg2,
+                                           &rresult)))
+        {
+            iresult = 0;
+            rational_to_fval(&rresult, &fresult);
+        }
         else
         {
             iresult = 0;
@@ -453,12 +568,14 @@ static void process_bin_ops(int priority)
         /* Put result back as arg for next up in the chain (if any).
          * This also means the final result is left on the stack */
         stack_push(iresult, fresult);
+        if (rvalid)
+            rational_set(&stack[stack_index - 1], &rresult);
     }
     calc_info("bin ops end");
 }
 
 static void bin_op_common(calc_op_enum cop,
-                          uint64_t (*fni)(uint64_t, uint64_t),
+                          calc_int_t (*fni)(calc_int_t, calc_int_t),
                           stackf_t (*fnf)(stackf_t, stackf_t),
                           int priority)
 {
@@ -564,8 +681,10 @@ static void op_equals(void)
          *               5 = [7]  repeats the +2
          *              10 = [12] repeats the +2
          */
-        uint64_t iresult;
+        calc_int_t iresult;
         stackf_t fresult;
+        rat_t rresult;
+        bool rvalid = false;
         stack_el_t *arg1 = &stack[0];
         stack_el_t *arg2 = &stack[1];
         if (calc_mode == calc_mode_integer)
@@ -573,6 +692,12 @@ static void op_equals(void)
             iresult = bop_stack[0].iop(arg1->ival, arg2->ival);
             dfp_zero(&fresult);
         }
+        else if ((rvalid = rational_bin_op(bop_stack[0].cop, arg1, arg2,
+                                           &rresult)))
+        {
+            iresult = 0;
+            rational_to_fval(&rresult, &fresult);
+        }
         else
         {
             iresult = 0;
@@ -581,6 +706,9 @@ static void op_equals(void)
         }
         stack[0].ival = iresult;
         stack[0].fval = fresult;
+        stack[0].rval_valid = false;
+        if (rvalid)
+            rational_set(&stack[0], &rresult);
         history_update(stack_peek());
         request_display_update();
     }
@@ -611,11 +739,13 @@ static void op_equals(void)
     print_bop_stack();
 }
 
-static void new_arg(uint64_t iarg, stackf_t farg)
+/* exact when farg is the value itself (entered, or a decimal like 0.1) so
+ * its fraction is too, rather than a rounded result like sqrt(2) */
+static void new_arg(calc_int_t iarg, stackf_t farg, bool exact)
 {
     /* Things should (mostly) be masked off already, but exceptions are
      * memory recall, value from history, or value pasted from clipboard */
-    uint64_t iarg_masked = iarg;
+    calc_int_t iarg_masked = iarg;
     calc_util_mask_width(&iarg_masked, integer_width);
 
     /* Decide if the new arg should replace the current top of stack ie. pop
@@ -630,13 +760,20 @@ static void new_arg(uint64_t iarg, stackf_t farg)
 
     dfp_normalise_zero(&farg);
     stack_push(iarg_masked, farg);
+    if (exact)
+        rational_from_fval(&stack[stack_index - 1]);
     paren_allowed = false;
 }
 
 
-void calc_give_arg(uint64_t ival, stackf_t fval)
+void calc_give_arg(calc_int_t ival, stackf_t fval)
 {
-    new_arg(ival, fval);
+    new_arg(ival, fval, true);
+}
+
+void calc_give_inexact_arg(stackf_t fval)
+{
+    new_arg(0, fval, false);
 }
 
 static void report_num_used_parentheses(void)
@@ -663,7 +800,7 @@ static void parentheses_left(void)
          */
         stackf_t dzero;
         dfp_zero(&dzero);
-        new_arg(0, dzero);
+        new_arg(0, dzero, true);
         /* need to reset paren_allowed */
         paren_allowed = true;
         request_display_update();
@@ -705,13 +842,21 @@ static void memory_store(int m)
     else
     {
         mem_val[m].fval = s->fval;
+        mem_val[m].rval = s->rval;
+        mem_val[m].rval_valid = s->rval_valid;
     }
     request_display_update();
 }
 
 static void memory_recall(int m)
 {
-    new_arg(mem_val[m].ival, mem_val[m].fval);
+    stack_el_t *s;
+
+    new_arg(mem_val[m].ival, mem_val[m].fval, false);
+    /* the fraction stored with it, if any */
+    s = &stack[stack_index - 1];
+    s->rval = mem_val[m].rval;
+    s->rval_valid = rational_on() && mem_val[m].rval_valid;
     request_display_update();
 }
 
@@ -727,7 +872,7 @@ static void memory_plus(int m)
     if (calc_mode == calc_mode_integer)
     {
         /* mem val as stored is not necessarily masked to the width */
-        uint64_t mem_masked = mem_val[m].ival;
+        calc_int_t mem_masked = mem_val[m].ival;
         calc_util_mask_width(&mem_masked, integer_width);
         mem_val[m].ival = bin_iop_add(mem_masked, s->ival);
         if (!use_unsigned)
@@ -739,7 +884,17 @@ static void memory_plus(int m)
     }
     else
     {
-        mem_val[m].fval = bin_fop_add(mem_val[m].fval, s->fval);
+        rat_t r;
+        if (rational_bin_op(cop_add, &mem_val[m], s, &r))
+        {
+            rational_to_fval(&r, &mem_val[m].fval);
+            rational_set(&mem_val[m], &r);
+        }
+        else
+        {
+            mem_val[m].fval = bin_fop_add(mem_val[m].fval, s->fval);
+            mem_val[m].rval_valid = false;
+        }
     }
 
     /* Test
@@ -755,7 +910,8 @@ static void enter_pi(void)
 
     stackf_t fval;
     dfp_from_string(&fval, "3.1415926535897932384626433832795029", &dfp_context);
-    new_arg(0, fval);
+    /* not the fraction of the rounded decimal */
+    new_arg(0, fval, false);
     request_display_update();
 }
 
@@ -767,7 +923,7 @@ static void enter_euler(void)
 
     stackf_t fval;
     dfp_from_string(&fval, "2.7182818284590452353602874713526625", &dfp_context);
-    new_arg(0, fval);
+    new_arg(0, fval, false);
     request_display_update();
 }
 #endif
@@ -794,33 +950,17 @@ static void enter_rand(void)
     sprintf(buf, "%.20f", r);
     stackf_t fval;
     dfp_from_string(&fval, buf, &dfp_context);
-    new_arg(0, fval);
+    new_arg(0, fval, true);
     request_display_update();
 }
 
 static void enter_int_min(void)
 {
-    int64_t min;
-    switch (integer_width)
-    {
-    case calc_width_8:
-        min = INT8_MIN;
-        break;
-    case calc_width_16:
-        min = INT16_MIN;
-        break;
-    case calc_width_32:
-        min = INT32_MIN;
-        break;
-    default:
-        min = INT64_MIN;
-        break;
-    }
-    uint64_t ival = min;
-    calc_util_mask_width(&ival, integer_width);
+    /* just the sign bit of the width */
+    calc_int_t ival = (calc_int_t)1 << (integer_width - 1);
     stackf_t fval;
     dfp_zero(&fval);
-    new_arg(ival, fval);
+    new_arg(ival, fval, true);
     request_display_update();
 }
 
@@ -861,7 +1001,7 @@ void calc_give_op(calc_op_enum cop)
             bin_op_common(cop, bin_iop_mod, bin_fop_mod, PRIORITY_MUL_DIV);
             break;
         case cop_pow:
-            bin_op_common(cop, NULL, bin_fop_pow, PRIORITY_POWER_ROOT);
+            bin_op_common(cop, bin_iop_pow, bin_fop_pow, PRIORITY_POWER_ROOT);
             break;
         case cop_root:
             bin_op_common(cop, NULL, bin_fop_root, PRIORITY_POWER_ROOT);
@@ -875,91 +1015,178 @@ void calc_give_op(calc_op_enum cop)
         case cop_rsftn:
             bin_op_common(cop, bin_iop_right_shift, NULL, PRIORITY_MUL_DIV);
             break;
+        case cop_pdep:
+            bin_op_common(cop, bin_iop_pdep, NULL, PRIORITY_MUL_DIV);
+            break;
+        case cop_pext:
+            bin_op_common(cop, bin_iop_pext, NULL, PRIORITY_MUL_DIV);
+            break;
+        case cop_morton2:
+            bin_op_common(cop, bin_iop_morton2, NULL, PRIORITY_MUL_DIV);
+            break;
+        case cop_clmul:
+            bin_op_common(cop, bin_iop_clmul, NULL, PRIORITY_MUL_DIV);
+            break;
+        case cop_clmulh:
+            bin_op_common(cop, bin_iop_clmulh, NULL, PRIORITY_MUL_DIV);
+            break;
+        case cop_gf2mod:
+            bin_op_common(cop, bin_iop_gf2mod, NULL, PRIORITY_MUL_DIV);
+            break;
+        case cop_gf2gcd:
+            bin_op_common(cop, bin_iop_gf2gcd, NULL, PRIORITY_MUL_DIV);
+            break;
+        case cop_dlog:
+            bin_op_common(cop, bin_iop_dlog, NULL, PRIORITY_POWER_ROOT);
+            break;
+        case cop_lane_adds:
+            bin_op_common(cop, bin_iop_lane_adds, NULL, PRIORITY_ADD_SUB);
+            break;
+        case cop_lane_subs:
+            bin_op_common(cop, bin_iop_lane_subs, NULL, PRIORITY_ADD_SUB);
+            break;
+        case cop_lane_min:
+            bin_op_common(cop, bin_iop_lane_min, NULL, PRIORITY_MUL_DIV);
+            break;
+        case cop_lane_max:
+            bin_op_common(cop, bin_iop_lane_max, NULL, PRIORITY_MUL_DIV);
+            break;
+        case cop_lane_cmpeq:
+            bin_op_common(cop, bin_iop_lane_cmpeq, NULL, PRIORITY_MUL_DIV);
+            break;
+        case cop_lane_cmpgt:
+            bin_op_common(cop, bin_iop_lane_cmpgt, NULL, PRIORITY_MUL_DIV);
+            break;
 
         case cop_pm:
-            unary_op(iop_plusminus, fop_plusminus);
+            unary_op(cop, iop_plusminus, fop_plusminus);
             break;
         case cop_com:
-            unary_op(iop_complement, NULL);
+            unary_op(cop, iop_complement, NULL);
             break;
         case cop_sqr:
-            unary_op(iop_square, fop_square);
+            unary_op(cop, iop_square, fop_square);
             break;
         case cop_sqrt:
-            unary_op(NULL, fop_square_root);
+            unary_op(cop, iop_square_root, fop_square_root);
             break;
         case cop_onedx:
-            unary_op(NULL, fop_one_over_x);
+            unary_op(cop, iop_one_over_x, fop_one_over_x);
             break;
         case cop_lsft:
-            unary_op(iop_left_shift, NULL);
+            unary_op(cop, iop_left_shift, NULL);
             break;
         case cop_rsft:
-            unary_op(iop_right_shift, NULL);
+            unary_op(cop, iop_right_shift, NULL);
             break;
         case cop_rol:
-            unary_op(iop_rol, NULL);
+            unary_op(cop, iop_rol, NULL);
             break;
         case cop_ror:
-            unary_op(iop_ror, NULL);
+            unary_op(cop, iop_ror, NULL);
+            break;
+        case cop_popcnt:
+            unary_op(cop, iop_popcount, NULL);
+            break;
+        case cop_clz:
+            unary_op(cop, iop_clz, NULL);
+            break;
+        case cop_ctz:
+            unary_op(cop, iop_ctz, NULL);
+            break;
+        case cop_parity:
+            unary_op(cop, iop_parity, NULL);
+            break;
+        case cop_bitrev:
+            unary_op(cop, iop_bitrev, NULL);
+            break;
+        case cop_bswap:
+            unary_op(cop, iop_bswap, NULL);
+            break;
+        case cop_spread2:
+            unary_op(cop, iop_spread2, NULL);
+            break;
+        case cop_compact2:
+            unary_op(cop, iop_compact2, NULL);
+            break;
+        case cop_spread3:
+            unary_op(cop, iop_spread3, NULL);
+            break;
+        case cop_compact3:
+            unary_op(cop, iop_compact3, NULL);
+            break;
+        case cop_isprime:
+            unary_op(cop, iop_is_prime, NULL);
+            break;
+        case cop_nextprime:
+            unary_op(cop, iop_next_prime, NULL);
+            break;
+        case cop_icbrt:
+            unary_op(cop, iop_cube_root, NULL);
+            break;
+        case cop_ilog2:
+            unary_op(cop, iop_ilog2, NULL);
+            break;
+        case cop_ilog10:
+            unary_op(cop, iop_ilog10, NULL);
             break;
 #if 0
         case cop_2powx:
-            unary_op(iop_2powx, NULL);
+            unary_op(cop, iop_2powx, NULL);
             break;
 #endif
 
 
         case cop_log:
-            unary_op(NULL, fop_log);
+            unary_op(cop, NULL, fop_log);
             break;
         case cop_inv_log:
-            unary_op(NULL, fop_inv_log);
+            unary_op(cop, NULL, fop_inv_log);
             break;
         case cop_ln:
-            unary_op(NULL, fop_ln);
+            unary_op(cop, NULL, fop_ln);
             break;
         case cop_inv_ln:
-            unary_op(NULL, fop_inv_ln);
+            unary_op(cop, NULL, fop_inv_ln);
             break;
         case cop_sin:
-            unary_op(NULL, fop_sin);
+            unary_op(cop, NULL, fop_sin);
             break;
         case cop_inv_sin:
-            unary_op(NULL, fop_inv_sin);
+            unary_op(cop, NULL, fop_inv_sin);
             break;
         case cop_cos:
-            unary_op(NULL, fop_cos);
+            unary_op(cop, NULL, fop_cos);
             break;
         case cop_inv_cos:
-            unary_op(NULL, fop_inv_cos);
+            unary_op(cop, NULL, fop_inv_cos);
             break;
         case cop_tan:
-            unary_op(NULL, fop_tan);
+            unary_op(cop, NULL, fop_tan);
             break;
         case cop_inv_tan:
-            unary_op(NULL, fop_inv_tan);
+            unary_op(cop, NULL, fop_inv_tan);
             break;
         case cop_sinh:
-            unary_op(NULL, fop_sinh);
+            unary_op(cop, NULL, fop_sinh);
             break;
         case cop_inv_sinh:
-            unary_op(NULL, fop_inv_sinh);
+            unary_op(cop, NULL, fop_inv_sinh);
             break;
         case cop_cosh:
-            unary_op(NULL, fop_cosh);
+            unary_op(cop, NULL, fop_cosh);
             break;
         case cop_inv_cosh:
-            unary_op(NULL, fop_inv_cosh);
+            unary_op(cop, NULL, fop_inv_cosh);
             break;
         case cop_tanh:
-            unary_op(NULL, fop_tanh);
+            unary_op(cop, NULL, fop_tanh);
             break;
         case cop_inv_tanh:
-            unary_op(NULL, fop_inv_tanh);
+            unary_op(cop, NULL, fop_inv_tanh);
             break;
         case cop_fact:
-            unary_op(NULL, fop_fact);
+            unary_op(cop, NULL, fop_fact);
             break;
 
         case cop_parl:
@@ -1016,7 +1243,7 @@ void calc_init(int debug_lvl,
                calc_mode_enum mode,
                int rand_range,
                bool sct_round,
-               calc_width_enum width,
+               calc_width_t width,
                bool int_unsigned,
                bool warn_signed,
                bool warn_unsigned)
@@ -1029,7 +1256,13 @@ void calc_init(int debug_lvl,
     random_range = rand_range >= 0 ? rand_range: 0;
     use_sct_rounding = sct_round;
     integer_width = width;
+    if (integer_width < CALC_WIDTH_MIN || integer_width > CALC_WIDTH_MAX)
+    {
+        /* shouldn't happen */
+        integer_width = 64;
+    }
     use_unsigned = int_unsigned;
+    calc_integer_select_ops(integer_width, use_unsigned);
     warn_on_signed_overflow = warn_signed;
     warn_on_unsigned_overflow = warn_unsigned;
 
@@ -1054,9 +1287,64 @@ void calc_init(int debug_lvl,
     /* User should do a calc_clear before starting. */
 }
 
+static const char *fixed_range_warn = "Value out of range for the fixed point format";
+static const char *fixed_off_warn = "Fixed point turned off, it needs a width of 64 or less with room for the fraction";
+static const char *lanes_off_warn = "Lanes turned off, the width must be a multiple of the lane width";
+
+/* 2^n for n < 64, exactly */
+static void dfp_pow2(stackf_t *r, int n)
+{
+    dfp_from_uint64(r, (uint64_t)1 << n);
+}
+
+void calc_fixed_to_dfp(calc_int_t ival, stackf_t *r)
+{
+    stackf_t scale;
+
+    if (use_unsigned)
+    {
+        dfp_from_uint128(r, ival);
+    }
+    else
+    {
+        dfp_from_int128(r, calc_util_get_signed(ival, integer_width));
+    }
+    dfp_pow2(&scale, fixed_frac);
+    dfp_divide(r, r, &scale, &dfp_context);
+}
+
+/* fval * 2^n rounded to the nearest integer, clamped to the range of the
+ * width. Returns a warning if it was out of range. */
+static const char *fixed_from_dfp(const stackf_t *fval, calc_int_t *ival)
+{
+    stackf_t scaled;
+    calc_sint_t x;
+    calc_sint_t lo = use_unsigned ? 0 : -((calc_sint_t)1 << (integer_width - 1));
+    calc_sint_t hi = use_unsigned ? ((calc_sint_t)1 << integer_width) - 1
+                                  : ((calc_sint_t)1 << (integer_width - 1)) - 1;
+    dfp_int_status_enum status;
+    const char *msg = NULL;
+
+    dfp_pow2(&scaled, fixed_frac);
+    dfp_multiply(&scaled, fval, &scaled, &dfp_context);
+    status = dfp_to_int128(&scaled, DEC_ROUND_HALF_EVEN, &x);
+    if (status == dfp_int_nan)
+    {
+        x = 0;
+    }
+    if (status == dfp_int_too_big || status == dfp_int_too_small ||
+        x < lo || x > hi)
+    {
+        x = x < lo ? lo : hi;
+        msg = fixed_range_warn;
+    }
+    *ival = (calc_int_t)x & calc_util_width_mask(integer_width);
+    return msg;
+}
+
 static const char *width_changed_warn = "Integer width changed to make value fit";
-static const char *neg_range_warn = "Negative value was out of range (< INT64_MIN)";
-static const char *pos_range_warn = "Positive value was out of range (> UINT64_MAX)";
+static const char *neg_range_warn = "Negative value was out of range (< -2^127)";
+static const char *pos_range_warn = "Positive value was out of range (> 2^128 - 1)";
 
 void calc_set_mode(calc_mode_enum mode)
 {
@@ -1075,17 +1363,29 @@ void calc_set_mode(calc_mode_enum mode)
          * save_val.fval */
 
         /* convert to decimal float */
-        char buf[DFP_STRING_MAX];
-        if (use_unsigned)
+        if (fixed_frac != 0)
         {
-            sprintf(buf, "%"PRIu64, s->ival);
+            calc_fixed_to_dfp(s->ival, &save_val.fval);
+        }
+        else if (use_unsigned)
+        {
+            dfp_from_uint128(&save_val.fval, s->ival);
         }
         else
         {
-            int64_t si = calc_util_get_signed(s->ival, integer_width);
-            sprintf(buf, "%" PRId64, si);
+            calc_sint_t si = calc_util_get_signed(s->ival, integer_width);
+            dfp_from_int128(&save_val.fval, si);
+        }
+    }
+    else if (fixed_frac != 0)
+    {
+        /* straight from the float value to fixed point, the width stays
+         * as it is */
+        const char *msg = fixed_from_dfp(&s->fval, &save_val.ival);
+        if (msg != NULL)
+        {
+            calc_warn(msg);
         }
-        dfp_from_string(&save_val.fval, buf, &dfp_context);
     }
     else
     {
@@ -1104,14 +1404,14 @@ void calc_set_mode(calc_mode_enum mode)
 
         const char *msg = NULL;
         bool negative;
-        uint64_t uval;
-        calc_width_enum current_width = integer_width;
-        calc_width_enum selected_width = current_width;
+        calc_int_t uval;
+        calc_width_t current_width = integer_width;
+        calc_width_t selected_width = current_width;
         bool ok = get_best_integer_callback(&uval, &negative);
         if (ok)
         {
-            /* The number was in the range of s64 (if it was negative) or
-             * u64 (if it was positive), so there must be a calc width that fits.
+            /* The number was in the range of s128 (if it was negative) or
+             * u128 (if it was positive), so there must be a calc width that fits.
              * See if we need to change width to make it fit. */
             selected_width = calc_util_get_changed_width(uval, negative, current_width);
             if (selected_width != current_width)
@@ -1121,14 +1421,15 @@ void calc_set_mode(calc_mode_enum mode)
         }
         else
         {
-            /* The number was outside the range of s64 (if negative) or
-             * u64 (if positive). Just return 0 and leave width unchanged. */
+            /* The number was outside the range of s128 (if negative) or
+             * u128 (if positive). Just return 0 and leave width unchanged. */
             uval = 0;
             msg = negative ? neg_range_warn : pos_range_warn;
         }
 
         save_val.ival = uval;
         integer_width = selected_width;
+        calc_integer_select_ops(integer_width, use_unsigned);
         if (msg != NULL)
         {
             calc_warn(msg);
@@ -1188,20 +1489,21 @@ void calc_clear(void)
         dfp_zero(&dzero);
         stack_push(0, dzero);
     }
+    rational_from_fval(&stack[0]);
     request_display_update();
 }
 
-void calc_set_result_callback(void (*fn)(uint64_t, stackf_t, calc_op_enum))
+void calc_set_result_callback(void (*fn)(calc_int_t, stackf_t, calc_op_enum))
 {
     result_callback = fn;
 }
 
-void calc_set_history_callback(void (*fn)(uint64_t, stackf_t))
+void calc_set_history_callback(void (*fn)(calc_int_t, stackf_t))
 {
     history_callback = fn;
 }
 
-void calc_set_get_best_integer_callback(bool (*fn)(uint64_t*, bool *))
+void calc_set_get_best_integer_callback(bool (*fn)(calc_int_t*, bool *))
 {
     /* For calculating the best integer from a floating point, when doing
      * mode switch from float to integer mode.
@@ -1259,7 +1561,7 @@ bool calc_get_mem_non_zero(unsigned int m)
         return !dfp_is_zero(&mem_val[m].fval);
 }
 
-void calc_get_mem(unsigned int m, uint64_t *ival, stackf_t *fval, bool *was_unsigned)
+void calc_get_mem(unsigned int m, calc_int_t *ival, stackf_t *fval, bool *was_unsigned)
 {
     if (m >= NUM_MEMORY)
     {
@@ -1286,12 +1588,7 @@ static void mask_stack_all(void)
 {
     for (int i = 0; i < stack_num_args(); i++)
     {
-        if (integer_width == calc_width_8)
-            stack[i].ival &= 0xff;
-        else if (integer_width == calc_width_16)
-            stack[i].ival &= 0xffff;
-        else if (integer_width == calc_width_32)
-            stack[i].ival &= 0xffffffff;
+        calc_util_mask_width(&stack[i].ival, integer_width);
     }
     history_update(stack_peek());
 }
@@ -1310,6 +1607,7 @@ void calc_set_use_unsigned(bool en)
         return;
 
     use_unsigned = en;
+    calc_integer_select_ops(integer_width, use_unsigned);
     mask_stack_all();
 }
 
@@ -1318,10 +1616,22 @@ bool calc_get_use_unsigned(void)
     return use_unsigned;
 }
 
-void calc_set_integer_width(calc_width_enum width)
+static bool fixed_fits_width(int frac_bits, calc_width_t width)
+{
+    return frac_bits == 0 || (width <= 64 && frac_bits < width);
+}
+
+static bool lanes_fit_width(int lane_bits, calc_width_t width)
+{
+    return lane_bits == 0 || width % lane_bits == 0;
+}
+
+void calc_set_integer_width(calc_width_t width)
 {
     if (width == integer_width)
         return;
+    if (width < CALC_WIDTH_MIN || width > CALC_WIDTH_MAX)
+        return;
 
     if (!use_unsigned)
     {
@@ -1331,14 +1641,128 @@ void calc_set_integer_width(calc_width_enum width)
     }
     /* update width and mask off at new width */
     integer_width = width;
+    calc_integer_select_ops(integer_width, use_unsigned);
     mask_stack_all();
+
+    if (!fixed_fits_width(fixed_frac, width))
+    {
+        calc_set_fixed_point(0, fixed_saturate);
+        calc_warn(fixed_off_warn);
+    }
+    if (!lanes_fit_width(lanes, width))
+    {
+        calc_set_lanes(0);
+        calc_warn(lanes_off_warn);
+    }
 }
 
-calc_width_enum calc_get_integer_width(void)
+calc_width_t calc_get_integer_width(void)
 {
     return integer_width;
 }
 
+bool calc_set_modulus(uint64_t m)
+{
+    if (m == 1)
+        return false;
+
+    if (m != 0)
+    {
+        calc_set_fixed_point(0, fixed_saturate);
+        calc_set_lanes(0);
+    }
+    modulus = m;
+    calc_integer_set_modulus(m);
+    return true;
+}
+
+uint64_t calc_get_modulus(void)
+{
+    return modulus;
+}
+
+bool calc_set_fixed_point(int frac_bits, bool saturate)
+{
+    if (frac_bits < 0 || !fixed_fits_width(frac_bits, integer_width))
+        return false;
+
+    if (frac_bits != 0)
+    {
+        calc_set_modulus(0);
+        calc_set_lanes(0);
+    }
+    fixed_frac = frac_bits;
+    fixed_saturate = saturate;
+    calc_integer_set_fixed(frac_bits, saturate);
+    /* same bits, different value */
+    request_display_update();
+    return true;
+}
+
+int calc_get_fixed_point_frac(void)
+{
+    return fixed_frac;
+}
+
+bool calc_get_fixed_point_saturate(void)
+{
+    return fixed_saturate;
+}
+
+bool calc_set_lanes(int lane_bits)
+{
+    if (lane_bits != 0 && lane_bits != 8 && lane_bits != 16 &&
+        lane_bits != 32 && lane_bits != 64)
+        return false;
+    if (!lanes_fit_width(lane_bits, integer_width))
+        return false;
+
+    if (lane_bits != 0)
+    {
+        calc_set_modulus(0);
+        calc_set_fixed_point(0, fixed_saturate);
+    }
+    lanes = lane_bits;
+    calc_integer_set_lanes(lane_bits);
+    /* the lanes are shown separately */
+    request_display_update();
+    return true;
+}
+
+int calc_get_lanes(void)
+{
+    return lanes;
+}
+
+void calc_set_rational(calc_rational_enum r)
+{
+    rational = r;
+    /* values already on the stack from their decimal, unless they're
+     * still exact from before */
+    for (int i = 0; i < stack_index; i++)
+    {
+        if (!stack[i].rval_valid)
+            rational_from_fval(&stack[i]);
+    }
+    request_display_update();
+}
+
+calc_rational_enum calc_get_rational(void)
+{
+    return rational;
+}
+
+bool calc_get_rational_top_of_stack(rat_t *r)
+{
+    const stack_el_t *s = stack_peek();
+
+    if (!rational_on() || !s->rval_valid)
+        return false;
+
+    *r = s->rval;
+    return true;
+}
+
 void calc_set_warn_on_signed_overflow(bool en)
 {
     warn_on_signed_overflow = en;
@@ -1361,14 +1785,14 @@ bool calc_get_warn_on_unsigned_overflow(void)
 
 /* Handle this as a special case. Makes most sense to actually treat it like
  * a unary op rather than normal binary xor op. */
-void calc_binary_bit_xor(uint64_t bitmask)
+void calc_binary_bit_xor(calc_int_t bitmask)
 {
     if (calc_mode != calc_mode_integer)
         return;
 
     /* see unary_op function */
 
-    uint64_t iresult;
+    calc_int_t iresult;
     stackf_t fresult;
     stack_el_t arg;
 
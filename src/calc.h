@@ -22,7 +22,9 @@
 #define CALC_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include "calc_types.h"
+#include "rational.h"
 
 /* operations to pass into calculator */
 typedef enum
@@ -92,6 +94,40 @@ typedef enum
     cop_rol,  /* rotate (circular shift) left 1 place */
     cop_ror,  /* rotate (circular shift) right 1 place */
 
+    cop_popcnt, /* number of 1 bits */
+    cop_clz,    /* count leading zeros */
+    cop_ctz,    /* count trailing zeros */
+    cop_parity, /* 1 if odd number of 1 bits */
+    cop_bitrev, /* reverse order of bits */
+    cop_bswap,  /* reverse order of bytes */
+
+    cop_pdep,     /* deposit low bits into the bits set in a mask */
+    cop_pext,     /* extract the bits set in a mask, packed at the bottom */
+    cop_morton2,  /* 2-D Morton (Z-order) interleave of two values */
+    cop_spread2,  /* bit i to bit 2i */
+    cop_compact2, /* every second bit packed together (inverse of spread2) */
+    cop_spread3,  /* bit i to bit 3i */
+    cop_compact3, /* every third bit packed together (inverse of spread3) */
+
+    cop_clmul,  /* carry-less multiply, low half */
+    cop_clmulh, /* carry-less multiply, high half */
+    cop_gf2mod, /* GF(2) polynomial remainder */
+    cop_gf2gcd, /* GF(2) polynomial greatest common divisor */
+
+    cop_isprime,   /* 1 if prime */
+    cop_nextprime, /* smallest prime greater than x */
+    cop_icbrt,     /* integer cube root */
+    cop_ilog2,     /* log2 rounded down */
+    cop_ilog10,    /* log10 rounded down */
+    cop_dlog,      /* discrete log, x with a^x = b in mod m mode */
+
+    cop_lane_adds,  /* saturating add, per lane */
+    cop_lane_subs,  /* saturating subtract, per lane */
+    cop_lane_min,   /* minimum, per lane */
+    cop_lane_max,   /* maximum, per lane */
+    cop_lane_cmpeq, /* all ones in lanes that are equal */
+    cop_lane_cmpgt, /* all ones in lanes where a > b */
+
     cop_int_min, /* get calculator to enter int_min */
 
 } calc_op_enum;
@@ -110,15 +146,21 @@ typedef enum
     calc_angle_grad,
 } calc_angle_enum;
 
-/* widths for integer mode */
+/* float mode rational, off, or shown as eg. 7/3 or mixed as 2 1/3 */
 typedef enum
 {
-    calc_width_8,
-    calc_width_16,
-    calc_width_32,
-    calc_width_64,
-    num_calc_widths
-} calc_width_enum;
+    calc_rational_off,
+    calc_rational_fraction,
+    calc_rational_mixed,
+} calc_rational_enum;
+
+/* width for integer mode, the number of bits, any of CALC_WIDTH_MIN to
+ * CALC_WIDTH_MAX. 8, 16, 32, 64 and 128 have their own (faster) operators,
+ * any other width is masked and sign extended as it goes. */
+typedef int calc_width_t;
+
+#define CALC_WIDTH_MIN 1
+#define CALC_WIDTH_MAX 128
 
 
 /* One off initialisation at startup. */
@@ -126,7 +168,7 @@ void calc_init(int debug_lvl,
                calc_mode_enum mode,
                int rand_range,
                bool sct_round,
-               calc_width_enum width,
+               calc_width_t width,
                bool int_unsigned,
                bool warn_signed,
                bool warn_unsigned);
@@ -138,7 +180,12 @@ void calc_clear(void);
 /* Give value entered by user to calculator.
  * If calc is in integer mode, ival is used, fval don't care (suggest set to dfp zero).
  * If calc is in float mode, fval is used, ival don't care (suggest set to 0). */
-void calc_give_arg(uint64_t ival, stackf_t fval);
+void calc_give_arg(calc_int_t ival, stackf_t fval);
+
+/* Give a float value that is a rounded result, eg. from float history, a
+ * unit conversion or a constant, so in rational mode it doesn't get the
+ * fraction of its decimal. */
+void calc_give_inexact_arg(stackf_t fval);
 
 /* Give operation to calculator. */
 void calc_give_op(calc_op_enum cop);
@@ -159,18 +206,18 @@ bool calc_get_repeated_equals(void);
  * operation. It returns
  * i)  the integer value and the floating point value at the top of stack
  * ii) the operator at the top of the binary operator stack, or cop_nop if it's empty */
-void calc_set_result_callback(void (*fn)(uint64_t, stackf_t, calc_op_enum));
+void calc_set_result_callback(void (*fn)(calc_int_t, stackf_t, calc_op_enum));
 
 /* Set callback that calculator uses to return value that you might
  * want to add to history (optional). */
-void calc_set_history_callback(void (*fn)(uint64_t, stackf_t));
+void calc_set_history_callback(void (*fn)(calc_int_t, stackf_t));
 
 /* Set callback that calculator uses to report parentheses level. */
 void calc_set_num_paren_callback(void (*fn)(int));
 
 /* Set callback for getting the best integer value when converting
  * from a floating point value to integer (during mode switch) */
-void calc_set_get_best_integer_callback(bool (*fn)(uint64_t *, bool *));
+void calc_set_get_best_integer_callback(bool (*fn)(calc_int_t *, bool *));
 
 /* Set callbacks to report warnings/errors to gui. */
 void calc_set_warn_callback(void (*fn)(const char *msg));
@@ -189,15 +236,59 @@ bool calc_get_use_sct_rounding(void);
 bool calc_get_mem_non_zero(unsigned int m);
 
 /* Get the memory values for memory m */
-void calc_get_mem(unsigned int m, uint64_t *ival, stackf_t *fval, bool *was_unsigned);
+void calc_get_mem(unsigned int m, calc_int_t *ival, stackf_t *fval, bool *was_unsigned);
 
 /* select signed or unsigned for integer mode */
 void calc_set_use_unsigned(bool en);
 bool calc_get_use_unsigned(void);
 
-/* set integer width to 8, 16, 32 or 64 bits */
-void calc_set_integer_width(calc_width_enum width);
-calc_width_enum calc_get_integer_width(void);
+/* set integer width, CALC_WIDTH_MIN to CALC_WIDTH_MAX bits */
+void calc_set_integer_width(calc_width_t width);
+calc_width_t calc_get_integer_width(void);
+
+/* Integer mode mod m, where + - * pow and 1/x are done mod m, from 2 to
+ * 2^64 - 1, or 0 for normal arithmetic. Returns false for 1. */
+bool calc_set_modulus(uint64_t m);
+uint64_t calc_get_modulus(void);
+
+/* Integer mode fixed point (Q format), where the low frac_bits of the
+ * value are the fraction, or 0 for plain integers. The width must be 64
+ * or less and more than frac_bits, else returns false (and it's turned
+ * off if the width changes to one like that). + - * / sqr sqrt 1/x are
+ * rounded to nearest, and either saturate or wrap at the ends of the
+ * range. Setting it turns off mod m and vice versa. */
+bool calc_set_fixed_point(int frac_bits, bool saturate);
+int calc_get_fixed_point_frac(void);
+bool calc_get_fixed_point_saturate(void);
+
+/* the real value of an integer mode value in the fixed point format */
+void calc_fixed_to_dfp(calc_int_t ival, stackf_t *r);
+
+/* Integer mode lanes (SWAR), where + - * / % and +/- work separately on
+ * each lane of lane_bits (8, 16, 32 or 64), 0 for off. The width must be a
+ * multiple of lane_bits, else returns false (and it's turned off if the
+ * width changes to one like that). The lane ops (saturating add etc.)
+ * work on the whole width as one lane when off. Setting it turns off mod
+ * m and fixed point, and they turn it off. */
+bool calc_set_lanes(int lane_bits);
+int calc_get_lanes(void);
+
+/* Float mode rational, where + - * / +/- sqr and 1/x on exact fractions
+ * give exact fractions, up to a 128 bit numerator and denominator. Values
+ * entered are taken exactly from their decimal. Other ops (sqrt, sin
+ * etc.), and results that don't fit, carry on as decimal float. The
+ * decimal float is kept as the nearest to the fraction, so it's what the
+ * display shows and what is used when leaving the mode. */
+void calc_set_rational(calc_rational_enum r);
+calc_rational_enum calc_get_rational(void);
+
+/* the floating mode value at the top of stack, to all its digits rather
+ * than as displayed */
+stackf_t calc_get_fval_top_of_stack(void);
+
+/* the top of stack as an exact fraction, false if it isn't one (or not
+ * in rational mode) */
+bool calc_get_rational_top_of_stack(rat_t *r);
 
 void calc_set_warn_on_signed_overflow(bool en);
 bool calc_get_warn_on_signed_overflow(void);
@@ -206,53 +297,55 @@ void calc_set_warn_on_unsigned_overflow(bool en);
 bool calc_get_warn_on_unsigned_overflow(void);
 
 /* special case for toggling bits in the binary display */
-void calc_binary_bit_xor(uint64_t bitmask);
+void calc_binary_bit_xor(calc_int_t bitmask);
 
-/* Convert content of str using strtoull.
+/* Convert content of str, as strtoull would but to 128 bits.
  * The result is returned in *val and is truncated according to the width.
- * Return false if the strtoull converison overflows or if the result
+ * Return false if the converison overflows 128 bits or if the result
  * was outside the range of the width. */
 bool calc_util_unsigned_str_to_ival(const char *str,
-                                    calc_width_enum width,
-                                    uint64_t *val,
+                                    calc_width_t width,
+                                    calc_int_t *val,
                                     int base);
 
-/* Convert content of str using strtoll.
+/* Convert content of str, as strtoll would but to 128 bits.
  * The result is returned in *val and is truncated according to the width.
- * Return false if the strtoll converison overflows or if the result
+ * Return false if the converison overflows 128 bits or if the result
  * was outside the range of the width. */
 bool calc_util_signed_str_to_ival(const char *str,
-                                  calc_width_enum width,
-                                  uint64_t *val,
+                                  calc_width_t width,
+                                  calc_int_t *val,
                                   int base);
 
 
-/* The values in the uint64 are always masked off to the width eg. for
- * width=8, a value of -1 is held as 0x00000000000000ff. This function
- * takes that uint64 value and converts to int64 with sign extension,
- * so afterwards the int64 would hold 0xffffffffffffffff */
-int64_t calc_util_get_signed(uint64_t x, calc_width_enum width);
+/* all ones in the low width bits */
+calc_int_t calc_util_width_mask(calc_width_t width);
+
+/* The values in the calc_int_t are always masked off to the width eg. for
+ * width=8, a value of -1 is held as 0x...000000ff. This function
+ * takes that value and converts to calc_sint_t with sign extension,
+ * so afterwards it would hold 0x...ffffffff */
+calc_sint_t calc_util_get_signed(calc_int_t x, calc_width_t width);
 
-/* is x in the signed range of the width (useful for widths 8,16,32,
- * will always return true for width 64) */
-bool calc_util_is_in_signed_range(int64_t x, calc_width_enum width);
+/* is x in the signed range of the width (always true for width 128) */
+bool calc_util_is_in_signed_range(calc_sint_t x, calc_width_t width);
 
-/* is x in the unsigned range of the width (useful for widths 8,16,32,
- * will always return true for width 64) */
-bool calc_util_is_in_unsigned_range(uint64_t x, calc_width_enum width);
+/* is x in the unsigned range of the width (always true for width 128) */
+bool calc_util_is_in_unsigned_range(calc_int_t x, calc_width_t width);
 
 /* mask off x to the width */
-void calc_util_mask_width(uint64_t *x, calc_width_enum width);
+void calc_util_mask_width(calc_int_t *x, calc_width_t width);
 
 
 /* When changing from float to integer mode, or pasting in a value in
  * integer mode, decide if the current integer width is enough, or does
  * it need to be increased.
- * uval is either a positive value in range of u64 (negative==false) or
- * represents a negative value in range of s64 (negative==true).
- * A value in the range of INT8_MIN up to UINT8_MAX requires width 8.
- * A value in the range of INT16_MIN up to UINT16_MAX requires width 16 etc.
+ * uval is either a positive value (negative==false) or represents a
+ * negative value as a calc_sint_t (negative==true).
+ * If the value doesn't fit the current width, the width goes up to the
+ * smallest of 8, 16, 32, 64 or 128 that it does fit eg. a value in the
+ * range of INT16_MIN up to UINT16_MAX requires width 16.
  * Return the width required, which will be >= current_width.*/
-calc_width_enum calc_util_get_changed_width(uint64_t uval, bool negative,
-                                            calc_width_enum current_width);
+calc_width_t calc_util_get_changed_width(calc_int_t uval, bool negative,
+                                         calc_width_t current_width);
 #endif
@@ -0,0 +1,449 @@
+/*****************************************************************************
+ * File calc_bigint.c part of ProgAndSciCalc
+ *
+ * Copyright (C) 2018 Ken Bromham
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <string.h>
+#include <ctype.h>
+#include <setjmp.h>
+
+#include "calc_bigint.h"
+#include "calc.h"
+
+/* Same priorities as the calculator, see calc.c */
+#define PRIORITY_ADD_SUB      0
+#define PRIORITY_MUL_DIV      1
+#define PRIORITY_POWER_ROOT   2
+
+/* deepest nesting of parentheses etc, so the recursion is limited */
+#define MAX_DEPTH 100
+
+static const char *err_syntax = "Syntax error";
+static const char *err_div_zero = "Divide by 0";
+static const char *err_too_large = "Result too large";
+static const char *err_negative = "Negative argument";
+static const char *err_too_deep = "Too many parentheses";
+
+typedef const char *(*big_op_fn)(bn_arena_t *ar, bn_t *r,
+                                 const bn_t *a, const bn_t *b);
+
+typedef struct
+{
+    const char *token;
+    calc_op_enum cop;
+    int priority;
+    big_op_fn fn;
+} big_op_t;
+
+typedef struct
+{
+    bn_arena_t *ar;
+    const char *p;
+    int depth;
+    /* jumped to with the error message */
+    jmp_buf err_jmp;
+    const char *err;
+} parser_t;
+
+
+/* fits in an unsigned long, for exponents, shifts, factorial */
+static bool get_count(const bn_t *a, unsigned long *n)
+{
+    if (a->neg || bn_bit_length(a) > 32)
+    {
+        return false;
+    }
+    *n = (unsigned long)bn_to_u128(a);
+    return true;
+}
+
+static const char *big_add(bn_arena_t *ar, bn_t *r, const bn_t *a, const bn_t *b)
+{
+    bn_add(ar, r, a, b);
+    return NULL;
+}
+
+static const char *big_sub(bn_arena_t *ar, bn_t *r, const bn_t *a, const bn_t *b)
+{
+    bn_sub(ar, r, a, b);
+    return NULL;
+}
+
+static const char *big_and(bn_arena_t *ar, bn_t *r, const bn_t *a, const bn_t *b)
+{
+    bn_and(ar, r, a, b);
+    return NULL;
+}
+
+static const char *big_or(bn_arena_t *ar, bn_t *r, const bn_t *a, const bn_t *b)
+{
+    bn_or(ar, r, a, b);
+    return NULL;
+}
+
+static const char *big_xor(bn_arena_t *ar, bn_t *r, const bn_t *a, const bn_t *b)
+{
+    bn_xor(ar, r, a, b);
+    return NULL;
+}
+
+static const char *big_mul(bn_arena_t *ar, bn_t *r, const bn_t *a, const bn_t *b)
+{
+    return bn_mul(ar, r, a, b) ? NULL : err_too_large;
+}
+
+static const char *big_div(bn_arena_t *ar, bn_t *r, const bn_t *a, const bn_t *b)
+{
+    return bn_divmod(ar, r, NULL, a, b) ? NULL : err_div_zero;
+}
+
+static const char *big_mod(bn_arena_t *ar, bn_t *r, const bn_t *a, const bn_t *b)
+{
+    return bn_divmod(ar, NULL, r, a, b) ? NULL : err_div_zero;
+}
+
+static const char *big_left_shift(bn_arena_t *ar, bn_t *r, const bn_t *a,
+                                  const bn_t *b)
+{
+    unsigned long n;
+
+    if (b->neg)
+    {
+        return err_negative;
+    }
+    if (!get_count(b, &n) || !bn_shl(ar, r, a, n))
+    {
+        return err_too_large;
+    }
+    return NULL;
+}
+
+static const char *big_right_shift(bn_arena_t *ar, bn_t *r, const bn_t *a,
+                                   const bn_t *b)
+{
+    unsigned long n;
+
+    if (b->neg)
+    {
+        return err_negative;
+    }
+    if (!get_count(b, &n))
+    {
+        /* shifted right that far there's nothing left but the sign */
+        bn_from_s128(ar, r, a->neg ? -1 : 0);
+        return NULL;
+    }
+    bn_shr(ar, r, a, n);
+    return NULL;
+}
+
+static const char *big_pow(bn_arena_t *ar, bn_t *r, const bn_t *a, const bn_t *b)
+{
+    unsigned long e;
+
+    if (b->neg)
+    {
+        return err_negative;
+    }
+    /* 0, 1 and -1 to any power are small */
+    if (bn_bit_length(a) <= 1 && !get_count(b, &e))
+    {
+        bn_t two;
+        bn_from_u128(ar, &two, 2);
+        bn_divmod(ar, NULL, &two, b, &two);
+        e = bn_is_zero(&two) ? 2 : 1;
+    }
+    else if (!get_count(b, &e))
+    {
+        return err_too_large;
+    }
+    return bn_pow(ar, r, a, e) ? NULL : err_too_large;
+}
+
+static const big_op_t big_ops[] =
+{
+    /* longest first where one is the start of another */
+    { "**",  cop_pow,     PRIORITY_POWER_ROOT, big_pow },
+    { "<<",  cop_lsftn,   PRIORITY_MUL_DIV,    big_left_shift },
+    { ">>",  cop_rsftn,   PRIORITY_MUL_DIV,    big_right_shift },
+    { "mod", cop_mod,     PRIORITY_MUL_DIV,    big_mod },
+    { "+",   cop_add,     PRIORITY_ADD_SUB,    big_add },
+    { "-",   cop_sub,     PRIORITY_ADD_SUB,    big_sub },
+    { "&",   cop_and,     PRIORITY_ADD_SUB,    big_and },
+    { "|",   cop_or,      PRIORITY_ADD_SUB,    big_or },
+    { "^",   cop_xor,     PRIORITY_ADD_SUB,    big_xor },
+    { "*",   cop_mul,     PRIORITY_MUL_DIV,    big_mul },
+    { "/",   cop_div,     PRIORITY_MUL_DIV,    big_div },
+    { "%",   cop_mod,     PRIORITY_MUL_DIV,    big_mod },
+};
+#define NUM_BIG_OPS (int)(sizeof(big_ops) / sizeof(big_ops[0]))
+
+
+static void fail(parser_t *ps, const char *err)
+{
+    ps->err = err;
+    longjmp(ps->err_jmp, 1);
+}
+
+static void check(parser_t *ps, const char *err)
+{
+    if (err != NULL)
+    {
+        fail(ps, err);
+    }
+}
+
+static void skip_space(parser_t *ps)
+{
+    while (isspace((unsigned char)*ps->p))
+    {
+        ps->p++;
+    }
+}
+
+/* consume token if it's next */
+static bool accept(parser_t *ps, const char *token)
+{
+    size_t len = strlen(token);
+
+    skip_space(ps);
+    if (strncmp(ps->p, token, len) != 0)
+    {
+        return false;
+    }
+    /* a word mustn't run on into another */
+    if (isalpha((unsigned char)token[0]) && isalnum((unsigned char)ps->p[len]))
+    {
+        return false;
+    }
+    ps->p += len;
+    return true;
+}
+
+static void expect(parser_t *ps, const char *token)
+{
+    if (!accept(ps, token))
+    {
+        fail(ps, err_syntax);
+    }
+}
+
+/* the binary operator next, NULL if none */
+static const big_op_t *peek_op(parser_t *ps)
+{
+    skip_space(ps);
+    for (int i = 0; i < NUM_BIG_OPS; i++)
+    {
+        size_t len = strlen(big_ops[i].token);
+        if (strncmp(ps->p, big_ops[i].token, len) == 0
+            && !(isalpha((unsigned char)big_ops[i].token[0])
+                 && isalnum((unsigned char)ps->p[len])))
+        {
+            return &big_ops[i];
+        }
+    }
+    return NULL;
+}
+
+static void parse_expr(parser_t *ps, bn_t *r, int min_priority);
+
+static bool is_digit_of(char c, int base)
+{
+    switch (base)
+    {
+    case 2:
+        return c == '0' || c == '1';
+    case 8:
+        return c >= '0' && c <= '7';
+    case 16:
+        return isxdigit((unsigned char)c);
+    default:
+        return isdigit((unsigned char)c);
+    }
+}
+
+static void parse_number(parser_t *ps, bn_t *r)
+{
+    const char *start;
+    int base = 10;
+
+    if (ps->p[0] == '0')
+    {
+        switch (tolower((unsigned char)ps->p[1]))
+        {
+        case 'x':
+            base = 16;
+            break;
+        case 'o':
+            base = 8;
+            break;
+        case 'b':
+            base = 2;
+            break;
+        default:
+            break;
+        }
+        if (base != 10)
+        {
+            ps->p += 2;
+        }
+    }
+    start = ps->p;
+    while (is_digit_of(*ps->p, base))
+    {
+        ps->p++;
+    }
+    if (ps->p == start || isalnum((unsigned char)*ps->p))
+    {
+        fail(ps, err_syntax);
+    }
+    if (!bn_from_string(ps->ar, r, start, ps->p - start, base))
+    {
+        fail(ps, err_too_large);
+    }
+}
+
+static void parse_args(parser_t *ps, bn_t *args, int num)
+{
+    expect(ps, "(");
+    for (int i = 0; i < num; i++)
+    {
+        if (i > 0)
+        {
+            expect(ps, ",");
+        }
+        parse_expr(ps, &args[i], PRIORITY_ADD_SUB);
+    }
+    expect(ps, ")");
+}
+
+/* a number, function, or parenthesised expression, with any unary
+ * operators before it and factorials after it */
+static void parse_unary(parser_t *ps, bn_t *r)
+{
+    skip_space(ps);
+    if (++ps->depth > MAX_DEPTH)
+    {
+        fail(ps, err_too_deep);
+    }
+
+    if (accept(ps, "-"))
+    {
+        parse_unary(ps, r);
+        bn_neg(ps->ar, r, r);
+    }
+    else if (accept(ps, "+"))
+    {
+        parse_unary(ps, r);
+    }
+    else if (accept(ps, "~"))
+    {
+        parse_unary(ps, r);
+        bn_not(ps->ar, r, r);
+    }
+    else
+    {
+        if (accept(ps, "("))
+        {
+            parse_expr(ps, r, PRIORITY_ADD_SUB);
+            expect(ps, ")");
+        }
+        else if (accept(ps, "gcd"))
+        {
+            bn_t args[2];
+            parse_args(ps, args, 2);
+            bn_gcd(ps->ar, r, &args[0], &args[1]);
+        }
+        else if (accept(ps, "powmod"))
+        {
+            bn_t args[3];
+            parse_args(ps, args, 3);
+            if (args[1].neg)
+            {
+                fail(ps, err_negative);
+            }
+            if (!bn_powmod(ps->ar, r, &args[0], &args[1], &args[2]))
+            {
+                fail(ps, err_div_zero);
+            }
+        }
+        else if (isdigit((unsigned char)*ps->p))
+        {
+            parse_number(ps, r);
+        }
+        else
+        {
+            fail(ps, err_syntax);
+        }
+
+        while (accept(ps, "!"))
+        {
+            unsigned long n;
+            if (r->neg)
+            {
+                fail(ps, err_negative);
+            }
+            if (!get_count(r, &n) || !bn_factorial(ps->ar, r, n))
+            {
+                fail(ps, err_too_large);
+            }
+        }
+    }
+    ps->depth--;
+}
+
+/* Operands and operators with priority at least min_priority. Power is
+ * right to left so its right operand takes the same priority again, the
+ * others left to right so theirs only takes higher. */
+static void parse_expr(parser_t *ps, bn_t *r, int min_priority)
+{
+    const big_op_t *op;
+
+    parse_unary(ps, r);
+    while ((op = peek_op(ps)) != NULL && op->priority >= min_priority)
+    {
+        bn_t rhs;
+        int next = op->cop == cop_pow ? op->priority : op->priority + 1;
+
+        ps->p += strlen(op->token);
+        parse_expr(ps, &rhs, next);
+        check(ps, op->fn(ps->ar, r, r, &rhs));
+    }
+}
+
+const char *calc_bigint_eval(bn_arena_t *ar, const char *expr, bn_t *result)
+{
+    /* static as it's changed between setjmp and longjmp */
+    static parser_t ps;
+
+    ps.ar = ar;
+    ps.p = expr;
+    ps.depth = 0;
+    ps.err = NULL;
+
+    if (setjmp(ps.err_jmp) == 0)
+    {
+        parse_expr(&ps, result, PRIORITY_ADD_SUB);
+        skip_space(&ps);
+        if (*ps.p != '\0')
+        {
+            fail(&ps, err_syntax);
+        }
+    }
+    return ps.err;
+}
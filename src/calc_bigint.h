@@ -0,0 +1,41 @@
+/*****************************************************************************
+ * File calc_bigint.h part of ProgAndSciCalc
+ *
+ * Copyright (C) 2018 Ken Bromham
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef CALC_BIGINT_H
+#define CALC_BIGINT_H
+
+#include "bignum.h"
+
+/* Evaluate an integer expression of any size, for the Big Integer window.
+ *
+ * Numbers are decimal, or hex with 0x, octal with 0o, binary with 0b.
+ * Operators, with the same priorities as the calculator keys:
+ *   + - & | ^         add, subtract, and, or, xor
+ *   * / % mod << >>   multiply, divide and remainder (truncating as C),
+ *                     shifts
+ *   **                power (right to left)
+ * and unary - + ~, postfix ! (factorial), parentheses, and the functions
+ * gcd(a, b) and powmod(a, e, m).
+ *
+ * Returns NULL and sets *result (allocated from ar) if ok, otherwise an
+ * error message. */
+const char *calc_bigint_eval(bn_arena_t *ar, const char *expr, bn_t *result);
+
+#endif
@@ -487,7 +487,7 @@ void calc_conversion_apply_result(ucv_enum category, int row)
         dfp_zero(&fval);
     }
 
-    calc_give_arg(0, fval);
+    calc_give_inexact_arg(fval);
     calc_give_op(cop_peek);
 }
 
@@ -558,7 +558,7 @@ void calc_constants_apply_result(const char *value)
 {
     stackf_t fval;
     dfp_from_string(&fval, value, &dfp_context);
-    calc_give_arg(0, fval);
+    calc_give_inexact_arg(fval);
     calc_give_op(cop_peek);
 }
 
@@ -557,7 +557,7 @@ stackf_t fop_inv_tanh(stackf_t arg)
     return res;
 }
 
-#define MAX_FACTORIAL "2123"
+#define MAX_FACTORIAL 2123
 
 stackf_t fop_fact(stackf_t arg)
 {
@@ -566,10 +566,10 @@ stackf_t fop_fact(stackf_t arg)
     stackf_t res;
     stackf_t one;
     stackf_t max;
-    int32_t n;
+    int64_t n;
 
     dfp_from_string(&one, "1.0", &dfp_context);
-    dfp_from_string(&max, MAX_FACTORIAL, &dfp_context);
+    dfp_from_int64(&max, MAX_FACTORIAL);
 
     if (dfp_is_nan(&arg) || dfp_is_negative(&arg))
     {
@@ -583,10 +583,9 @@ stackf_t fop_fact(stackf_t arg)
         return arg;
     }
 
-    n = dfp_to_int32(&arg, &dfp_context, DEC_ROUND_HALF_UP);
-    //printf("n = %d\n", n);
+    (void)dfp_to_int64(&arg, DEC_ROUND_HALF_UP, &n);
 
-    dfp_from_int32(&arg, n);
+    dfp_from_int64(&arg, n);
     res = one;
 
     while (n > 1)
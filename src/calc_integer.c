@@ -19,17 +19,20 @@
 
 
 #include "calc_internal.h"
+#include "bitops.h"
+#include "gf2.h"
+#include "ntheory.h"
 
 /*
  * Operations for integer mode.
- * For integer mode, all values are stored and passed around as a uint64_t.
+ * For integer mode, all values are stored and passed around as a calc_int_t.
  * There is an assumption of a twos complement target where the bit
  * pattern is the same for unsigned/signed, and in particular a conversion
  * from unsigned to signed will never do anything unexpected (ie. for the
  * case where the unsigned value is outside the range of the signed
  * type).
- * The value in the uint64 is always masked off to the width eg. for signed
- * 8 bit, a value of -1 will be held in the uint64 as 0x00000000000000ff.
+ * The value in the calc_int_t is always masked off to the width eg. for
+ * signed 8 bit, a value of -1 will be held as 0x...000000ff.
  * The masking is applied at the end of every operation (not always
  * necessary, but harmless to just do it).
  *
@@ -41,6 +44,12 @@ static const char *signed_overflow_msg = "Signed Integer Overflow";
 static const char *unsigned_overflow_msg = "Unsigned Integer Overflow";
 static const char *shift_range_msg = "Shift Out of Range";
 static const char *div0_msg = "Divide by 0";
+static const char *bswap_width_msg = "Width Not a Multiple of 8";
+static const char *negative_arg_msg = "Requires a Positive Value";
+static const char *no_modulus_msg = "Requires a Modulus (mod m)";
+static const char *no_inverse_msg = "No Inverse mod m";
+static const char *no_dlog_msg = "No Solution";
+static const char *dlog_range_msg = "Modulus Too Large for Discrete Log";
 
 static void calc_signed_overflow_warn(void)
 {
@@ -54,663 +63,1285 @@ static void calc_unsigned_overflow_warn(void)
         calc_warn(unsigned_overflow_msg);
 }
 
-/* for debug print */
-//#define DBGP(x) printf x
-#define DBGP(x) ((void)0)
+/*
+ * Each operation is generated once for every width and signedness, working
+ * in the C type of that width (eg. int8_t for signed 8 bit) so the result
+ * is masked to the width just by converting back to the unsigned type of
+ * the width, and overflow is checked with __builtin_add_overflow etc. The
+ * set of operations for the width and signedness in use is selected when
+ * either changes (calc_integer_select_ops), so the operations themselves
+ * don't need to look at them.
+ */
+
+typedef struct
+{
+    calc_int_t (*plusminus)(calc_int_t arg);
+    calc_int_t (*complement)(calc_int_t arg);
+    calc_int_t (*left_shift1)(calc_int_t arg);
+    calc_int_t (*right_shift1)(calc_int_t arg);
+    calc_int_t (*rol)(calc_int_t arg);
+    calc_int_t (*ror)(calc_int_t arg);
+    calc_int_t (*add)(calc_int_t a, calc_int_t b);
+    calc_int_t (*sub)(calc_int_t a, calc_int_t b);
+    calc_int_t (*mul)(calc_int_t a, calc_int_t b);
+    calc_int_t (*div)(calc_int_t a, calc_int_t b);
+    calc_int_t (*mod)(calc_int_t a, calc_int_t b);
+    calc_int_t (*and)(calc_int_t a, calc_int_t b);
+    calc_int_t (*or)(calc_int_t a, calc_int_t b);
+    calc_int_t (*xor)(calc_int_t a, calc_int_t b);
+    calc_int_t (*left_shift)(calc_int_t a, calc_int_t b);
+    calc_int_t (*right_shift)(calc_int_t a, calc_int_t b);
+} int_ops_t;
+
+/* T is the type to work in, UT the unsigned type of the same width, TMIN
+ * the smallest value of T, SIGNED 1 for signed types, WARN the overflow
+ * warning. Values are passed in and out as calc_int_t masked to the width,
+ * (T)(UT)a gives the value as T (twos complement). */
+#define DEFINE_INT_OPS(sfx, T, UT, BITS, TMIN, SIGNED, WARN)                 \
+                                                                             \
+static calc_int_t plusminus_##sfx(calc_int_t arg)                            \
+{                                                                            \
+    T x = (T)(UT)arg;                                                        \
+    if (SIGNED && x == TMIN)                                                 \
+    {                                                                        \
+        WARN();                                                              \
+        return arg;                                                          \
+    }                                                                        \
+    return (UT)(0 - x);                                                      \
+}                                                                            \
+                                                                             \
+static calc_int_t complement_##sfx(calc_int_t arg)                           \
+{                                                                            \
+    return (UT)~arg;                                                         \
+}                                                                            \
+                                                                             \
+static calc_int_t left_shift1_##sfx(calc_int_t arg)                          \
+{                                                                            \
+    return (UT)(arg << 1);                                                   \
+}                                                                            \
+                                                                             \
+static calc_int_t right_shift1_##sfx(calc_int_t arg)                         \
+{                                                                            \
+    /* arithmetic shift for signed */                                        \
+    return (UT)((T)(UT)arg >> 1);                                            \
+}                                                                            \
+                                                                             \
+static calc_int_t rol_##sfx(calc_int_t arg)                                  \
+{                                                                            \
+    return (UT)((arg << 1) | (arg >> (BITS - 1)));                           \
+}                                                                            \
+                                                                             \
+static calc_int_t ror_##sfx(calc_int_t arg)                                  \
+{                                                                            \
+    return (UT)((arg >> 1) | (arg << (BITS - 1)));                           \
+}                                                                            \
+                                                                             \
+static calc_int_t add_##sfx(calc_int_t a, calc_int_t b)                      \
+{                                                                            \
+    T res;                                                                   \
+    if (__builtin_add_overflow((T)(UT)a, (T)(UT)b, &res))                    \
+        WARN();                                                              \
+    return (UT)res;                                                          \
+}                                                                            \
+                                                                             \
+static calc_int_t sub_##sfx(calc_int_t a, calc_int_t b)                      \
+{                                                                            \
+    T res;                                                                   \
+    if (__builtin_sub_overflow((T)(UT)a, (T)(UT)b, &res))                    \
+        WARN();                                                              \
+    return (UT)res;                                                          \
+}                                                                            \
+                                                                             \
+static calc_int_t mul_##sfx(calc_int_t a, calc_int_t b)                      \
+{                                                                            \
+    T res;                                                                   \
+    if (__builtin_mul_overflow((T)(UT)a, (T)(UT)b, &res))                    \
+        WARN();                                                              \
+    return (UT)res;                                                          \
+}                                                                            \
+                                                                             \
+static calc_int_t div_##sfx(calc_int_t a, calc_int_t b)                      \
+{                                                                            \
+    T x = (T)(UT)a;                                                          \
+    T y = (T)(UT)b;                                                          \
+    if (y == 0)                                                              \
+    {                                                                        \
+        calc_warn(div0_msg);                                                 \
+        return 0;                                                            \
+    }                                                                        \
+    if (SIGNED && x == TMIN && y == (T)-1)                                   \
+    {                                                                        \
+        WARN();                                                              \
+        return a;                                                            \
+    }                                                                        \
+    return (UT)(x / y);                                                      \
+}                                                                            \
+                                                                             \
+static calc_int_t mod_##sfx(calc_int_t a, calc_int_t b)                      \
+{                                                                            \
+    T x = (T)(UT)a;                                                          \
+    T y = (T)(UT)b;                                                          \
+    if (y == 0)                                                              \
+    {                                                                        \
+        calc_warn(div0_msg);                                                 \
+        return 0;                                                            \
+    }                                                                        \
+    if (SIGNED && x == TMIN && y == (T)-1)                                   \
+    {                                                                        \
+        /* does this count as overflow? */                                   \
+        return 0;                                                            \
+    }                                                                        \
+    return (UT)(x % y);                                                      \
+}                                                                            \
+                                                                             \
+static calc_int_t and_##sfx(calc_int_t a, calc_int_t b)                      \
+{                                                                            \
+    return (UT)(a & b);                                                      \
+}                                                                            \
+                                                                             \
+static calc_int_t or_##sfx(calc_int_t a, calc_int_t b)                       \
+{                                                                            \
+    return (UT)(a | b);                                                      \
+}                                                                            \
+                                                                             \
+static calc_int_t xor_##sfx(calc_int_t a, calc_int_t b)                      \
+{                                                                            \
+    return (UT)(a ^ b);                                                      \
+}                                                                            \
+                                                                             \
+static calc_int_t left_shift_##sfx(calc_int_t a, calc_int_t b)               \
+{                                                                            \
+    if (b >= BITS)                                                           \
+    {                                                                        \
+        calc_warn(shift_range_msg);                                          \
+        return a;                                                            \
+    }                                                                        \
+    return (UT)(a << b);                                                     \
+}                                                                            \
+                                                                             \
+static calc_int_t right_shift_##sfx(calc_int_t a, calc_int_t b)              \
+{                                                                            \
+    if (b >= BITS)                                                           \
+    {                                                                        \
+        calc_warn(shift_range_msg);                                          \
+        return a;                                                            \
+    }                                                                        \
+    /* arithmetic shift for signed */                                        \
+    return (UT)((T)(UT)a >> b);                                              \
+}                                                                            \
+                                                                             \
+static const int_ops_t int_ops_##sfx =                                       \
+{                                                                            \
+    plusminus_##sfx, complement_##sfx, left_shift1_##sfx,                    \
+    right_shift1_##sfx, rol_##sfx, ror_##sfx, add_##sfx, sub_##sfx,          \
+    mul_##sfx, div_##sfx, mod_##sfx, and_##sfx, or_##sfx, xor_##sfx,         \
+    left_shift_##sfx, right_shift_##sfx,                                     \
+};
+
+DEFINE_INT_OPS(u8,   uint8_t,     uint8_t,    8,   0,             0, calc_unsigned_overflow_warn)
+DEFINE_INT_OPS(s8,   int8_t,      uint8_t,    8,   INT8_MIN,      1, calc_signed_overflow_warn)
+DEFINE_INT_OPS(u16,  uint16_t,    uint16_t,   16,  0,             0, calc_unsigned_overflow_warn)
+DEFINE_INT_OPS(s16,  int16_t,     uint16_t,   16,  INT16_MIN,     1, calc_signed_overflow_warn)
+DEFINE_INT_OPS(u32,  uint32_t,    uint32_t,   32,  0,             0, calc_unsigned_overflow_warn)
+DEFINE_INT_OPS(s32,  int32_t,     uint32_t,   32,  INT32_MIN,     1, calc_signed_overflow_warn)
+DEFINE_INT_OPS(u64,  uint64_t,    uint64_t,   64,  0,             0, calc_unsigned_overflow_warn)
+DEFINE_INT_OPS(s64,  int64_t,     uint64_t,   64,  INT64_MIN,     1, calc_signed_overflow_warn)
+DEFINE_INT_OPS(u128, calc_int_t,  calc_int_t, 128, 0,             0, calc_unsigned_overflow_warn)
+DEFINE_INT_OPS(s128, calc_sint_t, calc_int_t, 128, CALC_SINT_MIN, 1, calc_signed_overflow_warn)
+
+
+/*
+ * Any other width works in calc_int_t/calc_sint_t, using the mask for the
+ * width and the shift that sign extends from it, which are worked out when
+ * the width is selected. The width is less than 128 so sign extended
+ * values can be added or subtracted without overflowing calc_sint_t, and
+ * overflow is just the result being outside the range of the width.
+ */
+static calc_int_t width_mask;
+static int width_bits;
+static int sign_shift;
+static calc_sint_t width_smin;
+static calc_sint_t width_smax;
 
+static calc_sint_t sign_extend(calc_int_t x)
+{
+    return (calc_sint_t)(x << sign_shift) >> sign_shift;
+}
 
-static bool is_int_min(int64_t x, calc_width_enum width)
+static bool outside_signed_range(calc_sint_t x)
 {
-    switch (width)
+    return x < width_smin || x > width_smax;
+}
+
+static calc_int_t plusminus_uw(calc_int_t arg)
+{
+    return (0 - arg) & width_mask;
+}
+
+static calc_int_t complement_uw(calc_int_t arg)
+{
+    return ~arg & width_mask;
+}
+
+static calc_int_t left_shift1_uw(calc_int_t arg)
+{
+    return (arg << 1) & width_mask;
+}
+
+static calc_int_t right_shift1_uw(calc_int_t arg)
+{
+    return arg >> 1;
+}
+
+static calc_int_t rol_uw(calc_int_t arg)
+{
+    return ((arg << 1) | (arg >> (width_bits - 1))) & width_mask;
+}
+
+static calc_int_t ror_uw(calc_int_t arg)
+{
+    return ((arg >> 1) | (arg << (width_bits - 1))) & width_mask;
+}
+
+static calc_int_t add_uw(calc_int_t a, calc_int_t b)
+{
+    calc_int_t res;
+    if (__builtin_add_overflow(a, b, &res) || res > width_mask)
+        calc_unsigned_overflow_warn();
+    return res & width_mask;
+}
+
+static calc_int_t sub_uw(calc_int_t a, calc_int_t b)
+{
+    if (b > a)
+        calc_unsigned_overflow_warn();
+    return (a - b) & width_mask;
+}
+
+static calc_int_t mul_uw(calc_int_t a, calc_int_t b)
+{
+    calc_int_t res;
+    if (__builtin_mul_overflow(a, b, &res) || res > width_mask)
+        calc_unsigned_overflow_warn();
+    return res & width_mask;
+}
+
+static calc_int_t div_uw(calc_int_t a, calc_int_t b)
+{
+    if (b == 0)
     {
-    case calc_width_8:
-        return x == INT8_MIN;
-    case calc_width_16:
-        return x == INT16_MIN;
-    case calc_width_32:
-        return x == INT32_MIN;
-    default:
-        return x == INT64_MIN;
+        calc_warn(div0_msg);
+        return 0;
     }
+    return a / b;
 }
 
-static bool is_shift_valid(uint64_t x, calc_width_enum width)
+static calc_int_t mod_uw(calc_int_t a, calc_int_t b)
 {
-    switch (width)
+    if (b == 0)
     {
-    case calc_width_8:
-        return x < 8;
-    case calc_width_16:
-        return x < 16;
-    case calc_width_32:
-        return x < 32;
-    default:
-        return x < 64;
+        calc_warn(div0_msg);
+        return 0;
     }
+    return a % b;
 }
 
-/* unary ops */
+static calc_int_t and_uw(calc_int_t a, calc_int_t b)
+{
+    return a & b & width_mask;
+}
 
-uint64_t iop_plusminus(uint64_t arg)
+static calc_int_t or_uw(calc_int_t a, calc_int_t b)
 {
-    uint64_t res;
-    calc_width_enum width = calc_get_integer_width();
+    return (a | b) & width_mask;
+}
+
+static calc_int_t xor_uw(calc_int_t a, calc_int_t b)
+{
+    return (a ^ b) & width_mask;
+}
 
-    if (calc_get_use_unsigned())
+static calc_int_t left_shift_uw(calc_int_t a, calc_int_t b)
+{
+    if (b >= (calc_int_t)width_bits)
     {
-        res = -arg;
+        calc_warn(shift_range_msg);
+        return a;
     }
-    else
+    return (a << b) & width_mask;
+}
+
+static calc_int_t right_shift_uw(calc_int_t a, calc_int_t b)
+{
+    if (b >= (calc_int_t)width_bits)
     {
-        int64_t sa = calc_util_get_signed(arg, width);
-        if (is_int_min(sa, width))
-        {
-            calc_signed_overflow_warn();
-            return arg;
-        }
-        sa = -sa;
-        res = sa;
+        calc_warn(shift_range_msg);
+        return a;
     }
-
-    DBGP(("op res before %016" PRIx64 "\n", res));
-    calc_util_mask_width(&res, width);
-    DBGP(("op res after %016" PRIx64 "\n", res));
-    return res;
+    return a >> b;
 }
 
-uint64_t iop_complement(uint64_t arg)
+/* signed, where different from unsigned */
+
+static calc_int_t plusminus_sw(calc_int_t arg)
 {
-    uint64_t res;
-    calc_width_enum width = calc_get_integer_width();
+    calc_sint_t x = sign_extend(arg);
+    if (x == width_smin)
+    {
+        calc_signed_overflow_warn();
+        return arg;
+    }
+    return (calc_int_t)-x & width_mask;
+}
 
-    res = ~arg;
+static calc_int_t right_shift1_sw(calc_int_t arg)
+{
+    /* arithmetic shift */
+    return (calc_int_t)(sign_extend(arg) >> 1) & width_mask;
+}
 
-    DBGP(("op res before %016" PRIx64 "\n", res));
-    calc_util_mask_width(&res, width);
-    DBGP(("op res after %016" PRIx64 "\n", res));
-    return res;
+static calc_int_t add_sw(calc_int_t a, calc_int_t b)
+{
+    calc_sint_t res;
+    if (__builtin_add_overflow(sign_extend(a), sign_extend(b), &res)
+        || outside_signed_range(res))
+        calc_signed_overflow_warn();
+    return (calc_int_t)res & width_mask;
 }
 
-uint64_t iop_square(uint64_t arg)
+static calc_int_t sub_sw(calc_int_t a, calc_int_t b)
 {
-    return bin_iop_mul(arg, arg);
+    calc_sint_t res;
+    if (__builtin_sub_overflow(sign_extend(a), sign_extend(b), &res)
+        || outside_signed_range(res))
+        calc_signed_overflow_warn();
+    return (calc_int_t)res & width_mask;
 }
 
-#if 0
-static const char *sqrt_msg = "sqrt of negative number";
+static calc_int_t mul_sw(calc_int_t a, calc_int_t b)
+{
+    calc_sint_t res;
+    if (__builtin_mul_overflow(sign_extend(a), sign_extend(b), &res)
+        || outside_signed_range(res))
+        calc_signed_overflow_warn();
+    return (calc_int_t)res & width_mask;
+}
 
-uint64_t iop_square_root(uint64_t arg)
+static calc_int_t div_sw(calc_int_t a, calc_int_t b)
 {
-    uint64_t res;
-    calc_width_enum width = calc_get_integer_width();
+    calc_sint_t x = sign_extend(a);
+    calc_sint_t y = sign_extend(b);
+    if (y == 0)
+    {
+        calc_warn(div0_msg);
+        return 0;
+    }
+    if (x == width_smin && y == -1)
+    {
+        calc_signed_overflow_warn();
+        return a;
+    }
+    return (calc_int_t)(x / y) & width_mask;
+}
 
-    if (calc_get_use_unsigned())
+static calc_int_t mod_sw(calc_int_t a, calc_int_t b)
+{
+    calc_sint_t x = sign_extend(a);
+    calc_sint_t y = sign_extend(b);
+    if (y == 0)
     {
-        res = sqrt((double)arg);
+        calc_warn(div0_msg);
+        return 0;
     }
-    else
+    if (x == width_smin && y == -1)
     {
-        int64_t sa = calc_util_get_signed(arg, width);
-        if (sa < 0)
-        {
-            calc_warn(sqrt_msg);
-            return arg;
-        }
-        sa = sqrt((double)sa);
-        res = sa;
+        return 0;
     }
+    return (calc_int_t)(x % y) & width_mask;
+}
 
-    DBGP(("op res before %016" PRIx64 "\n", res));
-    calc_util_mask_width(&res, width);
-    DBGP(("op res after %016" PRIx64 "\n", res));
-    return res;
+static calc_int_t right_shift_sw(calc_int_t a, calc_int_t b)
+{
+    if (b >= (calc_int_t)width_bits)
+    {
+        calc_warn(shift_range_msg);
+        return a;
+    }
+    /* arithmetic shift */
+    return (calc_int_t)(sign_extend(a) >> b) & width_mask;
 }
-#endif
 
-#if 0
-uint64_t iop_2powx(uint64_t arg)
+static const int_ops_t int_ops_uw =
 {
-    uint64_t res;
-    calc_width_enum width = calc_get_integer_width();
+    plusminus_uw, complement_uw, left_shift1_uw, right_shift1_uw, rol_uw,
+    ror_uw, add_uw, sub_uw, mul_uw, div_uw, mod_uw, and_uw, or_uw, xor_uw,
+    left_shift_uw, right_shift_uw,
+};
+
+static const int_ops_t int_ops_sw =
+{
+    plusminus_sw, complement_uw, left_shift1_uw, right_shift1_sw, rol_uw,
+    ror_uw, add_sw, sub_sw, mul_sw, div_sw, mod_sw, and_uw, or_uw, xor_uw,
+    left_shift_uw, right_shift_sw,
+};
+
+
+/* the calc defaults, signed 64 bit. int_ops is width_ops unless one of the
+ * modes below is on, then it's mode_ops: width_ops with the arithmetic
+ * replaced by that of the mode (install_ops). */
+static const int_ops_t *width_ops = &int_ops_s64;
+static const int_ops_t *int_ops = &int_ops_s64;
+static int_ops_t mode_ops;
+
+/* for the bit counting ops, which work the same for every width */
+static calc_width_t ops_width = 64;
+static bool ops_unsigned = false;
+
+/* 0, or arithmetic is mod this */
+static uint64_t ops_modulus;
 
-    if (!is_shift_valid(arg, width))
+/* 0, or fixed point with this many fraction bits */
+static int ops_frac;
+static bool ops_saturate;
+
+/* 0, or + - * / work on lanes of this many bits */
+static int ops_lanes;
+
+static void install_ops(void);
+
+
+void calc_integer_select_ops(calc_width_t width, bool use_unsigned)
+{
+    ops_width = width;
+    ops_unsigned = use_unsigned;
+    switch (width)
     {
-        calc_warn(input_range_msg);
-        return arg;
+    case 8:
+        width_ops = use_unsigned ? &int_ops_u8 : &int_ops_s8;
+        break;
+    case 16:
+        width_ops = use_unsigned ? &int_ops_u16 : &int_ops_s16;
+        break;
+    case 32:
+        width_ops = use_unsigned ? &int_ops_u32 : &int_ops_s32;
+        break;
+    case 64:
+        width_ops = use_unsigned ? &int_ops_u64 : &int_ops_s64;
+        break;
+    case 128:
+        width_ops = use_unsigned ? &int_ops_u128 : &int_ops_s128;
+        break;
+    default:
+        width_bits = width;
+        width_mask = calc_util_width_mask(width);
+        sign_shift = CALC_WIDTH_MAX - width;
+        width_smin = -((calc_sint_t)1 << (width - 1));
+        width_smax = -width_smin - 1;
+        width_ops = use_unsigned ? &int_ops_uw : &int_ops_sw;
+        break;
     }
+    install_ops();
+}
 
-    res = 1ULL << arg;
 
-    DBGP(("op res before %016" PRIx64 "\n", res));
-    calc_util_mask_width(&res, width);
-    DBGP(("op res after %016" PRIx64 "\n", res));
-    return res;
+/* unary ops */
+
+calc_int_t iop_plusminus(calc_int_t arg)
+{
+    return int_ops->plusminus(arg);
 }
-#endif
 
-uint64_t iop_left_shift(uint64_t arg)
+calc_int_t iop_complement(calc_int_t arg)
 {
-    uint64_t res;
-    calc_width_enum width = calc_get_integer_width();
+    return int_ops->complement(arg);
+}
 
-    res = arg << 1;
+calc_int_t iop_square(calc_int_t arg)
+{
+    return bin_iop_mul(arg, arg);
+}
 
-    DBGP(("op res before %016" PRIx64 "\n", res));
-    calc_util_mask_width(&res, width);
-    DBGP(("op res after %016" PRIx64 "\n", res));
-    return res;
+calc_int_t iop_left_shift(calc_int_t arg)
+{
+    return int_ops->left_shift1(arg);
 }
 
-uint64_t iop_right_shift(uint64_t arg)
+calc_int_t iop_right_shift(calc_int_t arg)
 {
-    uint64_t res;
-    calc_width_enum width = calc_get_integer_width();
+    return int_ops->right_shift1(arg);
+}
 
-    if (calc_get_use_unsigned())
-    {
-        res = arg >> 1;
-    }
-    else
+/* rotate (circular shift) left 1 place */
+calc_int_t iop_rol(calc_int_t arg)
+{
+    return int_ops->rol(arg);
+}
+
+/* rotate (circular shift) right 1 place */
+calc_int_t iop_ror(calc_int_t arg)
+{
+    return int_ops->ror(arg);
+}
+
+/* A non negative result, which can be too big for the width as signed or
+ * unsigned (eg. 2 bit signed only goes up to 1), in which case it wraps the
+ * same as any other overflow. */
+static calc_int_t positive_result(calc_int_t n)
+{
+    calc_int_t mask = calc_util_width_mask(ops_width);
+    calc_int_t max = ops_unsigned ? mask : mask >> 1;
+
+    if (n > max)
     {
-        int64_t sa = calc_util_get_signed(arg, width);
-        sa = sa >> 1;
-        res = sa;
+        if (ops_unsigned)
+            calc_unsigned_overflow_warn();
+        else
+            calc_signed_overflow_warn();
     }
+    return n & mask;
+}
 
-    DBGP(("op res before %016" PRIx64 "\n", res));
-    calc_util_mask_width(&res, width);
-    DBGP(("op res after %016" PRIx64 "\n", res));
-    return res;
+/* a bit count as a result */
+static calc_int_t count_result(int n)
+{
+    return positive_result((calc_int_t)n);
 }
 
-/* rotate (circular shift) left 1 place */
-uint64_t iop_rol(uint64_t arg)
-{
-    uint64_t res;
-    calc_width_enum width = calc_get_integer_width();
-
-    int rs;
-    if (width == calc_width_8)
-        rs = 7;
-    else if (width == calc_width_16)
-        rs = 15;
-    else if (width == calc_width_32)
-        rs = 31;
-    else
-        rs = 63;
-
-    res = (arg << 1) | (arg >> rs);
-
-    DBGP(("op res before %016" PRIx64 "\n", res));
-    calc_util_mask_width(&res, width);
-    DBGP(("op res after %016" PRIx64 "\n", res));
-    return res;
+static bool is_negative(calc_int_t arg)
+{
+    return !ops_unsigned && calc_util_get_signed(arg, ops_width) < 0;
 }
 
-/* rotate (circular shift) right 1 place */
-uint64_t iop_ror(uint64_t arg)
-{
-    uint64_t res;
-    calc_width_enum width = calc_get_integer_width();
-
-    int ls;
-    if (width == calc_width_8)
-        ls = 7;
-    else if (width == calc_width_16)
-        ls = 15;
-    else if (width == calc_width_32)
-        ls = 31;
-    else
-        ls = 63;
-
-    res = (arg >> 1) | (arg << ls);
-
-    DBGP(("op res before %016" PRIx64 "\n", res));
-    calc_util_mask_width(&res, width);
-    DBGP(("op res after %016" PRIx64 "\n", res));
-    return res;
+/* absolute value, as unsigned so it can't overflow */
+static calc_int_t magnitude(calc_int_t arg)
+{
+    return is_negative(arg) ? (0 - arg) & calc_util_width_mask(ops_width) : arg;
 }
 
+/* number of 1 bits */
+calc_int_t iop_popcount(calc_int_t arg)
+{
+    return count_result(bitops_popcount(arg));
+}
 
-/* binary ops */
+/* count leading zeros, the width if arg is 0 */
+calc_int_t iop_clz(calc_int_t arg)
+{
+    return count_result(bitops_clz(arg, ops_width));
+}
 
-static bool range_test_add64(int64_t a, int64_t b)
+/* count trailing zeros, the width if arg is 0 */
+calc_int_t iop_ctz(calc_int_t arg)
 {
-    bool ok = true;
+    return count_result(bitops_ctz(arg, ops_width));
+}
 
-    if (b > 0)
-    {
-        if (a > INT64_MAX - b)
-            ok = false;
-    }
-    else
+/* 1 if odd number of 1 bits */
+calc_int_t iop_parity(calc_int_t arg)
+{
+    return count_result(bitops_parity(arg));
+}
+
+/* reverse order of bits within the width */
+calc_int_t iop_bitrev(calc_int_t arg)
+{
+    return bitops_reverse(arg, ops_width);
+}
+
+/* reverse order of bytes, the width must be whole bytes */
+calc_int_t iop_bswap(calc_int_t arg)
+{
+    if (ops_width % 8 != 0)
     {
-        if (a < INT64_MIN - b)
-            ok = false;
+        calc_warn(bswap_width_msg);
+        return arg;
     }
+    return bitops_byteswap(arg, ops_width);
+}
 
-    return ok;
+/* Morton (Z-order) helpers, anything spread beyond the width is lost */
+calc_int_t iop_spread2(calc_int_t arg)
+{
+    return bitops_spread2(arg) & calc_util_width_mask(ops_width);
 }
 
-uint64_t bin_iop_add(uint64_t a, uint64_t b)
+calc_int_t iop_compact2(calc_int_t arg)
 {
-    uint64_t res;
-    calc_width_enum width = calc_get_integer_width();
+    return bitops_compact2(arg);
+}
 
-    if (calc_get_use_unsigned())
-    {
-        bool ok;
+calc_int_t iop_spread3(calc_int_t arg)
+{
+    return bitops_spread3(arg) & calc_util_width_mask(ops_width);
+}
 
-        res = a + b;
+calc_int_t iop_compact3(calc_int_t arg)
+{
+    return bitops_compact3(arg);
+}
 
-        if (width < calc_width_64)
-        {
-            ok = calc_util_is_in_unsigned_range(res, width);
-        }
-        else
-        {
-            ok = res >= a;
-        }
-        if (!ok)
-        {
-            calc_unsigned_overflow_warn();
-        }
-    }
-    else
-    {
-        int64_t sa = calc_util_get_signed(a, width);
-        int64_t sb = calc_util_get_signed(b, width);
-        int64_t sres;
-        bool ok;
 
-        if (width < calc_width_64)
-        {
-            /* easy, do operation in the wider int64 type then check result */
-            sres = sa + sb;
-            ok = calc_util_is_in_signed_range(sres, width);
-        }
-        else
-        {
-            /* do a range test first, but then go ahead anyway */
-            ok = range_test_add64(sa, sb);
-            sres = sa + sb;
-        }
-        if (!ok)
-        {
-            calc_signed_overflow_warn();
-        }
-        res = sres;
+/* integer square root (rounded down) */
+calc_int_t iop_square_root(calc_int_t arg)
+{
+    if (is_negative(arg))
+    {
+        calc_warn(negative_arg_msg);
+        return arg;
     }
+    /* for fixed point sqrt(x 2^n) = sqrt(x) 2^n/2, so another n/2 */
+    return nt_isqrt(arg << ops_frac);
+}
 
-    DBGP(("op res before %016" PRIx64 "\n", res));
-    calc_util_mask_width(&res, width);
-    DBGP(("op res after %016" PRIx64 "\n", res));
-    return res;
+/* integer cube root, rounded towards 0 */
+calc_int_t iop_cube_root(calc_int_t arg)
+{
+    calc_int_t r = nt_icbrt(magnitude(arg));
+    return is_negative(arg) ? (0 - r) & calc_util_width_mask(ops_width) : r;
 }
 
-static bool range_test_sub64(int64_t a, int64_t b)
+/* 1 if prime, negative values are never prime */
+calc_int_t iop_is_prime(calc_int_t arg)
 {
-    bool ok = true;
+    return count_result(!is_negative(arg) && nt_is_prime(arg));
+}
 
-    if (b > 0)
+/* smallest prime greater than arg, overflows if there isn't one in the
+ * width */
+calc_int_t iop_next_prime(calc_int_t arg)
+{
+    calc_int_t p;
+
+    if (is_negative(arg))
+        return positive_result(2);
+    p = nt_next_prime(arg);
+    if (p == 0)
     {
-        if (a < INT64_MIN + b)
-            ok = false;
+        /* none below 2^128 */
+        calc_unsigned_overflow_warn();
+        return 0;
     }
-    else
+    return positive_result(p);
+}
+
+/* floor of log2 and log10, arg must be at least 1 */
+calc_int_t iop_ilog2(calc_int_t arg)
+{
+    if (arg == 0 || is_negative(arg))
     {
-        if (a > INT64_MAX + b)
-            ok = false;
+        calc_warn(negative_arg_msg);
+        return arg;
     }
+    return count_result(nt_ilog2(arg));
+}
 
-    return ok;
+calc_int_t iop_ilog10(calc_int_t arg)
+{
+    if (arg == 0 || is_negative(arg))
+    {
+        calc_warn(negative_arg_msg);
+        return arg;
+    }
+    return count_result(nt_ilog10(arg));
 }
 
-uint64_t bin_iop_sub(uint64_t a, uint64_t b)
+
+/*
+ * Fixed point (Q format), where the low ops_frac bits are the fraction.
+ * Only for widths up to 64, so exact results (the full product, or the
+ * dividend shifted up) fit in 128 bits, then get rounded to nearest with
+ * halves rounded up, and either saturate or wrap.
+ */
+
+void calc_integer_set_fixed(int frac_bits, bool saturate)
 {
-    uint64_t res;
-    calc_width_enum width = calc_get_integer_width();
+    ops_frac = frac_bits;
+    ops_saturate = saturate;
+    install_ops();
+}
 
-    if (calc_get_use_unsigned())
-    {
-        bool ok;
+static calc_sint_t fixed_val(calc_int_t arg)
+{
+    return ops_unsigned ? (calc_sint_t)arg : calc_util_get_signed(arg, ops_width);
+}
 
-        res = a - b;
+static calc_int_t fixed_result(calc_sint_t x)
+{
+    calc_sint_t lo = ops_unsigned ? 0 : -((calc_sint_t)1 << (ops_width - 1));
+    calc_sint_t hi = ops_unsigned ? ((calc_sint_t)1 << ops_width) - 1
+                                  : ((calc_sint_t)1 << (ops_width - 1)) - 1;
 
-        if (width < calc_width_64)
-        {
-            ok = calc_util_is_in_unsigned_range(res, width);
-        }
-        else
-        {
-            ok = res <= a;
-        }
-        if (!ok)
-        {
-            calc_unsigned_overflow_warn();
-        }
-    }
-    else
+    if (x < lo || x > hi)
     {
-        int64_t sa = calc_util_get_signed(a, width);
-        int64_t sb = calc_util_get_signed(b, width);
-        int64_t sres;
-        bool ok;
-
-        if (width < calc_width_64)
-        {
-            /* easy, do operation in the wider int64 type then check result */
-            sres = sa - sb;
-            ok = calc_util_is_in_signed_range(sres, width);
-        }
+        if (ops_saturate)
+            x = x < lo ? lo : hi;
+        else if (ops_unsigned)
+            calc_unsigned_overflow_warn();
         else
-        {
-            /* do a range test first, but then go ahead anyway */
-            ok = range_test_sub64(sa, sb);
-            sres = sa - sb;
-        }
-        if (!ok)
-        {
             calc_signed_overflow_warn();
-        }
-        res = sres;
     }
+    return (calc_int_t)x & calc_util_width_mask(ops_width);
+}
 
-    DBGP(("op res before %016" PRIx64 "\n", res));
-    calc_util_mask_width(&res, width);
-    DBGP(("op res after %016" PRIx64 "\n", res));
-    return res;
+static calc_int_t add_fixed(calc_int_t a, calc_int_t b)
+{
+    return fixed_result(fixed_val(a) + fixed_val(b));
 }
 
-static bool range_test_mul64(int64_t a, int64_t b)
+static calc_int_t sub_fixed(calc_int_t a, calc_int_t b)
 {
-    if (a == 0 || b == 0)
-        return true;
-    if (a == 1 || b == 1)
-        return true;
+    return fixed_result(fixed_val(a) - fixed_val(b));
+}
 
-    bool ok = true;
+static calc_int_t mul_fixed(calc_int_t a, calc_int_t b)
+{
+    calc_int_t half = (calc_int_t)1 << (ops_frac - 1);
 
-    if (a > 0 && b > 0)
+    if (ops_unsigned)
     {
-        if (a > INT64_MAX / b)
-            ok = false;
+        /* up to 128 bits, so unsigned */
+        return fixed_result((calc_sint_t)((a * b + half) >> ops_frac));
     }
-    else if (a < 0 && b < 0)
+    /* arithmetic shift, so rounds towards +infinity */
+    return fixed_result((fixed_val(a) * fixed_val(b) + (calc_sint_t)half)
+                        >> ops_frac);
+}
+
+/* x / y for the values (not the bit patterns) */
+static calc_int_t div_fixed_val(calc_sint_t x, calc_sint_t y)
+{
+    calc_sint_t num = x * ((calc_sint_t)1 << ops_frac);
+    calc_sint_t den = y;
+    calc_sint_t q, r;
+
+    if (den == 0)
     {
-        if (a < INT64_MAX / b)
-            ok = false;
+        calc_warn(div0_msg);
+        return 0;
     }
-    else if (a > 0 && b < 0)
+    if (den < 0)
     {
-        if (b < INT64_MIN / a)
-            ok = false;
+        num = -num;
+        den = -den;
     }
-    else if (a < 0 && b > 0)
+    /* floor, then up if the remainder is at least half */
+    q = num / den;
+    r = num % den;
+    if (r < 0)
     {
-        if (a < INT64_MIN / b)
-            ok = false;
+        q--;
+        r += den;
     }
+    if (2 * r >= den)
+        q++;
+    return fixed_result(q);
+}
+
+static calc_int_t div_fixed(calc_int_t a, calc_int_t b)
+{
+    return div_fixed_val(fixed_val(a), fixed_val(b));
+}
+
+
+/*
+ * mod m mode, where + - * and the power are done mod m (any m from 2 to
+ * 2^64 - 1). Arguments are reduced to 0 to m - 1 first (so -1 is m - 1)
+ * and that's where results are too, overflowing if they don't fit the
+ * width.
+ */
+
+void calc_integer_set_modulus(uint64_t m)
+{
+    ops_modulus = m;
+    install_ops();
+}
+
+static uint64_t residue(calc_int_t arg)
+{
+    uint64_t r = (uint64_t)(magnitude(arg) % ops_modulus);
+    return is_negative(arg) && r != 0 ? ops_modulus - r : r;
+}
 
-    return ok;
+static calc_int_t add_mod(calc_int_t a, calc_int_t b)
+{
+    uint64_t x = residue(a);
+    uint64_t y = residue(b);
+    /* x + y - m without overflowing */
+    return positive_result(x >= ops_modulus - y ? x - (ops_modulus - y) : x + y);
 }
 
-uint64_t bin_iop_mul(uint64_t a, uint64_t b)
+static calc_int_t sub_mod(calc_int_t a, calc_int_t b)
 {
-    uint64_t res;
-    calc_width_enum width = calc_get_integer_width();
+    uint64_t x = residue(a);
+    uint64_t y = residue(b);
+    return positive_result(x >= y ? x - y : x + (ops_modulus - y));
+}
+
+static calc_int_t mul_mod(calc_int_t a, calc_int_t b)
+{
+    return positive_result(nt_mulmod(residue(a), residue(b), ops_modulus));
+}
 
-    if (calc_get_use_unsigned())
+/* 1/x mod m, or in fixed point */
+calc_int_t iop_one_over_x(calc_int_t arg)
+{
+    uint64_t inv;
+
+    if (ops_frac != 0)
+        return div_fixed_val((calc_sint_t)1 << ops_frac, fixed_val(arg));
+    if (ops_modulus == 0)
+    {
+        calc_warn(no_modulus_msg);
+        return arg;
+    }
+    if (!nt_modinv(residue(arg), ops_modulus, &inv))
     {
-        bool ok;
+        calc_warn(no_inverse_msg);
+        return arg;
+    }
+    return positive_result(inv);
+}
 
-        res = a * b;
+/* a^b mod m, a negative b is a power of the inverse */
+calc_int_t bin_iop_pow(calc_int_t a, calc_int_t b)
+{
+    uint64_t base;
 
-        if (width < calc_width_64)
-        {
-            ok = calc_util_is_in_unsigned_range(res, width);
-        }
-        else
-        {
-            ok = (b == 0) || (a == res / b);
-        }
-        if (!ok)
-        {
-            calc_unsigned_overflow_warn();
-        }
+    if (ops_modulus == 0)
+    {
+        calc_warn(no_modulus_msg);
+        return a;
     }
-    else
+    base = residue(a);
+    if (is_negative(b) && !nt_modinv(base, ops_modulus, &base))
     {
-        int64_t sa = calc_util_get_signed(a, width);
-        int64_t sb = calc_util_get_signed(b, width);
-        int64_t sres;
-        bool ok;
+        calc_warn(no_inverse_msg);
+        return a;
+    }
+    return positive_result(nt_powmod(base, magnitude(b), ops_modulus));
+}
 
-        if (width < calc_width_64)
-        {
-            /* easy, do operation in the wider int64 type then check result */
-            sres = sa * sb;
-            ok = calc_util_is_in_signed_range(sres, width);
-        }
-        else
-        {
-            /* do a range test first, but then go ahead anyway */
-            ok = range_test_mul64(sa, sb);
-            sres = sa * sb;
-        }
-        if (!ok)
-        {
-            calc_signed_overflow_warn();
-        }
-        res = sres;
+/* discrete log, the smallest x with a^x = b mod m */
+calc_int_t bin_iop_dlog(calc_int_t a, calc_int_t b)
+{
+    uint64_t x;
+
+    if (ops_modulus == 0)
+    {
+        calc_warn(no_modulus_msg);
+        return a;
     }
+    switch (nt_dlog(residue(a), residue(b), ops_modulus, &x))
+    {
+    case NT_DLOG_FOUND:
+        return positive_result(x);
+    case NT_DLOG_NONE:
+        calc_warn(no_dlog_msg);
+        return a;
+    default:
+        calc_warn(dlog_range_msg);
+        return a;
+    }
+}
 
-    DBGP(("op res before %016" PRIx64 "\n", res));
-    calc_util_mask_width(&res, width);
-    DBGP(("op res after %016" PRIx64 "\n", res));
-    return res;
+
+/*
+ * Lanes (SWAR, SIMD within a register), where the value is a row of
+ * independent lanes of ops_lanes bits, as when debugging SIMD code.
+ * + - * / and +/- work per lane, wrapping with no overflow warning as
+ * the SIMD instructions do. Add and subtract are done on all the lanes at
+ * once, by keeping carries out of the top bit of each lane; the rest go
+ * lane by lane. The saturating, min, max and compare ops below treat the
+ * whole width as one lane when lanes are off.
+ */
+
+void calc_integer_set_lanes(int lane_bits)
+{
+    ops_lanes = lane_bits;
+    install_ops();
 }
 
-uint64_t bin_iop_div(uint64_t a, uint64_t b)
+/* lane width, the lsb and msb of every lane, and the width mask */
+typedef struct
 {
-    if (b == 0)
+    int bits;
+    calc_int_t lo;
+    calc_int_t hi;
+    calc_int_t mask;
+} lanes_t;
+
+static void get_lanes(lanes_t *ln)
+{
+    ln->bits = ops_lanes != 0 ? ops_lanes : ops_width;
+    ln->mask = calc_util_width_mask(ops_width);
+    ln->lo = 0;
+    for (int i = 0; i < ops_width; i += ln->bits)
     {
-        calc_warn(div0_msg);
-        return 0;
+        ln->lo |= (calc_int_t)1 << i;
     }
+    ln->hi = ln->lo << (ln->bits - 1);
+}
+
+/* lanes with the msb set (in h) to all ones, others to 0 */
+static calc_int_t lane_fill(const lanes_t *ln, calc_int_t h)
+{
+    return (h - (h >> (ln->bits - 1))) | h;
+}
+
+static calc_int_t lane_add(const lanes_t *ln, calc_int_t a, calc_int_t b)
+{
+    return (((a & ~ln->hi) + (b & ~ln->hi)) ^ ((a ^ b) & ln->hi)) & ln->mask;
+}
 
-    uint64_t res;
-    calc_width_enum width = calc_get_integer_width();
+static calc_int_t lane_sub(const lanes_t *ln, calc_int_t a, calc_int_t b)
+{
+    return (((a | ln->hi) - (b & ~ln->hi)) ^ ((a ^ ~b) & ln->hi)) & ln->mask;
+}
 
-    if (calc_get_use_unsigned())
+/* msb set in the lanes where a > b as unsigned, the borrow out of b - a */
+static calc_int_t lane_ugt(const lanes_t *ln, calc_int_t a, calc_int_t b)
+{
+    calc_int_t d = lane_sub(ln, b, a);
+    return ((~b & a) | ((~b | a) & d)) & ln->hi;
+}
+
+/* msb set in the lanes where a > b, signed or unsigned as the calculator
+ * is. Flipping the sign bits turns signed order into unsigned order. */
+static calc_int_t lane_gt(const lanes_t *ln, calc_int_t a, calc_int_t b)
+{
+    if (!ops_unsigned)
     {
-        res = a / b;
+        a ^= ln->hi;
+        b ^= ln->hi;
     }
-    else
-    {
-        int64_t sa = calc_util_get_signed(a, width);
-        int64_t sb = calc_util_get_signed(b, width);
-        int64_t sres;
+    return lane_ugt(ln, a, b);
+}
 
-        if (is_int_min(sa, width) && sb == -1)
-        {
-            calc_signed_overflow_warn();
-            return a;
-        }
-        sres = sa / sb;
-        res = sres;
-    }
+/* the largest value in lanes where a is positive, smallest where negative */
+static calc_int_t lane_signed_limit(const lanes_t *ln, calc_int_t a)
+{
+    return ((~ln->hi & ln->mask) ^ lane_fill(ln, a & ln->hi));
+}
 
-    DBGP(("op res before %016" PRIx64 "\n", res));
-    calc_util_mask_width(&res, width);
-    DBGP(("op res after %016" PRIx64 "\n", res));
+/* a lane as a value, sign extended if signed */
+static calc_sint_t lane_val(calc_int_t a, int shift)
+{
+    calc_int_t x = (a >> shift) & calc_util_width_mask(ops_lanes);
+    return ops_unsigned ? (calc_sint_t)x : calc_util_get_signed(x, ops_lanes);
+}
+
+/* lane by lane, for the ops that don't have a SWAR trick. Lanes are at
+ * most 64 bits so nothing overflows 128 bits before being wrapped to the
+ * lane. */
+static calc_int_t lane_each(calc_int_t a, calc_int_t b,
+                            calc_int_t (*op)(calc_sint_t, calc_sint_t))
+{
+    calc_int_t lane_mask = calc_util_width_mask(ops_lanes);
+    calc_int_t res = 0;
+
+    for (int i = 0; i < ops_width; i += ops_lanes)
+    {
+        res |= (op(lane_val(a, i), lane_val(b, i)) & lane_mask) << i;
+    }
     return res;
 }
 
-uint64_t bin_iop_mod(uint64_t a, uint64_t b)
+static calc_int_t lane_op_mul(calc_sint_t x, calc_sint_t y)
 {
-    if (b == 0)
+    return (calc_int_t)x * (calc_int_t)y;
+}
+
+static calc_int_t lane_op_div(calc_sint_t x, calc_sint_t y)
+{
+    if (y == 0)
     {
         calc_warn(div0_msg);
         return 0;
     }
+    return (calc_int_t)(x / y);
+}
 
-    uint64_t res;
-    calc_width_enum width = calc_get_integer_width();
-
-    if (calc_get_use_unsigned())
+static calc_int_t lane_op_mod(calc_sint_t x, calc_sint_t y)
+{
+    if (y == 0)
     {
-        res = a % b;
+        calc_warn(div0_msg);
+        return 0;
     }
-    else
+    return (calc_int_t)(x % y);
+}
+
+static calc_int_t add_lanes(calc_int_t a, calc_int_t b)
+{
+    lanes_t ln;
+
+    get_lanes(&ln);
+    return lane_add(&ln, a, b);
+}
+
+static calc_int_t sub_lanes(calc_int_t a, calc_int_t b)
+{
+    lanes_t ln;
+
+    get_lanes(&ln);
+    return lane_sub(&ln, a, b);
+}
+
+static calc_int_t mul_lanes(calc_int_t a, calc_int_t b)
+{
+    return lane_each(a, b, lane_op_mul);
+}
+
+static calc_int_t div_lanes(calc_int_t a, calc_int_t b)
+{
+    return lane_each(a, b, lane_op_div);
+}
+
+static calc_int_t mod_lanes(calc_int_t a, calc_int_t b)
+{
+    return lane_each(a, b, lane_op_mod);
+}
+
+/* saturating add and subtract */
+calc_int_t bin_iop_lane_adds(calc_int_t a, calc_int_t b)
+{
+    lanes_t ln;
+    calc_int_t s, over;
+
+    get_lanes(&ln);
+    s = lane_add(&ln, a, b);
+    if (ops_unsigned)
     {
-        int64_t sa = calc_util_get_signed(a, width);
-        int64_t sb = calc_util_get_signed(b, width);
-        int64_t sres;
+        /* carry out of the lane */
+        over = ((a & b) | ((a | b) & ~s)) & ln.hi;
+        return s | lane_fill(&ln, over);
+    }
+    /* same signs in, different sign out */
+    over = lane_fill(&ln, ~(a ^ b) & (a ^ s) & ln.hi);
+    return (s & ~over) | (lane_signed_limit(&ln, a) & over);
+}
 
-        if (is_int_min(sa, width) && sb == -1)
-        {
-            /* does this count as overflow? */
-            return 0;
-        }
-        sres = sa % sb;
-        res = sres;
+calc_int_t bin_iop_lane_subs(calc_int_t a, calc_int_t b)
+{
+    lanes_t ln;
+    calc_int_t d, over;
+
+    get_lanes(&ln);
+    d = lane_sub(&ln, a, b);
+    if (ops_unsigned)
+    {
+        /* borrow out of the lane */
+        over = ((~a & b) | ((~a | b) & d)) & ln.hi;
+        return d & ~lane_fill(&ln, over);
     }
+    /* different signs in, sign out not that of a */
+    over = lane_fill(&ln, (a ^ b) & (a ^ d) & ln.hi);
+    return (d & ~over) | (lane_signed_limit(&ln, a) & over);
+}
 
-    DBGP(("op res before %016" PRIx64 "\n", res));
-    calc_util_mask_width(&res, width);
-    DBGP(("op res after %016" PRIx64 "\n", res));
-    return res;
+calc_int_t bin_iop_lane_min(calc_int_t a, calc_int_t b)
+{
+    lanes_t ln;
+    calc_int_t gt;
+
+    get_lanes(&ln);
+    gt = lane_fill(&ln, lane_gt(&ln, a, b));
+    return (b & gt) | (a & ~gt);
+}
+
+calc_int_t bin_iop_lane_max(calc_int_t a, calc_int_t b)
+{
+    lanes_t ln;
+    calc_int_t gt;
+
+    get_lanes(&ln);
+    gt = lane_fill(&ln, lane_gt(&ln, a, b));
+    return (a & gt) | (b & ~gt);
+}
+
+/* Compares give all ones in the lanes where true, 0 where false. A lane
+ * of x = a ^ b is 0 if adding all ones to its low bits doesn't carry
+ * into the msb, and the msb itself is 0. */
+calc_int_t bin_iop_lane_cmpeq(calc_int_t a, calc_int_t b)
+{
+    lanes_t ln;
+    calc_int_t x, nonzero;
+
+    get_lanes(&ln);
+    x = a ^ b;
+    nonzero = (((x & ~ln.hi) + (~ln.hi & ln.mask)) | x) & ln.hi;
+    return lane_fill(&ln, ~nonzero & ln.hi);
 }
 
-uint64_t bin_iop_gcd(uint64_t a, uint64_t b)
+calc_int_t bin_iop_lane_cmpgt(calc_int_t a, calc_int_t b)
 {
-    uint64_t res;
-    calc_width_enum width = calc_get_integer_width();
+    lanes_t ln;
+
+    get_lanes(&ln);
+    return lane_fill(&ln, lane_gt(&ln, a, b));
+}
 
-    if (calc_get_use_unsigned())
+
+/* +/- as 0 - arg, for the modes */
+static calc_int_t plusminus_mode(calc_int_t arg)
+{
+    return mode_ops.sub(0, arg);
+}
+
+/* Select the ops for the modes that are on, so the ops below are a single
+ * call through int_ops. mod m takes + - * over fixed point, which takes
+ * + - * / over lanes, and the ops the modes don't change (the logical
+ * ops and shifts) stay those of the width. */
+static void install_ops(void)
+{
+    if (ops_modulus == 0 && ops_frac == 0 && ops_lanes == 0)
+    {
+        int_ops = width_ops;
+        return;
+    }
+
+    mode_ops = *width_ops;
+    if (ops_lanes != 0)
+    {
+        mode_ops.plusminus = plusminus_mode;
+        mode_ops.add = add_lanes;
+        mode_ops.sub = sub_lanes;
+        mode_ops.mul = mul_lanes;
+        mode_ops.div = div_lanes;
+        mode_ops.mod = mod_lanes;
+    }
+    if (ops_frac != 0)
     {
-        /* if b > a to start with, the first iteration through the loop ends
-         * up swapping a and b, then it follows from there, so don't need to
-         * worry about which of a and b is greater. */
-        while (b != 0)
-        {
-            uint64_t temp = b;
-            b = a % b;
-            a = temp;
-        }
-        res = a;
+        mode_ops.plusminus = plusminus_mode;
+        mode_ops.add = add_fixed;
+        mode_ops.sub = sub_fixed;
+        mode_ops.mul = mul_fixed;
+        mode_ops.div = div_fixed;
     }
-    else
+    if (ops_modulus != 0)
     {
-        int64_t sa = calc_util_get_signed(a, width);
-        int64_t sb = calc_util_get_signed(b, width);
+        mode_ops.plusminus = plusminus_mode;
+        mode_ops.add = add_mod;
+        mode_ops.sub = sub_mod;
+        mode_ops.mul = mul_mod;
+    }
+    int_ops = &mode_ops;
+}
 
-        if (sa == INT64_MIN && sb == -1)
-        {
-            return -1;
-        }
-        if (sa == -1 && sb == INT64_MIN)
-        {
-            return -1;
-        }
 
-        while (sb != 0)
-        {
-            int64_t temp = sb;
-            sb = sa % sb;
-            sa = temp;
-        }
-        res = sa;
-    }
+/* binary ops */
 
-    DBGP(("op res before %016" PRIx64 "\n", res));
-    calc_util_mask_width(&res, width);
-    DBGP(("op res after %016" PRIx64 "\n", res));
-    return res;
+calc_int_t bin_iop_add(calc_int_t a, calc_int_t b)
+{
+    return int_ops->add(a, b);
 }
 
-uint64_t bin_iop_and(uint64_t a, uint64_t b)
+calc_int_t bin_iop_sub(calc_int_t a, calc_int_t b)
 {
-    uint64_t res;
-    calc_width_enum width = calc_get_integer_width();
+    return int_ops->sub(a, b);
+}
 
-    res = a & b;
+calc_int_t bin_iop_mul(calc_int_t a, calc_int_t b)
+{
+    return int_ops->mul(a, b);
+}
 
-    DBGP(("op res before %016" PRIx64 "\n", res));
-    calc_util_mask_width(&res, width);
-    DBGP(("op res after %016" PRIx64 "\n", res));
-    return res;
+calc_int_t bin_iop_div(calc_int_t a, calc_int_t b)
+{
+    return int_ops->div(a, b);
 }
 
-uint64_t bin_iop_or(uint64_t a, uint64_t b)
+calc_int_t bin_iop_mod(calc_int_t a, calc_int_t b)
 {
-    uint64_t res;
-    calc_width_enum width = calc_get_integer_width();
+    return int_ops->mod(a, b);
+}
 
-    res = a | b;
+/* binary gcd, always positive (or 0 if both are 0) so it overflows for
+ * gcd(int_min, 0) or gcd(int_min, int_min) */
+calc_int_t bin_iop_gcd(calc_int_t a, calc_int_t b)
+{
+    return positive_result(nt_gcd(magnitude(a), magnitude(b)));
+}
 
-    DBGP(("op res before %016" PRIx64 "\n", res));
-    calc_util_mask_width(&res, width);
-    DBGP(("op res after %016" PRIx64 "\n", res));
-    return res;
+calc_int_t bin_iop_and(calc_int_t a, calc_int_t b)
+{
+    return int_ops->and(a, b);
 }
 
-uint64_t bin_iop_xor(uint64_t a, uint64_t b)
+calc_int_t bin_iop_or(calc_int_t a, calc_int_t b)
 {
-    uint64_t res;
-    calc_width_enum width = calc_get_integer_width();
+    return int_ops->or(a, b);
+}
 
-    res = a ^ b;
+calc_int_t bin_iop_xor(calc_int_t a, calc_int_t b)
+{
+    return int_ops->xor(a, b);
+}
 
-    DBGP(("op res before %016" PRIx64 "\n", res));
-    calc_util_mask_width(&res, width);
-    DBGP(("op res after %016" PRIx64 "\n", res));
-    return res;
+calc_int_t bin_iop_left_shift(calc_int_t a, calc_int_t b)
+{
+    return int_ops->left_shift(a, b);
 }
 
-uint64_t bin_iop_left_shift(uint64_t a, uint64_t b)
+calc_int_t bin_iop_right_shift(calc_int_t a, calc_int_t b)
 {
-    uint64_t res;
-    calc_width_enum width = calc_get_integer_width();
+    return int_ops->right_shift(a, b);
+}
 
-    if (!is_shift_valid(b, width))
-    {
-        calc_warn(shift_range_msg);
-        return a;
-    }
-    res = a << b;
+/* deposit the low bits of a into the bits set in mask b, the result can't
+ * go beyond the mask so is already within the width */
+calc_int_t bin_iop_pdep(calc_int_t a, calc_int_t b)
+{
+    return bitops_pdep(a, b);
+}
 
-    DBGP(("op res before %016" PRIx64 "\n", res));
-    calc_util_mask_width(&res, width);
-    DBGP(("op res after %016" PRIx64 "\n", res));
-    return res;
+/* the bits of a where mask b is set, packed at the bottom */
+calc_int_t bin_iop_pext(calc_int_t a, calc_int_t b)
+{
+    return bitops_pext(a, b);
 }
 
-uint64_t bin_iop_right_shift(uint64_t a, uint64_t b)
+/* 2-D Morton (Z-order) index with a in the even bits and b in the odd */
+calc_int_t bin_iop_morton2(calc_int_t a, calc_int_t b)
 {
-    uint64_t res;
-    calc_width_enum width = calc_get_integer_width();
+    return (bitops_spread2(a) | (bitops_spread2(b) << 1))
+           & calc_util_width_mask(ops_width);
+}
 
-    if (!is_shift_valid(b, width))
-    {
-        calc_warn(shift_range_msg);
-        return a;
-    }
-    if (calc_get_use_unsigned())
+/* Carry-less multiply of the bit patterns as GF(2) polynomials, the
+ * product being up to twice the width. clmul gives the low half, clmulh
+ * the high half. */
+calc_int_t bin_iop_clmul(calc_int_t a, calc_int_t b)
+{
+    calc_int_t lo, hi;
+
+    gf2_clmul(a, b, &lo, &hi);
+    return lo & calc_util_width_mask(ops_width);
+}
+
+calc_int_t bin_iop_clmulh(calc_int_t a, calc_int_t b)
+{
+    calc_int_t lo, hi;
+
+    gf2_clmul(a, b, &lo, &hi);
+    if (ops_width < CALC_WIDTH_MAX)
     {
-        res = a >> b;
+        hi = (hi << (CALC_WIDTH_MAX - ops_width)) | (lo >> ops_width);
     }
-    else
+    return hi & calc_util_width_mask(ops_width);
+}
+
+calc_int_t bin_iop_gf2mod(calc_int_t a, calc_int_t b)
+{
+    if (b == 0)
     {
-        int64_t sa = calc_util_get_signed(a, width);
-        sa = sa >> b;
-        res = sa;
+        calc_warn(div0_msg);
+        return 0;
     }
-
-    DBGP(("op res before %016" PRIx64 "\n", res));
-    calc_util_mask_width(&res, width);
-    DBGP(("op res after %016" PRIx64 "\n", res));
-    return res;
+    return gf2_mod(a, b);
 }
 
+calc_int_t bin_iop_gf2gcd(calc_int_t a, calc_int_t b)
+{
+    return gf2_gcd(a, b);
+}
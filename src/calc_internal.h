@@ -30,36 +30,79 @@
 #include <string.h>
 
 #include "calc.h"
+#include "dfp_int.h"
 
 
 void calc_error(const char *msg);
 void calc_warn(const char *msg);
 
-stackf_t calc_get_fval_top_of_stack(void);
+/* choose the integer operators for the width and signedness, to be called
+ * whenever either changes */
+void calc_integer_select_ops(calc_width_t width, bool use_unsigned);
+
+/* 0, or the modulus for + - * pow 1/x in mod m mode */
+void calc_integer_set_modulus(uint64_t m);
+
+/* 0, or the fraction bits for fixed point */
+void calc_integer_set_fixed(int frac_bits, bool saturate);
+
+/* 0, or the lane width for + - * / in lanes mode */
+void calc_integer_set_lanes(int lane_bits);
 
 /* integer unary operators */
-uint64_t iop_plusminus(uint64_t arg);
-uint64_t iop_complement(uint64_t arg);
-uint64_t iop_square(uint64_t arg);
-//uint64_t iop_square_root(uint64_t arg);
-//uint64_t iop_2powx(uint64_t arg);
-uint64_t iop_left_shift(uint64_t arg);
-uint64_t iop_right_shift(uint64_t arg);
-uint64_t iop_rol(uint64_t arg);
-uint64_t iop_ror(uint64_t arg);
+calc_int_t iop_plusminus(calc_int_t arg);
+calc_int_t iop_complement(calc_int_t arg);
+calc_int_t iop_square(calc_int_t arg);
+calc_int_t iop_square_root(calc_int_t arg);
+//calc_int_t iop_2powx(calc_int_t arg);
+calc_int_t iop_left_shift(calc_int_t arg);
+calc_int_t iop_right_shift(calc_int_t arg);
+calc_int_t iop_rol(calc_int_t arg);
+calc_int_t iop_ror(calc_int_t arg);
+calc_int_t iop_popcount(calc_int_t arg);
+calc_int_t iop_clz(calc_int_t arg);
+calc_int_t iop_ctz(calc_int_t arg);
+calc_int_t iop_parity(calc_int_t arg);
+calc_int_t iop_bitrev(calc_int_t arg);
+calc_int_t iop_bswap(calc_int_t arg);
+calc_int_t iop_spread2(calc_int_t arg);
+calc_int_t iop_compact2(calc_int_t arg);
+calc_int_t iop_spread3(calc_int_t arg);
+calc_int_t iop_compact3(calc_int_t arg);
+calc_int_t iop_cube_root(calc_int_t arg);
+calc_int_t iop_is_prime(calc_int_t arg);
+calc_int_t iop_next_prime(calc_int_t arg);
+calc_int_t iop_ilog2(calc_int_t arg);
+calc_int_t iop_ilog10(calc_int_t arg);
+calc_int_t iop_one_over_x(calc_int_t arg);
 
 /* integer binary operators */
-uint64_t bin_iop_add(uint64_t a, uint64_t b);
-uint64_t bin_iop_sub(uint64_t a, uint64_t b);
-uint64_t bin_iop_mul(uint64_t a, uint64_t b);
-uint64_t bin_iop_div(uint64_t a, uint64_t b);
-uint64_t bin_iop_mod(uint64_t a, uint64_t b);
-uint64_t bin_iop_and(uint64_t a, uint64_t b);
-uint64_t bin_iop_or(uint64_t a, uint64_t b);
-uint64_t bin_iop_xor(uint64_t a, uint64_t b);
-uint64_t bin_iop_gcd(uint64_t a, uint64_t b);
-uint64_t bin_iop_left_shift(uint64_t a, uint64_t b);
-uint64_t bin_iop_right_shift(uint64_t a, uint64_t b);
+calc_int_t bin_iop_add(calc_int_t a, calc_int_t b);
+calc_int_t bin_iop_sub(calc_int_t a, calc_int_t b);
+calc_int_t bin_iop_mul(calc_int_t a, calc_int_t b);
+calc_int_t bin_iop_div(calc_int_t a, calc_int_t b);
+calc_int_t bin_iop_mod(calc_int_t a, calc_int_t b);
+calc_int_t bin_iop_and(calc_int_t a, calc_int_t b);
+calc_int_t bin_iop_or(calc_int_t a, calc_int_t b);
+calc_int_t bin_iop_xor(calc_int_t a, calc_int_t b);
+calc_int_t bin_iop_gcd(calc_int_t a, calc_int_t b);
+calc_int_t bin_iop_left_shift(calc_int_t a, calc_int_t b);
+calc_int_t bin_iop_right_shift(calc_int_t a, calc_int_t b);
+calc_int_t bin_iop_pdep(calc_int_t a, calc_int_t b);
+calc_int_t bin_iop_pext(calc_int_t a, calc_int_t b);
+calc_int_t bin_iop_morton2(calc_int_t a, calc_int_t b);
+calc_int_t bin_iop_clmul(calc_int_t a, calc_int_t b);
+calc_int_t bin_iop_clmulh(calc_int_t a, calc_int_t b);
+calc_int_t bin_iop_gf2mod(calc_int_t a, calc_int_t b);
+calc_int_t bin_iop_gf2gcd(calc_int_t a, calc_int_t b);
+calc_int_t bin_iop_pow(calc_int_t a, calc_int_t b);
+calc_int_t bin_iop_dlog(calc_int_t a, calc_int_t b);
+calc_int_t bin_iop_lane_adds(calc_int_t a, calc_int_t b);
+calc_int_t bin_iop_lane_subs(calc_int_t a, calc_int_t b);
+calc_int_t bin_iop_lane_min(calc_int_t a, calc_int_t b);
+calc_int_t bin_iop_lane_max(calc_int_t a, calc_int_t b);
+calc_int_t bin_iop_lane_cmpeq(calc_int_t a, calc_int_t b);
+calc_int_t bin_iop_lane_cmpgt(calc_int_t a, calc_int_t b);
 
 
 /* float unary operators */
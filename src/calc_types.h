@@ -27,12 +27,62 @@
 extern decContext dfp_context;
 
 
-/* For integer mode, all values are stored and passed around as a uint64_t.
+/* For integer mode, all values are stored and passed around as a calc_int_t,
+ * 128 bits so any width up to 128 fits. calc_sint_t is the signed type of
+ * the same size.
  * There is an assumption of a twos complement target where the bit
  * pattern is the same for unsigned/signed, and in particular a conversion
  * from unsigned to signed will never do anything unexpected (ie. for the
  * case where the unsigned value is outside the range of the signed
  * type). */
+#if !defined(__SIZEOF_INT128__)
+#error "integer mode needs a compiler with unsigned __int128"
+#endif
+
+typedef unsigned __int128 calc_int_t;
+typedef __int128 calc_sint_t;
+
+#define CALC_INT_MAX (~(calc_int_t)0)
+#define CALC_SINT_MAX ((calc_sint_t)(CALC_INT_MAX >> 1))
+#define CALC_SINT_MIN (-CALC_SINT_MAX - 1)
+
+#if defined(DFP_USE_BID128)
+
+/* Floating point mode using the in-tree BID encoded decimal128, which
+ * gives the same results as decQuad (see dfp_bid128.h) */
+#include "dfp_bid128.h"
+
+typedef bid128_t stackf_t;
+
+#define dfp_add(r, a, b, c) bid128_add(r, a, b, c)
+#define dfp_subtract(r, a, b, c) bid128_subtract(r, a, b, c)
+#define dfp_multiply(r, a, b, c) bid128_multiply(r, a, b, c)
+#define dfp_divide(r, a, b, c) bid128_divide(r, a, b, c)
+#define dfp_remainder(r, a, b, c) bid128_remainder(r, a, b, c)
+#define dfp_minus(r, a, c) bid128_minus(r, a, c)
+#define dfp_zero(r) bid128_zero(r)
+#define dfp_abs(r, a, c) bid128_abs(r, a, c)
+
+#define dfp_to_string(a, s)  bid128_to_string(a, s)
+#define dfp_from_string(r, s, c) bid128_from_string(r, s, c)
+
+#define dfp_to_number(a, n) bid128_to_number(a, n)
+#define dfp_from_number(a, n, c)  bid128_from_number(a, n, c)
+
+#define dfp_compare(r, lhs, rhs, c) bid128_compare(r, lhs, rhs, c)
+#define dfp_is_negative(a) bid128_is_negative(a)
+#define dfp_is_integer(a) bid128_is_integer(a)
+#define dfp_is_zero(a) bid128_is_zero(a)
+#define dfp_is_infinite(a)  bid128_is_infinite(a)
+#define dfp_is_nan(a) bid128_is_nan(a)
+
+#define dfp_get_coefficient(a, bcd) bid128_get_coefficient(a, bcd)
+#define dfp_get_exponent(a) bid128_get_exponent(a)
+
+#define dfp_to_int32(a, c, round) bid128_to_int32(a, c, round)
+#define dfp_from_int32(a, i) bid128_from_int32(a, i)
+
+#else
 
 /* The type used for floating point mode */
 typedef decQuad stackf_t;
@@ -60,9 +110,15 @@ typedef decQuad stackf_t;
 #define dfp_is_infinite(a)  decQuadIsInfinite(a)
 #define dfp_is_nan(a) decQuadIsNaN(a)
 
+/* coefficient as DECQUAD_Pmax BCD digits, returns the sign */
+#define dfp_get_coefficient(a, bcd) decQuadGetCoefficient(a, bcd)
+#define dfp_get_exponent(a) decQuadGetExponent(a)
+
 #define dfp_to_int32(a, c, round) decQuadToInt32(a, c, round)
 #define dfp_from_int32(a, i) decQuadFromInt32(a, i)
 
+#endif
+
 #define dfp_context_clear_status(c) ((c)->status = 0)
 
 /* 43 chars */
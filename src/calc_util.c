@@ -18,108 +18,129 @@
  */
 
 
-#include <errno.h>
+#include <ctype.h>
 #include "calc_internal.h"
 
-void calc_util_mask_width(uint64_t *x, calc_width_enum width)
+calc_int_t calc_util_width_mask(calc_width_t width)
 {
-    switch (width)
-    {
-    case calc_width_8:
-        *x &= 0xff;
-        break;
-    case calc_width_16:
-        *x &= 0xffff;
-        break;
-    case calc_width_32:
-        *x &= 0xffffffff;
-        break;
-    default:
-        break;
-    }
+    if (width >= CALC_WIDTH_MAX)
+        return CALC_INT_MAX;
+    return ((calc_int_t)1 << width) - 1;
 }
 
-int64_t calc_util_get_signed(uint64_t x, calc_width_enum width)
+void calc_util_mask_width(calc_int_t *x, calc_width_t width)
 {
-    switch (width)
-    {
-    case calc_width_8:
-        return (int64_t)(int8_t)x;
-    case calc_width_16:
-        return (int64_t)(int16_t)x;
-    case calc_width_32:
-        return (int64_t)(int32_t)x;
-    default:
-        return (int64_t)x;
-    }
+    *x &= calc_util_width_mask(width);
 }
 
-bool calc_util_is_in_signed_range(int64_t x, calc_width_enum width)
+calc_sint_t calc_util_get_signed(calc_int_t x, calc_width_t width)
 {
-    switch (width)
-    {
-    case calc_width_8:
-        return x >= INT8_MIN && x <= INT8_MAX;
-    case calc_width_16:
-        return x >= INT16_MIN && x <= INT16_MAX;
-    case calc_width_32:
-        return x >= INT32_MIN && x <= INT32_MAX;
-    default:
+    /* move the sign bit of the width to the top, then back again with an
+     * arithmetic shift */
+    int shift = CALC_WIDTH_MAX - width;
+    return (calc_sint_t)(x << shift) >> shift;
+}
+
+bool calc_util_is_in_signed_range(calc_sint_t x, calc_width_t width)
+{
+    if (width >= CALC_WIDTH_MAX)
         return true;
-    }
+
+    calc_sint_t lim = (calc_sint_t)1 << (width - 1);
+    return x >= -lim && x < lim;
 }
 
-bool calc_util_is_in_unsigned_range(uint64_t x, calc_width_enum width)
+bool calc_util_is_in_unsigned_range(calc_int_t x, calc_width_t width)
 {
-    switch (width)
-    {
-    case calc_width_8:
-        return x <= UINT8_MAX;
-    case calc_width_16:
-        return x <= UINT16_MAX;
-    case calc_width_32:
-        return x <= UINT32_MAX;
-    default:
+    if (width >= CALC_WIDTH_MAX)
         return true;
-    }
+
+    return (x >> width) == 0;
 }
 
 
-bool calc_util_signed_str_to_ival(const char *str,
-                                  calc_width_enum width,
-                                  uint64_t *val,
-                                  int base)
+/* Read str the way strtoull does (leading white space, optional sign,
+ * optional 0x for base 16, then digits up to the first that isn't one),
+ * giving the magnitude in *mag and whether there was a '-' in *neg.
+ * Returns false if the magnitude doesn't fit in 128 bits. */
+static bool str_to_magnitude(const char *str, int base,
+                             calc_int_t *mag, bool *neg)
 {
+    calc_int_t cutoff = CALC_INT_MAX / base;
+    int cutlim = (int)(CALC_INT_MAX % base);
+    calc_int_t m = 0;
     bool ok = true;
-    int64_t sres;
-    uint64_t result;
 
-    errno = 0;
-    long long resll = strtoll(str, NULL, base);
-    if (errno == ERANGE)
+    while (isspace((unsigned char)*str))
+    {
+        str++;
+    }
+    *neg = *str == '-';
+    if (*str == '-' || *str == '+')
     {
-        //printf("signed_str_to_ival ERANGE\n");
-        ok = false;
+        str++;
+    }
+    if (base == 16 && str[0] == '0' && (str[1] == 'x' || str[1] == 'X')
+        && isxdigit((unsigned char)str[2]))
+    {
+        str += 2;
     }
 
-    /* for the unlikely scenario that long long is more than 64 bit */
-    if (ok)
+    for (; *str; str++)
     {
-        if (resll < INT64_MIN || resll > INT64_MAX)
+        int d;
+        if (*str >= '0' && *str <= '9')
+            d = *str - '0';
+        else if (*str >= 'a' && *str <= 'z')
+            d = *str - 'a' + 10;
+        else if (*str >= 'A' && *str <= 'Z')
+            d = *str - 'A' + 10;
+        else
+            break;
+        if (d >= base)
+            break;
+
+        if (m > cutoff || (m == cutoff && d > cutlim))
         {
             ok = false;
+            m = CALC_INT_MAX;
+        }
+        else
+        {
+            m = m * base + d;
         }
     }
+    *mag = m;
+    return ok;
+}
+
 
-    sres = resll;
+bool calc_util_signed_str_to_ival(const char *str,
+                                  calc_width_t width,
+                                  calc_int_t *val,
+                                  int base)
+{
+    calc_int_t mag;
+    calc_int_t result;
+    bool neg;
+    bool ok = str_to_magnitude(str, base, &mag, &neg);
+
+    if (ok)
+    {
+        if (neg)
+            ok = mag <= (calc_int_t)CALC_SINT_MAX + 1;
+        else
+            ok = mag <= (calc_int_t)CALC_SINT_MAX;
+    }
+
+    result = neg ? -mag : mag;
 
     if (ok)
     {
         /* now check for smaller widths */
-        ok = calc_util_is_in_signed_range(sres, width);
+        ok = calc_util_is_in_signed_range((calc_sint_t)result, width);
     }
 
-    result = sres;
     calc_util_mask_width(&result, width);
     *val = result;
     return ok;
@@ -127,31 +148,18 @@ bool calc_util_signed_str_to_ival(const char *str,
 
 
 bool calc_util_unsigned_str_to_ival(const char *str,
-                                    calc_width_enum width,
-                                    uint64_t *val,
+                                    calc_width_t width,
+                                    calc_int_t *val,
                                     int base)
 {
-    bool ok = true;
-    uint64_t result;
+    calc_int_t mag;
+    calc_int_t result;
+    bool neg;
+    bool ok = str_to_magnitude(str, base, &mag, &neg);
 
-    errno = 0;
-    unsigned long long resll = strtoull(str, NULL, base);
-    if (errno == ERANGE)
-    {
-        //printf("unsigned_str_to_ival ERANGE\n");
-        ok = false;
-    }
+    /* like strtoull, a '-' negates in the unsigned type */
+    result = neg ? -mag : mag;
 
-    /* for the unlikely scenario that long long is more than 64 bit */
-    if (ok)
-    {
-        if (resll > UINT64_MAX)
-        {
-            ok = false;
-        }
-    }
-
-    result = resll;
     if (ok)
     {
         /* now check for smaller widths */
@@ -164,49 +172,32 @@ bool calc_util_unsigned_str_to_ival(const char *str,
 }
 
 
-static calc_width_enum calc_util_find_min_signed_width(int64_t x)
-{
-    if (calc_util_is_in_signed_range(x, calc_width_8))
-        return calc_width_8;
-    else if (calc_util_is_in_signed_range(x, calc_width_16))
-        return calc_width_16;
-    else if (calc_util_is_in_signed_range(x, calc_width_32))
-        return calc_width_32;
-    else
-        return calc_width_64;
-}
+/* the widths a value is moved up to if it doesn't fit */
+static const calc_width_t changed_widths[] = { 8, 16, 32, 64, 128 };
 
-static calc_width_enum calc_util_find_min_unsigned_width(uint64_t x)
+static bool fits_width(calc_int_t uval, bool negative, calc_width_t width)
 {
-    if (calc_util_is_in_unsigned_range(x, calc_width_8))
-        return calc_width_8;
-    else if (calc_util_is_in_unsigned_range(x, calc_width_16))
-        return calc_width_16;
-    else if (calc_util_is_in_unsigned_range(x, calc_width_32))
-        return calc_width_32;
+    if (negative)
+        return calc_util_is_in_signed_range((calc_sint_t)uval, width);
     else
-        return calc_width_64;
+        return calc_util_is_in_unsigned_range(uval, width);
 }
 
-calc_width_enum calc_util_get_changed_width(uint64_t uval, bool negative,
-                                            calc_width_enum current_width)
+calc_width_t calc_util_get_changed_width(calc_int_t uval, bool negative,
+                                         calc_width_t current_width)
 {
-    calc_width_enum selected_width = current_width;
-    calc_width_enum min_width;
-
-    if (negative)
+    if (fits_width(uval, negative, current_width))
     {
-        min_width = calc_util_find_min_signed_width((int64_t)uval);
-    }
-    else
-    {
-        min_width = calc_util_find_min_unsigned_width(uval);
+        return current_width;
     }
 
-    if (min_width > selected_width)
+    for (size_t i = 0; i < sizeof(changed_widths) / sizeof(changed_widths[0]); i++)
     {
-        selected_width = min_width;
+        if (changed_widths[i] > current_width
+            && fits_width(uval, negative, changed_widths[i]))
+        {
+            return changed_widths[i];
+        }
     }
-    return selected_width;
+    return CALC_WIDTH_MAX;
 }
-
@@ -0,0 +1,428 @@
+/*****************************************************************************
+ * File checksum.c part of ProgAndSciCalc
+ *
+ * Copyright (C) 2018 Ken Bromham
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <string.h>
+
+#include "checksum.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define CHECKSUM_X86
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+static const crc_params_t crc_presets[] =
+{
+    /* name                  width  poly                   init
+     *                       refin  refout  xorout         check */
+    { "CRC-8/SMBUS",         8,  0x07,                  0x00,
+                             false, false,  0x00,                  0xf4 },
+    { "CRC-8/MAXIM-DOW",     8,  0x31,                  0x00,
+                             true,  true,   0x00,                  0xa1 },
+    { "CRC-16/ARC",          16, 0x8005,                0x0000,
+                             true,  true,   0x0000,                0xbb3d },
+    { "CRC-16/IBM-3740",     16, 0x1021,                0xffff,
+                             false, false,  0x0000,                0x29b1 },
+    { "CRC-16/XMODEM",       16, 0x1021,                0x0000,
+                             false, false,  0x0000,                0x31c3 },
+    { "CRC-16/MODBUS",       16, 0x8005,                0xffff,
+                             true,  true,   0x0000,                0x4b37 },
+    { "CRC-32/ISO-HDLC",     32, 0x04c11db7,            0xffffffff,
+                             true,  true,   0xffffffff,            0xcbf43926 },
+    { "CRC-32/BZIP2",        32, 0x04c11db7,            0xffffffff,
+                             false, false,  0xffffffff,            0xfc891918 },
+    { "CRC-32C (ISCSI)",     32, 0x1edc6f41,            0xffffffff,
+                             true,  true,   0xffffffff,            0xe3069283 },
+    { "CRC-64/XZ",           64, 0x42f0e1eba9ea3693ULL, ~0ULL,
+                             true,  true,   ~0ULL,     0x995dc9bbdf1939faULL },
+    { "CRC-64/ECMA-182",     64, 0x42f0e1eba9ea3693ULL, 0,
+                             false, false,  0,         0x6c40df5f0b497347ULL },
+};
+#define NUM_CRC_PRESETS (int)(sizeof(crc_presets) / sizeof(crc_presets[0]))
+
+#define CRC32C_POLY 0x1edc6f41
+
+
+int checksum_num_crc_presets(void)
+{
+    return NUM_CRC_PRESETS;
+}
+
+const crc_params_t *checksum_crc_preset(int index)
+{
+    return &crc_presets[index];
+}
+
+static uint64_t width_mask(int width)
+{
+    return width == 64 ? ~0ULL : (1ULL << width) - 1;
+}
+
+bool checksum_crc_params_ok(const crc_params_t *params)
+{
+    uint64_t mask;
+
+    if (params->width < 1 || params->width > CHECKSUM_CRC_WIDTH_MAX)
+    {
+        return false;
+    }
+    mask = width_mask(params->width);
+    return (params->poly & ~mask) == 0 && (params->init & ~mask) == 0
+           && (params->xorout & ~mask) == 0;
+}
+
+static uint64_t reflect(uint64_t x, int width)
+{
+    uint64_t r = 0;
+
+    for (int i = 0; i < width; i++)
+    {
+        r = (r << 1) | ((x >> i) & 1);
+    }
+    return r;
+}
+
+static uint64_t load64_le(const uint8_t *p)
+{
+    uint64_t x;
+    memcpy(&x, p, 8);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    x = __builtin_bswap64(x);
+#endif
+    return x;
+}
+
+static uint64_t load64_be(const uint8_t *p)
+{
+    uint64_t x;
+    memcpy(&x, p, 8);
+#if !defined(__BYTE_ORDER__) || __BYTE_ORDER__ != __ORDER_BIG_ENDIAN__
+    x = __builtin_bswap64(x);
+#endif
+    return x;
+}
+
+
+/*
+ * Slice by 8 tables. For reflected CRCs the register holds the CRC
+ * reflected in its low bits, and a byte goes in at the bottom. Otherwise
+ * the register holds the CRC in its top bits (shifted up by 64 - width),
+ * so every width works the same as 64 and a byte goes in at the top.
+ * tab[0] is the usual byte at a time table, tab[k] is for a byte k places
+ * further from the end of the 8 being done.
+ * Only the last set of tables is kept, which is all the window needs.
+ */
+static struct
+{
+    bool valid;
+    int width;
+    uint64_t poly;
+    bool refin;
+    uint64_t tab[8][256];
+} tables;
+
+static void make_tables(const crc_params_t *p)
+{
+    if (tables.valid && tables.width == p->width && tables.poly == p->poly
+        && tables.refin == p->refin)
+    {
+        return;
+    }
+
+    if (p->refin)
+    {
+        uint64_t rpoly = reflect(p->poly, p->width);
+        for (int i = 0; i < 256; i++)
+        {
+            uint64_t c = i;
+            for (int j = 0; j < 8; j++)
+            {
+                c = (c & 1) ? (c >> 1) ^ rpoly : c >> 1;
+            }
+            tables.tab[0][i] = c;
+        }
+        for (int i = 0; i < 256; i++)
+        {
+            for (int k = 1; k < 8; k++)
+            {
+                uint64_t c = tables.tab[k - 1][i];
+                tables.tab[k][i] = (c >> 8) ^ tables.tab[0][c & 0xff];
+            }
+        }
+    }
+    else
+    {
+        uint64_t tpoly = p->poly << (64 - p->width);
+        for (int i = 0; i < 256; i++)
+        {
+            uint64_t c = (uint64_t)i << 56;
+            for (int j = 0; j < 8; j++)
+            {
+                c = (c >> 63) ? (c << 1) ^ tpoly : c << 1;
+            }
+            tables.tab[0][i] = c;
+        }
+        for (int i = 0; i < 256; i++)
+        {
+            for (int k = 1; k < 8; k++)
+            {
+                uint64_t c = tables.tab[k - 1][i];
+                tables.tab[k][i] = (c << 8) ^ tables.tab[0][c >> 56];
+            }
+        }
+    }
+
+    tables.width = p->width;
+    tables.poly = p->poly;
+    tables.refin = p->refin;
+    tables.valid = true;
+}
+
+static uint64_t crc_reflected(uint64_t crc, const uint8_t *data, size_t len)
+{
+    uint64_t (*t)[256] = tables.tab;
+
+    for (; len >= 8; data += 8, len -= 8)
+    {
+        crc ^= load64_le(data);
+        crc = t[7][crc & 0xff] ^ t[6][(crc >> 8) & 0xff]
+              ^ t[5][(crc >> 16) & 0xff] ^ t[4][(crc >> 24) & 0xff]
+              ^ t[3][(crc >> 32) & 0xff] ^ t[2][(crc >> 40) & 0xff]
+              ^ t[1][(crc >> 48) & 0xff] ^ t[0][crc >> 56];
+    }
+    for (; len > 0; data++, len--)
+    {
+        crc = t[0][(crc ^ *data) & 0xff] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+static uint64_t crc_normal(uint64_t crc, const uint8_t *data, size_t len)
+{
+    uint64_t (*t)[256] = tables.tab;
+
+    for (; len >= 8; data += 8, len -= 8)
+    {
+        crc ^= load64_be(data);
+        crc = t[7][crc >> 56] ^ t[6][(crc >> 48) & 0xff]
+              ^ t[5][(crc >> 40) & 0xff] ^ t[4][(crc >> 32) & 0xff]
+              ^ t[3][(crc >> 24) & 0xff] ^ t[2][(crc >> 16) & 0xff]
+              ^ t[1][(crc >> 8) & 0xff] ^ t[0][crc & 0xff];
+    }
+    for (; len > 0; data++, len--)
+    {
+        crc = t[0][(crc >> 56) ^ *data] ^ (crc << 8);
+    }
+    return crc;
+}
+
+
+#ifdef CHECKSUM_X86
+
+/* Compiled for the instruction whatever the build flags, and only called
+ * when cpuid says it's there. crc is the reflected register. */
+__attribute__((target("sse4.2")))
+static uint64_t crc32c_hw(uint64_t crc, const uint8_t *data, size_t len)
+{
+    for (; len >= 8; data += 8, len -= 8)
+    {
+        uint64_t x;
+        memcpy(&x, data, 8);
+        crc = _mm_crc32_u64(crc, x);
+    }
+    for (; len > 0; data++, len--)
+    {
+        crc = _mm_crc32_u8((uint32_t)crc, *data);
+    }
+    return crc;
+}
+
+/* CPUID.1:ECX.SSE4_2[bit 20] */
+static bool have_sse42(void)
+{
+    unsigned int a, b, c, d;
+    return __get_cpuid(1, &a, &b, &c, &d) && (c & (1u << 20));
+}
+#endif
+
+static bool use_hardware = true;
+
+void checksum_use_hardware(bool enable)
+{
+    use_hardware = enable;
+}
+
+bool checksum_using_hardware(void)
+{
+#ifdef CHECKSUM_X86
+    static int have = -1;
+    if (have < 0)
+    {
+        have = have_sse42();
+    }
+    return use_hardware && have;
+#else
+    return false;
+#endif
+}
+
+uint64_t checksum_crc(const crc_params_t *p, const uint8_t *data, size_t len)
+{
+    uint64_t crc;
+
+    if (p->refin)
+    {
+        crc = reflect(p->init, p->width);
+#ifdef CHECKSUM_X86
+        if (p->width == 32 && p->poly == CRC32C_POLY
+            && checksum_using_hardware())
+        {
+            crc = crc32c_hw(crc, data, len);
+        }
+        else
+#endif
+        {
+            make_tables(p);
+            crc = crc_reflected(crc, data, len);
+        }
+        /* the register is reflected, so only reflect back if not refout */
+        if (!p->refout)
+        {
+            crc = reflect(crc, p->width);
+        }
+    }
+    else
+    {
+        make_tables(p);
+        crc = crc_normal(p->init << (64 - p->width), data, len);
+        crc >>= 64 - p->width;
+        if (p->refout)
+        {
+            crc = reflect(crc, p->width);
+        }
+    }
+    return (crc ^ p->xorout) & width_mask(p->width);
+}
+
+
+#define FNV64_OFFSET 0xcbf29ce484222325ULL
+#define FNV64_PRIME  0x100000001b3ULL
+
+uint64_t checksum_fnv1a64(const uint8_t *data, size_t len)
+{
+    uint64_t h = FNV64_OFFSET;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        h ^= data[i];
+        h *= FNV64_PRIME;
+    }
+    return h;
+}
+
+
+/* XXH64, as in the xxHash specification */
+#define XXH_P1 0x9e3779b185ebca87ULL
+#define XXH_P2 0xc2b2ae3d27d4eb4fULL
+#define XXH_P3 0x165667b19e3779f9ULL
+#define XXH_P4 0x85ebca77c2b2ae63ULL
+#define XXH_P5 0x27d4eb2f165667c5ULL
+
+static uint64_t rotl64(uint64_t x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+static uint32_t load32_le(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16)
+           | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t xxh_round(uint64_t acc, uint64_t input)
+{
+    acc += input * XXH_P2;
+    acc = rotl64(acc, 31);
+    return acc * XXH_P1;
+}
+
+static uint64_t xxh_merge(uint64_t acc, uint64_t val)
+{
+    acc ^= xxh_round(0, val);
+    return acc * XXH_P1 + XXH_P4;
+}
+
+uint64_t checksum_xxh64(const uint8_t *data, size_t len, uint64_t seed)
+{
+    const uint8_t *end = data + len;
+    uint64_t h;
+
+    if (len >= 32)
+    {
+        /* four lanes of 8 bytes */
+        uint64_t v1 = seed + XXH_P1 + XXH_P2;
+        uint64_t v2 = seed + XXH_P2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - XXH_P1;
+
+        for (; end - data >= 32; data += 32)
+        {
+            v1 = xxh_round(v1, load64_le(data));
+            v2 = xxh_round(v2, load64_le(data + 8));
+            v3 = xxh_round(v3, load64_le(data + 16));
+            v4 = xxh_round(v4, load64_le(data + 24));
+        }
+        h = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+        h = xxh_merge(h, v1);
+        h = xxh_merge(h, v2);
+        h = xxh_merge(h, v3);
+        h = xxh_merge(h, v4);
+    }
+    else
+    {
+        h = seed + XXH_P5;
+    }
+    h += len;
+
+    for (; end - data >= 8; data += 8)
+    {
+        h ^= xxh_round(0, load64_le(data));
+        h = rotl64(h, 27) * XXH_P1 + XXH_P4;
+    }
+    if (end - data >= 4)
+    {
+        h ^= (uint64_t)load32_le(data) * XXH_P1;
+        h = rotl64(h, 23) * XXH_P2 + XXH_P3;
+        data += 4;
+    }
+    for (; data < end; data++)
+    {
+        h ^= *data * XXH_P5;
+        h = rotl64(h, 11) * XXH_P1;
+    }
+
+    /* avalanche */
+    h ^= h >> 33;
+    h *= XXH_P2;
+    h ^= h >> 29;
+    h *= XXH_P3;
+    h ^= h >> 32;
+    return h;
+}
@@ -0,0 +1,76 @@
+/*****************************************************************************
+ * File checksum.h part of ProgAndSciCalc
+ *
+ * Copyright (C) 2018 Ken Bromham
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef CHECKSUM_H
+#define CHECKSUM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* CRCs and hashes over a block of bytes.
+ *
+ * A CRC is described the usual way (the Rocksoft model, as in the CRC
+ * catalogue): width, poly without its top bit, init and xorout as normal
+ * (not reflected) values, and whether the input bytes and the result are
+ * reflected. check is the CRC of the 9 bytes "123456789".
+ *
+ * CRCs go 8 bytes at a time using 8 tables (slice by 8), worked out when
+ * the width, poly or reflection changes. CRC-32C uses the SSE4.2 crc32
+ * instruction when the CPU has it. */
+
+#define CHECKSUM_CRC_WIDTH_MAX 64
+
+typedef struct
+{
+    const char *name;
+    int width;
+    uint64_t poly;
+    uint64_t init;
+    bool refin;
+    bool refout;
+    uint64_t xorout;
+    uint64_t check;
+} crc_params_t;
+
+/* the common CRCs, index 0 to checksum_num_crc_presets() - 1 */
+int checksum_num_crc_presets(void);
+const crc_params_t *checksum_crc_preset(int index);
+
+/* false if the params can't be used (width out of range, or a value
+ * wider than the width) */
+bool checksum_crc_params_ok(const crc_params_t *params);
+
+uint64_t checksum_crc(const crc_params_t *params, const uint8_t *data,
+                      size_t len);
+
+/* 64 bit FNV-1a */
+uint64_t checksum_fnv1a64(const uint8_t *data, size_t len);
+
+/* 64 bit xxHash (XXH64) */
+uint64_t checksum_xxh64(const uint8_t *data, size_t len, uint64_t seed);
+
+/* false to use the tables even when the instruction is there, for testing */
+void checksum_use_hardware(bool enable);
+
+/* true if the crc32 instruction is used for CRC-32C */
+bool checksum_using_hardware(void);
+
+#endif
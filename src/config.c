@@ -36,6 +36,11 @@ static int random_n;
 /* extra rounding for sin cos tan */
 static bool use_sct_rounding;
 
+/* how float results are normally displayed */
+static disp_float_format_enum float_format;
+static int fixed_places;
+static bool digit_grouping;
+
 /* fontsizes for the main and binary display */
 static int main_disp_fontsize;
 static int bin_disp_fontsize;
@@ -49,7 +54,7 @@ static int but_height;
 static float_digits_enum float_digits;
 
 /* integer width to use at startup */
-static calc_width_enum integer_width;
+static calc_width_t integer_width;
 
 /* use signed/unsigned type at startup */
 static bool use_unsigned;
@@ -74,8 +79,14 @@ static const char *HEX_GROUP = "HexGroup";
 static const char *RANDOM_01 = "Random01";
 static const char *RANDOM_N = "RandomN";
 static const char *SCT_ROUND = "SCTRounding";
+static const char *FLOAT_FORMAT = "FloatFormat";
+static const char *FIXED_PLACES = "FixedPlaces";
+static const char *DIGIT_GROUPING = "DigitGrouping";
 static const char *FLOAT_DIGITS = "FloatDigits";
+/* IntegerWidth was an index 0 - 3 for 8, 16, 32, 64 bits, now replaced by
+ * IntegerBits, but still read if IntegerBits isn't there */
 static const char *INTEGER_WIDTH = "IntegerWidth";
+static const char *INTEGER_BITS = "IntegerBits";
 static const char *USE_UNSIGNED = "UseUnsigned";
 static const char *WARN_SIGNED_OVERFLOW = "WarnSignedOverflow";
 static const char *WARN_UNSIGNED_OVERFLOW = "WarnUnsignedOverflow";
@@ -83,7 +94,7 @@ static const char *REPLACE_ZERO_WITH_O = "ReplaceZeroWithO";
 
 #define CALC_MODE_DEFAULT calc_mode_float
 #define FLOAT_DIGITS_DEFAULT FLOAT_DIGITS_10_ID
-#define INTEGER_WIDTH_DEFAULT calc_width_64
+#define INTEGER_WIDTH_DEFAULT 64
 
 static int get_integer(GKeyFile *keyfile, const char *grp, const char *keyname, int default_val)
 {
@@ -181,6 +192,21 @@ void config_init(void)
 
         use_sct_rounding = get_boolean(keyfile, SETTINGS, SCT_ROUND, true);
 
+        int ff = get_integer(keyfile, SETTINGS, FLOAT_FORMAT, disp_float_gmode);
+        if (ff < (int)disp_float_gmode || ff >= (int)num_disp_float_formats)
+        {
+            ff = disp_float_gmode;
+        }
+        float_format = (disp_float_format_enum)ff;
+
+        fixed_places = get_integer(keyfile, SETTINGS, FIXED_PLACES, DISP_FIXED_PLACES_DEFAULT);
+        if (fixed_places < DISP_FIXED_PLACES_MIN || fixed_places > DISP_FIXED_PLACES_MAX)
+        {
+            fixed_places = DISP_FIXED_PLACES_DEFAULT;
+        }
+
+        digit_grouping = get_boolean(keyfile, SETTINGS, DIGIT_GROUPING, false);
+
         int fd = get_integer(keyfile, SETTINGS, FLOAT_DIGITS, FLOAT_DIGITS_DEFAULT);
         if (fd < (int)FLOAT_DIGITS_8_ID || fd >= (int)NUM_FLOAT_DIGITS_ID)
         {
@@ -188,12 +214,18 @@ void config_init(void)
         }
         float_digits = (float_digits_enum)fd;
 
-        int iw = get_integer(keyfile, SETTINGS, INTEGER_WIDTH, INTEGER_WIDTH_DEFAULT);
-        if (iw < (int)calc_width_8 || iw >= (int)num_calc_widths)
+        int iw = get_integer(keyfile, SETTINGS, INTEGER_BITS, 0);
+        if (iw == 0)
+        {
+            /* older config file */
+            iw = get_integer(keyfile, SETTINGS, INTEGER_WIDTH, 3);
+            iw = (iw >= 0 && iw <= 3) ? 8 << iw : INTEGER_WIDTH_DEFAULT;
+        }
+        if (iw < CALC_WIDTH_MIN || iw > CALC_WIDTH_MAX)
         {
             iw = INTEGER_WIDTH_DEFAULT;
         }
-        integer_width = (calc_width_enum)iw;
+        integer_width = iw;
 
         use_unsigned = get_boolean(keyfile, SETTINGS, USE_UNSIGNED, false);
         warn_on_signed_overflow = get_boolean(keyfile, SETTINGS, WARN_SIGNED_OVERFLOW, true);
@@ -208,6 +240,9 @@ void config_init(void)
         random_01 = true;
         random_n = RANDOM_N_DEFAULT;
         use_sct_rounding = true;
+        float_format = disp_float_gmode;
+        fixed_places = DISP_FIXED_PLACES_DEFAULT;
+        digit_grouping = false;
         main_disp_fontsize = MAIN_FONTSIZE_DEFAULT;
         bin_disp_fontsize = BIN_FONTSIZE_DEFAULT;
         binop_lbl_fontsize = BINOP_LBL_FONTSIZE_DEFAULT;
@@ -250,8 +285,11 @@ void config_save(void)
     fprintf(fp, "%s=%s\n", RANDOM_01, random_01 ? "true": "false");
     fprintf(fp, "%s=%d\n", RANDOM_N, random_n);
     fprintf(fp, "%s=%s\n", SCT_ROUND, use_sct_rounding ? "true": "false");
+    fprintf(fp, "%s=%d\n", FLOAT_FORMAT, (int)float_format);
+    fprintf(fp, "%s=%d\n", FIXED_PLACES, fixed_places);
+    fprintf(fp, "%s=%s\n", DIGIT_GROUPING, digit_grouping ? "true": "false");
     fprintf(fp, "%s=%d\n", FLOAT_DIGITS, (int)float_digits);
-    fprintf(fp, "%s=%d\n", INTEGER_WIDTH, (int)integer_width);
+    fprintf(fp, "%s=%d\n", INTEGER_BITS, integer_width);
     fprintf(fp, "%s=%s\n", USE_UNSIGNED, use_unsigned ? "true": "false");
     fprintf(fp, "%s=%s\n", WARN_SIGNED_OVERFLOW, warn_on_signed_overflow ? "true": "false");
     fprintf(fp, "%s=%s\n", WARN_UNSIGNED_OVERFLOW, warn_on_unsigned_overflow ? "true": "false");
@@ -269,8 +307,11 @@ void config_save(void)
     g_key_file_set_boolean(keyfile, SETTINGS, RANDOM_01, random_01);
     g_key_file_set_integer(keyfile, SETTINGS, RANDOM_N, random_n);
     g_key_file_set_boolean(keyfile, SETTINGS, SCT_ROUND, use_sct_rounding);
+    g_key_file_set_integer(keyfile, SETTINGS, FLOAT_FORMAT, (int)float_format);
+    g_key_file_set_integer(keyfile, SETTINGS, FIXED_PLACES, fixed_places);
+    g_key_file_set_boolean(keyfile, SETTINGS, DIGIT_GROUPING, digit_grouping);
     g_key_file_set_integer(keyfile, SETTINGS, FLOAT_DIGITS, (int)float_digits);
-    g_key_file_set_integer(keyfile, SETTINGS, INTEGER_WIDTH, (int)integer_width);
+    g_key_file_set_integer(keyfile, SETTINGS, INTEGER_BITS, integer_width);
     g_key_file_set_boolean(keyfile, SETTINGS, USE_UNSIGNED, use_unsigned);
     g_key_file_set_boolean(keyfile, SETTINGS, WARN_SIGNED_OVERFLOW, warn_on_signed_overflow);
     g_key_file_set_boolean(keyfile, SETTINGS, WARN_UNSIGNED_OVERFLOW, warn_on_unsigned_overflow);
@@ -333,6 +374,36 @@ bool config_get_use_sct_rounding(void)
     return use_sct_rounding;
 }
 
+void config_set_float_format(disp_float_format_enum ff)
+{
+    float_format = ff;
+}
+
+disp_float_format_enum config_get_float_format(void)
+{
+    return float_format;
+}
+
+void config_set_fixed_places(int places)
+{
+    fixed_places = places;
+}
+
+int config_get_fixed_places(void)
+{
+    return fixed_places;
+}
+
+void config_set_digit_grouping(bool en)
+{
+    digit_grouping = en;
+}
+
+bool config_get_digit_grouping(void)
+{
+    return digit_grouping;
+}
+
 void config_set_main_disp_fontsize(int fs)
 {
     main_disp_fontsize = fs;
@@ -388,12 +459,12 @@ const char *config_get_dirname(void)
     return CALCDIR;
 }
 
-void config_set_integer_width(calc_width_enum width)
+void config_set_integer_width(calc_width_t width)
 {
     integer_width = width;
 }
 
-calc_width_enum config_get_integer_width(void)
+calc_width_t config_get_integer_width(void)
 {
     return integer_width;
 }
@@ -24,6 +24,7 @@
 #include <stdbool.h>
 #include "gui.h"
 #include "calc.h"
+#include "display.h"
 
 /* main display */
 #define MAIN_FONTSIZE_DEFAULT 22
@@ -62,8 +63,8 @@ void config_set_float_digits(float_digits_enum fd);
 float_digits_enum config_get_float_digits(void);
 
 /* specifies the integer width at startup */
-void config_set_integer_width(calc_width_enum width);
-calc_width_enum config_get_integer_width(void);
+void config_set_integer_width(calc_width_t width);
+calc_width_t config_get_integer_width(void);
 
 /* specifies signed/unsigned at startup */
 void config_set_use_unsigned(bool en);
@@ -96,6 +97,15 @@ int config_get_random_n(void);
 void config_set_use_sct_rounding(bool en);
 bool config_get_use_sct_rounding(void);
 
+void config_set_float_format(disp_float_format_enum ff);
+disp_float_format_enum config_get_float_format(void);
+
+void config_set_fixed_places(int places);
+int config_get_fixed_places(void);
+
+void config_set_digit_grouping(bool en);
+bool config_get_digit_grouping(void);
+
 void config_set_warn_on_signed_overflow(bool en);
 bool config_get_warn_on_signed_overflow(void);
 
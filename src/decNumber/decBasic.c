@@ -52,6 +52,9 @@ static decFloat *decDivide(decFloat *, const decFloat *,
 static decFloat *decCanonical(decFloat *, const decFloat *);
 static void      decFiniteMultiply(bcdnum *, uByte *, const decFloat *,
                               const decFloat *);
+#if DECUSE128
+static uLong     decSplitColumn(uLLong, uLong *);
+#endif
 static decFloat *decInfinity(decFloat *, const decFloat *);
 static decFloat *decInvalid(decFloat *, decContext *);
 static decFloat *decNaNs(decFloat *, const decFloat *, const decFloat *,
@@ -695,6 +698,10 @@ static decFloat * decDivide(decFloat *result, const decFloat *dfl,
 #define MULOPLEN  DECPMAX9         // operand length ('digits' base 10**9)
 #define MULACCLEN (MULOPLEN*2)              // accumulator length (ditto)
 #define LEADZEROS (MULACCLEN*9 - DECPMAX*2) // leading zeros always
+#if DECUSE128
+#define MULOPLEN18  (MULOPLEN/2)    // operand length ('digits' base 10**18)
+#define MULACCLEN18 (MULOPLEN18*2)  // accumulator length (ditto)
+#endif
 
 // Assertions: exponent not too large and MULACCLEN is a multiple of 4
 #if DECEMAXD>9
@@ -704,6 +711,38 @@ static decFloat * decDivide(decFloat *result, const decFloat *dfl,
   // This assumption is used below only for initialization
   #error MULACCLEN is not a multiple of 4
 #endif
+#if DECUSE128 && MULOPLEN!=(MULOPLEN/2)*2
+  // pairs of base-billion digits are combined for the 128-bit path
+  #error MULOPLEN is not a multiple of 2
+#endif
+
+#if DECUSE128
+/* ------------------------------------------------------------------ */
+/* decSplitColumn -- split a column from the 128-bit multiply         */
+/*                                                                    */
+/*   col is the column value, which must be <2**122                   */
+/*   lo  receives col%10**18                                          */
+/*   returns col/10**18                                               */
+/*                                                                    */
+/* This uses the same quotient estimation as the 64-bit path in       */
+/* decFiniteMultiply (see the notes there), with A=58 and B=64 so     */
+/* that hop, magic and the estimate all fit in 64 bits and only one   */
+/* 64x64->128-bit multiply is needed.  The estimate can be low by up  */
+/* to 2, and is never high, so the true remainder (<3*10**18) fits in */
+/* 64 bits and can be calculated with wrapping 64-bit arithmetic.     */
+/* ------------------------------------------------------------------ */
+#define MULTBASE18  ((uLong)BILLION*BILLION)
+#define MULMAGIC18  ((uLong)(((uLLong)1<<122)/MULTBASE18))
+
+static uLong decSplitColumn(uLLong col, uLong *lo) {
+  uLong hop=(uLong)(col>>58);           // col/2**58
+  uLong est=(uLong)(((uLLong)hop*MULMAGIC18)>>64); // quotient estimate
+  uLong rem=(uLong)col-est*MULTBASE18;  // low word of remainder
+  for (; rem>=MULTBASE18; est++) rem-=MULTBASE18; // correct by 0-2
+  *lo=rem;
+  return est;
+  } // decSplitColumn
+#endif
 
 static void decFiniteMultiply(bcdnum *num, uByte *bcdacc,
                               const decFloat *dfl, const decFloat *dfr) {
@@ -713,7 +752,15 @@ static void decFiniteMultiply(bcdnum *num, uByte *bcdacc,
   uByte  *ub;                      // ..
   uInt   uiwork;                   // for macros
 
-  #if DECUSE64
+  #if DECUSE128
+  uLong  bufl18[MULOPLEN18];       // left  coefficient (base 10**18)
+  uLong  bufr18[MULOPLEN18];       // right coefficient (base 10**18)
+  uLong  *ul, *ur;                 // work
+  uLLong accw[MULACCLEN18];        // accumulator (base 10**18+)
+  uLLong *pw;                      // work -> wide accumulator
+  uLong  carry;                    // carry between columns
+  uInt   acc[MULACCLEN];           // coefficent in base-billion ..
+  #elif DECUSE64
   uLong  accl[MULACCLEN];          // lazy accumulator (base-billion+)
   uLong  *pl;                      // work -> lazy accumulator
   uInt   acc[MULACCLEN];           // coefficent in base-billion ..
@@ -742,8 +789,41 @@ static void decFiniteMultiply(bcdnum *num, uByte *bcdacc,
     printf("\n");
   #endif
 
-  // start the 64-bit/32-bit differing paths...
-#if DECUSE64
+  // start the 128-bit/64-bit/32-bit differing paths...
+#if DECUSE128
+
+  // Pairs of base-billion digits are combined into base-10**18 limbs,
+  // which quarters the number of partial products.  Each partial
+  // product is an exact 64x64->128-bit multiply (<10**36), and a
+  // column holds at most MULOPLEN18 of them so there is no overflow
+  // (2*10**36 for QUAD, against 3.4*10**38).
+  for (ui=bufl, uj=bufr, ul=bufl18, ur=bufr18; ul<bufl18+MULOPLEN18;
+       ui+=2, uj+=2, ul++, ur++) {
+    *ul=*ui+(uLong)*(ui+1)*MULTBASE;
+    *ur=*uj+(uLong)*(uj+1)*MULTBASE;
+    } // ul
+
+  for (pw=accw; pw<accw+MULACCLEN18; pw++) *pw=0;
+
+  for (ur=bufr18; ur<bufr18+MULOPLEN18; ur++) { // over each item in rhs
+    if (*ur==0) continue;                 // product cannot affect result
+    pw=accw+(ur-bufr18);                  // where to add the lhs
+    for (ul=bufl18; ul<bufl18+MULOPLEN18; ul++, pw++) { // each item in lhs
+      *pw+=(uLLong)*ur*(*ul);
+      } // ul
+    } // ur
+
+  // Resolve the carries, and split each base 10**18 limb into the
+  // two base-billion digits needed for BCD conversion
+  carry=0;
+  for (pw=accw, pa=acc; pw<accw+MULACCLEN18; pw++, pa+=2) { // each column
+    uLong lo;                           // work
+    carry=decSplitColumn(*pw+carry, &lo);
+    *pa=(uInt)(lo%MULTBASE);
+    *(pa+1)=(uInt)(lo/MULTBASE);
+    } // pw loop
+
+#elif DECUSE64
 
   // zero the accumulator
   #if MULACCLEN==4
@@ -40,6 +40,19 @@
   #define DECUSE64  1         /* 1=use int64s, 0=int32 & smaller only */
   #endif
 
+  /* Conditional code flag -- 1 to use unsigned __int128 for the     */
+  /* decFloat coefficient multiply; only a win where a 64x64->128-bit */
+  /* multiply is a single instruction, so defaults on for x86-64 and  */
+  /* aarch64 only                                                     */
+  #if !defined(DECUSE128)
+    #if DECUSE64 && defined(__SIZEOF_INT128__) \
+        && (defined(__x86_64__) || defined(__aarch64__))
+    #define DECUSE128 1
+    #else
+    #define DECUSE128 0
+    #endif
+  #endif
+
   /* Conditional code flag -- set this to 0 to exclude printf calls   */
   #if !defined(DECPRINT)
   #define DECPRINT  1         /* 1=allow printf calls; 0=no printf    */
@@ -68,6 +81,9 @@
   /* ---------------------------------------------------------------- */
   /* Check parameter dependencies                                     */
   /* ---------------------------------------------------------------- */
+  #if DECUSE128 & !DECUSE64
+    #error DECUSE128 needs DECUSE64
+  #endif
   #if DECCHECK & !DECPRINT
     #error DECCHECK needs DECPRINT to be useful
   #endif
@@ -96,6 +112,9 @@
   #define Long   int64_t
   #define uLong  uint64_t
   #endif
+  #if DECUSE128
+  #define uLLong unsigned __int128
+  #endif
 
   /* Development-use definitions                                      */
   typedef long int LI;        /* for printf arguments only            */
@@ -0,0 +1,1091 @@
+/*****************************************************************************
+ * File dfp_bid128.c part of ProgAndSciCalc
+ *
+ * Copyright (C) 2018 Ken Bromham
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdbool.h>
+#include "dfp_bid128.h"
+
+/* Only built where the compiler has a 128 bit integer type, which is
+ * gcc/clang on any 64 bit target. */
+#if defined(__SIZEOF_INT128__)
+
+typedef unsigned __int128 u128;
+
+/* 256 bit unsigned, w[0] least significant. Big enough for the product
+ * of two coefficients, or the aligned sum in bid_add. */
+typedef struct
+{
+    uint64_t w[4];
+} u256_t;
+
+#define BID_PMAX    34
+#define BID_EMAX    6144
+#define BID_EMIN    (-6143)
+#define BID_BIAS    6176
+/* smallest and largest exponent that can be stored */
+#define BID_ETINY   (BID_EMIN - (BID_PMAX - 1))
+#define BID_ETOP    (BID_EMAX - (BID_PMAX - 1))
+
+/* top word layout, these are the same as DECFLOAT_* shifted up by 32 */
+#define BID_INF     0x7800000000000000ULL
+#define BID_QNAN    0x7c00000000000000ULL
+#define BID_SNAN    0x7e00000000000000ULL
+#define BID_TOP2    0x6000000000000000ULL
+
+#define BID_EXP_SHIFT  49
+#define BID_COEFF_HI_MASK  ((1ULL << BID_EXP_SHIFT) - 1)
+/* NaN payload is the bottom 110 bits */
+#define BID_NAN_HI_MASK  ((1ULL << 46) - 1)
+
+typedef enum
+{
+    bid_finite,
+    bid_inf,
+    bid_qnan,
+    bid_snan
+} bid_class_enum;
+
+typedef struct
+{
+    bid_class_enum cls;
+    uint32_t sign;      /* 0 or 1 */
+    int32_t exp;        /* unbiased, only valid when finite */
+    u128 coeff;         /* coefficient, or payload for a NaN */
+} bid_unpacked_t;
+
+/* remainder classification after dropping digits, in the same sense as
+ * the 'reround' digit in decFinalize */
+enum
+{
+    round_exact,
+    round_below_half,
+    round_half,
+    round_above_half
+};
+
+#define E19 ((u128)10000000000000000000ULL)
+
+static const u128 pow10_tab[39] =
+{
+    1ULL,
+    10ULL,
+    100ULL,
+    1000ULL,
+    10000ULL,
+    100000ULL,
+    1000000ULL,
+    10000000ULL,
+    100000000ULL,
+    1000000000ULL,
+    10000000000ULL,
+    100000000000ULL,
+    1000000000000ULL,
+    10000000000000ULL,
+    100000000000000ULL,
+    1000000000000000ULL,
+    10000000000000000ULL,
+    100000000000000000ULL,
+    1000000000000000000ULL,
+    10000000000000000000ULL,
+    E19 * 10ULL,
+    E19 * 100ULL,
+    E19 * 1000ULL,
+    E19 * 10000ULL,
+    E19 * 100000ULL,
+    E19 * 1000000ULL,
+    E19 * 10000000ULL,
+    E19 * 100000000ULL,
+    E19 * 1000000000ULL,
+    E19 * 10000000000ULL,
+    E19 * 100000000000ULL,
+    E19 * 1000000000000ULL,
+    E19 * 10000000000000ULL,
+    E19 * 100000000000000ULL,
+    E19 * 1000000000000000ULL,
+    E19 * 10000000000000000ULL,
+    E19 * 100000000000000000ULL,
+    E19 * 1000000000000000000ULL,
+    E19 * 10000000000000000000ULL,
+};
+
+#define POW10_PMAX  (pow10_tab[BID_PMAX])
+
+/* and the ones that need more than 128 bits, 10^39 to 10^77 */
+static const u256_t pow10_wide_tab[39] =
+{
+    {{0x5f65568000000000ULL, 0xf050fe938943acc4ULL, 0x0000000000000002ULL, 0x0000000000000000ULL}},
+    {{0xb9f5610000000000ULL, 0x6329f1c35ca4bfabULL, 0x000000000000001dULL, 0x0000000000000000ULL}},
+    {{0x4395ca0000000000ULL, 0xdfa371a19e6f7cb5ULL, 0x0000000000000125ULL, 0x0000000000000000ULL}},
+    {{0xa3d9e40000000000ULL, 0xbc627050305adf14ULL, 0x0000000000000b7aULL, 0x0000000000000000ULL}},
+    {{0x6682e80000000000ULL, 0x5bd86321e38cb6ceULL, 0x00000000000072cbULL, 0x0000000000000000ULL}},
+    {{0x011d100000000000ULL, 0x9673df52e37f2410ULL, 0x0000000000047bf1ULL, 0x0000000000000000ULL}},
+    {{0x0b22a00000000000ULL, 0xe086b93ce2f768a0ULL, 0x00000000002cd76fULL, 0x0000000000000000ULL}},
+    {{0x6f5a400000000000ULL, 0xc5433c60ddaa1640ULL, 0x0000000001c06a5eULL, 0x0000000000000000ULL}},
+    {{0x5986800000000000ULL, 0xb4a05bc8a8a4de84ULL, 0x00000000118427b3ULL, 0x0000000000000000ULL}},
+    {{0x7f41000000000000ULL, 0x0e4395d69670b12bULL, 0x00000000af298d05ULL, 0x0000000000000000ULL}},
+    {{0xf88a000000000000ULL, 0x8ea3da61e066ebb2ULL, 0x00000006d79f8232ULL, 0x0000000000000000ULL}},
+    {{0xb564000000000000ULL, 0x926687d2c40534fdULL, 0x000000446c3b15f9ULL, 0x0000000000000000ULL}},
+    {{0x15e8000000000000ULL, 0xb8014e3ba83411e9ULL, 0x000002ac3a4edbbfULL, 0x0000000000000000ULL}},
+    {{0xdb10000000000000ULL, 0x300d0e549208b31aULL, 0x00001aba4714957dULL, 0x0000000000000000ULL}},
+    {{0x8ea0000000000000ULL, 0xe0828f4db456ff0cULL, 0x00010b46c6cdd6e3ULL, 0x0000000000000000ULL}},
+    {{0x9240000000000000ULL, 0xc51999090b65f67dULL, 0x000a70c3c40a64e6ULL, 0x0000000000000000ULL}},
+    {{0xb680000000000000ULL, 0xb2fffa5a71fba0e7ULL, 0x006867a5a867f103ULL, 0x0000000000000000ULL}},
+    {{0x2100000000000000ULL, 0xfdffc78873d4490dULL, 0x04140c78940f6a24ULL, 0x0000000000000000ULL}},
+    {{0x4a00000000000000ULL, 0xebfdcb54864ada83ULL, 0x28c87cb5c89a2571ULL, 0x0000000000000000ULL}},
+    {{0xe400000000000000ULL, 0x37e9f14d3eec8920ULL, 0x97d4df19d6057673ULL, 0x0000000000000001ULL}},
+    {{0xe800000000000000ULL, 0x2f236d04753d5b48ULL, 0xee50b7025c36a080ULL, 0x000000000000000fULL}},
+    {{0x1000000000000000ULL, 0xd762422c946590d9ULL, 0x4f2726179a224501ULL, 0x000000000000009fULL}},
+    {{0xa000000000000000ULL, 0x69d695bdcbf7a87aULL, 0x17877cec0556b212ULL, 0x0000000000000639ULL}},
+    {{0x4000000000000000ULL, 0x2261d969f7ac94caULL, 0xeb4ae1383562f4b8ULL, 0x0000000000003e3aULL}},
+    {{0x8000000000000000ULL, 0x57d27e23acbdcfe6ULL, 0x30eccc3215dd8f31ULL, 0x0000000000026e4dULL}},
+    {{0x0000000000000000ULL, 0x6e38ed64bf6a1f01ULL, 0xe93ff9f4daa797edULL, 0x0000000000184f03ULL}},
+    {{0x0000000000000000ULL, 0x4e3945ef7a25360aULL, 0x1c7fc3908a8bef46ULL, 0x0000000000f31627ULL}},
+    {{0x0000000000000000ULL, 0x0e3cbb5ac5741c64ULL, 0x1cfda3a5697758bfULL, 0x00000000097edd87ULL}},
+    {{0x0000000000000000ULL, 0x8e5f518bb6891be8ULL, 0x21e864761ea97776ULL, 0x000000005ef4a747ULL}},
+    {{0x0000000000000000ULL, 0x8fb92f75215b1710ULL, 0x5313ec9d329eaaa1ULL, 0x00000003b58e88c7ULL}},
+    {{0x0000000000000000ULL, 0x9d3bda934d8ee6a0ULL, 0x3ec73e23fa32aa4fULL, 0x00000025179157c9ULL}},
+    {{0x0000000000000000ULL, 0x245689c107950240ULL, 0x73c86d67c5faa71cULL, 0x00000172ebad6ddcULL}},
+    {{0x0000000000000000ULL, 0x6b61618a4bd21680ULL, 0x85d4460dbbca8719ULL, 0x00000e7d34c64a9cULL}},
+    {{0x0000000000000000ULL, 0x31cdcf66f634e100ULL, 0x3a4abc8955e946feULL, 0x000090e40fbeea1dULL}},
+    {{0x0000000000000000ULL, 0xf20a1a059e10ca00ULL, 0x46eb5d5d5b1cc5edULL, 0x0005a8e89d752524ULL}},
+    {{0x0000000000000000ULL, 0x746504382ca7e400ULL, 0xc531a5a58f1fbb4bULL, 0x003899162693736aULL}},
+    {{0x0000000000000000ULL, 0x8bf22a31be8ee800ULL, 0xb3f07877973d50f2ULL, 0x0235fadd81c2822bULL}},
+    {{0x0000000000000000ULL, 0x7775a5f171951000ULL, 0x0764b4abe8652979ULL, 0x161bcca7119915b5ULL}},
+    {{0x0000000000000000ULL, 0xaa987b6e6fd2a000ULL, 0x49ef0eb713f39ebeULL, 0xdd15fe86affad912ULL}},
+};
+
+
+/***************************************************************************
+ * 128 and 256 bit integer helpers
+ */
+
+/* number of decimal digits in x, 1 for zero */
+static int digits_u128(u128 x)
+{
+    uint64_t hi = (uint64_t)(x >> 64);
+    int bits, t;
+
+    if (hi)
+        bits = 128 - __builtin_clzll(hi);
+    else
+        bits = 64 - __builtin_clzll((uint64_t)x | 1);
+
+    /* bits * log10(2) is within one of the answer */
+    t = (bits * 1233) >> 12;
+    return t - (x < pow10_tab[t]) + 1;
+}
+
+static void u256_from_u128(u256_t *v, u128 x)
+{
+    v->w[0] = (uint64_t)x;
+    v->w[1] = (uint64_t)(x >> 64);
+    v->w[2] = 0;
+    v->w[3] = 0;
+}
+
+static bool u256_fits_u128(const u256_t *v)
+{
+    return v->w[2] == 0 && v->w[3] == 0;
+}
+
+static u128 u256_low(const u256_t *v)
+{
+    return ((u128)v->w[1] << 64) | v->w[0];
+}
+
+/* v = a * b */
+static void u256_mul_u128(u256_t *v, u128 a, u128 b)
+{
+    uint64_t a0 = (uint64_t)a;
+    uint64_t a1 = (uint64_t)(a >> 64);
+    uint64_t b0 = (uint64_t)b;
+    uint64_t b1 = (uint64_t)(b >> 64);
+    u128 p00 = (u128)a0 * b0;
+    u128 p01 = (u128)a0 * b1;
+    u128 p10 = (u128)a1 * b0;
+    u128 p11 = (u128)a1 * b1;
+    u128 mid, top;
+
+    mid = (p00 >> 64) + (uint64_t)p01 + (uint64_t)p10;
+    top = p11 + (p01 >> 64) + (p10 >> 64) + (mid >> 64);
+    v->w[0] = (uint64_t)p00;
+    v->w[1] = (uint64_t)mid;
+    v->w[2] = (uint64_t)top;
+    v->w[3] = (uint64_t)(top >> 64);
+}
+
+/* v *= m, caller makes sure the result fits */
+static void u256_mul_u64(u256_t *v, uint64_t m)
+{
+    u128 carry = 0;
+    int i;
+
+    for (i = 0; i < 4; i++)
+    {
+        u128 p = (u128)v->w[i] * m + carry;
+        v->w[i] = (uint64_t)p;
+        carry = p >> 64;
+    }
+}
+
+/* v *= 10^n */
+static void u256_scale_pow10(u256_t *v, int n)
+{
+    while (n > 19)
+    {
+        u256_mul_u64(v, (uint64_t)pow10_tab[19]);
+        n -= 19;
+    }
+    u256_mul_u64(v, (uint64_t)pow10_tab[n]);
+}
+
+static void u256_add_u128(u256_t *v, u128 x)
+{
+    u128 s;
+
+    s = (u128)v->w[0] + (uint64_t)x;
+    v->w[0] = (uint64_t)s;
+    s = (s >> 64) + v->w[1] + (uint64_t)(x >> 64);
+    v->w[1] = (uint64_t)s;
+    s = (s >> 64) + v->w[2];
+    v->w[2] = (uint64_t)s;
+    v->w[3] += (uint64_t)(s >> 64);
+}
+
+/* v -= x, caller makes sure v >= x */
+static void u256_sub_u128(u256_t *v, u128 x)
+{
+    uint64_t x0 = (uint64_t)x;
+    uint64_t x1 = (uint64_t)(x >> 64);
+    uint64_t borrow;
+
+    borrow = v->w[0] < x0;
+    v->w[0] -= x0;
+    {
+        uint64_t t = v->w[1] - x1;
+        uint64_t b2 = (v->w[1] < x1) || (t < borrow);
+        v->w[1] = t - borrow;
+        borrow = b2;
+    }
+    {
+        uint64_t b2 = v->w[2] < borrow;
+        v->w[2] -= borrow;
+        v->w[3] -= b2;
+    }
+}
+
+/* v /= d, returns the remainder */
+static uint64_t u256_divmod_u64(u256_t *v, uint64_t d)
+{
+    u128 rem = 0;
+    int i = 3;
+
+    /* skip the leading zero limbs */
+    while (i > 0 && v->w[i] == 0)
+    {
+        i--;
+    }
+    for (; i >= 0; i--)
+    {
+        u128 cur = (rem << 64) | v->w[i];
+        v->w[i] = (uint64_t)(cur / d);
+        rem = cur % d;
+    }
+    return (uint64_t)rem;
+}
+
+static int u256_bits(const u256_t *v)
+{
+    int i;
+
+    for (i = 3; i > 0; i--)
+    {
+        if (v->w[i])
+            return i * 64 + 64 - __builtin_clzll(v->w[i]);
+    }
+    return 64 - __builtin_clzll(v->w[0] | 1);
+}
+
+/* is v < 10^n, for 39 <= n <= 77 */
+static bool u256_lt_pow10(const u256_t *v, int n)
+{
+    const u256_t *p = &pow10_wide_tab[n - 39];
+    int i;
+
+    for (i = 3; i >= 0; i--)
+    {
+        if (v->w[i] != p->w[i])
+            return v->w[i] < p->w[i];
+    }
+    return false;
+}
+
+/* number of decimal digits in v, same method as digits_u128 */
+static int u256_digits(const u256_t *v)
+{
+    int t;
+
+    if (u256_fits_u128(v))
+        return digits_u128(u256_low(v));
+
+    /* v >= 2^128 so at least 39 digits */
+    t = (u256_bits(v) * 1233) >> 12;
+    if (t < 39)
+        return 39;
+    return t - u256_lt_pow10(v, t) + 1;
+}
+
+/* Drop the bottom n digits of v (1 <= n <= digits in v), returning what
+ * is left, and classify what was dropped. */
+static u128 u256_drop_digits(u256_t *v, int n, int *rnd)
+{
+    bool sticky = false;
+    uint64_t r, half;
+
+    /* lowest digits first, these can only be sticky */
+    while (n > 19)
+    {
+        sticky |= u256_divmod_u64(v, (uint64_t)pow10_tab[19]) != 0;
+        n -= 19;
+    }
+
+    r = u256_divmod_u64(v, (uint64_t)pow10_tab[n]);
+    half = 5 * (uint64_t)pow10_tab[n - 1];
+    if (r > half || (r == half && sticky))
+        *rnd = round_above_half;
+    else if (r == half)
+        *rnd = round_half;
+    else if (r != 0 || sticky)
+        *rnd = round_below_half;
+    else
+        *rnd = round_exact;
+
+    return u256_low(v);
+}
+
+
+/***************************************************************************
+ * encoding
+ */
+
+static void bid_unpack(const bid128_t *a, bid_unpacked_t *u)
+{
+    uint64_t hi = a->w[1];
+
+    u->sign = (uint32_t)(hi >> 63);
+    u->exp = 0;
+    if ((hi & BID_TOP2) != BID_TOP2)
+    {
+        u->cls = bid_finite;
+        u->exp = (int32_t)((hi >> BID_EXP_SHIFT) & 0x3fff) - BID_BIAS;
+        u->coeff = ((u128)(hi & BID_COEFF_HI_MASK) << 64) | a->w[0];
+        /* 10^34 or above is non-canonical, treated as zero */
+        if (u->coeff >= POW10_PMAX)
+        {
+            u->coeff = 0;
+        }
+    }
+    else if ((hi & BID_QNAN) == BID_INF)
+    {
+        u->cls = bid_inf;
+        u->coeff = 0;
+    }
+    else if ((hi & BID_QNAN) == BID_QNAN)
+    {
+        u->cls = (hi & (BID_SNAN ^ BID_QNAN)) ? bid_snan : bid_qnan;
+        u->coeff = ((u128)(hi & BID_NAN_HI_MASK) << 64) | a->w[0];
+        if (u->coeff >= pow10_tab[BID_PMAX - 1])
+        {
+            u->coeff = 0;
+        }
+    }
+    else
+    {
+        /* the large coefficient form, coefficient is at least 2^113 so
+         * always non-canonical, exponent is 2 bits further down */
+        u->cls = bid_finite;
+        u->exp = (int32_t)((hi >> (BID_EXP_SHIFT - 2)) & 0x3fff) - BID_BIAS;
+        u->coeff = 0;
+    }
+}
+
+/* exp must be in range BID_ETINY to BID_ETOP, coeff < 10^34 */
+static bid128_t *bid_pack(bid128_t *r, uint32_t sign, int32_t exp, u128 coeff)
+{
+    r->w[1] = ((uint64_t)sign << 63)
+              | ((uint64_t)(exp + BID_BIAS) << BID_EXP_SHIFT)
+              | (uint64_t)(coeff >> 64);
+    r->w[0] = (uint64_t)coeff;
+    return r;
+}
+
+static bid128_t *bid_pack_special(bid128_t *r, uint32_t sign,
+                                  uint64_t special, u128 payload)
+{
+    r->w[1] = ((uint64_t)sign << 63) | special | (uint64_t)(payload >> 64);
+    r->w[0] = (uint64_t)payload;
+    return r;
+}
+
+static void coeff_to_bcd(u128 c, uint8_t *bcd)
+{
+    uint64_t hi = (uint64_t)(c / pow10_tab[17]);
+    uint64_t lo = (uint64_t)(c % pow10_tab[17]);
+    int i;
+
+    for (i = BID_PMAX - 1; i >= 17; i--)
+    {
+        bcd[i] = lo % 10;
+        lo /= 10;
+    }
+    for (; i >= 0; i--)
+    {
+        bcd[i] = hi % 10;
+        hi /= 10;
+    }
+}
+
+static u128 bcd_to_coeff(const uint8_t *bcd)
+{
+    uint64_t hi = 0, lo = 0;
+    int i;
+
+    for (i = 0; i < 17; i++)
+    {
+        hi = hi * 10 + bcd[i];
+    }
+    for (; i < BID_PMAX; i++)
+    {
+        lo = lo * 10 + bcd[i];
+    }
+    return (u128)hi * (uint64_t)pow10_tab[17] + lo;
+}
+
+void bid128_to_decquad(const bid128_t *a, decQuad *dq)
+{
+    bid_unpacked_t u;
+    uint8_t bcd[BID_PMAX];
+    int32_t exp;
+
+    bid_unpack(a, &u);
+    coeff_to_bcd(u.coeff, bcd);
+    switch (u.cls)
+    {
+    case bid_inf:
+        exp = DECFLOAT_Inf;
+        break;
+    case bid_qnan:
+        exp = DECFLOAT_qNaN;
+        break;
+    case bid_snan:
+        exp = DECFLOAT_sNaN;
+        break;
+    default:
+        exp = u.exp;
+        break;
+    }
+    decQuadFromBCD(dq, exp, bcd, u.sign ? DECFLOAT_Sign : 0);
+}
+
+void bid128_from_decquad(bid128_t *r, const decQuad *dq)
+{
+    uint8_t bcd[BID_PMAX];
+    int32_t exp;
+    uint32_t sign;
+
+    sign = decQuadToBCD(dq, &exp, bcd) ? 1 : 0;
+    if (decQuadIsNaN(dq))
+    {
+        bid_pack_special(r, sign,
+                         decQuadIsSignaling(dq) ? BID_SNAN : BID_QNAN,
+                         bcd_to_coeff(bcd));
+    }
+    else if (decQuadIsInfinite(dq))
+    {
+        bid_pack_special(r, sign, BID_INF, 0);
+    }
+    else
+    {
+        bid_pack(r, sign, exp, bcd_to_coeff(bcd));
+    }
+}
+
+
+/***************************************************************************
+ * rounding, and the special value rules, as decCommon.c and decBasic.c
+ */
+
+static bool bid_need_bump(decContext *set, uint32_t sign, int rnd, u128 c)
+{
+    switch (set->round)
+    {
+    case DEC_ROUND_HALF_EVEN:
+        return rnd == round_above_half || (rnd == round_half && (c & 1));
+    case DEC_ROUND_DOWN:
+        return false;
+    case DEC_ROUND_HALF_DOWN:
+        return rnd == round_above_half;
+    case DEC_ROUND_HALF_UP:
+        return rnd >= round_half;
+    case DEC_ROUND_UP:
+        return true;
+    case DEC_ROUND_CEILING:
+        return !sign;
+    case DEC_ROUND_FLOOR:
+        return sign;
+    case DEC_ROUND_05UP:
+        return c % 10 == 0 || c % 10 == 5;
+    default:
+        set->status |= DEC_Invalid_context;
+        return false;
+    }
+}
+
+/* Round the value v x 10^exp to fit and lay it out. v is either exact,
+ * or has been given a sticky digit which makes it round the same as the
+ * exact value would. Follows decFinalize. */
+static bid128_t *bid_finalise(bid128_t *r, uint32_t sign, int32_t exp,
+                              u256_t *v, decContext *set)
+{
+    int len = u256_digits(v);
+    int drop = len - BID_PMAX;
+    u128 c;
+
+    if (BID_ETINY - exp > drop)
+    {
+        drop = BID_ETINY - exp;
+    }
+
+    if (drop > 0)
+    {
+        int rnd;
+
+        exp += drop;
+        if (drop > len)
+        {
+            /* whole coefficient is sticky */
+            c = 0;
+            rnd = (v->w[0] | v->w[1] | v->w[2] | v->w[3]) ? round_below_half
+                                                          : round_exact;
+        }
+        else
+        {
+            c = u256_drop_digits(v, drop, &rnd);
+        }
+
+        if (rnd != round_exact)
+        {
+            set->status |= DEC_Inexact;
+            if (exp < BID_EMIN && exp + digits_u128(c) - 1 < BID_EMIN)
+            {
+                set->status |= DEC_Underflow;
+            }
+            if (bid_need_bump(set, sign, rnd, c))
+            {
+                /* 99..9 becomes 100..0, only needs the exponent bumping
+                 * if it was full length (otherwise subnormal) */
+                if (++c == POW10_PMAX)
+                {
+                    c = pow10_tab[BID_PMAX - 1];
+                    exp++;
+                }
+            }
+        }
+    }
+    else
+    {
+        c = u256_low(v);
+    }
+
+    if (exp > BID_ETOP)
+    {
+        if (c == 0)
+        {
+            exp = BID_ETOP;
+        }
+        else if (exp + digits_u128(c) - 1 > BID_EMAX)
+        {
+            bool need_max = false;
+
+            set->status |= DEC_Overflow | DEC_Inexact;
+            switch (set->round)
+            {
+            case DEC_ROUND_DOWN:
+            case DEC_ROUND_05UP:
+                need_max = true;
+                break;
+            case DEC_ROUND_CEILING:
+                need_max = sign;
+                break;
+            case DEC_ROUND_FLOOR:
+                need_max = !sign;
+                break;
+            default:
+                break;
+            }
+            if (!need_max)
+            {
+                return bid_pack_special(r, sign, BID_INF, 0);
+            }
+            return bid_pack(r, sign, BID_ETOP, POW10_PMAX - 1);
+        }
+        else
+        {
+            /* fold down */
+            c *= pow10_tab[exp - BID_ETOP];
+            exp = BID_ETOP;
+        }
+    }
+
+    return bid_pack(r, sign, exp, c);
+}
+
+/* one or both operands is a NaN, b can be NULL, follows decNaNs */
+static bid128_t *bid_nans(bid128_t *r, const bid_unpacked_t *a,
+                          const bid_unpacked_t *b, decContext *set)
+{
+    if (b != NULL && b->cls == bid_snan && a->cls != bid_snan)
+    {
+        a = b;
+    }
+    if (a->cls == bid_snan)
+    {
+        set->status |= DEC_Invalid_operation;
+    }
+    else if (a->cls != bid_qnan)
+    {
+        a = b;
+    }
+    return bid_pack_special(r, a->sign, BID_QNAN, a->coeff);
+}
+
+static bid128_t *bid_invalid(bid128_t *r, decContext *set)
+{
+    set->status |= DEC_Invalid_operation;
+    return bid_pack_special(r, 0, BID_QNAN, 0);
+}
+
+static bool is_nan_class(const bid_unpacked_t *u)
+{
+    return u->cls == bid_qnan || u->cls == bid_snan;
+}
+
+
+/***************************************************************************
+ * arithmetic
+ */
+
+static bid128_t *bid_add(bid128_t *r, const bid128_t *a, const bid128_t *b,
+                         bool negate_b, decContext *set)
+{
+    bid_unpacked_t ua, ub;
+    const bid_unpacked_t *big, *small;
+    bool diffsign;
+    uint32_t sign;
+    int32_t exp;
+    int d, len;
+    u256_t v;
+
+    bid_unpack(a, &ua);
+    bid_unpack(b, &ub);
+
+    /* NaNs propagate without sign change */
+    if (negate_b && !is_nan_class(&ub))
+    {
+        ub.sign ^= 1;
+    }
+
+    if (ua.cls != bid_finite || ub.cls != bid_finite)
+    {
+        if (is_nan_class(&ua) || is_nan_class(&ub))
+            return bid_nans(r, &ua, &ub, set);
+        if (ua.cls == bid_inf && ub.cls == bid_inf && ua.sign != ub.sign)
+            return bid_invalid(r, set);
+        if (ua.cls == bid_inf)
+            return bid_pack_special(r, ua.sign, BID_INF, 0);
+        return bid_pack_special(r, ub.sign, BID_INF, 0);
+    }
+
+    diffsign = ua.sign != ub.sign;
+
+    /* aligned and same sign with no carry out, the common case */
+    if (ua.exp == ub.exp && !diffsign)
+    {
+        u128 s = ua.coeff + ub.coeff;
+        if (s < POW10_PMAX)
+        {
+            return bid_pack(r, ua.sign, ua.exp, s);
+        }
+    }
+
+    /* big is the one with the larger exponent, or lhs if the same */
+    if (ua.exp >= ub.exp)
+    {
+        big = &ua;
+        small = &ub;
+    }
+    else
+    {
+        big = &ub;
+        small = &ua;
+    }
+
+    /* if big is zero then result is small, with the IEEE 754 rule for
+     * the sign of an exact zero sum */
+    if (big->coeff == 0)
+    {
+        sign = small->sign;
+        if (diffsign && small->coeff == 0)
+        {
+            sign = set->round == DEC_ROUND_FLOOR;
+        }
+        return bid_pack(r, sign, small->exp, small->coeff);
+    }
+
+    d = big->exp - small->exp;
+    len = digits_u128(big->coeff);
+    u256_from_u128(&v, big->coeff);
+    sign = big->sign;
+
+    if (len + d <= 72)
+    {
+        /* exact, v fits in 256 bits */
+        u256_scale_pow10(&v, d);
+        exp = small->exp;
+        if (!diffsign)
+        {
+            u256_add_u128(&v, small->coeff);
+        }
+        else if (u256_fits_u128(&v) && u256_low(&v) < small->coeff)
+        {
+            u256_from_u128(&v, small->coeff - u256_low(&v));
+            sign = small->sign;
+        }
+        else
+        {
+            u256_sub_u128(&v, small->coeff);
+            if (u256_fits_u128(&v) && u256_low(&v) == 0)
+            {
+                sign = set->round == DEC_ROUND_FLOOR;
+            }
+        }
+    }
+    else
+    {
+        /* The smaller operand is entirely below the rounding digit, so
+         * it only matters as a sticky digit. Shift big up far enough
+         * that there are more than 34 digits to drop, and put a 1 at
+         * the bottom in its place. */
+        int k = 72 - len;
+        u256_scale_pow10(&v, k);
+        exp = big->exp - k;
+        if (small->coeff != 0)
+        {
+            if (diffsign)
+                u256_sub_u128(&v, 1);
+            else
+                u256_add_u128(&v, 1);
+        }
+    }
+
+    return bid_finalise(r, sign, exp, &v, set);
+}
+
+bid128_t *bid128_add(bid128_t *r, const bid128_t *a, const bid128_t *b,
+                     decContext *set)
+{
+    return bid_add(r, a, b, false, set);
+}
+
+bid128_t *bid128_subtract(bid128_t *r, const bid128_t *a, const bid128_t *b,
+                          decContext *set)
+{
+    return bid_add(r, a, b, true, set);
+}
+
+bid128_t *bid128_multiply(bid128_t *r, const bid128_t *a, const bid128_t *b,
+                          decContext *set)
+{
+    bid_unpacked_t ua, ub;
+    uint32_t sign;
+    int32_t exp;
+    u256_t v;
+
+    bid_unpack(a, &ua);
+    bid_unpack(b, &ub);
+    sign = ua.sign ^ ub.sign;
+
+    if (ua.cls != bid_finite || ub.cls != bid_finite)
+    {
+        if (is_nan_class(&ua) || is_nan_class(&ub))
+            return bid_nans(r, &ua, &ub, set);
+        /* infinity times zero is bad */
+        if ((ua.cls == bid_inf && ub.cls == bid_finite && ub.coeff == 0)
+            || (ub.cls == bid_inf && ua.cls == bid_finite && ua.coeff == 0))
+            return bid_invalid(r, set);
+        return bid_pack_special(r, sign, BID_INF, 0);
+    }
+
+    exp = ua.exp + ub.exp;
+
+    /* both coefficients up to 64 bits and the product fits */
+    if ((ua.coeff >> 64) == 0 && (ub.coeff >> 64) == 0)
+    {
+        u128 p = (u128)(uint64_t)ua.coeff * (uint64_t)ub.coeff;
+        if (p < POW10_PMAX && exp >= BID_ETINY && exp <= BID_ETOP)
+        {
+            return bid_pack(r, sign, exp, p);
+        }
+        u256_from_u128(&v, p);
+    }
+    else
+    {
+        u256_mul_u128(&v, ua.coeff, ub.coeff);
+    }
+
+    return bid_finalise(r, sign, exp, &v, set);
+}
+
+/* decQuad does these */
+bid128_t *bid128_divide(bid128_t *r, const bid128_t *a, const bid128_t *b,
+                        decContext *set)
+{
+    decQuad dq_a, dq_b, dq_r;
+
+    bid128_to_decquad(a, &dq_a);
+    bid128_to_decquad(b, &dq_b);
+    decQuadDivide(&dq_r, &dq_a, &dq_b, set);
+    bid128_from_decquad(r, &dq_r);
+    return r;
+}
+
+bid128_t *bid128_remainder(bid128_t *r, const bid128_t *a, const bid128_t *b,
+                           decContext *set)
+{
+    decQuad dq_a, dq_b, dq_r;
+
+    bid128_to_decquad(a, &dq_a);
+    bid128_to_decquad(b, &dq_b);
+    decQuadRemainder(&dq_r, &dq_a, &dq_b, set);
+    bid128_from_decquad(r, &dq_r);
+    return r;
+}
+
+bid128_t *bid128_minus(bid128_t *r, const bid128_t *a, decContext *set)
+{
+    bid_unpacked_t u;
+
+    bid_unpack(a, &u);
+    if (is_nan_class(&u))
+        return bid_nans(r, &u, NULL, set);
+    if (u.cls == bid_inf)
+        return bid_pack_special(r, !u.sign, BID_INF, 0);
+    /* zero gets sign 0 */
+    return bid_pack(r, u.coeff != 0 && !u.sign, u.exp, u.coeff);
+}
+
+bid128_t *bid128_abs(bid128_t *r, const bid128_t *a, decContext *set)
+{
+    bid_unpacked_t u;
+
+    bid_unpack(a, &u);
+    if (is_nan_class(&u))
+        return bid_nans(r, &u, NULL, set);
+    if (u.cls == bid_inf)
+        return bid_pack_special(r, 0, BID_INF, 0);
+    return bid_pack(r, 0, u.exp, u.coeff);
+}
+
+bid128_t *bid128_zero(bid128_t *r)
+{
+    return bid_pack(r, 0, 0, 0);
+}
+
+
+/***************************************************************************
+ * conversions, via decQuad
+ */
+
+char *bid128_to_string(const bid128_t *a, char *s)
+{
+    decQuad dq;
+
+    bid128_to_decquad(a, &dq);
+    return decQuadToString(&dq, s);
+}
+
+bid128_t *bid128_from_string(bid128_t *r, const char *s, decContext *set)
+{
+    decQuad dq;
+
+    decQuadFromString(&dq, s, set);
+    bid128_from_decquad(r, &dq);
+    return r;
+}
+
+decNumber *bid128_to_number(const bid128_t *a, decNumber *n)
+{
+    decQuad dq;
+
+    bid128_to_decquad(a, &dq);
+    return decQuadToNumber(&dq, n);
+}
+
+bid128_t *bid128_from_number(bid128_t *r, const decNumber *n, decContext *set)
+{
+    decQuad dq;
+
+    decQuadFromNumber(&dq, n, set);
+    bid128_from_decquad(r, &dq);
+    return r;
+}
+
+int32_t bid128_to_int32(const bid128_t *a, decContext *set,
+                        enum rounding round)
+{
+    decQuad dq;
+
+    bid128_to_decquad(a, &dq);
+    return decQuadToInt32(&dq, set, round);
+}
+
+bid128_t *bid128_from_int32(bid128_t *r, int32_t i)
+{
+    if (i < 0)
+        return bid_pack(r, 1, 0, (u128)(-(int64_t)i));
+    return bid_pack(r, 0, 0, (u128)i);
+}
+
+bid128_t *bid128_from_int64(bid128_t *r, int64_t i)
+{
+    if (i < 0)
+        return bid_pack(r, 1, 0, (u128)(-(uint64_t)i));
+    return bid_pack(r, 0, 0, (u128)i);
+}
+
+bid128_t *bid128_from_uint64(bid128_t *r, uint64_t u)
+{
+    return bid_pack(r, 0, 0, (u128)u);
+}
+
+
+/***************************************************************************
+ * compare and tests
+ */
+
+/* compare magnitudes of finite or infinite a and b, both non-zero */
+static int bid_compare_mag(const bid_unpacked_t *a, const bid_unpacked_t *b)
+{
+    int32_t adj_a, adj_b;
+    u128 ca = a->coeff, cb = b->coeff;
+
+    if (a->cls == bid_inf || b->cls == bid_inf)
+    {
+        return (a->cls == bid_inf) - (b->cls == bid_inf);
+    }
+
+    adj_a = a->exp + digits_u128(ca) - 1;
+    adj_b = b->exp + digits_u128(cb) - 1;
+    if (adj_a != adj_b)
+    {
+        return adj_a > adj_b ? 1 : -1;
+    }
+
+    /* same adjusted exponent, so aligning fits in 34 digits */
+    if (a->exp > b->exp)
+        ca *= pow10_tab[a->exp - b->exp];
+    else if (b->exp > a->exp)
+        cb *= pow10_tab[b->exp - a->exp];
+    return (ca > cb) - (ca < cb);
+}
+
+bid128_t *bid128_compare(bid128_t *r, const bid128_t *a, const bid128_t *b,
+                         decContext *set)
+{
+    bid_unpacked_t ua, ub;
+    int sig_a, sig_b, comp;
+
+    bid_unpack(a, &ua);
+    bid_unpack(b, &ub);
+    if (is_nan_class(&ua) || is_nan_class(&ub))
+        return bid_nans(r, &ua, &ub, set);
+
+    /* signum of each */
+    sig_a = (ua.cls == bid_finite && ua.coeff == 0) ? 0 : ua.sign ? -1 : 1;
+    sig_b = (ub.cls == bid_finite && ub.coeff == 0) ? 0 : ub.sign ? -1 : 1;
+
+    if (sig_a != sig_b || sig_a == 0)
+        comp = (sig_a > sig_b) - (sig_a < sig_b);
+    else
+        comp = sig_a * bid_compare_mag(&ua, &ub);
+
+    return bid_pack(r, comp < 0, 0, comp != 0);
+}
+
+uint32_t bid128_is_negative(const bid128_t *a)
+{
+    bid_unpacked_t u;
+
+    bid_unpack(a, &u);
+    return u.sign && !is_nan_class(&u) && !(u.cls == bid_finite && u.coeff == 0);
+}
+
+uint32_t bid128_is_integer(const bid128_t *a)
+{
+    bid_unpacked_t u;
+
+    bid_unpack(a, &u);
+    return u.cls == bid_finite && u.exp == 0;
+}
+
+uint32_t bid128_is_zero(const bid128_t *a)
+{
+    bid_unpacked_t u;
+
+    bid_unpack(a, &u);
+    return u.cls == bid_finite && u.coeff == 0;
+}
+
+uint32_t bid128_is_infinite(const bid128_t *a)
+{
+    return (a->w[1] & BID_QNAN) == BID_INF;
+}
+
+uint32_t bid128_is_nan(const bid128_t *a)
+{
+    return (a->w[1] & BID_QNAN) == BID_QNAN;
+}
+
+int32_t bid128_get_coefficient(const bid128_t *a, uint8_t *bcd)
+{
+    decQuad dq;
+
+    bid128_to_decquad(a, &dq);
+    return decQuadGetCoefficient(&dq, bcd);
+}
+
+int32_t bid128_get_exponent(const bid128_t *a)
+{
+    decQuad dq;
+
+    bid128_to_decquad(a, &dq);
+    return decQuadGetExponent(&dq);
+}
+
+#endif /* __SIZEOF_INT128__ */
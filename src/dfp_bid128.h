@@ -0,0 +1,92 @@
+/*****************************************************************************
+ * File dfp_bid128.h part of ProgAndSciCalc
+ *
+ * Copyright (C) 2018 Ken Bromham
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef DFP_BID128_H
+#define DFP_BID128_H
+
+#include <stdint.h>
+#include "decNumber/decQuad.h"
+#include "decNumber/decimal128.h" // interface to decNumber
+
+/* Alternative to decQuad for floating point mode, selected at compile
+ * time with DFP_USE_BID128 (see calc_types.h).
+ *
+ * Same decimal128 format (34 digits, same exponent range), but using the
+ * binary integer decimal (BID) encoding where the coefficient is held
+ * as a plain binary integer, rather than densely packed decimal. That
+ * means add, subtract, multiply and compare can be done directly with
+ * 64/128 bit integer arithmetic. Results and rounding are the same as
+ * the decQuad functions for the same context.
+ *
+ * The less used operations (divide, remainder, string and decNumber
+ * conversion) go via decQuad. */
+
+#if defined(DFP_USE_BID128) && !defined(__SIZEOF_INT128__)
+#error "DFP_USE_BID128 needs a compiler with unsigned __int128"
+#endif
+
+/* w[0] is the least significant 64 bits, w[1] has sign, combination
+ * field and the top of the coefficient */
+typedef struct
+{
+    uint64_t w[2];
+} bid128_t;
+
+void bid128_from_decquad(bid128_t *r, const decQuad *dq);
+void bid128_to_decquad(const bid128_t *a, decQuad *dq);
+
+bid128_t *bid128_add(bid128_t *r, const bid128_t *a, const bid128_t *b,
+                     decContext *set);
+bid128_t *bid128_subtract(bid128_t *r, const bid128_t *a, const bid128_t *b,
+                          decContext *set);
+bid128_t *bid128_multiply(bid128_t *r, const bid128_t *a, const bid128_t *b,
+                          decContext *set);
+bid128_t *bid128_divide(bid128_t *r, const bid128_t *a, const bid128_t *b,
+                        decContext *set);
+bid128_t *bid128_remainder(bid128_t *r, const bid128_t *a, const bid128_t *b,
+                           decContext *set);
+bid128_t *bid128_minus(bid128_t *r, const bid128_t *a, decContext *set);
+bid128_t *bid128_abs(bid128_t *r, const bid128_t *a, decContext *set);
+bid128_t *bid128_zero(bid128_t *r);
+
+char *bid128_to_string(const bid128_t *a, char *s);
+bid128_t *bid128_from_string(bid128_t *r, const char *s, decContext *set);
+
+decNumber *bid128_to_number(const bid128_t *a, decNumber *n);
+bid128_t *bid128_from_number(bid128_t *r, const decNumber *n, decContext *set);
+
+bid128_t *bid128_compare(bid128_t *r, const bid128_t *a, const bid128_t *b,
+                         decContext *set);
+uint32_t bid128_is_negative(const bid128_t *a);
+uint32_t bid128_is_integer(const bid128_t *a);
+uint32_t bid128_is_zero(const bid128_t *a);
+uint32_t bid128_is_infinite(const bid128_t *a);
+uint32_t bid128_is_nan(const bid128_t *a);
+
+int32_t bid128_get_coefficient(const bid128_t *a, uint8_t *bcd);
+int32_t bid128_get_exponent(const bid128_t *a);
+
+int32_t bid128_to_int32(const bid128_t *a, decContext *set,
+                        enum rounding round);
+bid128_t *bid128_from_int32(bid128_t *r, int32_t i);
+bid128_t *bid128_from_int64(bid128_t *r, int64_t i);
+bid128_t *bid128_from_uint64(bid128_t *r, uint64_t u);
+
+#endif
@@ -0,0 +1,1120 @@
+/*****************************************************************************
+ * File dfp_bulk.c part of ProgAndSciCalc
+ *
+ * Copyright (C) 2018 Ken Bromham
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <string.h>
+#include <stdlib.h>
+
+#include "dfp_bulk.h"
+
+/* decCommon.c converts one decQuad per call, and each declet goes through
+ * a table lookup. The same tables are used here, but in loops over whole
+ * arrays with the declets taken straight out of two 64 bit halves, the
+ * three BCD digits written with one 4 byte store, and the table index for
+ * encoding made with a single multiply. Runs of four declets that are all
+ * zero, the top of the coefficient for most values, skip the tables.
+ *
+ * Decoding the declets with vector operations (the boolean form of the
+ * DPD mapping) was tried, but on SSE4.1/AVX2 that needs several times
+ * more instructions per declet than a lookup in these tables, which stay
+ * in the L1 cache, so it was slower. */
+
+/* from decNumber (decDPD.h) */
+extern const uint8_t DPD2BCD8[4096];   /* DPD -> ddd + len */
+extern const uint16_t BCD2DPD[2458];   /* 0-0x999 -> DPD */
+extern const uint16_t DPD2BIN[1024];   /* DPD -> 0-999 */
+extern const uint16_t BIN2DPD[1000];   /* 0-999 -> DPD */
+
+#define QUAD_BIAS       6176
+#define QUAD_EMIN       (-6143)
+#define QUAD_ETOP       6111    /* largest exponent with no clamping */
+
+/* as decNumberLocal.h, the decQuad words are in memory order, so on a
+ * little endian machine the word with the sign is the last one */
+#ifndef DECLITEND
+#define DECLITEND 1
+#endif
+#if DECLITEND
+#define QUAD_WORD(dq, k) ((dq)->words[3 - (k)])
+#else
+#define QUAD_WORD(dq, k) ((dq)->words[k])
+#endif
+
+
+/* declet to three digits at bcd, 4 bytes written (the 4th is the length
+ * from the table, and is overwritten by the next declet) */
+#define PUT_DECLET(bcd, dpd) memcpy(bcd, &DPD2BCD8[((dpd) & 0x3ff) * 4], 4)
+
+/* three digits at bcd to a declet. The digits are loaded as one little
+ * endian word, b0 | b1 << 8 | b2 << 16, and the multiply by
+ * 1 + 2^12 + 2^24 moves them to b0 << 24 | b1 << 20 | b2 << 16 with no
+ * overlap from the other products, giving the 0x000 - 0x999 index. */
+static inline uint64_t get_declet(const uint8_t *bcd)
+{
+    uint32_t x;
+    memcpy(&x, bcd, 4);
+#if !DECLITEND
+    x = x >> 24 | (x >> 8 & 0xff00) | (x << 8 & 0xff0000);
+#endif
+    return BCD2DPD[((x & 0xffffff) * 0x1001001u) >> 16 & 0xfff];
+}
+
+/* twelve digits at bcd all 0 */
+static inline bool digits_zero(const uint8_t *bcd)
+{
+    uint64_t a;
+    uint32_t b;
+    memcpy(&a, bcd, 8);
+    memcpy(&b, bcd + 8, 4);
+    return (a | b) == 0;
+}
+
+/* exponent and BCD8 coefficient of one decQuad, returns the sign, as
+ * decQuadToBCD */
+static inline int32_t quad_to_bcd(const decQuad *dq, int32_t *exp,
+                                  uint8_t *bcd)
+{
+    uint32_t top = QUAD_WORD(dq, 0);
+    uint32_t comb = top >> 26 & 0x1f;
+    uint64_t hi = (uint64_t)top << 32 | QUAD_WORD(dq, 1);
+    uint64_t lo = (uint64_t)QUAD_WORD(dq, 2) << 32 | QUAD_WORD(dq, 3);
+
+    /* most significant declet first, the last one must not write past the
+     * 34 digits */
+    if ((hi & 0x3ffffffffc0) == 0)
+    {
+        memset(&bcd[1], 0, 12);
+    }
+    else
+    {
+        PUT_DECLET(&bcd[1], hi >> 36);
+        PUT_DECLET(&bcd[4], hi >> 26);
+        PUT_DECLET(&bcd[7], hi >> 16);
+        PUT_DECLET(&bcd[10], hi >> 6);
+    }
+    if (((hi & 0x3f) | lo >> 30) == 0)
+    {
+        memset(&bcd[13], 0, 12);
+    }
+    else
+    {
+        PUT_DECLET(&bcd[13], hi << 4 | lo >> 60);
+        PUT_DECLET(&bcd[16], lo >> 50);
+        PUT_DECLET(&bcd[19], lo >> 40);
+        PUT_DECLET(&bcd[22], lo >> 30);
+    }
+    PUT_DECLET(&bcd[25], lo >> 20);
+    PUT_DECLET(&bcd[28], lo >> 10);
+    memcpy(&bcd[31], &DPD2BCD8[(lo & 0x3ff) * 4], 3);
+
+    if ((comb & 0x1e) == 0x1e)
+    {
+        /* NaN keeps its payload, infinity is all zero */
+        *exp = (int32_t)(top & 0x7e000000);
+        bcd[0] = 0;
+        if (comb == 0x1e)
+            memset(bcd, 0, DECQUAD_Pmax);
+    }
+    else
+    {
+        uint32_t exp_top;
+        if ((comb & 0x18) == 0x18)
+        {
+            exp_top = comb >> 1 & 3;
+            bcd[0] = (uint8_t)(8 + (comb & 1));
+        }
+        else
+        {
+            exp_top = comb >> 3;
+            bcd[0] = (uint8_t)(comb & 7);
+        }
+        *exp = (int32_t)((exp_top << 12 | (top >> 14 & 0xfff)) - QUAD_BIAS);
+    }
+    return (int32_t)(top & DECFLOAT_Sign);
+}
+
+void dfp_bulk_to_bcd(const decQuad *src, size_t n,
+                     int32_t *exp, uint8_t *bcd, int32_t *sign)
+{
+    for (size_t i = 0; i < n; i++, bcd += DECQUAD_Pmax)
+        sign[i] = quad_to_bcd(&src[i], &exp[i], bcd);
+}
+
+/* one decQuad from exponent, BCD8 coefficient and sign, as decQuadFromBCD */
+static inline void quad_from_bcd(decQuad *dq, int32_t exp,
+                                 const uint8_t *bcd, int32_t sign)
+{
+    uint32_t top;
+    uint64_t hi, lo, mid;
+
+    if (exp >= DECFLOAT_MinSp)
+    {
+        /* specials already encoded */
+        top = (uint32_t)exp | (uint32_t)sign;
+    }
+    else
+    {
+        uint32_t uexp = (uint32_t)(exp + QUAD_BIAS);
+        uint32_t exp_top = uexp >> 12;
+        uint32_t comb;
+
+        if (bcd[0] < 8)
+            comb = exp_top << 3 | bcd[0];
+        else
+            comb = 0x18 | exp_top << 1 | (bcd[0] & 1);
+        top = (uint32_t)sign | comb << 26 | (uexp & 0xfff) << 14;
+    }
+
+    hi = (uint64_t)top << 32;
+    if (!digits_zero(&bcd[1]))
+    {
+        hi |= get_declet(&bcd[1]) << 36 | get_declet(&bcd[4]) << 26
+              | get_declet(&bcd[7]) << 16 | get_declet(&bcd[10]) << 6;
+    }
+    lo = 0;
+    if (!digits_zero(&bcd[13]))
+    {
+        /* the declet that straddles the two halves */
+        mid = get_declet(&bcd[13]);
+        hi |= mid >> 4;
+        lo = mid << 60
+             | get_declet(&bcd[16]) << 50 | get_declet(&bcd[19]) << 40
+             | get_declet(&bcd[22]) << 30;
+    }
+    lo |= get_declet(&bcd[25]) << 20
+         | get_declet(&bcd[28]) << 10
+         | BCD2DPD[bcd[31] << 8 | bcd[32] << 4 | bcd[33]];
+
+    QUAD_WORD(dq, 0) = (uint32_t)(hi >> 32);
+    QUAD_WORD(dq, 1) = (uint32_t)hi;
+    QUAD_WORD(dq, 2) = (uint32_t)(lo >> 32);
+    QUAD_WORD(dq, 3) = (uint32_t)lo;
+}
+
+void dfp_bulk_from_bcd(decQuad *dst, size_t n,
+                       const int32_t *exp, const uint8_t *bcd,
+                       const int32_t *sign)
+{
+    for (size_t i = 0; i < n; i++, bcd += DECQUAD_Pmax)
+        quad_from_bcd(&dst[i], exp[i], bcd, sign[i]);
+}
+
+
+/* dfp_array_t: coefficient limbs are base 10^18, the low one is exactly
+ * the bottom 6 declets and the high one the other 5 declets plus the msd */
+
+#define LIMB        1000000000000000000ULL      /* 10^18 */
+#define HI_LIMIT    10000000000000000ULL        /* 10^16 */
+
+#if defined(__SIZEOF_INT128__)
+#define HAVE_U128 1
+typedef unsigned __int128 u128;
+#else
+#define HAVE_U128 0
+#endif
+
+static const uint64_t pow10_tab[19] =
+{
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL,
+    10000000ULL, 100000000ULL, 1000000000ULL, 10000000000ULL,
+    100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+    100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+    100000000000000000ULL, 1000000000000000000ULL
+};
+
+bool dfp_array_alloc(dfp_array_t *a, size_t n)
+{
+    a->exp = malloc(n * sizeof(int32_t));
+    a->sign = malloc(n * sizeof(int32_t));
+    a->coeff_hi = malloc(n * sizeof(uint64_t));
+    a->coeff_lo = malloc(n * sizeof(uint64_t));
+    if (a->exp && a->sign && a->coeff_hi && a->coeff_lo)
+        return true;
+    dfp_array_free(a);
+    return false;
+}
+
+void dfp_array_free(dfp_array_t *a)
+{
+    free(a->exp);
+    free(a->sign);
+    free(a->coeff_hi);
+    free(a->coeff_lo);
+    a->exp = NULL;
+    a->sign = NULL;
+    a->coeff_hi = NULL;
+    a->coeff_lo = NULL;
+}
+
+static void elem_from_quad(dfp_array_t *r, size_t i, const decQuad *q)
+{
+    uint32_t top = QUAD_WORD(q, 0);
+    uint32_t comb = top >> 26 & 0x1f;
+    uint64_t hi = (uint64_t)top << 32 | QUAD_WORD(q, 1);
+    uint64_t lo = (uint64_t)QUAD_WORD(q, 2) << 32 | QUAD_WORD(q, 3);
+    uint64_t msd;
+
+    r->sign[i] = (int32_t)(top & DECFLOAT_Sign);
+    if ((comb & 0x1e) == 0x1e)
+    {
+        if (comb == 0x1e)
+        {
+            /* infinity, with none of the junk that may be in the rest of
+             * the exponent continuation */
+            r->exp[i] = DECFLOAT_Inf;
+            r->coeff_hi[i] = 0;
+            r->coeff_lo[i] = 0;
+            return;
+        }
+        r->exp[i] = (int32_t)(top & 0x7e000000);
+        msd = 0;
+    }
+    else
+    {
+        uint32_t exp_top;
+        if ((comb & 0x18) == 0x18)
+        {
+            exp_top = comb >> 1 & 3;
+            msd = 8 + (comb & 1);
+        }
+        else
+        {
+            exp_top = comb >> 3;
+            msd = comb & 7;
+        }
+        r->exp[i] = (int32_t)((exp_top << 12 | (top >> 14 & 0xfff))
+                              - QUAD_BIAS);
+    }
+
+    r->coeff_hi[i] = msd * 1000000000000000ULL
+                     + DPD2BIN[hi >> 36 & 0x3ff] * 1000000000000ULL
+                     + DPD2BIN[hi >> 26 & 0x3ff] * 1000000000ULL
+                     + DPD2BIN[hi >> 16 & 0x3ff] * 1000000ULL
+                     + DPD2BIN[hi >> 6 & 0x3ff] * 1000ULL
+                     + DPD2BIN[(hi << 4 | lo >> 60) & 0x3ff];
+    r->coeff_lo[i] = DPD2BIN[lo >> 50 & 0x3ff] * 1000000000000000ULL
+                     + DPD2BIN[lo >> 40 & 0x3ff] * 1000000000000ULL
+                     + DPD2BIN[lo >> 30 & 0x3ff] * 1000000000ULL
+                     + DPD2BIN[lo >> 20 & 0x3ff] * 1000000ULL
+                     + DPD2BIN[lo >> 10 & 0x3ff] * 1000ULL
+                     + DPD2BIN[lo & 0x3ff];
+}
+
+static void quad_from_parts(decQuad *q, int32_t exp, int32_t sign,
+                            uint64_t chi, uint64_t clo)
+{
+    uint64_t msd = chi / 1000000000000000ULL;
+    uint64_t d[11];
+    uint32_t top;
+    uint64_t hi, lo;
+
+    chi -= msd * 1000000000000000ULL;
+    for (int k = 0; k < 6; k++)
+    {
+        d[k] = BIN2DPD[clo % 1000];
+        clo /= 1000;
+    }
+    for (int k = 6; k < 11; k++)
+    {
+        d[k] = BIN2DPD[chi % 1000];
+        chi /= 1000;
+    }
+
+    if (exp >= DECFLOAT_MinSp)
+    {
+        top = (uint32_t)exp | (uint32_t)sign;
+    }
+    else
+    {
+        uint32_t uexp = (uint32_t)(exp + QUAD_BIAS);
+        uint32_t exp_top = uexp >> 12;
+        uint32_t comb;
+
+        if (msd < 8)
+            comb = exp_top << 3 | (uint32_t)msd;
+        else
+            comb = 0x18 | exp_top << 1 | (uint32_t)(msd & 1);
+        top = (uint32_t)sign | comb << 26 | (uexp & 0xfff) << 14;
+    }
+
+    hi = (uint64_t)top << 32 | d[10] << 36 | d[9] << 26 | d[8] << 16
+         | d[7] << 6 | d[6] >> 4;
+    lo = d[6] << 60 | d[5] << 50 | d[4] << 40 | d[3] << 30 | d[2] << 20
+         | d[1] << 10 | d[0];
+
+    QUAD_WORD(q, 0) = (uint32_t)(hi >> 32);
+    QUAD_WORD(q, 1) = (uint32_t)hi;
+    QUAD_WORD(q, 2) = (uint32_t)(lo >> 32);
+    QUAD_WORD(q, 3) = (uint32_t)lo;
+}
+
+static void quad_from_elem(decQuad *q, const dfp_array_t *a, size_t i)
+{
+    quad_from_parts(q, a->exp[i], a->sign[i], a->coeff_hi[i], a->coeff_lo[i]);
+}
+
+void dfp_array_from_quads(dfp_array_t *r, const decQuad *src, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+        elem_from_quad(r, i, &src[i]);
+}
+
+void dfp_array_to_quads(decQuad *dst, const dfp_array_t *a, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+        quad_from_elem(&dst[i], a, i);
+}
+
+
+/* Fast paths. These only handle cases where the exact result fits in 34
+ * digits with an exponent that needs no clamping and is not subnormal,
+ * so no rounding is needed and decQuad would set no status. Each returns
+ * false, having changed nothing, when the element must go the slow way.
+ * Coefficients are (hi, lo) limb pairs. */
+
+/* a * b (both < 10^18) as limbs, false if 10^34 or more */
+static bool mul_limbs(uint64_t a, uint64_t b, uint64_t *hi, uint64_t *lo)
+{
+#if HAVE_U128
+    u128 p = (u128)a * b;
+    uint64_t q, rem;
+
+    if (p < LIMB)
+    {
+        *hi = 0;
+        *lo = (uint64_t)p;
+        return true;
+    }
+    if (p >= (u128)HI_LIMIT * LIMB)
+        return false;
+
+    /* quotient estimate as decSplitColumn in decBasic.c, the
+     * multiplier is 2^122 / 10^18. Can be low by up to 2. */
+    q = (uint64_t)(((u128)(uint64_t)(p >> 58) * 5316911983139663491ULL)
+                   >> 64);
+    rem = (uint64_t)p - q * LIMB;
+    while (rem >= LIMB)
+    {
+        rem -= LIMB;
+        q++;
+    }
+    *hi = q;
+    *lo = rem;
+    return true;
+#else
+    uint64_t p;
+
+    if (a != 0 && b > UINT64_MAX / a)
+        return false;
+    p = a * b;
+    *hi = p / LIMB;
+    *lo = p % LIMB;
+    return true;
+#endif
+}
+
+/* coefficient times 10^d, false if 10^34 or more */
+static bool scale_limbs(uint64_t *hi, uint64_t *lo, int d)
+{
+    uint64_t carry, new_lo;
+
+    if (*hi == 0 && *lo == 0)
+        return true;
+    if (d >= 34)
+        return false;
+    if (d >= 18)
+    {
+        if (*hi != 0 || *lo >= pow10_tab[34 - d])
+            return false;
+        *hi = *lo * pow10_tab[d - 18];
+        *lo = 0;
+        return true;
+    }
+    if (d >= 16 ? *hi != 0 : *hi >= pow10_tab[16 - d])
+        return false;
+    if (!mul_limbs(*lo, pow10_tab[d], &carry, &new_lo))
+        return false;
+    carry += *hi * pow10_tab[d];
+    if (carry >= HI_LIMIT)
+        return false;
+    *hi = carry;
+    *lo = new_lo;
+    return true;
+}
+
+static int cmp_limbs(uint64_t ahi, uint64_t alo, uint64_t bhi, uint64_t blo)
+{
+    if (ahi != bhi)
+        return ahi < bhi ? -1 : 1;
+    if (alo != blo)
+        return alo < blo ? -1 : 1;
+    return 0;
+}
+
+static bool add_fast(dfp_array_t *r, size_t ir,
+                     const dfp_array_t *a, size_t ia, int32_t asign,
+                     const dfp_array_t *b, size_t ib, int32_t bsign,
+                     enum rounding round)
+{
+    int32_t aexp = a->exp[ia], bexp = b->exp[ib];
+    uint64_t ahi = a->coeff_hi[ia], alo = a->coeff_lo[ia];
+    uint64_t bhi = b->coeff_hi[ib], blo = b->coeff_lo[ib];
+    int32_t exp, sign;
+    uint64_t hi, lo;
+
+    if (aexp >= DECFLOAT_MinSp || bexp >= DECFLOAT_MinSp)
+        return false;
+
+    /* align to the smaller exponent, which is the result exponent */
+    if (aexp > bexp)
+    {
+        if (!scale_limbs(&ahi, &alo, aexp - bexp))
+            return false;
+        exp = bexp;
+    }
+    else
+    {
+        if (!scale_limbs(&bhi, &blo, bexp - aexp))
+            return false;
+        exp = aexp;
+    }
+    if (exp < QUAD_EMIN)
+        return false;
+
+    if (asign == bsign)
+    {
+        lo = alo + blo;
+        hi = ahi + bhi;
+        if (lo >= LIMB)
+        {
+            lo -= LIMB;
+            hi++;
+        }
+        if (hi >= HI_LIMIT)
+            return false;
+        sign = asign;
+    }
+    else
+    {
+        int c = cmp_limbs(ahi, alo, bhi, blo);
+        if (c < 0)
+        {
+            uint64_t t = ahi;
+            ahi = bhi;
+            bhi = t;
+            t = alo;
+            alo = blo;
+            blo = t;
+            sign = bsign;
+        }
+        else if (c > 0)
+            sign = asign;
+        else
+        {
+            /* exact zero, only negative when rounding to floor */
+            sign = round == DEC_ROUND_FLOOR ? DECFLOAT_Sign : 0;
+        }
+        hi = ahi - bhi;
+        if (alo >= blo)
+            lo = alo - blo;
+        else
+        {
+            lo = alo + LIMB - blo;
+            hi--;
+        }
+    }
+
+    r->exp[ir] = exp;
+    r->sign[ir] = sign;
+    r->coeff_hi[ir] = hi;
+    r->coeff_lo[ir] = lo;
+    return true;
+}
+
+static bool mul_fast(dfp_array_t *r, size_t ir,
+                     const dfp_array_t *a, size_t ia,
+                     const dfp_array_t *b, size_t ib)
+{
+    int32_t aexp = a->exp[ia], bexp = b->exp[ib];
+    int32_t exp;
+    uint64_t hi, lo;
+
+    if (aexp >= DECFLOAT_MinSp || bexp >= DECFLOAT_MinSp)
+        return false;
+    exp = aexp + bexp;
+    if (exp < QUAD_EMIN || exp > QUAD_ETOP)
+        return false;
+    if (a->coeff_hi[ia] != 0 || b->coeff_hi[ib] != 0)
+        return false;
+    if (!mul_limbs(a->coeff_lo[ia], b->coeff_lo[ib], &hi, &lo))
+        return false;
+
+    r->exp[ir] = exp;
+    r->sign[ir] = a->sign[ia] ^ b->sign[ib];
+    r->coeff_hi[ir] = hi;
+    r->coeff_lo[ir] = lo;
+    return true;
+}
+
+static bool compare_fast(dfp_array_t *r, size_t ir,
+                         const dfp_array_t *a, size_t ia,
+                         const dfp_array_t *b, size_t ib)
+{
+    int32_t aexp = a->exp[ia], bexp = b->exp[ib];
+    uint64_t ahi = a->coeff_hi[ia], alo = a->coeff_lo[ia];
+    uint64_t bhi = b->coeff_hi[ib], blo = b->coeff_lo[ib];
+    bool azero = (ahi | alo) == 0, bzero = (bhi | blo) == 0;
+    int c;
+
+    if (aexp >= DECFLOAT_MinSp || bexp >= DECFLOAT_MinSp)
+        return false;
+
+    if (azero && bzero)
+        c = 0;
+    else if (azero)
+        c = b->sign[ib] ? 1 : -1;
+    else if (bzero)
+        c = a->sign[ia] ? -1 : 1;
+    else if (a->sign[ia] != b->sign[ib])
+        c = a->sign[ia] ? -1 : 1;
+    else
+    {
+        /* same sign, compare magnitudes at the same exponent */
+        if (aexp > bexp && !scale_limbs(&ahi, &alo, aexp - bexp))
+            return false;
+        if (bexp > aexp && !scale_limbs(&bhi, &blo, bexp - aexp))
+            return false;
+        c = cmp_limbs(ahi, alo, bhi, blo);
+        if (a->sign[ia])
+            c = -c;
+    }
+
+    r->exp[ir] = 0;
+    r->sign[ir] = c < 0 ? DECFLOAT_Sign : 0;
+    r->coeff_hi[ir] = 0;
+    r->coeff_lo[ir] = c != 0;
+    return true;
+}
+
+void dfp_add_n(dfp_array_t *r, const dfp_array_t *a, const dfp_array_t *b,
+               size_t n, decContext *set)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        decQuad qa, qb, qr;
+
+        if (add_fast(r, i, a, i, a->sign[i], b, i, b->sign[i], set->round))
+            continue;
+        quad_from_elem(&qa, a, i);
+        quad_from_elem(&qb, b, i);
+        decQuadAdd(&qr, &qa, &qb, set);
+        elem_from_quad(r, i, &qr);
+    }
+}
+
+void dfp_sub_n(dfp_array_t *r, const dfp_array_t *a, const dfp_array_t *b,
+               size_t n, decContext *set)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        decQuad qa, qb, qr;
+
+        if (add_fast(r, i, a, i, a->sign[i],
+                     b, i, b->sign[i] ^ DECFLOAT_Sign, set->round))
+            continue;
+        quad_from_elem(&qa, a, i);
+        quad_from_elem(&qb, b, i);
+        decQuadSubtract(&qr, &qa, &qb, set);
+        elem_from_quad(r, i, &qr);
+    }
+}
+
+void dfp_mul_n(dfp_array_t *r, const dfp_array_t *a, const dfp_array_t *b,
+               size_t n, decContext *set)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        decQuad qa, qb, qr;
+
+        if (mul_fast(r, i, a, i, b, i))
+            continue;
+        quad_from_elem(&qa, a, i);
+        quad_from_elem(&qb, b, i);
+        decQuadMultiply(&qr, &qa, &qb, set);
+        elem_from_quad(r, i, &qr);
+    }
+}
+
+/* exact quotients are too rare to be worth a fast path */
+void dfp_div_n(dfp_array_t *r, const dfp_array_t *a, const dfp_array_t *b,
+               size_t n, decContext *set)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        decQuad qa, qb, qr;
+
+        quad_from_elem(&qa, a, i);
+        quad_from_elem(&qb, b, i);
+        decQuadDivide(&qr, &qa, &qb, set);
+        elem_from_quad(r, i, &qr);
+    }
+}
+
+void dfp_fma_n(dfp_array_t *r, const dfp_array_t *a, const dfp_array_t *b,
+               const dfp_array_t *c, size_t n, decContext *set)
+{
+    /* one element of workspace for the product */
+    int32_t p_exp, p_sign;
+    uint64_t p_hi, p_lo;
+    dfp_array_t p = { &p_exp, &p_sign, &p_hi, &p_lo };
+
+    for (size_t i = 0; i < n; i++)
+    {
+        decQuad qa, qb, qc, qr;
+
+        /* if the product and the sum are both exact, the single
+         * rounding of the fma makes no difference */
+        if (mul_fast(&p, 0, a, i, b, i)
+            && add_fast(r, i, &p, 0, p_sign, c, i, c->sign[i], set->round))
+            continue;
+        quad_from_elem(&qa, a, i);
+        quad_from_elem(&qb, b, i);
+        quad_from_elem(&qc, c, i);
+        decQuadFMA(&qr, &qa, &qb, &qc, set);
+        elem_from_quad(r, i, &qr);
+    }
+}
+
+void dfp_compare_n(dfp_array_t *r, const dfp_array_t *a,
+                   const dfp_array_t *b, size_t n, decContext *set)
+{
+    for (size_t i = 0; i < n; i++)
+    {
+        decQuad qa, qb, qr;
+
+        if (compare_fast(r, i, a, i, b, i))
+            continue;
+        quad_from_elem(&qa, a, i);
+        quad_from_elem(&qb, b, i);
+        decQuadCompare(&qr, &qa, &qb, set);
+        elem_from_quad(r, i, &qr);
+    }
+}
+
+
+/* text. The digit runs are checked and converted 8 at a time as one 64
+ * bit word (SWAR), and written back the same way. */
+
+#define ONES_8      0x0101010101010101ULL
+
+/* all 8 chars (loaded little endian) are '0' - '9' */
+static inline bool is_eight_digits(uint64_t x)
+{
+    return ((x & 0xf0f0f0f0f0f0f0f0ULL)
+            | (((x + 0x0606060606060606ULL) & 0xf0f0f0f0f0f0f0f0ULL) >> 4))
+           == 0x3333333333333333ULL;
+}
+
+static inline uint64_t load8(const char *p)
+{
+    uint64_t x;
+    memcpy(&x, p, 8);
+#if !DECLITEND
+    x = __builtin_bswap64(x);
+#endif
+    return x;
+}
+
+/* length of the run of digits at p, up to end */
+static size_t digit_run(const char *p, const char *end)
+{
+    const char *start = p;
+
+    while (end - p >= 8 && is_eight_digits(load8(p)))
+        p += 8;
+    while (p < end && *p >= '0' && *p <= '9')
+        p++;
+    return (size_t)(p - start);
+}
+
+/* number of '0' chars at the start of p, up to n */
+static size_t leading_zeros(const char *p, size_t n)
+{
+    size_t i = 0;
+
+    while (n - i >= 8 && load8(&p[i]) == 0x30 * ONES_8)
+        i += 8;
+    while (i < n && p[i] == '0')
+        i++;
+    return i;
+}
+
+/* n digit chars at src to BCD at dst */
+static inline void copy_digits(uint8_t *dst, const char *src, size_t n)
+{
+    size_t i;
+
+    /* a word at a time, no borrows so byte order does not matter */
+    for (i = 0; i + 8 <= n; i += 8)
+    {
+        uint64_t w;
+        memcpy(&w, &src[i], 8);
+        w -= 0x30 * ONES_8;
+        memcpy(&dst[i], &w, 8);
+    }
+    for (; i < n; i++)
+        dst[i] = (uint8_t)(src[i] - '0');
+}
+
+/* The plain forms [sign] digits [. digits] [E [sign] digits] with at most
+ * 34 significant digits, and an exponent that needs no clamping and is
+ * not subnormal. These are exact so decQuadFromString would set no
+ * status. Returns the end of the number, or NULL if it is not one of
+ * these. */
+static const char *parse_fast(decQuad *dq, const char *p, const char *end)
+{
+    uint8_t bcd[DECQUAD_Pmax];
+    int32_t sign = 0;
+    int32_t exp = 0;
+    const char *int_start, *frac_start;
+    size_t n_int, n_frac = 0, z_int, z_frac = 0, ndigs;
+
+    if (p < end && (*p == '-' || *p == '+'))
+    {
+        if (*p == '-')
+            sign = DECFLOAT_Sign;
+        p++;
+    }
+
+    int_start = p;
+    n_int = digit_run(p, end);
+    p += n_int;
+    frac_start = p;
+    if (p < end && *p == '.')
+    {
+        frac_start = ++p;
+        n_frac = digit_run(p, end);
+        p += n_frac;
+    }
+    if (n_int + n_frac == 0)
+        return NULL;
+
+    if (p < end && (*p == 'e' || *p == 'E'))
+    {
+        bool neg = false;
+        size_t n_exp;
+
+        p++;
+        if (p < end && (*p == '-' || *p == '+'))
+        {
+            neg = *p == '-';
+            p++;
+        }
+        n_exp = digit_run(p, end);
+        if (n_exp == 0 || n_exp > 9)
+            return NULL;
+        for (size_t i = 0; i < n_exp; i++)
+            exp = exp * 10 + (p[i] - '0');
+        if (neg)
+            exp = -exp;
+        p += n_exp;
+    }
+
+    z_int = leading_zeros(int_start, n_int);
+    if (z_int == n_int)
+        z_frac = leading_zeros(frac_start, n_frac);
+    ndigs = n_int - z_int + n_frac - z_frac;
+    if (ndigs > DECQUAD_Pmax)
+        return NULL;
+
+    exp -= (int32_t)n_frac;
+    if (exp > QUAD_ETOP || exp < -QUAD_BIAS)
+        return NULL;
+    if (ndigs > 0 && exp + (int32_t)ndigs - 1 < QUAD_EMIN)
+        return NULL;
+
+    /* coefficient right aligned */
+    memset(bcd, 0, sizeof(bcd));
+    copy_digits(&bcd[DECQUAD_Pmax - ndigs], &int_start[z_int],
+                n_int - z_int);
+    copy_digits(&bcd[DECQUAD_Pmax - n_frac + z_frac], &frac_start[z_frac],
+                n_frac - z_frac);
+
+    if (ndigs <= 15)
+    {
+        /* most numbers in text are short, so just the low five declets;
+         * the most significant digit is 0 */
+        uint32_t uexp = (uint32_t)(exp + QUAD_BIAS);
+        uint64_t lo = get_declet(&bcd[19]) << 40 | get_declet(&bcd[22]) << 30
+                      | get_declet(&bcd[25]) << 20
+                      | get_declet(&bcd[28]) << 10
+                      | BCD2DPD[bcd[31] << 8 | bcd[32] << 4 | bcd[33]];
+
+        QUAD_WORD(dq, 0) = (uint32_t)sign | (uexp >> 12) << 29
+                           | (uexp & 0xfff) << 14;
+        QUAD_WORD(dq, 1) = 0;
+        QUAD_WORD(dq, 2) = (uint32_t)(lo >> 32);
+        QUAD_WORD(dq, 3) = (uint32_t)lo;
+    }
+    else
+        quad_from_bcd(dq, exp, bcd, sign);
+    return p;
+}
+
+static bool is_blank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+size_t dfp_bulk_parse(decQuad *dst, size_t max, const char *buf, size_t len,
+                      size_t *used, decContext *set)
+{
+    const char *p = buf, *end = buf + len;
+    size_t count = 0;
+
+    while (count < max && p < end)
+    {
+        const char *start = p, *stop;
+        char token[DFP_BULK_TOKEN_MAX + 1];
+        size_t n;
+
+        while (start < end && is_blank(*start))
+            start++;
+
+        /* the usual case, a plain number then the separator */
+        stop = parse_fast(&dst[count], start, end);
+        if (stop != NULL)
+        {
+            while (stop < end && is_blank(*stop))
+                stop++;
+            if (stop == end || *stop == ',' || *stop == '\n')
+            {
+                p = stop < end ? stop + 1 : end;
+                count++;
+                continue;
+            }
+        }
+
+        while (p < end && *p != ',' && *p != '\n')
+            p++;
+        stop = p;
+        if (p < end)
+            p++;        /* the separator */
+
+        while (stop > start && is_blank(stop[-1]))
+            stop--;
+        /* nothing after the last separator */
+        if (start == stop && p == end && stop == end)
+            break;
+
+        n = (size_t)(stop - start);
+        if (n > DFP_BULK_TOKEN_MAX || n == 0)
+        {
+            /* let decQuad report the syntax error */
+            n = 0;
+        }
+        memcpy(token, start, n);
+        token[n] = '\0';
+        decQuadFromString(&dst[count], token, set);
+        count++;
+    }
+    *used = (size_t)(p - buf);
+    return count;
+}
+
+/* value as decQuadToString, s has room for DECQUAD_String + 8 so that
+ * whole words can be written past the end. Returns the length. */
+static size_t format_one(char *s, int32_t exp, const uint8_t *bcd,
+                         int32_t sign)
+{
+    char *p = s;
+    int first = 0;
+    int ndigits;
+
+    if (sign)
+        *p++ = '-';
+
+    /* as from decQuadToBCD, so there may be junk in the low bits */
+    if (exp >= DECFLOAT_MinSp && exp < DECFLOAT_qNaN)
+    {
+        memcpy(p, "Infinity", 8);
+        return (size_t)(p + 8 - s);
+    }
+
+    /* skip leading zeros, a word at a time first */
+    while (first < DECQUAD_Pmax - 8 && load8((const char *)&bcd[first]) == 0)
+        first += 8;
+    while (first < DECQUAD_Pmax - 1 && bcd[first] == 0)
+        first++;
+    ndigits = DECQUAD_Pmax - first;
+
+    if (exp >= DECFLOAT_MinSp)
+    {
+        /* NaN, the payload if there is one */
+        if (exp >= DECFLOAT_sNaN)
+            *p++ = 's';
+        memcpy(p, "NaN", 3);
+        p += 3;
+        if (ndigits == 1 && bcd[first] == 0)
+            return (size_t)(p - s);
+    }
+
+    if (exp >= DECFLOAT_MinSp || exp == 0)
+    {
+        /* just the digits */
+        for (int i = 0; i < ndigits; i += 8)
+        {
+            uint64_t w;
+            memcpy(&w, &bcd[first + i], 8);
+            w += 0x30 * ONES_8;
+            memcpy(p + i, &w, 8);
+        }
+        return (size_t)(p + ndigits - s);
+    }
+    else
+    {
+        int32_t adjusted = exp + ndigits - 1;
+        char digs[DECQUAD_Pmax + 8];
+
+        for (int i = 0; i < ndigits; i += 8)
+        {
+            uint64_t w;
+            memcpy(&w, &bcd[first + i], 8);
+            w += 0x30 * ONES_8;
+            memcpy(&digs[i], &w, 8);
+        }
+
+        if (exp < 0 && adjusted >= -6)
+        {
+            int pre = ndigits + exp;   /* digits before the point */
+            if (pre > 0)
+            {
+                memcpy(p, digs, (size_t)pre);
+                p += pre;
+                *p++ = '.';
+                memcpy(p, &digs[pre], (size_t)(ndigits - pre));
+                p += ndigits - pre;
+            }
+            else
+            {
+                *p++ = '0';
+                *p++ = '.';
+                memset(p, '0', (size_t)-pre);
+                p += -pre;
+                memcpy(p, digs, (size_t)ndigits);
+                p += ndigits;
+            }
+        }
+        else
+        {
+            uint32_t e = (uint32_t)(adjusted < 0 ? -adjusted : adjusted);
+            char ebuf[8];
+            int elen = 0;
+
+            *p++ = digs[0];
+            if (ndigits > 1)
+            {
+                *p++ = '.';
+                memcpy(p, &digs[1], (size_t)(ndigits - 1));
+                p += ndigits - 1;
+            }
+            *p++ = 'E';
+            *p++ = adjusted < 0 ? '-' : '+';
+            do
+            {
+                ebuf[elen++] = (char)('0' + e % 10);
+                e /= 10;
+            } while (e > 0);
+            while (elen > 0)
+                *p++ = ebuf[--elen];
+        }
+        return (size_t)(p - s);
+    }
+}
+
+/* as format_one, straight from the decQuad */
+static size_t format_quad(char *s, const decQuad *dq)
+{
+    /* +8 so format_one can read whole words past the last digit */
+    uint8_t bcd[DECQUAD_Pmax + 8];
+    uint32_t top = QUAD_WORD(dq, 0);
+    int32_t exp, sign;
+
+    memset(&bcd[DECQUAD_Pmax], 0, 8);
+    if ((top & 0x1c003fff) == 0 && QUAD_WORD(dq, 1) == 0
+        && QUAD_WORD(dq, 2) >> 18 == 0 && (top & 0x60000000) != 0x60000000)
+    {
+        /* finite with no more than 15 digits, the usual case, so only the
+         * low five declets */
+        uint64_t lo = (uint64_t)QUAD_WORD(dq, 2) << 32 | QUAD_WORD(dq, 3);
+
+        memset(bcd, 0, 19);
+        PUT_DECLET(&bcd[19], lo >> 40);
+        PUT_DECLET(&bcd[22], lo >> 30);
+        PUT_DECLET(&bcd[25], lo >> 20);
+        PUT_DECLET(&bcd[28], lo >> 10);
+        memcpy(&bcd[31], &DPD2BCD8[(lo & 0x3ff) * 4], 3);
+        exp = (int32_t)((top >> 29 & 3) << 12 | (top >> 14 & 0xfff))
+              - QUAD_BIAS;
+        sign = (int32_t)(top & DECFLOAT_Sign);
+    }
+    else
+        sign = quad_to_bcd(dq, &exp, bcd);
+    return format_one(s, exp, bcd, sign);
+}
+
+size_t dfp_bulk_format(char *buf, size_t size, const decQuad *src, size_t n,
+                       char sep, size_t *done)
+{
+    size_t len = 0;
+    size_t count = 0;
+
+    if (size == 0)
+    {
+        *done = 0;
+        return 0;
+    }
+
+    for (; count < n; count++)
+    {
+        char s[DECQUAD_String + 8];
+        size_t slen;
+
+        if (size - len > DECQUAD_String + 9)
+        {
+            /* plenty of room, straight into buf */
+            if (count > 0)
+                buf[len++] = sep;
+            len += format_quad(&buf[len], &src[count]);
+            continue;
+        }
+
+        /* room for the terminator too */
+        slen = format_quad(s, &src[count]);
+        if (len + slen + (count > 0) >= size)
+            break;
+        if (count > 0)
+            buf[len++] = sep;
+        memcpy(&buf[len], s, slen);
+        len += slen;
+    }
+    buf[len] = '\0';
+    *done = count;
+    return len;
+}
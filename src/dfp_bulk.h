@@ -0,0 +1,109 @@
+/*****************************************************************************
+ * File dfp_bulk.h part of ProgAndSciCalc
+ *
+ * Copyright (C) 2018 Ken Bromham
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef DFP_BULK_H
+#define DFP_BULK_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "decNumber/decQuad.h"
+
+/* Conversion of whole arrays of decQuads to and from BCD.
+ *
+ * Same results as calling decQuadToBCD / decQuadFromBCD for each element,
+ * but without the call and setup per element, for loading or saving many
+ * values at once.
+ *
+ * The arrays are kept separate (structure of arrays): for element i the
+ * exponent is exp[i], the sign sign[i] (DECFLOAT_Sign or 0) and the
+ * coefficient is the DECQUAD_Pmax bytes starting at bcd[i * DECQUAD_Pmax].
+ * Exponent and coefficient of specials are as for decQuadToBCD. */
+
+void dfp_bulk_to_bcd(const decQuad *src, size_t n,
+                     int32_t *exp, uint8_t *bcd, int32_t *sign);
+void dfp_bulk_from_bcd(decQuad *dst, size_t n,
+                       const int32_t *exp, const uint8_t *bcd,
+                       const int32_t *sign);
+
+/* Arrays of decimal128 values kept as separate exponent, sign and
+ * coefficient arrays, for elementwise arithmetic over many values.
+ *
+ * Element i is the coefficient coeff_hi[i] * 10^18 + coeff_lo[i] (with
+ * coeff_lo[i] < 10^18 and coeff_hi[i] < 10^16), times 10^exp[i]. exp and
+ * sign are as for dfp_bulk_to_bcd, so a special value has exp[i] of
+ * DECFLOAT_Inf, DECFLOAT_qNaN or DECFLOAT_sNaN, and a NaN payload is in
+ * the coefficient. */
+typedef struct
+{
+    int32_t *exp;
+    int32_t *sign;
+    uint64_t *coeff_hi;
+    uint64_t *coeff_lo;
+} dfp_array_t;
+
+bool dfp_array_alloc(dfp_array_t *a, size_t n);
+void dfp_array_free(dfp_array_t *a);
+
+void dfp_array_from_quads(dfp_array_t *r, const decQuad *src, size_t n);
+void dfp_array_to_quads(decQuad *dst, const dfp_array_t *a, size_t n);
+
+/* r[i] = a[i] op b[i] for i < n, with the same results and status as the
+ * decQuad function for each element. r may be the same array as a or b.
+ * Exact finite results are done directly on the coefficients, anything
+ * that needs rounding or involves specials goes through decQuad. */
+void dfp_add_n(dfp_array_t *r, const dfp_array_t *a, const dfp_array_t *b,
+               size_t n, decContext *set);
+void dfp_sub_n(dfp_array_t *r, const dfp_array_t *a, const dfp_array_t *b,
+               size_t n, decContext *set);
+void dfp_mul_n(dfp_array_t *r, const dfp_array_t *a, const dfp_array_t *b,
+               size_t n, decContext *set);
+void dfp_div_n(dfp_array_t *r, const dfp_array_t *a, const dfp_array_t *b,
+               size_t n, decContext *set);
+/* r[i] = a[i] * b[i] + c[i], with a single rounding as decQuadFMA */
+void dfp_fma_n(dfp_array_t *r, const dfp_array_t *a, const dfp_array_t *b,
+               const dfp_array_t *c, size_t n, decContext *set);
+/* r[i] = -1, 0 or 1 (or NaN), as decQuadCompare */
+void dfp_compare_n(dfp_array_t *r, const dfp_array_t *a,
+                   const dfp_array_t *b, size_t n, decContext *set);
+
+/* Text conversion of many values, with no allocation.
+ *
+ * dfp_bulk_parse reads numbers separated by commas or newlines from buf
+ * (len chars, no terminator needed) into dst, at most max of them. Spaces,
+ * tabs and carriage returns around a number are ignored, and a separator
+ * at the very end does not start another number. Each number gives the
+ * same value and status as decQuadFromString; an empty field, or one of
+ * more than DFP_BULK_TOKEN_MAX chars, is a syntax error (NaN). Returns the
+ * number of values stored, and *used is set to the number of chars read,
+ * which is where to carry on from if dst filled up.
+ *
+ * dfp_bulk_format writes n values to buf as decQuadToString would, each
+ * but the last followed by sep, and adds a terminator. It stops early if
+ * the next value will not fit in size. Returns the length of the text,
+ * and *done is set to the number of values written. */
+#define DFP_BULK_TOKEN_MAX  255
+
+size_t dfp_bulk_parse(decQuad *dst, size_t max, const char *buf, size_t len,
+                      size_t *used, decContext *set);
+size_t dfp_bulk_format(char *buf, size_t size, const decQuad *src, size_t n,
+                       char sep, size_t *done);
+
+#endif
@@ -0,0 +1,280 @@
+/*****************************************************************************
+ * File dfp_int.c part of ProgAndSciCalc
+ *
+ * Copyright (C) 2018 Ken Bromham
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <string.h>
+#include <stdbool.h>
+
+#include "dfp_int.h"
+
+
+/* Magnitude of a rounded to an integer, and its sign. Returns
+ * dfp_int_too_big (for either sign) if it doesn't fit in 128 bits. */
+static dfp_int_status_enum get_magnitude(const stackf_t *a,
+                                         enum rounding round,
+                                         calc_int_t *mag, bool *neg)
+{
+    uint8_t bcd[DECQUAD_Pmax];
+    int32_t exp = dfp_get_exponent(a);
+    /* digits before the point are bcd[0] to bcd[end - 1] */
+    int end = DECQUAD_Pmax + exp;
+    calc_int_t m = 0;
+    int dropped = 0;        /* first digit after the point */
+    bool sticky = false;    /* any non zero digits after that */
+    bool up;
+
+    *neg = dfp_get_coefficient(a, bcd) != 0;
+    *mag = 0;
+    if (dfp_is_nan(a))
+    {
+        return dfp_int_nan;
+    }
+    if (dfp_is_infinite(a))
+    {
+        return dfp_int_too_big;
+    }
+
+    for (int i = 0; i < end && i < DECQUAD_Pmax; i++)
+    {
+        if (m > (CALC_INT_MAX - bcd[i]) / 10)
+        {
+            return dfp_int_too_big;
+        }
+        m = m * 10 + bcd[i];
+    }
+    for (int i = DECQUAD_Pmax; i < end && m != 0; i++)
+    {
+        /* positive exponent, trailing zeros */
+        if (m > CALC_INT_MAX / 10)
+        {
+            return dfp_int_too_big;
+        }
+        m *= 10;
+    }
+
+    if (end >= DECQUAD_Pmax)
+    {
+        *mag = m;
+        return dfp_int_exact;
+    }
+    for (int i = end < 0 ? 0 : end + 1; i < DECQUAD_Pmax && !sticky; i++)
+    {
+        sticky = bcd[i] != 0;
+    }
+    if (end >= 0)
+    {
+        dropped = bcd[end];
+    }
+    if (dropped == 0 && !sticky)
+    {
+        *mag = m;
+        return dfp_int_exact;
+    }
+
+    switch (round)
+    {
+    case DEC_ROUND_CEILING:
+        up = !*neg;
+        break;
+    case DEC_ROUND_UP:
+        up = true;
+        break;
+    case DEC_ROUND_HALF_UP:
+        up = dropped >= 5;
+        break;
+    case DEC_ROUND_HALF_EVEN:
+        up = dropped > 5 || (dropped == 5 && (sticky || (m & 1)));
+        break;
+    case DEC_ROUND_HALF_DOWN:
+        up = dropped > 5 || (dropped == 5 && sticky);
+        break;
+    case DEC_ROUND_FLOOR:
+        up = *neg;
+        break;
+    case DEC_ROUND_05UP:
+        up = m % 10 == 0 || m % 10 == 5;
+        break;
+    default:
+        /* DEC_ROUND_DOWN */
+        up = false;
+        break;
+    }
+    if (up)
+    {
+        if (m == CALC_INT_MAX)
+        {
+            return dfp_int_too_big;
+        }
+        m++;
+    }
+    *mag = m;
+    return dfp_int_rounded;
+}
+
+
+dfp_int_status_enum dfp_to_int64(const stackf_t *a, enum rounding round,
+                                 int64_t *result)
+{
+    calc_int_t mag;
+    bool neg;
+    dfp_int_status_enum status = get_magnitude(a, round, &mag, &neg);
+
+    if (status == dfp_int_too_big
+        || (neg && mag > (calc_int_t)INT64_MAX + 1)
+        || (!neg && mag > INT64_MAX))
+    {
+        *result = neg ? INT64_MIN : INT64_MAX;
+        return neg ? dfp_int_too_small : dfp_int_too_big;
+    }
+    /* -(int64_t)mag would overflow for INT64_MIN */
+    *result = neg && mag != 0 ? -(int64_t)(mag - 1) - 1 : (int64_t)mag;
+    return status;
+}
+
+
+dfp_int_status_enum dfp_to_uint64(const stackf_t *a, enum rounding round,
+                                  uint64_t *result)
+{
+    calc_int_t mag;
+    bool neg;
+    dfp_int_status_enum status = get_magnitude(a, round, &mag, &neg);
+
+    if (status == dfp_int_too_big || (neg && mag != 0) || mag > UINT64_MAX)
+    {
+        *result = neg ? 0 : UINT64_MAX;
+        return neg ? dfp_int_too_small : dfp_int_too_big;
+    }
+    *result = (uint64_t)mag;
+    return status;
+}
+
+
+dfp_int_status_enum dfp_to_int128(const stackf_t *a, enum rounding round,
+                                  calc_sint_t *result)
+{
+    calc_int_t mag;
+    bool neg;
+    dfp_int_status_enum status = get_magnitude(a, round, &mag, &neg);
+
+    if (status == dfp_int_too_big
+        || (neg && mag > (calc_int_t)CALC_SINT_MAX + 1)
+        || (!neg && mag > (calc_int_t)CALC_SINT_MAX))
+    {
+        *result = neg ? CALC_SINT_MIN : CALC_SINT_MAX;
+        return neg ? dfp_int_too_small : dfp_int_too_big;
+    }
+    *result = neg ? (calc_sint_t)-mag : (calc_sint_t)mag;
+    return status;
+}
+
+
+dfp_int_status_enum dfp_to_uint128(const stackf_t *a, enum rounding round,
+                                   calc_int_t *result)
+{
+    calc_int_t mag;
+    bool neg;
+    dfp_int_status_enum status = get_magnitude(a, round, &mag, &neg);
+
+    if (status == dfp_int_too_big || (neg && mag != 0))
+    {
+        *result = neg ? 0 : CALC_INT_MAX;
+        return neg ? dfp_int_too_small : dfp_int_too_big;
+    }
+    *result = mag;
+    return status;
+}
+
+
+#ifndef DFP_USE_BID128
+static stackf_t *quad_from_magnitude(stackf_t *r, uint64_t u, bool neg)
+{
+    uint8_t bcd[DECQUAD_Pmax];
+    int i = DECQUAD_Pmax;
+
+    /* at most 20 digits */
+    memset(bcd, 0, DECQUAD_Pmax - 20);
+    do
+    {
+        bcd[--i] = (uint8_t)(u % 10);
+        u /= 10;
+    } while (i > DECQUAD_Pmax - 20);
+    return decQuadFromBCD(r, 0, bcd, neg ? DECFLOAT_Sign : 0);
+}
+#endif
+
+
+stackf_t *dfp_from_int64(stackf_t *r, int64_t i)
+{
+#ifdef DFP_USE_BID128
+    return bid128_from_int64(r, i);
+#else
+    return quad_from_magnitude(r, i < 0 ? -(uint64_t)i : (uint64_t)i, i < 0);
+#endif
+}
+
+
+stackf_t *dfp_from_uint64(stackf_t *r, uint64_t u)
+{
+#ifdef DFP_USE_BID128
+    return bid128_from_uint64(r, u);
+#else
+    return quad_from_magnitude(r, u, false);
+#endif
+}
+
+
+stackf_t *dfp_from_uint128(stackf_t *r, calc_int_t u)
+{
+    const uint64_t e19 = 10000000000000000000ULL;
+    calc_int_t hi = u / e19;
+    stackf_t part, scale;
+
+    if (u <= UINT64_MAX)
+    {
+        return dfp_from_uint64(r, (uint64_t)u);
+    }
+
+    /* u is hi * 10^19 + lo, with hi up to 20 digits (so in two parts
+     * itself) and lo 19. Each part converts exactly, as does scaling by
+     * 10^19 (just the exponent) and adding the parts of hi, so the only
+     * rounding is in the final add, to the precision of the type. */
+    dfp_from_string(&scale, "1E+19", &dfp_context);
+    dfp_from_uint64(r, (uint64_t)(hi / e19));
+    dfp_multiply(r, r, &scale, &dfp_context);
+    dfp_from_uint64(&part, (uint64_t)(hi % e19));
+    dfp_add(r, r, &part, &dfp_context);
+    dfp_multiply(r, r, &scale, &dfp_context);
+    dfp_from_uint64(&part, (uint64_t)(u % e19));
+    return dfp_add(r, r, &part, &dfp_context);
+}
+
+
+stackf_t *dfp_from_int128(stackf_t *r, calc_sint_t i)
+{
+    if (i >= INT64_MIN && i <= INT64_MAX)
+    {
+        return dfp_from_int64(r, (int64_t)i);
+    }
+    dfp_from_uint128(r, i < 0 ? -(calc_int_t)i : (calc_int_t)i);
+    if (i < 0)
+    {
+        dfp_minus(r, r, &dfp_context);
+    }
+    return r;
+}
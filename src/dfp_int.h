@@ -0,0 +1,60 @@
+/*****************************************************************************
+ * File dfp_bulk.h part of ProgAndSciCalc
+ *
+ * Copyright (C) 2018 Ken Bromham
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef DFP_INT_H
+#define DFP_INT_H
+
+#include <stdint.h>
+#include "calc_types.h"
+
+/* Exact conversions between the floating point type and 64 and 128 bit
+ * integers, worked out from the coefficient digits and exponent (no text). */
+
+typedef enum
+{
+    dfp_int_exact,      /* already an integer in range */
+    dfp_int_rounded,    /* in range after rounding */
+    dfp_int_too_big,    /* result is the largest value */
+    dfp_int_too_small,  /* result is the smallest value */
+    dfp_int_nan         /* result is 0 */
+} dfp_int_status_enum;
+
+/* Round a to an integer with the rounding mode round (DEC_ROUND_DOWN to
+ * truncate) and return it in result. Infinities and values out of range
+ * give the largest or smallest value of the type. */
+dfp_int_status_enum dfp_to_int64(const stackf_t *a, enum rounding round,
+                                 int64_t *result);
+dfp_int_status_enum dfp_to_uint64(const stackf_t *a, enum rounding round,
+                                  uint64_t *result);
+dfp_int_status_enum dfp_to_int128(const stackf_t *a, enum rounding round,
+                                  calc_sint_t *result);
+dfp_int_status_enum dfp_to_uint128(const stackf_t *a, enum rounding round,
+                                   calc_int_t *result);
+
+/* always exact, with exponent 0 */
+stackf_t *dfp_from_int64(stackf_t *r, int64_t i);
+stackf_t *dfp_from_uint64(stackf_t *r, uint64_t u);
+
+/* exact up to the precision of the type (34 digits), larger values are
+ * rounded using dfp_context */
+stackf_t *dfp_from_int128(stackf_t *r, calc_sint_t i);
+stackf_t *dfp_from_uint128(stackf_t *r, calc_int_t u);
+
+#endif
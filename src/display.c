@@ -23,11 +23,12 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <stdint.h>
-#include <inttypes.h>
 
 #include "display.h"
 #include "display_widget.h"
 #include "display_print.h"
+#include "radix_print.h"
+#include "dfp_int.h"
 #include "calc.h"
 
 
@@ -35,18 +36,20 @@
 static disp_mode_enum disp_mode;
 static disp_int_format_enum int_format;
 static disp_float_format_enum float_format;
+static disp_float_format_enum float_format_normal = disp_float_gmode;
 static int disp_float_num_digits = 10;
+static int disp_float_fixed_places = DISP_FIXED_PLACES_DEFAULT;
 
 static void (*warn_callback)(const char *msg);
 static void (*error_callback)(const char *msg);
 
 
-#define DISP_MAX_DIGIT_HEX 16
-/* allow for groups of 4, so 3 spaces in between 4 groups of 4 */
-#define DISP_MAX_DIGIT_HEX_SPACED (DISP_MAX_DIGIT_HEX + 3)
+#define DISP_MAX_DIGIT_HEX 32
+/* allow for groups of 4, so 7 spaces in between 8 groups of 4 */
+#define DISP_MAX_DIGIT_HEX_SPACED (DISP_MAX_DIGIT_HEX + 7)
 /* Make big enough for any decQuad, although in practice the number of digits
- * displayed is restricted. This is also plenty big enough for 64 bit integer
- * (19 digits signed, 20 digits unsigned). */
+ * displayed is restricted. This is also big enough for 128 bit integer
+ * (39 digits and a sign). */
 #define DISP_STACK_SIZE (DFP_STRING_MAX)
 #define DISP_MAX_LEN (DISP_STACK_SIZE - 1)
 
@@ -64,8 +67,13 @@ static bool disp_exp_entry;
  * +1 for null termination */
 static char disp_hex_spaced[DISP_MAX_DIGIT_HEX_SPACED + 1];
 
+/* In float mode, the value last shown with display_set_val, for
+ * display_get_best_integer. Not valid once the user enters a value. */
+static stackf_t disp_fval;
+static bool disp_fval_valid;
+
 /* Store ival since it is calculated on the fly for the bin display */
-static uint64_t disp_ival;
+static calc_int_t disp_ival;
 
 /* 0, 4, or 8 */
 static int hex_grouping;
@@ -186,95 +194,188 @@ static void update_display_hex(int grouping)
 }
 
 
-static bool is_equivalent_of_int_min(calc_width_enum width)
+/* In integer mode the value is accumulated as the digits are entered
+ * (val = val * base + digit) rather than parsing disp_stack each time, the
+ * text is just for showing. disp_acc is the magnitude, the sign is a '-' at
+ * the front of disp_stack. */
+static calc_int_t disp_acc;
+/* what disp_acc was accumulated for, if any of these change it is
+ * recalculated from disp_stack */
+static calc_width_t acc_width;
+static disp_int_format_enum acc_format;
+static bool acc_unsigned;
+/* false when disp_stack has been changed other than by a digit at a time */
+static bool acc_valid;
+
+typedef enum
+{
+    acc_ok,
+    acc_overflow,
+    acc_int_min     /* +ve equivalent of int_min in signed dec */
+} acc_result_enum;
+
+/* The largest magnitude allowed for acc_width, for unsigned (also used
+ * for hex), signed +ve and signed -ve, and for dec and hex, given as
+ * max / base and max % base. A digit can be added if the magnitude so far
+ * is less than cutoff, or equal to it and the digit is no more than
+ * cutlim. Worked out when acc_width changes. */
+typedef struct
+{
+    calc_int_t cutoff;
+    unsigned int cutlim;
+} acc_limit_t;
+
+enum { acc_kind_unsigned, acc_kind_signed_pos, acc_kind_signed_neg };
+
+static acc_limit_t acc_limits[3][2];
+static calc_width_t acc_limits_width;
+
+static void acc_set_limit(int kind, calc_int_t max)
+{
+    acc_limits[kind][0].cutoff = max / 10;
+    acc_limits[kind][0].cutlim = (unsigned int)(max % 10);
+    acc_limits[kind][1].cutoff = max / 16;
+    acc_limits[kind][1].cutlim = (unsigned int)(max % 16);
+}
+
+static void acc_set_limits(calc_width_t width)
 {
-    /* check disp_stack to see if it holds the specific value */
+    calc_int_t umax = calc_util_width_mask(width);
 
-    switch (width)
+    if (width == acc_limits_width)
     {
-    case calc_width_8:
-        return strcmp(disp_stack, "128") == 0;
-    case calc_width_16:
-        return strcmp(disp_stack, "32768") == 0;
-    case calc_width_32:
-        return strcmp(disp_stack, "2147483648") == 0;
-    default:
-        return strcmp(disp_stack, "9223372036854775808") == 0;
+        return;
     }
+    acc_set_limit(acc_kind_unsigned, umax);
+    acc_set_limit(acc_kind_signed_pos, umax >> 1);
+    acc_set_limit(acc_kind_signed_neg, (umax >> 1) + 1);
+    acc_limits_width = width;
 }
 
 
-#define MAX_DEC_POP_COUNT 1
+static int acc_get_base(void)
+{
+    return acc_format == disp_int_hex ? 16 : 10;
+}
 
-/* See description for display_add in the header file for explanation of
- * the return value. */
-static bool update_display()
+/* Add one digit (value 0 to base - 1) to disp_acc if the result is in
+ * range. Hex shows the bit pattern, so is always treated as unsigned. */
+static acc_result_enum acc_add_digit(unsigned int digit)
 {
-    bool ret = false;
+    bool neg = disp_stack[0] == '-';
+    int b = acc_format == disp_int_hex;
+    int kind;
+    const acc_limit_t *lim;
 
-    if (disp_mode == disp_mode_int)
-    {
-        calc_width_enum width = calc_get_integer_width();
+    if (acc_format == disp_int_hex || acc_unsigned)
+        kind = acc_kind_unsigned;
+    else
+        kind = neg ? acc_kind_signed_neg : acc_kind_signed_pos;
 
-        /* Since, for the purpose of the bin display, the ival needs to be
-         * calculated each time it changes, may as well convert and store
-         * the result. We can also use this to limit the user input range
-         * in dec mode. */
-        if (int_format == disp_int_dec)
+    lim = &acc_limits[kind][b];
+    if (disp_acc > lim->cutoff || (disp_acc == lim->cutoff && digit > lim->cutlim))
+    {
+        if (kind == acc_kind_signed_pos)
         {
-            if (calc_get_use_unsigned())
-            {
-                int count = 0;
-                while (!calc_util_unsigned_str_to_ival(disp_stack, width, &disp_ival, 10))
-                {
-                    /* Fails if user entered out of range number.
-                     * Remove a digit and try again, should only ever go round
-                     * this loop once. */
-                    disp_stack_pop();
-                    if (++count > MAX_DEC_POP_COUNT)
-                    {
-                        /* should never happen */
-                        disp_error("Bad conversion dec to integer");
-                    }
-                }
-            }
-            else
+            lim = &acc_limits[acc_kind_signed_neg][b];
+            if (disp_acc == lim->cutoff && digit == lim->cutlim)
             {
-                int count = 0;
-                while (!calc_util_signed_str_to_ival(disp_stack, width, &disp_ival, 10))
-                {
-                    /* Fails if user has entered out of range number. Check for
-                     * the special case of the +ve equivalent of int_min. */
-                    if (is_equivalent_of_int_min(width))
-                    {
-                        ret = true;
-                    }
-                    /* Remove a digit and try again, should only ever go round
-                     * this loop once (if above int_min test is true, the value
-                     * gets sorted out after this func returns). */
-                    disp_stack_pop();
-                    if (++count > MAX_DEC_POP_COUNT)
-                    {
-                        /* should never happen */
-                        disp_error("Bad conversion dec to integer");
-                    }
-                }
+                return acc_int_min;
             }
         }
-        else
+        return acc_overflow;
+    }
+    disp_acc = disp_acc * acc_get_base() + digit;
+    return acc_ok;
+}
+
+/* value of an entered digit char, or -1 */
+static int digit_value(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    return -1;
+}
+
+/* Recalculate disp_acc from disp_stack, for when the text has been set as
+ * a whole, or the width, format or signedness has changed. Any digits out
+ * of range are removed from the end. Returns true if the digit removed
+ * would have made the +ve equivalent of int_min. */
+static bool acc_from_stack(void)
+{
+    int i = disp_stack[0] == '-' ? 1 : 0;
+    bool int_min = false;
+
+    acc_width = calc_get_integer_width();
+    acc_set_limits(acc_width);
+    acc_format = int_format;
+    acc_unsigned = calc_get_use_unsigned();
+    acc_valid = true;
+    disp_acc = 0;
+
+    for (; i < disp_stack_index; i++)
+    {
+        int d = digit_value(disp_stack[i]);
+        acc_result_enum res;
+
+        if (d < 0 || d >= acc_get_base())
         {
-            /* For hex mode, the number of digits entered has already been
-             * limited based on the the width. Since hex mode shows the
-             * bit pattern, no distinction between signed and unsigned, just
-             * treat as unsigned. */
-            if (!calc_util_unsigned_str_to_ival(disp_stack, width, &disp_ival, 16))
+            /* stop at anything else, as strtoull would */
+            return false;
+        }
+        res = acc_add_digit((unsigned int)d);
+        if (res != acc_ok)
+        {
+            int_min = res == acc_int_min;
+            while (disp_stack_index > i)
             {
-                /* should never happen */
-                disp_error("Bad conversion hex to integer");
+                disp_stack_pop();
             }
+            break;
         }
+    }
+    return int_min;
+}
+
+/* disp_acc as the value masked to the width */
+static calc_int_t acc_get_ival(void)
+{
+    calc_int_t ival = disp_stack[0] == '-' ? -disp_acc : disp_acc;
+    calc_util_mask_width(&ival, acc_width);
+    return ival;
+}
+
+static bool acc_is_current(void)
+{
+    return acc_valid && acc_width == calc_get_integer_width()
+           && acc_format == int_format
+           && acc_unsigned == calc_get_use_unsigned();
+}
+
 
-        display_widget_bin_set_val(disp_ival, width);
+/* See description for display_add in the header file for explanation of
+ * the return value. */
+static bool update_display(void)
+{
+    bool ret = false;
+
+    if (disp_mode == disp_mode_int)
+    {
+        /* disp_ival is kept for the bin display and display_get_val */
+        if (!acc_is_current())
+        {
+            ret = acc_from_stack();
+        }
+        disp_ival = acc_get_ival();
+        display_widget_bin_set_val(disp_ival, acc_width);
+    }
+    else
+    {
+        display_widget_bin_clear();
     }
 
     /* allow for hex grouping */
@@ -304,6 +405,7 @@ void display_set_text(const char *msg)
      * are 0 so eg. no need to add a 0 after pushing char. */
     memset(disp_stack, 0, sizeof(disp_stack));
     disp_stack_index = 0;
+    disp_fval_valid = false;
     /* force to false */
     disp_exp_entry = false;
 
@@ -312,6 +414,7 @@ void display_set_text(const char *msg)
         disp_stack_push(*msg, -1);
         msg++;
     }
+    acc_valid = false;
     (void)update_display();
 }
 
@@ -360,6 +463,11 @@ void display_remove(void)
         if (disp_stack_index == 1 && disp_stack[0] == '-')
             disp_stack[0] = '0';
     }
+    if (disp_mode == disp_mode_int)
+    {
+        /* the same as removing the last digit, 0 for a single digit */
+        disp_acc /= acc_get_base();
+    }
     (void)update_display();
 }
 
@@ -378,6 +486,40 @@ static void add_exponent(char c)
     (void)update_display();
 }
 
+static bool add_int_digit(char c)
+{
+    int d = digit_value(c);
+    acc_result_enum res;
+
+    if (!acc_is_current())
+    {
+        (void)acc_from_stack();
+    }
+    if (d < 0 || d >= acc_get_base())
+    {
+        return false;
+    }
+
+    /* suppress leading zeros */
+    if ((disp_stack_index == 1 && disp_stack[0] == '0') ||
+        (disp_stack_index == 2 && disp_stack[0] == '-' && disp_stack[1] == '0'))
+    {
+        if (d == 0)
+            return false;
+        /* so any non zero digit replaces the zero */
+        disp_stack_pop();
+    }
+
+    /* The range check limits the number of digits for both dec and hex,
+     * anything out of range is simply not added. */
+    res = acc_add_digit((unsigned int)d);
+    if (res == acc_ok)
+    {
+        disp_stack_push(c, -1);
+    }
+    return update_display() || res == acc_int_min;
+}
+
 bool display_add(char c)
 {
     if (disp_exp_entry)
@@ -386,6 +528,11 @@ bool display_add(char c)
         return false;
     }
 
+    if (disp_mode == disp_mode_int)
+    {
+        return add_int_digit(c);
+    }
+
     int limit;
 
     /* suppress leading zeros */
@@ -401,49 +548,25 @@ bool display_add(char c)
         }
     }
 
-    if (disp_mode == disp_mode_int)
+    bool existing_point = strchr(disp_stack, '.') != NULL;
+    if (existing_point && c == '.')
+        return false;
+    /* A bit of faff to set how many characters are allowed to be entered.
+     * If disp_float_num_digits == 6 as an example, then allow
+     *  123456, -123456, 1.23456, -1.23456, 0.123456, -0.123456 */
+    limit = disp_float_num_digits;
+    int first = 0;
+    if (disp_stack[0] == '-')
     {
-        if (int_format == disp_int_dec)
-        {
-            /* limited by range check by str_to_ival in update_display */
-            limit = -1;
-        }
-        else
-        {
-            /* For hex it is easier to simply limit the num digits */
-            calc_width_enum width = calc_get_integer_width();
-            if (width == calc_width_8)
-                limit = 2;
-            else if (width == calc_width_16)
-                limit = 4;
-            else if (width == calc_width_32)
-                limit = 8;
-            else
-                limit = 16;
-        }
+        first = 1;
+        limit++;
     }
-    else
+    if (existing_point)
     {
-        bool existing_point = strchr(disp_stack, '.') != NULL;
-        if (existing_point && c == '.')
-            return false;
-        /* A bit of faff to set how many characters are allowed to be entered.
-         * If disp_float_num_digits == 6 as an example, then allow
-         *  123456, -123456, 1.23456, -1.23456, 0.123456, -0.123456 */
-        limit = disp_float_num_digits;
-        int first = 0;
-        if (disp_stack[0] == '-')
-        {
-            first = 1;
-            limit++;
-        }
-        if (existing_point)
+        limit++;
+        if (disp_stack[first] == '0')
         {
             limit++;
-            if (disp_stack[first] == '0')
-            {
-                limit++;
-            }
         }
     }
 
@@ -508,11 +631,12 @@ void disp_toggle_sign(void)
         /* since we have removed the '-' */
         disp_stack_index--;
     }
+    acc_valid = false;
     (void)update_display();
 }
 
 
-void display_get_val(uint64_t *ival, stackf_t *fval)
+void display_get_val(calc_int_t *ival, stackf_t *fval)
 {
     if (disp_mode == disp_mode_int)
     {
@@ -530,174 +654,64 @@ void display_get_val(uint64_t *ival, stackf_t *fval)
 
 
 
-bool display_get_best_integer(uint64_t *val, bool *negative)
+bool display_get_best_integer(calc_int_t *val, bool *negative)
 {
     /* This is the one case where it probably makes sense to convert the value
      * actually on the display rather than convert from the (more precise,
      * unrounded) underlying floating point value.
-     * If the value is negative, convert as signed 64, if positive convert as
-     * unsigned 64. */
-
-    uint64_t result;
-    char *buf;
-    char buffer1[DFP_STRING_MAX];
-    char buffer2[DFP_STRING_MAX];
-    int exp_index = -1;
-    bool sign = false;
-    bool ret = true;
-
-    /* grab what is in the display */
-    buf = buffer1;
-    strcpy(buf, disp_stack);
-    if (*buf == '-')
-    {
-        sign = true;
-        buf++;
-    }
-    *negative = sign;
+     * If the value is negative, convert as signed 128, if positive convert as
+     * unsigned 128. */
 
-    /* anything starting with 0 converts to 0 */
-    if (*buf == '0')
-    {
-        *val = 0;
-        return true;
-    }
+    stackf_t fval;
+    dfp_int_status_enum status;
 
-    for (int i = 0; buf[i] && exp_index < 0; i++)
+    if (disp_fval_valid)
     {
-        char c = buf[i];
-        if (c == 'e' || c == 'E')
-        {
-            exp_index = i;
-            /* should already be guaranteed small e, but make sure */
-            buf[i] = 'e';
-        }
-        else if (c == 'a' || c == 'A')
+        /* a result, rounded to what display_print shows */
+        if (float_format != disp_float_fixed
+            || !display_print_fixed_value(&fval, disp_fval,
+                                          disp_float_fixed_places,
+                                          disp_float_num_digits))
         {
-            /* must be nan */
-            *val = 0;
-            return true;
-        }
-        else if (c == 'f' || c == 'F')
-        {
-            /* must be inf(inity) */
-            *val = sign ? (uint64_t)INT64_MIN : UINT64_MAX;
-            return false;
+            /* to the digits shown, as gmode */
+            decNumber dn;
+            decContext set;
+
+            decContextDefault(&set, DEC_INIT_DECQUAD);
+            set.digits = disp_float_num_digits;
+            set.round = DEC_ROUND_HALF_UP;
+            dfp_to_number(&disp_fval, &dn);
+            decNumberPlus(&dn, &dn, &set);
+            dfp_from_number(&fval, &dn, &set);
         }
     }
-
-    if (exp_index >= 0)
+    else
     {
-        /* it has an exponent */
-        int exp_val = (int)strtol(buf + exp_index + 1, NULL, 10);
-        if (exp_val < 0)
-        {
-            /* any negative exp converts to 0 */
-            *val = 0;
-            return true;
-        }
-        if (sign)
-        {
-            if (exp_val > 18)
-            {
-                /* definitely out of range */
-                *val = (uint64_t)INT64_MIN;
-                return false;
-            }
-        }
-        else
-        {
-            if (exp_val > 19)
-            {
-                /* definitely out of range */
-                *val = UINT64_MAX;
-                return false;
-            }
-        }
-
-        /* exp in range 0 to 18(19) */
-        int new_point_index = exp_val + 1;
-        int count = 0;
-        char *dst = buffer2;
-        char *src = buf;
-        if (sign)
-        {
-            *dst++ = '-';
-        }
-        /* expand to non exponent form, copy all digits up to exponent,
-         * inserting point at the appropriate location if it is within the
-         * digits still */
-        while (*src != 'e')
-        {
-            if (*src != '.')
-            {
-                *dst++ = *src;
-                count++;
-                if (count == new_point_index)
-                {
-                    *dst++ = '.';
-                }
-            }
-            src++;
-        }
-        /* run out of digits, may need to add some zeros */
-        count--;
-        while (count < exp_val)
-        {
-            count++;
-            *dst++ = '0';
-        }
-        /* null terminate */
-        *dst = 0;
-        /* terminate at point instead if there is one */
-        char *pt = strchr(buffer2, '.');
-        if (pt != NULL)
-        {
-            *pt = 0;
-        }
-
-        //printf("convert best A %s\n", buffer2);
+        /* entered by the user, so the text is the value */
+        dfp_from_string(&fval, disp_stack, &dfp_context);
+    }
 
-        /* convert the resulting string, includes the sign if there is one */
-        if (sign)
-        {
-            ret = calc_util_signed_str_to_ival(buffer2, calc_width_64, &result, 10);
-        }
-        else
-        {
-            ret = calc_util_unsigned_str_to_ival(buffer2, calc_width_64, &result, 10);
-        }
+    *negative = dfp_is_negative(&fval);
+    if (*negative)
+    {
+        calc_sint_t si;
+        status = dfp_to_int128(&fval, DEC_ROUND_DOWN, &si);
+        *val = (calc_int_t)si;
     }
     else
     {
-        /* no exponent, terminate at point if there is one */
-        char *pt = strchr(buffer1, '.');
-        if (pt != NULL)
-        {
-            *pt = 0;
-        }
-
-        //printf("convert best B %s\n", buffer1);
-
-        /* convert the resulting string, includes the sign if there is one */
-        if (sign)
-        {
-            ret = calc_util_signed_str_to_ival(buffer1, calc_width_64, &result, 10);
-        }
-        else
-        {
-            ret = calc_util_unsigned_str_to_ival(buffer1, calc_width_64, &result, 10);
-        }
+        status = dfp_to_uint128(&fval, DEC_ROUND_DOWN, val);
     }
-    *val = result;
-    return ret;
+
+    /* nan converts to 0 */
+    return status != dfp_int_too_big && status != dfp_int_too_small;
 }
 
 
-void display_set_val(uint64_t ival, stackf_t fval)
+void display_set_val(calc_int_t ival, stackf_t fval)
 {
     char msg[DFP_STRING_MAX];
-    calc_width_enum width = calc_get_integer_width();
+    calc_width_t width = calc_get_integer_width();
 
     if (disp_mode == disp_mode_int)
     {
@@ -705,12 +719,20 @@ void display_set_val(uint64_t ival, stackf_t fval)
         {
             if (calc_get_use_unsigned())
             {
-                sprintf(msg, "%" PRIu64, ival);
+                radix_print(msg, ival, 10, 1, 0, NULL);
             }
             else
             {
-                int64_t si = calc_util_get_signed(ival, width);
-                sprintf(msg, "%" PRId64, si);
+                calc_sint_t si = calc_util_get_signed(ival, width);
+                if (si < 0)
+                {
+                    msg[0] = '-';
+                    radix_print(msg + 1, -(calc_int_t)si, 10, 1, 0, NULL);
+                }
+                else
+                {
+                    radix_print(msg, (calc_int_t)si, 10, 1, 0, NULL);
+                }
             }
         }
         else
@@ -718,25 +740,42 @@ void display_set_val(uint64_t ival, stackf_t fval)
             /* Doing this unsigned, and for smaller widths, values are already
              * masked to the width,
              * eg. width=8, if the value represented is -1 then ival is
-             * actually 0x00000000000000ff */
-            sprintf(msg, "%" PRIX64, ival);
+             * actually 0x...000000ff */
+            radix_print(msg, ival, 16, 1, 0, NULL);
         }
     }
     else
     {
-        if (float_format == disp_float_gmode)
-        {
-            //sprintf(msg, "%.*g", DISP_MAX_DIGIT_FLOAT, fval);
-            display_print_gmode(msg, fval, disp_float_num_digits);
-        }
-        else
+        switch (float_format)
         {
+        case disp_float_emode:
             //sprintf(msg, "%.*e", DISP_MAX_DIGIT_FLOAT - 1, fval);
             display_print_emode(msg, fval, disp_float_num_digits);
+            break;
+        case disp_float_engmode:
+            display_print_engmode(msg, fval, disp_float_num_digits);
+            break;
+        case disp_float_fixed:
+            display_print_fixed(msg, fval, disp_float_fixed_places,
+                                disp_float_num_digits);
+            break;
+        case disp_float_si:
+            display_print_si(msg, fval, disp_float_num_digits);
+            break;
+        default:
+            //sprintf(msg, "%.*g", DISP_MAX_DIGIT_FLOAT, fval);
+            display_print_gmode(msg, fval, disp_float_num_digits);
+            break;
         }
     }
 
     display_set_text(msg);
+
+    if (disp_mode == disp_mode_float)
+    {
+        disp_fval = fval;
+        disp_fval_valid = true;
+    }
 }
 
 void display_set_exp_entry(bool enable)
@@ -789,6 +828,26 @@ disp_float_format_enum display_get_float_format(void)
     return float_format;
 }
 
+void display_set_normal_float_format(disp_float_format_enum format)
+{
+    float_format_normal = format;
+}
+
+disp_float_format_enum display_get_normal_float_format(void)
+{
+    return float_format_normal;
+}
+
+void display_set_float_fixed_places(int places)
+{
+    disp_float_fixed_places = places;
+}
+
+void display_set_float_grouping(bool enable)
+{
+    display_print_set_grouping(enable);
+}
+
 void display_set_hex_grouping(int hg)
 {
     hex_grouping = hg;
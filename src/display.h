@@ -36,13 +36,22 @@ typedef enum
     disp_int_hex,
 } disp_int_format_enum;
 
-/* Use %g or %e */
+/* Use %g or %e, engineering (exponent a multiple of 3), a fixed number of
+ * decimal places, or an SI prefix. See display_print.h */
 typedef enum
 {
     disp_float_gmode,
     disp_float_emode,
+    disp_float_engmode,
+    disp_float_fixed,
+    disp_float_si,
+    num_disp_float_formats
 } disp_float_format_enum;
 
+#define DISP_FIXED_PLACES_MIN 0
+#define DISP_FIXED_PLACES_MAX 20
+#define DISP_FIXED_PLACES_DEFAULT 2
+
 /* init, provide hex_grouping */
 void display_init(int hg);
 
@@ -79,6 +88,17 @@ void display_set_int_format(disp_int_format_enum format);
 void display_set_float_format(disp_float_format_enum format);
 disp_float_format_enum display_get_float_format(void);
 
+/* Set/get the float format normally used for results (the F-E button
+ * gives emode for one result only) */
+void display_set_normal_float_format(disp_float_format_enum format);
+disp_float_format_enum display_get_normal_float_format(void);
+
+/* Number of decimal places for disp_float_fixed */
+void display_set_float_fixed_places(int places);
+
+/* Group digits before the point in threes, in float mode */
+void display_set_float_grouping(bool enable);
+
 /* Add/remove minus sign, automatically does the right thing in
  * exponent entry mode. */
 void disp_toggle_sign(void);
@@ -87,11 +107,11 @@ void disp_toggle_sign(void);
  * which mode is in use, in int mode will use dec or hex depending on int
  * format in use, in float mode will use either gmode or emode depending on
  * float format in use. It will automatically disable exponent entry mode. */
-void display_set_val(uint64_t ival, stackf_t fval);
+void display_set_val(calc_int_t ival, stackf_t fval);
 
 /* Get the value currently on the display, as ival if in int mode (fval will
  * be set to zero), or fval if in float mode (ival will be set to zero). */
-void display_get_val(uint64_t *ival, stackf_t *fval);
+void display_get_val(calc_int_t *ival, stackf_t *fval);
 
 /* Set/get exponent entry mode - this affects how the display responds to
  * display_add, display_remove, display_toggle_sign. */
@@ -110,12 +130,12 @@ void disp_set_error_callback(void (*fn)(const char *msg));
  * So when converting to integer it would be truncated to 79, which looks
  * a bit wrong. So convert from the (rounded) value on the display rather
  * than from the underlying floating point value.
- * Returns true if the value is positive and in range of UINT64_MAX, or
- * negative and in range of INT64_MIN.
+ * Returns true if the value is positive and in the unsigned 128 bit range,
+ * or negative and in the signed 128 bit range.
  * The value is returned in *val, with *negative = true if it represents
  * a negative number.
  */
-bool display_get_best_integer(uint64_t *val, bool *negative);
+bool display_get_best_integer(calc_int_t *val, bool *negative);
 
 /* set the grouping for hex digits, 0, 4, or 8 */
 void display_set_hex_grouping(int hg);
@@ -22,386 +22,482 @@
 #include <string.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <ctype.h>
 
 #include "display_print.h"
 #include "calc_types.h"
 
-/* functions to manipulate the output from decimal floating point to_string */
+/* Print decimal floating point values in emode (always with an exponent
+ * unless it is 0), gmode (no exponent when the value is not too big or
+ * too small), engineering mode (exponent a multiple of 3), with an SI
+ * prefix, or with a fixed number of decimal places. The digits and
+ * exponent are taken straight from the value, no string is parsed, and
+ * the text is written in one pass. */
 
 //#define DEBUG_DISP_PRINT
 
-static bool round_to_max_digits(char *msg, int sig_count, int max_digits)
+typedef struct
 {
-    if (sig_count <= max_digits)
+    bool sign;
+    int exp_val;        /* exponent with the point after the first digit */
+    int count;          /* number of digits */
+    uint8_t *digits;
+} print_value_t;
+
+/* separator for groups of 3 digits before the point, 0 for none */
+static char group_sep;
+
+/* SI prefixes for exponents -30 to 30 in steps of 3, u for micro */
+#define SI_EXP_MIN (-30)
+#define SI_EXP_MAX 30
+static const char si_prefix[] = "qryzafpnum kMGTPEZYRQ";
+
+
+void display_print_set_grouping(bool enable)
+{
+    group_sep = enable ? ',' : 0;
+}
+
+bool display_print_get_grouping(void)
+{
+    return group_sep != 0;
+}
+
+
+/* Fill in pv from fval, all the significant digits with no rounding.
+ * Returns false for zero, infinity and nan, in which case msg has been
+ * written as dfp_to_string gives it. */
+static bool get_print_value(print_value_t *pv, uint8_t *bcd, char *msg,
+                            stackf_t fval)
+{
+    int first = 0;
+    int32_t exp = dfp_get_exponent(&fval);
+
+    pv->sign = dfp_get_coefficient(&fval, bcd) != 0;
+
+    while (first < DECQUAD_Pmax && bcd[first] == 0)
     {
-        return false;
+        first++;
     }
 
-    /* msg is in form n.nnnnn (or could be just n but then we have
-     * already returned since sig_count would be 1 and max_digits
-     * will always be > 1) */
-
-    bool carry = false;
-    int i = max_digits;
-    if (msg[i + 1] >= '5')
+    /* exponent is DECFLOAT_Inf or one of the NaNs for the specials */
+    if (exp >= DECFLOAT_MinSp || first == DECQUAD_Pmax)
     {
-        msg[i]++;
-        if (msg[i] > '9')
+        dfp_to_string(&fval, msg);
+        if (first == DECQUAD_Pmax && exp < DECFLOAT_MinSp)
         {
-            msg[i] = '0';
-            carry = true;
-            i--;
+            /* prefer small e, for zero with an exponent eg. 0E+3 */
+            char *e = strchr(msg, 'E');
+            if (e)
+            {
+                *e = 'e';
+            }
         }
+        return false;
     }
-    while (carry && msg[i] != '.')
+
+    pv->count = DECQUAD_Pmax - first;
+    pv->exp_val = exp + pv->count - 1;
+    pv->digits = &bcd[first];
+    return true;
+}
+
+
+/* Keep the first keep digits (keep >= 1), rounding half up on the first
+ * digit dropped, then remove trailing zeros. */
+static void round_print_value(print_value_t *pv, int keep)
+{
+    if (pv->count > keep)
     {
-        msg[i]++;
-        if (msg[i] > '9')
+        uint8_t *d = pv->digits;
+        bool carry = d[keep] >= 5;
+        int i = keep - 1;
+
+        while (carry && i >= 0)
         {
-            msg[i] = '0';
-            i--;
+            if (d[i] == 9)
+            {
+                d[i] = 0;
+                i--;
+            }
+            else
+            {
+                d[i]++;
+                carry = false;
+            }
         }
-        else
+        if (carry)
         {
-            carry = false;
+            /* 10 will become 1 with exponent incremented */
+            d[0] = 1;
+            pv->exp_val++;
         }
+        pv->count = keep;
     }
-    if (carry)
+
+    while (pv->count > 1 && pv->digits[pv->count - 1] == 0)
     {
-        msg[0]++;
-        if (msg[0] > '9')
-        {
-            /* 10 will become 1 with exponent incremented */
-            msg[0] = '1';
-        }
-        else
-        {
-            carry = false;
-        }
+        pv->count--;
     }
-    /* place null termination to shorten msg */
-    msg[max_digits + 1] = 0;
-    return carry;
+
+#ifdef DEBUG_DISP_PRINT
+    printf("print value: sign %d  count %d  exp_val %d\n",
+           pv->sign, pv->count, pv->exp_val);
+#endif
 }
 
 
-static void strip_trailing_zeros(char *msg)
+/* digit i of the value, 0 past the last one */
+static inline char digit_char(const print_value_t *pv, int i)
 {
-    bool has_point = false;
-    char *p = msg;
-    while (*p)
+    return (char)('0' + (i >= 0 && i < pv->count ? pv->digits[i] : 0));
+}
+
+
+/* Length of the digits before the point when grouped, or just n if
+ * grouping would make the whole text (of len chars ungrouped) too long
+ * for DFP_STRING_MAX. */
+static int grouped_len(int n, int len)
+{
+    if (group_sep && n > 3 && len + (n - 1) / 3 < DFP_STRING_MAX)
     {
-        if (*p == '.')
+        return n + (n - 1) / 3;
+    }
+    return n;
+}
+
+
+/* Write the first n digits (padded with zeros), with group separators if
+ * glen says there is room for them. */
+static char *put_int_digits(char *p, const print_value_t *pv, int n, int glen)
+{
+    for (int i = 0; i < n; i++)
+    {
+        if (glen > n && i > 0 && (n - i) % 3 == 0)
         {
-            has_point = true;
+            *p++ = group_sep;
         }
-        p++;
+        *p++ = digit_char(pv, i);
     }
-    if (!has_point || p == msg)
+    return p;
+}
+
+
+/* Write n digits starting from digit first (which may be negative for
+ * zeros after the point) */
+static char *put_digits(char *p, const print_value_t *pv, int first, int n)
+{
+    for (int i = 0; i < n; i++)
     {
-        return;
+        *p++ = digit_char(pv, first + i);
+    }
+    return p;
+}
+
+
+/* as sprintf "e%+d" */
+static char *put_exponent(char *p, int exp_val)
+{
+    char ebuf[10];
+    int n = 0;
+    unsigned int e = exp_val < 0 ? -exp_val : exp_val;
+
+    *p++ = 'e';
+    *p++ = exp_val < 0 ? '-' : '+';
+    do
+    {
+        ebuf[n++] = (char)('0' + e % 10);
+        e /= 10;
+    } while (e);
+    while (n)
+    {
+        *p++ = ebuf[--n];
     }
+    return p;
+}
+
 
-    /* p currently pointing at null terminator */
-    p--;
-    while (*p == '0')
+/* Mantissa with int_digits digits before the point, all digits after it,
+ * then the exponent if it is not 0 */
+static void put_mantissa_exp(char *p, const print_value_t *pv, int int_digits,
+                             int exp_val)
+{
+    if (pv->sign)
     {
-        p--;
+        *p++ = '-';
     }
-    /* if we hit the point, remove that as well */
-    if (*p == '.' && p != msg)
+    p = put_int_digits(p, pv, int_digits, int_digits);
+    if (pv->count > int_digits)
     {
-        p--;
+        *p++ = '.';
+        p = put_digits(p, pv, int_digits, pv->count - int_digits);
+    }
+    if (exp_val != 0)
+    {
+        p = put_exponent(p, exp_val);
     }
-    /* place null termination */
-    p++;
     *p = 0;
 }
 
 
-static int print_emode(char *msg, stackf_t fval, int max_digits)
+/* Value with no exponent, digits up to exp_val + 1 + places */
+static void put_plain(char *p, const print_value_t *pv, int places)
 {
-    char work_buffer[DFP_STRING_MAX];
-    char ebuf[10];
+    int int_digits = pv->exp_val >= 0 ? pv->exp_val + 1 : 1;
+    int len = pv->sign + int_digits + (places > 0 ? places + 1 : 0);
 
-    int exp_val = 0;
-    int exp_index = -1;
-    int point_index = -1;
-    int sig_index = -1; /* first significant digit */
-    int sig_count = 0;
-    bool start_sig_count = false;
-    bool sign = false;
-    char *buf;
+    if (pv->sign)
+    {
+        *p++ = '-';
+    }
+    if (pv->exp_val >= 0)
+    {
+        p = put_int_digits(p, pv, int_digits, grouped_len(int_digits, len));
+    }
+    else
+    {
+        *p++ = '0';
+    }
+    if (places > 0)
+    {
+        *p++ = '.';
+        p = put_digits(p, pv, pv->exp_val + 1, places);
+    }
+    *p = 0;
+}
 
-    /* put into msg so the result is there if return early due to 0, inf, nan */
-    buf = msg;
-    dfp_to_string(&fval, buf);
 
-    if (strchr(buf, 'n') || strchr(buf, 'N'))
+void display_print_emode(char *msg, stackf_t fval, int max_digits)
+{
+    uint8_t bcd[DECQUAD_Pmax];
+    print_value_t pv;
+
+    if (get_print_value(&pv, bcd, msg, fval))
     {
-        /* must be inf(inity) or nan */
-        return 0;
+        round_print_value(&pv, max_digits);
+        put_mantissa_exp(msg, &pv, 1, pv.exp_val);
     }
+}
+
 
-    if (*buf == '-')
+void display_print_gmode(char *msg, stackf_t fval, int max_digits)
+{
+    uint8_t bcd[DECQUAD_Pmax];
+    print_value_t pv;
+
+    if (!get_print_value(&pv, bcd, msg, fval))
     {
-        sign = true;
-        buf++;
+        return;
     }
+    round_print_value(&pv, max_digits);
 
-    for (int i = 0; buf[i] && exp_index < 0; i++)
+    if (pv.exp_val > 0 && pv.exp_val <= max_digits - 1)
     {
-        char c = buf[i];
-        if (c == '.')
-        {
-            point_index = i;
-        }
-        else if (c == 'E' || c == 'e')
-        {
-            exp_index = i;
-            /* prefer small e */
-            buf[i] = 'e';
-        }
-        else if (c >= '0' && c <= '9')
-        {
-            if (!start_sig_count && c >= '1')
-            {
-                start_sig_count = true;
-                sig_index = i;
-            }
-            if (start_sig_count)
-            {
-                sig_count++;
-            }
-        }
+        /*  1e2      ==>  100    */
+        /*  1.234e+1 ==>  12.34  */
+        /*  1.234e+3 ==>  1234   */
+        /*  1.234e+4 ==>  12340  */
+        int frac = pv.count - (pv.exp_val + 1);
+        put_plain(msg, &pv, frac > 0 ? frac : 0);
     }
-
-    if (sig_count == 0)
+    else if (pv.exp_val < 0 && pv.exp_val >= -4)
     {
-        /* must be value 0 */
-        return 0;
+        /*  1e-1     ==>  0.1       */
+        /*  1.234e-2 ==>  0.01234   */
+        /*  1.234e-4 ==>  0.0001234 */
+        put_plain(msg, &pv, pv.count - (pv.exp_val + 1));
     }
+    else
+    {
+        put_mantissa_exp(msg, &pv, 1, pv.exp_val);
+    }
+}
 
-#ifdef DEBUG_DISP_PRINT
-    printf("emode: original (%c) %s\n", sign?'-':'+', buf);
-#endif
 
-    if (exp_index >= 0)
+/* engineering mode, the exponent rounded down to a multiple of 3 */
+static void print_engmode(char *msg, stackf_t fval, int max_digits, bool si)
+{
+    uint8_t bcd[DECQUAD_Pmax];
+    print_value_t pv;
+    int exp3;
+
+    if (!get_print_value(&pv, bcd, msg, fval))
     {
-        /* already in emode, grab exp_val, then copy to working buffer
-         * without the exp for now, put it back later. */
-        exp_val = (int)strtol(buf + exp_index + 1, NULL, 10);
-        buf[exp_index] = 0;
-        strcpy(work_buffer, buf);
+        return;
     }
-    else
-    {
-        /* not in emode, convert */
-        if (point_index < 0)
-        {
-            /* no point eg. 12345 */
-            exp_val = sig_count - 1;
-        }
-        else
-        {
-            if (point_index > sig_index)
-            {
-                /* 123.45  ==> exp 2 */
-                exp_val = point_index - sig_index - 1;
-            }
-            else
-            {
-                /* 0.0012345  ==> exp -3 */
-                exp_val = point_index - sig_index;
-            }
-        }
+    round_print_value(&pv, max_digits);
 
-        /* copy to working buffer, converting to emode */
-        char *dst = work_buffer;
-        int count = 0;
-        char *src = &buf[sig_index];
-        while (*src)
-        {
-            if (*src != '.')
-            {
-                *dst++ = *src;
-                count++;
-                if (count == 1)
-                {
-                    /* this could leave a point at the end, if so it is
-                     * removed later */
-                    *dst++ = '.';
-                }
-            }
-            src++;
-        }
+    exp3 = pv.exp_val >= 0 ? pv.exp_val / 3 * 3 : -((2 - pv.exp_val) / 3 * 3);
+    if (si && exp3 >= SI_EXP_MIN && exp3 <= SI_EXP_MAX)
+    {
+        /*  1.234e+4 ==>  12.34k */
+        char *p;
 
-        /* if left with a point at the end, remove */
-        if (*(dst - 1) == '.')
+        put_mantissa_exp(msg, &pv, pv.exp_val - exp3 + 1, 0);
+        if (exp3 != 0)
         {
-            dst--;
+            p = msg + strlen(msg);
+            *p++ = si_prefix[(exp3 - SI_EXP_MIN) / 3];
+            *p = 0;
         }
-        /* null terminate */
-        *dst = 0;
     }
-
-#ifdef DEBUG_DISP_PRINT
-    printf("emode: sig %d  point %d  exp %d exp_val %d   sig_count %d\n",
-           sig_index, point_index, exp_index, exp_val, sig_count);
-    sprintf(ebuf, "e%+d", exp_val);
-    printf("emode: original   (%c) %s (%s)\n", sign?'-':'+', buf, ebuf);
-    printf("emode: ===> exp   (%c) %s (%s)\n", sign?'-':'+', work_buffer, ebuf);
-#endif
-
-    if (round_to_max_digits(work_buffer, sig_count, max_digits))
+    else
     {
-        exp_val++;
+        /*  1.234e+4 ==>  12.34e+3 */
+        /*  1e-4     ==>  100e-6   */
+        put_mantissa_exp(msg, &pv, pv.exp_val - exp3 + 1, exp3);
     }
+}
 
-#ifdef DEBUG_DISP_PRINT
-    sprintf(ebuf, "e%+d", exp_val);
-    printf("emode: ===> round (%c) %s (%s)\n", sign?'-':'+', work_buffer, ebuf);
-#endif
 
-    strip_trailing_zeros(work_buffer);
+void display_print_engmode(char *msg, stackf_t fval, int max_digits)
+{
+    print_engmode(msg, fval, max_digits, false);
+}
 
-#ifdef DEBUG_DISP_PRINT
-    sprintf(ebuf, "e%+d", exp_val);
-    printf("emode: ===> strip (%c) %s (%s)\n", sign?'-':'+', work_buffer, ebuf);
-#endif
 
-    /* build final result to be returned in msg */
-    buf = msg;
-    if (sign)
+void display_print_si(char *msg, stackf_t fval, int max_digits)
+{
+    print_engmode(msg, fval, max_digits, true);
+}
+
+
+/* Round pv to places digits after the point for the fixed format. Returns
+ * false for too many digits before the point, or too long altogether, when
+ * the fixed format falls back to gmode. */
+static bool round_fixed(print_value_t *pv, int places, int max_digits)
+{
+    /* digits up to the last place */
+    int keep = pv->exp_val + 1 + places;
+
+    if (keep > 0)
     {
-        *buf = '-';
-        buf++;
+        round_print_value(pv, keep);
     }
-    strcpy(buf, work_buffer);
-    /* put exponent back */
-    if (exp_val != 0)
+    else if (keep == 0 && pv->digits[0] >= 5)
     {
-        sprintf(ebuf, "e%+d", exp_val);
-        strcat(buf, ebuf);
+        /* 0.006 ==> 0.01 */
+        pv->digits[0] = 1;
+        pv->count = 1;
+        pv->exp_val++;
+    }
+    else
+    {
+        /* rounds to zero, no minus sign for that */
+        pv->sign = false;
+        pv->count = 0;
     }
-    return exp_val;
-}
-
 
-void display_print_emode(char *msg, stackf_t fval, int max_digits)
-{
-    (void)print_emode(msg, fval, max_digits);
+    return pv->exp_val < max_digits
+           && pv->sign + (pv->exp_val > 0 ? pv->exp_val : 0) + 1 + places + 1
+              < DFP_STRING_MAX;
 }
 
-
-void display_print_gmode(char *msg, stackf_t fval, int max_digits)
+void display_print_fixed(char *msg, stackf_t fval, int places, int max_digits)
 {
-    char work_buffer[DFP_STRING_MAX];
-    bool sign = false;
-    char *buf;
+    uint8_t bcd[DECQUAD_Pmax];
+    print_value_t pv;
 
-    /* get it into emode first */
-    int exp_val = print_emode(msg, fval, max_digits);
-#ifdef DEBUG_DISP_PRINT
-    printf("gmode: exp %d\n", exp_val);
-#endif
+    if (!get_print_value(&pv, bcd, msg, fval))
+    {
+        if (dfp_is_zero(&fval) && places + 2 < DFP_STRING_MAX)
+        {
+            pv.sign = false;
+            pv.exp_val = 0;
+            pv.count = 0;
+            put_plain(msg, &pv, places);
+        }
+        return;
+    }
 
-    if (exp_val == 0)
+    if (!round_fixed(&pv, places, max_digits))
     {
-        /* nothing to change */
+        display_print_gmode(msg, fval, max_digits);
         return;
     }
+    put_plain(msg, &pv, places);
+}
 
-    buf = msg;
-    if (*buf == '-')
+bool display_print_fixed_value(stackf_t *res, stackf_t fval, int places,
+                               int max_digits)
+{
+    uint8_t bcd[DECQUAD_Pmax];
+    char buf[DFP_STRING_MAX];
+    print_value_t pv;
+    char *p = buf;
+
+    *res = fval;
+    if (!get_print_value(&pv, bcd, buf, fval))
     {
-        sign = true;
-        buf++;
+        /* zero, infinity and nan are shown as they are */
+        return true;
+    }
+    if (!round_fixed(&pv, places, max_digits))
+    {
+        return false;
     }
 
-    if (exp_val > 0 && exp_val <= max_digits - 1)
+    /* eg. 8E+1 for 80.00 */
+    if (pv.sign)
     {
-        /*  1e2      ==>  100    */
-        /*  1.234e+1 ==>  12.34  */
-        /*  1.234e+2 ==>  123.4  */
-        /*  1.234e+3 ==>  1234   */
-        /*  1.234e+4 ==>  12340  */
-        /*  1.234e+5 ==>  123400 */
-        int point_index = exp_val + 1;
-        int count = 0;
-        char *dst = work_buffer;
-        char *src = buf;
-        /* copy all digits up to exponent, inserting point at the appropriate
-         * location if it is within the digits still */
-        while (*src != 'e')
-        {
-            if (*src != '.')
-            {
-                *dst++ = *src;
-                count++;
-                if (count == point_index)
-                {
-                    /* this could leave a point at the end, if so it is
-                     * removed later */
-                    *dst++ = '.';
-                }
-            }
-            src++;
-        }
-        /* run out of digits, may need to add some zeros */
-        count--;
-        while (count < exp_val)
-        {
-            count++;
-            *dst++ = '0';
-        }
-        /* if left with a point at the end, remove */
-        if (*(dst - 1) == '.')
-        {
-            dst--;
-        }
-        /* null terminate */
-        *dst = 0;
+        *p++ = '-';
     }
-    else if (exp_val < 0 && exp_val >= -4)
+    if (pv.count == 0)
     {
-        /*  1e-1     ==>  0.1       */
-        /*  1.234e-1 ==>  0.1234    */
-        /*  1.234e-2 ==>  0.01234   */
-        /*  1.234e-3 ==>  0.001234  */
-        /*  1.234e-4 ==>  0.0001234 */
-        char *dst = work_buffer;
-        char *src = buf;
-        *dst++ = '0';
-        *dst++ = '.';
-        exp_val = -exp_val;
-        for (int i = 1; i < exp_val; i++)
-        {
-            *dst++ = '0';
-        }
-        while (*src != 'e')
+        strcpy(p, "0");
+    }
+    else
+    {
+        for (int i = 0; i < pv.count; i++)
         {
-            if (*src != '.')
-            {
-                *dst++ = *src;
-            }
-            src++;
+            *p++ = (char)('0' + pv.digits[i]);
         }
-        /* null terminate */
-        *dst = 0;
+        sprintf(p, "E%d", pv.exp_val - (pv.count - 1));
     }
-    else
+    dfp_from_string(res, buf, &dfp_context);
+    return true;
+}
+
+
+void display_print_unformat(char *out, const char *text)
+{
+    /* room at the end for an SI prefix as an exponent, eg. e-30 */
+    char *end = out + DFP_STRING_MAX - 6;
+    char *o = out;
+    const char *p = text;
+
+    while (*p != '\0' && *p <= ' ')
     {
-        /* nothing to change */
-        return;
+        p++;
     }
 
-    /* we changed it, put result back from work_buffer to msg */
-    buf = msg;
-    if (sign)
+    for (; *p != '\0' && o < end; p++)
     {
-        *buf = '-';
-        buf++;
+        const char *si;
+
+        if (*p == ',' && isdigit((unsigned char)p[1])
+            && isdigit((unsigned char)p[2]) && isdigit((unsigned char)p[3]))
+        {
+            /* grouping, 1,234,567 */
+            continue;
+        }
+        if (strchr("0123456789.+-", *p) != NULL
+            || ((*p == 'e' || *p == 'E')
+                && (isdigit((unsigned char)p[1]) || p[1] == '+' || p[1] == '-')))
+        {
+            *o++ = *p;
+            continue;
+        }
+        /* an SI prefix straight after the digits, 12.345k ==> 12.345e3 (E
+         * without an exponent after it is exa) */
+        si = strchr(si_prefix, *p);
+        if (si != NULL && *p != ' ' && o > out
+            && (isdigit((unsigned char)o[-1]) || o[-1] == '.'))
+        {
+            o += sprintf(o, "e%d", SI_EXP_MIN + 3 * (int)(si - si_prefix));
+        }
+        break;
     }
-    strcpy(buf, work_buffer);
+    *o = '\0';
 }
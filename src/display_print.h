@@ -21,8 +21,35 @@
 #ifndef DISPLAY_PRINT_H
 #define DISPLAY_PRINT_H
 
+#include <stdbool.h>
 #include "calc_types.h"
 
+/* All round to max_digits significant digits, and write at most
+ * DFP_STRING_MAX chars to msg. */
 void display_print_gmode(char *msg, stackf_t fval, int max_digits);
 void display_print_emode(char *msg, stackf_t fval, int max_digits);
+/* exponent a multiple of 3, eg. 12.345e+3 */
+void display_print_engmode(char *msg, stackf_t fval, int max_digits);
+/* as engmode but with an SI prefix instead of the exponent, eg. 12.345k
+ * (u for micro), engmode outside the prefixes q to Q */
+void display_print_si(char *msg, stackf_t fval, int max_digits);
+/* places digits after the point, rounded, eg. 12345.68. Falls back to gmode
+ * for a value with more than max_digits digits before the point. */
+void display_print_fixed(char *msg, stackf_t fval, int places, int max_digits);
+/* The value display_print_fixed shows, rounded to places. Returns false
+ * when that would fall back to gmode. */
+bool display_print_fixed_value(stackf_t *res, stackf_t fval, int places,
+                               int max_digits);
+
+/* Text as written above (with grouping or an SI prefix) back to the plain
+ * text dfp_from_string takes, eg. 1,234.5 ==> 1234.5, 12.3k ==> 12.3e3.
+ * Leading white space is skipped and the value ends at the first character
+ * that isn't part of it, so pasted text has a better chance. Writes at most
+ * DFP_STRING_MAX chars to out. */
+void display_print_unformat(char *out, const char *text);
+
+/* Group the digits before the point in threes with commas, when there is
+ * room, for gmode and fixed. Default off. */
+void display_print_set_grouping(bool enable);
+bool display_print_get_grouping(void);
 #endif
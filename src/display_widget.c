@@ -20,18 +20,54 @@
 
 #include <gtk/gtk.h>
 #include <stdio.h>
+#include <string.h>
+#include <stdint.h>
 
 #include "display_widget.h"
 #include "config.h"
 #include "calc.h"
 #include "gui.h"
 #include "gui_util.h"
+#include "radix_print.h"
+#include "display_print.h"
+#include "ieee754.h"
 
 static GtkWidget *display;
-static GtkWidget *bin_display_top;
-static GtkWidget *top_eventbox;
-static GtkWidget *bin_display_bot;
-static GtkWidget *bot_eventbox;
+
+/*
+ * Details for the secondary display showing value in binary, in rows of 32
+ * bits, row 0 (the low bits) at the bottom
+ *
+ * bbbb-bbbb  bbbb-bbbb  bbbb-bbbb  bbbb-bbbb     bits 63 - 32
+ * bbbb-bbbb  bbbb-bbbb  bbbb-bbbb  bbbb-bbbb     bits 31 - 0
+ *
+ * The bottom two rows are always there, so the layout doesn't change for
+ * widths up to 64. The rows above are only shown when the width needs
+ * them. Bits above the width are left as spaces.
+ */
+#define BIN_ROW_BITS 32
+#define NUM_BIN_ROWS (CALC_WIDTH_MAX / BIN_ROW_BITS)
+#define MIN_BIN_ROWS 2
+/* 4 bytes with a hyphen between each nybble within a byte, hence 9 chars,
+ * and 2 spaces between each byte */
+#define BIN_ROW_CHARS (4 * 9 + 3 * 2)
+
+static GtkWidget *bin_display[NUM_BIN_ROWS];
+static GtkWidget *bin_eventbox[NUM_BIN_ROWS];
+static bool bin_pressed[NUM_BIN_ROWS];
+static int bin_rows_shown;
+
+/* real value under the binary display when in fixed point mode, each
+ * lane's value in lanes mode, or the value as a binary float when that
+ * view is on */
+static GtkWidget *value_display;
+static int ieee_format = -1;
+/* the last value, to redo the display when the view changes */
+static calc_int_t last_ival;
+static calc_width_t last_width;
+static bool last_valid;
+/* all of decQuad, 2^-n needs n digits so only short fractions are exact */
+#define VALUE_DIGITS 34
 
 /* Used when the binary display is out of use (float mode) - fill with spaces
  * to avoid possibility of the layout size changing.
@@ -39,27 +75,6 @@ static GtkWidget *bot_eventbox;
 static const char *bin_disp_unused =
     "                                          ";
 
-static bool top_pressed;
-static bool bot_pressed;
-
-/*
- * Details for the secondary display showing value in binary
- *
- * bbbb-bbbb  bbbb-bbbb  bbbb-bbbb  bbbb-bbbb  bbbb-bbbb  bbbb-bbbb  bbbb-bbbb  bbbb-bbbb
- *                                           ^^
- *                              will split here for top/bot displays
- */
-
-/* 64 bit numbers */
-#define MAX_BIN_BYTES 8
-/* add a hyphen between each nybble within a byte, hence 9 chars */
-#define MAX_BIN_CHARS (MAX_BIN_BYTES * 9)
-/* 2 spaces between each byte (7 * 2) = 14 */
-#define MAX_BIN_CHARS_PLUS_SPACES (MAX_BIN_CHARS + 14)
-/* 1 for null termination */
-#define MAX_BIN_CHARS_PLUS_SPACES_PLUS_NULL (MAX_BIN_CHARS_PLUS_SPACES + 1)
-static char bin_disp_str_spaced[MAX_BIN_CHARS_PLUS_SPACES_PLUS_NULL];
-
 
 /* return bit clicked (0 - 31), or -1 if not clicked on any bit */
 static int get_bit_clicked(GtkWidget *widget, GdkEventButton *event)
@@ -74,9 +89,9 @@ static int get_bit_clicked(GtkWidget *widget, GdkEventButton *event)
     //int y = event->y;
     //printf("position x=%d  y=%d\n", x, y);
 
-    /* get the font width for one char (monospace). Will be same for top and bot. */
+    /* get the font width for one char (monospace). Will be same for all rows. */
     int fw, fh;
-    PangoLayout *pl = gtk_widget_create_pango_layout(bin_display_bot, "0");
+    PangoLayout *pl = gtk_widget_create_pango_layout(bin_display[0], "0");
     pango_layout_get_pixel_size(pl, &fw, &fh);
     g_object_unref(pl);
     //printf("font w=%d  h=%d\n", fw, fh);
@@ -171,20 +186,20 @@ static int get_bit_clicked(GtkWidget *widget, GdkEventButton *event)
 #define MOUSE_LEFT_BUT 1
 #define MOUSE_RIGHT_BUT 3
 
-static gboolean button_release_top(GtkWidget *widget, GdkEventButton *event,
-                                   gpointer user_data)
+static gboolean button_release(GtkWidget *widget, GdkEventButton *event,
+                               gpointer user_data)
 {
     (void)widget;
-    (void)user_data;
     (void)event;
-    top_pressed = false;
+    int row = (int)(uintptr_t)user_data;
+    bin_pressed[row] = false;
     return TRUE;
 }
 
-static gboolean button_press_top(GtkWidget *widget, GdkEventButton *event,
-                                 gpointer user_data)
+static gboolean button_press(GtkWidget *widget, GdkEventButton *event,
+                             gpointer user_data)
 {
-    (void)user_data;
+    int row = (int)(uintptr_t)user_data;
 
     if (calc_get_mode() != calc_mode_integer)
         return TRUE;
@@ -192,78 +207,25 @@ static gboolean button_press_top(GtkWidget *widget, GdkEventButton *event,
     if (event->button != MOUSE_LEFT_BUT)
         return TRUE;
 
-    if (calc_get_integer_width() != calc_width_64)
-        return TRUE;
-
-    if (top_pressed)
+    if (bin_pressed[row])
     {
         /* filter out repeated press without a release in between */
         return TRUE;
     }
-    top_pressed = true;
+    bin_pressed[row] = true;
 
     int bit_clicked = get_bit_clicked(widget, event);
     if (bit_clicked < 0)
         return TRUE;
 
-    bit_clicked += 32;
-    //printf("bit clicked %d\n", bit_clicked);
-
-    gui_give_arg_if_pending();
-    calc_binary_bit_xor(1ULL << bit_clicked);
-
-    return TRUE;
-}
-
-
-static gboolean button_release_bot(GtkWidget *widget, GdkEventButton *event,
-                                   gpointer user_data)
-{
-    (void)widget;
-    (void)user_data;
-    (void)event;
-    bot_pressed = false;
-    return TRUE;
-}
-
-static gboolean button_press_bot(GtkWidget *widget, GdkEventButton *event,
-                                 gpointer user_data)
-{
-    (void)user_data;
-
-    if (calc_get_mode() != calc_mode_integer)
-        return TRUE;
-
-    if (event->button != MOUSE_LEFT_BUT)
-        return TRUE;
-
-    if (bot_pressed)
-    {
-        /* filter out repeated press without a release in between */
-        return TRUE;
-    }
-    bot_pressed = true;
-
-    int bit_clicked = get_bit_clicked(widget, event);
-    if (bit_clicked < 0)
+    bit_clicked += row * BIN_ROW_BITS;
+    if (bit_clicked >= calc_get_integer_width())
         return TRUE;
 
-    calc_width_enum calc_width = calc_get_integer_width();
-    if (calc_width == calc_width_8)
-    {
-        if (bit_clicked > 7)
-            return TRUE;
-    }
-    else if (calc_width == calc_width_16)
-    {
-        if (bit_clicked > 15)
-            return TRUE;
-    }
-
     //printf("bit clicked %d\n", bit_clicked);
 
     gui_give_arg_if_pending();
-    calc_binary_bit_xor(1ULL << bit_clicked);
+    calc_binary_bit_xor((calc_int_t)1 << bit_clicked);
 
     return TRUE;
 }
@@ -296,66 +258,69 @@ GtkWidget *display_widget_create(const char *main_msg, const char *bin_msg)
     g_object_unref(provider);
 #endif
 
-    /* secondary binary display */
+    /* secondary binary display, top row first */
     if (bin_msg == NULL)
         bin_msg = bin_disp_unused;
 
-    top_eventbox = gtk_event_box_new();
-    gtk_event_box_set_above_child(GTK_EVENT_BOX(top_eventbox), TRUE);
-    gtk_event_box_set_visible_window(GTK_EVENT_BOX(top_eventbox), FALSE);
+#if TARGET_GTK_VERSION == 2
+    sprintf(font_str, "mono %d", config_get_bin_disp_fontsize());
+    pfd = pango_font_description_from_string(font_str);
+#elif TARGET_GTK_VERSION == 3
+    sprintf(font_str, "*{font-family: mono; font-size: %dpt;}", config_get_bin_disp_fontsize());
+    provider = gtk_css_provider_new();
+    gtk_css_provider_load_from_data(provider, font_str, -1, NULL);
+#endif
 
-    bin_display_top = gui_label_new(bin_msg, 1.0, 0.5);
-    gtk_widget_show(bin_display_top);
-    gtk_widget_show(top_eventbox);
+    for (int row = NUM_BIN_ROWS - 1; row >= 0; row--)
+    {
+        bin_eventbox[row] = gtk_event_box_new();
+        gtk_event_box_set_above_child(GTK_EVENT_BOX(bin_eventbox[row]), TRUE);
+        gtk_event_box_set_visible_window(GTK_EVENT_BOX(bin_eventbox[row]), FALSE);
 
-    gtk_container_add(GTK_CONTAINER(top_eventbox), bin_display_top);
-    gtk_box_pack_start(GTK_BOX(vbox), top_eventbox, FALSE, FALSE, 0);
+        bin_display[row] = gui_label_new(bin_msg, 1.0, 0.5);
+        gtk_widget_show(bin_display[row]);
+        if (row < MIN_BIN_ROWS)
+        {
+            gtk_widget_show(bin_eventbox[row]);
+        }
 
+        gtk_container_add(GTK_CONTAINER(bin_eventbox[row]), bin_display[row]);
+        gtk_box_pack_start(GTK_BOX(vbox), bin_eventbox[row], FALSE, FALSE, 0);
 
-    bot_eventbox = gtk_event_box_new();
-    gtk_event_box_set_above_child(GTK_EVENT_BOX(bot_eventbox), TRUE);
-    gtk_event_box_set_visible_window(GTK_EVENT_BOX(bot_eventbox), FALSE);
+#if TARGET_GTK_VERSION == 2
+        gtk_widget_modify_font(bin_display[row], pfd);
+#elif TARGET_GTK_VERSION == 3
+        context = gtk_widget_get_style_context(bin_display[row]);
+        gtk_style_context_add_provider(context, GTK_STYLE_PROVIDER(provider), GTK_STYLE_PROVIDER_PRIORITY_USER);
+#endif
 
-    bin_display_bot = gui_label_new(bin_msg, 1.0, 0.5);
-    gtk_widget_show(bin_display_bot);
-    gtk_widget_show(bot_eventbox);
+        gtk_widget_add_events(bin_eventbox[row],
+                              GDK_BUTTON_PRESS_MASK |
+                              GDK_BUTTON_RELEASE_MASK);
+        g_signal_connect(bin_eventbox[row], "button-press-event",
+                         G_CALLBACK(button_press), (gpointer)(uintptr_t)row);
+        g_signal_connect(bin_eventbox[row], "button-release-event",
+                         G_CALLBACK(button_release), (gpointer)(uintptr_t)row);
+        bin_pressed[row] = false;
+    }
+    bin_rows_shown = MIN_BIN_ROWS;
 
-    gtk_container_add(GTK_CONTAINER(bot_eventbox), bin_display_bot);
-    gtk_box_pack_start(GTK_BOX(vbox), bot_eventbox, FALSE, FALSE, 0);
+    /* not shown until fixed point, lanes or the IEEE 754 view is in use */
+    value_display = gui_label_new("", 1.0, 0.5);
+    gtk_box_pack_start(GTK_BOX(vbox), value_display, FALSE, FALSE, 0);
+#if TARGET_GTK_VERSION == 2
+    gtk_widget_modify_font(value_display, pfd);
+#elif TARGET_GTK_VERSION == 3
+    context = gtk_widget_get_style_context(value_display);
+    gtk_style_context_add_provider(context, GTK_STYLE_PROVIDER(provider), GTK_STYLE_PROVIDER_PRIORITY_USER);
+#endif
 
 #if TARGET_GTK_VERSION == 2
-    sprintf(font_str, "mono %d", config_get_bin_disp_fontsize());
-    pfd = pango_font_description_from_string(font_str);
-    gtk_widget_modify_font(bin_display_top, pfd);
-    gtk_widget_modify_font(bin_display_bot, pfd);
     pango_font_description_free(pfd);
 #elif TARGET_GTK_VERSION == 3
-    sprintf(font_str, "*{font-family: mono; font-size: %dpt;}", config_get_bin_disp_fontsize());
-    provider = gtk_css_provider_new();
-    gtk_css_provider_load_from_data(provider, font_str, -1, NULL);
-    context = gtk_widget_get_style_context(bin_display_top);
-    gtk_style_context_add_provider(context, GTK_STYLE_PROVIDER(provider), GTK_STYLE_PROVIDER_PRIORITY_USER);
-    context = gtk_widget_get_style_context(bin_display_bot);
-    gtk_style_context_add_provider(context, GTK_STYLE_PROVIDER(provider), GTK_STYLE_PROVIDER_PRIORITY_USER);
     g_object_unref(provider);
 #endif
 
-    gtk_widget_add_events(top_eventbox,
-                          GDK_BUTTON_PRESS_MASK |
-                          GDK_BUTTON_RELEASE_MASK);
-    g_signal_connect(top_eventbox, "button-press-event",
-                     G_CALLBACK(button_press_top), NULL);
-    g_signal_connect(top_eventbox, "button-release-event",
-                     G_CALLBACK(button_release_top), NULL);
-
-    gtk_widget_add_events(bot_eventbox,
-                          GDK_BUTTON_PRESS_MASK |
-                          GDK_BUTTON_RELEASE_MASK);
-    g_signal_connect(bot_eventbox, "button-press-event",
-                     G_CALLBACK(button_press_bot), NULL);
-    g_signal_connect(bot_eventbox, "button-release-event",
-                     G_CALLBACK(button_release_bot), NULL);
-
     return vbox;
 }
 
@@ -397,7 +362,7 @@ void display_widget_main_set_text(const char *msg)
     }
 }
 
-static void display_widget_bin_set_text_top(const char *msg)
+static void display_widget_bin_set_text(int row, const char *msg)
 {
     if (msg == NULL)
     {
@@ -407,108 +372,302 @@ static void display_widget_bin_set_text_top(const char *msg)
     {
         char m[MAX_REPLACE_SIZE];
         replace_zero_with_o(m, msg);
-        gtk_label_set_text(GTK_LABEL(bin_display_top), m);
+        gtk_label_set_text(GTK_LABEL(bin_display[row]), m);
     }
     else
     {
-        gtk_label_set_text(GTK_LABEL(bin_display_top), msg);
+        gtk_label_set_text(GTK_LABEL(bin_display[row]), msg);
     }
 }
 
-static void display_widget_bin_set_text_bot(const char *msg)
+/* position in a row of the digit for bit (0 - 31) */
+static int bin_char_pos(int bit)
 {
-    if (msg == NULL)
-    {
-        msg = bin_disp_unused;
-    }
+    /* digit within the byte counting from the left, and the hyphen */
+    int d = 7 - bit % 8;
+    return (3 - bit / 8) * 11 + d + (d >= 4 ? 1 : 0);
+}
+
+/* one row with the digits of the bits in highlight shown bold and underlined,
+ * each one needing <b><u></u></b> around it */
+#define BIN_MARKUP_CHARS (BIN_ROW_CHARS + BIN_ROW_BITS * 14)
+static void display_widget_bin_set_markup(int row, const char *msg,
+                                          uint32_t highlight)
+{
+    char m[MAX_REPLACE_SIZE];
+    char markup[BIN_MARKUP_CHARS + 1];
+    bool hl_pos[BIN_ROW_CHARS] = { false };
+    char *p = markup;
+
     if (config_get_replace_zero_with_o())
     {
-        char m[MAX_REPLACE_SIZE];
         replace_zero_with_o(m, msg);
-        gtk_label_set_text(GTK_LABEL(bin_display_bot), m);
+        msg = m;
     }
-    else
+    for (int bit = 0; bit < BIN_ROW_BITS; bit++)
     {
-        gtk_label_set_text(GTK_LABEL(bin_display_bot), msg);
+        if (highlight & ((uint32_t)1 << bit))
+        {
+            hl_pos[bin_char_pos(bit)] = true;
+        }
     }
+    /* the row is only digits, hyphens and spaces, nothing to escape */
+    for (int i = 0; msg[i] != '\0'; i++)
+    {
+        if (hl_pos[i])
+        {
+            p += sprintf(p, "<b><u>%c</u></b>", msg[i]);
+        }
+        else
+        {
+            *p++ = msg[i];
+        }
+    }
+    *p = '\0';
+    gtk_label_set_markup(GTK_LABEL(bin_display[row]), markup);
 }
 
-static void set_bin_display(uint64_t ival, calc_width_enum width)
+/* Set one row to the 32 bits of val, where only the low bits bits are in
+ * use and the rest are spaces. Bits in highlight are made to stand out. */
+static void set_bin_row(int row, uint32_t val, int bits, uint32_t highlight)
 {
-    char *p;
-    int bytes;
-    int unused_bytes;
-
-    if (width == calc_width_8)
-        bytes = 1;
-    else if (width == calc_width_16)
-        bytes = 2;
-    else if (width == calc_width_32)
-        bytes = 4;
+    char str[BIN_ROW_CHARS + 1];
+    char *p = str;
+
+    /* each byte from the top, the 8 digits from the lookup table */
+    for (int i = 3; i >= 0; i--)
+    {
+        char b[8];
+        radix_print_byte_bin(b, (uint8_t)(val >> (i * 8)));
+        memcpy(p, b, 4);
+        p[4] = '-';
+        memcpy(p + 5, b + 4, 4);
+        p += 9;
+        if (i > 0)
+        {
+            *p++ = ' ';
+            *p++ = ' ';
+        }
+    }
+    *p = 0;
+
+    if (bits <= 0)
+    {
+        memset(str, ' ', BIN_ROW_CHARS);
+        highlight = 0;
+    }
+    else if (bits < BIN_ROW_BITS)
+    {
+        memset(str, ' ', bin_char_pos(bits - 1));
+        highlight &= ((uint32_t)1 << bits) - 1;
+    }
+    if (highlight != 0)
+    {
+        display_widget_bin_set_markup(row, str, highlight);
+    }
     else
-        bytes = 8;
+    {
+        display_widget_bin_set_text(row, str);
+    }
+}
 
-    unused_bytes = MAX_BIN_BYTES - bytes;
+static void set_bin_display(calc_int_t ival, calc_width_t width,
+                            calc_int_t highlight)
+{
+    int rows = (width + BIN_ROW_BITS - 1) / BIN_ROW_BITS;
 
-    /* fill in 1s and 0s working backwards */
-    p = bin_disp_str_spaced + MAX_BIN_CHARS_PLUS_SPACES_PLUS_NULL;
-    for (int i = 0; i < bytes; i++)
+    if (rows < MIN_BIN_ROWS)
     {
-        if (i == 0)
+        rows = MIN_BIN_ROWS;
+    }
+
+    /* sanity check */
+    if (!calc_util_is_in_unsigned_range(ival, width))
+    {
+        fprintf(stderr, "display width mask error\n");
+    }
+
+    for (int row = 0; row < rows; row++)
+    {
+        set_bin_row(row, (uint32_t)(ival >> (row * BIN_ROW_BITS)),
+                    width - row * BIN_ROW_BITS,
+                    (uint32_t)(highlight >> (row * BIN_ROW_BITS)));
+    }
+
+    /* only show or hide rows when the number needed changes */
+    for (int row = MIN_BIN_ROWS; row < NUM_BIN_ROWS; row++)
+    {
+        if (row < rows && row >= bin_rows_shown)
         {
-            /* null terminate */
-            *--p = 0;
+            gtk_widget_show(bin_eventbox[row]);
         }
-        else
+        else if (row >= rows && row < bin_rows_shown)
+        {
+            gtk_widget_hide(bin_eventbox[row]);
+        }
+    }
+    bin_rows_shown = rows;
+}
+
+/* eg. binary32  +  exp 130 (2^3)
+ *      = 10 */
+static void set_ieee_display(calc_int_t ival)
+{
+    char buf[DFP_STRING_MAX + 60];
+    const ieee_format_t *fmt = ieee_get_format(ieee_format);
+    ieee_fields_t fields;
+    stackf_t fval;
+    int len;
+
+    ieee_decode(ieee_format, ival, &fields);
+    len = sprintf(buf, "%s  %c  ", fmt->name, fields.sign ? '-' : '+');
+    switch (fields.cls)
+    {
+        case ieee_nan:
+            sprintf(buf + len, "NaN");
+            break;
+        case ieee_infinite:
+            sprintf(buf + len, "Inf");
+            break;
+        case ieee_zero:
+            sprintf(buf + len, "zero");
+            break;
+        default:
+            len += sprintf(buf + len, "%sexp %d (2^%d)\n= ",
+                           fields.cls == ieee_subnormal ? "subnormal " : "",
+                           fields.biased_exp, fields.exp);
+            ieee_to_dfp(ieee_format, ival, &fval);
+            display_print_gmode(buf + len, fval, VALUE_DIGITS);
+            break;
+    }
+    gtk_label_set_text(GTK_LABEL(value_display), buf);
+    gtk_widget_show(value_display);
+}
+
+/* each lane in decimal, the top lane first as on the binary display, eg.
+ * i8 x 4:  -1  2  3  127 */
+#define LANES_PER_LINE 8
+static void set_lanes_display(calc_int_t ival, calc_width_t width)
+{
+    /* 16 lanes of up to 4 chars, or 2 of up to 20 */
+    char buf[200];
+    int lanes = calc_get_lanes();
+    bool use_unsigned = calc_get_use_unsigned();
+    calc_int_t lane_mask = calc_util_width_mask(lanes);
+    char *p = buf;
+
+    p += sprintf(p, "%c%d x %d:", use_unsigned ? 'u' : 'i', lanes,
+                 width / lanes);
+    for (int i = width / lanes - 1; i >= 0; i--)
+    {
+        calc_int_t x = (ival >> (i * lanes)) & lane_mask;
+        if (i != width / lanes - 1 && (i + 1) % LANES_PER_LINE == 0)
         {
-            /* add 2 spaces between each byte */
-            *--p = ' ';
-            *--p = ' ';
+            *p++ = '\n';
         }
-        /* nybble */
-        for (int j = 0; j < 4; j++)
+        else
         {
-            int digit = ival & 1;
-            *--p = digit + '0';
-            ival >>= 1;
+            *p++ = ' ';
         }
-        /* add hyphen */
-        *--p = '-';
-        /* nybble */
-        for (int j = 0; j < 4; j++)
+        *p++ = ' ';
+        if (!use_unsigned && calc_util_get_signed(x, lanes) < 0)
         {
-            int digit = ival & 1;
-            *--p = digit + '0';
-            ival >>= 1;
+            *p++ = '-';
+            x = (0 - x) & lane_mask;
         }
+        p += radix_print(p, x, 10, 1, 0, NULL);
     }
-    for (int i = 0; i < unused_bytes; i++)
+    gtk_label_set_text(GTK_LABEL(value_display), buf);
+    gtk_widget_show(value_display);
+}
+
+/* eg. Q15.16 = 1.25, UQ16.16 for unsigned */
+static void set_value_display(calc_int_t ival, calc_width_t width)
+{
+    char buf[DFP_STRING_MAX + 40];
+    int frac = calc_get_fixed_point_frac();
+    bool use_unsigned = calc_get_use_unsigned();
+    stackf_t fval;
+    int len;
+
+    if (ieee_format >= 0)
     {
-        /* add spaces between each byte */
-        *--p = ' ';
-        *--p = ' ';
-        /* 9 to allow for what would have been the hyphen between nybbles */
-        for (int j = 0; j < 9; j++)
-        {
-            /* whatever character you want to use to represent unused bit */
-            *--p = ' ';
-        }
+        set_ieee_display(ival);
+        return;
     }
-    /* sanity check */
-    if (ival != 0 || p != bin_disp_str_spaced)
+    if (calc_get_lanes() != 0 && width % calc_get_lanes() == 0)
     {
-        fprintf(stderr, "display width mask error\n");
+        set_lanes_display(ival, width);
+        return;
+    }
+    if (frac == 0)
+    {
+        gtk_widget_hide(value_display);
+        return;
     }
+    calc_fixed_to_dfp(ival, &fval);
+    len = sprintf(buf, "%sQ%d.%d = ", use_unsigned ? "U" : "",
+                  width - frac - (use_unsigned ? 0 : 1), frac);
+    display_print_gmode(buf + len, fval, VALUE_DIGITS);
+    gtk_label_set_text(GTK_LABEL(value_display), buf);
+    gtk_widget_show(value_display);
+}
 
-    /* So the whole 64 bit number is in one array, now split into top and bot
-     * display, top display is the higher 32 bits ie. the leftmost bits in the
-     * array. */
-    bin_disp_str_spaced[42] = '\0';
-    display_widget_bin_set_text_top(bin_disp_str_spaced);
-    display_widget_bin_set_text_bot(bin_disp_str_spaced + 44);
+/* the exponent field is underlined in the IEEE 754 view */
+static calc_int_t ieee_exponent_bits(calc_width_t width)
+{
+    if (ieee_format < 0)
+    {
+        return 0;
+    }
+    const ieee_format_t *fmt = ieee_get_format(ieee_format);
+    calc_int_t mask = (((calc_int_t)1 << fmt->exp_bits) - 1) << fmt->mant_bits;
+    return mask & calc_util_width_mask(width);
+}
+
+void display_widget_bin_set_val(calc_int_t ival, calc_width_t width)
+{
+    /* mouse over the main display shows the value in all the bases */
+    char multi[RADIX_MULTI_MAX];
+
+    set_bin_display(ival, width, ieee_exponent_bits(width));
+    radix_print_multi(multi, ival, width, !calc_get_use_unsigned());
+    gtk_widget_set_tooltip_text(display, multi);
+    set_value_display(ival, width);
+    last_ival = ival;
+    last_width = width;
+    last_valid = true;
+}
+
+void display_widget_bin_set_highlight(calc_int_t ival, calc_width_t width,
+                                      calc_int_t highlight)
+{
+    set_bin_display(ival, width, highlight);
 }
 
-void display_widget_bin_set_val(uint64_t ival, calc_width_enum width)
+void display_widget_bin_clear(void)
 {
-    set_bin_display(ival, width);
+    gtk_widget_set_tooltip_text(display, NULL);
+    gtk_widget_hide(value_display);
+    last_valid = false;
+}
+
+void display_widget_set_fraction(const char *text)
+{
+    if (text == NULL)
+    {
+        gtk_widget_hide(value_display);
+        return;
+    }
+    gtk_label_set_text(GTK_LABEL(value_display), text);
+    gtk_widget_show(value_display);
+}
+
+void display_widget_set_ieee_format(int format)
+{
+    ieee_format = format;
+    if (last_valid)
+    {
+        display_widget_bin_set_val(last_ival, last_width);
+    }
 }
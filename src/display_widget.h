@@ -31,7 +31,27 @@ GtkWidget *display_widget_create(const char *main_msg, const char *bin_msg);
 /* set text on the main display */
 void display_widget_main_set_text(const char *msg);
 
-/* set value on the binary display */
-void display_widget_bin_set_val(uint64_t ival, calc_width_enum width);
+/* set value on the binary display, and the multi base view shown when the
+ * mouse is over the main display */
+void display_widget_bin_set_val(calc_int_t ival, calc_width_t width);
+
+/* show ival on the binary display with the bits in highlight made to stand
+ * out, eg. the bits an operation counted. Only until the next
+ * display_widget_bin_set_val. */
+void display_widget_bin_set_highlight(calc_int_t ival, calc_width_t width,
+                                      calc_int_t highlight);
+
+/* remove the multi base view, when not in integer mode */
+void display_widget_bin_clear(void);
+
+/* View the integer value as a binary float of the format (an
+ * ieee_format_enum), -1 for off. The exponent bits are underlined on the
+ * binary display and the fields and value shown under it. */
+void display_widget_set_ieee_format(int format);
+
+/* In floating mode, text under the main display for the exact fraction in
+ * rational mode, NULL to remove it. Removed by the next main display
+ * update. */
+void display_widget_set_fraction(const char *text);
 
 #endif
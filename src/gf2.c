@@ -0,0 +1,157 @@
+/*****************************************************************************
+ * File gf2.c part of ProgAndSciCalc
+ *
+ * Copyright (C) 2018 Ken Bromham
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdint.h>
+
+#include "gf2.h"
+#include "bitops.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define GF2_X86
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+typedef unsigned __int128 u128;
+
+
+/* portable 64 x 64 carry-less multiply, using a table of a times each
+ * 4 bit polynomial and taking b a nybble at a time from the top */
+static u128 clmul64_sw(uint64_t a, uint64_t b)
+{
+    u128 tab[16];
+    u128 r = 0;
+
+    tab[0] = 0;
+    tab[1] = a;
+    for (int i = 2; i < 16; i += 2)
+    {
+        tab[i] = tab[i / 2] << 1;
+        tab[i + 1] = tab[i] ^ a;
+    }
+    for (int i = 60; i >= 0; i -= 4)
+    {
+        r = (r << 4) ^ tab[(b >> i) & 0xf];
+    }
+    return r;
+}
+
+#ifdef GF2_X86
+
+/* Compiled for the instruction whatever the build flags, and only called
+ * when cpuid says it's there */
+__attribute__((target("pclmul")))
+static u128 clmul64_hw(uint64_t a, uint64_t b)
+{
+    uint64_t r[2];
+    __m128i p = _mm_clmulepi64_si128(_mm_cvtsi64_si128((long long)a),
+                                     _mm_cvtsi64_si128((long long)b), 0x00);
+    _mm_storeu_si128((__m128i *)r, p);
+    return ((u128)r[1] << 64) | r[0];
+}
+
+/* CPUID.1:ECX.PCLMULQDQ[bit 1] */
+static bool have_pclmul(void)
+{
+    unsigned int a, b, c, d;
+    return __get_cpuid(1, &a, &b, &c, &d) && (c & (1u << 1));
+}
+#endif
+
+
+static u128 (*clmul64)(uint64_t a, uint64_t b);
+static bool use_hardware = true;
+
+static void select_impl(void)
+{
+    clmul64 = clmul64_sw;
+#ifdef GF2_X86
+    if (use_hardware && have_pclmul())
+    {
+        clmul64 = clmul64_hw;
+    }
+#endif
+}
+
+void gf2_use_hardware(bool enable)
+{
+    use_hardware = enable;
+    select_impl();
+}
+
+bool gf2_using_hardware(void)
+{
+    if (clmul64 == NULL)
+    {
+        select_impl();
+    }
+    return clmul64 != clmul64_sw;
+}
+
+
+void gf2_clmul(u128 a, u128 b, u128 *lo, u128 *hi)
+{
+    uint64_t a0 = (uint64_t)a, a1 = (uint64_t)(a >> 64);
+    uint64_t b0 = (uint64_t)b, b1 = (uint64_t)(b >> 64);
+    u128 low, mid, high;
+
+    if (clmul64 == NULL)
+    {
+        select_impl();
+    }
+
+    /* Karatsuba, with no carries the middle term is just
+     * (a0 + a1)(b0 + b1) - a0 b0 - a1 b1 in xors */
+    low = clmul64(a0, b0);
+    high = clmul64(a1, b1);
+    mid = clmul64(a0 ^ a1, b0 ^ b1) ^ low ^ high;
+
+    *lo = low ^ (mid << 64);
+    *hi = high ^ (mid >> 64);
+}
+
+int gf2_degree(u128 a)
+{
+    return 127 - bitops_clz(a, 128);
+}
+
+u128 gf2_mod(u128 a, u128 m)
+{
+    int dm = gf2_degree(m);
+    int da;
+
+    /* take off m times the leading term of a until a is of lower degree */
+    while ((da = gf2_degree(a)) >= dm)
+    {
+        a ^= m << (da - dm);
+    }
+    return a;
+}
+
+u128 gf2_gcd(u128 a, u128 b)
+{
+    while (b != 0)
+    {
+        u128 temp = b;
+        b = gf2_mod(a, b);
+        a = temp;
+    }
+    return a;
+}
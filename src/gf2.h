@@ -0,0 +1,53 @@
+/*****************************************************************************
+ * File gf2.h part of ProgAndSciCalc
+ *
+ * Copyright (C) 2018 Ken Bromham
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef GF2_H
+#define GF2_H
+
+#include <stdbool.h>
+
+/* Polynomials over GF(2) held as bit patterns, bit i the coefficient of
+ * x^i, so add and subtract are both xor and multiply is carry-less.
+ *
+ * On x86 the multiply uses the PCLMULQDQ instruction when the CPU has it
+ * (checked once with cpuid), otherwise a portable version a nybble at a
+ * time. */
+
+/* the full 256 bit carry-less product of a and b */
+void gf2_clmul(unsigned __int128 a, unsigned __int128 b,
+               unsigned __int128 *lo, unsigned __int128 *hi);
+
+/* degree of a, -1 for the zero polynomial */
+int gf2_degree(unsigned __int128 a);
+
+/* remainder of a divided by m, m must not be 0 */
+unsigned __int128 gf2_mod(unsigned __int128 a, unsigned __int128 m);
+
+/* greatest common divisor, 0 only if both are 0 */
+unsigned __int128 gf2_gcd(unsigned __int128 a, unsigned __int128 b);
+
+/* false to use the portable code even when the instruction is there, for
+ * testing */
+void gf2_use_hardware(bool enable);
+
+/* true if PCLMULQDQ is being used */
+bool gf2_using_hardware(void);
+
+#endif
@@ -22,6 +22,10 @@
 #include <inttypes.h>
 #include "gui_internal.h"
 #include "display_print.h"
+#include "dfp_int.h"
+#include "radix_print.h"
+#include "ntheory.h"
+#include "bitops.h"
 
 
 /* decimal or hex when in integer mode */
@@ -92,6 +96,8 @@ typedef enum
     bid_rsft,  /* right shift 1 place (unary op) */
     bid_rol, /* rotate (circular shift) left 1 place */
     bid_ror, /* rotate (circular shift) right 1 place */
+    bid_bits, /* menu of bit counting ops, popcount etc */
+    bid_ntheory, /* menu of number theory ops, primes, factor etc */
 
     bid_ms,   /* memory store */
     bid_mr,   /* memory recall */
@@ -169,12 +175,13 @@ static int float_digits_from_id(float_digits_enum fd)
 }
 
 /* Info for integer width radio buttons */
-const INT_WIDTH_RB int_width_rb[num_calc_widths] =
+const INT_WIDTH_RB int_width_rb[NUM_INT_WIDTH_RB] =
 {
-    { "8",  calc_width_8 },
-    { "16", calc_width_16 },
-    { "32", calc_width_32 },
-    { "64", calc_width_64 },
+    { "8",   8 },
+    { "16",  16 },
+    { "32",  32 },
+    { "64",  64 },
+    { "128", 128 },
 };
 
 /* Info for integer signed/unsigned radio buttons */
@@ -193,7 +200,10 @@ static GtkWidget *lbl_pending_bin_op;
 static GtkWidget *but_backspace;
 static GtkWidget *but_repeat_eq;
 static GtkWidget *but_grid[bid_num_displayable];
-static GtkWidget *rbut_int_width[num_calc_widths];
+static GtkWidget *rbut_int_width[NUM_INT_WIDTH_RB];
+/* "other" radio button and the entry for its width */
+static GtkWidget *rbut_int_width_other;
+static GtkWidget *entry_int_width;
 static GtkWidget *rbut_int_signed[NUM_INT_SIGNED_RB];
 /* Used when creating the button grid, for either deg/rad/grad or dec/hex */
 static GSList *rb_list_grid;
@@ -206,9 +216,10 @@ static void set_angle_buttons(button_id_enum bid);
 static void update_status_label(void);
 static void update_mem_label(void);
 static void update_mem_tooltip(unsigned int m);
-static void gui_result_callback(uint64_t ival, stackf_t fval, calc_op_enum bop_cop);
-static void gui_history_callback(uint64_t ival, stackf_t fval);
+static void gui_result_callback(calc_int_t ival, stackf_t fval, calc_op_enum bop_cop);
+static void gui_history_callback(calc_int_t ival, stackf_t fval);
 static void gui_set_num_used_parentheses(int n);
+static void dialog_response(GtkDialog *dialog, gint response_id, gpointer data);
 static void gui_warn(const char *msg);
 static void gui_error(const char *msg);
 static void set_inv_button(bool selected);
@@ -261,7 +272,7 @@ static const button_info binfo_left_float[BT_ROWS][BT_COLS] =
 /* LEFT table in integer mode */
 static const button_info binfo_left_int[BT_ROWS][BT_COLS] =
 {
-    { {"DEC", bid_dec, 0},           {"HEX", bid_hex, 0},            {NULL, bid_blank, 0} },
+    { {"DEC", bid_dec, 0},           {"HEX", bid_hex, 0},            {"bits", bid_bits, 0} },
     { {"rol", bid_rol, cop_rol},     {"<<", bid_lsft, cop_lsft},     {">>", bid_rsft, cop_rsft} },
     { {"ror", bid_ror, cop_ror},     {"<< n", bid_lsftn, cop_lsftn}, {">> n", bid_rsftn, cop_rsftn} },
     { {"and", bid_and, cop_and},     {"or", bid_or, cop_or},         {"xor", bid_xor, cop_xor} },
@@ -283,12 +294,12 @@ static const button_info binfo_main_float[BT_ROWS][BT_COLS] =
 /* CENTRE table in integer mode, not quite the same */
 static const button_info binfo_main_int[BT_ROWS][BT_COLS] =
 {
-    { {NULL, bid_blank, 0}, {"MODE", bid_flip, 0},      {NULL, bid_blank, 0} },
-    { {NULL, bid_blank, 0}, {"HIST", bid_hist, 0},      {NULL, bid_blank, 0} },
-    { {"7", bid_7, 0},      {"8", bid_8, 0},            {"9", bid_9, 0} },
-    { {"4", bid_4, 0},      {"5", bid_5, 0},            {"6", bid_6, 0} },
-    { {"1", bid_1, 0},      {"2", bid_2, 0},            {"3", bid_3, 0} },
-    { {"0", bid_0, 0},      {"not", bid_com, cop_com},  {"+/-", bid_pm, cop_pm} },
+    { {"num", bid_ntheory, 0}, {"MODE", bid_flip, 0},      {NULL, bid_blank, 0} },
+    { {NULL, bid_blank, 0},    {"HIST", bid_hist, 0},      {NULL, bid_blank, 0} },
+    { {"7", bid_7, 0},         {"8", bid_8, 0},            {"9", bid_9, 0} },
+    { {"4", bid_4, 0},         {"5", bid_5, 0},            {"6", bid_6, 0} },
+    { {"1", bid_1, 0},         {"2", bid_2, 0},            {"3", bid_3, 0} },
+    { {"0", bid_0, 0},         {"not", bid_com, cop_com},  {"+/-", bid_pm, cop_pm} },
 };
 
 /* RIGHT table in float mode */
@@ -323,7 +334,7 @@ static bool digit_entered(const button_info *binfo)
     if (!arg_pending)
     {
         /* start a new argument */
-        last_float_format = disp_float_gmode;
+        last_float_format = display_get_normal_float_format();
         display_set_text(binfo->name);
         arg_pending = true;
         gtk_widget_set_sensitive(but_backspace, TRUE);
@@ -339,7 +350,7 @@ static bool digit_entered(const button_info *binfo)
 /* helper function to pass arg to calculator */
 static void give_arg_if_pending(void)
 {
-    uint64_t ival;
+    calc_int_t ival;
     stackf_t fval;
 
     if (arg_pending)
@@ -358,7 +369,7 @@ static void enter_point(void)
 
     if (!arg_pending)
     {
-        last_float_format = disp_float_gmode;
+        last_float_format = display_get_normal_float_format();
         display_set_text("0.");
         arg_pending = true;
         gtk_widget_set_sensitive(but_backspace, TRUE);
@@ -446,6 +457,283 @@ static void mode_toggle(void)
 }
 
 
+/* The bit ops, from the menu under the bits button, a NULL name is a
+ * separator */
+typedef struct
+{
+    const char *name;
+    calc_op_enum cop;
+} bits_menu_item;
+
+static const bits_menu_item bits_menu_items[] =
+{
+    {"popcount", cop_popcnt},
+    {"clz", cop_clz},
+    {"ctz", cop_ctz},
+    {"parity", cop_parity},
+    {"bit reverse", cop_bitrev},
+    {"byte swap", cop_bswap},
+    {NULL, 0},
+    {"pdep (deposit)", cop_pdep},
+    {"pext (extract)", cop_pext},
+    {NULL, 0},
+    {"morton 2-D", cop_morton2},
+    {"spread 2", cop_spread2},
+    {"compact 2", cop_compact2},
+    {"spread 3", cop_spread3},
+    {"compact 3", cop_compact3},
+    {NULL, 0},
+    {"clmul (carry-less mul)", cop_clmul},
+    {"clmulh (high half)", cop_clmulh},
+    {"GF(2) mod", cop_gf2mod},
+    {"GF(2) gcd", cop_gf2gcd},
+    {NULL, 0},
+    {"lane add (saturate)", cop_lane_adds},
+    {"lane sub (saturate)", cop_lane_subs},
+    {"lane min", cop_lane_min},
+    {"lane max", cop_lane_max},
+    {"lane compare =", cop_lane_cmpeq},
+    {"lane compare >", cop_lane_cmpgt},
+};
+#define NUM_BITS_MENU_ITEMS (int)(sizeof(bits_menu_items) / sizeof(bits_menu_items[0]))
+
+/* the menu is not part of the main window, so is made once and kept */
+static GtkWidget *bits_menu;
+
+/* the bits of arg that the op looked at, to be highlighted on the binary
+ * display */
+static calc_int_t bits_highlight(calc_op_enum cop, calc_int_t arg,
+                                 calc_width_t width)
+{
+    calc_int_t mask = calc_util_width_mask(width);
+    int n;
+
+    switch (cop)
+    {
+        case cop_popcnt:
+        case cop_parity:
+            return arg;
+        case cop_clz:
+            /* the leading zeros */
+            n = bitops_clz(arg, width);
+            return n >= width ? mask : mask ^ (mask >> n);
+        case cop_ctz:
+            /* the trailing zeros */
+            n = bitops_ctz(arg, width);
+            return n >= width ? mask : ((calc_int_t)1 << n) - 1;
+        default:
+            return 0;
+    }
+}
+
+static void bits_menu_activate(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    const bits_menu_item *item = data;
+    calc_int_t arg;
+    stackf_t fval;
+    calc_int_t highlight;
+
+    give_arg_if_pending();
+    display_get_val(&arg, &fval);
+    highlight = bits_highlight(item->cop, arg, calc_get_integer_width());
+    calc_give_op(item->cop);
+
+    /* The binary display shows the arg with the counted bits picked out,
+     * rather than the count, until the next update. */
+    if (highlight != 0)
+    {
+        display_widget_bin_set_highlight(arg, calc_get_integer_width(),
+                                         highlight);
+    }
+}
+
+/* make a menu of ops from a table, for the bits and num buttons */
+static GtkWidget *op_menu_new(const bits_menu_item *items, int num_items,
+                              GCallback activate)
+{
+    GtkWidget *menu = gtk_menu_new();
+
+    for (int i = 0; i < num_items; i++)
+    {
+        GtkWidget *mi;
+        if (items[i].name == NULL)
+        {
+            mi = gtk_separator_menu_item_new();
+            gtk_menu_shell_append(GTK_MENU_SHELL(menu), mi);
+            continue;
+        }
+        mi = gtk_menu_item_new_with_label(items[i].name);
+        gtk_menu_shell_append(GTK_MENU_SHELL(menu), mi);
+        g_signal_connect(G_OBJECT(mi), "activate", activate,
+                         (gpointer)&items[i]);
+    }
+    return menu;
+}
+
+static void lanes_activate(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    gui_lanes_open();
+}
+
+static void bits_menu_popup(void)
+{
+    if (bits_menu == NULL)
+    {
+        GtkWidget *mi;
+        bits_menu = op_menu_new(bits_menu_items, NUM_BITS_MENU_ITEMS,
+                                G_CALLBACK(bits_menu_activate));
+        mi = gtk_menu_item_new_with_label("lanes...");
+        gtk_menu_shell_append(GTK_MENU_SHELL(bits_menu), mi);
+        g_signal_connect(G_OBJECT(mi), "activate",
+                         G_CALLBACK(lanes_activate), NULL);
+        gtk_widget_show_all(bits_menu);
+    }
+    gtk_menu_popup(GTK_MENU(bits_menu), NULL, NULL, NULL, NULL, 0,
+                   gtk_get_current_event_time());
+}
+
+
+/* The number theory ops, from the menu under the num button. Factor isn't
+ * a calculator op as the result is a list, it's shown in a dialog. The
+ * mod m ops need a modulus, set in the window from mod m... */
+static const bits_menu_item ntheory_menu_items[] =
+{
+    {"is prime", cop_isprime},
+    {"next prime", cop_nextprime},
+    {NULL, 0},
+    {"isqrt", cop_sqrt},
+    {"icbrt", cop_icbrt},
+    {"ilog2", cop_ilog2},
+    {"ilog10", cop_ilog10},
+    {NULL, 0},
+    {"x^y mod m", cop_pow},
+    {"1/x mod m", cop_onedx},
+    {"discrete log", cop_dlog},
+};
+#define NUM_NTHEORY_MENU_ITEMS (int)(sizeof(ntheory_menu_items) / sizeof(ntheory_menu_items[0]))
+
+static GtkWidget *ntheory_menu;
+
+static void ntheory_menu_activate(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    const bits_menu_item *item = data;
+
+    calc_give_op(item->cop);
+}
+
+/* append a value in decimal, with ^n if n > 1 */
+static char *factor_print(char *p, calc_int_t val, int n)
+{
+    p += radix_print(p, val, 10, 1, 0, NULL);
+    if (n > 1)
+    {
+        p += sprintf(p, "^%d", n);
+    }
+    return p;
+}
+
+/* show the prime factors of the displayed value, as eg. 360 = 2^3 * 3^2 * 5 */
+static void factor_activate(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+    calc_int_t arg;
+    stackf_t fval;
+    calc_int_t factors[NT_MAX_FACTORS];
+    int num;
+    bool complete;
+    /* there can be at most 26 different primes, of up to 39 digits */
+    char buf[26 * 50 + 200];
+    char *p = buf;
+    GtkWidget *dialog;
+
+    give_arg_if_pending();
+    display_get_val(&arg, &fval);
+    if (!calc_get_use_unsigned() &&
+        calc_util_get_signed(arg, calc_get_integer_width()) < 0)
+    {
+        arg = (0 - arg) & calc_util_width_mask(calc_get_integer_width());
+        *p++ = '-';
+    }
+    p = factor_print(p, arg, 1);
+
+    num = nt_factor(arg, factors, &complete);
+    if (num == 0)
+    {
+        sprintf(p, " has no prime factors");
+    }
+    else
+    {
+        p += sprintf(p, " = %s", buf[0] == '-' ? "-1 * " : "");
+        for (int i = 0; i < num;)
+        {
+            int n = 1;
+            while (i + n < num && factors[i + n] == factors[i])
+            {
+                n++;
+            }
+            if (i > 0)
+            {
+                p += sprintf(p, " * ");
+            }
+            p = factor_print(p, factors[i], n);
+            i += n;
+        }
+        if (!complete)
+        {
+            sprintf(p, "\n\n(the last factor is composite, too slow to split)");
+        }
+    }
+
+    dialog = gtk_message_dialog_new(
+                GTK_WINDOW(window_main),
+                GTK_DIALOG_MODAL | GTK_DIALOG_DESTROY_WITH_PARENT,
+                GTK_MESSAGE_INFO,
+                GTK_BUTTONS_OK,
+                "%s", buf);
+    g_signal_connect(dialog, "response",
+                     G_CALLBACK(dialog_response), NULL);
+    gtk_window_set_title(GTK_WINDOW(dialog), "Prime Factors");
+    gtk_widget_show(dialog);
+}
+
+static void modular_activate(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    gui_modular_open();
+}
+
+static void ntheory_menu_popup(void)
+{
+    if (ntheory_menu == NULL)
+    {
+        GtkWidget *mi;
+        ntheory_menu = op_menu_new(ntheory_menu_items, NUM_NTHEORY_MENU_ITEMS,
+                                   G_CALLBACK(ntheory_menu_activate));
+        mi = gtk_separator_menu_item_new();
+        gtk_menu_shell_append(GTK_MENU_SHELL(ntheory_menu), mi);
+        mi = gtk_menu_item_new_with_label("factor");
+        gtk_menu_shell_append(GTK_MENU_SHELL(ntheory_menu), mi);
+        g_signal_connect(G_OBJECT(mi), "activate",
+                         G_CALLBACK(factor_activate), NULL);
+        mi = gtk_menu_item_new_with_label("mod m...");
+        gtk_menu_shell_append(GTK_MENU_SHELL(ntheory_menu), mi);
+        g_signal_connect(G_OBJECT(mi), "activate",
+                         G_CALLBACK(modular_activate), NULL);
+        gtk_widget_show_all(ntheory_menu);
+    }
+    gtk_menu_popup(GTK_MENU(ntheory_menu), NULL, NULL, NULL, NULL, 0,
+                   gtk_get_current_event_time());
+}
+
+
 /* Callback for most buttons (the special cases that aren't handled here are
  * deg/rad/grad, inv, hyp, dec/hex, backspace) */
 static void button_click(GtkWidget *widget, gpointer data)
@@ -612,13 +900,25 @@ static void button_click(GtkWidget *widget, gpointer data)
 
         case bid_fe:
             give_arg_if_pending();
-            if (last_float_format == disp_float_gmode)
+            if (last_float_format == display_get_normal_float_format())
             {
-                display_set_float_format(disp_float_emode);
+                /* one result in emode, or gmode if emode is normal */
+                if (last_float_format == disp_float_emode)
+                    display_set_float_format(disp_float_gmode);
+                else
+                    display_set_float_format(disp_float_emode);
             }
             calc_give_op(binfo->cop);
             break;
 
+        case bid_bits:
+            bits_menu_popup();
+            break;
+
+        case bid_ntheory:
+            ntheory_menu_popup();
+            break;
+
         case bid_hist:
             /* if already open this will actually close it */
             gui_history_open();
@@ -959,6 +1259,11 @@ static gboolean key_press(GtkWidget *widget, GdkEventKey *event, gpointer data)
             return key_click_any_mode(but_grid[bid_4]);
         case '5':
         case NUM_KEYPAD_5:
+            if (event->state & CTRL_MASK)
+            {
+                /* 128 bit */
+                return key_click_if_integer_mode(rbut_int_width[4]);
+            }
             return key_click_any_mode(but_grid[bid_5]);
         case '6':
         case NUM_KEYPAD_6:
@@ -1120,6 +1425,12 @@ static gboolean key_press(GtkWidget *widget, GdkEventKey *event, gpointer data)
         case 'g':
             return key_click_if_integer_mode(but_grid[bid_gcd]);
 
+        case 'k':
+            return key_click_if_integer_mode(but_grid[bid_bits]);
+
+        case 'j':
+            return key_click_if_integer_mode(but_grid[bid_ntheory]);
+
         case '<':
             if (event->state & CTRL_MASK)
             {
@@ -1186,6 +1497,42 @@ void gui_create(void)
     gui_recreate();
 }
 
+/* Change the calculator width, or nothing if it's already that width */
+static void set_integer_width(calc_width_t width)
+{
+    if (width == calc_get_integer_width())
+    {
+        return;
+    }
+    give_arg_if_pending();
+    calc_set_integer_width(width);
+    /* this will update display */
+    calc_give_op(cop_peek);
+}
+
+/* Width from the entry next to the "other" radio button, or 0 if it isn't
+ * a valid width */
+static calc_width_t get_entry_int_width(void)
+{
+    const char *text = gtk_entry_get_text(GTK_ENTRY(entry_int_width));
+    char *end;
+    long w = strtol(text, &end, 10);
+
+    if (end == text || *end != '\0' || w < CALC_WIDTH_MIN || w > CALC_WIDTH_MAX)
+    {
+        return 0;
+    }
+    return (calc_width_t)w;
+}
+
+/* Put width in the entry for the "other" radio button */
+static void set_entry_int_width(calc_width_t width)
+{
+    char buf[8];
+    sprintf(buf, "%d", width);
+    gtk_entry_set_text(GTK_ENTRY(entry_int_width), buf);
+}
+
 /* Callback for int width radio buttons */
 static void int_width_rb_toggle(GtkWidget *widget, gpointer data)
 {
@@ -1200,13 +1547,73 @@ static void int_width_rb_toggle(GtkWidget *widget, gpointer data)
 
     if (active)
     {
-        give_arg_if_pending();
-        calc_set_integer_width(info->id);
-        /* this will update display */
-        calc_give_op(cop_peek);
+        set_integer_width(info->id);
     }
 }
 
+/* Callback for the "other" int width radio button, uses the entry width */
+static void int_width_other_toggle(GtkWidget *widget, gpointer data)
+{
+    (void)data;
+    gboolean active = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(widget));
+
+    if (!gui_created)
+    {
+        return;
+    }
+
+    if (active)
+    {
+        calc_width_t width = get_entry_int_width();
+        if (width == 0)
+        {
+            width = calc_get_integer_width();
+            set_entry_int_width(width);
+        }
+        set_integer_width(width);
+    }
+}
+
+/* Select the radio button for width, the "other" one (with the width put
+ * in its entry) if it isn't one of the presets. This results in the width
+ * being set in the calculator. */
+static void select_integer_width(calc_width_t width)
+{
+    for (int i = 0; i < NUM_INT_WIDTH_RB; i++)
+    {
+        if (int_width_rb[i].id == width)
+        {
+            gtk_button_clicked(GTK_BUTTON(rbut_int_width[i]));
+            return;
+        }
+    }
+    set_entry_int_width(width);
+    if (gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(rbut_int_width_other)))
+    {
+        set_integer_width(width);
+    }
+    else
+    {
+        gtk_button_clicked(GTK_BUTTON(rbut_int_width_other));
+    }
+}
+
+/* Callback for enter in the int width entry */
+static void int_width_entry_activate(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+    calc_width_t width = get_entry_int_width();
+
+    if (width == 0)
+    {
+        gui_warn("Integer width must be from 1 to 128");
+        set_entry_int_width(calc_get_integer_width());
+        return;
+    }
+    select_integer_width(width);
+}
+
 /* Callback for int signed/unsigned radio buttons */
 static void int_signed_rb_toggle(GtkWidget *widget, gpointer data)
 {
@@ -1249,13 +1656,15 @@ static void add_integer_width_rb(GtkWidget *hbox)
     gtk_widget_show(lbl);
     gtk_box_pack_start(GTK_BOX(hbox_w), lbl, FALSE, FALSE, 0);
 
-    for (i = 0; i < num_calc_widths; i++)
+    bool preset = false;
+    for (i = 0; i < NUM_INT_WIDTH_RB; i++)
     {
         button = gtk_radio_button_new_with_label(group, int_width_rb[i].name);
         group = gtk_radio_button_get_group(GTK_RADIO_BUTTON(button));
-        if (i == (int)calc_get_integer_width())
+        if (int_width_rb[i].id == calc_get_integer_width())
         {
             gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(button), TRUE);
+            preset = true;
         }
         g_signal_connect(button, "toggled",
                          G_CALLBACK(int_width_rb_toggle),
@@ -1265,6 +1674,27 @@ static void add_integer_width_rb(GtkWidget *hbox)
         rbut_int_width[i] = button;
     }
 
+    /* any other width, typed in the entry */
+    button = gtk_radio_button_new_with_label(group, "other");
+    if (!preset)
+    {
+        gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(button), TRUE);
+    }
+    g_signal_connect(button, "toggled",
+                     G_CALLBACK(int_width_other_toggle), NULL);
+    gtk_widget_show(button);
+    gtk_box_pack_start(GTK_BOX(hbox_w), button, FALSE, FALSE, 6);
+    rbut_int_width_other = button;
+
+    entry_int_width = gtk_entry_new();
+    gtk_entry_set_max_length(GTK_ENTRY(entry_int_width), 3);
+    gtk_entry_set_width_chars(GTK_ENTRY(entry_int_width), 3);
+    set_entry_int_width(calc_get_integer_width());
+    g_signal_connect(entry_int_width, "activate",
+                     G_CALLBACK(int_width_entry_activate), NULL);
+    gtk_widget_show(entry_int_width);
+    gtk_box_pack_start(GTK_BOX(hbox_w), entry_int_width, FALSE, FALSE, 0);
+
     group = NULL;
 
     /* some faffing around to push signed/unsigned buttons over to the
@@ -1377,10 +1807,12 @@ static void gui_recreate(void)
     lbl_pending_bin_op = NULL;
     but_backspace = NULL;
     but_repeat_eq = NULL;
-    for (int i = 0; i < num_calc_widths; i++)
+    for (int i = 0; i < NUM_INT_WIDTH_RB; i++)
     {
         rbut_int_width[i] = NULL;
     }
+    rbut_int_width_other = NULL;
+    entry_int_width = NULL;
     for (int i = 0; i < NUM_INT_SIGNED_RB; i++)
     {
         rbut_int_signed[i] = NULL;
@@ -1550,7 +1982,7 @@ static void gui_recreate(void)
     else
     {
         display_set_mode(disp_mode_float);
-        display_set_float_format(disp_float_gmode);
+        display_set_float_format(display_get_normal_float_format());
         display_set_num_float_digits(float_digits_from_id(float_digits_id));
 
         if (calc_get_angle() == calc_angle_deg)
@@ -1699,19 +2131,39 @@ static void update_status_label(void)
 {
     if (calc_get_mode() == calc_mode_integer)
     {
-        if (gui_radix == gui_radix_dec)
-            gtk_label_set_text(GTK_LABEL(lbl_status), "INTEGER : DEC");
-        else
-            gtk_label_set_text(GTK_LABEL(lbl_status), "INTEGER : HEX");
+        char buf[60];
+        int n = snprintf(buf, sizeof(buf), "INTEGER : %s",
+                         gui_radix == gui_radix_dec ? "DEC" : "HEX");
+        if (calc_get_modulus() != 0)
+        {
+            snprintf(buf + n, sizeof(buf) - n, " : MOD %" PRIu64,
+                     calc_get_modulus());
+        }
+        else if (calc_get_fixed_point_frac() != 0)
+        {
+            snprintf(buf + n, sizeof(buf) - n, " : Q%d",
+                     calc_get_fixed_point_frac());
+        }
+        else if (calc_get_lanes() != 0)
+        {
+            snprintf(buf + n, sizeof(buf) - n, " : LANES %d",
+                     calc_get_lanes());
+        }
+        gtk_label_set_text(GTK_LABEL(lbl_status), buf);
     }
     else
     {
+        char buf[60];
+        const char *angle;
         if (calc_get_angle() == calc_angle_deg)
-            gtk_label_set_text(GTK_LABEL(lbl_status), "FLOATING : DEG");
+            angle = "DEG";
         else if (calc_get_angle() == calc_angle_rad)
-            gtk_label_set_text(GTK_LABEL(lbl_status), "FLOATING : RAD");
+            angle = "RAD";
         else
-            gtk_label_set_text(GTK_LABEL(lbl_status), "FLOATING : GRAD");
+            angle = "GRAD";
+        snprintf(buf, sizeof(buf), "FLOATING : %s%s", angle,
+                 calc_get_rational() != calc_rational_off ? " : RATIONAL" : "");
+        gtk_label_set_text(GTK_LABEL(lbl_status), buf);
     }
 }
 
@@ -1733,8 +2185,8 @@ static void update_mem_label(void)
 /* use tooltip so if you mouse over the MR/MR2 buttons it shows the mem value */
 static void update_mem_tooltip(unsigned int m)
 {
-    char buf[100]; // plenty
-    uint64_t ival;
+    char buf[RADIX_PRINT_MAX]; // plenty
+    calc_int_t ival;
     stackf_t fval;
     bool was_unsigned;
     calc_get_mem(m, &ival, &fval, &was_unsigned);
@@ -1745,14 +2197,20 @@ static void update_mem_tooltip(unsigned int m)
 
     if (calc_get_mode() == calc_mode_integer)
     {
-        if (was_unsigned)
+        /* dec then hex in brackets */
+        char *p = buf;
+        if (!was_unsigned && (calc_sint_t)ival < 0)
         {
-            sprintf(buf, "%" PRIu64 "\n(0x%" PRIX64 ")", ival, ival);
+            *p++ = '-';
+            p += radix_print(p, -ival, 10, 1, 0, NULL);
         }
         else
         {
-            sprintf(buf, "%" PRId64 "\n(0x%" PRIX64 ")", (int64_t)ival, ival);
+            p += radix_print(p, ival, 10, 1, 0, NULL);
         }
+        p += sprintf(p, "\n(0x");
+        p += radix_print(p, ival, 16, 1, 0, NULL);
+        sprintf(p, ")");
     }
     else
     {
@@ -1810,6 +2268,48 @@ static void show_pending_bin_op(calc_op_enum cop)
     case cop_rsftn:
         new_name = ">>";
         break;
+    case cop_pdep:
+        new_name = "pdep";
+        break;
+    case cop_pext:
+        new_name = "pext";
+        break;
+    case cop_morton2:
+        new_name = "morton";
+        break;
+    case cop_clmul:
+        new_name = "clmul";
+        break;
+    case cop_clmulh:
+        new_name = "clmulh";
+        break;
+    case cop_gf2mod:
+        new_name = "pmod";
+        break;
+    case cop_gf2gcd:
+        new_name = "pgcd";
+        break;
+    case cop_dlog:
+        new_name = "dlog";
+        break;
+    case cop_lane_adds:
+        new_name = "adds";
+        break;
+    case cop_lane_subs:
+        new_name = "subs";
+        break;
+    case cop_lane_min:
+        new_name = "min";
+        break;
+    case cop_lane_max:
+        new_name = "max";
+        break;
+    case cop_lane_cmpeq:
+        new_name = "cmp=";
+        break;
+    case cop_lane_cmpgt:
+        new_name = "cmp>";
+        break;
     default:
         new_name = "";
         break;
@@ -1819,22 +2319,38 @@ static void show_pending_bin_op(calc_op_enum cop)
 }
 
 
+/* in rational mode, eg. = 7/3 under the main display when the result is
+ * an exact fraction */
+static void show_fraction(void)
+{
+    char buf[RAT_STRING_MAX + 2];
+    rat_t r;
+
+    if (!calc_get_rational_top_of_stack(&r) || r.den == 1)
+        return;
+
+    strcpy(buf, "= ");
+    rat_to_string(buf + 2, &r, calc_get_rational() == calc_rational_mixed);
+    display_widget_set_fraction(buf);
+}
+
 /* Called by calculator after all operations. Values returned are
  * i)  the integer value and the floating point value at the top of stack
  * ii) the operator at the top of the binary operator stack, or cop_nop if it's empty */
-static void gui_result_callback(uint64_t ival, stackf_t fval, calc_op_enum bop_cop)
+static void gui_result_callback(calc_int_t ival, stackf_t fval, calc_op_enum bop_cop)
 {
     last_float_format = display_get_float_format();
     /* this automatically clears disp exp_entry */
     display_set_val(ival, fval);
-    display_set_float_format(disp_float_gmode);
+    show_fraction();
+    display_set_float_format(display_get_normal_float_format());
     gtk_widget_set_sensitive(but_backspace, FALSE);
     arg_pending = false;
     show_pending_bin_op(bop_cop);
 }
 
 /* Called by calculator each time a new value is pushed to stack. */
-static void gui_history_callback(uint64_t ival, stackf_t fval)
+static void gui_history_callback(calc_int_t ival, stackf_t fval)
 {
     gui_history_add(ival, fval);
 }
@@ -1893,6 +2409,12 @@ static void gui_error(const char *msg)
 }
 
 
+/* for the modular window, the status shows the modulus */
+void gui_update_status(void)
+{
+    update_status_label();
+}
+
 /* pass value that user has entered into calculator */
 void gui_give_arg_if_pending(void)
 {
@@ -1900,41 +2422,43 @@ void gui_give_arg_if_pending(void)
 }
 
 
-/* Strip leading whitespace and terminate at first non valid character, this will
- * give more chance that the pasted text will be acceptable to dfp_from_string */
-static char *massage_float_txt(char *buf)
+static bool pasted_value_is_negative(const char *text)
 {
-    /* strip leading whitespace */
-    char *p = buf;
-    while (*p != '\0' && *p <= ' ')
+    /* if first non white space char is a '-' */
+    while (*text && *text <= ' ')
     {
-        p++;
+        text++;
     }
-    char *start = p;
+    return *text == '-';
+}
+
+/* true if text is just a decimal integer, with optional sign and white
+ * space around it */
+static bool pasted_value_is_plain_integer(const char *text)
+{
+    const char *p = text;
 
-    /* terminate at first non valid character */
-    const char *valid = "0123456789.+-eE";
-    while (*p != '\0')
+    while (*p && *p <= ' ')
     {
-        if (!strchr(valid, *p))
-        {
-            *p = '\0';
-            break;
-        }
         p++;
     }
-
-    return start;
-}
-
-static bool pasted_value_is_negative(const char *text)
-{
-    /* if first non white space char is a '-' */
-    while (*text && *text <= ' ')
+    if (*p == '-' || *p == '+')
     {
-        text++;
+        p++;
     }
-    return *text == '-';
+    if (!isdigit((unsigned char)*p))
+    {
+        return false;
+    }
+    while (isdigit((unsigned char)*p))
+    {
+        p++;
+    }
+    while (*p && *p <= ' ')
+    {
+        p++;
+    }
+    return *p == '\0';
 }
 
 static void clipboard_copy(void)
@@ -1948,19 +2472,12 @@ static void clipboard_copy(void)
 
 
 static const char *width_changed_warn = "Integer width changed to make value fit";
-static const char *neg_range_warn = "Negative value was out of range (< INT64_MIN)";
-static const char *pos_range_warn = "Positive value was out of range (> UINT64_MAX)";
+static const char *neg_range_warn = "Negative value was out of range (< -2^127)";
+static const char *pos_range_warn = "Positive value was out of range (> 2^128 - 1)";
 
-static void clipboard_paste_callback(GtkClipboard *clipboard, const gchar *text, gpointer data)
+/* give the value in text to the calculator, as if it was typed in */
+void gui_paste_text(const char *text, int base)
 {
-    (void)clipboard;
-    (void)data;
-
-    if (text == NULL)
-    {
-        return;
-    }
-
     if (calc_get_mode() == calc_mode_integer)
     {
         stackf_t dzero;
@@ -1968,25 +2485,47 @@ static void clipboard_paste_callback(GtkClipboard *clipboard, const gchar *text,
 
         bool ok;
         const char *msg = NULL;
-        uint64_t uval;
-        int base = gui_radix == gui_radix_dec ? 10 : 16;
-        calc_width_enum current_width = calc_get_integer_width();
-        calc_width_enum selected_width = current_width;
+        calc_int_t uval;
+        calc_width_t current_width = calc_get_integer_width();
+        calc_width_t selected_width = current_width;
         bool negative = pasted_value_is_negative(text);
 
-        if (negative)
+        if (base == 10 && !pasted_value_is_plain_integer(text))
         {
-            ok = calc_util_signed_str_to_ival(text, calc_width_64, &uval, base);
+            /* as a decimal value, so eg. 1.5e3 is 1500, then truncated */
+            char temp[DFP_STRING_MAX];
+            stackf_t fval;
+            dfp_int_status_enum status;
+            display_print_unformat(temp, text);
+            dfp_from_string(&fval, temp, &dfp_context);
+            if (negative)
+            {
+                calc_sint_t si;
+                status = dfp_to_int128(&fval, DEC_ROUND_DOWN, &si);
+                uval = (calc_int_t)si;
+            }
+            else
+            {
+                status = dfp_to_uint128(&fval, DEC_ROUND_DOWN, &uval);
+            }
+            /* anything that isn't a number is 0 */
+            ok = status != dfp_int_too_big && status != dfp_int_too_small;
+        }
+        else if (negative)
+        {
+            /* plain integers are parsed exactly, the float type only has
+             * 34 digits */
+            ok = calc_util_signed_str_to_ival(text, CALC_WIDTH_MAX, &uval, base);
         }
         else
         {
-            ok = calc_util_unsigned_str_to_ival(text, calc_width_64, &uval, base);
+            ok = calc_util_unsigned_str_to_ival(text, CALC_WIDTH_MAX, &uval, base);
         }
 
         if (ok)
         {
-            /* The number was in the range of s64 (if it was negative) or
-             * u64 (if it was positive), so there must be a calc width that fits.
+            /* The number was in the range of s128 (if it was negative) or
+             * u128 (if it was positive), so there must be a calc width that fits.
              * See if we need to change width to make it fit. */
             selected_width = calc_util_get_changed_width(uval, negative, current_width);
             if (selected_width != current_width)
@@ -1996,20 +2535,13 @@ static void clipboard_paste_callback(GtkClipboard *clipboard, const gchar *text,
         }
         else
         {
-            /* The number was outside the range of s64 (if negative) or
-             * u64 (if positive). Just return 0 and leave width unchanged. */
+            /* The number was outside the range of s128 (if negative) or
+             * u128 (if positive). Just return 0 and leave width unchanged. */
             uval = 0;
             msg = negative ? neg_range_warn : pos_range_warn;
         }
 
-        if (selected_width == calc_width_8)
-            gtk_button_clicked(GTK_BUTTON(rbut_int_width[0]));
-        else if (selected_width == calc_width_16)
-            gtk_button_clicked(GTK_BUTTON(rbut_int_width[1]));
-        else if (selected_width == calc_width_32)
-            gtk_button_clicked(GTK_BUTTON(rbut_int_width[2]));
-        else
-            gtk_button_clicked(GTK_BUTTON(rbut_int_width[3]));
+        select_integer_width(selected_width);
 
         calc_give_arg(uval, dzero);
         calc_give_op(cop_peek);
@@ -2020,17 +2552,30 @@ static void clipboard_paste_callback(GtkClipboard *clipboard, const gchar *text,
     }
     else
     {
-        /* dfp_from_string isn't very forgiving so pre process the text */
+        /* dfp_from_string isn't very forgiving so pre process the text,
+         * which also undoes grouping and SI prefixes from a copy */
         char temp[DFP_STRING_MAX];
-        temp[0] = '\0';
-        strncat(temp, text, DFP_STRING_MAX-1);
+        display_print_unformat(temp, text);
         stackf_t fval;
-        dfp_from_string(&fval, massage_float_txt(temp), &dfp_context);
+        dfp_from_string(&fval, temp, &dfp_context);
         calc_give_arg(0, fval);
         calc_give_op(cop_peek);
     }
 }
 
+static void clipboard_paste_callback(GtkClipboard *clipboard, const gchar *text, gpointer data)
+{
+    (void)clipboard;
+    (void)data;
+
+    if (text == NULL)
+    {
+        return;
+    }
+
+    gui_paste_text(text, gui_radix == gui_radix_dec ? 10 : 16);
+}
+
 static void clipboard_paste_default(void)
 {
     GtkClipboard *clip = gtk_clipboard_get(GDK_SELECTION_CLIPBOARD);
@@ -0,0 +1,265 @@
+/*****************************************************************************
+ * File gui_bigint.c part of ProgAndSciCalc
+ *
+ * Copyright (C) 2018 Ken Bromham
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "gui_internal.h"
+#include "calc_bigint.h"
+
+/* Big Integer window. The calculator itself works on values of at most
+ * 128 bits, this evaluates a typed expression with no limit (well,
+ * BN_MAX_BITS) and shows the result in dec, hex and bin. A result that
+ * fits in 128 bits can be given back to the calculator. */
+
+/* window, there will only ever be one */
+static GtkWidget *window_bigint;
+static GtkWidget *entry_expr;
+static GtkWidget *label_status;
+
+typedef enum
+{
+    res_dec,
+    res_hex,
+    res_bin,
+    res_bits,
+    num_res
+} res_enum;
+
+static const char *res_names[num_res] = { "Dec", "Hex", "Bin", "Bits" };
+static GtkWidget *entry_res[num_res];
+
+/* the last result, kept until the next one or the window closes */
+static bn_arena_t arena;
+static bn_t result;
+static bool have_result;
+
+#define EXPR_WIDTH 60
+/* an entry gets slow with a huge amount of text, longer results are cut
+ * short */
+#define RESULT_MAX_CHARS 20000
+#define RESULT_CUT_MSG "  ... (cut short)"
+#define BITS_TEXT_LEN 24
+
+static const char *help_msg =
+    "+ - * / % ** << >> & | ^ ~ ! ( )  gcd(a, b)  powmod(a, e, m)";
+
+
+static void bigint_destroy(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    bn_arena_free(&arena);
+    have_result = false;
+    window_bigint = NULL;
+}
+
+static void close_button_clicked(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    gtk_widget_destroy(window_bigint);
+}
+
+static void set_result_text(res_enum res, char *text)
+{
+    /* the cut message fits in what it replaces */
+    if (strlen(text) > RESULT_MAX_CHARS + sizeof(RESULT_CUT_MSG))
+    {
+        strcpy(&text[RESULT_MAX_CHARS], RESULT_CUT_MSG);
+    }
+    gtk_entry_set_text(GTK_ENTRY(entry_res[res]), text);
+}
+
+static void show_result(void)
+{
+    char buf[BITS_TEXT_LEN];
+
+    set_result_text(res_dec, bn_to_string(&arena, &result, 10));
+    set_result_text(res_hex, bn_to_string(&arena, &result, 16));
+    set_result_text(res_bin, bn_to_string(&arena, &result, 2));
+    snprintf(buf, sizeof(buf), "%ld", bn_bit_length(&result));
+    set_result_text(res_bits, buf);
+}
+
+static void evaluate(void)
+{
+    const char *err;
+
+    bn_arena_free(&arena);
+    bn_arena_init(&arena);
+
+    err = calc_bigint_eval(&arena, gtk_entry_get_text(GTK_ENTRY(entry_expr)),
+                           &result);
+    have_result = err == NULL;
+    if (have_result)
+    {
+        show_result();
+        gtk_label_set_text(GTK_LABEL(label_status), "");
+    }
+    else
+    {
+        for (int i = 0; i < num_res; i++)
+        {
+            gtk_entry_set_text(GTK_ENTRY(entry_res[i]), "");
+        }
+        gtk_label_set_text(GTK_LABEL(label_status), err);
+    }
+}
+
+static void expr_activate(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    evaluate();
+}
+
+static void evaluate_button_clicked(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    evaluate();
+}
+
+/* the result to the calculator, which changes width as needed or warns if
+ * it doesn't fit in 128 bits */
+static void to_calc_button_clicked(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    if (!have_result)
+    {
+        return;
+    }
+    if (bn_bit_length(&result) > CALC_WIDTH_MAX)
+    {
+        gtk_label_set_text(GTK_LABEL(label_status),
+                           "Too big for the calculator (more than 128 bits)");
+        return;
+    }
+    gui_paste_text(bn_to_string(&arena, &result, 10), 10);
+}
+
+static GtkWidget *create_table(void)
+{
+    GtkWidget *table;
+    GtkWidget *label;
+
+#if TARGET_GTK_VERSION == 2
+    table = gtk_table_new(num_res, 2, FALSE);
+    gtk_table_set_row_spacings(GTK_TABLE(table), 2);
+    gtk_table_set_col_spacings(GTK_TABLE(table), 5);
+#elif TARGET_GTK_VERSION == 3
+    table = gtk_grid_new();
+    gtk_grid_set_row_spacing(GTK_GRID(table), 2);
+    gtk_grid_set_column_spacing(GTK_GRID(table), 5);
+#endif
+
+    for (int row = 0; row < num_res; row++)
+    {
+        label = gui_label_new(res_names[row], 0, 0.5);
+        entry_res[row] = gtk_entry_new();
+#if TARGET_GTK_VERSION == 2
+        gtk_entry_set_editable(GTK_ENTRY(entry_res[row]), FALSE);
+#elif TARGET_GTK_VERSION == 3
+        gtk_editable_set_editable(GTK_EDITABLE(entry_res[row]), FALSE);
+#endif
+        gtk_entry_set_width_chars(GTK_ENTRY(entry_res[row]), EXPR_WIDTH);
+#if TARGET_GTK_VERSION == 2
+        gtk_table_attach_defaults(GTK_TABLE(table), label, 0, 1, row, row+1);
+        gtk_table_attach_defaults(GTK_TABLE(table), entry_res[row],
+                                  1, 2, row, row+1);
+#elif TARGET_GTK_VERSION == 3
+        gtk_grid_attach(GTK_GRID(table), label, 0, row, 1, 1);
+        gtk_grid_attach(GTK_GRID(table), entry_res[row], 1, row, 1, 1);
+#endif
+    }
+
+    return table;
+}
+
+void gui_bigint_open(void)
+{
+    GtkWidget *vbox;
+    GtkWidget *hbox;
+    GtkWidget *label;
+    GtkWidget *button;
+
+    if (window_bigint != NULL)
+    {
+        /* already open */
+        return;
+    }
+
+    bn_arena_init(&arena);
+    have_result = false;
+
+    window_bigint = gtk_window_new(GTK_WINDOW_TOPLEVEL);
+    gtk_window_set_title(GTK_WINDOW(window_bigint), "Big Integer");
+    g_signal_connect(window_bigint, "destroy",
+                     G_CALLBACK(bigint_destroy), NULL);
+    gtk_container_set_border_width(GTK_CONTAINER(window_bigint), 10);
+
+    vbox = gui_vbox_new(FALSE, 0);
+    gtk_container_add(GTK_CONTAINER(window_bigint), vbox);
+
+    label = gui_label_new(help_msg, 0, 0.5);
+    gtk_box_pack_start(GTK_BOX(vbox), label, FALSE, FALSE, 0);
+
+    entry_expr = gtk_entry_new();
+    gtk_entry_set_width_chars(GTK_ENTRY(entry_expr), EXPR_WIDTH);
+    g_signal_connect(entry_expr, "activate",
+                     G_CALLBACK(expr_activate), NULL);
+    gtk_box_pack_start(GTK_BOX(vbox), entry_expr, FALSE, FALSE, 5);
+
+    label_status = gui_label_new("", 0, 0.5);
+    gtk_box_pack_start(GTK_BOX(vbox), label_status, FALSE, FALSE, 0);
+
+    gtk_box_pack_start(GTK_BOX(vbox), gui_hseparator_new(), FALSE, FALSE, 5);
+    gtk_box_pack_start(GTK_BOX(vbox), create_table(), TRUE, TRUE, 5);
+
+    /* buttons */
+    hbox = gui_hbox_new(FALSE, 5);
+    button = gtk_button_new_with_mnemonic("_Evaluate");
+    g_signal_connect(button, "clicked",
+                     G_CALLBACK(evaluate_button_clicked), NULL);
+    gtk_box_pack_start(GTK_BOX(hbox), button, FALSE, FALSE, 0);
+    button = gtk_button_new_with_mnemonic("_To Calculator");
+    g_signal_connect(button, "clicked",
+                     G_CALLBACK(to_calc_button_clicked), NULL);
+    gtk_box_pack_start(GTK_BOX(hbox), button, FALSE, FALSE, 0);
+    button = gtk_button_new_with_mnemonic("_Close");
+    g_signal_connect(button, "clicked",
+                     G_CALLBACK(close_button_clicked), NULL);
+    gtk_widget_set_size_request(button, 80, -1);
+#if TARGET_GTK_VERSION == 2
+    GtkWidget *align = gtk_alignment_new(1, 0, 0, 0);
+    gtk_container_add(GTK_CONTAINER(align), button);
+    gtk_box_pack_start(GTK_BOX(hbox), align, TRUE, TRUE, 0);
+#elif TARGET_GTK_VERSION == 3
+    gtk_widget_set_halign(button, GTK_ALIGN_END);
+    gtk_box_pack_start(GTK_BOX(hbox), button, TRUE, TRUE, 0);
+#endif
+    gtk_box_pack_start(GTK_BOX(vbox), hbox, FALSE, FALSE, 10);
+
+    gtk_widget_show_all(window_bigint);
+}
@@ -0,0 +1,579 @@
+/*****************************************************************************
+ * File gui_checksum.c part of ProgAndSciCalc
+ *
+ * Copyright (C) 2018 Ken Bromham
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <ctype.h>
+#include <errno.h>
+#include <inttypes.h>
+
+#include "gui_internal.h"
+#include "checksum.h"
+
+/* Checksum window. Works out a CRC or hash of some bytes, which can be
+ * typed in as hex or text, read from a file, or be the calculator's
+ * current integer value. The result can be given to the calculator. */
+
+/* window, there will only ever be one */
+static GtkWidget *window_checksum;
+static GtkWidget *entry_input;
+static GtkWidget *combo_algo;
+static GtkWidget *entry_width;
+static GtkWidget *entry_poly;
+static GtkWidget *entry_init;
+static GtkWidget *entry_xorout;
+static GtkWidget *chk_refin;
+static GtkWidget *chk_refout;
+static GtkWidget *entry_result;
+static GtkWidget *label_status;
+
+typedef enum
+{
+    input_hex,
+    input_text,
+    input_file,
+    input_calc,
+    num_inputs
+} input_enum;
+
+static const char *input_names[num_inputs] =
+{
+    "Hex bytes", "Text", "File", "Calculator value"
+};
+static GtkWidget *rbut_input[num_inputs];
+
+/* after the CRC presets in the algorithm list */
+typedef enum
+{
+    algo_fnv1a64,
+    algo_xxh64,
+    num_hash_algos
+} hash_algo_enum;
+
+static const char *hash_algo_names[num_hash_algos] = { "FNV-1a 64", "XXH64" };
+
+/* the last result, as hex */
+#define RESULT_LEN 24
+static char result_text[RESULT_LEN];
+static bool have_result;
+
+#define ENTRY_WIDTH 50
+#define PARAM_WIDTH 20
+
+
+static void checksum_destroy(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    have_result = false;
+    window_checksum = NULL;
+}
+
+static void close_button_clicked(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    gtk_widget_destroy(window_checksum);
+}
+
+static input_enum get_input(void)
+{
+    for (int i = 0; i < num_inputs; i++)
+    {
+        if (gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(rbut_input[i])))
+        {
+            return i;
+        }
+    }
+    return input_hex;
+}
+
+static void set_param_entry(GtkWidget *entry, uint64_t val)
+{
+    char buf[RESULT_LEN];
+    snprintf(buf, sizeof(buf), "0x%" PRIx64, val);
+    gtk_entry_set_text(GTK_ENTRY(entry), buf);
+}
+
+/* Callback for the algorithm changing. A CRC preset fills in its params,
+ * which can then be changed for a CRC that isn't in the list. */
+static void algo_changed(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+    int algo = gtk_combo_box_get_active(GTK_COMBO_BOX(combo_algo));
+    bool is_crc = algo >= 0 && algo < checksum_num_crc_presets();
+
+    if (is_crc)
+    {
+        const crc_params_t *p = checksum_crc_preset(algo);
+        char buf[RESULT_LEN];
+
+        snprintf(buf, sizeof(buf), "%d", p->width);
+        gtk_entry_set_text(GTK_ENTRY(entry_width), buf);
+        set_param_entry(entry_poly, p->poly);
+        set_param_entry(entry_init, p->init);
+        set_param_entry(entry_xorout, p->xorout);
+        gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(chk_refin), p->refin);
+        gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(chk_refout), p->refout);
+    }
+    gtk_widget_set_sensitive(entry_width, is_crc);
+    gtk_widget_set_sensitive(entry_poly, is_crc);
+    gtk_widget_set_sensitive(entry_init, is_crc);
+    gtk_widget_set_sensitive(entry_xorout, is_crc);
+    gtk_widget_set_sensitive(chk_refin, is_crc);
+    gtk_widget_set_sensitive(chk_refout, is_crc);
+}
+
+static bool parse_param(GtkWidget *entry, int base, uint64_t *val)
+{
+    const char *text = gtk_entry_get_text(GTK_ENTRY(entry));
+    char *end;
+
+    errno = 0;
+    *val = strtoull(text, &end, base);
+    while (isspace((unsigned char)*end))
+    {
+        end++;
+    }
+    return end != text && *end == '\0' && errno == 0;
+}
+
+static const char *get_crc_params(crc_params_t *p)
+{
+    uint64_t width;
+
+    p->name = "";
+    if (!parse_param(entry_width, 10, &width) || width < 1
+        || width > CHECKSUM_CRC_WIDTH_MAX)
+    {
+        return "Width must be 1 to 64";
+    }
+    p->width = (int)width;
+    if (!parse_param(entry_poly, 16, &p->poly)
+        || !parse_param(entry_init, 16, &p->init)
+        || !parse_param(entry_xorout, 16, &p->xorout))
+    {
+        return "Poly, Init and XorOut must be hex";
+    }
+    p->refin = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(chk_refin));
+    p->refout = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(chk_refout));
+    if (!checksum_crc_params_ok(p))
+    {
+        return "Poly, Init or XorOut wider than Width";
+    }
+    return NULL;
+}
+
+static int hex_digit_val(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    return tolower((unsigned char)c) - 'a' + 10;
+}
+
+/* Hex digits in pairs, allowing spaces, colons, commas and hyphens between
+ * bytes and a 0x in front eg. "de ad be ef", "0xdeadbeef", "de:ad:be:ef" */
+static const char *parse_hex_bytes(const char *text, uint8_t *data, size_t *len)
+{
+    int hi = -1;
+
+    *len = 0;
+    for (const char *p = text; *p != '\0'; p++)
+    {
+        if (hi < 0 && p[0] == '0' && tolower((unsigned char)p[1]) == 'x')
+        {
+            p++;
+        }
+        else if (isxdigit((unsigned char)*p))
+        {
+            if (hi < 0)
+            {
+                hi = hex_digit_val(*p);
+            }
+            else
+            {
+                data[(*len)++] = (uint8_t)(hi << 4 | hex_digit_val(*p));
+                hi = -1;
+            }
+        }
+        else if (isspace((unsigned char)*p) || *p == ':' || *p == ','
+                 || *p == '-')
+        {
+            if (hi >= 0)
+            {
+                return "Hex digits must be in pairs";
+            }
+        }
+        else
+        {
+            return "Not a hex digit";
+        }
+    }
+    if (hi >= 0)
+    {
+        return "Hex digits must be in pairs";
+    }
+    return NULL;
+}
+
+/* The calculator value as bytes, most significant first, as many as the
+ * width needs */
+static const char *get_calc_bytes(uint8_t *data, size_t *len)
+{
+    calc_int_t ival;
+    stackf_t fval;
+    int bytes;
+
+    if (calc_get_mode() != calc_mode_integer)
+    {
+        return "Calculator not in integer mode";
+    }
+    display_get_val(&ival, &fval);
+    bytes = (calc_get_integer_width() + 7) / 8;
+    for (int i = 0; i < bytes; i++)
+    {
+        data[i] = (uint8_t)(ival >> ((bytes - 1 - i) * 8));
+    }
+    *len = bytes;
+    return NULL;
+}
+
+static void compute(void)
+{
+    const char *text = gtk_entry_get_text(GTK_ENTRY(entry_input));
+    int algo = gtk_combo_box_get_active(GTK_COMBO_BOX(combo_algo));
+    int num_crc = checksum_num_crc_presets();
+    const char *err = NULL;
+    uint8_t calc_bytes[CALC_WIDTH_MAX / 8];
+    uint8_t *data = NULL;
+    gchar *contents = NULL;
+    size_t len = 0;
+    crc_params_t params;
+    uint64_t result;
+    int digits;
+    char msg[80];
+
+    have_result = false;
+    gtk_entry_set_text(GTK_ENTRY(entry_result), "");
+
+    if (algo < num_crc)
+    {
+        err = get_crc_params(&params);
+    }
+
+    if (err == NULL)
+    {
+        switch (get_input())
+        {
+            case input_hex:
+                data = malloc(strlen(text) / 2 + 1);
+                if (data == NULL)
+                {
+                    err = "Out of memory";
+                    break;
+                }
+                err = parse_hex_bytes(text, data, &len);
+                break;
+            case input_text:
+                data = (uint8_t *)text;
+                len = strlen(text);
+                break;
+            case input_file:
+            {
+                GError *gerror = NULL;
+                gsize size;
+                if (!g_file_get_contents(text, &contents, &size, &gerror))
+                {
+                    snprintf(msg, sizeof(msg), "%s", gerror->message);
+                    g_error_free(gerror);
+                    err = msg;
+                    break;
+                }
+                data = (uint8_t *)contents;
+                len = size;
+                break;
+            }
+            case input_calc:
+                data = calc_bytes;
+                err = get_calc_bytes(data, &len);
+                break;
+            default:
+                break;
+        }
+    }
+
+    if (err == NULL)
+    {
+        if (algo < num_crc)
+        {
+            result = checksum_crc(&params, data, len);
+            digits = (params.width + 3) / 4;
+        }
+        else if (algo - num_crc == algo_fnv1a64)
+        {
+            result = checksum_fnv1a64(data, len);
+            digits = 16;
+        }
+        else
+        {
+            result = checksum_xxh64(data, len, 0);
+            digits = 16;
+        }
+        snprintf(result_text, sizeof(result_text), "%0*" PRIx64, digits, result);
+        gtk_entry_set_text(GTK_ENTRY(entry_result), result_text);
+        have_result = true;
+        snprintf(msg, sizeof(msg), "%zu bytes", len);
+        err = msg;
+    }
+    gtk_label_set_text(GTK_LABEL(label_status), err);
+
+    if (get_input() == input_hex)
+    {
+        free(data);
+    }
+    g_free(contents);
+}
+
+static void compute_button_clicked(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    compute();
+}
+
+static void input_activate(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    compute();
+}
+
+static void browse_button_clicked(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+    GtkWidget *dialog;
+
+    dialog = gtk_file_chooser_dialog_new("Checksum File",
+                                         GTK_WINDOW(window_checksum),
+                                         GTK_FILE_CHOOSER_ACTION_OPEN,
+                                         "_Cancel", GTK_RESPONSE_CANCEL,
+                                         "_Open", GTK_RESPONSE_ACCEPT,
+                                         NULL);
+    if (gtk_dialog_run(GTK_DIALOG(dialog)) == GTK_RESPONSE_ACCEPT)
+    {
+        char *filename = gtk_file_chooser_get_filename(GTK_FILE_CHOOSER(dialog));
+        gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(rbut_input[input_file]),
+                                     TRUE);
+        gtk_entry_set_text(GTK_ENTRY(entry_input), filename);
+        g_free(filename);
+        gtk_widget_destroy(dialog);
+        compute();
+        return;
+    }
+    gtk_widget_destroy(dialog);
+}
+
+/* the result to the calculator, which changes width as needed */
+static void to_calc_button_clicked(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    if (have_result)
+    {
+        gui_paste_text(result_text, 16);
+    }
+}
+
+static void table_attach(GtkWidget *table, GtkWidget *widget,
+                         int col, int row, int width)
+{
+#if TARGET_GTK_VERSION == 2
+    gtk_table_attach_defaults(GTK_TABLE(table), widget, col, col + width,
+                              row, row + 1);
+#elif TARGET_GTK_VERSION == 3
+    gtk_grid_attach(GTK_GRID(table), widget, col, row, width, 1);
+#endif
+}
+
+static GtkWidget *param_entry_new(void)
+{
+    GtkWidget *entry = gtk_entry_new();
+    gtk_entry_set_width_chars(GTK_ENTRY(entry), PARAM_WIDTH);
+    return entry;
+}
+
+/* algorithm and CRC params */
+static GtkWidget *create_algo_table(void)
+{
+    GtkWidget *table;
+
+#if TARGET_GTK_VERSION == 2
+    table = gtk_table_new(6, 2, FALSE);
+    gtk_table_set_row_spacings(GTK_TABLE(table), 2);
+    gtk_table_set_col_spacings(GTK_TABLE(table), 5);
+#elif TARGET_GTK_VERSION == 3
+    table = gtk_grid_new();
+    gtk_grid_set_row_spacing(GTK_GRID(table), 2);
+    gtk_grid_set_column_spacing(GTK_GRID(table), 5);
+#endif
+
+    combo_algo = gtk_combo_box_text_new();
+    for (int i = 0; i < checksum_num_crc_presets(); i++)
+    {
+        gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(combo_algo),
+                                       checksum_crc_preset(i)->name);
+    }
+    for (int i = 0; i < num_hash_algos; i++)
+    {
+        gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(combo_algo),
+                                       hash_algo_names[i]);
+    }
+    entry_width = param_entry_new();
+    entry_poly = param_entry_new();
+    entry_init = param_entry_new();
+    entry_xorout = param_entry_new();
+    chk_refin = gtk_check_button_new_with_label("Reflect In");
+    chk_refout = gtk_check_button_new_with_label("Reflect Out");
+
+    table_attach(table, gui_label_new("Algorithm", 0, 0.5), 0, 0, 1);
+    table_attach(table, combo_algo, 1, 0, 1);
+    table_attach(table, gui_label_new("Width", 0, 0.5), 0, 1, 1);
+    table_attach(table, entry_width, 1, 1, 1);
+    table_attach(table, gui_label_new("Poly", 0, 0.5), 0, 2, 1);
+    table_attach(table, entry_poly, 1, 2, 1);
+    table_attach(table, gui_label_new("Init", 0, 0.5), 0, 3, 1);
+    table_attach(table, entry_init, 1, 3, 1);
+    table_attach(table, gui_label_new("XorOut", 0, 0.5), 0, 4, 1);
+    table_attach(table, entry_xorout, 1, 4, 1);
+    table_attach(table, chk_refin, 0, 5, 1);
+    table_attach(table, chk_refout, 1, 5, 1);
+
+    g_signal_connect(combo_algo, "changed", G_CALLBACK(algo_changed), NULL);
+
+    return table;
+}
+
+void gui_checksum_open(void)
+{
+    GtkWidget *vbox;
+    GtkWidget *hbox;
+    GtkWidget *button;
+    GSList *group = NULL;
+
+    if (window_checksum != NULL)
+    {
+        /* already open */
+        return;
+    }
+
+    have_result = false;
+
+    window_checksum = gtk_window_new(GTK_WINDOW_TOPLEVEL);
+    gtk_window_set_title(GTK_WINDOW(window_checksum), "Checksum");
+    g_signal_connect(window_checksum, "destroy",
+                     G_CALLBACK(checksum_destroy), NULL);
+    gtk_container_set_border_width(GTK_CONTAINER(window_checksum), 10);
+
+    vbox = gui_vbox_new(FALSE, 0);
+    gtk_container_add(GTK_CONTAINER(window_checksum), vbox);
+
+    /* input */
+    hbox = gui_hbox_new(FALSE, 5);
+    for (int i = 0; i < num_inputs; i++)
+    {
+        rbut_input[i] = gtk_radio_button_new_with_label(group, input_names[i]);
+        group = gtk_radio_button_get_group(GTK_RADIO_BUTTON(rbut_input[i]));
+        gtk_box_pack_start(GTK_BOX(hbox), rbut_input[i], FALSE, FALSE, 0);
+    }
+    gtk_box_pack_start(GTK_BOX(vbox), hbox, FALSE, FALSE, 0);
+
+    hbox = gui_hbox_new(FALSE, 5);
+    entry_input = gtk_entry_new();
+    gtk_entry_set_width_chars(GTK_ENTRY(entry_input), ENTRY_WIDTH);
+    g_signal_connect(entry_input, "activate",
+                     G_CALLBACK(input_activate), NULL);
+    gtk_box_pack_start(GTK_BOX(hbox), entry_input, TRUE, TRUE, 0);
+    button = gtk_button_new_with_mnemonic("_Browse...");
+    g_signal_connect(button, "clicked",
+                     G_CALLBACK(browse_button_clicked), NULL);
+    gtk_box_pack_start(GTK_BOX(hbox), button, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(vbox), hbox, FALSE, FALSE, 5);
+
+    gtk_box_pack_start(GTK_BOX(vbox), gui_hseparator_new(), FALSE, FALSE, 5);
+    gtk_box_pack_start(GTK_BOX(vbox), create_algo_table(), FALSE, FALSE, 5);
+    gtk_box_pack_start(GTK_BOX(vbox), gui_hseparator_new(), FALSE, FALSE, 5);
+
+    /* result */
+    hbox = gui_hbox_new(FALSE, 5);
+    gtk_box_pack_start(GTK_BOX(hbox), gui_label_new("Result", 0, 0.5),
+                       FALSE, FALSE, 0);
+    entry_result = gtk_entry_new();
+#if TARGET_GTK_VERSION == 2
+    gtk_entry_set_editable(GTK_ENTRY(entry_result), FALSE);
+#elif TARGET_GTK_VERSION == 3
+    gtk_editable_set_editable(GTK_EDITABLE(entry_result), FALSE);
+#endif
+    gtk_box_pack_start(GTK_BOX(hbox), entry_result, TRUE, TRUE, 0);
+    gtk_box_pack_start(GTK_BOX(vbox), hbox, FALSE, FALSE, 0);
+
+    label_status = gui_label_new("", 0, 0.5);
+    gtk_box_pack_start(GTK_BOX(vbox), label_status, FALSE, FALSE, 5);
+
+    /* buttons */
+    hbox = gui_hbox_new(FALSE, 5);
+    button = gtk_button_new_with_mnemonic("C_ompute");
+    g_signal_connect(button, "clicked",
+                     G_CALLBACK(compute_button_clicked), NULL);
+    gtk_box_pack_start(GTK_BOX(hbox), button, FALSE, FALSE, 0);
+    button = gtk_button_new_with_mnemonic("_To Calculator");
+    g_signal_connect(button, "clicked",
+                     G_CALLBACK(to_calc_button_clicked), NULL);
+    gtk_box_pack_start(GTK_BOX(hbox), button, FALSE, FALSE, 0);
+    button = gtk_button_new_with_mnemonic("_Close");
+    g_signal_connect(button, "clicked",
+                     G_CALLBACK(close_button_clicked), NULL);
+    gtk_widget_set_size_request(button, 80, -1);
+#if TARGET_GTK_VERSION == 2
+    GtkWidget *align = gtk_alignment_new(1, 0, 0, 0);
+    gtk_container_add(GTK_CONTAINER(align), button);
+    gtk_box_pack_start(GTK_BOX(hbox), align, TRUE, TRUE, 0);
+#elif TARGET_GTK_VERSION == 3
+    gtk_widget_set_halign(button, GTK_ALIGN_END);
+    gtk_box_pack_start(GTK_BOX(hbox), button, TRUE, TRUE, 0);
+#endif
+    gtk_box_pack_start(GTK_BOX(vbox), hbox, FALSE, FALSE, 10);
+
+    /* CRC-32 to start with, which fills in the params */
+    for (int i = 0; i < checksum_num_crc_presets(); i++)
+    {
+        if (checksum_crc_preset(i)->width == 32)
+        {
+            gtk_combo_box_set_active(GTK_COMBO_BOX(combo_algo), i);
+            break;
+        }
+    }
+
+    gtk_widget_show_all(window_checksum);
+}
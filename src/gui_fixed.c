@@ -0,0 +1,218 @@
+/*****************************************************************************
+ * File gui_fixed.c   part of ProgAndSciCalc
+ *
+ * Copyright (C) 2018 Ken Bromham
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdlib.h>
+
+#include "gui_internal.h"
+
+/* Fixed point window. Sets the number of fraction bits for Q format in
+ * integer mode, and whether results that don't fit saturate or wrap. The
+ * integer bits are whatever is left of the integer width. */
+
+/* window, there will only ever be one */
+static GtkWidget *window_fixed;
+static GtkWidget *entry_frac;
+static GtkWidget *check_saturate;
+static GtkWidget *label_format;
+static GtkWidget *label_status;
+
+
+static void fixed_destroy(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    window_fixed = NULL;
+}
+
+static void close_button_clicked(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    gtk_widget_destroy(window_fixed);
+}
+
+static void show_format(void)
+{
+    char buf[80];
+    int frac = calc_get_fixed_point_frac();
+    int width = calc_get_integer_width();
+    bool use_unsigned = calc_get_use_unsigned();
+
+    if (frac == 0)
+    {
+        snprintf(buf, sizeof(buf), "Off, normal integer arithmetic");
+    }
+    else
+    {
+        snprintf(buf, sizeof(buf), "%sQ%d.%d, resolution 2^-%d, %s",
+                 use_unsigned ? "U" : "",
+                 width - frac - (use_unsigned ? 0 : 1), frac, frac,
+                 calc_get_fixed_point_saturate() ? "saturating" : "wrapping");
+    }
+    gtk_label_set_text(GTK_LABEL(label_format), buf);
+    gui_update_status();
+}
+
+static void set_fixed(void)
+{
+    const char *text = gtk_entry_get_text(GTK_ENTRY(entry_frac));
+    char *end;
+    long frac = strtol(text, &end, 10);
+    bool saturate =
+        gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(check_saturate));
+
+    gtk_label_set_text(GTK_LABEL(label_status), "");
+    gui_give_arg_if_pending();
+    if (end == text || *end != '\0' || frac < 0 || frac > CALC_WIDTH_MAX ||
+        !calc_set_fixed_point((int)frac, saturate))
+    {
+        gtk_label_set_text(GTK_LABEL(label_status),
+                           "Fraction bits must be less than the width, "
+                           "up to 64 bits (0 for off)");
+        return;
+    }
+    show_format();
+}
+
+static void set_button_clicked(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    set_fixed();
+}
+
+static void frac_activate(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    set_fixed();
+}
+
+static void off_button_clicked(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    gui_give_arg_if_pending();
+    calc_set_fixed_point(0, calc_get_fixed_point_saturate());
+    gtk_entry_set_text(GTK_ENTRY(entry_frac), "");
+    gtk_label_set_text(GTK_LABEL(label_status), "");
+    show_format();
+}
+
+/* saturate or wrap takes effect straight away if fixed point is on */
+static void saturate_toggled(GtkWidget *widget, gpointer data)
+{
+    (void)data;
+
+    gboolean active = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(widget));
+    if (calc_get_fixed_point_frac() != 0)
+    {
+        calc_set_fixed_point(calc_get_fixed_point_frac(), active);
+        show_format();
+    }
+}
+
+static GtkWidget *button_new(const char *mnemonic, GCallback clicked)
+{
+    GtkWidget *button = gtk_button_new_with_mnemonic(mnemonic);
+    g_signal_connect(button, "clicked", clicked, NULL);
+    return button;
+}
+
+void gui_fixed_open(void)
+{
+    GtkWidget *vbox;
+    GtkWidget *hbox;
+    GtkWidget *button;
+    char buf[24];
+
+    if (window_fixed != NULL)
+    {
+        /* already open */
+        return;
+    }
+
+    window_fixed = gtk_window_new(GTK_WINDOW_TOPLEVEL);
+    gtk_window_set_title(GTK_WINDOW(window_fixed), "Fixed Point");
+    g_signal_connect(window_fixed, "destroy",
+                     G_CALLBACK(fixed_destroy), NULL);
+    gtk_container_set_border_width(GTK_CONTAINER(window_fixed), 10);
+
+    vbox = gui_vbox_new(FALSE, 0);
+    gtk_container_add(GTK_CONTAINER(window_fixed), vbox);
+
+    /* fraction bits */
+    hbox = gui_hbox_new(FALSE, 5);
+    gtk_box_pack_start(GTK_BOX(hbox), gui_label_new("Fraction bits", 0, 0.5),
+                       FALSE, FALSE, 0);
+    entry_frac = gtk_entry_new();
+    gtk_entry_set_width_chars(GTK_ENTRY(entry_frac), 6);
+    if (calc_get_fixed_point_frac() != 0)
+    {
+        snprintf(buf, sizeof(buf), "%d", calc_get_fixed_point_frac());
+        gtk_entry_set_text(GTK_ENTRY(entry_frac), buf);
+    }
+    g_signal_connect(entry_frac, "activate",
+                     G_CALLBACK(frac_activate), NULL);
+    gtk_box_pack_start(GTK_BOX(hbox), entry_frac, TRUE, TRUE, 0);
+    gtk_box_pack_start(GTK_BOX(hbox),
+                       button_new("_Set", G_CALLBACK(set_button_clicked)),
+                       FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(hbox),
+                       button_new("O_ff", G_CALLBACK(off_button_clicked)),
+                       FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(vbox), hbox, FALSE, FALSE, 0);
+
+    check_saturate = gtk_check_button_new_with_label(
+                         "Saturate on overflow (else wrap)");
+    gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(check_saturate),
+                                 calc_get_fixed_point_saturate());
+    g_signal_connect(check_saturate, "toggled",
+                     G_CALLBACK(saturate_toggled), NULL);
+    gtk_box_pack_start(GTK_BOX(vbox), check_saturate, FALSE, FALSE, 5);
+
+    label_format = gui_label_new("", 0, 0.5);
+    gtk_box_pack_start(GTK_BOX(vbox), label_format, FALSE, FALSE, 5);
+
+    label_status = gui_label_new("", 0, 0.5);
+    gtk_box_pack_start(GTK_BOX(vbox), label_status, FALSE, FALSE, 5);
+
+    /* buttons */
+    hbox = gui_hbox_new(FALSE, 5);
+    button = button_new("_Close", G_CALLBACK(close_button_clicked));
+    gtk_widget_set_size_request(button, 80, -1);
+#if TARGET_GTK_VERSION == 2
+    GtkWidget *align = gtk_alignment_new(1, 0, 0, 0);
+    gtk_container_add(GTK_CONTAINER(align), button);
+    gtk_box_pack_start(GTK_BOX(hbox), align, TRUE, TRUE, 0);
+#elif TARGET_GTK_VERSION == 3
+    gtk_widget_set_halign(button, GTK_ALIGN_END);
+    gtk_box_pack_start(GTK_BOX(hbox), button, TRUE, TRUE, 0);
+#endif
+    gtk_box_pack_start(GTK_BOX(vbox), hbox, FALSE, FALSE, 10);
+
+    show_format();
+    gtk_widget_show_all(window_fixed);
+}
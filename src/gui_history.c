@@ -22,6 +22,7 @@
 #include <inttypes.h>
 #include "gui_internal.h"
 #include "display_print.h"
+#include "radix_print.h"
 
 static GtkWidget *window_hist_float;
 static GtkWidget *window_hist_int;
@@ -36,7 +37,7 @@ static stackf_t history_fval_copy[HISTORY_MAX_ITEMS];
 typedef struct
 {
     bool is_unsigned;
-    uint64_t ival;
+    calc_int_t ival;
 } hist_int_t;
 
 static hist_int_t history_ival[HISTORY_MAX_ITEMS];
@@ -111,14 +112,16 @@ static gboolean entry_button_release_int(GtkWidget *widget,
     return FALSE;
 }
 
-#define TEXT_LEN_INT 42
+/* 40 chars dec, 32 + 2 hex, 2 spaces, 2 brackets for 128 bit values, but
+ * only show as many as a 64 bit value needs */
+#define TEXT_LEN_INT 80
+#define TEXT_WIDTH_INT 42
 static GtkWidget *create_table_int(void)
 {
     int row;
     GtkWidget *table;
     GtkWidget *entry;
-    /* 20 digits dec, 16 + 2 hex, 2 spaces, 2 brackets, this size is enough */
-    char buf[50];
+    char buf[TEXT_LEN_INT + 1];
 
 #if TARGET_GTK_VERSION == 2
     table = gtk_table_new(HISTORY_MAX_ITEMS, 1, TRUE);
@@ -132,16 +135,20 @@ static GtkWidget *create_table_int(void)
     {
         /* entry to display values */
         entry = gtk_entry_new();
-        if (history_ival_copy[row].is_unsigned)
+        calc_int_t ival = history_ival_copy[row].ival;
+        char *p = buf;
+        if (!history_ival_copy[row].is_unsigned && (calc_sint_t)ival < 0)
         {
-            sprintf(buf, "%" PRIu64 "  (0x%" PRIX64 ")",
-                    history_ival_copy[row].ival, history_ival_copy[row].ival);
+            *p++ = '-';
+            p += radix_print(p, -ival, 10, 1, 0, NULL);
         }
         else
         {
-            sprintf(buf, "%" PRId64 "  (0x%" PRIX64 ")",
-                    (int64_t)history_ival_copy[row].ival, history_ival_copy[row].ival);
+            p += radix_print(p, ival, 10, 1, 0, NULL);
         }
+        p += sprintf(p, "  (0x");
+        p += radix_print(p, ival, 16, 1, 0, NULL);
+        sprintf(p, ")");
         gtk_entry_set_text(GTK_ENTRY(entry), buf);
 #if TARGET_GTK_VERSION == 2
         gtk_entry_set_editable(GTK_ENTRY(entry), FALSE);
@@ -149,7 +156,7 @@ static GtkWidget *create_table_int(void)
         gtk_editable_set_editable(GTK_EDITABLE(entry), FALSE);
 #endif
         gtk_entry_set_max_length(GTK_ENTRY(entry), TEXT_LEN_INT);
-        gtk_entry_set_width_chars(GTK_ENTRY(entry), TEXT_LEN_INT);
+        gtk_entry_set_width_chars(GTK_ENTRY(entry), TEXT_WIDTH_INT);
         /* want to return value to calc either by clicking mouse on the value
          * (button-release) or by using keyboard to give focus to the value
          * and press enter (activate) */
@@ -265,14 +272,14 @@ static void history_open_int(void)
     gtk_widget_show_all(window_hist_int);
 }
 
-static void history_add_int(uint64_t ival)
+static void history_add_int(calc_int_t ival)
 {
     if (ival == 0)
     {
         return;
     }
 
-    uint64_t res;
+    calc_int_t res;
     bool is_unsigned = calc_get_use_unsigned();
 
     if (is_unsigned)
@@ -282,15 +289,15 @@ static void history_add_int(uint64_t ival)
     else
     {
         /* sign extend in case it's negative */
-        calc_width_enum width = calc_get_integer_width();
-        int64_t si = calc_util_get_signed(ival, width);
-        res = si;
+        calc_width_t width = calc_get_integer_width();
+        calc_sint_t si = calc_util_get_signed(ival, width);
+        res = (calc_int_t)si;
     }
 
 #ifdef HISTORY_FILTER_OUT_DUPLICATES
     /* filter out consecutive same values */
     if (res == history_ival[0].ival &&
-        (res <= INT64_MAX || (is_unsigned == history_ival[0].is_unsigned)))
+        (res <= (calc_int_t)CALC_SINT_MAX || (is_unsigned == history_ival[0].is_unsigned)))
     {
         return;
     }
@@ -335,7 +342,7 @@ static void entry_enter_pressed_float(GtkWidget *widget, gpointer data)
      * intended to be used in float mode */
     if (calc_get_mode() == calc_mode_float)
     {
-        calc_give_arg(0, history_fval_copy[row]);
+        calc_give_inexact_arg(history_fval_copy[row]);
         calc_give_op(cop_peek);
         gtk_widget_destroy(window_hist_float);
     }
@@ -357,7 +364,7 @@ static gboolean entry_button_release_float(GtkWidget *widget,
         if (calc_get_mode() != calc_mode_float)
             return FALSE;
 
-        calc_give_arg(0, history_fval_copy[row]);
+        calc_give_inexact_arg(history_fval_copy[row]);
         calc_give_op(cop_peek);
         gtk_widget_destroy(window_hist_float);
         return TRUE;
@@ -563,7 +570,7 @@ void gui_history_open(void)
     }
 }
 
-void gui_history_add(uint64_t ival, stackf_t fval)
+void gui_history_add(calc_int_t ival, stackf_t fval)
 {
     if (calc_get_mode() == calc_mode_integer)
     {
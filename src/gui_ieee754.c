@@ -0,0 +1,323 @@
+/*****************************************************************************
+ * File gui_ieee754.c part of ProgAndSciCalc
+ *
+ * Copyright (C) 2018 Ken Bromham
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "gui_internal.h"
+#include "display.h"
+#include "display_widget.h"
+#include "display_print.h"
+#include "radix_print.h"
+#include "ieee754.h"
+
+/* IEEE 754 window. Shows the fields and value of a binary float encoding
+ * (binary16, bfloat16, binary32, binary64 or binary128), or the nearest
+ * encoding of a value with the rounding error. While it's open the
+ * calculator's binary display views integer values in the format too. */
+
+/* window, there will only ever be one */
+static GtkWidget *window_ieee;
+static GtkWidget *entry_bits;
+static GtkWidget *entry_value;
+static GtkWidget *label_fields;
+static GtkWidget *label_error;
+static GtkWidget *label_status;
+static GtkWidget *rbut_format[ieee_num_formats];
+
+static ieee_format_enum format = ieee_binary32;
+
+#define ENTRY_WIDTH 45
+
+
+static void ieee_destroy(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    display_widget_set_ieee_format(-1);
+    window_ieee = NULL;
+}
+
+static void close_button_clicked(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    gtk_widget_destroy(window_ieee);
+}
+
+/* fill in everything from the bits, err NULL if not encoding a value */
+static void show_encoding(calc_int_t bits, const stackf_t *err)
+{
+    const ieee_format_t *fmt = ieee_get_format(format);
+    ieee_fields_t fields;
+    stackf_t fval;
+    char hex[RADIX_PRINT_MAX];
+    char buf[RADIX_PRINT_MAX + 80];
+    int len;
+
+    static const char *class_names[] =
+    {
+        "zero", "subnormal", "normal", "infinite", "NaN"
+    };
+
+    radix_print(hex, bits, 16, fmt->bits / 4, 0, NULL);
+    snprintf(buf, sizeof(buf), "0x%s", hex);
+    gtk_entry_set_text(GTK_ENTRY(entry_bits), buf);
+
+    ieee_to_dfp(format, bits, &fval);
+    display_print_gmode(buf, fval, DECQUAD_Pmax);
+    gtk_entry_set_text(GTK_ENTRY(entry_value), buf);
+
+    ieee_decode(format, bits, &fields);
+    radix_print(hex, fields.mant, 16, (fmt->mant_bits + 3) / 4, 0, NULL);
+    len = snprintf(buf, sizeof(buf), "sign %d  exponent %d", fields.sign,
+                   fields.biased_exp);
+    if (fields.cls == ieee_normal || fields.cls == ieee_subnormal)
+    {
+        len += snprintf(buf + len, sizeof(buf) - len, " (2^%d)", fields.exp);
+    }
+    snprintf(buf + len, sizeof(buf) - len, "  mantissa 0x%s  %s", hex,
+             class_names[fields.cls]);
+    gtk_label_set_text(GTK_LABEL(label_fields), buf);
+
+    if (err != NULL)
+    {
+        len = snprintf(buf, sizeof(buf), "Rounding error ");
+        display_print_gmode(buf + len, *err, 6);
+        strcat(buf, " ulp");
+        gtk_label_set_text(GTK_LABEL(label_error), buf);
+    }
+    else
+    {
+        gtk_label_set_text(GTK_LABEL(label_error), "");
+    }
+    gtk_label_set_text(GTK_LABEL(label_status), "");
+}
+
+static void encode(const stackf_t *fval)
+{
+    stackf_t err;
+    calc_int_t bits = ieee_from_dfp(format, fval, &err);
+
+    show_encoding(bits, &err);
+}
+
+static void decode_entry(void)
+{
+    calc_int_t bits;
+    const char *text = gtk_entry_get_text(GTK_ENTRY(entry_bits));
+
+    if (!calc_util_unsigned_str_to_ival(text, ieee_get_format(format)->bits,
+                                        &bits, 16))
+    {
+        gtk_label_set_text(GTK_LABEL(label_status),
+                           "Bits must be hex that fits the format");
+        return;
+    }
+    show_encoding(bits, NULL);
+}
+
+static void encode_entry(void)
+{
+    const char *text = gtk_entry_get_text(GTK_ENTRY(entry_value));
+    decContext set = dfp_context;
+    stackf_t fval;
+
+    dfp_context_clear_status(&set);
+    dfp_from_string(&fval, text, &set);
+    if (set.status & DEC_Conversion_syntax)
+    {
+        gtk_label_set_text(GTK_LABEL(label_status),
+                           "Value must be a number eg. 0.1, 1e-3, Inf, NaN");
+        return;
+    }
+    encode(&fval);
+}
+
+/* The integer value is taken as the bits, the float value is encoded */
+static void from_calc(void)
+{
+    calc_int_t ival;
+    stackf_t fval;
+
+    display_get_val(&ival, &fval);
+    if (calc_get_mode() == calc_mode_integer)
+    {
+        show_encoding(ival & calc_util_width_mask(ieee_get_format(format)->bits),
+                      NULL);
+    }
+    else
+    {
+        encode(&fval);
+    }
+}
+
+static void bits_activate(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    decode_entry();
+}
+
+static void value_activate(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    encode_entry();
+}
+
+static void from_calc_button_clicked(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    from_calc();
+}
+
+/* bits to integer mode, the value to floating mode */
+static void to_calc_button_clicked(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    if (calc_get_mode() == calc_mode_integer)
+    {
+        gui_paste_text(gtk_entry_get_text(GTK_ENTRY(entry_bits)), 16);
+    }
+    else
+    {
+        gui_paste_text(gtk_entry_get_text(GTK_ENTRY(entry_value)), 10);
+    }
+}
+
+static void format_toggled(GtkWidget *widget, gpointer data)
+{
+    if (!gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(widget)))
+    {
+        return;
+    }
+    format = (ieee_format_enum)(uintptr_t)data;
+    display_widget_set_ieee_format(format);
+    from_calc();
+}
+
+static GtkWidget *button_new(const char *mnemonic, GCallback clicked)
+{
+    GtkWidget *button = gtk_button_new_with_mnemonic(mnemonic);
+    g_signal_connect(button, "clicked", clicked, NULL);
+    return button;
+}
+
+static GtkWidget *entry_row_new(const char *name, GtkWidget **entry,
+                                GCallback activate)
+{
+    GtkWidget *hbox = gui_hbox_new(FALSE, 5);
+    GtkWidget *label = gui_label_new(name, 0, 0.5);
+
+    gtk_widget_set_size_request(label, 50, -1);
+    gtk_box_pack_start(GTK_BOX(hbox), label, FALSE, FALSE, 0);
+    *entry = gtk_entry_new();
+    gtk_entry_set_width_chars(GTK_ENTRY(*entry), ENTRY_WIDTH);
+    g_signal_connect(*entry, "activate", activate, NULL);
+    gtk_box_pack_start(GTK_BOX(hbox), *entry, TRUE, TRUE, 0);
+    return hbox;
+}
+
+void gui_ieee754_open(void)
+{
+    GtkWidget *vbox;
+    GtkWidget *hbox;
+    GtkWidget *button;
+    GSList *group = NULL;
+
+    if (window_ieee != NULL)
+    {
+        /* already open */
+        return;
+    }
+
+    window_ieee = gtk_window_new(GTK_WINDOW_TOPLEVEL);
+    gtk_window_set_title(GTK_WINDOW(window_ieee), "IEEE 754");
+    g_signal_connect(window_ieee, "destroy", G_CALLBACK(ieee_destroy), NULL);
+    gtk_container_set_border_width(GTK_CONTAINER(window_ieee), 10);
+
+    vbox = gui_vbox_new(FALSE, 0);
+    gtk_container_add(GTK_CONTAINER(window_ieee), vbox);
+
+    /* format */
+    hbox = gui_hbox_new(FALSE, 5);
+    for (int i = 0; i < ieee_num_formats; i++)
+    {
+        rbut_format[i] = gtk_radio_button_new_with_label(group,
+                             ieee_get_format(i)->name);
+        group = gtk_radio_button_get_group(GTK_RADIO_BUTTON(rbut_format[i]));
+        gtk_box_pack_start(GTK_BOX(hbox), rbut_format[i], FALSE, FALSE, 0);
+    }
+    gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(rbut_format[format]), TRUE);
+    for (int i = 0; i < ieee_num_formats; i++)
+    {
+        g_signal_connect(rbut_format[i], "toggled",
+                         G_CALLBACK(format_toggled), (gpointer)(uintptr_t)i);
+    }
+    gtk_box_pack_start(GTK_BOX(vbox), hbox, FALSE, FALSE, 0);
+
+    gtk_box_pack_start(GTK_BOX(vbox),
+                       entry_row_new("Bits", &entry_bits,
+                                     G_CALLBACK(bits_activate)),
+                       FALSE, FALSE, 5);
+    gtk_box_pack_start(GTK_BOX(vbox),
+                       entry_row_new("Value", &entry_value,
+                                     G_CALLBACK(value_activate)),
+                       FALSE, FALSE, 0);
+
+    label_fields = gui_label_new("", 0, 0.5);
+    gtk_box_pack_start(GTK_BOX(vbox), label_fields, FALSE, FALSE, 5);
+    label_error = gui_label_new("", 0, 0.5);
+    gtk_box_pack_start(GTK_BOX(vbox), label_error, FALSE, FALSE, 0);
+    label_status = gui_label_new("", 0, 0.5);
+    gtk_box_pack_start(GTK_BOX(vbox), label_status, FALSE, FALSE, 5);
+
+    /* buttons */
+    hbox = gui_hbox_new(FALSE, 5);
+    gtk_box_pack_start(GTK_BOX(hbox),
+                       button_new("_From Calculator",
+                                  G_CALLBACK(from_calc_button_clicked)),
+                       FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(hbox),
+                       button_new("_To Calculator",
+                                  G_CALLBACK(to_calc_button_clicked)),
+                       FALSE, FALSE, 0);
+    button = button_new("_Close", G_CALLBACK(close_button_clicked));
+    gtk_widget_set_size_request(button, 80, -1);
+#if TARGET_GTK_VERSION == 2
+    GtkWidget *align = gtk_alignment_new(1, 0, 0, 0);
+    gtk_container_add(GTK_CONTAINER(align), button);
+    gtk_box_pack_start(GTK_BOX(hbox), align, TRUE, TRUE, 0);
+#elif TARGET_GTK_VERSION == 3
+    gtk_widget_set_halign(button, GTK_ALIGN_END);
+    gtk_box_pack_start(GTK_BOX(hbox), button, TRUE, TRUE, 0);
+#endif
+    gtk_box_pack_start(GTK_BOX(vbox), hbox, FALSE, FALSE, 10);
+
+    display_widget_set_ieee_format(format);
+    from_calc();
+    gtk_widget_show_all(window_ieee);
+}
@@ -48,9 +48,11 @@ extern const FLOAT_DIGITS_RB float_digits_rb[NUM_FLOAT_DIGITS_ID];
 typedef struct
 {
     char *name;
-    calc_width_enum id;
+    calc_width_t id;
 } INT_WIDTH_RB;
-extern const INT_WIDTH_RB int_width_rb[num_calc_widths];
+/* the preset widths, any other width is set with the entry next to them */
+#define NUM_INT_WIDTH_RB 5
+extern const INT_WIDTH_RB int_width_rb[NUM_INT_WIDTH_RB];
 
 /* Info for integer signed/unsigned radio buttons */
 typedef struct
@@ -72,12 +74,33 @@ void options_menu_add(GtkWidget *menubar);
 void help_menu_add(GtkWidget *menubar);
 void conversion_menu_add(GtkWidget *menubar);
 void constants_menu_add(GtkWidget *menubar);
+void tools_menu_add(GtkWidget *menubar);
 
 void gui_menu_constants_init(void);
 void gui_menu_constants_deinit(void);
+bool gui_menu_constants_get(int n, const char **name, const char **value);
 
 void gui_history_init(void);
 void gui_history_open(void);
-void gui_history_add(uint64_t ival, stackf_t fval);
+void gui_history_add(calc_int_t ival, stackf_t fval);
+
+void gui_bigint_open(void);
+void gui_checksum_open(void);
+void gui_modular_open(void);
+void gui_fixed_open(void);
+void gui_ieee754_open(void);
+void gui_lanes_open(void);
+void gui_rational_open(void);
+void gui_recognise_open(void);
+void gui_invsym_open(void);
+
+/* update the status label, after the modulus for mod m mode, the fixed
+ * point format, the lane width or rational mode changes */
+void gui_update_status(void);
+
+/* Give the value in text (base 10 or 16 in integer mode) to the
+ * calculator, as for paste. In integer mode the width is changed if needed
+ * to fit the value. */
+void gui_paste_text(const char *text, int base);
 
 #endif
@@ -0,0 +1,310 @@
+/*****************************************************************************
+ * File gui_invsym.c part of ProgAndSciCalc
+ *
+ * Copyright (C) 2018 Ken Bromham
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <ctype.h>
+
+#include "gui_internal.h"
+#include "config.h"
+#include "display_print.h"
+#include "invsym.h"
+
+/* Inverse Symbolic window. Takes the floating mode value from the
+ * calculator and shows the simplest expressions on pi, e etc. and the
+ * user's constants that match it to the number of digits given. The index
+ * is opened (built the first time) when the window opens, and closed with
+ * it. */
+
+/* window, there will only ever be one */
+static GtkWidget *window_invsym;
+static GtkWidget *entry_digits;
+static GtkWidget *entry_value;
+static GtkWidget *label_status;
+
+#define MAX_MATCHES 8
+static GtkWidget *entry_match[MAX_MATCHES];
+
+static const char *INDEXFILE = "invsym_index";
+
+#define DIGITS_DEFAULT "12"
+#define DIGITS_MIN 4
+#define DIGITS_MAX 30
+
+#define ENTRY_WIDTH 70
+
+/* the index didn't open, ie. out of memory */
+static bool index_failed;
+static char index_status[80];
+
+
+static void invsym_destroy(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    invsym_close();
+    window_invsym = NULL;
+}
+
+static void close_button_clicked(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    gtk_widget_destroy(window_invsym);
+}
+
+/* the constants file values that are numbers */
+static int get_user_constants(invsym_const_t *user)
+{
+    decContext set = dfp_context;
+    const char *name;
+    const char *value;
+    int num = 0;
+
+    for (int n = 0; num < INVSYM_MAX_USER &&
+                    gui_menu_constants_get(n, &name, &value); n++)
+    {
+        char buf[DFP_STRING_MAX];
+        char *end;
+
+        while (isspace((unsigned char)*value))
+        {
+            value++;
+        }
+        buf[0] = '\0';
+        strncat(buf, value, sizeof(buf) - 1);
+        for (end = buf + strlen(buf); end > buf && isspace((unsigned char)end[-1]);
+             end--)
+            ;
+        *end = '\0';
+
+        dfp_context_clear_status(&set);
+        dfp_from_string(&user[num].value, buf, &set);
+        if ((set.status & DEC_Conversion_syntax) || dfp_is_nan(&user[num].value))
+            continue;
+        user[num].name[0] = '\0';
+        strncat(user[num].name, name, INVSYM_NAME_MAX);
+        num++;
+    }
+    return num;
+}
+
+static void open_index(void)
+{
+    invsym_const_t user[INVSYM_MAX_USER];
+    int num_user = get_user_constants(user);
+    bool built;
+
+    /* saved with the config if there's the directory for it, otherwise
+     * built each time */
+    gchar *filename = g_build_filename(g_get_home_dir(), config_get_dirname(),
+                                       INDEXFILE, NULL);
+    index_failed = !invsym_open(filename, user, num_user, 0, &built);
+    g_free(filename);
+
+    if (index_failed)
+    {
+        snprintf(index_status, sizeof(index_status),
+                 "Not enough memory for the index");
+    }
+    else
+    {
+        snprintf(index_status, sizeof(index_status),
+                 "%d expressions%s, %d of your constants", invsym_size(),
+                 built ? " (index built)" : "", num_user);
+    }
+}
+
+static void clear_results(void)
+{
+    gtk_entry_set_text(GTK_ENTRY(entry_value), "");
+    for (int i = 0; i < MAX_MATCHES; i++)
+    {
+        gtk_entry_set_text(GTK_ENTRY(entry_match[i]), "");
+    }
+}
+
+/* decimal, DIGITS_MIN to DIGITS_MAX */
+static bool get_digits(int *digits)
+{
+    const char *p = gtk_entry_get_text(GTK_ENTRY(entry_digits));
+    int v = 0;
+
+    if (*p == '\0')
+        return false;
+    for (; *p != '\0'; p++)
+    {
+        if (!isdigit((unsigned char)*p))
+            return false;
+        v = v * 10 + (*p - '0');
+        if (v > DIGITS_MAX)
+            return false;
+    }
+    *digits = v;
+    return v >= DIGITS_MIN;
+}
+
+static void lookup(void)
+{
+    char buf[INVSYM_TEXT_MAX + DFP_STRING_MAX + 10];
+    invsym_match_t m[MAX_MATCHES];
+    stackf_t fval;
+    int digits;
+    int num;
+
+    clear_results();
+    gtk_label_set_text(GTK_LABEL(label_status), index_status);
+    if (index_failed)
+        return;
+    if (!get_digits(&digits))
+    {
+        snprintf(buf, sizeof(buf), "Digits must be from %d to %d",
+                 DIGITS_MIN, DIGITS_MAX);
+        gtk_label_set_text(GTK_LABEL(label_status), buf);
+        return;
+    }
+    if (calc_get_mode() != calc_mode_float)
+    {
+        gtk_label_set_text(GTK_LABEL(label_status),
+                           "Takes the value in floating mode");
+        return;
+    }
+
+    gui_give_arg_if_pending();
+    fval = calc_get_fval_top_of_stack();
+    display_print_gmode(buf, fval, DECQUAD_Pmax);
+    gtk_entry_set_text(GTK_ENTRY(entry_value), buf);
+
+    num = invsym_lookup(&fval, digits, m, MAX_MATCHES);
+    if (num == 0)
+    {
+        gtk_entry_set_text(GTK_ENTRY(entry_match[0]), "No match");
+    }
+    /* eg. pi^2 / 4  = 2.467401100272339654708622749969038 */
+    for (int i = 0; i < num; i++)
+    {
+        strcpy(buf, m[i].text);
+        strcat(buf, "  = ");
+        display_print_gmode(buf + strlen(buf), m[i].value, DECQUAD_Pmax);
+        gtk_entry_set_text(GTK_ENTRY(entry_match[i]), buf);
+    }
+}
+
+static void from_calc_button_clicked(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    lookup();
+}
+
+static void digits_activate(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    lookup();
+}
+
+static GtkWidget *result_row(GtkWidget *vbox, const char *name)
+{
+    GtkWidget *hbox = gui_hbox_new(FALSE, 5);
+    GtkWidget *label = gui_label_new(name, 0, 0.5);
+    GtkWidget *entry = gtk_entry_new();
+
+    gtk_label_set_width_chars(GTK_LABEL(label), 8);
+    gtk_box_pack_start(GTK_BOX(hbox), label, FALSE, FALSE, 0);
+    gtk_entry_set_width_chars(GTK_ENTRY(entry), ENTRY_WIDTH);
+#if TARGET_GTK_VERSION == 2
+    gtk_entry_set_editable(GTK_ENTRY(entry), FALSE);
+#elif TARGET_GTK_VERSION == 3
+    gtk_editable_set_editable(GTK_EDITABLE(entry), FALSE);
+#endif
+    gtk_box_pack_start(GTK_BOX(hbox), entry, TRUE, TRUE, 0);
+    gtk_box_pack_start(GTK_BOX(vbox), hbox, FALSE, FALSE, 2);
+    return entry;
+}
+
+void gui_invsym_open(void)
+{
+    GtkWidget *vbox;
+    GtkWidget *hbox;
+    GtkWidget *button;
+
+    if (window_invsym != NULL)
+    {
+        /* already open */
+        return;
+    }
+
+    open_index();
+
+    window_invsym = gtk_window_new(GTK_WINDOW_TOPLEVEL);
+    gtk_window_set_title(GTK_WINDOW(window_invsym), "Inverse Symbolic");
+    g_signal_connect(window_invsym, "destroy",
+                     G_CALLBACK(invsym_destroy), NULL);
+    gtk_container_set_border_width(GTK_CONTAINER(window_invsym), 10);
+
+    vbox = gui_vbox_new(FALSE, 0);
+    gtk_container_add(GTK_CONTAINER(window_invsym), vbox);
+
+    /* digits to match */
+    hbox = gui_hbox_new(FALSE, 5);
+    gtk_box_pack_start(GTK_BOX(hbox), gui_label_new("Digits", 0, 0.5),
+                       FALSE, FALSE, 0);
+    entry_digits = gtk_entry_new();
+    gtk_entry_set_width_chars(GTK_ENTRY(entry_digits), 4);
+    gtk_entry_set_text(GTK_ENTRY(entry_digits), DIGITS_DEFAULT);
+    g_signal_connect(entry_digits, "activate",
+                     G_CALLBACK(digits_activate), NULL);
+    gtk_box_pack_start(GTK_BOX(hbox), entry_digits, FALSE, FALSE, 0);
+    button = gtk_button_new_with_mnemonic("_From Calculator");
+    g_signal_connect(button, "clicked",
+                     G_CALLBACK(from_calc_button_clicked), NULL);
+    gtk_box_pack_start(GTK_BOX(hbox), button, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(vbox), hbox, FALSE, FALSE, 5);
+
+    entry_value = result_row(vbox, "x");
+    for (int i = 0; i < MAX_MATCHES; i++)
+    {
+        entry_match[i] = result_row(vbox, i == 0 ? "Matches" : "");
+    }
+
+    label_status = gui_label_new("", 0, 0.5);
+    gtk_box_pack_start(GTK_BOX(vbox), label_status, FALSE, FALSE, 5);
+
+    /* buttons */
+    hbox = gui_hbox_new(FALSE, 5);
+    button = gtk_button_new_with_mnemonic("_Close");
+    g_signal_connect(button, "clicked", G_CALLBACK(close_button_clicked), NULL);
+    gtk_widget_set_size_request(button, 80, -1);
+#if TARGET_GTK_VERSION == 2
+    GtkWidget *align = gtk_alignment_new(1, 0, 0, 0);
+    gtk_container_add(GTK_CONTAINER(align), button);
+    gtk_box_pack_start(GTK_BOX(hbox), align, TRUE, TRUE, 0);
+#elif TARGET_GTK_VERSION == 3
+    gtk_widget_set_halign(button, GTK_ALIGN_END);
+    gtk_box_pack_start(GTK_BOX(hbox), button, TRUE, TRUE, 0);
+#endif
+    gtk_box_pack_start(GTK_BOX(vbox), hbox, FALSE, FALSE, 10);
+
+    lookup();
+    gtk_widget_show_all(window_invsym);
+}
@@ -0,0 +1,178 @@
+/*****************************************************************************
+ * File gui_lanes.c   part of ProgAndSciCalc
+ *
+ * Copyright (C) 2018 Ken Bromham
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "gui_internal.h"
+
+/* Lanes window. Sets the lane width for lanes (SWAR) mode in integer
+ * mode, where + - * / work on each lane separately and the display shows
+ * each lane's value. */
+
+/* window, there will only ever be one */
+static GtkWidget *window_lanes;
+static GtkWidget *label_lanes;
+static GtkWidget *label_status;
+
+static const int lane_widths[] = { 0, 8, 16, 32, 64 };
+#define NUM_LANE_WIDTHS (int)(sizeof(lane_widths) / sizeof(lane_widths[0]))
+static GtkWidget *rbut_lanes[NUM_LANE_WIDTHS];
+
+
+static void lanes_destroy(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    window_lanes = NULL;
+}
+
+static void close_button_clicked(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    gtk_widget_destroy(window_lanes);
+}
+
+static void show_lanes(void)
+{
+    char buf[80];
+    int lanes = calc_get_lanes();
+
+    if (lanes == 0)
+    {
+        snprintf(buf, sizeof(buf), "Off, normal integer arithmetic");
+    }
+    else
+    {
+        snprintf(buf, sizeof(buf), "%d lanes of %d bits",
+                 calc_get_integer_width() / lanes, lanes);
+    }
+    gtk_label_set_text(GTK_LABEL(label_lanes), buf);
+    gui_update_status();
+}
+
+static void lanes_toggled(GtkWidget *widget, gpointer data)
+{
+    int lanes = lane_widths[(uintptr_t)data];
+
+    if (!gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(widget)) ||
+        lanes == calc_get_lanes())
+    {
+        return;
+    }
+    gui_give_arg_if_pending();
+    if (calc_set_lanes(lanes))
+    {
+        gtk_label_set_text(GTK_LABEL(label_status), "");
+    }
+    else
+    {
+        gtk_label_set_text(GTK_LABEL(label_status),
+                           "The width must be a multiple of the lane width");
+        /* back to what it was */
+        for (int i = 0; i < NUM_LANE_WIDTHS; i++)
+        {
+            if (lane_widths[i] == calc_get_lanes())
+            {
+                gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(rbut_lanes[i]),
+                                             TRUE);
+            }
+        }
+    }
+    show_lanes();
+}
+
+void gui_lanes_open(void)
+{
+    GtkWidget *vbox;
+    GtkWidget *hbox;
+    GtkWidget *button;
+    GSList *group = NULL;
+    char name[8];
+
+    if (window_lanes != NULL)
+    {
+        /* already open */
+        return;
+    }
+
+    window_lanes = gtk_window_new(GTK_WINDOW_TOPLEVEL);
+    gtk_window_set_title(GTK_WINDOW(window_lanes), "Lanes");
+    g_signal_connect(window_lanes, "destroy",
+                     G_CALLBACK(lanes_destroy), NULL);
+    gtk_container_set_border_width(GTK_CONTAINER(window_lanes), 10);
+
+    vbox = gui_vbox_new(FALSE, 0);
+    gtk_container_add(GTK_CONTAINER(window_lanes), vbox);
+
+    /* lane width */
+    hbox = gui_hbox_new(FALSE, 5);
+    gtk_box_pack_start(GTK_BOX(hbox), gui_label_new("Lane width", 0, 0.5),
+                       FALSE, FALSE, 0);
+    for (int i = 0; i < NUM_LANE_WIDTHS; i++)
+    {
+        if (lane_widths[i] == 0)
+        {
+            snprintf(name, sizeof(name), "Off");
+        }
+        else
+        {
+            snprintf(name, sizeof(name), "%d", lane_widths[i]);
+        }
+        rbut_lanes[i] = gtk_radio_button_new_with_label(group, name);
+        group = gtk_radio_button_get_group(GTK_RADIO_BUTTON(rbut_lanes[i]));
+        if (lane_widths[i] == calc_get_lanes())
+        {
+            gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(rbut_lanes[i]),
+                                         TRUE);
+        }
+        gtk_box_pack_start(GTK_BOX(hbox), rbut_lanes[i], FALSE, FALSE, 0);
+    }
+    for (int i = 0; i < NUM_LANE_WIDTHS; i++)
+    {
+        g_signal_connect(rbut_lanes[i], "toggled",
+                         G_CALLBACK(lanes_toggled), (gpointer)(uintptr_t)i);
+    }
+    gtk_box_pack_start(GTK_BOX(vbox), hbox, FALSE, FALSE, 0);
+
+    label_lanes = gui_label_new("", 0, 0.5);
+    gtk_box_pack_start(GTK_BOX(vbox), label_lanes, FALSE, FALSE, 5);
+
+    label_status = gui_label_new("", 0, 0.5);
+    gtk_box_pack_start(GTK_BOX(vbox), label_status, FALSE, FALSE, 5);
+
+    /* buttons */
+    hbox = gui_hbox_new(FALSE, 5);
+    button = gtk_button_new_with_mnemonic("_Close");
+    g_signal_connect(button, "clicked", G_CALLBACK(close_button_clicked), NULL);
+    gtk_widget_set_size_request(button, 80, -1);
+#if TARGET_GTK_VERSION == 2
+    GtkWidget *align = gtk_alignment_new(1, 0, 0, 0);
+    gtk_container_add(GTK_CONTAINER(align), button);
+    gtk_box_pack_start(GTK_BOX(hbox), align, TRUE, TRUE, 0);
+#elif TARGET_GTK_VERSION == 3
+    gtk_widget_set_halign(button, GTK_ALIGN_END);
+    gtk_box_pack_start(GTK_BOX(hbox), button, TRUE, TRUE, 0);
+#endif
+    gtk_box_pack_start(GTK_BOX(vbox), hbox, FALSE, FALSE, 10);
+
+    show_lanes();
+    gtk_widget_show_all(window_lanes);
+}
@@ -40,6 +40,9 @@ GtkWidget *create_menu(void)
     /* Constants */
     constants_menu_add(menubar);
 
+    /* Tools */
+    tools_menu_add(menubar);
+
     gtk_box_pack_start(GTK_BOX(menu_vbox), menubar, FALSE, FALSE, 0);
     gtk_widget_show_all(menu_vbox);
 
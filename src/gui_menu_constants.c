@@ -357,6 +357,22 @@ static void load_entries(FILE *fp)
     }
 }
 
+/* the n th constant of all the categories in turn, false past the last */
+bool gui_menu_constants_get(int n, const char **name, const char **value)
+{
+    for (int i = 0; i < num_categories; i++)
+    {
+        if (n < cat_table[i]->num_rows)
+        {
+            *name = cat_table[i]->row_name[n];
+            *value = cat_table[i]->row_val[n];
+            return true;
+        }
+        n -= cat_table[i]->num_rows;
+    }
+    return false;
+}
+
 
 /* load entries from constants file if it exists */
 void gui_menu_constants_init(void)
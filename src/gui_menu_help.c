@@ -27,9 +27,12 @@ extern GtkWidget *window_main;
 static const char *instructions[] =
 {
 "MODE\n"
-"Integer  - Performs operations on integers, 8, 16, 32 or 64 bits, signed or unsigned.\n"
+"Integer  - Performs operations on integers of any width from 1 to 128 bits, signed or\n"
+"           unsigned. 8, 16, 32, 64 and 128 have their own buttons, any other width can\n"
+"           be typed in the box next to \"other\" (press enter to apply).\n"
 "           The main display can be decimal or hex, the value is also shown in binary\n"
-"           under the main display. Hex values, as with the binary display, show the bit\n"
+"           under the main display (rows of 32 bits, more rows appear for widths\n"
+"           above 64). Hex values, as with the binary display, show the bit\n"
 "           pattern and so look the same whether signed or unsigned. The binary display\n"
 "           is interactive ie. you can click on an individual bit to toggle that bit.\n"
 "Floating - uses decQuad decimal floating point type (34 digits internally). The display\n"
@@ -56,7 +59,7 @@ static const char *instructions[] =
 "[root] is the reverse eg. 8 [root] 3 = 2\n"
 "[<<n] [>>n] are left shift and right shift by n eg. 20 [<<n] 2 = 80, 20 [>>n] 2 = 5\n"
 "[and] [or] [xor] are bitwise operations\n"
-"[gcd] is greatest common divisor eg. 9 [gcd] 6 = 3\n\n"
+"[gcd] is greatest common divisor eg. 9 [gcd] 6 = 3, always positive for signed values\n\n"
 "Precedence, from low to high, is ADD_SUB, MUL_DIV, POWER_ROOT.\n"
 "Associativity in all cases (including POWER_ROOT) is left to right.\n"
 "eg. 1 + 2 * 3 = 7\n"
@@ -93,6 +96,51 @@ static const char *instructions[] =
 "  use [INV][sin] etc. to get inverse\n"
 "[<<] [>>] are left shift and right shift by 1 place\n"
 "[rol] [ror] rotate (circular shift) left or right by 1 place\n"
+"[bits] opens a menu of bit operations, all within the current integer width\n"
+"  popcount (number of 1 bits), clz (count leading zeros), ctz (count\n"
+"  trailing zeros), parity (1 if odd number of 1 bits), bit reverse, byte swap\n"
+"  (width must be a multiple of 8). After a count the binary display shows the\n"
+"  argument with the bits counted underlined, until the next value.\n"
+"  pdep and pext are binary ops, x [pdep] mask deposits the low bits of x into\n"
+"  the bits set in mask, x [pext] mask extracts the bits of x where mask is set\n"
+"  and packs them at the bottom eg. 0xf0 [pext] 0x3c = 0xc\n"
+"  morton 2-D is a binary op giving the Morton (Z-order) index of x and y,\n"
+"  x in the even bits and y in the odd.\n"
+"  spread 2 moves bit i to bit 2i, compact 2 is the inverse, so a 2-D index\n"
+"  gives back x with [compact 2] and y with [>>] [compact 2].\n"
+"  spread 3 and compact 3 do the same for 3-D, so the 3-D index of x, y, z is\n"
+"  spread3(x) | spread3(y) << 1 | spread3(z) << 2\n"
+"  clmul and clmulh are binary ops for carry-less multiply, treating the\n"
+"  values as polynomials over GF(2) (bit i the coefficient of x^i), giving\n"
+"  the low and high halves of the double width product.\n"
+"  GF(2) mod and GF(2) gcd are the remainder and greatest common divisor of\n"
+"  such polynomials eg. with width 16, 0x57 [clmul] 0x83 [GF(2) mod] 0x11b\n"
+"  = 0xc1 (multiply in the AES field)\n"
+"  lanes... opens a window to set a lane width of 8, 16, 32 or 64 bits (the\n"
+"  width must be a multiple of it), for looking at SIMD values. Then + - * /\n"
+"  mod and +/- work on each lane separately, wrapping within the lane, and\n"
+"  each lane's value is shown under the binary display (the status shows\n"
+"  LANES n). Bit ops, shifts and rotates still work on the whole value.\n"
+"  Lanes, mod m and fixed point are exclusive, setting one turns off the others.\n"
+"  lane add and lane sub saturate instead of wrapping, lane min and lane max\n"
+"  pick from each pair of lanes, lane compare = and lane compare > give all\n"
+"  ones in the lanes where true and 0 where false. They are signed or\n"
+"  unsigned as the calculator is, and treat the whole width as one lane\n"
+"  when lanes are off.\n"
+"[num] opens a menu of number theory operations on integers\n"
+"  is prime (1 or 0), next prime (smallest prime greater than x), isqrt and\n"
+"  icbrt (integer square and cube roots, rounded down), ilog2 and ilog10\n"
+"  (logs rounded down). factor shows the prime factors in a dialog\n"
+"  eg. 360 = 2^3 * 3^2 * 5. Up to 64 bits these are exact and take\n"
+"  milliseconds at most; above 64 bits is prime is exact below 3.3e24, and\n"
+"  factor may leave a composite factor it couldn't split.\n"
+"  mod m... opens a window to set a modulus m (2 to 2^64 - 1), then + - *\n"
+"  [sqr] and the menu's x^y mod m and 1/x mod m (modular inverse) are done\n"
+"  mod m, with results from 0 to m - 1 (the status shows MOD m). discrete log\n"
+"  is a binary op, a [discrete log] b gives the smallest x with a^x = b mod m\n"
+"  (the part of m coprime to a must be below 2^40). The window also solves\n"
+"  Chinese remainder problems eg. 2 mod 3, 3 mod 5, 2 mod 7 gives 23 mod 105,\n"
+"  the moduli don't have to be coprime.\n"
 "[x!] factorial, beware if x is not an integer value it is rounded up/down to closest integer",
 
 "MISCELLANEOUS\n"
@@ -160,10 +208,13 @@ static const char *instructions[] =
 "   xor                     ^\n"
 "   gcd                     g\n"
 "   not                     n\n"
+"   bits                    k\n"
+"   num                     j\n"
 " width 8                 ctrl-1\n"
 " width 16                ctrl-2\n"
 " width 32                ctrl-3\n"
-" width 64                ctrl-4\n\n"
+" width 64                ctrl-4\n"
+" width 128               ctrl-5\n\n"
 "It is possible to access other buttons from keyboard by using cursor keys to highlight\n"
 "the chosen button then pressing SPACEBAR.",
 
@@ -178,10 +229,11 @@ static const char *instructions[] =
 "the value fits in the range of the current settings is based on the integer width.\n"
 "A value in the range from INT8_MIN up to UINT8_MAX requires width 8. A value in the\n"
 "range from INT16_MIN up to UINT16_MAX requires width 16 etc. The width will be\n"
-"automatically increased (with a notification) if needed. The signed/unsigned setting\n"
+"automatically increased (with a notification) to the next of 8, 16, 32, 64 or 128\n"
+"bits if needed, a width that isn't one of those is kept if the value fits it. The signed/unsigned setting\n"
 "will not be changed. So if, for example, the current settings are width 8, unsigned,\n"
 "decimal, a value of -1 will give 255. If the value is negative and less than\n"
-"INT64_MIN, or positive and greater than UINT64_MAX, you get 0 (with a warning) and\n"
+"-2^127, or positive and greater than 2^128 - 1, you get 0 (with a warning) and\n"
 "the width will be unchanged. (NB. some of the behaviour here changed in version 2.6).\n\n"
 "Example 1, enter 123.456 in Floating mode, switch to Integer, now have 123, switch\n"
 "back to Floating mode, now have 123. The original value 123.456 can be retrieved\n"
@@ -199,6 +251,90 @@ static const char *instructions[] =
 "is taken as the value to convert. If this value is 0 then, with the exception of\n"
 "temperature conversion, the value 1 is used instead.",
 
+"BIG INTEGER\n"
+"Tools->Big Integer opens a window for integer arithmetic beyond 128 bits (up to\n"
+"2^24 bits), eg. 2**200, 100!, powmod(3, 1000, 2**127 - 1). Type an expression and\n"
+"press enter, the result is shown in decimal, hex and binary. Numbers can be decimal,\n"
+"or hex, octal, binary with a 0x, 0o, 0b prefix.\n"
+"  + - * / % (or mod) << >> & | ^   with the same precedence as the calculator\n"
+"  **   power, right to left ie. 2**3**2 = 2**9\n"
+"  - ~  unary minus and not,  !  factorial\n"
+"  gcd(a, b),  powmod(a, e, m)\n"
+"Division truncates towards 0, the remainder has the sign of the left operand.\n"
+"Bitwise operations on negative values act as if they were twos complement of\n"
+"unlimited width. [To Calculator] passes a result of up to 128 bits back to the\n"
+"calculator, changing the integer width if needed as for paste.",
+
+"CHECKSUM\n"
+"Tools->Checksum opens a window to work out a CRC or hash of some bytes, which can\n"
+"be typed as hex (eg. de ad be ef, 0xdeadbeef, de:ad:be:ef), typed as text, read\n"
+"from a file ([Browse...] or type the path), or be the calculator's current integer\n"
+"value (as many bytes as the width needs, most significant first).\n"
+"Choosing one of the listed CRCs (CRC-8, CRC-16, CRC-32, CRC-32C, CRC-64 variants)\n"
+"fills in its Width, Poly, Init, XorOut and reflection, which can then be changed\n"
+"for any other CRC of up to 64 bits, as in the usual CRC catalogue description.\n"
+"FNV-1a 64 and XXH64 (seed 0) hashes are also there.\n"
+"[To Calculator] passes the result to the calculator as for paste.\n"
+"CRC-32C uses the SSE4.2 crc32 instruction when the CPU has it.",
+
+"FIXED POINT\n"
+"Tools->Fixed Point sets integer mode to fixed point (Q format) eg. for checking DSP\n"
+"code. With n fraction bits the integer value v is taken as v / 2^n, so with width\n"
+"32 signed and 16 fraction bits (Q15.16) 0x18000 is 1.5. The width must be 64 or\n"
+"less with n less than the width; unsigned gives UQ formats. Under the binary\n"
+"display the real value is shown, eg. Q15.16 = 1.5 (the status shows Q16).\n"
+"  + - add and subtract the integer values\n"
+"  * / shift the product or dividend by n, rounding to nearest (halves up)\n"
+"  +/-  [sqr] [sqrt] [1/x] also work on the fixed point values\n"
+"Results that don't fit either saturate to the largest or smallest value, or wrap\n"
+"as normal integers do (with the overflow warning if enabled), as set in the window.\n"
+"Switching to floating mode gives the real value, and switching back converts the\n"
+"float value to fixed point with the width unchanged, rounding to nearest.\n"
+"Fixed point is turned off by setting a mod m modulus, or by changing to a width it\n"
+"doesn't fit.",
+
+"IEEE 754\n"
+"Tools->IEEE 754 opens a window for binary floating point encodings, binary16 (half),\n"
+"bfloat16, binary32 (float), binary64 (double) and binary128. [From Calculator] in\n"
+"integer mode takes the value as the bits of a float and shows its sign, exponent and\n"
+"mantissa fields, class (normal, subnormal etc.) and value. In floating mode it gives\n"
+"the nearest encoding of the value, with the rounding error in units of the last\n"
+"place (ulp) eg. 0.1 as binary32 is 0x3dcccccd, 0.2 ulp too big. Bits (hex) or a\n"
+"value can also be typed in. Conversions are correctly rounded (to nearest, ties to\n"
+"even) both ways, values being shown to 34 digits. While the window is open the\n"
+"binary display shows integer values in the chosen format, the exponent bits\n"
+"underlined and the value underneath. [To Calculator] gives the bits to integer mode,\n"
+"or the value to floating mode.",
+
+"RATIONAL\n"
+"Tools->Rational turns on rational mode for floating mode, where values are also kept\n"
+"as exact fractions so eg. 1 / 3 * 3 is exactly 1, and 1 / 3 + 1 / 6 = 1/2. The\n"
+"fraction is shown under the main display as a/b (eg. = 7/3) or mixed (= 2 1/3), the\n"
+"main display being the nearest decimal as normal. Values entered are taken exactly\n"
+"from their decimal (0.1 is 1/10). + - * / +/- [sqr] [1/x] and M+ give exact\n"
+"fractions, the numerator and denominator each up to 128 bits. Other operations (sqrt,\n"
+"sin, x^y etc.), pi, and results too big for 128 bits carry on in decimal floating\n"
+"point, with no fraction shown, until a new value is entered. The status shows\n"
+"RATIONAL while it is on.\n\n"
+"Tools->Recognise takes the floating mode value and shows its continued fraction,\n"
+"the convergents with a denominator up to a maximum (1000 by default, up to 10^12),\n"
+"and the closest fraction with that denominator or less, with its error. It also\n"
+"says whether the value is a simple fraction, or a fraction times pi or sqrt(2), to\n"
+"30 digits with a denominator up to the maximum (and 10^12), eg. 0.785398163397448309\n"
+"6156608458198757 is 1/4 pi and 0.7071067811865475244008443621048490 is 1/2 sqrt(2).\n"
+"This is all integer arithmetic on the decimal's coefficient, a few microseconds.\n\n"
+"Tools->Inverse Symbolic takes the floating mode value and shows the simplest\n"
+"expressions that match it to a number of digits (12 by default, 4 to 30), also as\n"
+"-(expression) or 1 / (expression), eg. 2.4674011002723 is pi^2 / 4. The expressions\n"
+"are on 1 to 12, pi, e, phi, gamma, zeta(3), G (Catalan's constant) and the first 64\n"
+"numbers in the constants file, each with one of x x^2 x^3 sqrt cbrt ln e^x, then two\n"
+"of those with + - * / (only one of them from the constants file), or one times a\n"
+"fraction p/q with p and q up to 12. The index of their values is built when the\n"
+"window is first opened, using all the CPU cores, and saved as\n"
+"  ~/.ProgAndSciCalc/invsym_index\n"
+"if the directory is there, to be mapped straight into memory the next time. It is\n"
+"built again when the constants file changes. A lookup is a few binary searches.",
+
 "CONSTANTS FILE FORMAT\n"
 "This is an optional text file named constants, which you should place here :-\n"
 "  ~/.ProgAndSciCalc/constants\n"
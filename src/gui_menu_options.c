@@ -36,10 +36,13 @@ static float_digits_enum float_digits;
 static GtkWidget *entry_ran_n;
 static bool random_01;
 static bool sct_round;
+static disp_float_format_enum float_format;
+static GtkWidget *entry_fixed_places;
+static bool digit_grouping;
 
 /* Settings Integer */
 static GtkWidget *window_settings_int;
-static calc_width_enum integer_width;
+static GtkWidget *entry_int_width;
 static bool use_unsigned;
 static int hex_group;
 static bool warn_on_signed_overflow;
@@ -363,6 +366,18 @@ static void settings_float_ok_button_clicked(GtkWidget *widget, gpointer data)
     config_set_use_sct_rounding(sct_round);
     calc_set_use_sct_rounding(sct_round);
 
+    /* number format, will take effect next time a result is displayed */
+    int places = get_entry_val(entry_fixed_places,
+                               DISP_FIXED_PLACES_MIN,
+                               DISP_FIXED_PLACES_MAX,
+                               DISP_FIXED_PLACES_DEFAULT);
+    config_set_float_format(float_format);
+    config_set_fixed_places(places);
+    config_set_digit_grouping(digit_grouping);
+    display_set_normal_float_format(float_format);
+    display_set_float_fixed_places(places);
+    display_set_float_grouping(digit_grouping);
+
     gtk_widget_destroy(window_settings_float);
 }
 
@@ -549,6 +564,97 @@ static void add_sct_rounding(GtkWidget *vbox)
     gtk_box_pack_start(GTK_BOX(vbox), button, FALSE, FALSE, 0);
 }
 
+typedef struct
+{
+    char *name;
+    disp_float_format_enum id;
+} FLOAT_FORMAT_RB;
+#define NUM_FLOAT_FORMAT_RB 5
+static const FLOAT_FORMAT_RB float_format_rb[NUM_FLOAT_FORMAT_RB] =
+{
+    { "general (1234.5, 1.2345e+20)", disp_float_gmode },
+    { "scientific (1.2345e+3)", disp_float_emode },
+    { "engineering (1.2345e+3, 12.345e+3)", disp_float_engmode },
+    { "SI prefix (1.2345k, 12.345u)", disp_float_si },
+    { "fixed decimal places", disp_float_fixed },
+};
+
+static void float_format_rb_toggle(GtkWidget *widget, gpointer data)
+{
+    const FLOAT_FORMAT_RB *info = data;
+    gboolean active = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(widget));
+
+    if (active)
+    {
+        float_format = info->id;
+        /* shouldn't be possible to get here and it's NULL, but just in case */
+        if (entry_fixed_places != NULL)
+            gtk_widget_set_sensitive(entry_fixed_places, float_format == disp_float_fixed);
+    }
+}
+
+static void grouping_button_toggle(GtkWidget *widget, gpointer data)
+{
+    (void)data;
+    gboolean active = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(widget));
+    digit_grouping = active;
+}
+
+#define FIXED_PLACES_TEXT_LEN 2
+
+static void add_float_format(GtkWidget *vbox)
+{
+    GtkWidget *hbox;
+    GtkWidget *lbl;
+    GtkWidget *button;
+    GSList *group = NULL;
+    char buf[40];
+    char msg[80];
+
+    float_format = config_get_float_format();
+    digit_grouping = config_get_digit_grouping();
+
+    lbl = gui_label_new("Number format for results", 0, 0.5);
+    gtk_box_pack_start(GTK_BOX(vbox), lbl, FALSE, FALSE, 0);
+
+    for (int i = 0; i < NUM_FLOAT_FORMAT_RB; i++)
+    {
+        button = gtk_radio_button_new_with_label(group, float_format_rb[i].name);
+        group = gtk_radio_button_get_group(GTK_RADIO_BUTTON(button));
+        if (float_format_rb[i].id == float_format)
+        {
+            gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(button), TRUE);
+        }
+        g_signal_connect(button, "toggled",
+                         G_CALLBACK(float_format_rb_toggle),
+                         (gpointer)&float_format_rb[i]);
+        gtk_box_pack_start(GTK_BOX(vbox), button, FALSE, FALSE, 0);
+    }
+
+    /* number of places entry */
+    hbox = gui_hbox_new(FALSE, 4);
+    sprintf(msg, "Decimal places (%d to %d, default %d)",
+            DISP_FIXED_PLACES_MIN, DISP_FIXED_PLACES_MAX, DISP_FIXED_PLACES_DEFAULT);
+    lbl = gui_label_new(msg, 0.5, 0.5);
+    entry_fixed_places = gtk_entry_new();
+    gtk_entry_set_max_length(GTK_ENTRY(entry_fixed_places), FIXED_PLACES_TEXT_LEN);
+    gtk_entry_set_width_chars(GTK_ENTRY(entry_fixed_places), FIXED_PLACES_TEXT_LEN);
+    sprintf(buf, "%d", config_get_fixed_places());
+    gtk_entry_set_text(GTK_ENTRY(entry_fixed_places), buf);
+    gtk_box_pack_start(GTK_BOX(hbox), lbl, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(hbox), entry_fixed_places, FALSE, FALSE, 0);
+    if (float_format != disp_float_fixed)
+        gtk_widget_set_sensitive(entry_fixed_places, FALSE);
+    gtk_box_pack_start(GTK_BOX(vbox), hbox, FALSE, FALSE, 0);
+
+    button = gtk_check_button_new_with_label("Group digits in threes (1,234,567.89)");
+    if (digit_grouping)
+        gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(button), TRUE);
+    g_signal_connect(button, "toggled",
+                     G_CALLBACK(grouping_button_toggle), NULL);
+    gtk_box_pack_start(GTK_BOX(vbox), button, FALSE, FALSE, 0);
+}
+
 /* Callback for menu Options->Settings (Floating) */
 static void settings_float_activate(GtkWidget *widget, gpointer data)
 {
@@ -564,6 +670,7 @@ static void settings_float_activate(GtkWidget *widget, gpointer data)
         return;
 
     entry_ran_n = NULL;
+    entry_fixed_places = NULL;
 
     window_settings_float = gtk_window_new(GTK_WINDOW_TOPLEVEL);
     gtk_window_set_title(GTK_WINDOW(window_settings_float), "Settings (Floating)");
@@ -581,6 +688,10 @@ static void settings_float_activate(GtkWidget *widget, gpointer data)
     separator = gui_hseparator_new();
     gtk_box_pack_start(GTK_BOX(vbox), separator, FALSE, FALSE, 5);
 
+    add_float_format(vbox);
+    separator = gui_hseparator_new();
+    gtk_box_pack_start(GTK_BOX(vbox), separator, FALSE, FALSE, 5);
+
     add_random_num(vbox);
     separator = gui_hseparator_new();
     gtk_box_pack_start(GTK_BOX(vbox), separator, FALSE, FALSE, 5);
@@ -618,7 +729,11 @@ static void settings_int_ok_button_clicked(GtkWidget *widget, gpointer data)
     (void)data;
 
     /* only used to set the startup value */
-    config_set_integer_width(integer_width);
+    int width = get_entry_val(entry_int_width,
+                              CALC_WIDTH_MIN,
+                              CALC_WIDTH_MAX,
+                              config_get_integer_width());
+    config_set_integer_width(width);
     config_set_use_unsigned(use_unsigned);
 
     /* hex grouping, update display so will take effect on next display
@@ -644,43 +759,27 @@ static void settings_int_cancel_button_clicked(GtkWidget *widget, gpointer data)
     gtk_widget_destroy(window_settings_int);
 }
 
-static void int_width_rb_toggle(GtkWidget *widget, gpointer data)
-{
-    const INT_WIDTH_RB *info = data;
-    gboolean active = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(widget));
-    if (active)
-    {
-        integer_width = info->id;
-    }
-}
+#define INT_WIDTH_TEXT_LEN 3
 
 static void add_integer_width_group(GtkWidget *vbox)
 {
     GtkWidget *lbl;
     GtkWidget *hbox;
-    GtkWidget *button;
-    GSList *group = NULL;
-
-    integer_width = config_get_integer_width();
+    char msg[50];
+    char buf[10];
 
-    hbox = gui_hbox_new(TRUE, 0);
-
-    lbl = gui_label_new("Integer width at startup", 0, 0.5);
-    gtk_box_pack_start(GTK_BOX(vbox), lbl, FALSE, FALSE, 0);
+    hbox = gui_hbox_new(FALSE, 4);
 
-    for (int i = 0; i < num_calc_widths; i++)
-    {
-        button = gtk_radio_button_new_with_label(group, int_width_rb[i].name);
-        group = gtk_radio_button_get_group(GTK_RADIO_BUTTON(button));
-        if (int_width_rb[i].id == integer_width)
-        {
-            gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(button), TRUE);
-        }
-        g_signal_connect(button, "toggled",
-                         G_CALLBACK(int_width_rb_toggle),
-                         (gpointer)&int_width_rb[i]);
-        gtk_box_pack_start(GTK_BOX(hbox), button, FALSE, FALSE, 10);
-    }
+    sprintf(msg, "Integer width at startup (%d to %d)",
+            CALC_WIDTH_MIN, CALC_WIDTH_MAX);
+    lbl = gui_label_new(msg, 0, 0.5);
+    entry_int_width = gtk_entry_new();
+    gtk_entry_set_max_length(GTK_ENTRY(entry_int_width), INT_WIDTH_TEXT_LEN);
+    gtk_entry_set_width_chars(GTK_ENTRY(entry_int_width), INT_WIDTH_TEXT_LEN);
+    sprintf(buf, "%d", config_get_integer_width());
+    gtk_entry_set_text(GTK_ENTRY(entry_int_width), buf);
+    gtk_box_pack_start(GTK_BOX(hbox), lbl, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(hbox), entry_int_width, FALSE, FALSE, 0);
     gtk_box_pack_start(GTK_BOX(vbox), hbox, FALSE, FALSE, 5);
 }
 
@@ -873,6 +972,8 @@ static void settings_int_activate(GtkWidget *widget, gpointer data)
     if (window_settings_int != NULL)
         return;
 
+    entry_int_width = NULL;
+
     window_settings_int = gtk_window_new(GTK_WINDOW_TOPLEVEL);
     gtk_window_set_title(GTK_WINDOW(window_settings_int), "Settings (Integer)");
     g_signal_connect(window_settings_int, "destroy",
@@ -0,0 +1,132 @@
+/*****************************************************************************
+ * File gui_menu_tools.c part of ProgAndSciCalc
+ *
+ * Copyright (C) 2018 Ken Bromham
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "gui_internal.h"
+
+
+static void bigint_activate(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    gui_bigint_open();
+}
+
+static void checksum_activate(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    gui_checksum_open();
+}
+
+static void fixed_activate(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    gui_fixed_open();
+}
+
+static void ieee754_activate(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    gui_ieee754_open();
+}
+
+static void invsym_activate(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    gui_invsym_open();
+}
+
+static void rational_activate(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    gui_rational_open();
+}
+
+static void recognise_activate(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    gui_recognise_open();
+}
+
+void tools_menu_add(GtkWidget *menubar)
+{
+    GtkWidget *tools_menu;
+    GtkWidget *tools_root_mi;
+    GtkWidget *bigint_mi;
+    GtkWidget *checksum_mi;
+    GtkWidget *fixed_mi;
+    GtkWidget *ieee754_mi;
+    GtkWidget *invsym_mi;
+    GtkWidget *rational_mi;
+    GtkWidget *recognise_mi;
+
+    tools_menu = gtk_menu_new();
+    tools_root_mi = gtk_menu_item_new_with_mnemonic("Too_ls");
+    gtk_menu_item_set_submenu(GTK_MENU_ITEM(tools_root_mi), tools_menu);
+
+    bigint_mi = gtk_menu_item_new_with_label("Big Integer");
+    gtk_menu_shell_append(GTK_MENU_SHELL(tools_menu), bigint_mi);
+    g_signal_connect(G_OBJECT(bigint_mi), "activate",
+                     G_CALLBACK(bigint_activate), NULL);
+
+    checksum_mi = gtk_menu_item_new_with_label("Checksum");
+    gtk_menu_shell_append(GTK_MENU_SHELL(tools_menu), checksum_mi);
+    g_signal_connect(G_OBJECT(checksum_mi), "activate",
+                     G_CALLBACK(checksum_activate), NULL);
+
+    fixed_mi = gtk_menu_item_new_with_label("Fixed Point");
+    gtk_menu_shell_append(GTK_MENU_SHELL(tools_menu), fixed_mi);
+    g_signal_connect(G_OBJECT(fixed_mi), "activate",
+                     G_CALLBACK(fixed_activate), NULL);
+
+    ieee754_mi = gtk_menu_item_new_with_label("IEEE 754");
+    gtk_menu_shell_append(GTK_MENU_SHELL(tools_menu), ieee754_mi);
+    g_signal_connect(G_OBJECT(ieee754_mi), "activate",
+                     G_CALLBACK(ieee754_activate), NULL);
+
+    invsym_mi = gtk_menu_item_new_with_label("Inverse Symbolic");
+    gtk_menu_shell_append(GTK_MENU_SHELL(tools_menu), invsym_mi);
+    g_signal_connect(G_OBJECT(invsym_mi), "activate",
+                     G_CALLBACK(invsym_activate), NULL);
+
+    rational_mi = gtk_menu_item_new_with_label("Rational");
+    gtk_menu_shell_append(GTK_MENU_SHELL(tools_menu), rational_mi);
+    g_signal_connect(G_OBJECT(rational_mi), "activate",
+                     G_CALLBACK(rational_activate), NULL);
+
+    recognise_mi = gtk_menu_item_new_with_label("Recognise");
+    gtk_menu_shell_append(GTK_MENU_SHELL(tools_menu), recognise_mi);
+    g_signal_connect(G_OBJECT(recognise_mi), "activate",
+                     G_CALLBACK(recognise_activate), NULL);
+
+    gtk_menu_shell_append(GTK_MENU_SHELL(menubar), tools_root_mi);
+}
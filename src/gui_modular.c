@@ -0,0 +1,372 @@
+/*****************************************************************************
+ * File gui_modular.c part of ProgAndSciCalc
+ *
+ * Copyright (C) 2018 Ken Bromham
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <ctype.h>
+#include <inttypes.h>
+
+#include "gui_internal.h"
+#include "radix_print.h"
+#include "ntheory.h"
+
+/* Modular arithmetic window. Sets the modulus for mod m mode, and solves
+ * Chinese remainder problems (which take a list of residues and moduli,
+ * so don't fit the calculator's binary ops). */
+
+/* window, there will only ever be one */
+static GtkWidget *window_modular;
+static GtkWidget *entry_modulus;
+static GtkWidget *label_modulus;
+static GtkWidget *entry_crt;
+static GtkWidget *entry_result;
+static GtkWidget *label_status;
+
+/* the last CRT result, in decimal */
+static char result_text[RADIX_PRINT_MAX];
+static bool have_result;
+
+/* more than enough congruences to get to 128 bits */
+#define MAX_CRT 64
+
+#define ENTRY_WIDTH 50
+
+
+static void modular_destroy(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    have_result = false;
+    window_modular = NULL;
+}
+
+static void close_button_clicked(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    gtk_widget_destroy(window_modular);
+}
+
+static void show_modulus(void)
+{
+    char buf[80];
+    uint64_t m = calc_get_modulus();
+
+    if (m == 0)
+    {
+        snprintf(buf, sizeof(buf), "Off, normal integer arithmetic");
+    }
+    else
+    {
+        snprintf(buf, sizeof(buf), "+ - * x^y 1/x are mod %" PRIu64, m);
+    }
+    gtk_label_set_text(GTK_LABEL(label_modulus), buf);
+    gui_update_status();
+}
+
+/* A number in decimal, or hex with 0x, moving *p past it. Returns false
+ * if there isn't one or it's beyond 128 bits. */
+static bool parse_num(const char **p, calc_int_t *val)
+{
+    const char *s = *p;
+    int base = 10;
+    calc_int_t v = 0;
+    int digits = 0;
+
+    while (isspace((unsigned char)*s))
+    {
+        s++;
+    }
+    if (s[0] == '0' && (s[1] == 'x' || s[1] == 'X'))
+    {
+        base = 16;
+        s += 2;
+    }
+    for (; isxdigit((unsigned char)*s); s++, digits++)
+    {
+        int d = isdigit((unsigned char)*s) ? *s - '0'
+                                           : tolower((unsigned char)*s) - 'a' + 10;
+        if (d >= base)
+            break;
+        if (v > (CALC_INT_MAX - d) / base)
+            return false;
+        v = v * base + d;
+    }
+    *p = s;
+    *val = v;
+    return digits > 0;
+}
+
+static void set_modulus(void)
+{
+    const char *text = gtk_entry_get_text(GTK_ENTRY(entry_modulus));
+    const char *p = text;
+    calc_int_t m;
+
+    gtk_label_set_text(GTK_LABEL(label_status), "");
+    if (!parse_num(&p, &m) || *p != '\0' || m > UINT64_MAX ||
+        !calc_set_modulus((uint64_t)m))
+    {
+        gtk_label_set_text(GTK_LABEL(label_status),
+                           "Modulus must be from 2 to 2^64 - 1 (0 for off)");
+        return;
+    }
+    gui_give_arg_if_pending();
+    show_modulus();
+}
+
+static void set_button_clicked(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    set_modulus();
+}
+
+static void off_button_clicked(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    gui_give_arg_if_pending();
+    calc_set_modulus(0);
+    gtk_entry_set_text(GTK_ENTRY(entry_modulus), "");
+    show_modulus();
+}
+
+/* Congruences as "r mod m" (or just "r m"), separated by commas */
+static const char *parse_crt(const char *text, calc_int_t *r, calc_int_t *m,
+                             int *num)
+{
+    const char *p = text;
+
+    *num = 0;
+    for (;;)
+    {
+        if (*num == MAX_CRT)
+        {
+            return "Too many congruences";
+        }
+        if (!parse_num(&p, &r[*num]))
+        {
+            return "Expected a residue, eg. 2 mod 3, 3 mod 5";
+        }
+        while (isspace((unsigned char)*p))
+        {
+            p++;
+        }
+        if (strncmp(p, "mod", 3) == 0)
+        {
+            p += 3;
+        }
+        if (!parse_num(&p, &m[*num]) || m[*num] == 0)
+        {
+            return "Expected a modulus, eg. 2 mod 3, 3 mod 5";
+        }
+        (*num)++;
+        while (isspace((unsigned char)*p))
+        {
+            p++;
+        }
+        if (*p == '\0')
+        {
+            return NULL;
+        }
+        if (*p != ',' && *p != ';')
+        {
+            return "Congruences must be separated by commas";
+        }
+        p++;
+    }
+}
+
+static void solve(void)
+{
+    calc_int_t r[MAX_CRT];
+    calc_int_t m[MAX_CRT];
+    calc_int_t x, mod;
+    int num;
+    char buf[2 * RADIX_PRINT_MAX];
+    const char *msg;
+
+    have_result = false;
+    gtk_entry_set_text(GTK_ENTRY(entry_result), "");
+    msg = parse_crt(gtk_entry_get_text(GTK_ENTRY(entry_crt)), r, m, &num);
+    if (msg == NULL && !nt_crt(r, m, num, &x, &mod))
+    {
+        msg = "No solution (or the combined modulus is beyond 128 bits)";
+    }
+    if (msg != NULL)
+    {
+        gtk_label_set_text(GTK_LABEL(label_status), msg);
+        return;
+    }
+
+    radix_print(result_text, x, 10, 1, 0, NULL);
+    have_result = true;
+    snprintf(buf, sizeof(buf), "%s mod ", result_text);
+    radix_print(buf + strlen(buf), mod, 10, 1, 0, NULL);
+    gtk_entry_set_text(GTK_ENTRY(entry_result), buf);
+    gtk_label_set_text(GTK_LABEL(label_status), "");
+}
+
+static void solve_button_clicked(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    solve();
+}
+
+static void modulus_activate(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    set_modulus();
+}
+
+static void crt_activate(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    solve();
+}
+
+/* the result to the calculator, which changes width as needed */
+static void to_calc_button_clicked(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    if (have_result)
+    {
+        gui_paste_text(result_text, 10);
+    }
+}
+
+static GtkWidget *button_new(const char *mnemonic, GCallback clicked)
+{
+    GtkWidget *button = gtk_button_new_with_mnemonic(mnemonic);
+    g_signal_connect(button, "clicked", clicked, NULL);
+    return button;
+}
+
+void gui_modular_open(void)
+{
+    GtkWidget *vbox;
+    GtkWidget *hbox;
+    GtkWidget *button;
+    char buf[24];
+
+    if (window_modular != NULL)
+    {
+        /* already open */
+        return;
+    }
+
+    have_result = false;
+
+    window_modular = gtk_window_new(GTK_WINDOW_TOPLEVEL);
+    gtk_window_set_title(GTK_WINDOW(window_modular), "Modular Arithmetic");
+    g_signal_connect(window_modular, "destroy",
+                     G_CALLBACK(modular_destroy), NULL);
+    gtk_container_set_border_width(GTK_CONTAINER(window_modular), 10);
+
+    vbox = gui_vbox_new(FALSE, 0);
+    gtk_container_add(GTK_CONTAINER(window_modular), vbox);
+
+    /* modulus */
+    hbox = gui_hbox_new(FALSE, 5);
+    gtk_box_pack_start(GTK_BOX(hbox), gui_label_new("Modulus", 0, 0.5),
+                       FALSE, FALSE, 0);
+    entry_modulus = gtk_entry_new();
+    gtk_entry_set_width_chars(GTK_ENTRY(entry_modulus), 22);
+    if (calc_get_modulus() != 0)
+    {
+        snprintf(buf, sizeof(buf), "%" PRIu64, calc_get_modulus());
+        gtk_entry_set_text(GTK_ENTRY(entry_modulus), buf);
+    }
+    g_signal_connect(entry_modulus, "activate",
+                     G_CALLBACK(modulus_activate), NULL);
+    gtk_box_pack_start(GTK_BOX(hbox), entry_modulus, TRUE, TRUE, 0);
+    gtk_box_pack_start(GTK_BOX(hbox),
+                       button_new("_Set", G_CALLBACK(set_button_clicked)),
+                       FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(hbox),
+                       button_new("O_ff", G_CALLBACK(off_button_clicked)),
+                       FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(vbox), hbox, FALSE, FALSE, 0);
+
+    label_modulus = gui_label_new("", 0, 0.5);
+    gtk_box_pack_start(GTK_BOX(vbox), label_modulus, FALSE, FALSE, 5);
+
+    gtk_box_pack_start(GTK_BOX(vbox), gui_hseparator_new(), FALSE, FALSE, 5);
+
+    /* CRT */
+    gtk_box_pack_start(GTK_BOX(vbox),
+                       gui_label_new("Chinese remainder, eg. 2 mod 3, 3 mod 5, 2 mod 7",
+                                     0, 0.5),
+                       FALSE, FALSE, 0);
+    entry_crt = gtk_entry_new();
+    gtk_entry_set_width_chars(GTK_ENTRY(entry_crt), ENTRY_WIDTH);
+    g_signal_connect(entry_crt, "activate", G_CALLBACK(crt_activate), NULL);
+    gtk_box_pack_start(GTK_BOX(vbox), entry_crt, FALSE, FALSE, 5);
+
+    hbox = gui_hbox_new(FALSE, 5);
+    gtk_box_pack_start(GTK_BOX(hbox), gui_label_new("x =", 0, 0.5),
+                       FALSE, FALSE, 0);
+    entry_result = gtk_entry_new();
+#if TARGET_GTK_VERSION == 2
+    gtk_entry_set_editable(GTK_ENTRY(entry_result), FALSE);
+#elif TARGET_GTK_VERSION == 3
+    gtk_editable_set_editable(GTK_EDITABLE(entry_result), FALSE);
+#endif
+    gtk_box_pack_start(GTK_BOX(hbox), entry_result, TRUE, TRUE, 0);
+    gtk_box_pack_start(GTK_BOX(vbox), hbox, FALSE, FALSE, 0);
+
+    label_status = gui_label_new("", 0, 0.5);
+    gtk_box_pack_start(GTK_BOX(vbox), label_status, FALSE, FALSE, 5);
+
+    /* buttons */
+    hbox = gui_hbox_new(FALSE, 5);
+    gtk_box_pack_start(GTK_BOX(hbox),
+                       button_new("S_olve", G_CALLBACK(solve_button_clicked)),
+                       FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(hbox),
+                       button_new("_To Calculator",
+                                  G_CALLBACK(to_calc_button_clicked)),
+                       FALSE, FALSE, 0);
+    button = button_new("_Close", G_CALLBACK(close_button_clicked));
+    gtk_widget_set_size_request(button, 80, -1);
+#if TARGET_GTK_VERSION == 2
+    GtkWidget *align = gtk_alignment_new(1, 0, 0, 0);
+    gtk_container_add(GTK_CONTAINER(align), button);
+    gtk_box_pack_start(GTK_BOX(hbox), align, TRUE, TRUE, 0);
+#elif TARGET_GTK_VERSION == 3
+    gtk_widget_set_halign(button, GTK_ALIGN_END);
+    gtk_box_pack_start(GTK_BOX(hbox), button, TRUE, TRUE, 0);
+#endif
+    gtk_box_pack_start(GTK_BOX(vbox), hbox, FALSE, FALSE, 10);
+
+    show_modulus();
+    gtk_widget_show_all(window_modular);
+}
@@ -0,0 +1,149 @@
+/*****************************************************************************
+ * File gui_rational.c part of ProgAndSciCalc
+ *
+ * Copyright (C) 2018 Ken Bromham
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "gui_internal.h"
+
+/* Rational window. Turns rational mode on or off in floating mode, where
+ * + - * / keep exact fractions, shown under the main display as a/b or
+ * mixed. */
+
+/* window, there will only ever be one */
+static GtkWidget *window_rational;
+static GtkWidget *label_rational;
+
+static const char *rational_names[] = { "Off", "a/b", "Mixed" };
+#define NUM_RATIONAL (int)(sizeof(rational_names) / sizeof(rational_names[0]))
+
+
+static void rational_destroy(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    window_rational = NULL;
+}
+
+static void close_button_clicked(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    gtk_widget_destroy(window_rational);
+}
+
+static void show_rational(void)
+{
+    const char *msg;
+
+    if (calc_get_rational() == calc_rational_off)
+    {
+        msg = "Off, normal decimal floating point";
+    }
+    else if (calc_get_mode() == calc_mode_integer)
+    {
+        msg = "Takes effect in floating mode";
+    }
+    else
+    {
+        msg = "+ - * / +/- sqr 1/x are exact on fractions";
+    }
+    gtk_label_set_text(GTK_LABEL(label_rational), msg);
+    gui_update_status();
+}
+
+static void rational_toggled(GtkWidget *widget, gpointer data)
+{
+    calc_rational_enum r = (calc_rational_enum)(uintptr_t)data;
+
+    if (!gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(widget)) ||
+        r == calc_get_rational())
+    {
+        return;
+    }
+    gui_give_arg_if_pending();
+    calc_set_rational(r);
+    show_rational();
+}
+
+void gui_rational_open(void)
+{
+    GtkWidget *vbox;
+    GtkWidget *hbox;
+    GtkWidget *button;
+    GtkWidget *rbut[NUM_RATIONAL];
+    GSList *group = NULL;
+
+    if (window_rational != NULL)
+    {
+        /* already open */
+        return;
+    }
+
+    window_rational = gtk_window_new(GTK_WINDOW_TOPLEVEL);
+    gtk_window_set_title(GTK_WINDOW(window_rational), "Rational");
+    g_signal_connect(window_rational, "destroy",
+                     G_CALLBACK(rational_destroy), NULL);
+    gtk_container_set_border_width(GTK_CONTAINER(window_rational), 10);
+
+    vbox = gui_vbox_new(FALSE, 0);
+    gtk_container_add(GTK_CONTAINER(window_rational), vbox);
+
+    /* off, a/b or mixed, in the order of calc_rational_enum */
+    hbox = gui_hbox_new(FALSE, 5);
+    gtk_box_pack_start(GTK_BOX(hbox), gui_label_new("Fractions", 0, 0.5),
+                       FALSE, FALSE, 0);
+    for (int i = 0; i < NUM_RATIONAL; i++)
+    {
+        rbut[i] = gtk_radio_button_new_with_label(group, rational_names[i]);
+        group = gtk_radio_button_get_group(GTK_RADIO_BUTTON(rbut[i]));
+        if (i == (int)calc_get_rational())
+        {
+            gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(rbut[i]), TRUE);
+        }
+        gtk_box_pack_start(GTK_BOX(hbox), rbut[i], FALSE, FALSE, 0);
+    }
+    for (int i = 0; i < NUM_RATIONAL; i++)
+    {
+        g_signal_connect(rbut[i], "toggled",
+                         G_CALLBACK(rational_toggled), (gpointer)(uintptr_t)i);
+    }
+    gtk_box_pack_start(GTK_BOX(vbox), hbox, FALSE, FALSE, 0);
+
+    label_rational = gui_label_new("", 0, 0.5);
+    gtk_box_pack_start(GTK_BOX(vbox), label_rational, FALSE, FALSE, 5);
+
+    /* buttons */
+    hbox = gui_hbox_new(FALSE, 5);
+    button = gtk_button_new_with_mnemonic("_Close");
+    g_signal_connect(button, "clicked", G_CALLBACK(close_button_clicked), NULL);
+    gtk_widget_set_size_request(button, 80, -1);
+#if TARGET_GTK_VERSION == 2
+    GtkWidget *align = gtk_alignment_new(1, 0, 0, 0);
+    gtk_container_add(GTK_CONTAINER(align), button);
+    gtk_box_pack_start(GTK_BOX(hbox), align, TRUE, TRUE, 0);
+#elif TARGET_GTK_VERSION == 3
+    gtk_widget_set_halign(button, GTK_ALIGN_END);
+    gtk_box_pack_start(GTK_BOX(hbox), button, TRUE, TRUE, 0);
+#endif
+    gtk_box_pack_start(GTK_BOX(vbox), hbox, FALSE, FALSE, 10);
+
+    show_rational();
+    gtk_widget_show_all(window_rational);
+}
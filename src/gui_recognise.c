@@ -0,0 +1,328 @@
+/*****************************************************************************
+ * File gui_recognise.c part of ProgAndSciCalc
+ *
+ * Copyright (C) 2018 Ken Bromham
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <ctype.h>
+
+#include "gui_internal.h"
+#include "display_print.h"
+#include "radix_print.h"
+#include "rational.h"
+
+/* Recognise window. Takes the floating mode value from the calculator
+ * and shows its continued fraction, the convergents and best
+ * approximation with a limit on the denominator, and whether it is a
+ * simple fraction or a fraction of pi or sqrt(2). */
+
+/* window, there will only ever be one */
+static GtkWidget *window_recognise;
+static GtkWidget *entry_max_den;
+static GtkWidget *entry_value;
+static GtkWidget *entry_cf;
+static GtkWidget *entry_conv;
+static GtkWidget *entry_best;
+static GtkWidget *entry_recognised;
+static GtkWidget *label_status;
+
+/* terms of the continued fraction shown, and convergents (more than there
+ * can be for 10^12) */
+#define MAX_CF_TERMS 24
+#define MAX_CONV 80
+
+#define MAX_DEN_DEFAULT "1000"
+#define MAX_DEN_LIMIT ((calc_int_t)1000000000000)
+
+#define ENTRY_WIDTH 60
+
+
+static void recognise_destroy(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    window_recognise = NULL;
+}
+
+static void close_button_clicked(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    gtk_widget_destroy(window_recognise);
+}
+
+static void clear_results(void)
+{
+    gtk_entry_set_text(GTK_ENTRY(entry_value), "");
+    gtk_entry_set_text(GTK_ENTRY(entry_cf), "");
+    gtk_entry_set_text(GTK_ENTRY(entry_conv), "");
+    gtk_entry_set_text(GTK_ENTRY(entry_best), "");
+    gtk_entry_set_text(GTK_ENTRY(entry_recognised), "");
+}
+
+/* decimal, 1 to MAX_DEN_LIMIT */
+static bool get_max_den(calc_int_t *max_den)
+{
+    const char *p = gtk_entry_get_text(GTK_ENTRY(entry_max_den));
+    calc_int_t v = 0;
+
+    if (*p == '\0')
+        return false;
+    for (; *p != '\0'; p++)
+    {
+        if (!isdigit((unsigned char)*p))
+            return false;
+        v = v * 10 + (*p - '0');
+        if (v > MAX_DEN_LIMIT)
+            return false;
+    }
+    *max_den = v;
+    return v != 0;
+}
+
+/* eg. [0; 1, 3, 1, 1, 1, 15, ...] */
+static void show_cf(const rat_t *x)
+{
+    calc_sint_t a0;
+    calc_int_t cf[MAX_CF_TERMS];
+    char buf[(MAX_CF_TERMS + 1) * (RADIX_PRINT_MAX + 2) + 10];
+    int len;
+    int num = rat_continued_fraction(x, &a0, cf, MAX_CF_TERMS);
+
+    len = sprintf(buf, "[%s", a0 < 0 ? "-" : "");
+    radix_print(buf + len, a0 < 0 ? -(calc_int_t)a0 : (calc_int_t)a0,
+                10, 1, 0, NULL);
+    len = strlen(buf);
+    for (int i = 0; i < num && i < MAX_CF_TERMS; i++)
+    {
+        len += sprintf(buf + len, "%s", i == 0 ? "; " : ", ");
+        radix_print(buf + len, cf[i], 10, 1, 0, NULL);
+        len = strlen(buf);
+    }
+    sprintf(buf + len, "%s]", num > MAX_CF_TERMS ? ", ..." : "");
+    gtk_entry_set_text(GTK_ENTRY(entry_cf), buf);
+}
+
+static void show_convergents(const rat_t *x, calc_int_t max_den)
+{
+    rat_t conv[MAX_CONV];
+    char buf[MAX_CONV * (RAT_STRING_MAX + 2)];
+    int len = 0;
+    int num = rat_convergents(x, max_den, conv, MAX_CONV);
+
+    buf[0] = '\0';
+    for (int i = 0; i < num; i++)
+    {
+        len += sprintf(buf + len, "%s", i == 0 ? "" : "  ");
+        rat_to_string(buf + len, &conv[i], false);
+        len = strlen(buf);
+    }
+    gtk_entry_set_text(GTK_ENTRY(entry_conv), buf);
+}
+
+/* eg. 355/113  error 2.66e-7, the error being the fraction - x */
+static void show_best(const rat_t *x, const stackf_t *fval,
+                      calc_int_t max_den)
+{
+    decContext set = dfp_context;
+    char buf[RAT_STRING_MAX + DFP_STRING_MAX + 20];
+    rat_t best;
+    stackf_t b, err;
+    int len;
+
+    rat_best_approx(&best, x, max_den);
+    rat_to_string(buf, &best, false);
+    len = strlen(buf);
+    rat_to_dfp(&best, &b);
+    dfp_subtract(&err, &b, fval, &set);
+    len += sprintf(buf + len, "  error ");
+    display_print_gmode(buf + len, err, 3);
+    gtk_entry_set_text(GTK_ENTRY(entry_best), buf);
+}
+
+/* eg. 1/4 pi, -pi, 1/2 sqrt(2), 2/3 */
+static void show_recognised(const stackf_t *fval, calc_int_t max_den)
+{
+    static const char *times_name[rat_num_times] = { "", "pi", "sqrt(2)" };
+    char buf[RAT_STRING_MAX + 20];
+    rat_t r;
+    rat_times_enum times;
+
+    if (!rat_recognise(fval, max_den, &r, &times))
+    {
+        gtk_entry_set_text(GTK_ENTRY(entry_recognised),
+                           "Not a simple fraction, or fraction of pi or sqrt(2)");
+        return;
+    }
+    if (times != rat_times_one && r.den == 1 && (r.num == 1 || r.num == -1))
+    {
+        snprintf(buf, sizeof(buf), "%s%s", r.num < 0 ? "-" : "",
+                 times_name[times]);
+    }
+    else
+    {
+        rat_to_string(buf, &r, false);
+        if (times != rat_times_one && r.num != 0)
+        {
+            strcat(buf, " ");
+            strcat(buf, times_name[times]);
+        }
+    }
+    gtk_entry_set_text(GTK_ENTRY(entry_recognised), buf);
+}
+
+static void recognise(void)
+{
+    char buf[DFP_STRING_MAX + 10];
+    calc_int_t max_den;
+    stackf_t fval;
+    rat_t x;
+
+    clear_results();
+    gtk_label_set_text(GTK_LABEL(label_status), "");
+    if (!get_max_den(&max_den))
+    {
+        gtk_label_set_text(GTK_LABEL(label_status),
+                           "Max denominator must be from 1 to 10^12");
+        return;
+    }
+    if (calc_get_mode() != calc_mode_float)
+    {
+        gtk_label_set_text(GTK_LABEL(label_status),
+                           "Takes the value in floating mode");
+        return;
+    }
+
+    gui_give_arg_if_pending();
+    fval = calc_get_fval_top_of_stack();
+    display_print_gmode(buf, fval, DECQUAD_Pmax);
+    gtk_entry_set_text(GTK_ENTRY(entry_value), buf);
+
+    /* the decimal is exactly a fraction, unless it's beyond 128 bits */
+    if (!rat_from_dfp(&x, &fval))
+    {
+        gtk_label_set_text(GTK_LABEL(label_status),
+                           "The value is too big or small for 128 bits");
+        return;
+    }
+    show_cf(&x);
+    show_convergents(&x, max_den);
+    show_best(&x, &fval, max_den);
+    show_recognised(&fval, max_den);
+}
+
+static void from_calc_button_clicked(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    recognise();
+}
+
+static void max_den_activate(GtkWidget *widget, gpointer data)
+{
+    (void)widget;
+    (void)data;
+
+    recognise();
+}
+
+static GtkWidget *result_row(GtkWidget *vbox, const char *name)
+{
+    GtkWidget *hbox = gui_hbox_new(FALSE, 5);
+    GtkWidget *label = gui_label_new(name, 0, 0.5);
+    GtkWidget *entry = gtk_entry_new();
+
+    gtk_label_set_width_chars(GTK_LABEL(label), 18);
+    gtk_box_pack_start(GTK_BOX(hbox), label, FALSE, FALSE, 0);
+    gtk_entry_set_width_chars(GTK_ENTRY(entry), ENTRY_WIDTH);
+#if TARGET_GTK_VERSION == 2
+    gtk_entry_set_editable(GTK_ENTRY(entry), FALSE);
+#elif TARGET_GTK_VERSION == 3
+    gtk_editable_set_editable(GTK_EDITABLE(entry), FALSE);
+#endif
+    gtk_box_pack_start(GTK_BOX(hbox), entry, TRUE, TRUE, 0);
+    gtk_box_pack_start(GTK_BOX(vbox), hbox, FALSE, FALSE, 2);
+    return entry;
+}
+
+void gui_recognise_open(void)
+{
+    GtkWidget *vbox;
+    GtkWidget *hbox;
+    GtkWidget *button;
+
+    if (window_recognise != NULL)
+    {
+        /* already open */
+        return;
+    }
+
+    window_recognise = gtk_window_new(GTK_WINDOW_TOPLEVEL);
+    gtk_window_set_title(GTK_WINDOW(window_recognise), "Recognise");
+    g_signal_connect(window_recognise, "destroy",
+                     G_CALLBACK(recognise_destroy), NULL);
+    gtk_container_set_border_width(GTK_CONTAINER(window_recognise), 10);
+
+    vbox = gui_vbox_new(FALSE, 0);
+    gtk_container_add(GTK_CONTAINER(window_recognise), vbox);
+
+    /* max denominator */
+    hbox = gui_hbox_new(FALSE, 5);
+    gtk_box_pack_start(GTK_BOX(hbox), gui_label_new("Max denominator", 0, 0.5),
+                       FALSE, FALSE, 0);
+    entry_max_den = gtk_entry_new();
+    gtk_entry_set_width_chars(GTK_ENTRY(entry_max_den), 14);
+    gtk_entry_set_text(GTK_ENTRY(entry_max_den), MAX_DEN_DEFAULT);
+    g_signal_connect(entry_max_den, "activate",
+                     G_CALLBACK(max_den_activate), NULL);
+    gtk_box_pack_start(GTK_BOX(hbox), entry_max_den, FALSE, FALSE, 0);
+    button = gtk_button_new_with_mnemonic("_From Calculator");
+    g_signal_connect(button, "clicked",
+                     G_CALLBACK(from_calc_button_clicked), NULL);
+    gtk_box_pack_start(GTK_BOX(hbox), button, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(vbox), hbox, FALSE, FALSE, 5);
+
+    entry_value = result_row(vbox, "x");
+    entry_cf = result_row(vbox, "Continued fraction");
+    entry_conv = result_row(vbox, "Convergents");
+    entry_best = result_row(vbox, "Best");
+    entry_recognised = result_row(vbox, "Recognised");
+
+    label_status = gui_label_new("", 0, 0.5);
+    gtk_box_pack_start(GTK_BOX(vbox), label_status, FALSE, FALSE, 5);
+
+    /* buttons */
+    hbox = gui_hbox_new(FALSE, 5);
+    button = gtk_button_new_with_mnemonic("_Close");
+    g_signal_connect(button, "clicked", G_CALLBACK(close_button_clicked), NULL);
+    gtk_widget_set_size_request(button, 80, -1);
+#if TARGET_GTK_VERSION == 2
+    GtkWidget *align = gtk_alignment_new(1, 0, 0, 0);
+    gtk_container_add(GTK_CONTAINER(align), button);
+    gtk_box_pack_start(GTK_BOX(hbox), align, TRUE, TRUE, 0);
+#elif TARGET_GTK_VERSION == 3
+    gtk_widget_set_halign(button, GTK_ALIGN_END);
+    gtk_box_pack_start(GTK_BOX(hbox), button, TRUE, TRUE, 0);
+#endif
+    gtk_box_pack_start(GTK_BOX(vbox), hbox, FALSE, FALSE, 10);
+
+    recognise();
+    gtk_widget_show_all(window_recognise);
+}
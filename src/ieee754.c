@@ -0,0 +1,297 @@
+/*****************************************************************************
+ * File ieee754.c part of ProgAndSciCalc
+ *
+ * Copyright (C) 2018 Ken Bromham
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+
+#include "ieee754.h"
+#include "bignum.h"
+
+static const ieee_format_t formats[ieee_num_formats] =
+{
+    { "binary16",  16,  5,  10 },
+    { "bfloat16",  16,  8,   7 },
+    { "binary32",  32,  8,  23 },
+    { "binary64",  64, 11,  52 },
+    { "binary128", 128, 15, 112 },
+};
+
+/* enough digits past decQuad's 34 to round correctly */
+#define KEEP_DIGITS 40
+
+/* digits kept for the error in ulps, it's less than 1 so this fits in 128
+ * bits */
+#define ERR_DIGITS 36
+
+
+const ieee_format_t *ieee_get_format(ieee_format_enum f)
+{
+    return &formats[f];
+}
+
+static int get_bias(const ieee_format_t *fmt)
+{
+    return (1 << (fmt->exp_bits - 1)) - 1;
+}
+
+void ieee_decode(ieee_format_enum f, calc_int_t bits, ieee_fields_t *fields)
+{
+    const ieee_format_t *fmt = &formats[f];
+    int max_exp = (1 << fmt->exp_bits) - 1;
+    int bias = get_bias(fmt);
+
+    fields->sign = (bits >> (fmt->bits - 1)) & 1;
+    fields->biased_exp = (int)(bits >> fmt->mant_bits) & max_exp;
+    fields->mant = bits & (((calc_int_t)1 << fmt->mant_bits) - 1);
+    fields->exp = 0;
+
+    if (fields->biased_exp == max_exp)
+    {
+        fields->cls = fields->mant == 0 ? ieee_infinite : ieee_nan;
+    }
+    else if (fields->biased_exp == 0)
+    {
+        fields->cls = fields->mant == 0 ? ieee_zero : ieee_subnormal;
+        fields->exp = 1 - bias;
+    }
+    else
+    {
+        fields->cls = ieee_normal;
+        fields->exp = fields->biased_exp - bias;
+    }
+}
+
+/* The string is exact, and from_string rounds it correctly. A copy of the
+ * context so the flags it sets don't get seen by the calculator. */
+static void dfp_from_exact_string(stackf_t *r, const char *s)
+{
+    decContext set = dfp_context;
+
+    set.round = DEC_ROUND_HALF_EVEN;
+    dfp_from_string(r, s, &set);
+}
+
+void ieee_to_dfp(ieee_format_enum f, calc_int_t bits, stackf_t *r)
+{
+    const ieee_format_t *fmt = &formats[f];
+    ieee_fields_t fields;
+    bn_arena_t ar;
+    bn_t n;
+    char *digits;
+    char text[KEEP_DIGITS + 16];
+    size_t len;
+    int e2;
+    int e10;
+
+    ieee_decode(f, bits, &fields);
+    switch (fields.cls)
+    {
+        case ieee_nan:
+            dfp_from_exact_string(r, fields.sign ? "-NaN" : "NaN");
+            return;
+        case ieee_infinite:
+            dfp_from_exact_string(r, fields.sign ? "-Inf" : "Inf");
+            return;
+        case ieee_zero:
+            dfp_from_exact_string(r, fields.sign ? "-0" : "0");
+            return;
+        default:
+            break;
+    }
+
+    /* the value is sig * 2^e2 with sig an integer, which as a decimal is
+     * sig * 2^e2 exactly, or sig * 5^-e2 * 10^e2 */
+    calc_int_t sig = fields.mant;
+    if (fields.cls == ieee_normal)
+    {
+        sig |= (calc_int_t)1 << fmt->mant_bits;
+    }
+    e2 = fields.exp - fmt->mant_bits;
+
+    bn_arena_init(&ar);
+    bn_from_u128(&ar, &n, sig);
+    if (e2 >= 0)
+    {
+        bn_shl(&ar, &n, &n, e2);
+    }
+    else
+    {
+        bn_t p;
+        bn_from_u128(&ar, &p, 5);
+        bn_pow(&ar, &p, &p, -e2);
+        bn_mul(&ar, &n, &n, &p);
+    }
+    digits = bn_to_string(&ar, &n, 10);
+    len = strlen(digits);
+    e10 = e2 < 0 ? e2 : 0;
+    if (len > KEEP_DIGITS)
+    {
+        /* from_string doesn't cope with thousands of digits, the ones
+         * past the rounding digit only matter for whether any are
+         * nonzero, so they become one sticky digit */
+        bool sticky = strspn(digits + KEEP_DIGITS - 1, "0") !=
+                      len - KEEP_DIGITS + 1;
+        digits[KEEP_DIGITS - 1] = sticky ? '1' : '0';
+        digits[KEEP_DIGITS] = '\0';
+        e10 += (int)(len - KEEP_DIGITS);
+    }
+    sprintf(text, "%s%sE%d", fields.sign ? "-" : "", digits, e10);
+    dfp_from_exact_string(r, text);
+    bn_arena_free(&ar);
+}
+
+/* a / b for 0 <= a < b, negated if neg */
+static void fraction_to_dfp(bn_arena_t *ar, stackf_t *r,
+                            const bn_t *a, const bn_t *b, bool neg)
+{
+    bn_t t;
+    char text[60];
+
+    bn_from_u128(ar, &t, 10);
+    bn_pow(ar, &t, &t, ERR_DIGITS);
+    bn_mul(ar, &t, &t, a);
+    bn_divmod(ar, &t, NULL, &t, b);
+    sprintf(text, "%s%sE-%d", neg && !bn_is_zero(a) ? "-" : "",
+            bn_to_string(ar, &t, 10),
+            ERR_DIGITS);
+    dfp_from_exact_string(r, text);
+}
+
+/* num / (den * 2^e) as quotient m and remainder r of dividing by div */
+static void scaled_divide(bn_arena_t *ar, const bn_t *num, const bn_t *den,
+                          long e, bn_t *m, bn_t *r, bn_t *div)
+{
+    bn_t n = *num;
+
+    *div = *den;
+    if (e >= 0)
+    {
+        bn_shl(ar, div, den, e);
+    }
+    else
+    {
+        bn_shl(ar, &n, num, -e);
+    }
+    bn_divmod(ar, m, r, &n, div);
+}
+
+calc_int_t ieee_from_dfp(ieee_format_enum f, const stackf_t *x, stackf_t *err)
+{
+    const ieee_format_t *fmt = &formats[f];
+    int p = fmt->mant_bits + 1;
+    int bias = get_bias(fmt);
+    int emin = 1 - bias;
+    int emax = bias;
+    calc_int_t max_exp = ((calc_int_t)1 << fmt->exp_bits) - 1;
+    calc_int_t inf = max_exp << fmt->mant_bits;
+    uint8_t bcd[DECQUAD_Pmax];
+    char digits[DECQUAD_Pmax];
+    bool neg = dfp_get_coefficient(x, bcd) != 0;
+    calc_int_t sign_bit = (calc_int_t)neg << (fmt->bits - 1);
+
+    if (dfp_is_nan(x))
+    {
+        dfp_from_exact_string(err, "NaN");
+        return sign_bit | inf | ((calc_int_t)1 << (fmt->mant_bits - 1));
+    }
+    if (dfp_is_infinite(x) || dfp_is_zero(x))
+    {
+        dfp_zero(err);
+        return sign_bit | (dfp_is_zero(x) ? 0 : inf);
+    }
+
+    /* x is c * 10^q, so num / den exactly */
+    bn_arena_t ar;
+    bn_t num, den, m, r, div, t;
+    int q = dfp_get_exponent(x);
+
+    bn_arena_init(&ar);
+    for (int i = 0; i < DECQUAD_Pmax; i++)
+    {
+        digits[i] = (char)('0' + bcd[i]);
+    }
+    bn_from_string(&ar, &num, digits, DECQUAD_Pmax, 10);
+    bn_from_u128(&ar, &t, 10);
+    bn_pow(&ar, &t, &t, q < 0 ? -q : q);
+    if (q >= 0)
+    {
+        bn_mul(&ar, &num, &num, &t);
+        bn_from_u128(&ar, &den, 1);
+    }
+    else
+    {
+        den = t;
+    }
+
+    /* Find e so that x / 2^e has p bits, m * 2^e being x rounded down to
+     * p bits. The first guess is right or one too small. Below the
+     * normal range there are fewer bits, the lsb is fixed at the
+     * subnormal lsb. */
+    long e = bn_bit_length(&num) - bn_bit_length(&den) - p;
+    scaled_divide(&ar, &num, &den, e, &m, &r, &div);
+    if (bn_bit_length(&m) > p)
+    {
+        e++;
+        scaled_divide(&ar, &num, &den, e, &m, &r, &div);
+    }
+    if (e < emin - (p - 1))
+    {
+        e = emin - (p - 1);
+        scaled_divide(&ar, &num, &den, e, &m, &r, &div);
+    }
+
+    /* round to nearest, ties to even, r / div being the fraction of an
+     * ulp that was dropped */
+    calc_int_t mi = bn_to_u128(&m);
+    bn_shl(&ar, &t, &r, 1);
+    int cmp = bn_cmp(&t, &div);
+    bool up = cmp > 0 || (cmp == 0 && (mi & 1) != 0);
+    if (up)
+    {
+        bn_sub(&ar, &t, &div, &r);
+        fraction_to_dfp(&ar, err, &t, &div, neg);
+        mi++;
+        if (mi == (calc_int_t)1 << p)
+        {
+            mi >>= 1;
+            e++;
+        }
+    }
+    else
+    {
+        fraction_to_dfp(&ar, err, &r, &div, !neg);
+    }
+    bn_arena_free(&ar);
+
+    if (e + p - 1 > emax)
+    {
+        dfp_from_exact_string(err, neg ? "-Inf" : "Inf");
+        return sign_bit | inf;
+    }
+
+    /* normal with the implicit 1 dropped, or subnormal */
+    calc_int_t biased = 0;
+    if ((mi >> (p - 1)) != 0)
+    {
+        biased = (calc_int_t)(e + p - 1 + bias);
+        mi &= ((calc_int_t)1 << fmt->mant_bits) - 1;
+    }
+    return sign_bit | (biased << fmt->mant_bits) | mi;
+}
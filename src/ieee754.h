@@ -0,0 +1,90 @@
+/*****************************************************************************
+ * File ieee754.h part of ProgAndSciCalc
+ *
+ * Copyright (C) 2018 Ken Bromham
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef IEEE754_H
+#define IEEE754_H
+
+#include <stdbool.h>
+#include "calc_types.h"
+
+/* IEEE 754 binary floating point encodings (and bfloat16), for looking at
+ * the bits of a float or working out the encoding of a value.
+ *
+ * Conversions both ways are correctly rounded, to nearest with ties to
+ * even. They are done exactly with big integers (an encoding is an
+ * integer times a power of 2, a decQuad an integer times a power of 10)
+ * rather than through the C library, so they don't depend on the host's
+ * float types and work the same for binary128. */
+
+typedef enum
+{
+    ieee_binary16,
+    ieee_bfloat16,
+    ieee_binary32,
+    ieee_binary64,
+    ieee_binary128,
+    ieee_num_formats
+} ieee_format_enum;
+
+typedef struct
+{
+    const char *name;
+    /* total bits, and the bits of the exponent and mantissa (fraction)
+     * fields, the mantissa not including the implicit 1 */
+    int bits;
+    int exp_bits;
+    int mant_bits;
+} ieee_format_t;
+
+const ieee_format_t *ieee_get_format(ieee_format_enum f);
+
+typedef enum
+{
+    ieee_zero,
+    ieee_subnormal,
+    ieee_normal,
+    ieee_infinite,
+    ieee_nan
+} ieee_class_enum;
+
+typedef struct
+{
+    ieee_class_enum cls;
+    bool sign;
+    /* the fields as stored */
+    int biased_exp;
+    calc_int_t mant;
+    /* unbiased exponent, for normal and subnormal values (the minimum
+     * exponent for subnormals) */
+    int exp;
+} ieee_fields_t;
+
+/* Split the low bits of bits (as many as the format has) into fields */
+void ieee_decode(ieee_format_enum f, calc_int_t bits, ieee_fields_t *fields);
+
+/* The value of an encoding, rounded to decQuad */
+void ieee_to_dfp(ieee_format_enum f, calc_int_t bits, stackf_t *r);
+
+/* The nearest encoding to x. err is the encoding minus x in units of the
+ * last place at x, from -0.5 to 0.5 (infinite if x overflowed, NaN for a
+ * NaN). NaNs encode as the quiet NaN with only the top mantissa bit set. */
+calc_int_t ieee_from_dfp(ieee_format_enum f, const stackf_t *x, stackf_t *err);
+
+#endif
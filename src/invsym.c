@@ -0,0 +1,960 @@
+/*****************************************************************************
+ * File invsym.c part of ProgAndSciCalc
+ *
+ * Copyright (C) 2018 Ken Bromham
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+/* for mmap, sysconf and pthreads with -std=c99 */
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "invsym.h"
+#include "ntheory.h"
+#include "decNumber/decNumberMath.h"
+
+/* The index file is a header then the entries sorted on key. Change the
+ * magic if what goes in the index changes, so old files get rebuilt. */
+#define MAGIC "PSCINV1"
+
+typedef struct
+{
+    char magic[8];
+    uint32_t entry_size;
+    uint32_t count;
+    uint64_t hash;
+} header_t;
+
+typedef struct
+{
+    uint64_t key_hi;
+    uint64_t key_lo;
+    uint32_t code;
+    uint32_t complexity;
+} entry_t;
+
+/* The key is in the same order as the value. For x > 0 it is the top bit
+ * set, then the exponent of the first digit biased to be positive, then
+ * the 34 digits of the coefficient with any leading zeros shifted out
+ * (10^34 < 2^113). For x < 0 it's the bits of the key of -x inverted, so
+ * the top bit is clear and bigger magnitudes come lower. 0 is just the
+ * top bit. */
+#define COEFF_BITS 113
+#define EXP_BIAS 6176
+#define KEY_ZERO ((calc_int_t)1 << 127)
+
+/* the constants, 1 to 12 then these */
+#define NUM_INTEGERS 12
+static const struct
+{
+    const char *name;
+    const char *value;
+    int weight;
+} named[] =
+{
+    { "pi", "3.14159265358979323846264338327950288", 1 },
+    { "e", "2.71828182845904523536028747135266250", 1 },
+    { "phi", "1.61803398874989484820458683436563812", 2 },
+    { "gamma", "0.577215664901532860606512090082402431", 2 },
+    { "zeta(3)", "1.20205690315959428539973816151144999", 3 },
+    { "G", "0.915965594177219015054603514932384111", 3 },
+};
+#define NUM_NAMED (int)(sizeof(named) / sizeof(named[0]))
+#define NUM_BUILTIN (NUM_INTEGERS + NUM_NAMED)
+#define MAX_ATOMS (NUM_BUILTIN + INVSYM_MAX_USER)
+
+#define USER_WEIGHT 2
+
+typedef struct
+{
+    char name[INVSYM_NAME_MAX + 1];
+    stackf_t value;
+    int weight;
+    bool user;
+} atom_t;
+
+/* applied to a constant to make a term */
+typedef enum
+{
+    un_id,
+    un_sqr,
+    un_cube,
+    un_sqrt,
+    un_cbrt,
+    un_ln,
+    un_exp,
+    num_un
+} un_enum;
+
+static const int un_weight[num_un] = { 0, 1, 2, 1, 2, 2, 2 };
+
+typedef enum
+{
+    op_add,
+    op_sub,
+    op_mul,
+    op_div,
+} op_enum;
+
+static const char *op_text[] = { " + ", " - ", " * ", " / " };
+
+/* A term is 11 bits, the unary op then the constant. The code of an
+ * expression has the kind in the top 2 bits, then
+ *     term      the term
+ *     binary    op in bits 22-23, the terms in 11-21 and 0-10
+ *     fraction  p in bits 15-18, q in 11-14 and the term in 0-10 */
+#define TERM(un, atom) (((uint32_t)(un) << 8) | (uint32_t)(atom))
+#define TERM_MASK 0x7ff
+#define KIND_TERM 0u
+#define KIND_BINARY 1u
+#define KIND_FRACTION 2u
+#define CODE_BINARY(op, t1, t2) \
+    ((KIND_BINARY << 30) | ((uint32_t)(op) << 22) | ((t1) << 11) | (t2))
+#define CODE_FRACTION(p, q, t) \
+    ((KIND_FRACTION << 30) | ((uint32_t)(p) << 15) | ((uint32_t)(q) << 11) | (t))
+
+/* a multiple p/q of a term, p and q from 2 */
+#define MAX_PQ 12
+
+typedef struct
+{
+    stackf_t value;
+    calc_int_t key;
+    uint32_t term;
+    int weight;
+    bool user;
+} term_t;
+
+#define MAX_THREADS 16
+
+/* one part of the build, run 0 being the terms and fractions and the
+ * others the + - * / of every other row of terms */
+typedef struct
+{
+    int first_row;
+    int step;
+    entry_t *out;
+    int count;
+    decContext set;
+} run_t;
+
+/* entries looked at in one search, more than there will be for a
+ * sensible number of digits */
+#define MAX_SCAN 100000
+
+static atom_t atoms[MAX_ATOMS];
+static int num_atoms;
+
+/* the built in ones first */
+static term_t terms[MAX_ATOMS * num_un];
+static int num_terms;
+static int num_builtin_terms;
+
+static const entry_t *entries;
+static int num_entries;
+static void *map_base;
+static size_t map_len;
+static entry_t *built_entries;
+
+
+static calc_int_t make_key(const stackf_t *x)
+{
+    uint8_t bcd[DECQUAD_Pmax];
+    bool neg = dfp_get_coefficient(x, bcd) != 0;
+    int digits = 0;
+    calc_int_t c = 0;
+    calc_int_t key;
+
+    for (int i = 0; i < DECQUAD_Pmax; i++)
+    {
+        c = c * 10 + bcd[i];
+        if (c != 0)
+            digits++;
+    }
+    if (c == 0)
+        return KEY_ZERO;
+
+    for (int i = digits; i < DECQUAD_Pmax; i++)
+    {
+        c *= 10;
+    }
+    key = KEY_ZERO | c |
+          (calc_int_t)(dfp_get_exponent(x) + digits - 1 + EXP_BIAS) << COEFF_BITS;
+    return neg ? ~key : key;
+}
+
+static calc_int_t entry_key(const entry_t *e)
+{
+    return (calc_int_t)e->key_hi << 64 | e->key_lo;
+}
+
+static int compare_entry(const void *pa, const void *pb)
+{
+    const entry_t *a = pa;
+    const entry_t *b = pb;
+
+    if (a->key_hi != b->key_hi)
+        return a->key_hi < b->key_hi ? -1 : 1;
+    if (a->key_lo != b->key_lo)
+        return a->key_lo < b->key_lo ? -1 : 1;
+    if (a->complexity != b->complexity)
+        return a->complexity < b->complexity ? -1 : 1;
+    if (a->code != b->code)
+        return a->code < b->code ? -1 : 1;
+    return 0;
+}
+
+static bool usable(const stackf_t *v)
+{
+    return !dfp_is_zero(v) && !dfp_is_nan(v) && !dfp_is_infinite(v);
+}
+
+static void push(run_t *run, const stackf_t *v, uint32_t code, int complexity)
+{
+    entry_t *e;
+    calc_int_t key;
+
+    if (!usable(v))
+        return;
+    key = make_key(v);
+    e = &run->out[run->count++];
+    e->key_hi = (uint64_t)(key >> 64);
+    e->key_lo = (uint64_t)key;
+    e->code = code;
+    e->complexity = (uint32_t)complexity;
+}
+
+static int integer_weight(int n)
+{
+    return n <= 2 ? 1 : n <= 6 ? 2 : 3;
+}
+
+static void set_atoms(const invsym_const_t *user, int num_user)
+{
+    decContext set = dfp_context;
+
+    set.round = DEC_ROUND_HALF_EVEN;
+    num_atoms = 0;
+    for (int n = 1; n <= NUM_INTEGERS; n++)
+    {
+        atom_t *a = &atoms[num_atoms++];
+        sprintf(a->name, "%d", n);
+        dfp_from_int32(&a->value, n);
+        a->weight = integer_weight(n);
+        a->user = false;
+    }
+    for (int i = 0; i < NUM_NAMED; i++)
+    {
+        atom_t *a = &atoms[num_atoms++];
+        strcpy(a->name, named[i].name);
+        dfp_from_string(&a->value, named[i].value, &set);
+        a->weight = named[i].weight;
+        a->user = false;
+    }
+    for (int i = 0; i < num_user && i < INVSYM_MAX_USER; i++)
+    {
+        atom_t *a = &atoms[num_atoms];
+
+        if (!usable(&user[i].value))
+            continue;
+        a->name[0] = '\0';
+        strncat(a->name, user[i].name, INVSYM_NAME_MAX);
+        a->value = user[i].value;
+        a->weight = USER_WEIGHT;
+        a->user = true;
+        num_atoms++;
+    }
+}
+
+/* FNV-1a, of the constants, so the index is rebuilt when they change */
+static uint64_t hash_bytes(uint64_t h, const void *p, size_t n)
+{
+    const uint8_t *b = p;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        h = (h ^ b[i]) * 0x100000001b3ULL;
+    }
+    return h;
+}
+
+static uint64_t atoms_hash(void)
+{
+    uint64_t h = hash_bytes(0xcbf29ce484222325ULL, MAGIC, sizeof(MAGIC));
+
+    for (int i = 0; i < num_atoms; i++)
+    {
+        h = hash_bytes(h, atoms[i].name, strlen(atoms[i].name) + 1);
+        h = hash_bytes(h, &atoms[i].value, sizeof(atoms[i].value));
+        h = hash_bytes(h, &atoms[i].weight, sizeof(atoms[i].weight));
+    }
+    return h;
+}
+
+/* to 34 digits for cbrt, x^(1/3) */
+static const char *ONE_THIRD = "0.3333333333333333333333333333333333";
+
+static void term_value(stackf_t *r, uint32_t term, decContext *set)
+{
+    const stackf_t *x = &atoms[term & 0xff].value;
+    un_enum un = (un_enum)(term >> 8);
+    decNumber dn_x, dn_res, dn_third;
+
+    switch (un)
+    {
+    case un_id:
+        *r = *x;
+        return;
+    case un_sqr:
+        dfp_multiply(r, x, x, set);
+        return;
+    case un_cube:
+        dfp_multiply(r, x, x, set);
+        dfp_multiply(r, r, x, set);
+        return;
+    default:
+        break;
+    }
+
+    dfp_to_number(x, &dn_x); // convert to decNumber
+    if (un == un_sqrt)
+    {
+        decNumberSquareRoot(&dn_res, &dn_x, set);
+    }
+    else if (un == un_cbrt)
+    {
+        decNumberFromString(&dn_third, ONE_THIRD, set);
+        decNumberPower(&dn_res, &dn_x, &dn_third, set);
+    }
+    else if (un == un_ln)
+    {
+        decNumberLn(&dn_res, &dn_x, set);
+    }
+    else
+    {
+        decNumberExp(&dn_res, &dn_x, set);
+    }
+    dfp_from_number(r, &dn_res, set); // convert back from decNumber
+}
+
+/* Every constant with every unary op, the ones that aren't defined or are
+ * 0 left out. Where two have the same value the simpler is kept, or the
+ * plain constant, so that eg. 2^2 doesn't go through the + - * / again as
+ * well as 4. */
+static void make_terms(void)
+{
+    decContext set = dfp_context;
+
+    set.round = DEC_ROUND_HALF_EVEN;
+    num_terms = 0;
+    num_builtin_terms = 0;
+    for (int a = 0; a < num_atoms; a++)
+    {
+        if (a == NUM_BUILTIN)
+        {
+            num_builtin_terms = num_terms;
+        }
+        for (int un = 0; un < num_un; un++)
+        {
+            term_t t;
+            int same = -1;
+
+            t.term = TERM(un, a);
+            term_value(&t.value, t.term, &set);
+            if (!usable(&t.value))
+                continue;
+            t.key = make_key(&t.value);
+            t.weight = atoms[a].weight + un_weight[un];
+            t.user = atoms[a].user;
+
+            for (int i = 0; i < num_terms; i++)
+            {
+                if (terms[i].key == t.key)
+                {
+                    same = i;
+                    break;
+                }
+            }
+            if (same < 0)
+            {
+                terms[num_terms++] = t;
+            }
+            else if (terms[same].user == t.user &&
+                     (t.weight < terms[same].weight ||
+                      (t.weight == terms[same].weight && un == un_id)))
+            {
+                terms[same] = t;
+            }
+        }
+    }
+    if (num_atoms <= NUM_BUILTIN)
+    {
+        num_builtin_terms = num_terms;
+    }
+}
+
+static void binary_value(stackf_t *r, op_enum op, const stackf_t *a,
+                         const stackf_t *b, decContext *set)
+{
+    switch (op)
+    {
+    case op_add:
+        dfp_add(r, a, b, set);
+        break;
+    case op_sub:
+        dfp_subtract(r, a, b, set);
+        break;
+    case op_mul:
+        dfp_multiply(r, a, b, set);
+        break;
+    case op_div:
+        dfp_divide(r, a, b, set);
+        break;
+    }
+}
+
+static void fraction_value(stackf_t *r, int p, int q, const stackf_t *a,
+                           decContext *set)
+{
+    stackf_t sp, sq;
+
+    dfp_from_int32(&sp, p);
+    dfp_from_int32(&sq, q);
+    dfp_divide(r, &sp, &sq, set);
+    dfp_multiply(r, r, a, set);
+}
+
+static void push_binary(run_t *run, op_enum op, const term_t *a,
+                        const term_t *b)
+{
+    stackf_t v;
+
+    binary_value(&v, op, &a->value, &b->value, &run->set);
+    push(run, &v, CODE_BINARY(op, a->term, b->term), a->weight + b->weight + 1);
+}
+
+/* Each term in the rows of this run with every built in term. + and *
+ * only once for each pair, and the other way round as well for - and /
+ * when a is the user's constant, as there's no row for b with a. */
+static void *build_rows(void *arg)
+{
+    run_t *run = arg;
+
+    for (int i = run->first_row; i < num_terms; i += run->step)
+    {
+        const term_t *a = &terms[i];
+
+        for (int j = 0; j < num_builtin_terms; j++)
+        {
+            const term_t *b = &terms[j];
+
+            if (a->user || i <= j)
+            {
+                push_binary(run, op_add, a, b);
+                push_binary(run, op_mul, a, b);
+            }
+            push_binary(run, op_sub, a, b);
+            push_binary(run, op_div, a, b);
+            if (a->user)
+            {
+                push_binary(run, op_sub, b, a);
+                push_binary(run, op_div, b, a);
+            }
+        }
+    }
+    qsort(run->out, run->count, sizeof(entry_t), compare_entry);
+    return NULL;
+}
+
+static void build_terms(run_t *run)
+{
+    for (int i = 0; i < num_terms; i++)
+    {
+        const term_t *t = &terms[i];
+
+        push(run, &t->value, t->term, t->weight);
+        for (int p = 2; p <= MAX_PQ; p++)
+        {
+            for (int q = 2; q <= MAX_PQ; q++)
+            {
+                stackf_t v;
+
+                if (nt_gcd(p, q) != 1)
+                    continue;
+                fraction_value(&v, p, q, &t->value, &run->set);
+                push(run, &v, CODE_FRACTION(p, q, t->term),
+                     t->weight + integer_weight(p) + integer_weight(q) + 1);
+            }
+        }
+    }
+    qsort(run->out, run->count, sizeof(entry_t), compare_entry);
+}
+
+/* the sorted runs merged, keeping the simplest for each value */
+static entry_t *merge_runs(run_t *runs, int num_runs, int *count)
+{
+    int pos[MAX_THREADS + 1] = { 0 };
+    int total = 0;
+    int n = 0;
+    entry_t *out;
+
+    for (int r = 0; r < num_runs; r++)
+    {
+        total += runs[r].count;
+    }
+    out = malloc((total > 0 ? total : 1) * sizeof(entry_t));
+    if (out == NULL)
+        return NULL;
+
+    for (;;)
+    {
+        int best = -1;
+
+        for (int r = 0; r < num_runs; r++)
+        {
+            if (pos[r] < runs[r].count &&
+                (best < 0 || compare_entry(&runs[r].out[pos[r]],
+                                           &runs[best].out[pos[best]]) < 0))
+            {
+                best = r;
+            }
+        }
+        if (best < 0)
+            break;
+
+        const entry_t *e = &runs[best].out[pos[best]++];
+        if (n == 0 || e->key_hi != out[n - 1].key_hi ||
+            e->key_lo != out[n - 1].key_lo)
+        {
+            out[n++] = *e;
+        }
+    }
+    *count = n;
+    return out;
+}
+
+static entry_t *build(int threads, int *count)
+{
+    run_t runs[MAX_THREADS + 1];
+    pthread_t tid[MAX_THREADS];
+    bool started[MAX_THREADS];
+    entry_t *merged = NULL;
+    bool ok = true;
+
+    make_terms();
+    for (int r = 0; r <= threads; r++)
+    {
+        size_t cap = 0;
+
+        runs[r].set = dfp_context;
+        runs[r].set.round = DEC_ROUND_HALF_EVEN;
+        runs[r].count = 0;
+        runs[r].first_row = r - 1;
+        runs[r].step = threads;
+        if (r == 0)
+        {
+            cap = (size_t)num_terms * (1 + (MAX_PQ - 1) * (MAX_PQ - 1));
+        }
+        else
+        {
+            for (int i = r - 1; i < num_terms; i += threads)
+            {
+                cap += (size_t)num_builtin_terms * (terms[i].user ? 6 : 4);
+            }
+        }
+        runs[r].out = malloc((cap > 0 ? cap : 1) * sizeof(entry_t));
+        if (runs[r].out == NULL)
+        {
+            ok = false;
+        }
+    }
+
+    for (int t = 0; t < threads; t++)
+    {
+        started[t] = ok &&
+                     pthread_create(&tid[t], NULL, build_rows, &runs[t + 1]) == 0;
+    }
+    if (ok)
+    {
+        build_terms(&runs[0]);
+    }
+    for (int t = 0; t < threads; t++)
+    {
+        if (started[t])
+        {
+            pthread_join(tid[t], NULL);
+        }
+        else if (ok)
+        {
+            /* couldn't start the thread, do it here */
+            build_rows(&runs[t + 1]);
+        }
+    }
+
+    if (ok)
+    {
+        merged = merge_runs(runs, threads + 1, count);
+    }
+    for (int r = 0; r <= threads; r++)
+    {
+        free(runs[r].out);
+    }
+    return merged;
+}
+
+static void save(const char *path, const entry_t *e, int count, uint64_t hash)
+{
+    header_t h;
+    char *tmp = malloc(strlen(path) + 5);
+    FILE *fp;
+    bool ok;
+
+    if (tmp == NULL)
+        return;
+    sprintf(tmp, "%s.tmp", path);
+    fp = fopen(tmp, "wb");
+    if (fp == NULL)
+    {
+        free(tmp);
+        return;
+    }
+
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, MAGIC, sizeof(MAGIC));
+    h.entry_size = sizeof(entry_t);
+    h.count = (uint32_t)count;
+    h.hash = hash;
+    ok = fwrite(&h, sizeof(h), 1, fp) == 1 &&
+         fwrite(e, sizeof(entry_t), count, fp) == (size_t)count;
+    ok = fclose(fp) == 0 && ok;
+
+    /* written in full first, so there's never half an index */
+    if (!ok || rename(tmp, path) != 0)
+    {
+        remove(tmp);
+    }
+    free(tmp);
+}
+
+static bool map_index(const char *path, uint64_t hash)
+{
+    struct stat st;
+    const header_t *h;
+    void *p;
+    int fd = open(path, O_RDONLY);
+
+    if (fd < 0)
+        return false;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(header_t))
+    {
+        close(fd);
+        return false;
+    }
+    p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED)
+        return false;
+
+    h = p;
+    if (memcmp(h->magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        h->entry_size != sizeof(entry_t) || h->hash != hash ||
+        (size_t)st.st_size != sizeof(header_t) + (size_t)h->count * sizeof(entry_t))
+    {
+        munmap(p, (size_t)st.st_size);
+        return false;
+    }
+    map_base = p;
+    map_len = (size_t)st.st_size;
+    entries = (const entry_t *)(h + 1);
+    num_entries = (int)h->count;
+    return true;
+}
+
+bool invsym_open(const char *path, const invsym_const_t *user, int num_user,
+                 int threads, bool *built)
+{
+    uint64_t hash;
+
+    invsym_close();
+    set_atoms(user, num_user);
+    hash = atoms_hash();
+    *built = false;
+    if (path != NULL && map_index(path, hash))
+        return true;
+
+    if (threads <= 0)
+    {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = n > 0 ? (int)n : 1;
+    }
+    if (threads > MAX_THREADS)
+    {
+        threads = MAX_THREADS;
+    }
+    built_entries = build(threads, &num_entries);
+    if (built_entries == NULL)
+    {
+        num_entries = 0;
+        return false;
+    }
+    entries = built_entries;
+    *built = true;
+    if (path != NULL)
+    {
+        save(path, built_entries, num_entries, hash);
+    }
+    return true;
+}
+
+void invsym_close(void)
+{
+    if (map_base != NULL)
+    {
+        munmap(map_base, map_len);
+        map_base = NULL;
+    }
+    free(built_entries);
+    built_entries = NULL;
+    entries = NULL;
+    num_entries = 0;
+}
+
+int invsym_size(void)
+{
+    return num_entries;
+}
+
+static void term_text(char *buf, uint32_t term)
+{
+    const char *name = atoms[term & 0xff].name;
+    bool paren = strpbrk(name, " +-*/^") != NULL;
+    const char *l = paren ? "(" : "";
+    const char *r = paren ? ")" : "";
+
+    switch ((un_enum)(term >> 8))
+    {
+    case un_id:
+        strcpy(buf, name);
+        break;
+    case un_sqr:
+        sprintf(buf, "%s%s%s^2", l, name, r);
+        break;
+    case un_cube:
+        sprintf(buf, "%s%s%s^3", l, name, r);
+        break;
+    case un_sqrt:
+        sprintf(buf, "sqrt(%s)", name);
+        break;
+    case un_cbrt:
+        sprintf(buf, "cbrt(%s)", name);
+        break;
+    case un_ln:
+        sprintf(buf, "ln(%s)", name);
+        break;
+    default:
+        sprintf(buf, "e^%s%s%s", l, name, r);
+        break;
+    }
+}
+
+static void code_text(char *buf, uint32_t code)
+{
+    uint32_t kind = code >> 30;
+
+    if (kind == KIND_TERM)
+    {
+        term_text(buf, code & TERM_MASK);
+    }
+    else if (kind == KIND_BINARY)
+    {
+        term_text(buf, (code >> 11) & TERM_MASK);
+        strcat(buf, op_text[(code >> 22) & 3]);
+        term_text(buf + strlen(buf), code & TERM_MASK);
+    }
+    else
+    {
+        int len = sprintf(buf, "%d/%d ", (int)(code >> 15) & 0xf,
+                          (int)(code >> 11) & 0xf);
+        term_text(buf + len, code & TERM_MASK);
+    }
+}
+
+static void code_value(stackf_t *r, uint32_t code, decContext *set)
+{
+    uint32_t kind = code >> 30;
+    stackf_t a, b;
+
+    if (kind == KIND_TERM)
+    {
+        term_value(r, code & TERM_MASK, set);
+    }
+    else if (kind == KIND_BINARY)
+    {
+        term_value(&a, (code >> 11) & TERM_MASK, set);
+        term_value(&b, code & TERM_MASK, set);
+        binary_value(r, (op_enum)((code >> 22) & 3), &a, &b, set);
+    }
+    else
+    {
+        term_value(&a, code & TERM_MASK, set);
+        fraction_value(r, (int)(code >> 15) & 0xf, (int)(code >> 11) & 0xf,
+                       &a, set);
+    }
+}
+
+/* what was searched for, x or -x or 1/x */
+typedef enum
+{
+    form_plain,
+    form_neg,
+    form_inv
+} form_enum;
+
+/* first entry with a key >= key */
+static int lower_bound(calc_int_t key)
+{
+    int lo = 0;
+    int hi = num_entries;
+
+    while (lo < hi)
+    {
+        int mid = lo + (hi - lo) / 2;
+        if (entry_key(&entries[mid]) < key)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/* added in order of complexity, after any that are as simple */
+static void add_match(const entry_t *e, form_enum form, invsym_match_t *m,
+                      int *num, int max, decContext *set)
+{
+    /* room for -( ) or 1 / ( ) round it */
+    char inner[INVSYM_TEXT_MAX - 8];
+    char text[INVSYM_TEXT_MAX];
+    int complexity = (int)e->complexity + (form != form_plain);
+    stackf_t v;
+    int at;
+
+    if (*num == max && complexity >= m[max - 1].complexity)
+        return;
+
+    code_text(inner, e->code);
+    if (form == form_plain)
+    {
+        strcpy(text, inner);
+    }
+    else
+    {
+        bool paren = strchr(inner, ' ') != NULL;
+
+        sprintf(text, "%s%s%s%s", form == form_neg ? "-" : "1 / ",
+                paren ? "(" : "", inner, paren ? ")" : "");
+    }
+    for (int i = 0; i < *num; i++)
+    {
+        if (strcmp(m[i].text, text) == 0)
+            return;
+    }
+
+    code_value(&v, e->code, set);
+    if (form == form_neg)
+    {
+        dfp_minus(&v, &v, set);
+    }
+    else if (form == form_inv)
+    {
+        stackf_t one;
+        dfp_from_int32(&one, 1);
+        dfp_divide(&v, &one, &v, set);
+    }
+
+    for (at = *num; at > 0 && m[at - 1].complexity > complexity; at--)
+        ;
+    if (*num < max)
+    {
+        (*num)++;
+    }
+    memmove(&m[at + 1], &m[at], (*num - 1 - at) * sizeof(*m));
+    strcpy(m[at].text, text);
+    m[at].value = v;
+    m[at].complexity = complexity;
+}
+
+static void search(const stackf_t *x, form_enum form, int digits,
+                   invsym_match_t *m, int *num, int max, decContext *set)
+{
+    char buf[20];
+    stackf_t scale, tol, lo, hi;
+    calc_int_t key_hi;
+
+    sprintf(buf, "1E-%d", digits);
+    dfp_from_string(&scale, buf, set);
+    dfp_abs(&tol, x, set);
+    dfp_multiply(&tol, &tol, &scale, set);
+    dfp_subtract(&lo, x, &tol, set);
+    dfp_add(&hi, x, &tol, set);
+    key_hi = make_key(&hi);
+
+    for (int i = lower_bound(make_key(&lo)), n = 0;
+         i < num_entries && n < MAX_SCAN && entry_key(&entries[i]) <= key_hi;
+         i++, n++)
+    {
+        add_match(&entries[i], form, m, num, max, set);
+    }
+}
+
+int invsym_lookup(const stackf_t *x, int digits, invsym_match_t *m, int max)
+{
+    decContext set = dfp_context;
+    stackf_t y, one;
+    int num = 0;
+
+    set.round = DEC_ROUND_HALF_EVEN;
+    if (num_entries == 0 || max <= 0 || !usable(x))
+        return 0;
+    if (digits < 1)
+    {
+        digits = 1;
+    }
+    if (digits > DECQUAD_Pmax)
+    {
+        digits = DECQUAD_Pmax;
+    }
+
+    search(x, form_plain, digits, m, &num, max, &set);
+    dfp_minus(&y, x, &set);
+    search(&y, form_neg, digits, m, &num, max, &set);
+    dfp_from_int32(&one, 1);
+    dfp_divide(&y, &one, x, &set);
+    search(&y, form_inv, digits, m, &num, max, &set);
+    return num;
+}
@@ -0,0 +1,80 @@
+/*****************************************************************************
+ * File invsym.h part of ProgAndSciCalc
+ *
+ * Copyright (C) 2018 Ken Bromham
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef INVSYM_H
+#define INVSYM_H
+
+#include <stdbool.h>
+#include "calc_types.h"
+
+/* Inverse symbolic lookup, in the spirit of RIES and the Plouffe inverter,
+ * eg. 2.4674011002723 is pi^2 / 4.
+ *
+ * An index is made of the values of small expressions on the constants
+ * pi, e, phi, gamma, zeta(3), Catalan's G and 1 to 12, plus the user's
+ * constants. Each constant c can have one of
+ *     c  c^2  c^3  sqrt(c)  cbrt(c)  ln(c)  e^c
+ * applied, then two of those are combined with + - * /, or one is
+ * multiplied by a fraction p/q with p, q up to 12. Only one side of a
+ * + - * / can be a user constant, to keep the size down.
+ *
+ * The values are sorted on a 128 bit key that is in the same order as the
+ * decQuad values, so a lookup is a binary search. Where expressions have
+ * the same value the simplest is kept. The index is built with a few
+ * threads, and saved to a file that is mapped into memory the next time,
+ * rebuilt when the constants change. */
+
+/* the user's constants, at most this many are used */
+#define INVSYM_MAX_USER 64
+#define INVSYM_NAME_MAX 40
+
+typedef struct
+{
+    char name[INVSYM_NAME_MAX + 1];
+    stackf_t value;
+} invsym_const_t;
+
+/* eg. 3/4 (Planck constant)^2 - ... */
+#define INVSYM_TEXT_MAX (4 * INVSYM_NAME_MAX + 40)
+
+typedef struct
+{
+    char text[INVSYM_TEXT_MAX];
+    stackf_t value;
+    int complexity;
+} invsym_match_t;
+
+/* Map the index in the file at path, or build it (with threads threads)
+ * and save it there if it's missing or was made from other constants.
+ * If it can't be saved it's kept in memory. false if out of memory.
+ * built is set true if it was built. */
+bool invsym_open(const char *path, const invsym_const_t *user, int num_user,
+                 int threads, bool *built);
+void invsym_close(void);
+
+/* number of expressions in the index, 0 if not open */
+int invsym_size(void);
+
+/* Expressions with a value within a relative 10^-digits of x, also
+ * -(expr) and 1 / (expr), simplest first, up to max of them. Returns the
+ * number found. */
+int invsym_lookup(const stackf_t *x, int digits, invsym_match_t *m, int max);
+
+#endif
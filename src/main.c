@@ -48,11 +48,14 @@ int main(int argc, char *argv[])
     config_init();
 
     display_init(config_get_hex_grouping());
+    display_set_normal_float_format(config_get_float_format());
+    display_set_float_fixed_places(config_get_fixed_places());
+    display_set_float_grouping(config_get_digit_grouping());
 
     calc_mode_enum mode = config_get_calc_mode();
     int rand_range = config_get_random_01() ? 0 : config_get_random_n();
     bool sct_round = config_get_use_sct_rounding();
-    calc_width_enum width = config_get_integer_width();
+    calc_width_t width = config_get_integer_width();
     bool int_unsigned = config_get_use_unsigned();
     bool warn_signed = config_get_warn_on_signed_overflow();
     bool warn_unsigned = config_get_warn_on_unsigned_overflow();
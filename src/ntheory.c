@@ -0,0 +1,813 @@
+/*****************************************************************************
+ * File ntheory.c part of ProgAndSciCalc
+ *
+ * Copyright (C) 2018 Ken Bromham
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "ntheory.h"
+#include "bitops.h"
+
+typedef unsigned __int128 u128;
+
+#define U64_MAX_128 ((u128)UINT64_MAX)
+
+static const uint8_t small_primes[] =
+{
+    2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53, 59, 61, 67,
+    71, 73, 79, 83, 89, 97
+};
+#define NUM_SMALL_PRIMES (int)(sizeof(small_primes) / sizeof(small_primes[0]))
+
+/* Miller-Rabin bases with no strong pseudoprimes below 2^64 (found by
+ * Jim Sinclair) */
+static const uint64_t mr_bases_64[] =
+{
+    2, 325, 9375, 28178, 450775, 9780504, 1795265022
+};
+#define NUM_MR_BASES_64 (int)(sizeof(mr_bases_64) / sizeof(mr_bases_64[0]))
+
+/* the first 13 primes (to 41) as bases are exact below this */
+#define MR_PRIMES_EXACT_LIMIT ((u128)3317044064679887385ULL * 1000000 + 961981)
+#define MR_PRIMES_EXACT_BASES 13
+
+/* trial division before rho */
+#define TRIAL_DIV_LIMIT 1000
+
+/* rho gives up on a part above 64 bits after this many steps */
+#define RHO_128_MAX_STEPS (1 << 20)
+
+
+/* Stein's binary gcd, taking out the common power of 2 first */
+static uint64_t gcd64(uint64_t a, uint64_t b)
+{
+    int shift;
+
+    if (a == 0)
+        return b;
+    if (b == 0)
+        return a;
+    shift = __builtin_ctzll(a | b);
+    a >>= __builtin_ctzll(a);
+    do
+    {
+        b >>= __builtin_ctzll(b);
+        if (a > b)
+        {
+            uint64_t t = a;
+            a = b;
+            b = t;
+        }
+        b -= a;
+    } while (b != 0);
+    return a << shift;
+}
+
+u128 nt_gcd(u128 a, u128 b)
+{
+    int shift;
+
+    if (a <= U64_MAX_128 && b <= U64_MAX_128)
+        return gcd64((uint64_t)a, (uint64_t)b);
+    if (a == 0)
+        return b;
+    if (b == 0)
+        return a;
+    shift = bitops_ctz(a | b, 128);
+    a >>= bitops_ctz(a, 128);
+    do
+    {
+        b >>= bitops_ctz(b, 128);
+        if (a > b)
+        {
+            u128 t = a;
+            a = b;
+            b = t;
+        }
+        b -= a;
+        /* finish off in 64 bits once both fit */
+        if (a <= U64_MAX_128 && b <= U64_MAX_128)
+            return (u128)gcd64((uint64_t)a, (uint64_t)b) << shift;
+    } while (b != 0);
+    return a << shift;
+}
+
+
+/*
+ * Montgomery arithmetic mod an odd n < 2^64, with R = 2^64. Values are
+ * held as aR mod n, so a multiply needs no division, only the reduction
+ * (REDC) of the 128 bit product.
+ */
+typedef struct
+{
+    uint64_t n;
+    uint64_t ninv;  /* n^-1 mod 2^64 */
+    uint64_t one;   /* R mod n */
+    uint64_t r2;    /* R^2 mod n */
+} mont_t;
+
+static void mont_init(mont_t *m, uint64_t n)
+{
+    /* n is its own inverse mod 8, each Newton step doubles the bits */
+    uint64_t inv = n;
+    for (int i = 0; i < 5; i++)
+    {
+        inv *= 2 - n * inv;
+    }
+    m->n = n;
+    m->ninv = inv;
+    m->one = (0 - n) % n;
+    m->r2 = (uint64_t)((u128)m->one * m->one % n);
+}
+
+/* t R^-1 mod n for t < nR. Subtracting mn (with m chosen to clear the low
+ * 64 bits) rather than adding keeps it within 128 bits. */
+static uint64_t mont_redc(const mont_t *m, u128 t)
+{
+    uint64_t q = (uint64_t)t * m->ninv;
+    uint64_t hi = (uint64_t)(t >> 64);
+    uint64_t qn_hi = (uint64_t)(((u128)q * m->n) >> 64);
+
+    return hi >= qn_hi ? hi - qn_hi : hi - qn_hi + m->n;
+}
+
+static uint64_t mont_mul(const mont_t *m, uint64_t a, uint64_t b)
+{
+    return mont_redc(m, (u128)a * b);
+}
+
+static uint64_t mont_to(const mont_t *m, uint64_t a)
+{
+    return mont_mul(m, a % m->n, m->r2);
+}
+
+static uint64_t mont_pow(const mont_t *m, uint64_t b, uint64_t e)
+{
+    uint64_t r = m->one;
+
+    while (e != 0)
+    {
+        if (e & 1)
+            r = mont_mul(m, r, b);
+        b = mont_mul(m, b, b);
+        e >>= 1;
+    }
+    return r;
+}
+
+/* strong probable prime test to base a (not a multiple of n), n odd */
+static bool mr_test_64(const mont_t *m, uint64_t a, uint64_t d, int s)
+{
+    uint64_t minus_one = m->n - m->one;
+    uint64_t x = mont_pow(m, mont_to(m, a), d);
+
+    if (x == m->one || x == minus_one)
+        return true;
+    for (int i = 1; i < s; i++)
+    {
+        x = mont_mul(m, x, x);
+        if (x == minus_one)
+            return true;
+    }
+    return false;
+}
+
+static bool is_prime_64(uint64_t n)
+{
+    mont_t m;
+    uint64_t d;
+    int s;
+
+    if (n < 2)
+        return false;
+    for (int i = 0; i < NUM_SMALL_PRIMES; i++)
+    {
+        if (n % small_primes[i] == 0)
+            return n == small_primes[i];
+    }
+    if (n < 97 * 97)
+        return true;
+
+    mont_init(&m, n);
+    s = __builtin_ctzll(n - 1);
+    d = (n - 1) >> s;
+    for (int i = 0; i < NUM_MR_BASES_64; i++)
+    {
+        uint64_t a = mr_bases_64[i] % n;
+        if (a != 0 && !mr_test_64(&m, a, d, s))
+            return false;
+    }
+    return true;
+}
+
+
+/* Above 64 bits, a * b mod n the long way, doubling and adding. Only
+ * needed for the few values above 64 bits so kept simple. */
+static u128 addmod128(u128 a, u128 b, u128 n)
+{
+    /* a + b - n without overflowing */
+    return a >= n - b ? a - (n - b) : a + b;
+}
+
+static u128 mulmod128(u128 a, u128 b, u128 n)
+{
+    u128 r = 0;
+
+    if (a < b)
+    {
+        u128 t = a;
+        a = b;
+        b = t;
+    }
+    for (int i = 127 - bitops_clz(b, 128); i >= 0; i--)
+    {
+        r = addmod128(r, r, n);
+        if ((b >> i) & 1)
+            r = addmod128(r, a, n);
+    }
+    return r;
+}
+
+static u128 powmod128(u128 b, u128 e, u128 n)
+{
+    u128 r = 1;
+
+    while (e != 0)
+    {
+        if (e & 1)
+            r = mulmod128(r, b, n);
+        b = mulmod128(b, b, n);
+        e >>= 1;
+    }
+    return r;
+}
+
+static bool is_prime_128(u128 n)
+{
+    u128 d;
+    int s;
+    int bases;
+
+    for (int i = 0; i < NUM_SMALL_PRIMES; i++)
+    {
+        if (n % small_primes[i] == 0)
+            return false;
+    }
+    s = bitops_ctz(n - 1, 128);
+    d = (n - 1) >> s;
+    bases = n < MR_PRIMES_EXACT_LIMIT ? MR_PRIMES_EXACT_BASES : NUM_SMALL_PRIMES;
+    for (int i = 0; i < bases; i++)
+    {
+        u128 x = powmod128(small_primes[i], d, n);
+        bool pass = x == 1 || x == n - 1;
+        for (int j = 1; j < s && !pass; j++)
+        {
+            x = mulmod128(x, x, n);
+            pass = x == n - 1;
+        }
+        if (!pass)
+            return false;
+    }
+    return true;
+}
+
+bool nt_is_prime(u128 n)
+{
+    if (n <= U64_MAX_128)
+        return is_prime_64((uint64_t)n);
+    return is_prime_128(n);
+}
+
+u128 nt_next_prime(u128 n)
+{
+    if (n < 2)
+        return 2;
+    /* the next odd number, then every other */
+    n += (n & 1) ? 2 : 1;
+    for (; n >= 3; n += 2)
+    {
+        if (nt_is_prime(n))
+            return n;
+    }
+    /* wrapped */
+    return 0;
+}
+
+
+/*
+ * Pollard's rho, with Brent's cycle finding and the gcd taken once for a
+ * batch of RHO_BATCH steps (multiplying the differences together). If the
+ * batch overshoots to a gcd of n it steps back through the batch one at a
+ * time. Returns a factor of n, which may be n itself if this c failed.
+ */
+#define RHO_BATCH 128
+
+static uint64_t absdiff64(uint64_t a, uint64_t b)
+{
+    return a > b ? a - b : b - a;
+}
+
+static uint64_t rho_step(const mont_t *m, uint64_t y, uint64_t c)
+{
+    /* y^2 + c mod n */
+    y = mont_mul(m, y, y);
+    return y >= m->n - c ? y - (m->n - c) : y + c;
+}
+
+static uint64_t rho_64(uint64_t n, uint64_t c)
+{
+    mont_t m;
+    uint64_t x, y, ys = 0, q, g = 1;
+
+    mont_init(&m, n);
+    y = mont_to(&m, 2);
+    q = m.one;
+    x = y;
+
+    for (uint64_t r = 1; g == 1; r *= 2)
+    {
+        x = y;
+        for (uint64_t i = 0; i < r; i++)
+        {
+            y = rho_step(&m, y, c);
+        }
+        for (uint64_t k = 0; k < r && g == 1; k += RHO_BATCH)
+        {
+            uint64_t steps = r - k < RHO_BATCH ? r - k : RHO_BATCH;
+            ys = y;
+            for (uint64_t i = 0; i < steps; i++)
+            {
+                y = rho_step(&m, y, c);
+                q = mont_mul(&m, q, absdiff64(x, y));
+            }
+            /* q is in Montgomery form, but R is coprime to n so that
+             * doesn't change the gcd */
+            g = gcd64(q, n);
+        }
+    }
+    if (g == n)
+    {
+        do
+        {
+            ys = rho_step(&m, ys, c);
+            g = gcd64(absdiff64(x, ys), n);
+        } while (g == 1);
+    }
+    return g;
+}
+
+/* the same above 64 bits, with a limit on the steps, returns 0 if it gives
+ * up */
+static u128 rho_128(u128 n, u128 c)
+{
+    u128 x, y = 2, ys = 2, q = 1, g = 1;
+    long steps_done = 0;
+
+    for (long r = 1; g == 1; r *= 2)
+    {
+        x = y;
+        for (long i = 0; i < r; i++)
+        {
+            y = addmod128(mulmod128(y, y, n), c, n);
+        }
+        for (long k = 0; k < r && g == 1; k += RHO_BATCH)
+        {
+            long steps = r - k < RHO_BATCH ? r - k : RHO_BATCH;
+            ys = y;
+            for (long i = 0; i < steps; i++)
+            {
+                y = addmod128(mulmod128(y, y, n), c, n);
+                q = mulmod128(q, x > y ? x - y : y - x, n);
+            }
+            g = nt_gcd(q, n);
+            steps_done += steps;
+        }
+        if (steps_done > RHO_128_MAX_STEPS)
+            return 0;
+    }
+    if (g == n)
+    {
+        do
+        {
+            ys = addmod128(mulmod128(ys, ys, n), c, n);
+            g = nt_gcd(x > ys ? x - ys : ys - x, n);
+        } while (g == 1);
+    }
+    return g;
+}
+
+typedef struct
+{
+    u128 *factors;
+    int num;
+    bool complete;
+} factor_list_t;
+
+static void add_factor(factor_list_t *fl, u128 f)
+{
+    if (fl->num < NT_MAX_FACTORS)
+        fl->factors[fl->num++] = f;
+}
+
+/* n odd with no small factors */
+static void factor_rec(factor_list_t *fl, u128 n)
+{
+    u128 d = 0;
+
+    if (n == 1)
+        return;
+    if (nt_is_prime(n))
+    {
+        add_factor(fl, n);
+        return;
+    }
+    /* try c = 1, 2, ... until rho splits n */
+    for (uint64_t c = 1; d == 0 || d == n; c++)
+    {
+        if (n <= U64_MAX_128)
+        {
+            d = rho_64((uint64_t)n, c);
+        }
+        else
+        {
+            d = rho_128(n, c);
+            if (d == 0 || c > 4)
+            {
+                /* couldn't split it */
+                add_factor(fl, n);
+                fl->complete = false;
+                return;
+            }
+        }
+    }
+    factor_rec(fl, d);
+    factor_rec(fl, n / d);
+}
+
+int nt_factor(u128 n, u128 *factors, bool *complete)
+{
+    factor_list_t fl = { factors, 0, true };
+    int tz;
+
+    if (n < 2)
+    {
+        *complete = true;
+        return 0;
+    }
+    tz = bitops_ctz(n, 128);
+    for (int i = 0; i < tz; i++)
+    {
+        add_factor(&fl, 2);
+    }
+    n >>= tz;
+    for (uint64_t p = 3; p < TRIAL_DIV_LIMIT && p * p <= n; p += 2)
+    {
+        while (n % p == 0)
+        {
+            add_factor(&fl, p);
+            n /= p;
+        }
+    }
+    factor_rec(&fl, n);
+
+    /* rho finds them in any order, insertion sort as there are few */
+    for (int i = 1; i < fl.num; i++)
+    {
+        u128 f = factors[i];
+        int j = i;
+        for (; j > 0 && factors[j - 1] > f; j--)
+        {
+            factors[j] = factors[j - 1];
+        }
+        factors[j] = f;
+    }
+    *complete = fl.complete;
+    return fl.num;
+}
+
+
+u128 nt_isqrt(u128 n)
+{
+    u128 x, y;
+
+    if (n < 2)
+        return n;
+    /* Newton from above, starting at a power of 2 at least sqrt(n) */
+    x = (u128)1 << ((128 - bitops_clz(n, 128) + 1) / 2);
+    for (;;)
+    {
+        y = (x + n / x) / 2;
+        if (y >= x)
+            return x;
+        x = y;
+    }
+}
+
+u128 nt_icbrt(u128 n)
+{
+    u128 y = 0;
+
+    /* a bit at a time from the top, as for a square root (Hacker's
+     * Delight), comparing with n shifted down so nothing overflows */
+    for (int s = 126; s >= 0; s -= 3)
+    {
+        u128 b;
+        y *= 2;
+        b = 3 * y * (y + 1) + 1;
+        if ((n >> s) >= b)
+        {
+            n -= b << s;
+            y++;
+        }
+    }
+    return y;
+}
+
+int nt_ilog2(u128 n)
+{
+    return 127 - bitops_clz(n, 128);
+}
+
+int nt_ilog10(u128 n)
+{
+    u128 p = 10;
+    int r = 0;
+
+    if (n == 0)
+        return -1;
+    /* 10^38 < 2^128 < 10^39 */
+    while (r < 38 && n >= p)
+    {
+        p *= 10;
+        r++;
+    }
+    return r;
+}
+
+
+/*
+ * Arithmetic mod m for m < 2^64, the products done in 128 bits.
+ */
+
+uint64_t nt_mulmod(uint64_t a, uint64_t b, uint64_t m)
+{
+    return (uint64_t)((u128)a * b % m);
+}
+
+/* b^e mod 2^k, k < 64, wrapping in 64 bits does the mod for free */
+static uint64_t powmod_2k(uint64_t b, u128 e, int k)
+{
+    uint64_t r = 1;
+
+    for (; e != 0; e >>= 1)
+    {
+        if (e & 1)
+            r *= b;
+        b *= b;
+    }
+    return r & ((UINT64_C(1) << k) - 1);
+}
+
+/* Montgomery needs m odd, so for m = 2^k q the result is worked out mod q
+ * and mod 2^k separately, then put together (CRT) */
+uint64_t nt_powmod(uint64_t b, u128 e, uint64_t m)
+{
+    uint64_t q;
+    uint64_t rq = 0;
+    uint64_t r2, qinv;
+    int k;
+
+    if (m <= 1)
+        return 0;
+    k = __builtin_ctzll(m);
+    q = m >> k;
+    if (q > 1)
+    {
+        mont_t mq;
+        uint64_t x;
+
+        mont_init(&mq, q);
+        x = mont_to(&mq, b);
+        rq = mq.one;
+        for (u128 ee = e; ee != 0; ee >>= 1)
+        {
+            if (ee & 1)
+                rq = mont_mul(&mq, rq, x);
+            x = mont_mul(&mq, x, x);
+        }
+        rq = mont_redc(&mq, rq);
+        if (k == 0)
+            return rq;
+        qinv = mq.ninv;
+    }
+    else
+    {
+        qinv = 1;
+    }
+    /* x = rq + q t, with t chosen to make x = r2 mod 2^k */
+    r2 = powmod_2k(b, e, k);
+    return rq + q * ((r2 - rq) * qinv & ((UINT64_C(1) << k) - 1));
+}
+
+bool nt_modinv(uint64_t a, uint64_t m, uint64_t *inv)
+{
+    /* extended Euclid, the coefficients stay below m in magnitude */
+    __int128 t0 = 0, t1 = 1;
+    uint64_t r0 = m, r1 = a % m;
+
+    while (r1 != 0)
+    {
+        uint64_t q = r0 / r1;
+        uint64_t r = r0 - q * r1;
+        __int128 t = t0 - (__int128)q * t1;
+        r0 = r1;
+        r1 = r;
+        t0 = t1;
+        t1 = t;
+    }
+    if (r0 != 1)
+        return false;
+    *inv = (uint64_t)(t0 < 0 ? t0 + m : t0);
+    return true;
+}
+
+/* the same for 128 bit m, the coefficients kept mod m (which makes it
+ * slow, but it's only used for CRT) */
+static bool modinv128(u128 a, u128 m, u128 *inv)
+{
+    u128 t0 = 0, t1 = 1;
+    u128 r0 = m, r1 = a % m;
+
+    while (r1 != 0)
+    {
+        u128 q = r0 / r1;
+        u128 r = r0 - q * r1;
+        u128 qt = mulmod128(q % m, t1, m);
+        u128 t = t0 >= qt ? t0 - qt : t0 + (m - qt);
+        r0 = r1;
+        r1 = r;
+        t0 = t1;
+        t1 = t;
+    }
+    if (r0 != 1)
+        return false;
+    *inv = t0;
+    return true;
+}
+
+bool nt_crt(const u128 *r, const u128 *m, int num, u128 *x, u128 *mod)
+{
+    u128 x1 = 0;
+    u128 m1 = 1;
+
+    for (int i = 0; i < num; i++)
+    {
+        u128 m2 = m[i];
+        u128 g, m2g, d, inv, t;
+
+        if (m2 == 0)
+            return false;
+        /* x1 + m1 t = r2 mod m2, solvable if g divides r2 - x1 */
+        g = nt_gcd(m1, m2);
+        d = r[i] % m2;
+        d = d >= x1 % m2 ? d - x1 % m2 : d + (m2 - x1 % m2);
+        if (d % g != 0)
+            return false;
+        m2g = m2 / g;
+        if (m1 > ~(u128)0 / m2g)
+        {
+            /* lcm beyond 128 bits */
+            return false;
+        }
+        t = 0;
+        if (m2g > 1)
+        {
+            if (!modinv128((m1 / g) % m2g, m2g, &inv))
+                return false;
+            t = mulmod128((d / g) % m2g, inv, m2g);
+        }
+        x1 += m1 * t;
+        m1 *= m2g;
+    }
+    *x = x1;
+    *mod = m1;
+    return true;
+}
+
+
+/*
+ * Discrete log by baby step giant step, with the extension for a and m
+ * not coprime: while they share a factor g, b must have it too and it is
+ * divided out of the congruence (each time taking one more power of a).
+ * The baby steps a^j b are kept in a hash table of value to j.
+ */
+typedef struct
+{
+    uint64_t val;
+    uint32_t j;     /* j + 1, 0 for an empty slot */
+} dlog_slot_t;
+
+static uint64_t dlog_hash(uint64_t v, int bits)
+{
+    return (v * UINT64_C(0x9e3779b97f4a7c15)) >> (64 - bits);
+}
+
+int nt_dlog(uint64_t a, uint64_t b, uint64_t m, uint64_t *x)
+{
+    uint64_t k = 1;     /* the power of a taken out so far, times the bits
+                         * of a that weren't shared with m */
+    uint64_t count = 0;
+    uint64_t g, n, an, cur;
+    dlog_slot_t *table;
+    int bits;
+
+    if (m == 1)
+    {
+        *x = 0;
+        return NT_DLOG_FOUND;
+    }
+    a %= m;
+    b %= m;
+    while ((g = gcd64(a, m)) != 1)
+    {
+        if (b == k)
+        {
+            *x = count;
+            return NT_DLOG_FOUND;
+        }
+        if (b % g != 0)
+            return NT_DLOG_NONE;
+        b /= g;
+        m /= g;
+        count++;
+        k = nt_mulmod(k, a / g, m);
+    }
+    if (b == k % m)
+    {
+        *x = count;
+        return NT_DLOG_FOUND;
+    }
+    if (m > NT_DLOG_MAX_MODULUS)
+        return NT_DLOG_TOO_BIG;
+
+    n = nt_isqrt(m - 1) + 1;
+    for (bits = 1; (UINT64_C(1) << bits) < 2 * n; bits++)
+    {
+    }
+    table = calloc((size_t)1 << bits, sizeof(*table));
+    if (table == NULL)
+        return NT_DLOG_TOO_BIG;
+
+    /* baby steps, a later j replaces an earlier one with the same value
+     * so the smallest x is found */
+    cur = b;
+    for (uint64_t j = 0; j < n; j++)
+    {
+        uint64_t h = dlog_hash(cur, bits);
+        while (table[h].j != 0 && table[h].val != cur)
+        {
+            h = (h + 1) & ((UINT64_C(1) << bits) - 1);
+        }
+        table[h].val = cur;
+        table[h].j = (uint32_t)(j + 1);
+        cur = nt_mulmod(cur, a, m);
+    }
+
+    /* giant steps, k a^(in) = a^j b for x = in - j */
+    an = nt_powmod(a, n, m);
+    cur = k % m;
+    for (uint64_t i = 1; i <= n; i++)
+    {
+        uint64_t h;
+        cur = nt_mulmod(cur, an, m);
+        h = dlog_hash(cur, bits);
+        while (table[h].j != 0)
+        {
+            if (table[h].val == cur)
+            {
+                *x = i * n - (table[h].j - 1) + count;
+                free(table);
+                return NT_DLOG_FOUND;
+            }
+            h = (h + 1) & ((UINT64_C(1) << bits) - 1);
+        }
+    }
+    free(table);
+    return NT_DLOG_NONE;
+}
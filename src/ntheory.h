@@ -0,0 +1,86 @@
+/*****************************************************************************
+ * File ntheory.h part of ProgAndSciCalc
+ *
+ * Copyright (C) 2018 Ken Bromham
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef NTHEORY_H
+#define NTHEORY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Number theory on unsigned values of up to 128 bits.
+ *
+ * Below 2^64 everything is exact and quick: Miller-Rabin with a set of
+ * bases known to have no exceptions below 2^64, and factoring with
+ * Pollard's rho (Brent's version), all mod n done in Montgomery form.
+ * Above 2^64 the primality test is exact below 3.3e24 and a test with 25
+ * bases beyond that, and factoring gives up on a composite part that
+ * rho can't split in reasonable time. */
+
+/* the most prime factors there can be, 2^128 */
+#define NT_MAX_FACTORS 128
+
+unsigned __int128 nt_gcd(unsigned __int128 a, unsigned __int128 b);
+
+bool nt_is_prime(unsigned __int128 n);
+
+/* smallest prime greater than n, 0 if that's beyond 128 bits */
+unsigned __int128 nt_next_prime(unsigned __int128 n);
+
+/* The prime factors of n (n > 1) in ascending order, repeated as many
+ * times as they divide n. Returns the number of factors. complete is
+ * false if the last one is a composite part that couldn't be split. */
+int nt_factor(unsigned __int128 n, unsigned __int128 *factors, bool *complete);
+
+/* largest r with r^2 <= n */
+unsigned __int128 nt_isqrt(unsigned __int128 n);
+
+/* largest r with r^3 <= n */
+unsigned __int128 nt_icbrt(unsigned __int128 n);
+
+/* floor of log2 and log10, -1 for 0 */
+int nt_ilog2(unsigned __int128 n);
+int nt_ilog10(unsigned __int128 n);
+
+/* Arithmetic mod m, for 0 < m < 2^64. Arguments to mulmod are less than
+ * m, powmod and modinv reduce theirs. powmod is Montgomery multiplication
+ * (for the odd part of m), so well under a microsecond for any e. */
+uint64_t nt_mulmod(uint64_t a, uint64_t b, uint64_t m);
+uint64_t nt_powmod(uint64_t b, unsigned __int128 e, uint64_t m);
+
+/* false if a and m aren't coprime */
+bool nt_modinv(uint64_t a, uint64_t m, uint64_t *inv);
+
+/* Chinese remainder: the x that is r[i] mod m[i] for all i, with the
+ * moduli not needing to be coprime. x is returned mod the lcm of the
+ * moduli (in *mod). false if there is no such x, or the lcm is beyond 128
+ * bits. */
+bool nt_crt(const unsigned __int128 *r, const unsigned __int128 *m, int num,
+            unsigned __int128 *x, unsigned __int128 *mod);
+
+/* Discrete log, the smallest x with a^x = b mod m. Baby step giant step
+ * needs a table of about sqrt(m) entries, so the part of m that is
+ * coprime to a is limited to NT_DLOG_MAX_MODULUS. */
+#define NT_DLOG_FOUND 1
+#define NT_DLOG_NONE 0
+#define NT_DLOG_TOO_BIG -1
+#define NT_DLOG_MAX_MODULUS (UINT64_C(1) << 40)
+int nt_dlog(uint64_t a, uint64_t b, uint64_t m, uint64_t *x);
+
+#endif
@@ -0,0 +1,333 @@
+/*****************************************************************************
+ * File radix_print.c part of ProgAndSciCalc
+ *
+ * Copyright (C) 2018 Ken Bromham
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "radix_print.h"
+
+static const char digit_chars[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+/* digits for a byte in hex and binary, 6 bits in octal, 0 - 99 in dec */
+static char hex_tab[256][2];
+static char bin_tab[256][8];
+static char oct_tab[64][2];
+static char dec_tab[100][2];
+
+/* for the other bases, the largest power of the base that fits in 32 bits
+ * and the number of digits in it */
+static uint32_t chunk_pow[37];
+static int chunk_digits[37];
+
+static bool tables_ready;
+
+
+static void init_tables(void)
+{
+    for (int i = 0; i < 256; i++)
+    {
+        hex_tab[i][0] = digit_chars[i >> 4];
+        hex_tab[i][1] = digit_chars[i & 0xf];
+        for (int j = 0; j < 8; j++)
+        {
+            bin_tab[i][j] = (char)('0' + ((i >> (7 - j)) & 1));
+        }
+    }
+    for (int i = 0; i < 64; i++)
+    {
+        oct_tab[i][0] = (char)('0' + (i >> 3));
+        oct_tab[i][1] = (char)('0' + (i & 7));
+    }
+    for (int i = 0; i < 100; i++)
+    {
+        dec_tab[i][0] = (char)('0' + i / 10);
+        dec_tab[i][1] = (char)('0' + i % 10);
+    }
+    for (int base = 2; base <= 36; base++)
+    {
+        uint64_t p = base;
+        int n = 1;
+        while (p * base <= UINT32_MAX)
+        {
+            p *= base;
+            n++;
+        }
+        chunk_pow[base] = (uint32_t)p;
+        chunk_digits[base] = n;
+    }
+    tables_ready = true;
+}
+
+
+/* number of significant bits in val, at least 1 */
+static int num_bits(uint64_t val)
+{
+    return val ? 64 - __builtin_clzll(val) : 1;
+}
+
+
+/* Digits of val (no leading zeros, at least one digit) ending just before
+ * end, returns the first. Up to 7 chars before the first may also be
+ * written. */
+static char *put_digits64(char *end, uint64_t val, int base)
+{
+    char *p = end;
+    int n;
+
+    switch (base)
+    {
+    case 16:
+        n = (num_bits(val) + 3) / 4;
+        do
+        {
+            p -= 2;
+            memcpy(p, hex_tab[val & 0xff], 2);
+            val >>= 8;
+        } while (val);
+        return end - n;
+
+    case 2:
+        n = num_bits(val);
+        do
+        {
+            p -= 8;
+            memcpy(p, bin_tab[val & 0xff], 8);
+            val >>= 8;
+        } while (val);
+        return end - n;
+
+    case 8:
+        n = (num_bits(val) + 2) / 3;
+        do
+        {
+            p -= 2;
+            memcpy(p, oct_tab[val & 0x3f], 2);
+            val >>= 6;
+        } while (val);
+        return end - n;
+
+    case 10:
+        while (val >= 100)
+        {
+            p -= 2;
+            memcpy(p, dec_tab[val % 100], 2);
+            val /= 100;
+        }
+        if (val >= 10)
+        {
+            p -= 2;
+            memcpy(p, dec_tab[val], 2);
+        }
+        else
+        {
+            *--p = (char)('0' + val);
+        }
+        return p;
+
+    default:
+        {
+            uint32_t v32;
+
+            /* one 64 bit division per chunk of digits, then 32 bit */
+            while (val > UINT32_MAX)
+            {
+                uint32_t r = (uint32_t)(val % chunk_pow[base]);
+                val /= chunk_pow[base];
+                for (int i = 0; i < chunk_digits[base]; i++)
+                {
+                    *--p = digit_chars[r % base];
+                    r /= base;
+                }
+            }
+            v32 = (uint32_t)val;
+            do
+            {
+                *--p = digit_chars[v32 % base];
+                v32 /= base;
+            } while (v32);
+            return p;
+        }
+    }
+}
+
+
+/* As put_digits64 but exactly n digits, padded with zeros */
+static char *put_chunk(char *end, uint64_t val, int base, int n)
+{
+    char *p = put_digits64(end, val, base);
+    memset(end - n, '0', p - (end - n));
+    return end - n;
+}
+
+
+/* As put_digits64, for values of more than 64 bits taking off the low
+ * digits in chunks of what fits in 64 bits (or for the bases without a
+ * table, the 32 bit chunks), each a single 128 bit division at most, until
+ * the rest is 64 bits */
+static char *put_digits(char *end, unsigned __int128 val, int base)
+{
+    const uint64_t e19 = 10000000000000000000ULL;
+
+    while (val > UINT64_MAX)
+    {
+        switch (base)
+        {
+        case 16:
+            end = put_chunk(end, (uint64_t)val, 16, 16);
+            val >>= 64;
+            break;
+        case 2:
+            end = put_chunk(end, (uint64_t)val, 2, 64);
+            val >>= 64;
+            break;
+        case 8:
+            /* 21 digits is 63 bits */
+            end = put_chunk(end, (uint64_t)val & (UINT64_MAX >> 1), 8, 21);
+            val >>= 63;
+            break;
+        case 10:
+            end = put_chunk(end, (uint64_t)(val % e19), 10, 19);
+            val /= e19;
+            break;
+        default:
+            end = put_chunk(end, (uint64_t)(val % chunk_pow[base]), base,
+                            chunk_digits[base]);
+            val /= chunk_pow[base];
+            break;
+        }
+    }
+    return put_digits64(end, (uint64_t)val, base);
+}
+
+
+int radix_print(char *buf, unsigned __int128 val, int base, int min_digits,
+                int group, const char *sep)
+{
+    /* 128 digits, plus room for put_digits to write whole table entries */
+    char digits[128 + 8];
+    char *end = digits + sizeof(digits);
+    char *start;
+    char *p = buf;
+    int n, first;
+    size_t sep_len;
+
+    if (!tables_ready)
+    {
+        init_tables();
+    }
+    if (base < 2 || base > 36)
+    {
+        /* shouldn't happen */
+        *buf = 0;
+        return 0;
+    }
+
+    start = put_digits(end, val, base);
+    n = (int)(end - start);
+    if (min_digits > 128)
+    {
+        min_digits = 128;
+    }
+    if (n < min_digits)
+    {
+        start -= min_digits - n;
+        memset(start, '0', min_digits - n);
+        n = min_digits;
+    }
+
+    sep_len = sep ? strlen(sep) : 0;
+    if (group <= 0 || n <= group || sep_len == 0 || sep_len > 2)
+    {
+        memcpy(buf, start, n);
+        buf[n] = 0;
+        return n;
+    }
+
+    /* a short group first if the digits don't divide evenly */
+    first = n % group;
+    if (first == 0)
+    {
+        first = group;
+    }
+    memcpy(p, start, first);
+    p += first;
+    for (int i = first; i < n; i += group)
+    {
+        memcpy(p, sep, sep_len);
+        p += sep_len;
+        memcpy(p, start + i, group);
+        p += group;
+    }
+    *p = 0;
+    return (int)(p - buf);
+}
+
+
+void radix_print_byte_bin(char *dst, uint8_t b)
+{
+    if (!tables_ready)
+    {
+        init_tables();
+    }
+    memcpy(dst, bin_tab[b], 8);
+}
+
+
+int radix_print_multi(char *buf, unsigned __int128 val, int bits,
+                      bool is_signed)
+{
+    unsigned __int128 mask = ~(unsigned __int128)0;
+    char *p = buf;
+
+    if (bits < 128)
+    {
+        mask = ((unsigned __int128)1 << bits) - 1;
+    }
+    val &= mask;
+
+    memcpy(p, "dec ", 4);
+    p += 4;
+    if (is_signed && (val >> (bits - 1)) & 1)
+    {
+        /* twos complement within the width */
+        *p++ = '-';
+        p += radix_print(p, (~val + 1) & mask, 10, 1, 3, ",");
+    }
+    else
+    {
+        p += radix_print(p, val, 10, 1, 3, ",");
+    }
+
+    memcpy(p, "\nhex ", 5);
+    p += 5;
+    p += radix_print(p, val, 16, (bits + 3) / 4, 4, " ");
+
+    memcpy(p, "\noct ", 5);
+    p += 5;
+    p += radix_print(p, val, 8, 1, 0, NULL);
+
+    memcpy(p, "\nbin ", 5);
+    p += 5;
+    p += radix_print(p, val, 2, bits, 4, " ");
+
+    return (int)(p - buf);
+}
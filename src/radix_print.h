@@ -0,0 +1,56 @@
+/*****************************************************************************
+ * File radix_print.h part of ProgAndSciCalc
+ *
+ * Copyright (C) 2018 Ken Bromham
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef RADIX_PRINT_H
+#define RADIX_PRINT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Printing integers of up to 128 bits in bases 2 to 36 (digits 0-9 then
+ * A-Z). Bases 2, 8 and 16 go through lookup tables a byte (or 6 bits for
+ * octal) at a time, base 10 two digits at a time, and any other base by
+ * dividing the value into 32 bit chunks so most divisions are 32 bit.
+ * Above 64 bits the low digits are taken off in 64 bit sized chunks first,
+ * so values that fit in 64 bits never do a 128 bit division. */
+
+/* enough for 128 binary digits with a 2 char separator between each */
+#define RADIX_PRINT_MAX 384
+
+/* Write val in base to buf, at least min_digits digits (padded with
+ * zeros, up to 128), with the string sep (at most 2 chars) between each
+ * group of group digits counting from the right, group 0 for none.
+ * Returns the length. */
+int radix_print(char *buf, unsigned __int128 val, int base, int min_digits,
+                int group, const char *sep);
+
+/* The 8 binary digits of b to dst, not terminated */
+void radix_print_byte_bin(char *dst, uint8_t b);
+
+/* enough for the four lines of radix_print_multi */
+#define RADIX_MULTI_MAX 320
+
+/* The value in dec, hex, oct and bin on four lines, for a value of width
+ * bits (1 to 128). If is_signed, dec shows the value as signed. Hex and bin
+ * are grouped in fours, dec in threes. Returns the length. */
+int radix_print_multi(char *buf, unsigned __int128 val, int bits,
+                      bool is_signed);
+
+#endif
@@ -0,0 +1,537 @@
+/*****************************************************************************
+ * File rational.c part of ProgAndSciCalc
+ *
+ * Copyright (C) 2018 Ken Bromham
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+
+#include "rational.h"
+#include "ntheory.h"
+#include "bignum.h"
+
+/* num / den is worked out to at least this many digits, with one sticky
+ * digit for the rest, so from_string can round it correctly */
+#define KEEP_DIGITS 40
+/* den < 10^39, so num * 10^80 / den has at least 42 digits */
+#define SCALE_DIGITS 80
+
+
+static calc_int_t magnitude(calc_sint_t n)
+{
+    return n < 0 ? -(calc_int_t)n : (calc_int_t)n;
+}
+
+/* n and d already in lowest terms */
+static bool rat_set(rat_t *r, bool neg, calc_int_t n, calc_int_t d)
+{
+    if (n > (calc_int_t)CALC_SINT_MAX)
+        return false;
+
+    r->num = neg ? -(calc_sint_t)n : (calc_sint_t)n;
+    r->den = n == 0 ? 1 : d;
+    return true;
+}
+
+bool rat_from_dfp(rat_t *r, const stackf_t *x)
+{
+    uint8_t bcd[DECQUAD_Pmax];
+    bool neg;
+    int q;
+    calc_int_t c = 0;
+
+    if (dfp_is_nan(x) || dfp_is_infinite(x))
+        return false;
+
+    neg = dfp_get_coefficient(x, bcd) != 0;
+    q = dfp_get_exponent(x);
+    for (int i = 0; i < DECQUAD_Pmax; i++)
+    {
+        c = c * 10 + bcd[i];
+    }
+    if (c == 0)
+        return rat_set(r, false, 0, 1);
+
+    if (q >= 0)
+    {
+        for (int i = 0; i < q; i++)
+        {
+            if (__builtin_mul_overflow(c, 10, &c))
+                return false;
+        }
+        return rat_set(r, neg, c, 1);
+    }
+
+    /* c / (2^k * 5^k), the 2s and 5s of c cancelled first, so eg.
+     * 5e-39 is 1 / 2e38 */
+    int twos = -q;
+    int fives = -q;
+    int tz = (uint64_t)c != 0 ? __builtin_ctzll((uint64_t)c)
+                              : 64 + __builtin_ctzll((uint64_t)(c >> 64));
+    if (tz > twos)
+        tz = twos;
+    c >>= tz;
+    twos -= tz;
+    while (fives > 0 && c % 5 == 0)
+    {
+        c /= 5;
+        fives--;
+    }
+    if (twos >= 128)
+        return false;
+
+    calc_int_t d = (calc_int_t)1 << twos;
+    while (fives-- > 0)
+    {
+        if (__builtin_mul_overflow(d, 5, &d))
+            return false;
+    }
+    return rat_set(r, neg, c, d);
+}
+
+/* The string is exact, and from_string rounds it correctly. A copy of the
+ * context so the flags it sets don't get seen by the calculator. */
+static void dfp_from_exact_string(stackf_t *r, const char *s)
+{
+    decContext set = dfp_context;
+
+    set.round = DEC_ROUND_HALF_EVEN;
+    dfp_from_string(r, s, &set);
+}
+
+void rat_to_dfp(const rat_t *a, stackf_t *r)
+{
+    bn_arena_t ar;
+    bn_t n, d, t, rem;
+    char text[KEEP_DIGITS + 20];
+
+    if (a->num == 0)
+    {
+        dfp_zero(r);
+        return;
+    }
+
+    bn_arena_init(&ar);
+    bn_from_u128(&ar, &n, magnitude(a->num));
+    bn_from_u128(&ar, &d, a->den);
+    bn_from_u128(&ar, &t, 10);
+    bn_pow(&ar, &t, &t, SCALE_DIGITS);
+    bn_mul(&ar, &n, &n, &t);
+    bn_divmod(&ar, &t, &rem, &n, &d);
+
+    /* the digits past the rounding digit only matter for whether any are
+     * nonzero, so they become one sticky digit */
+    char *digits = bn_to_string(&ar, &t, 10);
+    size_t len = strlen(digits);
+    bool sticky = !bn_is_zero(&rem) ||
+                  strspn(digits + KEEP_DIGITS - 1, "0") != len - KEEP_DIGITS + 1;
+    int e10 = (int)(len - KEEP_DIGITS) - SCALE_DIGITS;
+    int keep = KEEP_DIGITS;
+    digits[keep - 1] = sticky ? '1' : '0';
+    /* an exact value without the trailing zeros, eg. 0.125 for 1/8 */
+    while (!sticky && e10 < 0 && digits[keep - 1] == '0')
+    {
+        keep--;
+        e10++;
+    }
+    digits[keep] = '\0';
+    sprintf(text, "%s%sE%d", a->num < 0 ? "-" : "", digits, e10);
+    dfp_from_exact_string(r, text);
+    bn_arena_free(&ar);
+}
+
+/* a + b, or a - b if negate_b. With g = gcd(a.den, b.den) the sum is
+ * t / (a.den * b.den / g), and any factor t has in common with that must
+ * divide g, so the gcd for the result is only with g. */
+static bool add_sub(rat_t *r, const rat_t *a, const rat_t *b, bool negate_b)
+{
+    bool a_neg = a->num < 0;
+    bool b_neg = (b->num < 0) != negate_b;
+    calc_int_t g = nt_gcd(a->den, b->den);
+    calc_int_t g2 = 1;
+    calc_int_t x, y, t, d;
+    bool neg;
+
+    if (__builtin_mul_overflow(magnitude(a->num), b->den / g, &x) ||
+        __builtin_mul_overflow(magnitude(b->num), a->den / g, &y))
+    {
+        return false;
+    }
+    if (a_neg == b_neg)
+    {
+        if (__builtin_add_overflow(x, y, &t))
+            return false;
+        neg = a_neg;
+    }
+    else if (x >= y)
+    {
+        t = x - y;
+        neg = a_neg;
+    }
+    else
+    {
+        t = y - x;
+        neg = b_neg;
+    }
+
+    if (g != 1)
+    {
+        g2 = nt_gcd(t, g);
+        t /= g2;
+    }
+    if (__builtin_mul_overflow(a->den / g, b->den / g2, &d))
+        return false;
+    return rat_set(r, neg, t, d);
+}
+
+bool rat_add(rat_t *r, const rat_t *a, const rat_t *b)
+{
+    return add_sub(r, a, b, false);
+}
+
+bool rat_sub(rat_t *r, const rat_t *a, const rat_t *b)
+{
+    return add_sub(r, a, b, true);
+}
+
+/* the gcds are across, a.num with b.den and b.num with a.den, as each
+ * fraction is already in lowest terms */
+bool rat_mul(rat_t *r, const rat_t *a, const rat_t *b)
+{
+    calc_int_t an = magnitude(a->num);
+    calc_int_t bn = magnitude(b->num);
+    calc_int_t g1 = nt_gcd(an, b->den);
+    calc_int_t g2 = nt_gcd(bn, a->den);
+    calc_int_t n, d;
+
+    if (__builtin_mul_overflow(an / g1, bn / g2, &n) ||
+        __builtin_mul_overflow(a->den / g2, b->den / g1, &d))
+    {
+        return false;
+    }
+    return rat_set(r, (a->num < 0) != (b->num < 0), n, d);
+}
+
+bool rat_div(rat_t *r, const rat_t *a, const rat_t *b)
+{
+    rat_t inv;
+
+    return rat_inv(&inv, b) && rat_mul(r, a, &inv);
+}
+
+bool rat_neg(rat_t *r, const rat_t *a)
+{
+    /* |num| < 2^127 so this can't overflow */
+    r->num = -a->num;
+    r->den = a->den;
+    return true;
+}
+
+bool rat_inv(rat_t *r, const rat_t *a)
+{
+    if (a->num == 0)
+        return false;
+
+    return rat_set(r, a->num < 0, a->den, magnitude(a->num));
+}
+
+static char *print_u128(char *p, calc_int_t v)
+{
+    char tmp[40];
+    int n = 0;
+
+    do
+    {
+        tmp[n++] = (char)('0' + (int)(v % 10));
+        v /= 10;
+    } while (v != 0);
+    while (n > 0)
+    {
+        *p++ = tmp[--n];
+    }
+    *p = '\0';
+    return p;
+}
+
+void rat_to_string(char *buf, const rat_t *a, bool mixed)
+{
+    calc_int_t n = magnitude(a->num);
+    char *p = buf;
+
+    if (a->num < 0)
+    {
+        *p++ = '-';
+    }
+    if (a->den == 1)
+    {
+        print_u128(p, n);
+        return;
+    }
+    if (mixed && n > a->den)
+    {
+        p = print_u128(p, n / a->den);
+        *p++ = ' ';
+        n %= a->den;
+    }
+    p = print_u128(p, n);
+    *p++ = '/';
+    print_u128(p, a->den);
+}
+
+
+/* continued fractions */
+
+/* Steps through the convergents h / k of n / d, the remaining complete
+ * quotient being n / d as it goes */
+typedef struct
+{
+    calc_int_t n;
+    calc_int_t d;
+    calc_int_t h;
+    calc_int_t k;
+    calc_int_t h_prev;
+    calc_int_t k_prev;
+} convergents_t;
+
+static void conv_init(convergents_t *c, calc_int_t n, calc_int_t d)
+{
+    c->n = n;
+    c->d = d;
+    c->h = 1;
+    c->k = 0;
+    c->h_prev = 0;
+    c->k_prev = 1;
+}
+
+static bool conv_more(const convergents_t *c)
+{
+    return c->d != 0;
+}
+
+/* false at the end, or if the next convergent has a denominator beyond
+ * max_den or doesn't fit */
+static bool conv_next(convergents_t *c, calc_int_t max_den)
+{
+    calc_int_t a, h, k;
+
+    if (c->d == 0)
+        return false;
+
+    a = c->n / c->d;
+    if (__builtin_mul_overflow(a, c->h, &h) ||
+        __builtin_add_overflow(h, c->h_prev, &h) ||
+        __builtin_mul_overflow(a, c->k, &k) ||
+        __builtin_add_overflow(k, c->k_prev, &k) ||
+        k > max_den)
+    {
+        return false;
+    }
+
+    calc_int_t rem = c->n % c->d;
+    c->n = c->d;
+    c->d = rem;
+    c->h_prev = c->h;
+    c->k_prev = c->k;
+    c->h = h;
+    c->k = k;
+    return true;
+}
+
+/* |n / d - h / k| * d * k, which is |n * k - h * d| */
+static void distance(bn_arena_t *ar, bn_t *r, calc_int_t n, calc_int_t d,
+                     calc_int_t h, calc_int_t k)
+{
+    bn_t a, b, t;
+
+    bn_from_u128(ar, &a, n);
+    bn_from_u128(ar, &t, k);
+    bn_mul(ar, &a, &a, &t);
+    bn_from_u128(ar, &b, h);
+    bn_from_u128(ar, &t, d);
+    bn_mul(ar, &b, &b, &t);
+    if (bn_cmp(&a, &b) >= 0)
+        bn_sub(ar, r, &a, &b);
+    else
+        bn_sub(ar, r, &b, &a);
+}
+
+int rat_continued_fraction(const rat_t *a, calc_sint_t *a0, calc_int_t *cf,
+                           int max)
+{
+    calc_int_t m = magnitude(a->num);
+    calc_int_t q = m / a->den;
+    calc_int_t r = m % a->den;
+    calc_int_t n, d;
+    int num = 0;
+
+    /* the floor, so for -7/3 it's -3 and then [-3; 1, 2] */
+    if (a->num >= 0)
+    {
+        *a0 = (calc_sint_t)q;
+    }
+    else if (r == 0)
+    {
+        *a0 = -(calc_sint_t)q;
+    }
+    else
+    {
+        *a0 = -(calc_sint_t)q - 1;
+        r = a->den - r;
+    }
+
+    /* then the Euclidean algorithm on den / r */
+    n = a->den;
+    d = r;
+    while (d != 0)
+    {
+        if (num < max)
+        {
+            cf[num] = n / d;
+        }
+        num++;
+        calc_int_t t = n % d;
+        n = d;
+        d = t;
+    }
+    return num;
+}
+
+int rat_convergents(const rat_t *a, calc_int_t max_den, rat_t *conv, int max)
+{
+    convergents_t c;
+    int num = 0;
+
+    conv_init(&c, magnitude(a->num), a->den);
+    while (num < max && conv_next(&c, max_den))
+    {
+        (void)rat_set(&conv[num], a->num < 0, c.h, c.k);
+        num++;
+    }
+    return num;
+}
+
+void rat_best_approx(rat_t *r, const rat_t *a, calc_int_t max_den)
+{
+    calc_int_t n = magnitude(a->num);
+    convergents_t c;
+    calc_int_t t, hs, ks;
+
+    conv_init(&c, n, a->den);
+    while (conv_next(&c, max_den))
+    {
+    }
+
+    /* The semiconvergents between the last two convergents are
+     * (t * h + h_prev) / (t * k + k_prev), for the largest t the
+     * denominator allows it may be closer than h / k. */
+    (void)rat_set(r, a->num < 0, c.h, c.k);
+    if (!conv_more(&c))
+        return;
+
+    t = (max_den - c.k_prev) / c.k;
+    if (t == 0 || __builtin_mul_overflow(t, c.h, &hs) ||
+        __builtin_add_overflow(hs, c.h_prev, &hs))
+    {
+        return;
+    }
+    ks = t * c.k + c.k_prev;
+
+    bn_arena_t ar;
+    bn_t dc, ds, x;
+
+    bn_arena_init(&ar);
+    distance(&ar, &dc, n, a->den, c.h, c.k);
+    distance(&ar, &ds, n, a->den, hs, ks);
+    bn_from_u128(&ar, &x, ks);
+    bn_mul(&ar, &dc, &dc, &x);
+    bn_from_u128(&ar, &x, c.k);
+    bn_mul(&ar, &ds, &ds, &x);
+    if (bn_cmp(&ds, &dc) < 0)
+    {
+        (void)rat_set(r, a->num < 0, hs, ks);
+    }
+    bn_arena_free(&ar);
+}
+
+bool rat_simplest_within(rat_t *r, const rat_t *a, calc_int_t max_den,
+                         int digits)
+{
+    calc_int_t n = magnitude(a->num);
+    convergents_t c;
+    bn_arena_t ar;
+    bn_t scale, dist, x, t;
+    bool found = false;
+
+    if (n == 0)
+        return rat_set(r, false, 0, 1);
+
+    bn_arena_init(&ar);
+    bn_from_u128(&ar, &scale, 10);
+    bn_pow(&ar, &scale, &scale, digits);
+    conv_init(&c, n, a->den);
+    while (!found && conv_next(&c, max_den))
+    {
+        /* |x - h / k| <= x * 10^-digits, as
+         * |n * k - h * d| * 10^digits <= n * k */
+        distance(&ar, &dist, n, a->den, c.h, c.k);
+        bn_mul(&ar, &dist, &dist, &scale);
+        bn_from_u128(&ar, &x, n);
+        bn_from_u128(&ar, &t, c.k);
+        bn_mul(&ar, &x, &x, &t);
+        found = bn_cmp(&dist, &x) <= 0;
+    }
+    bn_arena_free(&ar);
+    return found && rat_set(r, a->num < 0, c.h, c.k);
+}
+
+/* to 34 digits */
+static const char *times_value[rat_num_times] =
+{
+    "1",
+    "3.141592653589793238462643383279503",
+    "1.414213562373095048801688724209698",
+};
+
+bool rat_recognise(const stackf_t *x, calc_int_t max_den, rat_t *r,
+                   rat_times_enum *times)
+{
+    decContext set = dfp_context;
+    bool found = false;
+
+    set.round = DEC_ROUND_HALF_EVEN;
+    if (max_den > RAT_RECOGNISE_MAX_DEN)
+        max_den = RAT_RECOGNISE_MAX_DEN;
+
+    for (int i = 0; i < rat_num_times; i++)
+    {
+        stackf_t c, y;
+        rat_t exact, f;
+
+        dfp_from_string(&c, times_value[i], &set);
+        dfp_divide(&y, x, &c, &set);
+        if (rat_from_dfp(&exact, &y) &&
+            rat_simplest_within(&f, &exact, max_den, RAT_RECOGNISE_DIGITS) &&
+            (!found || f.den < r->den))
+        {
+            *r = f;
+            *times = (rat_times_enum)i;
+            found = true;
+        }
+    }
+    return found;
+}
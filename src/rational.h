@@ -0,0 +1,104 @@
+/*****************************************************************************
+ * File rational.h part of ProgAndSciCalc
+ *
+ * Copyright (C) 2018 Ken Bromham
+ *
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef RATIONAL_H
+#define RATIONAL_H
+
+#include <stdbool.h>
+#include "calc_types.h"
+
+/* Exact fractions for rational mode, num / den in lowest terms with
+ * den > 0 and the sign on num. Both are 128 bit, |num| up to 2^127 - 1 and
+ * den up to 2^128 - 1. The ops return false when a result doesn't fit
+ * (or for division by zero), for the caller to carry on with the decimal
+ * float instead.
+ *
+ * Results are kept in lowest terms without a full gcd each time, by
+ * cancelling across the operands first (as in Knuth, Seminumerical
+ * Algorithms 4.5.1), so only the small gcds that are needed are done. */
+
+typedef struct
+{
+    calc_sint_t num;
+    calc_int_t den;
+} rat_t;
+
+/* a 128 bit numerator and denominator, with the sign, a space and / */
+#define RAT_STRING_MAX (2 * 40 + 4)
+
+/* false for inf and nan, and for values beyond 128 bits eg. 1e40 or
+ * 1e-40, otherwise the decimal exactly */
+bool rat_from_dfp(rat_t *r, const stackf_t *x);
+
+/* correctly rounded, to nearest with ties to even */
+void rat_to_dfp(const rat_t *a, stackf_t *r);
+
+bool rat_add(rat_t *r, const rat_t *a, const rat_t *b);
+bool rat_sub(rat_t *r, const rat_t *a, const rat_t *b);
+bool rat_mul(rat_t *r, const rat_t *a, const rat_t *b);
+bool rat_div(rat_t *r, const rat_t *a, const rat_t *b);
+bool rat_neg(rat_t *r, const rat_t *a);
+bool rat_inv(rat_t *r, const rat_t *a);
+
+/* eg. -7/3, or mixed as -2 1/3, an integer without the /1 */
+void rat_to_string(char *buf, const rat_t *a, bool mixed);
+
+/* The continued fraction of a, a0 the floor then [a0; cf0, cf1 ...] up to
+ * max of the rest. Returns how many there are after a0 in all, which can
+ * be more than max. */
+int rat_continued_fraction(const rat_t *a, calc_sint_t *a0, calc_int_t *cf,
+                           int max);
+
+/* The convergents of a with a denominator up to max_den, up to max of
+ * them. Returns the number. */
+int rat_convergents(const rat_t *a, calc_int_t max_den, rat_t *conv, int max);
+
+/* the closest fraction to a with a denominator up to max_den, which is
+ * the last convergent or the best semiconvergent after it */
+void rat_best_approx(rat_t *r, const rat_t *a, calc_int_t max_den);
+
+/* The fraction with the smallest denominator (up to max_den) that is
+ * within a relative 10^-digits of a, from its convergents. false if there
+ * isn't one. */
+bool rat_simplest_within(rat_t *r, const rat_t *a, calc_int_t max_den,
+                         int digits);
+
+/* Recognising a decimal as a simple fraction, or a fraction times pi or
+ * sqrt(2), eg. 0.7853981633974483096156608458198757 is 1/4 pi. It has to
+ * match to RAT_RECOGNISE_DIGITS, which is what's left of decQuad's 34
+ * after a few roundings, and the denominator is limited to
+ * RAT_RECOGNISE_MAX_DEN so that chance matches are very unlikely. The
+ * fraction with the smallest denominator is taken, then 1 before pi
+ * before sqrt(2). */
+#define RAT_RECOGNISE_DIGITS 30
+#define RAT_RECOGNISE_MAX_DEN ((calc_int_t)1000000000000)
+
+typedef enum
+{
+    rat_times_one,
+    rat_times_pi,
+    rat_times_sqrt2,
+    rat_num_times
+} rat_times_enum;
+
+bool rat_recognise(const stackf_t *x, calc_int_t max_den, rat_t *r,
+                   rat_times_enum *times);
+
+#endif
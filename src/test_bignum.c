@@ -0,0 +1,493 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "bignum.h"
+
+/* Test of bignum.c. The fast algorithms are checked against the simple
+ * ones by changing the thresholds, and the results against each other
+ * (q * b + r == a etc) and against 128 bit arithmetic for small values. */
+
+
+#define NUM_RANDOM  300
+
+/* thresholds low enough that small numbers use the fast algorithms */
+#define LOW_KARATSUBA 4
+#define LOW_NTT 6
+#define LOW_BZ 4
+#define LOW_RADIX_DC 2
+/* high enough that they're never used */
+#define NEVER 1000000000
+
+typedef unsigned __int128 u128;
+typedef __int128 s128;
+
+static uint64_t rng_state = 0x9e3779b97f4a7c15ULL;
+
+static uint64_t rng(void)
+{
+    /* xorshift64* */
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 0x2545f4914f6cdd1dULL;
+}
+
+static void use_simple(void)
+{
+    bn_set_thresholds(NEVER, NEVER, NEVER, NEVER);
+}
+
+static void use_fast(void)
+{
+    bn_set_thresholds(LOW_KARATSUBA, LOW_NTT, LOW_BZ, LOW_RADIX_DC);
+}
+
+/* random value of up to max_limbs limbs, with runs of all ones and all
+ * zeros as they find the carry bugs */
+static void random_bn(bn_arena_t *ar, bn_t *r, int max_limbs, bool allow_neg)
+{
+    int n = 1 + (int)(rng() % max_limbs);
+    bn_limb_t *d = bn_arena_alloc(ar, n * sizeof(bn_limb_t));
+    char *s;
+
+    for (int i = 0; i < n; i++)
+    {
+        switch (rng() % 4)
+        {
+        case 0:
+            d[i] = 0;
+            break;
+        case 1:
+            d[i] = ~(bn_limb_t)0;
+            break;
+        default:
+            d[i] = rng();
+            break;
+        }
+    }
+    if (d[n - 1] == 0)
+    {
+        d[n - 1] = 1;
+    }
+    /* go through hex to make it a proper value */
+    s = bn_arena_alloc(ar, n * 16 + 1);
+    for (int i = 0; i < n; i++)
+    {
+        sprintf(s + i * 16, "%016llX", (unsigned long long)d[n - 1 - i]);
+    }
+    bn_from_string(ar, r, s, strlen(s), 16);
+    if (allow_neg && (rng() & 1))
+    {
+        bn_neg(ar, r, r);
+    }
+}
+
+static bool equal(const bn_t *a, const bn_t *b)
+{
+    return bn_cmp(a, b) == 0;
+}
+
+static void print_fail(bn_arena_t *ar, const char *what, const bn_t *a,
+                       const bn_t *b)
+{
+    printf("FAIL %s\n a %s\n b %s\n", what,
+           bn_to_string(ar, a, 16), bn_to_string(ar, b, 16));
+}
+
+static bool test_fixed(void)
+{
+    bn_arena_t ar;
+    bn_t a, b;
+    bool ok = true;
+
+    bn_arena_init(&ar);
+
+    bn_from_u128(&ar, &a, 2);
+    bn_pow(&ar, &a, &a, 200);
+    ok = ok && strcmp(bn_to_string(&ar, &a, 10),
+        "1606938044258990275541962092341162602522202993782792835301376") == 0;
+    ok = ok && strcmp(bn_to_string(&ar, &a, 16),
+        "100000000000000000000000000000000000000000000000000") == 0;
+    ok = ok && bn_bit_length(&a) == 201;
+
+    bn_factorial(&ar, &a, 100);
+    ok = ok && strcmp(bn_to_string(&ar, &a, 10),
+        "9332621544394415268169923885626670049071596826438162146859296389"
+        "5217599993229915608941463976156518286253697920827223758251185210"
+        "916864000000000000000000000000") == 0;
+
+    bn_from_s128(&ar, &a, -255);
+    ok = ok && strcmp(bn_to_string(&ar, &a, 10), "-255") == 0;
+    ok = ok && strcmp(bn_to_string(&ar, &a, 16), "-FF") == 0;
+    ok = ok && strcmp(bn_to_string(&ar, &a, 8), "-377") == 0;
+    ok = ok && strcmp(bn_to_string(&ar, &a, 2), "-11111111") == 0;
+
+    bn_zero(&a);
+    ok = ok && strcmp(bn_to_string(&ar, &a, 10), "0") == 0;
+    ok = ok && strcmp(bn_to_string(&ar, &a, 2), "0") == 0;
+
+    /* 2^127 - 1 is prime so 3^(p-1) mod p is 1 */
+    bn_from_u128(&ar, &a, ((u128)1 << 127) - 1);
+    bn_from_u128(&ar, &b, ((u128)1 << 127) - 2);
+    bn_powmod(&ar, &b, &(bn_t){ .d = (bn_limb_t[]){ 3 }, .n = 1 }, &b, &a);
+    ok = ok && bn_to_u128(&b) == 1;
+
+    ok = ok && !bn_from_string(&ar, &a, "12a", 3, 10);
+    ok = ok && !bn_from_string(&ar, &a, "102", 3, 2);
+    ok = ok && !bn_from_string(&ar, &a, "", 0, 10);
+
+    /* too big */
+    bn_from_u128(&ar, &a, 10);
+    ok = ok && !bn_pow(&ar, &b, &a, 100000000);
+    ok = ok && !bn_factorial(&ar, &b, 10000000);
+    bn_from_u128(&ar, &a, 1);
+    ok = ok && !bn_shl(&ar, &b, &a, BN_MAX_BITS + 1);
+
+    bn_arena_free(&ar);
+    printf(ok ? "fixed OK\n" : "FAIL fixed\n");
+    return ok;
+}
+
+/* against 128 bit arithmetic, values within 62 bits so nothing overflows */
+static bool test_small(void)
+{
+    bn_arena_t ar;
+    bn_arena_init(&ar);
+
+    for (int i = 0; i < 100000; i++)
+    {
+        bn_arena_mark_t mark = bn_arena_mark(&ar);
+        s128 x = (int64_t)rng() >> (rng() % 64);
+        s128 y = (int64_t)rng() >> (rng() % 64);
+        unsigned sh = (unsigned)(rng() % 64);
+        bn_t a, b, r;
+        bool ok = true;
+
+        bn_from_s128(&ar, &a, x);
+        bn_from_s128(&ar, &b, y);
+
+        bn_add(&ar, &r, &a, &b);
+        ok = ok && (s128)bn_to_u128(&r) == x + y;
+        bn_sub(&ar, &r, &a, &b);
+        ok = ok && (s128)bn_to_u128(&r) == x - y;
+        bn_mul(&ar, &r, &a, &b);
+        ok = ok && (s128)bn_to_u128(&r) == x * y;
+        if (y != 0)
+        {
+            bn_t q;
+            bn_divmod(&ar, &q, &r, &a, &b);
+            ok = ok && (s128)bn_to_u128(&q) == x / y
+                 && (s128)bn_to_u128(&r) == x % y;
+        }
+        bn_and(&ar, &r, &a, &b);
+        ok = ok && (s128)bn_to_u128(&r) == (x & y);
+        bn_or(&ar, &r, &a, &b);
+        ok = ok && (s128)bn_to_u128(&r) == (x | y);
+        bn_xor(&ar, &r, &a, &b);
+        ok = ok && (s128)bn_to_u128(&r) == (x ^ y);
+        bn_not(&ar, &r, &a);
+        ok = ok && (s128)bn_to_u128(&r) == ~x;
+        bn_shl(&ar, &r, &a, sh);
+        ok = ok && (s128)bn_to_u128(&r) == x * ((s128)1 << sh);
+        bn_shr(&ar, &r, &a, sh);
+        ok = ok && (s128)bn_to_u128(&r) == x >> sh;
+        ok = ok && bn_cmp(&a, &b) == (x < y ? -1 : x > y);
+
+        if (!ok)
+        {
+            print_fail(&ar, "small", &a, &b);
+            bn_arena_free(&ar);
+            return false;
+        }
+        bn_arena_release(&ar, mark);
+    }
+    bn_arena_free(&ar);
+    printf("small OK\n");
+    return true;
+}
+
+/* the fast multiplications against the schoolbook */
+static bool test_mul(void)
+{
+    bn_arena_t ar;
+    bn_arena_init(&ar);
+
+    for (int i = 0; i < NUM_RANDOM; i++)
+    {
+        bn_arena_mark_t mark = bn_arena_mark(&ar);
+        bn_t a, b, r_simple, r_kara, r_ntt, r_default;
+
+        random_bn(&ar, &a, 200, true);
+        random_bn(&ar, &b, i & 1 ? 200 : 20, true);
+
+        use_simple();
+        bn_mul(&ar, &r_simple, &a, &b);
+        bn_set_thresholds(LOW_KARATSUBA, NEVER, 0, 0);
+        bn_mul(&ar, &r_kara, &a, &b);
+        bn_set_thresholds(NEVER, LOW_NTT, 0, 0);
+        bn_mul(&ar, &r_ntt, &a, &b);
+        bn_set_thresholds(0, 0, 0, 0);
+        bn_mul(&ar, &r_default, &a, &b);
+
+        if (!equal(&r_simple, &r_kara) || !equal(&r_simple, &r_ntt)
+            || !equal(&r_simple, &r_default))
+        {
+            print_fail(&ar, "mul", &a, &b);
+            bn_arena_free(&ar);
+            return false;
+        }
+        bn_arena_release(&ar, mark);
+    }
+    bn_arena_free(&ar);
+    printf("mul OK\n");
+    return true;
+}
+
+/* q * b + r == a, |r| < |b|, r has the sign of a, and the same from the
+ * schoolbook and recursive division */
+static bool test_div(void)
+{
+    bn_arena_t ar;
+    bn_arena_init(&ar);
+
+    for (int i = 0; i < NUM_RANDOM * 3; i++)
+    {
+        bn_arena_mark_t mark = bn_arena_mark(&ar);
+        bn_t a, b, q, r, q2, r2, t, abs_r, abs_b;
+        bool ok;
+
+        random_bn(&ar, &a, 300, true);
+        random_bn(&ar, &b, 1 + (int)(rng() % 150), true);
+
+        use_fast();
+        bn_divmod(&ar, &q, &r, &a, &b);
+        use_simple();
+        bn_divmod(&ar, &q2, &r2, &a, &b);
+
+        bn_mul(&ar, &t, &q, &b);
+        bn_add(&ar, &t, &t, &r);
+        bn_neg(&ar, &abs_r, &r);
+        abs_r = r.neg ? abs_r : r;
+        bn_neg(&ar, &abs_b, &b);
+        abs_b = b.neg ? abs_b : b;
+        ok = equal(&t, &a) && bn_cmp(&abs_r, &abs_b) < 0
+             && (bn_is_zero(&r) || r.neg == a.neg)
+             && equal(&q, &q2) && equal(&r, &r2);
+        if (!ok)
+        {
+            print_fail(&ar, "div", &a, &b);
+            bn_arena_free(&ar);
+            return false;
+        }
+        bn_arena_release(&ar, mark);
+    }
+    bn_set_thresholds(0, 0, 0, 0);
+    bn_arena_free(&ar);
+    printf("div OK\n");
+    return true;
+}
+
+/* to a string and back in each base, decimal both ways */
+static bool test_strings(void)
+{
+    static const int bases[] = { 2, 8, 10, 16 };
+    bn_arena_t ar;
+    bn_arena_init(&ar);
+
+    for (int i = 0; i < NUM_RANDOM; i++)
+    {
+        bn_arena_mark_t mark = bn_arena_mark(&ar);
+        bn_t a, b, mag;
+        char *s_fast, *s_simple;
+
+        random_bn(&ar, &a, 150, true);
+        for (int j = 0; j < 4; j++)
+        {
+            use_fast();
+            s_fast = bn_to_string(&ar, &a, bases[j]);
+            use_simple();
+            s_simple = bn_to_string(&ar, &a, bases[j]);
+            if (strcmp(s_fast, s_simple) != 0)
+            {
+                print_fail(&ar, "to string", &a, &a);
+                bn_arena_free(&ar);
+                return false;
+            }
+            use_fast();
+            bn_from_string(&ar, &b, s_fast + a.neg, strlen(s_fast + a.neg),
+                           bases[j]);
+            use_simple();
+            bn_from_string(&ar, &mag, s_fast + a.neg, strlen(s_fast + a.neg),
+                           bases[j]);
+            if (a.neg)
+            {
+                bn_neg(&ar, &b, &b);
+                bn_neg(&ar, &mag, &mag);
+            }
+            if (!equal(&a, &b) || !equal(&a, &mag))
+            {
+                print_fail(&ar, "from string", &a, &b);
+                bn_arena_free(&ar);
+                return false;
+            }
+        }
+        bn_arena_release(&ar, mark);
+    }
+    bn_set_thresholds(0, 0, 0, 0);
+    bn_arena_free(&ar);
+    printf("strings OK\n");
+    return true;
+}
+
+/* gcd divides both, powmod against repeated multiplication */
+static bool test_number_theory(void)
+{
+    bn_arena_t ar;
+    bn_arena_init(&ar);
+
+    for (int i = 0; i < NUM_RANDOM; i++)
+    {
+        bn_arena_mark_t mark = bn_arena_mark(&ar);
+        bn_t a, b, g, c, r1, r2, m, p;
+        unsigned long e = (unsigned long)(rng() % 50);
+
+        random_bn(&ar, &c, 10, true);
+        random_bn(&ar, &a, 20, true);
+        random_bn(&ar, &b, 20, true);
+        bn_mul(&ar, &a, &a, &c);
+        bn_mul(&ar, &b, &b, &c);
+        bn_gcd(&ar, &g, &a, &b);
+        bn_divmod(&ar, NULL, &r1, &a, &g);
+        bn_divmod(&ar, NULL, &r2, &b, &g);
+        if (g.neg || !bn_is_zero(&r1) || !bn_is_zero(&r2))
+        {
+            print_fail(&ar, "gcd", &a, &b);
+            bn_arena_free(&ar);
+            return false;
+        }
+        bn_divmod(&ar, NULL, &r1, &g, &c);
+        if (!bn_is_zero(&r1))
+        {
+            print_fail(&ar, "gcd common factor", &a, &b);
+            bn_arena_free(&ar);
+            return false;
+        }
+
+        random_bn(&ar, &m, 8, false);
+        bn_from_u128(&ar, &p, e);
+        bn_powmod(&ar, &r1, &a, &p, &m);
+        bn_pow(&ar, &r2, &a, e);
+        bn_divmod(&ar, NULL, &r2, &r2, &m);
+        if (r2.neg)
+        {
+            bn_add(&ar, &r2, &r2, &m);
+        }
+        if (!equal(&r1, &r2))
+        {
+            print_fail(&ar, "powmod", &a, &m);
+            bn_arena_free(&ar);
+            return false;
+        }
+        bn_arena_release(&ar, mark);
+    }
+    bn_arena_free(&ar);
+    printf("number theory OK\n");
+    return true;
+}
+
+/* the big ones through all the fast algorithms at the real thresholds */
+static bool test_large(void)
+{
+    bn_arena_t ar;
+    bn_t a, b, q, r, t;
+    char *s;
+    bool ok;
+
+    bn_arena_init(&ar);
+    bn_set_thresholds(0, 0, 0, 0);
+
+    bn_factorial(&ar, &a, 20000);
+    random_bn(&ar, &b, 2000, false);
+    bn_divmod(&ar, &q, &r, &a, &b);
+    bn_mul(&ar, &t, &q, &b);
+    bn_add(&ar, &t, &t, &r);
+    ok = equal(&t, &a);
+
+    s = bn_to_string(&ar, &a, 10);
+    ok = ok && strlen(s) == 77338;
+    ok = ok && bn_from_string(&ar, &t, s, strlen(s), 10) && equal(&t, &a);
+
+    bn_arena_free(&ar);
+    printf(ok ? "large OK\n" : "FAIL large\n");
+    return ok;
+}
+
+/* not a test as such, just to see the difference */
+static void time_algorithms(void)
+{
+    bn_arena_t ar;
+    bn_t a, b, r;
+    clock_t start;
+    char *s;
+
+    bn_arena_init(&ar);
+    bn_from_u128(&ar, &r, 7);
+    bn_pow(&ar, &a, &r, 350000);
+    bn_pow(&ar, &b, &r, 340000);
+    bn_add(&ar, &b, &b, &r);
+    printf("%ld x %ld bits:\n", bn_bit_length(&a), bn_bit_length(&b));
+
+    use_simple();
+    start = clock();
+    bn_mul(&ar, &r, &a, &b);
+    printf("  mul schoolbook %.3fs\n", (double)(clock() - start) / CLOCKS_PER_SEC);
+    bn_set_thresholds(0, NEVER, 0, 0);
+    start = clock();
+    bn_mul(&ar, &r, &a, &b);
+    printf("  mul karatsuba %.3fs\n", (double)(clock() - start) / CLOCKS_PER_SEC);
+    bn_set_thresholds(0, 0, 0, 0);
+    start = clock();
+    bn_mul(&ar, &r, &a, &b);
+    printf("  mul ntt %.3fs\n", (double)(clock() - start) / CLOCKS_PER_SEC);
+
+    bn_mul(&ar, &a, &a, &a);
+    use_simple();
+    start = clock();
+    bn_divmod(&ar, &r, NULL, &a, &b);
+    printf("  div schoolbook %.3fs\n", (double)(clock() - start) / CLOCKS_PER_SEC);
+    bn_set_thresholds(0, 0, 0, 0);
+    start = clock();
+    bn_divmod(&ar, &r, NULL, &a, &b);
+    printf("  div recursive %.3fs\n", (double)(clock() - start) / CLOCKS_PER_SEC);
+
+    bn_set_thresholds(0, 0, 0, NEVER);
+    start = clock();
+    s = bn_to_string(&ar, &b, 10);
+    printf("  to decimal (%zu digits) one chunk at a time %.3fs\n", strlen(s),
+           (double)(clock() - start) / CLOCKS_PER_SEC);
+    bn_set_thresholds(0, 0, 0, 0);
+    start = clock();
+    s = bn_to_string(&ar, &b, 10);
+    printf("  to decimal split %.3fs\n", (double)(clock() - start) / CLOCKS_PER_SEC);
+
+    bn_arena_free(&ar);
+}
+
+int main(void)
+{
+    bool ok = test_fixed() && test_small() && test_mul() && test_div()
+              && test_strings() && test_number_theory() && test_large();
+
+    if (ok)
+        printf("all tests OK\n");
+    else
+        printf("************* FAIL ***************\n");
+
+    time_algorithms();
+
+    return 0;
+}
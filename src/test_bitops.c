@@ -0,0 +1,296 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "bitops.h"
+
+/* For testing the bitops_ functions from bitops.c, against simple bit at
+ * a time versions, with the instructions and with the portable code. */
+
+typedef unsigned __int128 u128;
+
+static int fails;
+
+static u128 width_mask(int bits)
+{
+    return bits == 128 ? ~(u128)0 : ((u128)1 << bits) - 1;
+}
+
+static int naive_popcount(u128 x)
+{
+    int n = 0;
+    for (; x != 0; x >>= 1)
+    {
+        n += (int)(x & 1);
+    }
+    return n;
+}
+
+static int naive_clz(u128 x, int bits)
+{
+    int n = 0;
+    for (int i = bits - 1; i >= 0 && ((x >> i) & 1) == 0; i--)
+    {
+        n++;
+    }
+    return n;
+}
+
+static int naive_ctz(u128 x, int bits)
+{
+    int n = 0;
+    for (int i = 0; i < bits && ((x >> i) & 1) == 0; i++)
+    {
+        n++;
+    }
+    return n;
+}
+
+static u128 naive_reverse(u128 x, int bits)
+{
+    u128 r = 0;
+    for (int i = 0; i < bits; i++)
+    {
+        r = (r << 1) | ((x >> i) & 1);
+    }
+    return r;
+}
+
+static u128 naive_byteswap(u128 x, int bits)
+{
+    u128 r = 0;
+    for (int i = 0; i < bits; i += 8)
+    {
+        r = (r << 8) | ((x >> i) & 0xff);
+    }
+    return r;
+}
+
+static u128 naive_pdep(u128 x, u128 mask)
+{
+    u128 r = 0;
+    int j = 0;
+    for (int i = 0; i < 128; i++)
+    {
+        if ((mask >> i) & 1)
+        {
+            r |= ((x >> j++) & 1) << i;
+        }
+    }
+    return r;
+}
+
+static u128 naive_pext(u128 x, u128 mask)
+{
+    u128 r = 0;
+    int j = 0;
+    for (int i = 0; i < 128; i++)
+    {
+        if ((mask >> i) & 1)
+        {
+            r |= ((x >> i) & 1) << j++;
+        }
+    }
+    return r;
+}
+
+/* every n bits from bit 0 */
+static u128 every_mask(int n)
+{
+    u128 m = 0;
+    for (int i = 0; i < 128; i += n)
+    {
+        m |= (u128)1 << i;
+    }
+    return m;
+}
+
+static void print_hex(u128 x)
+{
+    printf("%016llx%016llx", (unsigned long long)(x >> 64),
+           (unsigned long long)x);
+}
+
+static void fail_int(const char *name, u128 x, int bits, int got, int expected)
+{
+    printf("FAIL %s ", name);
+    print_hex(x);
+    printf(" bits %d got %d expected %d\n", bits, got, expected);
+    fails++;
+}
+
+static void fail_val(const char *name, u128 x, int bits, u128 got, u128 expected)
+{
+    printf("FAIL %s ", name);
+    print_hex(x);
+    printf(" bits %d got ", bits);
+    print_hex(got);
+    printf(" expected ");
+    print_hex(expected);
+    printf("\n");
+    fails++;
+}
+
+static void test_val(u128 x, int bits)
+{
+    int got, expected;
+
+    x &= width_mask(bits);
+
+    got = bitops_popcount(x);
+    expected = naive_popcount(x);
+    if (got != expected)
+    {
+        fail_int("popcount", x, bits, got, expected);
+    }
+    got = bitops_parity(x);
+    if (got != (expected & 1))
+    {
+        fail_int("parity", x, bits, got, expected & 1);
+    }
+    got = bitops_clz(x, bits);
+    expected = naive_clz(x, bits);
+    if (got != expected)
+    {
+        fail_int("clz", x, bits, got, expected);
+    }
+    got = bitops_ctz(x, bits);
+    expected = naive_ctz(x, bits);
+    if (got != expected)
+    {
+        fail_int("ctz", x, bits, got, expected);
+    }
+    if (bitops_reverse(x, bits) != naive_reverse(x, bits))
+    {
+        fail_val("reverse", x, bits, bitops_reverse(x, bits),
+                 naive_reverse(x, bits));
+    }
+    if (bits % 8 == 0 && bitops_byteswap(x, bits) != naive_byteswap(x, bits))
+    {
+        fail_val("byteswap", x, bits, bitops_byteswap(x, bits),
+                 naive_byteswap(x, bits));
+    }
+}
+
+static void test_deposit(u128 x, u128 mask)
+{
+    u128 got, expected;
+
+    got = bitops_pdep(x, mask);
+    expected = naive_pdep(x, mask);
+    if (got != expected)
+    {
+        fail_val("pdep", x, 128, got, expected);
+    }
+    got = bitops_pext(x, mask);
+    expected = naive_pext(x, mask);
+    if (got != expected)
+    {
+        fail_val("pext", x, 128, got, expected);
+    }
+
+    got = bitops_spread2(x);
+    expected = naive_pdep(x, every_mask(2));
+    if (got != expected)
+    {
+        fail_val("spread2", x, 128, got, expected);
+    }
+    got = bitops_compact2(x);
+    expected = naive_pext(x, every_mask(2));
+    if (got != expected)
+    {
+        fail_val("compact2", x, 128, got, expected);
+    }
+    got = bitops_spread3(x);
+    expected = naive_pdep(x, every_mask(3));
+    if (got != expected)
+    {
+        fail_val("spread3", x, 128, got, expected);
+    }
+    got = bitops_compact3(x);
+    expected = naive_pext(x, every_mask(3));
+    if (got != expected)
+    {
+        fail_val("compact3", x, 128, got, expected);
+    }
+}
+
+static u128 rand_u128(void)
+{
+    u128 x = 0;
+    for (int i = 0; i < 8; i++)
+    {
+        x = (x << 16) | (u128)(rand() & 0xffff);
+    }
+    return x;
+}
+
+static void test_all(void)
+{
+    for (int bits = 1; bits <= 128; bits++)
+    {
+        u128 m = width_mask(bits);
+
+        test_val(0, bits);
+        test_val(m, bits);
+        test_val(1, bits);
+        test_val((u128)1 << (bits - 1), bits);
+        for (int i = 0; i < bits; i++)
+        {
+            test_val((u128)1 << i, bits);
+            test_val(m ^ ((u128)1 << i), bits);
+            test_val(m >> i, bits);
+            test_val(m << i, bits);
+        }
+        for (int i = 0; i < 200; i++)
+        {
+            u128 x = rand_u128();
+            test_val(x, bits);
+            /* sparse values give longer runs of zeros */
+            test_val(x & rand_u128() & rand_u128(), bits);
+        }
+    }
+
+    test_deposit(0, 0);
+    test_deposit(~(u128)0, ~(u128)0);
+    for (int i = 0; i < 128; i++)
+    {
+        test_deposit(~(u128)0, (u128)1 << i);
+        test_deposit((u128)1 << i, ~(u128)0);
+        test_deposit(~(u128)0 >> i, ~(u128)0 << i);
+    }
+    for (int i = 0; i < 20000; i++)
+    {
+        u128 x = rand_u128();
+        test_deposit(x, rand_u128());
+        test_deposit(x, rand_u128() & rand_u128());
+        test_deposit(x, rand_u128() | rand_u128());
+    }
+}
+
+int main(void)
+{
+    srand(1);
+    printf("instructions %s\n", bitops_using_hardware() ? "used" : "not there");
+    test_all();
+
+    bitops_use_hardware(false);
+    if (bitops_using_hardware())
+    {
+        printf("FAIL still using instructions\n");
+        fails++;
+    }
+    test_all();
+    bitops_use_hardware(true);
+
+    if (fails == 0)
+    {
+        printf("All tests passed\n");
+    }
+    else
+    {
+        printf("%d tests failed\n", fails);
+    }
+    return fails == 0 ? 0 : 1;
+}
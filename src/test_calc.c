@@ -0,0 +1,159 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "calc.h"
+#include "calc_conversion.h"
+
+/* For testing the calculator in calc.c through calc_give_arg and
+ * calc_give_op, as the gui drives it. So far the exact fractions kept in
+ * rational mode. */
+
+static int fails;
+
+/* the display, only the integer is looked at */
+static calc_int_t result_ival;
+
+static void result(calc_int_t ival, stackf_t fval, calc_op_enum cop)
+{
+    (void)fval;
+    (void)cop;
+    result_ival = ival;
+}
+
+/* the float display carried over on a switch to integer mode, always 0 */
+static bool best_integer(calc_int_t *uval, bool *negative)
+{
+    *uval = 0;
+    *negative = false;
+    return true;
+}
+
+static void give(const char *text)
+{
+    stackf_t fval;
+
+    dfp_from_string(&fval, text, &dfp_context);
+    calc_give_arg(0, fval);
+}
+
+static void check_rational(const char *what, bool valid, calc_sint_t num,
+                           calc_int_t den)
+{
+    rat_t r;
+    bool got = calc_get_rational_top_of_stack(&r);
+
+    if (got != valid || (valid && (r.num != num || r.den != den)))
+    {
+        printf("FAIL %s, expect %s got %s\n", what,
+               valid ? "a fraction" : "none", got ? "a fraction" : "none");
+        fails++;
+    }
+}
+
+static void test_memory(void)
+{
+    calc_clear();
+    calc_set_rational(calc_rational_fraction);
+
+    /* 1/3 stays exact through memory */
+    give("1");
+    calc_give_op(cop_div);
+    give("3");
+    calc_give_op(cop_eq);
+    calc_give_op(cop_ms);
+    calc_clear();
+    calc_give_op(cop_mr);
+    check_rational("recall 1/3", true, 1, 3);
+
+    /* sqrt(2) is rounded, so not the fraction of its decimal */
+    calc_clear();
+    give("2");
+    calc_give_op(cop_sqrt);
+    check_rational("sqrt(2)", false, 0, 0);
+    calc_give_op(cop_ms);
+    calc_clear();
+    calc_give_op(cop_mr);
+    check_rational("recall sqrt(2)", false, 0, 0);
+
+    /* a decimal entered is exact */
+    calc_clear();
+    give("0.1");
+    check_rational("enter 0.1", true, 1, 10);
+
+    calc_set_rational(calc_rational_off);
+}
+
+/* values the gui passes in that are rounded results */
+static void test_inexact(void)
+{
+    stackf_t fval;
+
+    calc_clear();
+    calc_set_rational(calc_rational_fraction);
+
+    /* float history recall of 1/3 */
+    dfp_from_string(&fval, "0.3333333333333333333333333333333333", &dfp_context);
+    calc_give_inexact_arg(fval);
+    check_rational("history 1/3", false, 0, 0);
+
+    /* 3 m converted to inches, row 2 is m and row 5 inch */
+    calc_clear();
+    give("3");
+    calc_conversion_fix_value(ucv_length);
+    calc_conversion_set_convert_from_row(ucv_length, 2);
+    calc_conversion_apply_result(ucv_length, 5);
+    check_rational("3 m in inches", false, 0, 0);
+
+    /* a constant */
+    calc_clear();
+    calc_constants_apply_result("1.602176634e-19");
+    check_rational("constant", false, 0, 0);
+
+    calc_set_rational(calc_rational_off);
+}
+
+/* +/- in mod m is the residue of -x */
+static void test_modulus(void)
+{
+    stackf_t dzero;
+    calc_int_t pm[][2] = { {5, 2}, {0, 0}, {6, 1}, {1, 6} };
+
+    dfp_zero(&dzero);
+    calc_set_mode(calc_mode_integer);
+    calc_set_modulus(7);
+    for (unsigned int i = 0; i < sizeof(pm) / sizeof(pm[0]); i++)
+    {
+        calc_clear();
+        calc_give_arg(pm[i][0], dzero);
+        calc_give_op(cop_pm);
+        if (result_ival != pm[i][1])
+        {
+            printf("FAIL +/- %d mod 7, expect %d got %d\n", (int)pm[i][0],
+                   (int)pm[i][1], (int)result_ival);
+            fails++;
+        }
+    }
+    calc_set_modulus(0);
+    calc_set_mode(calc_mode_float);
+}
+
+int main(void)
+{
+    calc_init(0, calc_mode_float, 0, false, 64, false, true, true);
+    calc_set_result_callback(result);
+    calc_set_get_best_integer_callback(best_integer);
+    calc_clear();
+
+    test_memory();
+    test_inexact();
+    test_modulus();
+
+    if (fails == 0)
+        printf("all passed\n");
+    else
+        printf("%d FAILED\n", fails);
+    return fails != 0;
+}
@@ -0,0 +1,243 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "checksum.h"
+
+/* For testing the checksum_ functions from checksum.c. The CRCs are
+ * checked against the catalogue check values and against a bit at a time
+ * version for any width, the hashes against published values. */
+
+static int fails;
+
+static const uint8_t check_str[] = "123456789";
+
+/* straight from the definition, one bit at a time */
+static uint64_t naive_crc(const crc_params_t *p, const uint8_t *data,
+                          size_t len)
+{
+    uint64_t top = 1ULL << (p->width - 1);
+    uint64_t mask = p->width == 64 ? ~0ULL : (top << 1) - 1;
+    uint64_t crc = p->init;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        for (int j = 0; j < 8; j++)
+        {
+            int bit = p->refin ? (data[i] >> j) & 1 : (data[i] >> (7 - j)) & 1;
+            bool xor = ((crc & top) != 0) != (bit != 0);
+            crc = (crc << 1) & mask;
+            if (xor)
+            {
+                crc ^= p->poly;
+            }
+        }
+    }
+    if (p->refout)
+    {
+        uint64_t r = 0;
+        for (int i = 0; i < p->width; i++)
+        {
+            r = (r << 1) | ((crc >> i) & 1);
+        }
+        crc = r;
+    }
+    return (crc ^ p->xorout) & mask;
+}
+
+static uint64_t rand64(void)
+{
+    uint64_t x = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        x = (x << 16) | (uint64_t)(rand() & 0xffff);
+    }
+    return x;
+}
+
+static void test_presets(void)
+{
+    for (int i = 0; i < checksum_num_crc_presets(); i++)
+    {
+        const crc_params_t *p = checksum_crc_preset(i);
+        uint64_t got = checksum_crc(p, check_str, 9);
+
+        if (!checksum_crc_params_ok(p))
+        {
+            printf("FAIL %s params not ok\n", p->name);
+            fails++;
+        }
+        if (got != p->check)
+        {
+            printf("FAIL %s got %llx expected %llx\n", p->name,
+                   (unsigned long long)got, (unsigned long long)p->check);
+            fails++;
+        }
+        if (naive_crc(p, check_str, 9) != p->check)
+        {
+            printf("FAIL naive %s\n", p->name);
+            fails++;
+        }
+    }
+}
+
+/* random params, lengths and alignments */
+static void test_random(void)
+{
+    static uint8_t buf[200];
+
+    for (size_t i = 0; i < sizeof(buf); i++)
+    {
+        buf[i] = (uint8_t)rand();
+    }
+    for (int i = 0; i < 20000; i++)
+    {
+        crc_params_t p;
+        uint64_t mask;
+        size_t off = rand() % 8;
+        size_t len = rand() % (sizeof(buf) - off);
+        uint64_t got, expected;
+
+        p.name = "random";
+        p.width = 1 + rand() % 64;
+        mask = p.width == 64 ? ~0ULL : (1ULL << p.width) - 1;
+        p.poly = rand64() & mask;
+        p.init = rand64() & mask;
+        p.xorout = rand64() & mask;
+        p.refin = rand() & 1;
+        p.refout = rand() & 1;
+        /* now and then the CRC-32C poly, for the instruction */
+        if (i % 4 == 0)
+        {
+            p.width = 32;
+            p.poly = 0x1edc6f41;
+            p.init &= 0xffffffff;
+            p.xorout &= 0xffffffff;
+        }
+
+        got = checksum_crc(&p, buf + off, len);
+        expected = naive_crc(&p, buf + off, len);
+        if (got != expected)
+        {
+            printf("FAIL crc width %d poly %llx refin %d refout %d len %zu "
+                   "got %llx expected %llx\n", p.width,
+                   (unsigned long long)p.poly, p.refin, p.refout, len,
+                   (unsigned long long)got, (unsigned long long)expected);
+            fails++;
+        }
+    }
+}
+
+static void test_hashes(void)
+{
+    static const struct
+    {
+        const char *s;
+        uint64_t fnv;
+    } fnv_tests[] =
+    {
+        {"", 0xcbf29ce484222325ULL},
+        {"a", 0xaf63dc4c8601ec8cULL},
+        {"foobar", 0x85944171f73967e8ULL},
+    };
+    static const struct
+    {
+        const char *s;
+        uint64_t seed;
+        uint64_t xxh;
+    } xxh_tests[] =
+    {
+        {"", 0, 0xef46db3751d8e999ULL},
+        {"Nobody inspects the spammish repetition", 0, 0xfbcea83c8a378bf1ULL},
+    };
+
+    for (size_t i = 0; i < sizeof(fnv_tests) / sizeof(fnv_tests[0]); i++)
+    {
+        const char *s = fnv_tests[i].s;
+        uint64_t got = checksum_fnv1a64((const uint8_t *)s, strlen(s));
+        if (got != fnv_tests[i].fnv)
+        {
+            printf("FAIL fnv1a64 \"%s\" got %llx\n", s, (unsigned long long)got);
+            fails++;
+        }
+    }
+    for (size_t i = 0; i < sizeof(xxh_tests) / sizeof(xxh_tests[0]); i++)
+    {
+        const char *s = xxh_tests[i].s;
+        uint64_t got = checksum_xxh64((const uint8_t *)s, strlen(s),
+                                      xxh_tests[i].seed);
+        if (got != xxh_tests[i].xxh)
+        {
+            printf("FAIL xxh64 \"%s\" got %llx\n", s, (unsigned long long)got);
+            fails++;
+        }
+    }
+}
+
+static double elapsed(clock_t start)
+{
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+/* just for information, the speed over a large buffer */
+static void time_checksums(void)
+{
+    size_t len = 64 << 20;
+    uint8_t *buf = malloc(len);
+    clock_t start;
+    volatile uint64_t sink;
+
+    if (buf == NULL)
+    {
+        return;
+    }
+    for (size_t i = 0; i < len; i++)
+    {
+        buf[i] = (uint8_t)(i * 131);
+    }
+    for (int i = 0; i < checksum_num_crc_presets(); i++)
+    {
+        const crc_params_t *p = checksum_crc_preset(i);
+        start = clock();
+        sink = checksum_crc(p, buf, len);
+        printf("%-20s %6.2f GB/s\n", p->name, len / elapsed(start) / 1e9);
+    }
+    start = clock();
+    sink = checksum_fnv1a64(buf, len);
+    printf("%-20s %6.2f GB/s\n", "FNV-1a 64", len / elapsed(start) / 1e9);
+    start = clock();
+    sink = checksum_xxh64(buf, len, 0);
+    printf("%-20s %6.2f GB/s\n", "XXH64", len / elapsed(start) / 1e9);
+    (void)sink;
+    free(buf);
+}
+
+int main(void)
+{
+    srand(1);
+    printf("crc32 instruction %s\n",
+           checksum_using_hardware() ? "used" : "not there");
+    test_presets();
+    test_random();
+    test_hashes();
+
+    checksum_use_hardware(false);
+    test_presets();
+    test_random();
+    checksum_use_hardware(true);
+
+    if (fails == 0)
+    {
+        printf("All tests passed\n");
+    }
+    else
+    {
+        printf("%d tests failed\n", fails);
+    }
+
+    time_checksums();
+    return fails == 0 ? 0 : 1;
+}
@@ -0,0 +1,307 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "dfp_bid128.h"
+
+/* Differential test of dfp_bid128.c against decQuad. Random operands,
+ * biased towards the awkward cases (cancellation, exponents near the
+ * limits, big alignment shifts), are given to both and the results and
+ * status compared bit for bit, for every rounding mode. */
+
+
+#define NUM_RANDOM  200000
+
+#define STATUS_MASK (DEC_Inexact | DEC_Overflow | DEC_Underflow | \
+                     DEC_Invalid_operation)
+
+static const enum rounding round_modes[] =
+{
+    DEC_ROUND_HALF_EVEN,
+    DEC_ROUND_HALF_UP,
+    DEC_ROUND_HALF_DOWN,
+    DEC_ROUND_UP,
+    DEC_ROUND_DOWN,
+    DEC_ROUND_CEILING,
+    DEC_ROUND_FLOOR,
+    DEC_ROUND_05UP,
+};
+
+static uint64_t rng_state = 0x9e3779b97f4a7c15ULL;
+
+static uint64_t rng(void)
+{
+    /* xorshift64* */
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 0x2545f4914f6cdd1dULL;
+}
+
+static int rng_range(int lo, int hi)
+{
+    return lo + (int)(rng() % (uint64_t)(hi - lo + 1));
+}
+
+static void random_quad(decQuad *dq)
+{
+    uint8_t bcd[DECQUAD_Pmax];
+    int32_t exp;
+    int sign = rng() & 1 ? DECFLOAT_Sign : 0;
+    int ndigits = rng_range(1, DECQUAD_Pmax);
+    int kind = rng_range(0, 99);
+
+    memset(bcd, 0, sizeof(bcd));
+    for (int i = DECQUAD_Pmax - ndigits; i < DECQUAD_Pmax; i++)
+    {
+        /* runs of 9s and 0s are the interesting ones for rounding */
+        int r = rng_range(0, 9);
+        bcd[i] = r < 3 ? 9 : r < 5 ? 0 : rng_range(0, 9);
+    }
+
+    if (kind < 2)
+    {
+        memset(bcd, 0, sizeof(bcd));
+        exp = DECFLOAT_Inf;
+    }
+    else if (kind < 4)
+    {
+        bcd[0] = 0;
+        exp = rng() & 1 ? DECFLOAT_qNaN : DECFLOAT_sNaN;
+    }
+    else if (kind < 8)
+    {
+        memset(bcd, 0, sizeof(bcd));
+        exp = rng_range(-DECQUAD_Bias, DECQUAD_Emax - DECQUAD_Pmax + 1);
+    }
+    else if (kind < 60)
+        exp = rng_range(-40, 40);
+    else if (kind < 80)
+        exp = rng_range(-DECQUAD_Bias, -DECQUAD_Bias + 80);
+    else if (kind < 95)
+        exp = rng_range(DECQUAD_Emax - 100, DECQUAD_Emax - DECQUAD_Pmax + 1);
+    else
+        exp = rng_range(-DECQUAD_Bias, DECQUAD_Emax - DECQUAD_Pmax + 1);
+
+    decQuadFromBCD(dq, exp, bcd, sign);
+}
+
+/* a second operand that is likely to cancel or need a big shift */
+static void related_quad(decQuad *dq, const decQuad *a)
+{
+    uint8_t bcd[DECQUAD_Pmax];
+    int32_t exp;
+    int32_t sign = decQuadToBCD(a, &exp, bcd);
+
+    if (!decQuadIsFinite(a))
+    {
+        random_quad(dq);
+        return;
+    }
+
+    switch (rng_range(0, 3))
+    {
+    case 0:
+        /* nearly the same magnitude, opposite sign */
+        sign ^= DECFLOAT_Sign;
+        bcd[DECQUAD_Pmax - 1 - rng_range(0, 3)] = rng_range(0, 9);
+        break;
+    case 1:
+        /* exponent shifted by around a coefficient length or two */
+        exp -= rng_range(30, 80);
+        if (exp < -DECQUAD_Bias)
+            exp = -DECQUAD_Bias;
+        break;
+    case 2:
+        /* exactly the negative */
+        sign ^= DECFLOAT_Sign;
+        break;
+    default:
+        exp += rng_range(-5, 5);
+        if (exp < -DECQUAD_Bias)
+            exp = -DECQUAD_Bias;
+        if (exp > DECQUAD_Emax - DECQUAD_Pmax + 1)
+            exp = DECQUAD_Emax - DECQUAD_Pmax + 1;
+        break;
+    }
+    decQuadFromBCD(dq, exp, bcd, sign);
+}
+
+typedef enum
+{
+    op_add,
+    op_subtract,
+    op_multiply,
+    op_compare,
+    op_minus,
+    op_abs,
+    num_ops
+} op_enum;
+
+static const char *op_names[num_ops] =
+{
+    "add", "subtract", "multiply", "compare", "minus", "abs"
+};
+
+static bool check_op(op_enum op, const decQuad *a, const decQuad *b,
+                     enum rounding round)
+{
+    decContext set_dq, set_bid;
+    decQuad expect, got_dq;
+    bid128_t ba, bb, got;
+
+    decContextDefault(&set_dq, DEC_INIT_DECQUAD);
+    set_dq.round = round;
+    set_bid = set_dq;
+
+    bid128_from_decquad(&ba, a);
+    bid128_from_decquad(&bb, b);
+
+    switch (op)
+    {
+    case op_add:
+        decQuadAdd(&expect, a, b, &set_dq);
+        bid128_add(&got, &ba, &bb, &set_bid);
+        break;
+    case op_subtract:
+        decQuadSubtract(&expect, a, b, &set_dq);
+        bid128_subtract(&got, &ba, &bb, &set_bid);
+        break;
+    case op_multiply:
+        decQuadMultiply(&expect, a, b, &set_dq);
+        bid128_multiply(&got, &ba, &bb, &set_bid);
+        break;
+    case op_compare:
+        decQuadCompare(&expect, a, b, &set_dq);
+        bid128_compare(&got, &ba, &bb, &set_bid);
+        break;
+    case op_minus:
+        decQuadMinus(&expect, a, &set_dq);
+        bid128_minus(&got, &ba, &set_bid);
+        break;
+    default:
+        decQuadAbs(&expect, a, &set_dq);
+        bid128_abs(&got, &ba, &set_bid);
+        break;
+    }
+
+    bid128_to_decquad(&got, &got_dq);
+    if (memcmp(&expect, &got_dq, sizeof(decQuad)) != 0
+        || (set_dq.status & STATUS_MASK) != (set_bid.status & STATUS_MASK))
+    {
+        char sa[DECQUAD_String], sb[DECQUAD_String];
+        char se[DECQUAD_String], sg[DECQUAD_String];
+        printf("%s FAIL (round %d): %s, %s\n", op_names[op], (int)round,
+               decQuadToString(a, sa), decQuadToString(b, sb));
+        printf("    expected %s status %x, got %s status %x\n",
+               decQuadToString(&expect, se), set_dq.status & STATUS_MASK,
+               decQuadToString(&got_dq, sg), set_bid.status & STATUS_MASK);
+        return false;
+    }
+    return true;
+}
+
+static bool test_round_trip(void)
+{
+    bool ok = true;
+
+    for (int i = 0; i < NUM_RANDOM && ok; i++)
+    {
+        decQuad a, back;
+        bid128_t b;
+        random_quad(&a);
+        bid128_from_decquad(&b, &a);
+        bid128_to_decquad(&b, &back);
+        if (memcmp(&a, &back, sizeof(decQuad)) != 0)
+        {
+            char s[DECQUAD_String];
+            printf("round trip FAIL: %s\n", decQuadToString(&a, s));
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+static bool test_random_ops(void)
+{
+    bool ok = true;
+    int fails = 0;
+
+    for (unsigned int m = 0; m < sizeof(round_modes) / sizeof(round_modes[0]); m++)
+    {
+        for (int i = 0; i < NUM_RANDOM; i++)
+        {
+            decQuad a, b;
+            random_quad(&a);
+            if (rng() & 1)
+                related_quad(&b, &a);
+            else
+                random_quad(&b);
+
+            for (int op = 0; op < num_ops; op++)
+            {
+                if (!check_op(op, &a, &b, round_modes[m]))
+                {
+                    ok = false;
+                    if (++fails > 20)
+                        return false;
+                }
+            }
+        }
+    }
+    return ok;
+}
+
+/* not a test as such, just to see the difference. A chain of multiply
+ * and add, with operands that need rounding some of the time */
+static void time_ops(void)
+{
+    decContext set;
+    decQuad dq_x, dq_m, dq_a;
+    bid128_t b_x, b_m, b_a;
+    clock_t start;
+    double t_dq, t_bid;
+    const int n = 2000000;
+
+    decContextDefault(&set, DEC_INIT_DECQUAD);
+    decQuadFromString(&dq_m, "1.0000000001", &set);
+    decQuadFromString(&dq_a, "0.5", &set);
+    decQuadFromString(&dq_x, "1", &set);
+    bid128_from_decquad(&b_m, &dq_m);
+    bid128_from_decquad(&b_a, &dq_a);
+    bid128_from_decquad(&b_x, &dq_x);
+
+    start = clock();
+    for (int i = 0; i < n; i++)
+    {
+        decQuadMultiply(&dq_x, &dq_x, &dq_m, &set);
+        decQuadAdd(&dq_x, &dq_x, &dq_a, &set);
+    }
+    t_dq = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for (int i = 0; i < n; i++)
+    {
+        bid128_multiply(&b_x, &b_x, &b_m, &set);
+        bid128_add(&b_x, &b_x, &b_a, &set);
+    }
+    t_bid = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    printf("multiply+add x %d: decQuad %.3fs, bid128 %.3fs\n", n, t_dq, t_bid);
+}
+
+int main(void)
+{
+    bool ok = test_round_trip() && test_random_ops();
+
+    if (ok)
+        printf("all tests OK\n");
+    else
+        printf("************* FAIL ***************\n");
+
+    time_ops();
+
+    return 0;
+}
@@ -0,0 +1,787 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "dfp_bulk.h"
+
+/* Test of dfp_bulk.c against the one at a time decQuad functions it
+ * replaces. */
+
+
+#define NUM_RANDOM  100000
+#define NUM_ARITH   20000
+
+static const enum rounding round_modes[] =
+{
+    DEC_ROUND_HALF_EVEN,
+    DEC_ROUND_HALF_UP,
+    DEC_ROUND_HALF_DOWN,
+    DEC_ROUND_UP,
+    DEC_ROUND_DOWN,
+    DEC_ROUND_CEILING,
+    DEC_ROUND_FLOOR,
+    DEC_ROUND_05UP,
+};
+
+static uint64_t rng_state = 0x9e3779b97f4a7c15ULL;
+
+static uint64_t rng(void)
+{
+    /* xorshift64* */
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 0x2545f4914f6cdd1dULL;
+}
+
+static int rng_range(int lo, int hi)
+{
+    return lo + (int)(rng() % (uint64_t)(hi - lo + 1));
+}
+
+/* any bit pattern at all, including non canonical declets and specials
+ * with junk in the coefficient */
+static void random_bits(decQuad *dq)
+{
+    for (int i = 0; i < 4; i++)
+        dq->words[i] = (uint32_t)rng();
+}
+
+static void random_bcd(int32_t *exp, uint8_t *bcd, int32_t *sign)
+{
+    int kind = rng_range(0, 99);
+
+    for (int i = 0; i < DECQUAD_Pmax; i++)
+        bcd[i] = (uint8_t)rng_range(0, 9);
+    *sign = rng() & 1 ? DECFLOAT_Sign : 0;
+
+    if (kind < 3)
+    {
+        memset(bcd, 0, DECQUAD_Pmax);
+        *exp = DECFLOAT_Inf;
+    }
+    else if (kind < 6)
+    {
+        bcd[0] = 0;
+        *exp = rng() & 1 ? DECFLOAT_qNaN : DECFLOAT_sNaN;
+    }
+    else
+    {
+        *exp = rng_range(-DECQUAD_Bias, DECQUAD_Emax - DECQUAD_Pmax + 1);
+    }
+}
+
+static bool check_to_bcd(const decQuad *dq, size_t n)
+{
+    int32_t *exp = malloc(n * sizeof(int32_t));
+    int32_t *sign = malloc(n * sizeof(int32_t));
+    uint8_t *bcd = malloc(n * DECQUAD_Pmax);
+    bool ok = true;
+
+    dfp_bulk_to_bcd(dq, n, exp, bcd, sign);
+    for (size_t i = 0; i < n && ok; i++)
+    {
+        int32_t e;
+        uint8_t b[DECQUAD_Pmax];
+        int32_t s = decQuadToBCD(&dq[i], &e, b);
+        if (s != sign[i] || e != exp[i]
+            || memcmp(b, &bcd[i * DECQUAD_Pmax], DECQUAD_Pmax) != 0)
+        {
+            printf("to_bcd FAIL at %d: %08x %08x %08x %08x\n", (int)i,
+                   dq[i].words[3], dq[i].words[2],
+                   dq[i].words[1], dq[i].words[0]);
+            ok = false;
+        }
+    }
+    free(exp);
+    free(sign);
+    free(bcd);
+    return ok;
+}
+
+static bool check_from_bcd(const int32_t *exp, const uint8_t *bcd,
+                           const int32_t *sign, size_t n)
+{
+    decQuad *dq = malloc(n * sizeof(decQuad));
+    bool ok = true;
+
+    dfp_bulk_from_bcd(dq, n, exp, bcd, sign);
+    for (size_t i = 0; i < n && ok; i++)
+    {
+        decQuad expect;
+        decQuadFromBCD(&expect, exp[i], &bcd[i * DECQUAD_Pmax], sign[i]);
+        if (memcmp(&expect, &dq[i], sizeof(decQuad)) != 0)
+        {
+            char s[DECQUAD_String];
+            printf("from_bcd FAIL at %d: %s\n", (int)i,
+                   decQuadToString(&expect, s));
+            ok = false;
+        }
+    }
+    free(dq);
+    return ok;
+}
+
+/* every declet value in every position */
+static bool test_all_declets(void)
+{
+    decQuad dq[1024];
+
+    for (int d = 0; d < 1024; d++)
+    {
+        /* finite, exponent 0, msd 0, all declets d */
+        uint32_t w[4] = { 0x22080000, 0, 0, 0 };
+        for (int k = 0; k < 11; k++)
+        {
+            int bit = 10 * k;
+            w[3 - bit / 32] |= (uint32_t)d << (bit % 32);
+            if (bit % 32 > 22)
+                w[3 - bit / 32 - 1] |= (uint32_t)d >> (32 - bit % 32);
+        }
+        for (int i = 0; i < 4; i++)
+            dq[d].words[i] = w[3 - i];
+    }
+    return check_to_bcd(dq, 1024);
+}
+
+static bool test_all_triples(void)
+{
+    int32_t exp[1000], sign[1000];
+    uint8_t bcd[1000 * DECQUAD_Pmax];
+
+    for (int t = 0; t < 1000; t++)
+    {
+        uint8_t *b = &bcd[t * DECQUAD_Pmax];
+        exp[t] = t - 500;
+        sign[t] = t & 1 ? DECFLOAT_Sign : 0;
+        b[0] = (uint8_t)(t % 10);
+        for (int k = 0; k < 11; k++)
+        {
+            b[1 + 3 * k] = (uint8_t)(t / 100);
+            b[2 + 3 * k] = (uint8_t)(t / 10 % 10);
+            b[3 + 3 * k] = (uint8_t)(t % 10);
+        }
+    }
+    return check_from_bcd(exp, bcd, sign, 1000);
+}
+
+static bool test_random(void)
+{
+    decQuad *dq = malloc(NUM_RANDOM * sizeof(decQuad));
+    int32_t *exp = malloc(NUM_RANDOM * sizeof(int32_t));
+    int32_t *sign = malloc(NUM_RANDOM * sizeof(int32_t));
+    uint8_t *bcd = malloc(NUM_RANDOM * DECQUAD_Pmax);
+    bool ok = true;
+
+    for (int i = 0; i < NUM_RANDOM; i++)
+    {
+        random_bits(&dq[i]);
+        random_bcd(&exp[i], &bcd[i * DECQUAD_Pmax], &sign[i]);
+    }
+
+    /* odd lengths for the part blocks at the end */
+    for (size_t n = 1; n < 200 && ok; n += 7)
+    {
+        ok = check_to_bcd(dq, n) && check_from_bcd(exp, bcd, sign, n);
+    }
+    ok = ok && check_to_bcd(dq, NUM_RANDOM)
+         && check_from_bcd(exp, bcd, sign, NUM_RANDOM);
+
+    free(dq);
+    free(exp);
+    free(sign);
+    free(bcd);
+    return ok;
+}
+
+static bool test_array_round_trip(void)
+{
+    decQuad *dq = malloc(NUM_RANDOM * sizeof(decQuad));
+    decQuad *back = malloc(NUM_RANDOM * sizeof(decQuad));
+    dfp_array_t arr;
+    bool ok = dfp_array_alloc(&arr, NUM_RANDOM);
+
+    for (int i = 0; i < NUM_RANDOM; i++)
+        random_bits(&dq[i]);
+    dfp_array_from_quads(&arr, dq, NUM_RANDOM);
+    dfp_array_to_quads(back, &arr, NUM_RANDOM);
+
+    for (int i = 0; i < NUM_RANDOM && ok; i++)
+    {
+        decQuad canon;
+        decQuadCanonical(&canon, &dq[i]);
+        if (memcmp(&canon, &back[i], sizeof(decQuad)) != 0)
+        {
+            char s[DECQUAD_String];
+            printf("array round trip FAIL: %s\n",
+                   decQuadToString(&canon, s));
+            ok = false;
+        }
+    }
+    dfp_array_free(&arr);
+    free(dq);
+    free(back);
+    return ok;
+}
+
+/* mostly short coefficients and nearby exponents, so that the exact
+ * paths get used, with some of everything else */
+static void random_operand(decQuad *dq)
+{
+    int32_t exp, sign;
+    uint8_t bcd[DECQUAD_Pmax];
+    int kind = rng_range(0, 99);
+
+    random_bcd(&exp, bcd, &sign);
+    if (kind < 70 && exp < DECFLOAT_MinSp)
+    {
+        int ndigits = rng_range(0, kind < 40 ? 10 : DECQUAD_Pmax);
+        memset(bcd, 0, DECQUAD_Pmax - ndigits);
+        exp = rng_range(-20, 20);
+    }
+    else if (kind < 75 && exp < DECFLOAT_MinSp)
+    {
+        exp = rng_range(-6176, -6130);
+    }
+    else if (kind < 80 && exp < DECFLOAT_MinSp)
+    {
+        exp = rng_range(3050, 3070);
+    }
+    decQuadFromBCD(dq, exp, bcd, sign);
+}
+
+typedef enum
+{
+    arith_add,
+    arith_sub,
+    arith_mul,
+    arith_div,
+    arith_fma,
+    arith_compare,
+    num_arith
+} arith_enum;
+
+static const char *arith_names[num_arith] =
+{
+    "add", "sub", "mul", "div", "fma", "compare"
+};
+
+static bool test_array_arith(void)
+{
+    decQuad *qa = malloc(NUM_ARITH * sizeof(decQuad));
+    decQuad *qb = malloc(NUM_ARITH * sizeof(decQuad));
+    decQuad *qc = malloc(NUM_ARITH * sizeof(decQuad));
+    decQuad *got = malloc(NUM_ARITH * sizeof(decQuad));
+    dfp_array_t a, b, c, r;
+    decContext set_minus;
+    bool ok = true;
+
+    decContextDefault(&set_minus, DEC_INIT_DECQUAD);
+    dfp_array_alloc(&a, NUM_ARITH);
+    dfp_array_alloc(&b, NUM_ARITH);
+    dfp_array_alloc(&c, NUM_ARITH);
+    dfp_array_alloc(&r, NUM_ARITH);
+
+    for (int i = 0; i < NUM_ARITH; i++)
+    {
+        random_operand(&qa[i]);
+        random_operand(&qb[i]);
+        random_operand(&qc[i]);
+        /* some exact cancellation */
+        if (rng_range(0, 19) == 0)
+            decQuadMinus(&qb[i], &qa[i], &set_minus);
+    }
+    dfp_array_from_quads(&a, qa, NUM_ARITH);
+    dfp_array_from_quads(&b, qb, NUM_ARITH);
+    dfp_array_from_quads(&c, qc, NUM_ARITH);
+
+    for (unsigned int m = 0; m < sizeof(round_modes) / sizeof(round_modes[0]); m++)
+    {
+        for (int op = 0; op < num_arith && ok; op++)
+        {
+            decContext set_n;
+            decContextDefault(&set_n, DEC_INIT_DECQUAD);
+            set_n.round = round_modes[m];
+
+            switch (op)
+            {
+            case arith_add:
+                dfp_add_n(&r, &a, &b, NUM_ARITH, &set_n);
+                break;
+            case arith_sub:
+                dfp_sub_n(&r, &a, &b, NUM_ARITH, &set_n);
+                break;
+            case arith_mul:
+                dfp_mul_n(&r, &a, &b, NUM_ARITH, &set_n);
+                break;
+            case arith_div:
+                dfp_div_n(&r, &a, &b, NUM_ARITH, &set_n);
+                break;
+            case arith_fma:
+                dfp_fma_n(&r, &a, &b, &c, NUM_ARITH, &set_n);
+                break;
+            default:
+                dfp_compare_n(&r, &a, &b, NUM_ARITH, &set_n);
+                break;
+            }
+            dfp_array_to_quads(got, &r, NUM_ARITH);
+
+            /* status is sticky, so compare it for the whole array */
+            decContext set;
+            decContextDefault(&set, DEC_INIT_DECQUAD);
+            set.round = round_modes[m];
+            for (int i = 0; i < NUM_ARITH && ok; i++)
+            {
+                decQuad expect;
+                switch (op)
+                {
+                case arith_add:
+                    decQuadAdd(&expect, &qa[i], &qb[i], &set);
+                    break;
+                case arith_sub:
+                    decQuadSubtract(&expect, &qa[i], &qb[i], &set);
+                    break;
+                case arith_mul:
+                    decQuadMultiply(&expect, &qa[i], &qb[i], &set);
+                    break;
+                case arith_div:
+                    decQuadDivide(&expect, &qa[i], &qb[i], &set);
+                    break;
+                case arith_fma:
+                    decQuadFMA(&expect, &qa[i], &qb[i], &qc[i], &set);
+                    break;
+                default:
+                    decQuadCompare(&expect, &qa[i], &qb[i], &set);
+                    break;
+                }
+                if (memcmp(&expect, &got[i], sizeof(decQuad)) != 0)
+                {
+                    char sa[DECQUAD_String], sb[DECQUAD_String];
+                    char se[DECQUAD_String], sg[DECQUAD_String];
+                    printf("%s_n FAIL (round %d): %s, %s\n",
+                           arith_names[op], (int)round_modes[m],
+                           decQuadToString(&qa[i], sa),
+                           decQuadToString(&qb[i], sb));
+                    printf("    expected %s, got %s\n",
+                           decQuadToString(&expect, se),
+                           decQuadToString(&got[i], sg));
+                    ok = false;
+                }
+            }
+            if (ok && set.status != set_n.status)
+            {
+                printf("%s_n FAIL (round %d): status %x, expected %x\n",
+                       arith_names[op], (int)round_modes[m],
+                       set_n.status, set.status);
+                ok = false;
+            }
+        }
+    }
+
+    /* result in place of an operand */
+    if (ok)
+    {
+        decContext set;
+        decContextDefault(&set, DEC_INIT_DECQUAD);
+        dfp_add_n(&a, &a, &b, NUM_ARITH, &set);
+        dfp_array_to_quads(got, &a, NUM_ARITH);
+        for (int i = 0; i < NUM_ARITH && ok; i++)
+        {
+            decQuad expect;
+            decQuadAdd(&expect, &qa[i], &qb[i], &set);
+            if (memcmp(&expect, &got[i], sizeof(decQuad)) != 0)
+            {
+                printf("add_n in place FAIL at %d\n", i);
+                ok = false;
+            }
+        }
+    }
+
+    dfp_array_free(&a);
+    dfp_array_free(&b);
+    dfp_array_free(&c);
+    dfp_array_free(&r);
+    free(qa);
+    free(qb);
+    free(qc);
+    free(got);
+    return ok;
+}
+
+/* reference for dfp_bulk_parse, one token at a time through
+ * decQuadFromString */
+static bool check_parse(const char *text, enum rounding round)
+{
+    size_t len = strlen(text);
+    decQuad got[64];
+    size_t used;
+    decContext set, set_n;
+    size_t n;
+    const char *p = text, *end = text + len;
+    size_t count = 0;
+    bool ok = true;
+
+    decContextDefault(&set, DEC_INIT_DECQUAD);
+    set.round = round;
+    set_n = set;
+    n = dfp_bulk_parse(got, 64, text, len, &used, &set_n);
+
+    while (p < end && ok)
+    {
+        const char *start = p, *stop;
+        char token[1024];
+        decQuad expect;
+
+        while (p < end && *p != ',' && *p != '\n')
+            p++;
+        stop = p;
+        if (p < end)
+            p++;
+        while (start < stop && strchr(" \t\r", *start))
+            start++;
+        while (stop > start && strchr(" \t\r", stop[-1]))
+            stop--;
+        if (start == stop && stop == end)
+            break;
+
+        memcpy(token, start, (size_t)(stop - start));
+        token[stop - start] = '\0';
+        decQuadFromString(&expect, token, &set);
+        if (count >= n || memcmp(&expect, &got[count], sizeof(decQuad)) != 0)
+        {
+            char se[DECQUAD_String], sg[DECQUAD_String];
+            printf("parse FAIL (round %d) \"%s\": expected %s, got %s\n",
+                   (int)round, token, decQuadToString(&expect, se),
+                   count < n ? decQuadToString(&got[count], sg) : "none");
+            ok = false;
+        }
+        count++;
+    }
+    if (ok && (count != n || used != len || set.status != set_n.status))
+    {
+        printf("parse FAIL \"%s\": %d values (expected %d), used %d of %d,"
+               " status %x (expected %x)\n", text, (int)n, (int)count,
+               (int)used, (int)len, set_n.status, set.status);
+        ok = false;
+    }
+    return ok;
+}
+
+static bool test_parse(void)
+{
+    static const char *texts[] =
+    {
+        "1,2.50,-0.000, +7E3,1e-6200\n",
+        "1.2.3, abc, Inf, -NaN123, sNaN, .5, 5., -.0e+00",
+        "1234567890123456789012345678901234567,"
+        "00000000000000000000000000000000000000001",
+        "0.000000000000000000000000000000000000000000001234",
+        " \t42\r\n-17\r\n\r\n",
+        "1E6111,1E6112,9.999999999999999999999999999999999E6144,1E6145",
+        "1E-6143,1E-6144,1E-6176,1E-6177,0E-6176,0E-6177",
+        "12345678901234567890123456789012345E-6176",
+        "1e,e5,+,-,1e+,1e-1-,0x10,1_000,1,,2",
+        "99999999999999999999999999999999995,"
+        "99999999999999999999999999999999985",
+        "",
+        "\n",
+        "7",
+    };
+    bool ok = true;
+
+    for (unsigned int i = 0; i < sizeof(texts) / sizeof(texts[0]) && ok; i++)
+    {
+        for (unsigned int m = 0; m < sizeof(round_modes) / sizeof(round_modes[0]) && ok; m++)
+            ok = check_parse(texts[i], round_modes[m]);
+    }
+
+    /* random digit strings, long ones need rounding */
+    for (int i = 0; i < 20000 && ok; i++)
+    {
+        char text[1024];
+        char *p = text;
+        int values = rng_range(1, 20);
+
+        for (int v = 0; v < values; v++)
+        {
+            int ndigits = rng_range(1, rng_range(0, 3) ? 20 : 45);
+            int point = rng_range(-1, ndigits);
+
+            if (rng_range(0, 3) == 0)
+                *p++ = rng() & 1 ? '-' : '+';
+            for (int d = 0; d < ndigits; d++)
+            {
+                if (d == point)
+                    *p++ = '.';
+                *p++ = (char)('0' + (rng_range(0, 2) ? rng_range(0, 9) : 9));
+            }
+            if (rng_range(0, 2) == 0)
+                p += sprintf(p, "E%d", rng_range(-6200, 6200));
+            *p++ = rng() & 1 ? ',' : '\n';
+        }
+        *p = '\0';
+        ok = check_parse(text, round_modes[i % 8]);
+    }
+
+    /* stops when the array is full, and says where */
+    if (ok)
+    {
+        decQuad got[2];
+        decContext set;
+        size_t used;
+        decContextDefault(&set, DEC_INIT_DECQUAD);
+        if (dfp_bulk_parse(got, 2, "1,2,3", 5, &used, &set) != 2 || used != 4)
+        {
+            printf("parse FAIL: array full\n");
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+static bool test_format(void)
+{
+    enum { n = 5000 };
+    decQuad *dq = malloc(n * sizeof(decQuad));
+    char *buf = malloc(n * (DECQUAD_String + 1));
+    char *expect = malloc(n * (DECQUAD_String + 1));
+    size_t len, done, elen = 0;
+    bool ok = true;
+
+    for (int i = 0; i < n; i++)
+    {
+        if (i % 3 == 0)
+            random_bits(&dq[i]);
+        else
+            random_operand(&dq[i]);
+        decQuadToString(&dq[i], &expect[elen]);
+        elen += strlen(&expect[elen]);
+        expect[elen++] = '\n';
+    }
+    expect[--elen] = '\0';
+
+    len = dfp_bulk_format(buf, n * (DECQUAD_String + 1), dq, n, '\n', &done);
+    if (done != n || len != elen || strcmp(buf, expect) != 0)
+    {
+        for (size_t i = 0; i < len && i < elen; i++)
+        {
+            if (buf[i] != expect[i])
+            {
+                size_t start = i > 40 ? i - 40 : 0;
+                printf("format FAIL near \"%.80s\"\n    expected \"%.80s\"\n",
+                       &buf[start], &expect[start]);
+                break;
+            }
+        }
+        ok = false;
+    }
+
+    /* stops before a value that will not fit, and still terminates */
+    if (ok)
+    {
+        size_t size = elen / 2;
+        len = dfp_bulk_format(buf, size, dq, n, '\n', &done);
+        if (len >= size || buf[len] != '\0' || done == 0 || done == n
+            || strncmp(buf, expect, len) != 0
+            || (expect[len] != '\n'))
+        {
+            printf("format FAIL: short buffer\n");
+            ok = false;
+        }
+    }
+    free(dq);
+    free(buf);
+    free(expect);
+    return ok;
+}
+
+/* not a test as such, just to see the difference */
+/* to BCD and back, one at a time and bulk, for the values in dq */
+static void time_bcd(const char *what, decQuad *dq, int n, int reps)
+{
+    int32_t *exp = malloc(n * sizeof(int32_t));
+    int32_t *sign = malloc(n * sizeof(int32_t));
+    uint8_t *bcd = malloc(n * DECQUAD_Pmax);
+    clock_t start;
+    double t_one, t_bulk;
+
+    start = clock();
+    for (int r = 0; r < reps; r++)
+    {
+        for (int i = 0; i < n; i++)
+            sign[i] = decQuadToBCD(&dq[i], &exp[i], &bcd[i * DECQUAD_Pmax]);
+    }
+    t_one = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for (int r = 0; r < reps; r++)
+        dfp_bulk_to_bcd(dq, n, exp, bcd, sign);
+    t_bulk = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    printf("to bcd, %s x %d: one at a time %.3fs, bulk %.3fs\n",
+           what, n * reps, t_one, t_bulk);
+
+    start = clock();
+    for (int r = 0; r < reps; r++)
+    {
+        for (int i = 0; i < n; i++)
+            decQuadFromBCD(&dq[i], exp[i], &bcd[i * DECQUAD_Pmax], sign[i]);
+    }
+    t_one = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for (int r = 0; r < reps; r++)
+        dfp_bulk_from_bcd(dq, n, exp, bcd, sign);
+    t_bulk = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    printf("from bcd, %s x %d: one at a time %.3fs, bulk %.3fs\n",
+           what, n * reps, t_one, t_bulk);
+
+    free(exp);
+    free(sign);
+    free(bcd);
+}
+
+static void time_bulk(void)
+{
+    const int n = 10000;
+    const int reps = 200;
+    decQuad *dq = malloc(n * sizeof(decQuad));
+    clock_t start;
+    double t_one, t_bulk;
+
+    /* BCD, all 34 digits, then typical short values eg. prices */
+    for (int i = 0; i < n; i++)
+    {
+        int32_t exp, sign;
+        uint8_t bcd[DECQUAD_Pmax];
+        random_bcd(&exp, bcd, &sign);
+        decQuadFromBCD(&dq[i], exp, bcd, sign);
+    }
+    time_bcd("34 digits", dq, n, reps * 5);
+    for (int i = 0; i < n; i++)
+    {
+        decQuadFromInt32(&dq[i], rng_range(-10000000, 10000000));
+        dq[i].words[3] -= 2 << 14;   /* exponent -2 */
+    }
+    time_bcd("short", dq, n, reps * 5);
+
+    /* text, typical short values */
+    {
+        decContext set;
+        char *text = malloc(n * (DECQUAD_String + 1));
+        char *out = malloc(n * (DECQUAD_String + 1));
+        size_t len = 0, used, done;
+        decContextDefault(&set, DEC_INIT_DECQUAD);
+        for (int i = 0; i < n; i++)
+        {
+            len += sprintf(&text[len], "%d.%02d\n", rng_range(-100000, 100000),
+                           rng_range(0, 99));
+        }
+
+        start = clock();
+        for (int r = 0; r < reps / 4; r++)
+        {
+            const char *p = text;
+            char *o = out;
+            for (int i = 0; i < n; i++)
+            {
+                char token[DECQUAD_String];
+                const char *q = strchr(p, '\n');
+                memcpy(token, p, (size_t)(q - p));
+                token[q - p] = '\0';
+                decQuadFromString(&dq[i], token, &set);
+                p = q + 1;
+            }
+            for (int i = 0; i < n; i++)
+            {
+                decQuadToString(&dq[i], o);
+                o += strlen(o);
+                *o++ = '\n';
+            }
+        }
+        t_one = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+        start = clock();
+        for (int r = 0; r < reps / 4; r++)
+        {
+            dfp_bulk_parse(dq, n, text, len, &used, &set);
+            dfp_bulk_format(out, n * (DECQUAD_String + 1), dq, n, '\n',
+                            &done);
+        }
+        t_bulk = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+        printf("parse+format x %d: one at a time %.3fs, bulk %.3fs\n",
+               n * reps / 4, t_one, t_bulk);
+        free(text);
+        free(out);
+    }
+
+    /* add and multiply of typical short values, eg. a column of prices */
+    {
+        decContext set;
+        decQuad *q2 = malloc(n * sizeof(decQuad));
+        decQuad *q3 = malloc(n * sizeof(decQuad));
+        dfp_array_t a, b, r;
+        decContextDefault(&set, DEC_INIT_DECQUAD);
+        dfp_array_alloc(&a, n);
+        dfp_array_alloc(&b, n);
+        dfp_array_alloc(&r, n);
+        for (int i = 0; i < n; i++)
+        {
+            decQuadFromInt32(&dq[i], rng_range(0, 1000000));
+            decQuadFromInt32(&q2[i], rng_range(0, 1000));
+            dq[i].words[3] -= 2 << 14;   /* exponent -2 */
+        }
+        dfp_array_from_quads(&a, dq, n);
+        dfp_array_from_quads(&b, q2, n);
+
+        start = clock();
+        for (int r = 0; r < reps; r++)
+        {
+            for (int i = 0; i < n; i++)
+                decQuadAdd(&q3[i], &dq[i], &q2[i], &set);
+            for (int i = 0; i < n; i++)
+                decQuadMultiply(&q3[i], &dq[i], &q2[i], &set);
+            for (int i = 0; i < n; i++)
+                decQuadSubtract(&q3[i], &dq[i], &q2[i], &set);
+        }
+        t_one = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+        start = clock();
+        for (int i = 0; i < reps; i++)
+        {
+            dfp_add_n(&r, &a, &b, n, &set);
+            dfp_mul_n(&r, &a, &b, n, &set);
+            dfp_sub_n(&r, &a, &b, n, &set);
+        }
+        t_bulk = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+        printf("add+mul+sub x %d: one at a time %.3fs, arrays %.3fs\n",
+               n * reps, t_one, t_bulk);
+        dfp_array_free(&a);
+        dfp_array_free(&b);
+        dfp_array_free(&r);
+        free(q2);
+        free(q3);
+    }
+    free(dq);
+}
+
+int main(void)
+{
+    bool ok = test_all_declets() && test_all_triples() && test_random()
+              && test_array_round_trip() && test_array_arith()
+              && test_parse() && test_format();
+
+    if (ok)
+        printf("all tests OK\n");
+    else
+        printf("************* FAIL ***************\n");
+
+    time_bulk();
+
+    return 0;
+}
@@ -0,0 +1,447 @@
+/* bigger decNumbers than decQuad for the reference conversions */
+#define DECNUMDIGITS 64
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <inttypes.h>
+
+#include "dfp_int.h"
+#include "decNumber/decNumber.h"
+
+/* Test of dfp_int.c against decNumber, rounding to an integer with
+ * decNumberToIntegralValue then converting the plain text with strtoll /
+ * strtoull (or by hand for 128 bits). */
+
+
+#define NUM_RANDOM  300000
+
+decContext dfp_context;
+
+static const enum rounding round_modes[] =
+{
+    DEC_ROUND_HALF_EVEN,
+    DEC_ROUND_HALF_UP,
+    DEC_ROUND_HALF_DOWN,
+    DEC_ROUND_UP,
+    DEC_ROUND_DOWN,
+    DEC_ROUND_CEILING,
+    DEC_ROUND_FLOOR,
+    DEC_ROUND_05UP,
+};
+
+static uint64_t rng_state = 0x9e3779b97f4a7c15ULL;
+
+static uint64_t rng(void)
+{
+    /* xorshift64* */
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 0x2545f4914f6cdd1dULL;
+}
+
+static int rng_range(int lo, int hi)
+{
+    return lo + (int)(rng() % (uint64_t)(hi - lo + 1));
+}
+
+/* the reference, as text then strtoll / strtoull */
+static dfp_int_status_enum ref_convert(const stackf_t *a, enum rounding round,
+                                       bool is_signed, uint64_t *result)
+{
+    decNumber dn, rn, zero;
+    decContext set;
+    char buf[100];
+    bool neg;
+
+    if (dfp_is_nan(a))
+    {
+        *result = 0;
+        return dfp_int_nan;
+    }
+    neg = dfp_get_coefficient(a, (uint8_t[DECQUAD_Pmax]){ 0 }) != 0;
+    if (dfp_is_infinite(a))
+    {
+        if (is_signed)
+            *result = neg ? (uint64_t)INT64_MIN : INT64_MAX;
+        else
+            *result = neg ? 0 : UINT64_MAX;
+        return neg ? dfp_int_too_small : dfp_int_too_big;
+    }
+
+    decContextDefault(&set, DEC_INIT_BASE);
+    set.traps = 0;
+    set.digits = 64;
+    set.emax = 999;
+    set.emin = -999;
+    set.round = round;
+    dfp_to_number(a, &dn);
+    decNumberToIntegralValue(&rn, &dn, &set);
+    decNumberZero(&zero);
+    decNumberQuantize(&rn, &rn, &zero, &set);
+    if (decNumberIsNaN(&rn))
+    {
+        /* more than 64 digits */
+        if (is_signed)
+            *result = neg ? (uint64_t)INT64_MIN : INT64_MAX;
+        else
+            *result = neg ? 0 : UINT64_MAX;
+        return neg ? dfp_int_too_small : dfp_int_too_big;
+    }
+    decNumberToString(&rn, buf);
+
+    errno = 0;
+    if (is_signed)
+    {
+        long long v = strtoll(buf, NULL, 10);
+        *result = (uint64_t)v;
+        if (errno == ERANGE)
+            return neg ? dfp_int_too_small : dfp_int_too_big;
+    }
+    else
+    {
+        if (buf[0] == '-' && strcmp(buf, "-0") != 0)
+        {
+            *result = 0;
+            return dfp_int_too_small;
+        }
+        *result = strtoull(buf[0] == '-' ? buf + 1 : buf, NULL, 10);
+        if (errno == ERANGE)
+            return dfp_int_too_big;
+    }
+    decNumberCompare(&zero, &rn, &dn, &set);
+    return decNumberIsZero(&zero) ? dfp_int_exact : dfp_int_rounded;
+}
+
+static bool check(const stackf_t *a, enum rounding round)
+{
+    int64_t si;
+    uint64_t ui, ref;
+    dfp_int_status_enum st, ref_st;
+    char buf[DFP_STRING_MAX];
+
+    st = dfp_to_int64(a, round, &si);
+    ref_st = ref_convert(a, round, true, &ref);
+    if (st != ref_st || (uint64_t)si != ref)
+    {
+        dfp_to_string(a, buf);
+        printf("FAIL int64 %s round %d: got %" PRId64 " (%d) expected %"
+               PRId64 " (%d)\n", buf, round, si, st, (int64_t)ref, ref_st);
+        return false;
+    }
+    st = dfp_to_uint64(a, round, &ui);
+    ref_st = ref_convert(a, round, false, &ref);
+    if (st != ref_st || ui != ref)
+    {
+        dfp_to_string(a, buf);
+        printf("FAIL uint64 %s round %d: got %" PRIu64 " (%d) expected %"
+               PRIu64 " (%d)\n", buf, round, ui, st, ref, ref_st);
+        return false;
+    }
+    return true;
+}
+
+static bool check_all_rounding(const char *text)
+{
+    stackf_t a;
+    dfp_from_string(&a, text, &dfp_context);
+    for (int r = 0; r < (int)(sizeof(round_modes) / sizeof(round_modes[0])); r++)
+    {
+        if (!check(&a, round_modes[r]))
+            return false;
+    }
+    return true;
+}
+
+static bool test_fixed(void)
+{
+    static const char *tests[] =
+    {
+        "0", "-0", "0.5", "-0.5", "1.5", "2.5", "-2.5", "0.49999", "0.50001",
+        "1E-6176", "-1E-6176", "9.5", "15", "25.5", "1E+2", "1.00E+2",
+        "123456789012345678901234567890.5",
+        "9223372036854775807", "9223372036854775807.4",
+        "9223372036854775807.5", "9223372036854775808",
+        "-9223372036854775808", "-9223372036854775808.4",
+        "-9223372036854775808.5", "-9223372036854775809",
+        "18446744073709551615", "18446744073709551615.5",
+        "18446744073709551615.49999999999", "18446744073709551616",
+        "1.8446744073709551615E+19", "1.8446744073709551616E+19",
+        "1E+19", "1E+20", "9.999999999999999999999999999999999E+6144",
+        "-1E+19", "0E+100", "-0E-100",
+        "Inf", "-Inf", "NaN", "-NaN", "sNaN",
+    };
+
+    for (int i = 0; i < (int)(sizeof(tests) / sizeof(tests[0])); i++)
+    {
+        if (!check_all_rounding(tests[i]))
+            return false;
+    }
+    printf("fixed OK\n");
+    return true;
+}
+
+static bool test_random(void)
+{
+    for (int i = 0; i < NUM_RANDOM; i++)
+    {
+        char text[80];
+        int digits = rng_range(1, 34);
+        int len = 0;
+
+        if (rng() & 1)
+            text[len++] = '-';
+        for (int d = 0; d < digits; d++)
+            text[len++] = (char)('0' + rng_range(0, 9));
+        /* mostly values around the 64 bit range */
+        sprintf(&text[len], "E%d", rng_range(-digits - 3, 21 - digits));
+        if (!check_all_rounding(text))
+            return false;
+    }
+    printf("random OK\n");
+    return true;
+}
+
+/* plain decimal text to 128 bits, false if it doesn't fit */
+static bool text_to_u128(const char *buf, calc_int_t *result)
+{
+    calc_int_t m = 0;
+    for (; *buf; buf++)
+    {
+        if (m > (CALC_INT_MAX - (calc_int_t)(*buf - '0')) / 10)
+            return false;
+        m = m * 10 + (calc_int_t)(*buf - '0');
+    }
+    *result = m;
+    return true;
+}
+
+static void u128_to_text(char *buf, calc_int_t u)
+{
+    char tmp[50];
+    int n = 0;
+    do
+    {
+        tmp[n++] = (char)('0' + (int)(u % 10));
+        u /= 10;
+    } while (u);
+    while (n)
+        *buf++ = tmp[--n];
+    *buf = 0;
+}
+
+static dfp_int_status_enum ref_convert128(const stackf_t *a, enum rounding round,
+                                          bool is_signed, calc_int_t *result)
+{
+    decNumber dn, rn, zero;
+    decContext set;
+    char buf[100];
+    bool neg;
+    calc_int_t mag;
+    calc_int_t max_pos = is_signed ? (calc_int_t)CALC_SINT_MAX : CALC_INT_MAX;
+    calc_int_t max_neg = is_signed ? (calc_int_t)CALC_SINT_MAX + 1 : 0;
+    calc_int_t min_val = is_signed ? (calc_int_t)CALC_SINT_MIN : 0;
+
+    if (dfp_is_nan(a))
+    {
+        *result = 0;
+        return dfp_int_nan;
+    }
+    neg = dfp_get_coefficient(a, (uint8_t[DECQUAD_Pmax]){ 0 }) != 0;
+
+    decContextDefault(&set, DEC_INIT_BASE);
+    set.traps = 0;
+    set.digits = 64;
+    set.emax = 999;
+    set.emin = -999;
+    set.round = round;
+    dfp_to_number(a, &dn);
+    decNumberToIntegralValue(&rn, &dn, &set);
+    decNumberZero(&zero);
+    decNumberQuantize(&rn, &rn, &zero, &set);
+    decNumberToString(&rn, buf);
+
+    if (dfp_is_infinite(a) || decNumberIsNaN(&rn)
+        || !text_to_u128(buf[0] == '-' ? buf + 1 : buf, &mag)
+        || (buf[0] == '-' && mag > max_neg) || (buf[0] != '-' && mag > max_pos))
+    {
+        *result = neg ? min_val : max_pos;
+        return neg ? dfp_int_too_small : dfp_int_too_big;
+    }
+    *result = buf[0] == '-' ? -mag : mag;
+    decNumberCompare(&zero, &rn, &dn, &set);
+    return decNumberIsZero(&zero) ? dfp_int_exact : dfp_int_rounded;
+}
+
+static bool check128(const char *text)
+{
+    stackf_t a;
+    calc_sint_t si;
+    calc_int_t ui, ref;
+    dfp_int_status_enum st, ref_st;
+
+    dfp_from_string(&a, text, &dfp_context);
+    for (int r = 0; r < (int)(sizeof(round_modes) / sizeof(round_modes[0])); r++)
+    {
+        st = dfp_to_int128(&a, round_modes[r], &si);
+        ref_st = ref_convert128(&a, round_modes[r], true, &ref);
+        if (st != ref_st || (calc_int_t)si != ref)
+        {
+            printf("FAIL int128 %s round %d: (%d) expected (%d)\n",
+                   text, round_modes[r], st, ref_st);
+            return false;
+        }
+        st = dfp_to_uint128(&a, round_modes[r], &ui);
+        ref_st = ref_convert128(&a, round_modes[r], false, &ref);
+        if (st != ref_st || ui != ref)
+        {
+            printf("FAIL uint128 %s round %d: (%d) expected (%d)\n",
+                   text, round_modes[r], st, ref_st);
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool test_128(void)
+{
+    static const char *tests[] =
+    {
+        "0", "-0.5", "2.5", "-2.5",
+        "170141183460469231731687303715884105727",
+        "1.70141183460469231731687303715884E+38",
+        "1.701411834604692317316873037158842E+38",
+        "-1.701411834604692317316873037158841E+38",
+        "-1.701411834604692317316873037158842E+38",
+        "340282366920938463463374607431768211455",
+        "3.402823669209384634633746074317682E+38",
+        "3.402823669209384634633746074317683E+38",
+        "1E+38", "1E+39", "-1E+39", "Inf", "-Inf", "NaN",
+    };
+
+    for (int i = 0; i < (int)(sizeof(tests) / sizeof(tests[0])); i++)
+    {
+        if (!check128(tests[i]))
+            return false;
+    }
+    for (int i = 0; i < NUM_RANDOM / 10; i++)
+    {
+        char text[80];
+        int digits = rng_range(1, 34);
+        int len = 0;
+
+        if (rng() & 1)
+            text[len++] = '-';
+        for (int d = 0; d < digits; d++)
+            text[len++] = (char)('0' + rng_range(0, 9));
+        /* mostly values around the 128 bit range */
+        sprintf(&text[len], "E%d", rng_range(-digits - 3, 40 - digits));
+        if (!check128(text))
+            return false;
+    }
+
+    for (int i = 0; i < NUM_RANDOM; i++)
+    {
+        calc_int_t u = (((calc_int_t)rng() << 64) | rng()) >> rng_range(0, 127);
+        calc_sint_t si = (calc_sint_t)((((calc_int_t)rng() << 64) | rng()) >> rng_range(1, 127));
+        stackf_t a, b;
+        char text[50];
+
+        if (i == 0)
+        {
+            u = CALC_INT_MAX;
+            si = CALC_SINT_MIN;
+        }
+        else if (rng() & 1)
+        {
+            si = -si;
+        }
+
+        /* the same rounding as from the text */
+        dfp_from_uint128(&a, u);
+        u128_to_text(text, u);
+        dfp_from_string(&b, text, &dfp_context);
+        if (memcmp(&a, &b, sizeof(a)) != 0)
+        {
+            printf("FAIL from uint128 %s\n", text);
+            return false;
+        }
+
+        dfp_from_int128(&a, si);
+        text[0] = '-';
+        u128_to_text(si < 0 ? text + 1 : text, si < 0 ? -(calc_int_t)si : (calc_int_t)si);
+        dfp_from_string(&b, text, &dfp_context);
+        if (memcmp(&a, &b, sizeof(a)) != 0)
+        {
+            printf("FAIL from int128 %s\n", text);
+            return false;
+        }
+    }
+    printf("128 OK\n");
+    return true;
+}
+
+static bool test_from(void)
+{
+    for (int i = 0; i < NUM_RANDOM; i++)
+    {
+        uint64_t u = rng() >> rng_range(0, 63);
+        int64_t si = (int64_t)(rng() >> rng_range(0, 63));
+        stackf_t a, b;
+        char text[30];
+        uint64_t ub;
+        int64_t sb;
+
+        if (i == 0)
+        {
+            u = UINT64_MAX;
+            si = INT64_MIN;
+        }
+        else if (rng() & 1)
+        {
+            si = -si;
+        }
+
+        dfp_from_uint64(&a, u);
+        sprintf(text, "%" PRIu64, u);
+        dfp_from_string(&b, text, &dfp_context);
+        if (memcmp(&a, &b, sizeof(a)) != 0
+            || dfp_to_uint64(&a, DEC_ROUND_DOWN, &ub) != dfp_int_exact
+            || ub != u)
+        {
+            printf("FAIL from uint64 %s\n", text);
+            return false;
+        }
+
+        dfp_from_int64(&a, si);
+        sprintf(text, "%" PRId64, si);
+        dfp_from_string(&b, text, &dfp_context);
+        if (memcmp(&a, &b, sizeof(a)) != 0
+            || dfp_to_int64(&a, DEC_ROUND_DOWN, &sb) != dfp_int_exact
+            || sb != si)
+        {
+            printf("FAIL from int64 %s\n", text);
+            return false;
+        }
+    }
+    printf("from OK\n");
+    return true;
+}
+
+int main(void)
+{
+    bool ok;
+
+    decContextDefault(&dfp_context, DEC_INIT_DECQUAD);
+    ok = test_fixed() && test_random() && test_from() && test_128();
+
+    if (ok)
+        printf("all tests OK\n");
+    else
+        printf("************* FAIL ***************\n");
+
+    return 0;
+}
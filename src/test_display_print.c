@@ -6,8 +6,7 @@
 #include "display_print.h"
 #include "calc_types.h"
 
-/* For testing functions display_print_emode and display_print_gmode
- * from display_print.c */
+/* For testing the display_print_ functions from display_print.c */
 
 
 decContext dfp_context;
@@ -44,6 +43,13 @@ static const test_t emode_tests[] =
     {"-0.0012345678", 6, "-1.23457e-3"},
     {"9999999", 6, "1e+7"},
     {"2.2222222222222e100", 6, "2.22222e+100"},
+    {"-0.000099999", 4, "-1e-4"},
+    {"99.95", 3, "1e+2"},
+    {"9.99e6144", 2, "1e+6145"},
+    {"1234567890123456789012345678901234", 34, "1.234567890123456789012345678901234e+33"},
+    {"0E+3", 8, "0e+3"},
+    {"-Infinity", 8, "-Infinity"},
+    {"NaN", 8, "NaN"},
 };
 
 
@@ -75,51 +81,270 @@ static const test_t gmode_tests[] =
     {"2.2222222222222e100", 6, "2.22222e+100"},
     {"1e9", 10, "1000000000"},
     {"-1e9", 10, "-1000000000"},
+    {"-0.000099999", 4, "-0.0001"},
+    {"0.00001234", 8, "1.234e-5"},
+    {"99.95", 3, "100"},
+    {"120", 2, "1.2e+2"},
+    {"1234567890123456789012345678901234", 34, "1234567890123456789012345678901234"},
+    {"0E+3", 8, "0e+3"},
+    {"-0", 8, "-0"},
+    {"-Infinity", 8, "-Infinity"},
 };
 
-static bool test_emode(void)
+static const test_t engmode_tests[] =
+{
+    {"0", 8, "0"},
+    {"123", 8, "123"},
+    {"1.5", 8, "1.5"},
+    {"12345", 8, "12.345e+3"},
+    {"-0.0012345678", 6, "-1.23457e-3"},
+    {"0.0001", 8, "100e-6"},
+    {"999999", 3, "1e+6"},
+    {"2.5e-10", 6, "250e-12"},
+    {"1e100", 6, "10e+99"},
+    {"Infinity", 8, "Infinity"},
+};
+
+
+static const test_t si_tests[] =
+{
+    {"123", 6, "123"},
+    {"1000", 6, "1k"},
+    {"12345", 8, "12.345k"},
+    {"999.9999", 4, "1k"},
+    {"0.000047", 6, "47u"},
+    {"-3.3e-9", 6, "-3.3n"},
+    {"1.5e30", 6, "1.5Q"},
+    {"2e-30", 6, "2q"},
+    {"4.7e33", 6, "4.7e+33"},
+};
+
+
+typedef struct
+{
+    char *val;
+    int places;
+    char *expected;
+} fixed_test_t;
+
+/* all with 10 digits */
+static const fixed_test_t fixed_tests[] =
+{
+    {"3.14159", 2, "3.14"},
+    {"2.675", 2, "2.68"},
+    {"-42", 3, "-42.000"},
+    {"99.999", 2, "100.00"},
+    {"12345.6", 0, "12346"},
+    {"0.005", 2, "0.01"},
+    {"0.0049", 2, "0.00"},
+    {"-0.001", 2, "0.00"},
+    {"0", 3, "0.000"},
+    {"-0E+5", 2, "0.00"},
+    {"1e15", 2, "1e+15"},
+    {"NaN", 2, "NaN"},
+};
+
+
+/* value shown by fixed, as display_get_best_integer takes it, NULL where
+ * fixed falls back to gmode, all with 10 digits */
+static const fixed_test_t fixed_value_tests[] =
+{
+    {"79.996", 2, "80"},
+    {"-79.994", 2, "-79.99"},
+    {"12345.6", 0, "12346"},
+    {"0.005", 2, "0.01"},
+    {"-0.001", 2, "0"},
+    {"0", 3, "0"},
+    {"1e15", 2, NULL},
+};
+
+
+/* with grouping enabled */
+static const test_t grouped_gmode_tests[] =
+{
+    {"123", 10, "123"},
+    {"1234567", 10, "1,234,567"},
+    {"-1234.5", 10, "-1,234.5"},
+    {"1234567", 6, "1.23457e+6"},
+    /* too long to group */
+    {"1234567890123456789012345678901234", 34, "1234567890123456789012345678901234"},
+};
+
+
+static bool run_tests(const char *name, const test_t *tests, int num_tests,
+                      void (*print)(char *, stackf_t, int))
 {
     stackf_t fval;
     char buf[DFP_STRING_MAX];
     bool ok = true;
 
-    for (unsigned int i = 0; i < sizeof(emode_tests) / sizeof(emode_tests[0]); i++)
+    for (int i = 0; i < num_tests; i++)
     {
-        dfp_from_string(&fval, emode_tests[i].val, &dfp_context);
+        dfp_from_string(&fval, tests[i].val, &dfp_context);
 #if 0
         dfp_to_string(&fval, buf);
         printf("orig %s\n", buf);
 #endif
-        display_print_emode(buf, fval, emode_tests[i].digits);
-        if (strcmp(buf, emode_tests[i].expected) != 0)
+        print(buf, fval, tests[i].digits);
+        if (strcmp(buf, tests[i].expected) != 0)
         {
-            printf("emode FAIL: got %s  expected %s\n", buf, emode_tests[i].expected);
+            printf("%s FAIL: got %s  expected %s\n", name, buf, tests[i].expected);
             ok = false;
         }
     }
     return ok;
 }
 
-static bool test_gmode(void)
+#define RUN_TESTS(name, tests, print) \
+    run_tests(name, tests, sizeof(tests) / sizeof(tests[0]), print)
+
+static bool test_fixed(void)
 {
     stackf_t fval;
     char buf[DFP_STRING_MAX];
     bool ok = true;
 
-    for (unsigned int i = 0; i < sizeof(gmode_tests) / sizeof(gmode_tests[0]); i++)
+    for (unsigned int i = 0; i < sizeof(fixed_tests) / sizeof(fixed_tests[0]); i++)
     {
-        dfp_from_string(&fval, gmode_tests[i].val, &dfp_context);
-#if 0
-        dfp_to_string(&fval, buf);
-        printf("orig %s\n", buf);
-#endif
-        display_print_gmode(buf, fval, gmode_tests[i].digits);
-        if (strcmp(buf, gmode_tests[i].expected) != 0)
+        dfp_from_string(&fval, fixed_tests[i].val, &dfp_context);
+        display_print_fixed(buf, fval, fixed_tests[i].places, 10);
+        if (strcmp(buf, fixed_tests[i].expected) != 0)
+        {
+            printf("fixed FAIL: got %s  expected %s\n", buf, fixed_tests[i].expected);
+            ok = false;
+        }
+    }
+
+    /* grouping */
+    display_print_set_grouping(true);
+    dfp_from_string(&fval, "1234567.891", &dfp_context);
+    display_print_fixed(buf, fval, 2, 10);
+    if (strcmp(buf, "1,234,567.89") != 0)
+    {
+        printf("fixed FAIL: got %s  expected 1,234,567.89\n", buf);
+        ok = false;
+    }
+    display_print_set_grouping(false);
+    return ok;
+}
+
+static bool test_fixed_value(void)
+{
+    stackf_t fval, res, expected;
+    decQuad cmp;
+    bool ok = true;
+
+    for (unsigned int i = 0;
+         i < sizeof(fixed_value_tests) / sizeof(fixed_value_tests[0]); i++)
+    {
+        const fixed_test_t *t = &fixed_value_tests[i];
+        bool shown;
+
+        dfp_from_string(&fval, t->val, &dfp_context);
+        shown = display_print_fixed_value(&res, fval, t->places, 10);
+        if (t->expected == NULL)
+        {
+            if (shown)
+            {
+                printf("fixed value FAIL: %s expected gmode\n", t->val);
+                ok = false;
+            }
+            continue;
+        }
+        dfp_from_string(&expected, t->expected, &dfp_context);
+        dfp_compare(&cmp, &res, &expected, &dfp_context);
+        if (!shown || !dfp_is_zero(&cmp))
+        {
+            char buf[DFP_STRING_MAX];
+            dfp_to_string(&res, buf);
+            printf("fixed value FAIL: %s got %s  expected %s\n", t->val, buf,
+                   t->expected);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+static bool test_grouping(void)
+{
+    bool ok;
+
+    display_print_set_grouping(true);
+    ok = RUN_TESTS("grouped gmode", grouped_gmode_tests, display_print_gmode);
+    display_print_set_grouping(false);
+    return ok;
+}
+
+/* display text copied to the clipboard must paste back as the same value,
+ * display_print_unformat is what the paste uses */
+typedef struct
+{
+    char *val;
+    char mode;          /* g grouped gmode, f grouped fixed 2 places, s SI */
+    char *expected;     /* the value after the paste */
+} paste_test_t;
+
+static const paste_test_t paste_tests[] =
+{
+    {"1234567", 'g', "1234567"},
+    {"-1234.5", 'g', "-1234.5"},
+    {"1234567.891", 'f', "1234567.89"},
+    {"12345", 's', "12345"},
+    {"0.000047", 's', "0.000047"},
+    {"-3.3e-9", 's', "-3.3e-9"},
+    {"1.5e18", 's', "1.5e18"},
+    {"4.7e33", 's', "4.7e33"},
+    {"123", 's', "123"},
+};
+
+static bool test_paste_back(void)
+{
+    stackf_t fval, res, expected;
+    char buf[DFP_STRING_MAX];
+    char plain[DFP_STRING_MAX];
+    decQuad cmp;
+    bool ok = true;
+
+    for (unsigned int i = 0; i < sizeof(paste_tests) / sizeof(paste_tests[0]); i++)
+    {
+        const paste_test_t *t = &paste_tests[i];
+
+        dfp_from_string(&fval, t->val, &dfp_context);
+        display_print_set_grouping(t->mode != 's');
+        if (t->mode == 'g')
+            display_print_gmode(buf, fval, 10);
+        else if (t->mode == 'f')
+            display_print_fixed(buf, fval, 2, 10);
+        else
+            display_print_si(buf, fval, 8);
+        display_print_set_grouping(false);
+
+        display_print_unformat(plain, buf);
+        dfp_from_string(&res, plain, &dfp_context);
+        dfp_from_string(&expected, t->expected, &dfp_context);
+        dfp_compare(&cmp, &res, &expected, &dfp_context);
+        if (!dfp_is_zero(&cmp))
         {
-            printf("gmode FAIL: got %s  expected %s\n", buf, gmode_tests[i].expected);
+            printf("paste back FAIL: %s copied as %s pasted as %s\n", t->val,
+                   buf, plain);
             ok = false;
         }
     }
+
+    /* text from elsewhere, stops at the first character that isn't part of
+     * the value */
+    display_print_unformat(plain, "  1.5e3 apples");
+    if (strcmp(plain, "1.5e3") != 0)
+    {
+        printf("paste FAIL: got %s  expected 1.5e3\n", plain);
+        ok = false;
+    }
+    display_print_unformat(plain, "2,5");
+    if (strcmp(plain, "2") != 0)
+    {
+        printf("paste FAIL: got %s  expected 2\n", plain);
+        ok = false;
+    }
     return ok;
 }
 
@@ -127,7 +352,14 @@ int main(void)
 {
     decContextDefault(&dfp_context, DEC_INIT_DECQUAD);
 
-    bool ok = test_emode() && test_gmode();
+    bool ok = RUN_TESTS("emode", emode_tests, display_print_emode)
+              && RUN_TESTS("gmode", gmode_tests, display_print_gmode)
+              && RUN_TESTS("engmode", engmode_tests, display_print_engmode)
+              && RUN_TESTS("si", si_tests, display_print_si)
+              && test_fixed()
+              && test_fixed_value()
+              && test_grouping()
+              && test_paste_back();
 
     if (ok)
         printf("all tests OK\n");
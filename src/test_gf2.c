@@ -0,0 +1,184 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "gf2.h"
+
+/* For testing the gf2_ functions from gf2.c, against bit at a time
+ * versions, with the instruction and with the portable code. */
+
+typedef unsigned __int128 u128;
+
+static int fails;
+
+static void naive_clmul(u128 a, u128 b, u128 *lo, u128 *hi)
+{
+    *lo = 0;
+    *hi = 0;
+    for (int i = 0; i < 128; i++)
+    {
+        if ((b >> i) & 1)
+        {
+            *lo ^= a << i;
+            if (i > 0)
+            {
+                *hi ^= a >> (128 - i);
+            }
+        }
+    }
+}
+
+/* remainder, one bit at a time from the top */
+static u128 naive_mod(u128 a, u128 m)
+{
+    int dm = 127;
+    while (((m >> dm) & 1) == 0)
+    {
+        dm--;
+    }
+    for (int i = 127; i >= dm; i--)
+    {
+        if ((a >> i) & 1)
+        {
+            a ^= m << (i - dm);
+        }
+    }
+    return a;
+}
+
+static void print_hex(u128 x)
+{
+    printf("%016llx%016llx", (unsigned long long)(x >> 64),
+           (unsigned long long)x);
+}
+
+static void fail2(const char *name, u128 a, u128 b, u128 got, u128 expected)
+{
+    printf("FAIL %s ", name);
+    print_hex(a);
+    printf(" ");
+    print_hex(b);
+    printf(" got ");
+    print_hex(got);
+    printf(" expected ");
+    print_hex(expected);
+    printf("\n");
+    fails++;
+}
+
+static u128 rand_u128(void)
+{
+    u128 x = 0;
+    for (int i = 0; i < 8; i++)
+    {
+        x = (x << 16) | (u128)(rand() & 0xffff);
+    }
+    return x;
+}
+
+static void test_pair(u128 a, u128 b)
+{
+    u128 lo, hi, elo, ehi;
+
+    gf2_clmul(a, b, &lo, &hi);
+    naive_clmul(a, b, &elo, &ehi);
+    if (lo != elo)
+    {
+        fail2("clmul lo", a, b, lo, elo);
+    }
+    if (hi != ehi)
+    {
+        fail2("clmul hi", a, b, hi, ehi);
+    }
+
+    if (b != 0 && gf2_mod(a, b) != naive_mod(a, b))
+    {
+        fail2("mod", a, b, gf2_mod(a, b), naive_mod(a, b));
+    }
+}
+
+/* gcd of p q and p r is p times the gcd of q and r */
+static void test_gcd(u128 p, u128 q, u128 r)
+{
+    u128 lo, hi;
+    u128 pq, pr, g;
+
+    gf2_clmul(p, q, &pq, &hi);
+    gf2_clmul(p, r, &pr, &hi);
+    g = gf2_gcd(q, r);
+    gf2_clmul(p, g, &lo, &hi);
+    if (gf2_gcd(pq, pr) != lo)
+    {
+        fail2("gcd", pq, pr, gf2_gcd(pq, pr), lo);
+    }
+    /* and the gcd divides both */
+    if (g != 0 && (gf2_mod(q, g) != 0 || gf2_mod(r, g) != 0))
+    {
+        fail2("gcd divides", q, r, g, 0);
+    }
+}
+
+static void test_all(void)
+{
+    test_pair(0, 0);
+    test_pair(~(u128)0, ~(u128)0);
+    for (int i = 0; i < 128; i++)
+    {
+        test_pair(~(u128)0, (u128)1 << i);
+        test_pair((u128)1 << i, ~(u128)0 >> i);
+    }
+    for (int i = 0; i < 100000; i++)
+    {
+        u128 a = rand_u128();
+        u128 b = rand_u128();
+        test_pair(a, b);
+        test_pair(a, b >> (rand() % 128));
+        test_pair(a >> (rand() % 128), b >> (rand() % 128));
+    }
+
+    /* known: x^8 + x^4 + x^3 + x + 1 (AES) is irreducible, so coprime to
+     * anything of lower degree but 0 */
+    for (u128 a = 1; a < 0x100; a++)
+    {
+        if (gf2_gcd(0x11b, a) != 1)
+        {
+            fail2("gcd aes", 0x11b, a, gf2_gcd(0x11b, a), 1);
+        }
+    }
+    /* x^2 + 1 = (x + 1)^2 */
+    if (gf2_gcd(0x5, 0x3) != 0x3)
+    {
+        fail2("gcd", 0x5, 0x3, gf2_gcd(0x5, 0x3), 0x3);
+    }
+    for (int i = 0; i < 10000; i++)
+    {
+        test_gcd(rand_u128() >> 88, rand_u128() >> 88, rand_u128() >> 88);
+    }
+}
+
+int main(void)
+{
+    srand(1);
+    printf("PCLMULQDQ %s\n", gf2_using_hardware() ? "used" : "not there");
+    test_all();
+
+    gf2_use_hardware(false);
+    if (gf2_using_hardware())
+    {
+        printf("FAIL still using PCLMULQDQ\n");
+        fails++;
+    }
+    test_all();
+    gf2_use_hardware(true);
+
+    if (fails == 0)
+    {
+        printf("All tests passed\n");
+    }
+    else
+    {
+        printf("%d tests failed\n", fails);
+    }
+    return fails == 0 ? 0 : 1;
+}
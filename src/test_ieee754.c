@@ -0,0 +1,285 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ieee754.h"
+
+/* For testing the ieee_ conversions from ieee754.c, against the C
+ * library's correctly rounded strtod/strtof and exact printf, plus
+ * known values and the edge cases around subnormals and overflow. */
+
+decContext dfp_context;
+
+static int fails;
+
+static uint64_t rand64(void)
+{
+    uint64_t x = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        x = (x << 16) | (uint64_t)(rand() & 0xffff);
+    }
+    return x;
+}
+
+/* the same value, ignoring the exponent of the decimal (eg. 1.0 = 1)
+ * but not the sign of 0 */
+static bool dfp_equal(const stackf_t *a, const stackf_t *b)
+{
+    stackf_t c;
+
+    if (dfp_is_nan(a) || dfp_is_nan(b))
+        return dfp_is_nan(a) && dfp_is_nan(b);
+    dfp_compare(&c, a, b, &dfp_context);
+    return dfp_is_zero(&c) && dfp_is_negative(a) == dfp_is_negative(b);
+}
+
+static void check_encode(ieee_format_enum f, const char *text,
+                         calc_int_t expect, const char *expect_err)
+{
+    stackf_t x, err, e;
+    char s[DFP_STRING_MAX];
+
+    dfp_from_string(&x, text, &dfp_context);
+    calc_int_t bits = ieee_from_dfp(f, &x, &err);
+    if (bits != expect)
+    {
+        printf("FAIL %s %s gave 0x%llx\n", ieee_get_format(f)->name, text,
+               (unsigned long long)bits);
+        fails++;
+    }
+    if (expect_err != NULL)
+    {
+        dfp_from_string(&e, expect_err, &dfp_context);
+        if (!dfp_equal(&err, &e))
+        {
+            dfp_to_string(&err, s);
+            printf("FAIL %s %s error %s expected %s\n",
+                   ieee_get_format(f)->name, text, s, expect_err);
+            fails++;
+        }
+    }
+}
+
+static void check_decode(ieee_format_enum f, calc_int_t bits,
+                         const char *expect)
+{
+    stackf_t r, e;
+    char s[DFP_STRING_MAX];
+
+    ieee_to_dfp(f, bits, &r);
+    dfp_from_string(&e, expect, &dfp_context);
+    if (!dfp_equal(&r, &e))
+    {
+        dfp_to_string(&r, s);
+        printf("FAIL %s 0x%llx gave %s expected %s\n", ieee_get_format(f)->name,
+               (unsigned long long)bits, s, expect);
+        fails++;
+    }
+}
+
+static void test_known(void)
+{
+    calc_int_t one128 = (calc_int_t)0x3fff << 112;
+
+    check_encode(ieee_binary16, "1", 0x3c00, "0");
+    check_encode(ieee_bfloat16, "1", 0x3f80, "0");
+    check_encode(ieee_binary32, "1", 0x3f800000, "0");
+    check_encode(ieee_binary64, "1", 0x3ff0000000000000, "0");
+    check_encode(ieee_binary128, "1", one128, "0");
+    check_encode(ieee_binary128, "-1.5", one128 | (calc_int_t)1 << 127 |
+                 (calc_int_t)1 << 111, "0");
+
+    /* 0x3dcccccd is 0.100000001490116119384765625, 0.2 ulp above */
+    check_encode(ieee_binary32, "0.1", 0x3dcccccd, "0.2");
+    check_encode(ieee_binary32, "-0.1", 0xbdcccccd, "-0.2");
+    check_encode(ieee_binary64, "0.1", 0x3fb999999999999a, "0.4");
+    check_encode(ieee_bfloat16, "0.333333333333333333333333333333333",
+                 0x3eab, NULL);
+    check_encode(ieee_binary16, "-0", 0x8000, "0");
+
+    /* largest half, and the halfway point above it rounds to even which
+     * is the next power of 2, so infinity */
+    check_encode(ieee_binary16, "65504", 0x7bff, "0");
+    check_encode(ieee_binary16, "65519.99", 0x7bff, NULL);
+    check_encode(ieee_binary16, "65520", 0x7c00, "Inf");
+    check_encode(ieee_binary16, "-1e100", 0xfc00, "-Inf");
+    check_encode(ieee_binary32, "1e6144", 0x7f800000, "Inf");
+
+    /* smallest subnormal half is 2^-24, half of it is a tie to 0 */
+    check_encode(ieee_binary16, "5.9604644775390625E-8", 0x0001, "0");
+    check_encode(ieee_binary16, "2.98023223876953125E-8", 0x0000, "-0.5");
+    check_encode(ieee_binary16, "2.98023223876953126E-8", 0x0001, NULL);
+    check_encode(ieee_binary16, "8.94069671630859375E-8", 0x0002, "0.5");
+    check_encode(ieee_binary64, "4.9406564584124654E-324", 1, NULL);
+    check_encode(ieee_binary64, "2.4703282292062327E-324", 0, NULL);
+    check_encode(ieee_binary64, "2.4703282292062328E-324", 1, NULL);
+    check_encode(ieee_binary128, "1e-6000", 0, NULL);
+    /* the largest subnormal rounding up to the smallest normal */
+    check_encode(ieee_binary32, "1.1754943e-38", 0x00800000, NULL);
+
+    check_encode(ieee_binary32, "Inf", 0x7f800000, "0");
+    check_encode(ieee_binary32, "-Inf", 0xff800000, "0");
+    check_encode(ieee_binary32, "NaN", 0x7fc00000, "NaN");
+
+    check_decode(ieee_binary16, 0x3c00, "1");
+    check_decode(ieee_binary16, 0x7bff, "65504");
+    check_decode(ieee_binary16, 0x0001, "5.9604644775390625E-8");
+    check_decode(ieee_binary16, 0x8000, "-0");
+    check_decode(ieee_binary16, 0x7c00, "Inf");
+    check_decode(ieee_binary16, 0xfc00, "-Inf");
+    check_decode(ieee_binary16, 0x7e00, "NaN");
+    check_decode(ieee_bfloat16, 0x4049, "3.140625");
+    check_decode(ieee_binary32, 0x3dcccccd, "0.100000001490116119384765625");
+    check_decode(ieee_binary64, 0x3fb999999999999a,
+                 "0.1000000000000000055511151231257827");
+    check_decode(ieee_binary128, one128, "1");
+    /* largest binary128, (2 - 2^-112) * 2^16383 */
+    check_decode(ieee_binary128, ((calc_int_t)0x7ffe << 112) |
+                 (((calc_int_t)1 << 112) - 1),
+                 "1.189731495357231765085759326628007E+4932");
+    /* smallest binary128 subnormal, 2^-16494 */
+    check_decode(ieee_binary128, 1, "6.475175119438025110924438958227647E-4966");
+
+    ieee_fields_t fields;
+    ieee_decode(ieee_binary32, 0xc0490fdb, &fields);
+    if (fields.cls != ieee_normal || !fields.sign || fields.biased_exp != 128 ||
+        fields.exp != 1 || fields.mant != 0x490fdb)
+    {
+        printf("FAIL decode fields of -pi\n");
+        fails++;
+    }
+    ieee_decode(ieee_binary64, 1, &fields);
+    if (fields.cls != ieee_subnormal || fields.exp != -1022)
+    {
+        printf("FAIL decode fields of double subnormal\n");
+        fails++;
+    }
+}
+
+/* random bit patterns, decoded exactly by printf then rounded to decQuad,
+ * and back (34 digits is enough to get a double back) */
+static void test_random_double(void)
+{
+    char text[1200];
+    stackf_t r, e, err;
+
+    for (int i = 0; i < 20000; i++)
+    {
+        uint64_t bits = rand64();
+        double d;
+
+        memcpy(&d, &bits, sizeof(d));
+        if (d != d)
+            continue;
+        ieee_to_dfp(ieee_binary64, bits, &r);
+        snprintf(text, sizeof(text), "%.1100e", d);
+        dfp_from_string(&e, text, &dfp_context);
+        if (!dfp_equal(&r, &e))
+        {
+            printf("FAIL decode double 0x%llx\n", (unsigned long long)bits);
+            fails++;
+        }
+        calc_int_t back = ieee_from_dfp(ieee_binary64, &r, &err);
+        if (back != bits)
+        {
+            printf("FAIL double 0x%llx back as 0x%llx\n",
+                   (unsigned long long)bits, (unsigned long long)back);
+            fails++;
+        }
+    }
+}
+
+/* every 16 bit pattern there is, to decQuad and back */
+static void test_all_16(void)
+{
+    stackf_t r, err;
+
+    for (int f = ieee_binary16; f <= ieee_bfloat16; f++)
+    {
+        for (calc_int_t bits = 0; bits < 0x10000; bits++)
+        {
+            ieee_fields_t fields;
+            ieee_decode(f, bits, &fields);
+            if (fields.cls == ieee_nan)
+                continue;
+            ieee_to_dfp(f, bits, &r);
+            if (ieee_from_dfp(f, &r, &err) != bits)
+            {
+                printf("FAIL %s 0x%x\n", ieee_get_format(f)->name,
+                       (unsigned)bits);
+                fails++;
+            }
+        }
+    }
+}
+
+/* random decimals with up to 34 digits, against strtod and strtof */
+static void test_random_decimal(void)
+{
+    char text[80];
+    stackf_t x, err;
+
+    for (int i = 0; i < 20000; i++)
+    {
+        int len = 0;
+        int digits = 1 + rand() % 34;
+        int exp = rand() % 700 - 350;
+
+        if (i % 4 == 0)
+        {
+            /* near the float range */
+            exp = rand() % 100 - 60;
+        }
+        if (rand() & 1)
+        {
+            text[len++] = '-';
+        }
+        for (int j = 0; j < digits; j++)
+        {
+            text[len++] = (char)('0' + rand() % 10);
+        }
+        snprintf(text + len, sizeof(text) - len, "e%d", exp);
+
+        dfp_from_string(&x, text, &dfp_context);
+        double d = strtod(text, NULL);
+        float fl = strtof(text, NULL);
+        uint64_t expect64;
+        uint32_t expect32;
+        memcpy(&expect64, &d, sizeof(d));
+        memcpy(&expect32, &fl, sizeof(fl));
+
+        if (ieee_from_dfp(ieee_binary64, &x, &err) != expect64)
+        {
+            printf("FAIL binary64 %s\n", text);
+            fails++;
+        }
+        if (ieee_from_dfp(ieee_binary32, &x, &err) != expect32)
+        {
+            printf("FAIL binary32 %s\n", text);
+            fails++;
+        }
+    }
+}
+
+int main(void)
+{
+    decContextDefault(&dfp_context, DEC_INIT_DECQUAD);
+    srand(1);
+    test_known();
+    test_all_16();
+    test_random_double();
+    test_random_decimal();
+
+    if (fails == 0)
+    {
+        printf("All tests passed\n");
+    }
+    else
+    {
+        printf("%d tests failed\n", fails);
+    }
+    return fails == 0 ? 0 : 1;
+}
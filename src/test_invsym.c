@@ -0,0 +1,169 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "invsym.h"
+
+/* For testing the inverse symbolic lookup in invsym.c. The index is built
+ * with one thread and with several, which has to give the same index, then
+ * saved and mapped back in from the file. Known values have to come back
+ * as the expected expression first. */
+
+decContext dfp_context;
+
+static const char *INDEX_FILE = "test_invsym.idx";
+
+static int fails;
+
+static void check_lookup(const char *text, int digits, const char *expect)
+{
+    invsym_match_t m[8];
+    stackf_t x;
+    int num;
+
+    dfp_from_string(&x, text, &dfp_context);
+    num = invsym_lookup(&x, digits, m, 8);
+    if (num == 0 || strcmp(m[0].text, expect) != 0)
+    {
+        printf("FAIL lookup %s to %d digits, expect %s got %s\n", text, digits,
+               expect, num == 0 ? "nothing" : m[0].text);
+        fails++;
+    }
+}
+
+static void check_not_found(const char *text, int digits)
+{
+    invsym_match_t m[8];
+    stackf_t x;
+    int num;
+
+    dfp_from_string(&x, text, &dfp_context);
+    num = invsym_lookup(&x, digits, m, 8);
+    if (num != 0)
+    {
+        printf("FAIL lookup %s to %d digits, expect nothing got %s\n", text,
+               digits, m[0].text);
+        fails++;
+    }
+}
+
+/* the matches simplest first, each within 10^-digits of x */
+static void check_matches(const char *text, int digits)
+{
+    invsym_match_t m[8];
+    stackf_t x, diff, tol, scale;
+    char buf[20];
+    decQuad cmp;
+    int num;
+
+    dfp_from_string(&x, text, &dfp_context);
+    sprintf(buf, "1E-%d", digits - 1);
+    dfp_from_string(&scale, buf, &dfp_context);
+    dfp_abs(&tol, &x, &dfp_context);
+    dfp_multiply(&tol, &tol, &scale, &dfp_context);
+    num = invsym_lookup(&x, digits, m, 8);
+    for (int i = 0; i < num; i++)
+    {
+        dfp_subtract(&diff, &m[i].value, &x, &dfp_context);
+        dfp_abs(&diff, &diff, &dfp_context);
+        dfp_compare(&cmp, &diff, &tol, &dfp_context);
+        if (!dfp_is_negative(&cmp) && !dfp_is_zero(&cmp))
+        {
+            printf("FAIL match %s for %s is too far away\n", m[i].text, text);
+            fails++;
+        }
+        if (i > 0 && m[i].complexity < m[i - 1].complexity)
+        {
+            printf("FAIL matches for %s out of order\n", text);
+            fails++;
+        }
+    }
+}
+
+static void test_known(void)
+{
+    check_lookup("2.4674011002723", 12, "pi^2 / 4");
+    check_lookup("2.467401100272339654708622749969038", 30, "pi^2 / 4");
+    check_lookup("1.618033988749894848204586834365638", 30, "phi");
+    check_lookup("23.14069263277926900572908636794855", 30, "e^pi");
+    check_lookup("2.414213562373095048801688724209698", 30, "1 + sqrt(2)");
+    check_lookup("2.356194490192344928846982537459627", 30, "3/4 pi");
+    check_lookup("-0.5772156649015328606065120900824024", 30, "-gamma");
+    check_lookup("0.1706521194376097578214335933218917", 30, "1 / (e + pi)");
+    check_lookup("1.259921049894873164767210607278228", 30, "cbrt(2)");
+    check_lookup("0.6931471805599453094172321214581766", 30, "ln(2)");
+    check_lookup("8.539734222673567065463550869546574", 30, "e * pi");
+    check_lookup("89875517873681764", 30, "c^2");
+    check_lookup("0.5", 30, "1 / 2");
+
+    /* close, but not to this many digits */
+    check_not_found("2.467401100273", 15);
+
+    check_matches("2.4674011002723", 12);
+    check_matches("7.389", 4);
+    check_matches("-1234.5678", 8);
+}
+
+int main(void)
+{
+    invsym_const_t user[] =
+    {
+        { "c", { { 0 } } },
+        { "bad", { { 0 } } },
+    };
+    bool built;
+    int size;
+
+    decContextDefault(&dfp_context, DEC_INIT_DECQUAD);
+    dfp_from_string(&user[0].value, "299792458", &dfp_context);
+    dfp_from_string(&user[1].value, "NaN", &dfp_context);
+    remove(INDEX_FILE);
+
+    /* one thread, kept in memory */
+    if (!invsym_open(NULL, user, 2, 1, &built) || !built)
+    {
+        printf("FAIL build with 1 thread\n");
+        fails++;
+    }
+    size = invsym_size();
+    printf("index of %d expressions\n", size);
+    test_known();
+
+    /* several threads, saved */
+    if (!invsym_open(INDEX_FILE, user, 2, 4, &built) || !built ||
+        invsym_size() != size)
+    {
+        printf("FAIL build with 4 threads, %d expressions\n", invsym_size());
+        fails++;
+    }
+    test_known();
+
+    /* mapped from the file */
+    if (!invsym_open(INDEX_FILE, user, 2, 4, &built) || built ||
+        invsym_size() != size)
+    {
+        printf("FAIL map the saved index\n");
+        fails++;
+    }
+    test_known();
+
+    /* other constants, so built again */
+    if (!invsym_open(INDEX_FILE, user, 0, 0, &built) || !built ||
+        invsym_size() >= size)
+    {
+        printf("FAIL rebuild for other constants\n");
+        fails++;
+    }
+    check_lookup("2.4674011002723", 12, "pi^2 / 4");
+
+    invsym_close();
+    remove(INDEX_FILE);
+
+    if (fails == 0)
+        printf("all passed\n");
+    else
+        printf("%d FAILED\n", fails);
+    return fails != 0;
+}
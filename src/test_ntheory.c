@@ -0,0 +1,490 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "ntheory.h"
+
+/* For testing the nt_ functions from ntheory.c, against trial division
+ * and other slow but obvious versions, plus known hard cases. */
+
+typedef unsigned __int128 u128;
+
+static int fails;
+
+static bool naive_is_prime(uint64_t n)
+{
+    if (n < 2)
+        return false;
+    for (uint64_t d = 2; d * d <= n; d++)
+    {
+        if (n % d == 0)
+            return false;
+    }
+    return true;
+}
+
+static u128 naive_gcd(u128 a, u128 b)
+{
+    while (b != 0)
+    {
+        u128 t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+static uint64_t rand64(void)
+{
+    uint64_t x = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        x = (x << 16) | (uint64_t)(rand() & 0xffff);
+    }
+    return x;
+}
+
+static u128 rand128(void)
+{
+    return ((u128)rand64() << 64) | rand64();
+}
+
+static void print_u128(u128 x)
+{
+    char buf[40];
+    int i = sizeof(buf) - 1;
+
+    buf[i] = '\0';
+    do
+    {
+        buf[--i] = (char)('0' + (int)(x % 10));
+        x /= 10;
+    } while (x != 0);
+    printf("%s", buf + i);
+}
+
+/* the factors multiply back to n, are prime and are in order */
+static bool check_factors(u128 n)
+{
+    u128 f[NT_MAX_FACTORS];
+    bool complete;
+    int num = nt_factor(n, f, &complete);
+    u128 prod = 1;
+
+    for (int i = 0; i < num; i++)
+    {
+        prod *= f[i];
+        if ((complete && !nt_is_prime(f[i])) || (i > 0 && f[i] < f[i - 1]))
+            return false;
+    }
+    return prod == n && complete;
+}
+
+static void test_small(void)
+{
+    u128 prime = 2;
+
+    for (uint64_t n = 0; n < 200000; n++)
+    {
+        if (nt_is_prime(n) != naive_is_prime(n))
+        {
+            printf("FAIL is_prime %llu\n", (unsigned long long)n);
+            fails++;
+        }
+        if (n > 1 && !check_factors(n))
+        {
+            printf("FAIL factor %llu\n", (unsigned long long)n);
+            fails++;
+        }
+        if (n == prime)
+        {
+            u128 next = nt_next_prime(n);
+            for (uint64_t m = n + 1; m < next; m++)
+            {
+                if (naive_is_prime(m))
+                {
+                    printf("FAIL next_prime %llu\n", (unsigned long long)n);
+                    fails++;
+                }
+            }
+            prime = next;
+        }
+    }
+}
+
+/* Carmichael numbers and strong pseudoprimes to several bases, all
+ * composite */
+static void test_pseudoprimes(void)
+{
+    static const uint64_t composites[] =
+    {
+        561, 1105, 1729, 2465, 2821, 6601, 8911, 41041, 825265, 321197185,
+        2047, 1373653, 25326001, 3215031751ULL, 2152302898747ULL,
+        3474749660383ULL, 341550071728321ULL,
+        /* strong pseudoprime to the prime bases up to 23 */
+        3825123056546413051ULL,
+        /* p * q close to 2^64 */
+        4294967291ULL * 4294967279ULL,
+        /* squares and cubes of primes */
+        4294967291ULL * 4294967291ULL, 2642245ULL * 2642245ULL * 2642245ULL,
+    };
+    static const uint64_t primes[] =
+    {
+        2, 3, 5, 7, 4294967291ULL, 4294967311ULL, 1000000007ULL,
+        18446744073709551557ULL, 9223372036854775783ULL,
+    };
+
+    for (size_t i = 0; i < sizeof(composites) / sizeof(composites[0]); i++)
+    {
+        if (nt_is_prime(composites[i]))
+        {
+            printf("FAIL %llu is not prime\n", (unsigned long long)composites[i]);
+            fails++;
+        }
+        if (!check_factors(composites[i]))
+        {
+            printf("FAIL factor %llu\n", (unsigned long long)composites[i]);
+            fails++;
+        }
+    }
+    for (size_t i = 0; i < sizeof(primes) / sizeof(primes[0]); i++)
+    {
+        if (!nt_is_prime(primes[i]))
+        {
+            printf("FAIL %llu is prime\n", (unsigned long long)primes[i]);
+            fails++;
+        }
+    }
+    /* the largest 64 bit prime, then the next is above 2^64 */
+    if (nt_next_prime(18446744073709551557ULL) != ((u128)1 << 64) + 13)
+    {
+        printf("FAIL next prime above 2^64\n");
+        fails++;
+    }
+    /* strong pseudoprime to all the prime bases up to 37, above 2^64 */
+    if (nt_is_prime((u128)318665857834031151ULL * 1000000 + 167461))
+    {
+        printf("FAIL 318665857834031151167461 is not prime\n");
+        fails++;
+    }
+    /* 2^127 - 1 is prime, 2^128 - 159 is the largest 128 bit prime */
+    if (!nt_is_prime(((u128)1 << 127) - 1) || !nt_is_prime(-(u128)159))
+    {
+        printf("FAIL 128 bit primes\n");
+        fails++;
+    }
+    if (nt_next_prime(-(u128)159) != 0)
+    {
+        printf("FAIL next prime beyond 128 bits\n");
+        fails++;
+    }
+}
+
+static void test_random(void)
+{
+    for (int i = 0; i < 20000; i++)
+    {
+        u128 a = rand128() >> (rand() % 128);
+        u128 b = rand128() >> (rand() % 128);
+        u128 r;
+
+        if (i % 8 == 0)
+        {
+            /* a common factor to find */
+            u128 c = rand64() >> (rand() % 64);
+            a = (a >> 64) * c;
+            b = (b >> 64) * c;
+        }
+        if (nt_gcd(a, b) != naive_gcd(a, b))
+        {
+            printf("FAIL gcd ");
+            print_u128(a);
+            printf(" ");
+            print_u128(b);
+            printf("\n");
+            fails++;
+        }
+
+        r = nt_isqrt(a);
+        if (r * r > a || (r + 1) * (r + 1) <= a)
+        {
+            if (!(r == UINT64_MAX && (r + 1) * (r + 1) == 0))
+            {
+                printf("FAIL isqrt ");
+                print_u128(a);
+                printf("\n");
+                fails++;
+            }
+        }
+        r = nt_icbrt(a);
+        /* r < 2^43 so (r + 1)^3 fits */
+        if (r * r * r > a || (r + 1) * (r + 1) * (r + 1) <= a)
+        {
+            printf("FAIL icbrt ");
+            print_u128(a);
+            printf("\n");
+            fails++;
+        }
+
+        if (a != 0)
+        {
+            int l = nt_ilog2(a);
+            if ((a >> l) != 1)
+            {
+                printf("FAIL ilog2\n");
+                fails++;
+            }
+            l = nt_ilog10(a);
+            u128 p = 1;
+            for (int j = 0; j < l; j++)
+            {
+                p *= 10;
+            }
+            if (p > a || (l < 38 && p * 10 <= a))
+            {
+                printf("FAIL ilog10 ");
+                print_u128(a);
+                printf("\n");
+                fails++;
+            }
+        }
+
+        if (i < 2000 && a > 1 && !check_factors((uint64_t)a | 2))
+        {
+            printf("FAIL factor %llu\n", (unsigned long long)((uint64_t)a | 2));
+            fails++;
+        }
+    }
+    if (nt_ilog2(0) != -1 || nt_ilog10(0) != -1 || nt_isqrt(-(u128)1) !=
+        UINT64_MAX || nt_icbrt(-(u128)1) != 6981463658331ULL)
+    {
+        printf("FAIL edge cases\n");
+        fails++;
+    }
+}
+
+static uint64_t naive_powmod(uint64_t b, u128 e, uint64_t m)
+{
+    u128 r = 1 % m;
+    u128 x = b % m;
+
+    for (; e != 0; e >>= 1)
+    {
+        if (e & 1)
+            r = r * x % m;
+        x = x * x % m;
+    }
+    return (uint64_t)r;
+}
+
+static void test_modular(void)
+{
+    for (int i = 0; i < 20000; i++)
+    {
+        uint64_t m = (rand64() >> (rand() % 64)) | 1;
+        uint64_t a = rand64();
+        u128 e = rand128() >> (rand() % 128);
+        uint64_t inv;
+
+        if (i % 2 == 0)
+        {
+            /* even moduli go a different way */
+            m = (m << (rand() % 8)) | 2;
+        }
+        if (nt_powmod(a, e, m) != naive_powmod(a, e, m))
+        {
+            printf("FAIL powmod %llu ^ e mod %llu\n", (unsigned long long)a,
+                   (unsigned long long)m);
+            fails++;
+        }
+        if (nt_modinv(a, m, &inv) != (naive_gcd(a % m, m) == 1) ||
+            (naive_gcd(a % m, m) == 1 && (u128)(a % m) * inv % m != 1 % m))
+        {
+            printf("FAIL modinv %llu mod %llu\n", (unsigned long long)a,
+                   (unsigned long long)m);
+            fails++;
+        }
+    }
+}
+
+static void test_crt(void)
+{
+    static const struct
+    {
+        int num;
+        uint64_t r[3];
+        uint64_t m[3];
+        bool ok;
+        uint64_t x;
+        uint64_t mod;
+    } tests[] =
+    {
+        {3, {2, 3, 2}, {3, 5, 7}, true, 23, 105},
+        /* not coprime */
+        {2, {3, 4}, {4, 6}, false, 0, 0},
+        {2, {3, 7}, {4, 6}, true, 7, 12},
+        {1, {10, 0}, {7, 0}, true, 3, 7},
+    };
+    u128 r[3], m[3], x, mod;
+
+    for (size_t i = 0; i < sizeof(tests) / sizeof(tests[0]); i++)
+    {
+        bool ok;
+        for (int j = 0; j < tests[i].num; j++)
+        {
+            r[j] = tests[i].r[j];
+            m[j] = tests[i].m[j];
+        }
+        ok = nt_crt(r, m, tests[i].num, &x, &mod);
+        if (ok != tests[i].ok || (ok && (x != tests[i].x || mod != tests[i].mod)))
+        {
+            printf("FAIL crt %zu\n", i);
+            fails++;
+        }
+    }
+    /* random with two 64 bit primes, the result goes above 64 bits */
+    for (int i = 0; i < 200; i++)
+    {
+        m[0] = nt_next_prime(rand64() >> 1);
+        m[1] = nt_next_prime(rand64() >> 1);
+        x = rand128() % (m[0] * m[1]);
+        r[0] = x % m[0];
+        r[1] = x % m[1];
+        if (m[0] != m[1] && (!nt_crt(r, m, 2, &r[2], &mod) || r[2] != x ||
+                             mod != m[0] * m[1]))
+        {
+            printf("FAIL crt random\n");
+            fails++;
+        }
+    }
+}
+
+static void test_dlog(void)
+{
+    uint64_t x;
+
+    for (int i = 0; i < 300; i++)
+    {
+        uint64_t m = 2 + (rand64() >> (24 + rand() % 40));
+        uint64_t a = rand64() % m;
+        uint64_t e = rand64() % m;
+        uint64_t b = naive_powmod(a, e, m);
+        int res = nt_dlog(a, b, m, &x);
+
+        /* the smallest x, so no more than e */
+        if (res != NT_DLOG_FOUND || x > e || naive_powmod(a, x, m) != b)
+        {
+            printf("FAIL dlog %llu %llu %llu\n", (unsigned long long)a,
+                   (unsigned long long)b, (unsigned long long)m);
+            fails++;
+        }
+        if (m < 2000)
+        {
+            /* the smallest by trying them all */
+            uint64_t y = 0;
+            while (naive_powmod(a, y, m) != b)
+            {
+                y++;
+            }
+            if (x != y)
+            {
+                printf("FAIL dlog smallest %llu %llu %llu\n",
+                       (unsigned long long)a, (unsigned long long)b,
+                       (unsigned long long)m);
+                fails++;
+            }
+        }
+    }
+    /* 2 is not a power of 4 mod 7 (4 is a square, 2^1 = 2) so try 3 */
+    if (nt_dlog(2, 3, 7, &x) != NT_DLOG_NONE || nt_dlog(2, 0, 8, &x) !=
+        NT_DLOG_FOUND || x != 3 || nt_dlog(3, 5, (UINT64_C(1) << 61) - 1, &x) !=
+        NT_DLOG_TOO_BIG)
+    {
+        printf("FAIL dlog special cases\n");
+        fails++;
+    }
+}
+
+static double elapsed(clock_t start)
+{
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+/* the slowest 64 bit values to factor are semiprimes with two 32 bit
+ * primes, these should take around a millisecond at most */
+static void time_factor(void)
+{
+    int num = 1000;
+    double worst = 0;
+    clock_t start = clock();
+
+    for (int i = 0; i < num; i++)
+    {
+        u128 p = nt_next_prime(rand64() >> 32 | 0x80000000);
+        u128 q = nt_next_prime(rand64() >> 32 | 0x80000000);
+        clock_t one = clock();
+
+        if (p * q > UINT64_MAX || !check_factors(p * q))
+        {
+            printf("FAIL factor semiprime ");
+            print_u128(p * q);
+            printf("\n");
+            fails++;
+        }
+        if (elapsed(one) > worst)
+            worst = elapsed(one);
+    }
+    printf("64 bit semiprimes %.3f ms average, %.3f ms worst\n",
+           elapsed(start) * 1000 / num, worst * 1000);
+}
+
+/* 64 bit modpow, should be well under a microsecond */
+static void time_powmod(void)
+{
+    int num = 1000000;
+    uint64_t m = 18446744073709551557ULL;
+    uint64_t b = 12345;
+    volatile uint64_t sink = 0;
+    clock_t start = clock();
+
+    for (int i = 0; i < num; i++)
+    {
+        b = nt_powmod(b, (m - 2) ^ (uint64_t)i, m) + 1;
+    }
+    sink = b;
+    (void)sink;
+    printf("64 bit powmod %.0f ns odd modulus", elapsed(start) * 1e9 / num);
+    m--;
+    start = clock();
+    for (int i = 0; i < num; i++)
+    {
+        b = nt_powmod(b, (m - 2) ^ (uint64_t)i, m) + 1;
+    }
+    sink = b;
+    printf(", %.0f ns even\n", elapsed(start) * 1e9 / num);
+}
+
+int main(void)
+{
+    srand(1);
+    test_small();
+    test_pseudoprimes();
+    test_random();
+    test_modular();
+    test_crt();
+    test_dlog();
+    time_factor();
+    time_powmod();
+
+    if (fails == 0)
+    {
+        printf("All tests passed\n");
+    }
+    else
+    {
+        printf("%d tests failed\n", fails);
+    }
+    return fails == 0 ? 0 : 1;
+}
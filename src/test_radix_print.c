@@ -0,0 +1,335 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <time.h>
+
+#include "radix_print.h"
+
+/* Test of radix_print.c against printf and a simple one digit at a time
+ * loop. */
+
+
+#define NUM_RANDOM  200000
+
+static uint64_t rng_state = 0x9e3779b97f4a7c15ULL;
+
+static uint64_t rng(void)
+{
+    /* xorshift64* */
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 0x2545f4914f6cdd1dULL;
+}
+
+typedef unsigned __int128 u128;
+#define U128_MAX (~(u128)0)
+
+/* random value with a random number of significant bits */
+static u128 random_val(void)
+{
+    int bits = (int)(rng() % 129);
+    u128 val = ((u128)rng() << 64) | rng();
+    return bits == 0 ? 0 : val >> (128 - bits);
+}
+
+/* the simple way, with grouping */
+static int naive_print(char *buf, u128 val, int base, int min_digits,
+                       int group, const char *sep)
+{
+    char tmp[128];
+    int n = 0;
+    int len = 0;
+
+    do
+    {
+        tmp[n++] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ"[val % base];
+        val /= base;
+    } while (val);
+    while (n < min_digits && n < 128)
+    {
+        tmp[n++] = '0';
+    }
+    for (int i = n - 1; i >= 0; i--)
+    {
+        buf[len++] = tmp[i];
+        if (group > 0 && i > 0 && i % group == 0)
+        {
+            strcpy(&buf[len], sep);
+            len += (int)strlen(sep);
+        }
+    }
+    buf[len] = 0;
+    return len;
+}
+
+static bool check(u128 val, int base, int min_digits, int group,
+                  const char *sep)
+{
+    char buf[RADIX_PRINT_MAX];
+    char expect[RADIX_PRINT_MAX];
+    int len = radix_print(buf, val, base, min_digits, group, sep);
+    int elen = naive_print(expect, val, base, min_digits, group, sep);
+
+    if (len != elen || strcmp(buf, expect) != 0)
+    {
+        printf("FAIL 0x%016" PRIX64 "%016" PRIX64 " base %d min %d group %d "
+               "sep '%s': got '%s' (%d) expected '%s' (%d)\n",
+               (uint64_t)(val >> 64), (uint64_t)val, base, min_digits, group,
+               sep, buf, len, expect, elen);
+        return false;
+    }
+    return true;
+}
+
+static bool test_printf(void)
+{
+    char buf[RADIX_PRINT_MAX];
+    char expect[RADIX_PRINT_MAX];
+    static const uint64_t vals[] =
+    {
+        0, 1, 7, 8, 9, 10, 15, 16, 99, 100, 255, 256, 4095, 4096,
+        UINT32_MAX, (uint64_t)UINT32_MAX + 1, INT64_MAX, (uint64_t)INT64_MAX + 1,
+        UINT64_MAX,
+    };
+    bool ok = true;
+
+    for (int i = 0; i < (int)(sizeof(vals) / sizeof(vals[0])) + NUM_RANDOM; i++)
+    {
+        uint64_t val = i < (int)(sizeof(vals) / sizeof(vals[0])) ?
+                       vals[i] : (uint64_t)random_val();
+
+        radix_print(buf, val, 16, 1, 0, NULL);
+        sprintf(expect, "%" PRIX64, val);
+        ok = ok && strcmp(buf, expect) == 0;
+        radix_print(buf, val, 10, 1, 0, NULL);
+        sprintf(expect, "%" PRIu64, val);
+        ok = ok && strcmp(buf, expect) == 0;
+        radix_print(buf, val, 8, 1, 0, NULL);
+        sprintf(expect, "%" PRIo64, val);
+        ok = ok && strcmp(buf, expect) == 0;
+        radix_print(buf, val, 16, 16, 0, NULL);
+        sprintf(expect, "%016" PRIX64, val);
+        ok = ok && strcmp(buf, expect) == 0;
+        if (!ok)
+        {
+            printf("FAIL printf %" PRIu64 "\n", val);
+            return false;
+        }
+    }
+    printf("printf OK\n");
+    return true;
+}
+
+static bool test_bases(void)
+{
+    static const char *seps[] = { " ", ",", "__" };
+
+    for (int i = 0; i < NUM_RANDOM; i++)
+    {
+        u128 val = random_val();
+        int base = 2 + (int)(rng() % 35);
+        int min_digits = (int)(rng() % 140);
+        int group = (int)(rng() % 6);
+        const char *sep = seps[rng() % 3];
+
+        if (!check(val, base, min_digits, group, sep)
+            || !check(U128_MAX - val, base, 0, 0, sep)
+            || !check((uint64_t)val, base, min_digits, group, sep))
+        {
+            return false;
+        }
+    }
+    printf("bases OK\n");
+    return true;
+}
+
+static bool test_fixed(void)
+{
+    static const struct
+    {
+        u128 val;
+        int base;
+        int min_digits;
+        int group;
+        const char *sep;
+        const char *expected;
+    } tests[] =
+    {
+        { 0,                  2,  1,  4, " ",  "0" },
+        { 0,                  2,  8,  4, " ",  "0000 0000" },
+        { 0xa5,               2,  16, 4, " ",  "0000 0000 1010 0101" },
+        { 0x12345,            16, 1,  4, " ",  "1 2345" },
+        { 0xdeadbeef,         16, 1,  8, " ",  "DEADBEEF" },
+        { 1234567,            10, 1,  3, ",",  "1,234,567" },
+        { 123456,             10, 1,  3, ",",  "123,456" },
+        { 35,                 36, 1,  0, NULL, "Z" },
+        { 36,                 36, 1,  0, NULL, "10" },
+        { UINT64_MAX,         36, 1,  0, NULL, "3W5E11264SGSF" },
+        { UINT64_MAX,         3,  1,  0, NULL,
+          "11112220022122120101211020120210210211220" },
+        { UINT64_MAX,         8,  1,  0, NULL, "1777777777777777777777" },
+        { 0777,               8,  1,  3, "_",  "777" },
+        { 01000,              8,  1,  3, "_",  "1_000" },
+        { U128_MAX,           16, 1,  8, " ",
+          "FFFFFFFF FFFFFFFF FFFFFFFF FFFFFFFF" },
+        { U128_MAX,           10, 1,  0, NULL,
+          "340282366920938463463374607431768211455" },
+        { U128_MAX,           8,  1,  0, NULL,
+          "3777777777777777777777777777777777777777777" },
+        { U128_MAX,           36, 1,  0, NULL, "F5LXX1ZZ5PNORYNQGLHZMSP33" },
+        { U128_MAX,           3,  1,  0, NULL,
+          "2022011021210020210120002110120110212210222120211110010221102110"
+          "20010021100121010" },
+        { (u128)UINT64_MAX + 1, 10, 1, 0, NULL, "18446744073709551616" },
+        { (u128)1 << 64,      16, 20, 4, " ",
+          "0001 0000 0000 0000 0000" },
+    };
+    char buf[RADIX_PRINT_MAX];
+
+    for (int i = 0; i < (int)(sizeof(tests) / sizeof(tests[0])); i++)
+    {
+        radix_print(buf, tests[i].val, tests[i].base, tests[i].min_digits,
+                    tests[i].group, tests[i].sep);
+        if (strcmp(buf, tests[i].expected) != 0)
+        {
+            printf("FAIL fixed %d: got '%s' expected '%s'\n",
+                   i, buf, tests[i].expected);
+            return false;
+        }
+    }
+    printf("fixed OK\n");
+    return true;
+}
+
+static bool test_byte_bin(void)
+{
+    for (int b = 0; b < 256; b++)
+    {
+        char buf[9] = { 0 };
+        char expect[RADIX_PRINT_MAX];
+        radix_print_byte_bin(buf, (uint8_t)b);
+        radix_print(expect, (uint64_t)b, 2, 8, 0, NULL);
+        if (strcmp(buf, expect) != 0)
+        {
+            printf("FAIL byte bin %d: got '%s'\n", b, buf);
+            return false;
+        }
+    }
+    printf("byte bin OK\n");
+    return true;
+}
+
+static bool test_multi(void)
+{
+    static const struct
+    {
+        u128 val;
+        int bits;
+        bool is_signed;
+        const char *expected;
+    } tests[] =
+    {
+        { 0xff, 8, true,
+          "dec -1\nhex FF\noct 377\nbin 1111 1111" },
+        { 0xff, 8, false,
+          "dec 255\nhex FF\noct 377\nbin 1111 1111" },
+        { 0x1234, 16, true,
+          "dec 4,660\nhex 1234\noct 11064\nbin 0001 0010 0011 0100" },
+        { 0x8000000000000000ULL, 64, true,
+          "dec -9,223,372,036,854,775,808\n"
+          "hex 8000 0000 0000 0000\n"
+          "oct 1000000000000000000000\n"
+          "bin 1000 0000 0000 0000 0000 0000 0000 0000 "
+          "0000 0000 0000 0000 0000 0000 0000 0000" },
+        { 0xfff, 12, true,
+          "dec -1\nhex FFF\noct 7777\nbin 1111 1111 1111" },
+        { 0x5, 3, false,
+          "dec 5\nhex 5\noct 5\nbin 101" },
+        { (u128)1 << 127, 128, true,
+          "dec -170,141,183,460,469,231,731,687,303,715,884,105,728\n"
+          "hex 8000 0000 0000 0000 0000 0000 0000 0000\n"
+          "oct 2000000000000000000000000000000000000000000\n"
+          "bin 1000 0000 0000 0000 0000 0000 0000 0000 "
+          "0000 0000 0000 0000 0000 0000 0000 0000 "
+          "0000 0000 0000 0000 0000 0000 0000 0000 "
+          "0000 0000 0000 0000 0000 0000 0000 0000" },
+    };
+    char buf[RADIX_MULTI_MAX];
+
+    for (int i = 0; i < (int)(sizeof(tests) / sizeof(tests[0])); i++)
+    {
+        int len = radix_print_multi(buf, tests[i].val, tests[i].bits,
+                                    tests[i].is_signed);
+        if (strcmp(buf, tests[i].expected) != 0 || len != (int)strlen(buf))
+        {
+            printf("FAIL multi %d: got\n%s\nexpected\n%s\n",
+                   i, buf, tests[i].expected);
+            return false;
+        }
+    }
+
+    /* longest there is */
+    if (radix_print_multi(buf, (u128)1 << 127, 128, true) >= RADIX_MULTI_MAX)
+    {
+        printf("FAIL multi too long\n");
+        return false;
+    }
+    printf("multi OK\n");
+    return true;
+}
+
+/* not a test as such, just to see the difference */
+static void time_print(void)
+{
+    const int n = 10000;
+    const int reps = 100;
+    static const int bases[] = { 2, 8, 10, 16, 7 };
+    uint64_t *vals = malloc(n * sizeof(uint64_t));
+    char buf[RADIX_PRINT_MAX];
+    clock_t start;
+    double t_naive, t_radix;
+    unsigned int sum = 0;
+
+    for (int i = 0; i < n; i++)
+        vals[i] = rng();
+
+    for (int b = 0; b < (int)(sizeof(bases) / sizeof(bases[0])); b++)
+    {
+        start = clock();
+        for (int r = 0; r < reps; r++)
+            for (int i = 0; i < n; i++)
+                sum += naive_print(buf, vals[i], bases[b], 1, 4, " ");
+        t_naive = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+        start = clock();
+        for (int r = 0; r < reps; r++)
+            for (int i = 0; i < n; i++)
+                sum += radix_print(buf, vals[i], bases[b], 1, 4, " ");
+        t_radix = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+        printf("base %2d x %d: one digit at a time %.3fs, radix_print %.3fs\n",
+               bases[b], n * reps, t_naive, t_radix);
+    }
+    if (sum == 0)
+        printf("\n");
+    free(vals);
+}
+
+int main(void)
+{
+    bool ok = test_printf() && test_bases() && test_fixed()
+              && test_byte_bin() && test_multi();
+
+    if (ok)
+        printf("all tests OK\n");
+    else
+        printf("************* FAIL ***************\n");
+
+    time_print();
+
+    return 0;
+}
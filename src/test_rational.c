@@ -0,0 +1,429 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "rational.h"
+#include "ntheory.h"
+
+/* For testing the rat_ functions from rational.c, against the plain
+ * cross multiplied formulas on small values (reduced with a full gcd),
+ * plus known values, the decimal conversions and overflow. The best
+ * approximations are checked against trying every denominator. */
+
+decContext dfp_context;
+
+static int fails;
+
+static calc_sint_t rand_small(void)
+{
+    calc_sint_t v = rand() % 2000001 - 1000000;
+    return v;
+}
+
+/* for values beyond 64 bits */
+static calc_sint_t from_dec(const char *s)
+{
+    calc_sint_t v = 0;
+    for (; *s; s++)
+    {
+        v = v * 10 + (*s - '0');
+    }
+    return v;
+}
+
+static rat_t make(calc_sint_t n, calc_sint_t d)
+{
+    rat_t r;
+    calc_int_t g = nt_gcd(n < 0 ? -(calc_int_t)n : (calc_int_t)n,
+                          d < 0 ? -(calc_int_t)d : (calc_int_t)d);
+    if (d < 0)
+    {
+        n = -n;
+        d = -d;
+    }
+    r.num = n / (calc_sint_t)g;
+    r.den = (calc_int_t)(d / (calc_sint_t)g);
+    return r;
+}
+
+static void print_rat(const char *what, const rat_t *r)
+{
+    char buf[RAT_STRING_MAX];
+    rat_to_string(buf, r, false);
+    printf(" %s %s", what, buf);
+}
+
+static void check_rat(const char *op, const rat_t *a, const rat_t *b,
+                      const rat_t *got, const rat_t *expect)
+{
+    if (got->num != expect->num || got->den != expect->den)
+    {
+        printf("FAIL %s", op);
+        print_rat("a", a);
+        print_rat("b", b);
+        print_rat("gave", got);
+        print_rat("expected", expect);
+        printf("\n");
+        fails++;
+    }
+}
+
+static void test_random(void)
+{
+    for (int i = 0; i < 200000; i++)
+    {
+        calc_sint_t an = rand_small();
+        calc_sint_t ad = rand() % 1000000 + 1;
+        calc_sint_t bn = rand_small();
+        calc_sint_t bd = rand() % 1000000 + 1;
+        rat_t a = make(an, ad);
+        rat_t b = make(bn, bd);
+        rat_t r, e;
+
+        if (!rat_add(&r, &a, &b))
+        {
+            printf("FAIL add overflow\n");
+            fails++;
+        }
+        e = make(a.num * (calc_sint_t)b.den + b.num * (calc_sint_t)a.den,
+                 (calc_sint_t)(a.den * b.den));
+        check_rat("add", &a, &b, &r, &e);
+
+        (void)rat_sub(&r, &a, &b);
+        e = make(a.num * (calc_sint_t)b.den - b.num * (calc_sint_t)a.den,
+                 (calc_sint_t)(a.den * b.den));
+        check_rat("sub", &a, &b, &r, &e);
+
+        (void)rat_mul(&r, &a, &b);
+        e = make(a.num * b.num, (calc_sint_t)(a.den * b.den));
+        check_rat("mul", &a, &b, &r, &e);
+
+        if (b.num == 0)
+        {
+            if (rat_div(&r, &a, &b))
+            {
+                printf("FAIL div by zero\n");
+                fails++;
+            }
+            continue;
+        }
+        (void)rat_div(&r, &a, &b);
+        e = make(a.num * (calc_sint_t)b.den, b.num * (calc_sint_t)a.den);
+        check_rat("div", &a, &b, &r, &e);
+    }
+}
+
+/* chains stay exact, eg. adding 1/n for n = 1..N */
+static void test_chain(void)
+{
+    rat_t sum = make(0, 1);
+    rat_t one_third = make(1, 3);
+    rat_t three = make(3, 1);
+    rat_t r;
+    int n;
+
+    for (n = 1; n <= 100; n++)
+    {
+        rat_t t = make(1, n);
+        if (!rat_add(&sum, &sum, &t))
+            break;
+    }
+    /* the harmonic numbers' denominators pass 2^128 at H(89) */
+    if (n < 80 || n > 100)
+    {
+        printf("FAIL harmonic sum stopped at %d\n", n);
+        fails++;
+    }
+
+    (void)rat_mul(&r, &one_third, &three);
+    rat_t e = make(1, 1);
+    check_rat("1/3 * 3", &one_third, &three, &r, &e);
+
+    /* overflow is reported, not wrapped */
+    rat_t big = make(CALC_SINT_MAX, 1);
+    rat_t half = make(1, 2);
+    if (rat_add(&r, &big, &big) || rat_mul(&r, &big, &three))
+    {
+        printf("FAIL big overflow\n");
+        fails++;
+    }
+    if (!rat_mul(&r, &big, &half) || r.num != CALC_SINT_MAX || r.den != 2)
+    {
+        printf("FAIL big * 1/2\n");
+        fails++;
+    }
+    if (!rat_neg(&r, &big) || r.num != -CALC_SINT_MAX)
+    {
+        printf("FAIL neg big\n");
+        fails++;
+    }
+}
+
+static void check_from(const char *text, bool expect_ok, calc_sint_t n,
+                       calc_int_t d)
+{
+    stackf_t x;
+    rat_t r;
+
+    dfp_from_string(&x, text, &dfp_context);
+    bool ok = rat_from_dfp(&r, &x);
+    if (ok != expect_ok || (ok && (r.num != n || r.den != d)))
+    {
+        printf("FAIL from %s", text);
+        if (ok)
+            print_rat("gave", &r);
+        printf("\n");
+        fails++;
+    }
+}
+
+static void check_to(calc_sint_t n, calc_sint_t d, const char *expect)
+{
+    stackf_t x;
+    char s[DFP_STRING_MAX];
+    rat_t r = make(n, d);
+
+    rat_to_dfp(&r, &x);
+    dfp_to_string(&x, s);
+    if (strcmp(s, expect) != 0)
+    {
+        printf("FAIL to dfp");
+        print_rat("", &r);
+        printf(" gave %s expected %s\n", s, expect);
+        fails++;
+    }
+}
+
+static void check_string(calc_sint_t n, calc_sint_t d, bool mixed,
+                         const char *expect)
+{
+    char s[RAT_STRING_MAX];
+    rat_t r = make(n, d);
+
+    rat_to_string(s, &r, mixed);
+    if (strcmp(s, expect) != 0)
+    {
+        printf("FAIL string gave %s expected %s\n", s, expect);
+        fails++;
+    }
+}
+
+static void test_known(void)
+{
+    calc_int_t e38 = 1;
+    for (int i = 0; i < 38; i++)
+    {
+        e38 *= 10;
+    }
+
+    check_from("0", true, 0, 1);
+    check_from("-0", true, 0, 1);
+    check_from("0.1", true, 1, 10);
+    check_from("-2.50", true, -5, 2);
+    check_from("1.25E+3", true, 1250, 1);
+    check_from("0.125", true, 1, 8);
+    check_from("5E-39", true, 1, 2 * e38);
+    check_from("1E-39", false, 0, 0);
+    check_from("1E+38", true, (calc_sint_t)e38, 1);
+    check_from("2E+38", false, 0, 0);
+    check_from("Inf", false, 0, 0);
+    check_from("NaN", false, 0, 0);
+
+    check_to(1, 3, "0.3333333333333333333333333333333333");
+    check_to(-2, 3, "-0.6666666666666666666666666666666667");
+    check_to(1, 8, "0.125");
+    check_to(100, 1, "100");
+    check_to(0, 1, "0");
+    check_to(22, 7, "3.142857142857142857142857142857143");
+    check_to(CALC_SINT_MAX, 1, "1.701411834604692317316873037158841E+38");
+    /* exactly halfway at 35 digits, rounds to even */
+    check_to(from_dec("12345678901234567890123456789012345"), 10,
+             "1234567890123456789012345678901234");
+    check_to(from_dec("12345678901234567890123456789012355"), 10,
+             "1234567890123456789012345678901236");
+    check_to(from_dec("37037036703703703670370370367037036"), 30,
+             "1234567890123456789012345678901235");
+
+    check_string(7, 3, false, "7/3");
+    check_string(-7, 3, true, "-2 1/3");
+    check_string(2, 3, true, "2/3");
+    check_string(-6, 3, true, "-2");
+    check_string(0, 5, true, "0");
+}
+
+static void check_cf(calc_sint_t n, calc_sint_t d, const char *expect)
+{
+    rat_t a = make(n, d);
+    calc_sint_t a0;
+    calc_int_t cf[8];
+    char s[200];
+    int len;
+
+    int num = rat_continued_fraction(&a, &a0, cf, 8);
+    len = sprintf(s, "[%lld", (long long)a0);
+    for (int i = 0; i < num && i < 8; i++)
+    {
+        len += sprintf(s + len, "%s%llu", i == 0 ? "; " : ", ",
+                       (unsigned long long)cf[i]);
+    }
+    sprintf(s + len, "]");
+    if (strcmp(s, expect) != 0)
+    {
+        printf("FAIL cf gave %s expected %s\n", s, expect);
+        fails++;
+    }
+}
+
+static rat_t from_text(const char *text)
+{
+    stackf_t x;
+    rat_t r;
+
+    dfp_from_string(&x, text, &dfp_context);
+    if (!rat_from_dfp(&r, &x))
+    {
+        printf("FAIL from_text %s\n", text);
+        fails++;
+    }
+    return r;
+}
+
+static void check_best(const char *text, calc_int_t max_den,
+                       calc_sint_t n, calc_int_t d)
+{
+    rat_t a = from_text(text);
+    rat_t r;
+
+    rat_best_approx(&r, &a, max_den);
+    if (r.num != n || r.den != d)
+    {
+        printf("FAIL best %s den %llu", text, (unsigned long long)max_den);
+        print_rat("gave", &r);
+        printf("\n");
+        fails++;
+    }
+}
+
+static void check_recognise(const char *text, bool expect_ok,
+                            calc_sint_t n, calc_int_t d,
+                            rat_times_enum expect_times)
+{
+    stackf_t x;
+    rat_t r;
+    rat_times_enum times;
+
+    dfp_from_string(&x, text, &dfp_context);
+    bool ok = rat_recognise(&x, RAT_RECOGNISE_MAX_DEN, &r, &times);
+    if (ok != expect_ok ||
+        (ok && (r.num != n || r.den != d || times != expect_times)))
+    {
+        printf("FAIL recognise %s", text);
+        if (ok)
+        {
+            print_rat("gave", &r);
+            printf(" times %d", (int)times);
+        }
+        printf("\n");
+        fails++;
+    }
+}
+
+/* |a - p / q| as a double is plenty to compare for small values */
+static double dist(const rat_t *a, calc_sint_t p, calc_sint_t q)
+{
+    double x = (double)(a->num * q - p * (calc_sint_t)a->den);
+    return (x < 0 ? -x : x) / ((double)a->den * (double)q);
+}
+
+/* against trying every denominator */
+static void test_best_random(void)
+{
+    for (int i = 0; i < 20000; i++)
+    {
+        rat_t a = make(rand_small(), rand() % 1000000 + 1);
+        calc_int_t max_den = rand() % 200 + 1;
+        rat_t r;
+        double best = 1e300;
+
+        rat_best_approx(&r, &a, max_den);
+        for (calc_sint_t q = 1; q <= (calc_sint_t)max_den; q++)
+        {
+            calc_sint_t p = a.num * q / (calc_sint_t)a.den;
+            for (calc_sint_t pp = p - 1; pp <= p + 1; pp++)
+            {
+                double e = dist(&a, pp, q);
+                if (e < best)
+                    best = e;
+            }
+        }
+        if (r.den > max_den || dist(&a, r.num, (calc_sint_t)r.den) > best)
+        {
+            printf("FAIL best random");
+            print_rat("a", &a);
+            print_rat("gave", &r);
+            printf(" max den %d\n", (int)max_den);
+            fails++;
+        }
+    }
+}
+
+static void test_continued_fraction(void)
+{
+    rat_t conv[8];
+    rat_t pi = from_text("3.141592653589793238462643383279503");
+
+    check_cf(415, 93, "[4; 2, 6, 7]");
+    check_cf(-7, 3, "[-3; 1, 2]");
+    check_cf(-6, 3, "[-2]");
+    check_cf(3, 7, "[0; 2, 3]");
+
+    int num = rat_convergents(&pi, 1000, conv, 8);
+    if (num != 4 || conv[1].num != 22 || conv[1].den != 7 ||
+        conv[3].num != 355 || conv[3].den != 113)
+    {
+        printf("FAIL convergents of pi\n");
+        fails++;
+    }
+
+    check_best("3.141592653589793238462643383279503", 100, 311, 99);
+    check_best("3.141592653589793238462643383279503", 1000, 355, 113);
+    check_best("-3.141592653589793238462643383279503", 10, -22, 7);
+    check_best("3.7", 1, 4, 1);
+    check_best("0.5", 1000, 1, 2);
+    test_best_random();
+
+    check_recognise("0.3333333333333333333333333333333333", true, 1, 3,
+                    rat_times_one);
+    check_recognise("-2.5", true, -5, 2, rat_times_one);
+    check_recognise("0", true, 0, 1, rat_times_one);
+    check_recognise("0.7853981633974483096156608458198758", true, 1, 4,
+                    rat_times_pi);
+    check_recognise("0.7071067811865475244008443621048490", true, 1, 2,
+                    rat_times_sqrt2);
+    check_recognise("-9.869604401089358618834490999876151E-1", false, 0, 0,
+                    rat_times_one);
+    check_recognise("1.732050807568877293527446341505872", false, 0, 0,
+                    rat_times_one);
+}
+
+int main(void)
+{
+    decContextDefault(&dfp_context, DEC_INIT_DECQUAD);
+    srand(1);
+    test_known();
+    test_chain();
+    test_random();
+    test_continued_fraction();
+
+    if (fails == 0)
+    {
+        printf("All tests passed\n");
+    }
+    else
+    {
+        printf("%d tests failed\n", fails);
+    }
+    return fails == 0 ? 0 : 1;
+}